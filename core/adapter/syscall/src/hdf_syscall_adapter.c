@@ -1073,6 +1073,38 @@ int HdfIoserviceGetListenerCount(const struct HdfIoService *service)
     return count;
 }
 
+int32_t HdfIoServiceSetEventQueue(struct HdfIoService *service, const struct HdfEventQueueConfig *config)
+{
+    if (service == NULL || config == NULL) {
+        return HDF_ERR_INVALID_PARAM;
+    }
+
+    struct HdfSyscallAdapter *adapter = CONTAINER_OF(service, struct HdfSyscallAdapter, super);
+    int32_t ret = ioctl(adapter->fd, HDF_LISTEN_EVENT_SET_QUEUE, config);
+    if (ret) {
+        HDF_LOGE("%s: failed to set event queue of drv(%d) %d %{public}s", __func__, adapter->fd, errno, strerror(errno));
+        return HDF_ERR_IO;
+    }
+
+    return HDF_SUCCESS;
+}
+
+int32_t HdfIoServiceGetEventQueueStats(struct HdfIoService *service, struct HdfEventQueueStats *stats)
+{
+    if (service == NULL || stats == NULL) {
+        return HDF_ERR_INVALID_PARAM;
+    }
+
+    struct HdfSyscallAdapter *adapter = CONTAINER_OF(service, struct HdfSyscallAdapter, super);
+    int32_t ret = ioctl(adapter->fd, HDF_LISTEN_EVENT_GET_STATS, stats);
+    if (ret) {
+        HDF_LOGE("%s: failed to get event queue stats of drv(%d) %d %{public}s", __func__, adapter->fd, errno, strerror(errno));
+        return HDF_ERR_IO;
+    }
+
+    return HDF_SUCCESS;
+}
+
 int HdfIoserviceGroupGetListenerCount(const struct HdfIoServiceGroup *group)
 {
     if (group == NULL) {
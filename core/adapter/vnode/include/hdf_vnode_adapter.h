@@ -9,6 +9,7 @@
 #ifndef HDF_VNODE_ADAPTER_H
 #define HDF_VNODE_ADAPTER_H
 #include "hdf_dlist.h"
+#include "osal_atomic.h"
 #include "osal_mutex.h"
 #include "hdf_sbuf.h"
 #include "hdf_io_service.h"
@@ -21,12 +22,15 @@ struct HdfVNodeAdapter {
     struct OsalMutex mutex;
     struct DListHead clientList;
     struct OsalCdev *cdev;
+    uint32_t eventAllocs;
+    uint64_t copyBytes;
 };
 
+/* an event as reported, shared read only by the queues of all the clients it went to */
 struct HdfDevEvent {
     uint32_t id;
     struct HdfSBuf *data;
-    struct DListHead listNode;
+    OsalAtomic refCount;
 };
 
 #endif /* HDF_VNODE_ADAPTER_H */
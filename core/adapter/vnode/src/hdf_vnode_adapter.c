@@ -19,7 +19,6 @@
 
 #define HDF_LOG_TAG hdf_vnode
 #define VOID_DATA_SIZE 4
-#define EVENT_QUEUE_MAX 100
 #define MAX_RW_SIZE (1024 * 1204) // 1M
 
 enum HdfVNodeClientStatus {
@@ -35,9 +34,15 @@ struct HdfVNodeAdapterClient {
     wait_queue_head_t pollWait;
     struct HdfIoService *serv;
     struct OsalMutex mutex;
-    struct DListHead eventQueue;
+    struct HdfDevEvent **eventQueue; /* ring of eventQueueDepth events, the oldest at eventQueueHead */
     struct DListHead listNode;
-    int32_t eventQueueSize;
+    uint32_t eventQueueDepth;
+    uint32_t eventQueueHead;
+    uint32_t eventQueueSize;
+    uint32_t dropPolicy;
+    uint32_t maxQueueSize;
+    uint32_t queuedEvents;
+    uint32_t droppedEvents;
     int32_t wakeup;
     uint32_t status;
 };
@@ -191,6 +196,48 @@ static void DevEventFree(struct HdfDevEvent *event)
     OsalMemFree(event);
 }
 
+/* copy the event data once, with adapter->mutex held, whatever the number of clients to queue it */
+static struct HdfDevEvent *DevEventCreate(struct HdfVNodeAdapter *adapter, uint32_t id, const struct HdfSBuf *data)
+{
+    struct HdfDevEvent *event = OsalMemAlloc(sizeof(struct HdfDevEvent));
+    if (event == NULL) {
+        return NULL;
+    }
+    event->id = id;
+    event->data = HdfSBufCopy(data);
+    if (event->data == NULL) {
+        HDF_LOGE("%s: sbuf oom", __func__);
+        OsalMemFree(event);
+        return NULL;
+    }
+    OsalAtomicSet(&event->refCount, 1);
+    adapter->eventAllocs++;
+    adapter->copyBytes += HdfSbufGetDataSize(data);
+    return event;
+}
+
+static void DevEventGet(struct HdfDevEvent *event)
+{
+    OsalAtomicInc(&event->refCount);
+}
+
+static void DevEventPut(struct HdfDevEvent *event)
+{
+    if (OsalAtomicDecReturn(&event->refCount) == 0) {
+        DevEventFree(event);
+    }
+}
+
+static struct HdfDevEvent *VNodeAdapterClientPopEventLocked(struct HdfVNodeAdapterClient *client)
+{
+    struct HdfDevEvent *event = client->eventQueue[client->eventQueueHead];
+
+    client->eventQueue[client->eventQueueHead] = NULL;
+    client->eventQueueHead = (client->eventQueueHead + 1) % client->eventQueueDepth;
+    client->eventQueueSize--;
+    return event;
+}
+
 static int HdfVNodeAdapterServCall(const struct HdfVNodeAdapterClient *client, unsigned long arg)
 {
     struct HdfWriteReadBuf bwr;
@@ -266,12 +313,12 @@ static int HdfVNodeAdapterReadDevEvent(struct HdfVNodeAdapterClient *client, uns
     }
     OsalMutexLock(&client->mutex);
 
-    if (DListIsEmpty(&client->eventQueue)) {
+    if (client->eventQueueSize == 0) {
         OsalMutexUnlock(&client->mutex);
         return HDF_DEV_ERR_NODATA;
     }
 
-    event = CONTAINER_OF(client->eventQueue.next, struct HdfDevEvent, listNode);
+    event = client->eventQueue[client->eventQueueHead];
     eventSize = HdfSbufGetDataSize(event->data);
     if (eventSize > bwr.readSize) {
         bwr.readSize = eventSize;
@@ -290,53 +337,47 @@ static int HdfVNodeAdapterReadDevEvent(struct HdfVNodeAdapterClient *client, uns
         ret = HDF_ERR_IO;
     }
     if (ret == HDF_SUCCESS) {
-        DListRemove(&event->listNode);
-        DevEventFree(event);
-        client->eventQueueSize--;
+        DevEventPut(VNodeAdapterClientPopEventLocked(client));
     }
 
     OsalMutexUnlock(&client->mutex);
     return ret;
 }
 
-static void HdfVnodeAdapterDropOldEventLocked(struct HdfVNodeAdapterClient *client)
-{
-    struct HdfDevEvent *dropEvent = CONTAINER_OF(client->eventQueue.next, struct HdfDevEvent, listNode);
-
-    HDF_LOGE("dev event queue full, drop old one");
-    DListRemove(&dropEvent->listNode);
-    DevEventFree(dropEvent);
-    client->eventQueueSize--;
-}
-
 static int VNodeAdapterSendDevEventToClient(struct HdfVNodeAdapterClient *vnodeClient,
-    uint32_t id, const struct HdfSBuf *data)
+    uint32_t id, const struct HdfSBuf *data, struct HdfDevEvent **event)
 {
-    struct HdfDevEvent *event = NULL;
-
     OsalMutexLock(&vnodeClient->mutex);
     if (vnodeClient->status != VNODE_CLIENT_LISTENING) {
         OsalMutexUnlock(&vnodeClient->mutex);
         return HDF_SUCCESS;
     }
-    if (vnodeClient->eventQueueSize >= EVENT_QUEUE_MAX) {
-        HdfVnodeAdapterDropOldEventLocked(vnodeClient);
-    }
-    event = OsalMemAlloc(sizeof(struct HdfDevEvent));
-    if (event == NULL) {
-        OsalMutexUnlock(&vnodeClient->mutex);
-        return HDF_DEV_ERR_NO_MEMORY;
+    if (vnodeClient->eventQueueSize >= vnodeClient->eventQueueDepth) {
+        if (vnodeClient->droppedEvents++ == 0) {
+            HDF_LOGE("dev event queue full, drop %s one, later drops are only counted",
+                vnodeClient->dropPolicy == HDF_EVENT_DROP_NEWEST ? "new" : "old");
+        }
+        if (vnodeClient->dropPolicy == HDF_EVENT_DROP_NEWEST) {
+            OsalMutexUnlock(&vnodeClient->mutex);
+            return HDF_SUCCESS;
+        }
+        DevEventPut(VNodeAdapterClientPopEventLocked(vnodeClient));
     }
-    event->id = id;
-    event->data = HdfSBufCopy(data);
-    if (event->data == NULL) {
-        OsalMutexUnlock(&vnodeClient->mutex);
-        HDF_LOGE("%s: sbuf oom", __func__);
-        OsalMemFree(event);
-        return HDF_DEV_ERR_NO_MEMORY;
+    if (*event == NULL) {
+        *event = DevEventCreate(vnodeClient->adapter, id, data);
+        if (*event == NULL) {
+            OsalMutexUnlock(&vnodeClient->mutex);
+            return HDF_DEV_ERR_NO_MEMORY;
+        }
     }
-    DListInsertTail(&event->listNode, &vnodeClient->eventQueue);
+    DevEventGet(*event);
+    vnodeClient->eventQueue[(vnodeClient->eventQueueHead + vnodeClient->eventQueueSize) %
+        vnodeClient->eventQueueDepth] = *event;
     vnodeClient->eventQueueSize++;
+    vnodeClient->queuedEvents++;
+    if (vnodeClient->eventQueueSize > vnodeClient->maxQueueSize) {
+        vnodeClient->maxQueueSize = vnodeClient->eventQueueSize;
+    }
     wake_up_interruptible(&vnodeClient->pollWait);
     OsalMutexUnlock(&vnodeClient->mutex);
 
@@ -347,6 +388,7 @@ static int HdfVNodeAdapterSendDevEvent(struct HdfVNodeAdapter *adapter, struct H
     uint32_t id, const struct HdfSBuf *data)
 {
     struct HdfVNodeAdapterClient *client = NULL;
+    struct HdfDevEvent *event = NULL;
     int ret = HDF_FAILURE;
 
     if (adapter == NULL || data == NULL || HdfSbufGetDataSize(data) == 0) {
@@ -357,12 +399,16 @@ static int HdfVNodeAdapterSendDevEvent(struct HdfVNodeAdapter *adapter, struct H
         if (vnodeClient != NULL && client != vnodeClient) {
             continue;
         }
-        ret = VNodeAdapterSendDevEventToClient(client, id, data);
+        ret = VNodeAdapterSendDevEventToClient(client, id, data, &event);
         if (ret != HDF_SUCCESS) {
             break;
         }
     }
     OsalMutexUnlock(&adapter->mutex);
+    /* drop the reference of the sender, the queues hold their own */
+    if (event != NULL) {
+        DevEventPut(event);
+    }
     return ret;
 }
 
@@ -375,12 +421,10 @@ static void HdfVNodeAdapterClientStartListening(struct HdfVNodeAdapterClient *cl
 
 static void HdfVnodeCleanEventQueue(struct HdfVNodeAdapterClient *client)
 {
-    struct HdfDevEvent *event = NULL;
-    struct HdfDevEvent *eventTemp = NULL;
-    DLIST_FOR_EACH_ENTRY_SAFE(event, eventTemp, &client->eventQueue, struct HdfDevEvent, listNode) {
-        DListRemove(&event->listNode);
-        DevEventFree(event);
+    while (client->eventQueueSize > 0) {
+        DevEventPut(VNodeAdapterClientPopEventLocked(client));
     }
+    client->eventQueueHead = 0;
 }
 
 static void HdfVNodeAdapterClientStopListening(struct HdfVNodeAdapterClient *client)
@@ -413,6 +457,74 @@ static void HdfVNodeAdapterClientWakeup(struct HdfVNodeAdapterClient *client)
     OsalMutexUnlock(&client->mutex);
 }
 
+static int HdfVNodeAdapterSetEventQueue(struct HdfVNodeAdapterClient *client, unsigned long arg)
+{
+    struct HdfEventQueueConfig config;
+    struct HdfDevEvent **queue = NULL;
+    struct HdfDevEvent **oldQueue = NULL;
+    uint32_t size = 0;
+
+    if (arg == 0 || CopyFromUser(&config, (void *)(uintptr_t)arg, sizeof(config)) != 0) {
+        return HDF_ERR_INVALID_PARAM;
+    }
+    if (config.depth == 0 || config.depth > HDF_EVENT_QUEUE_DEPTH_MAX ||
+        config.dropPolicy >= HDF_EVENT_DROP_POLICY_MAX) {
+        HDF_LOGE("%s: invalid depth %u or drop policy %u", __func__, config.depth, config.dropPolicy);
+        return HDF_ERR_INVALID_PARAM;
+    }
+    queue = OsalMemCalloc(sizeof(struct HdfDevEvent *) * config.depth);
+    if (queue == NULL) {
+        HDF_LOGE("%s: oom", __func__);
+        return HDF_DEV_ERR_NO_MEMORY;
+    }
+
+    OsalMutexLock(&client->mutex);
+    /* keep the newest events that fit in the new depth, counting the others as dropped */
+    while (client->eventQueueSize > config.depth) {
+        DevEventPut(VNodeAdapterClientPopEventLocked(client));
+        client->droppedEvents++;
+    }
+    while (client->eventQueueSize > 0) {
+        queue[size++] = VNodeAdapterClientPopEventLocked(client);
+    }
+    oldQueue = client->eventQueue;
+    client->eventQueue = queue;
+    client->eventQueueDepth = config.depth;
+    client->eventQueueHead = 0;
+    client->eventQueueSize = size;
+    client->dropPolicy = config.dropPolicy;
+    OsalMutexUnlock(&client->mutex);
+
+    OsalMemFree(oldQueue);
+    return HDF_SUCCESS;
+}
+
+static int HdfVNodeAdapterGetEventQueueStats(struct HdfVNodeAdapterClient *client, unsigned long arg)
+{
+    struct HdfEventQueueStats stats;
+
+    if (arg == 0) {
+        return HDF_ERR_INVALID_PARAM;
+    }
+    OsalMutexLock(&client->adapter->mutex);
+    stats.eventAllocs = client->adapter->eventAllocs;
+    stats.copyBytes = client->adapter->copyBytes;
+    OsalMutexLock(&client->mutex);
+    stats.depth = client->eventQueueDepth;
+    stats.count = client->eventQueueSize;
+    stats.maxCount = client->maxQueueSize;
+    stats.queued = client->queuedEvents;
+    stats.dropped = client->droppedEvents;
+    OsalMutexUnlock(&client->mutex);
+    OsalMutexUnlock(&client->adapter->mutex);
+
+    if (CopyToUser((void *)(uintptr_t)arg, &stats, sizeof(stats)) != 0) {
+        HDF_LOGE("%s: failed to copy stats", __func__);
+        return HDF_ERR_IO;
+    }
+    return HDF_SUCCESS;
+}
+
 static long HdfVNodeAdapterIoctl(struct file *filep,  unsigned int cmd, unsigned long arg)
 {
     struct HdfVNodeAdapterClient *client = (struct HdfVNodeAdapterClient *)OsalGetFilePriv(filep);
@@ -436,6 +548,10 @@ static long HdfVNodeAdapterIoctl(struct file *filep,  unsigned int cmd, unsigned
         case HDF_LISTEN_EVENT_EXIT:
             HdfVNodeAdapterClientExitListening(client);
             break;
+        case HDF_LISTEN_EVENT_SET_QUEUE:
+            return HdfVNodeAdapterSetEventQueue(client, arg);
+        case HDF_LISTEN_EVENT_GET_STATS:
+            return HdfVNodeAdapterGetEventQueueStats(client, arg);
         default:
             return HDF_FAILURE;
     }
@@ -450,14 +566,21 @@ static struct HdfVNodeAdapterClient *HdfNewVNodeAdapterClient(struct HdfVNodeAda
         HDF_LOGE("%s: oom", __func__);
         return NULL;
     }
+    client->eventQueue = OsalMemCalloc(sizeof(struct HdfDevEvent *) * HDF_EVENT_QUEUE_DEPTH_DEFAULT);
+    if (client->eventQueue == NULL) {
+        OsalMemFree(client);
+        HDF_LOGE("%s: oom", __func__);
+        return NULL;
+    }
     if (OsalMutexInit(&client->mutex) != HDF_SUCCESS) {
+        OsalMemFree(client->eventQueue);
         OsalMemFree(client);
         HDF_LOGE("%s: no mutex", __func__);
         return NULL;
     }
 
-    DListHeadInit(&client->eventQueue);
-    client->eventQueueSize = 0;
+    client->eventQueueDepth = HDF_EVENT_QUEUE_DEPTH_DEFAULT;
+    client->dropPolicy = HDF_EVENT_DROP_OLDEST;
     client->serv = &adapter->ioService;
     client->status = VNODE_CLIENT_RUNNING;
     client->adapter = adapter;
@@ -474,9 +597,6 @@ static struct HdfVNodeAdapterClient *HdfNewVNodeAdapterClient(struct HdfVNodeAda
 
 static void HdfDestoryVNodeAdapterClient(struct HdfVNodeAdapterClient *client)
 {
-    struct HdfDevEvent *event = NULL;
-    struct HdfDevEvent *eventTemp = NULL;
-
     client->status = VNODE_CLIENT_STOPPED;
 
     OsalMutexLock(&client->adapter->mutex);
@@ -484,12 +604,10 @@ static void HdfDestoryVNodeAdapterClient(struct HdfVNodeAdapterClient *client)
     OsalMutexUnlock(&client->adapter->mutex);
 
     OsalMutexLock(&client->mutex);
-    DLIST_FOR_EACH_ENTRY_SAFE(event, eventTemp, &client->eventQueue, struct HdfDevEvent, listNode) {
-        DListRemove(&event->listNode);
-        DevEventFree(event);
-    }
+    HdfVnodeCleanEventQueue(client);
     OsalMutexUnlock(&client->mutex);
     OsalMutexDestroy(&client->mutex);
+    OsalMemFree(client->eventQueue);
     OsalMemFree(client);
 }
 
@@ -532,7 +650,7 @@ static unsigned int HdfVNodeAdapterPoll(struct file *filep, poll_table *wait)
     OsalMutexLock(&client->mutex);
     if (client->status == VNODE_CLIENT_EXITED) {
         mask |= POLLHUP;
-    } else if (!DListIsEmpty(&client->eventQueue)) {
+    } else if (client->eventQueueSize > 0) {
         mask |= POLLIN;
     } else if (client->wakeup > 0) {
         mask |= POLLIN;
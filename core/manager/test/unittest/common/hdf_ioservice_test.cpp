@@ -28,6 +28,18 @@ struct Eventlistener {
     int32_t eventCount;
 };
 
+struct BenchEventlistener {
+    struct HdfDevEventlistener listener;
+    uint32_t eventCount;
+    uint64_t totalLatencyUs;
+    uint64_t maxLatencyUs;
+};
+
+#define USEC_PER_SEC 1000000
+#define BENCH_LISTENER_NUM 16
+#define BENCH_EVENT_NUM 64
+#define SLOW_LISTENER_BLOCK_US (500 * 1000)
+
 class IoServiceTest : public testing::Test {
 public:
     static void SetUpTestCase();
@@ -36,9 +48,14 @@ public:
     void TearDown();
     static int OnDevEventReceived(struct HdfDevEventlistener *listener, struct HdfIoService *service, uint32_t id,
         struct HdfSBuf *data);
+    static int OnSlowEventReceived(struct HdfDevEventlistener *listener, struct HdfIoService *service, uint32_t id,
+        struct HdfSBuf *data);
+    static int OnBenchEventReceived(struct HdfDevEventlistener *listener, struct HdfIoService *service, uint32_t id,
+        struct HdfSBuf *data);
 
     static struct Eventlistener listener0;
     static struct Eventlistener listener1;
+    static struct Eventlistener slowListener;
     const char *testSvcName = SAMPLE_SERVICE;
     const int eventWaitTimeUs = (150 * 1000);
     static int eventCount;
@@ -48,6 +65,7 @@ int IoServiceTest::eventCount = 0;
 
 struct Eventlistener IoServiceTest::listener0;
 struct Eventlistener IoServiceTest::listener1;
+struct Eventlistener IoServiceTest::slowListener;
 
 void IoServiceTest::SetUpTestCase()
 {
@@ -56,6 +74,9 @@ void IoServiceTest::SetUpTestCase()
 
     listener1.listener.onReceive = OnDevEventReceived;
     listener1.listener.priv = (void *)"listener1";
+
+    slowListener.listener.onReceive = OnSlowEventReceived;
+    slowListener.listener.priv = (void *)"slowListener";
 }
 
 void IoServiceTest::TearDownTestCase()
@@ -66,6 +87,7 @@ void IoServiceTest::SetUp()
 {
     listener0.eventCount = 0;
     listener1.eventCount = 0;
+    slowListener.eventCount = 0;
     eventCount = 0;
 }
 
@@ -92,6 +114,71 @@ int IoServiceTest::OnDevEventReceived(struct HdfDevEventlistener *listener, stru
     return 0;
 }
 
+/* blocks on its first event so that the following ones pile up in the queue */
+int IoServiceTest::OnSlowEventReceived(struct HdfDevEventlistener *listener, struct HdfIoService *service,
+    uint32_t id, struct HdfSBuf *data)
+{
+    (void)service;
+    (void)id;
+    (void)data;
+    struct Eventlistener *l = CONTAINER_OF(listener, struct Eventlistener, listener);
+    if (l->eventCount++ == 0) {
+        usleep(SLOW_LISTENER_BLOCK_US);
+    }
+    return 0;
+}
+
+static uint64_t GetTimeUs(void)
+{
+    OsalTimespec time;
+    OsalGetTime(&time);
+    return time.sec * USEC_PER_SEC + time.usec;
+}
+
+int IoServiceTest::OnBenchEventReceived(struct HdfDevEventlistener *listener, struct HdfIoService *service,
+    uint32_t id, struct HdfSBuf *data)
+{
+    (void)service;
+    (void)id;
+    uint64_t sendTimeUs = 0;
+    uint64_t now = GetTimeUs();
+    if (!HdfSbufReadUint64(data, &sendTimeUs)) {
+        HDF_LOGE("failed to read send time in event data");
+        return 0;
+    }
+    struct BenchEventlistener *l = CONTAINER_OF(listener, struct BenchEventlistener, listener);
+    uint64_t latencyUs = (now > sendTimeUs) ? (now - sendTimeUs) : 0;
+    l->eventCount++;
+    l->totalLatencyUs += latencyUs;
+    if (latencyUs > l->maxLatencyUs) {
+        l->maxLatencyUs = latencyUs;
+    }
+    return 0;
+}
+
+static int SendStampEvent(struct HdfIoService *serv, bool broadcast)
+{
+    struct HdfSBuf *data = HdfSBufObtainDefaultSize();
+    if (data == nullptr) {
+        return HDF_DEV_ERR_NO_MEMORY;
+    }
+    struct HdfSBuf *reply = HdfSBufObtainDefaultSize();
+    if (reply == nullptr) {
+        HdfSBufRecycle(data);
+        return HDF_DEV_ERR_NO_MEMORY;
+    }
+
+    int ret = HDF_FAILURE;
+    uint32_t cmdId = broadcast ? SAMPLE_DRIVER_SENDEVENT_BROADCAST_DEVICE : SAMPLE_DRIVER_SENDEVENT_SINGLE_DEVICE;
+    if (HdfSbufWriteUint64(data, GetTimeUs())) {
+        ret = serv->dispatcher->Dispatch(&serv->object, cmdId, data, reply);
+    }
+
+    HdfSBufRecycle(data);
+    HdfSBufRecycle(reply);
+    return ret;
+}
+
 static int SendEvent(struct HdfIoService *serv, const char *eventData, bool broadcast)
 {
     OsalTimespec time;
@@ -680,4 +767,118 @@ HWTEST_F(IoServiceTest, HdfIoService014, TestSize.Level0)
 
     HdfIoServiceRecycle(serv);
     HdfIoServiceRecycle(serv1);
-}
\ No newline at end of file
+}
+
+/* *
+ * @tc.name: HdfIoService015
+ * @tc.desc: event queue depth, drop policy and overflow counters
+ * @tc.type: FUNC
+ * @tc.require:
+ */
+HWTEST_F(IoServiceTest, HdfIoService015, TestSize.Level0)
+{
+    const uint32_t queueDepth = 4;
+    const uint32_t eventNum = 10;
+    struct HdfIoService *serv = HdfIoServiceBind(testSvcName);
+    ASSERT_NE(serv, nullptr);
+    serv->priv = (void *)"serv";
+
+    struct HdfEventQueueConfig config = { 0, HDF_EVENT_DROP_NEWEST };
+    EXPECT_NE(HDF_SUCCESS, HdfIoServiceSetEventQueue(serv, &config));
+    config.depth = HDF_EVENT_QUEUE_DEPTH_MAX + 1;
+    EXPECT_NE(HDF_SUCCESS, HdfIoServiceSetEventQueue(serv, &config));
+    config.depth = queueDepth;
+    config.dropPolicy = HDF_EVENT_DROP_POLICY_MAX;
+    EXPECT_NE(HDF_SUCCESS, HdfIoServiceSetEventQueue(serv, &config));
+
+    struct HdfEventQueueStats stats;
+    int ret = HdfIoServiceGetEventQueueStats(serv, &stats);
+    ASSERT_EQ(ret, HDF_SUCCESS);
+    ASSERT_EQ(stats.depth, (uint32_t)HDF_EVENT_QUEUE_DEPTH_DEFAULT);
+
+    config.dropPolicy = HDF_EVENT_DROP_NEWEST;
+    ret = HdfIoServiceSetEventQueue(serv, &config);
+    ASSERT_EQ(ret, HDF_SUCCESS);
+
+    ret = HdfDeviceRegisterEventListener(serv, &slowListener.listener);
+    ASSERT_EQ(ret, HDF_SUCCESS);
+
+    /* the listener takes the first event and blocks, the queue holds the next ones and drops the rest */
+    ret = SendEvent(serv, testSvcName, false);
+    ASSERT_EQ(ret, HDF_SUCCESS);
+    usleep(eventWaitTimeUs);
+    for (uint32_t i = 1; i < eventNum; i++) {
+        ret = SendEvent(serv, testSvcName, false);
+        ASSERT_EQ(ret, HDF_SUCCESS);
+    }
+    usleep(SLOW_LISTENER_BLOCK_US + eventWaitTimeUs);
+    ASSERT_EQ((int32_t)(queueDepth + 1), slowListener.eventCount);
+
+    ret = HdfIoServiceGetEventQueueStats(serv, &stats);
+    ASSERT_EQ(ret, HDF_SUCCESS);
+    EXPECT_EQ(stats.depth, queueDepth);
+    EXPECT_EQ(stats.count, 0u);
+    EXPECT_EQ(stats.maxCount, queueDepth);
+    EXPECT_EQ(stats.queued, queueDepth + 1);
+    EXPECT_EQ(stats.dropped, eventNum - queueDepth - 1);
+
+    ret = HdfDeviceUnregisterEventListener(serv, &slowListener.listener);
+    ASSERT_EQ(ret, HDF_SUCCESS);
+    HdfIoServiceRecycle(serv);
+}
+
+/* *
+ * @tc.name: HdfIoService016
+ * @tc.desc: broadcast to many listeners, one event payload for all of them
+ * @tc.type: PERF
+ * @tc.require:
+ */
+HWTEST_F(IoServiceTest, HdfIoService016, TestSize.Level1)
+{
+    struct HdfIoService *servs[BENCH_LISTENER_NUM] = { nullptr };
+    struct BenchEventlistener listeners[BENCH_LISTENER_NUM] = {};
+    struct HdfEventQueueStats before;
+    struct HdfEventQueueStats after;
+    int ret;
+
+    for (uint32_t i = 0; i < BENCH_LISTENER_NUM; i++) {
+        servs[i] = HdfIoServiceBind(testSvcName);
+        ASSERT_NE(servs[i], nullptr);
+        servs[i]->priv = (void *)"benchServ";
+        listeners[i].listener.onReceive = OnBenchEventReceived;
+        ret = HdfDeviceRegisterEventListener(servs[i], &listeners[i].listener);
+        ASSERT_EQ(ret, HDF_SUCCESS);
+    }
+
+    ret = HdfIoServiceGetEventQueueStats(servs[0], &before);
+    ASSERT_EQ(ret, HDF_SUCCESS);
+    for (uint32_t i = 0; i < BENCH_EVENT_NUM; i++) {
+        ret = SendStampEvent(servs[0], true);
+        ASSERT_EQ(ret, HDF_SUCCESS);
+    }
+    usleep(eventWaitTimeUs);
+    ret = HdfIoServiceGetEventQueueStats(servs[0], &after);
+    ASSERT_EQ(ret, HDF_SUCCESS);
+
+    uint32_t delivered = 0;
+    uint64_t totalLatencyUs = 0;
+    uint64_t maxLatencyUs = 0;
+    for (uint32_t i = 0; i < BENCH_LISTENER_NUM; i++) {
+        EXPECT_EQ(listeners[i].eventCount, (uint32_t)BENCH_EVENT_NUM);
+        delivered += listeners[i].eventCount;
+        totalLatencyUs += listeners[i].totalLatencyUs;
+        maxLatencyUs = (listeners[i].maxLatencyUs > maxLatencyUs) ? listeners[i].maxLatencyUs : maxLatencyUs;
+        ret = HdfDeviceUnregisterEventListener(servs[i], &listeners[i].listener);
+        EXPECT_EQ(ret, HDF_SUCCESS);
+        HdfIoServiceRecycle(servs[i]);
+    }
+
+    uint32_t allocs = after.eventAllocs - before.eventAllocs;
+    uint64_t copyBytes = after.copyBytes - before.copyBytes;
+    printf("%u listeners, %u events: %u payload allocs, %" PRIu64 " bytes copied, %u delivered, "
+        "latency avg %" PRIu64 "us max %" PRIu64 "us\n", BENCH_LISTENER_NUM, BENCH_EVENT_NUM, allocs, copyBytes,
+        delivered, (delivered == 0) ? 0 : totalLatencyUs / delivered, maxLatencyUs);
+    /* one payload per event whatever the number of listeners */
+    EXPECT_EQ(allocs, (uint32_t)BENCH_EVENT_NUM);
+    EXPECT_EQ(after.dropped, 0u);
+}
@@ -26,6 +26,8 @@ extern "C" {
 #define HDF_LISTEN_EVENT_STOP _IO('b', 4)
 #define HDF_LISTEN_EVENT_WAKEUP _IO('b', 5)
 #define HDF_LISTEN_EVENT_EXIT _IO('b', 6)
+#define HDF_LISTEN_EVENT_SET_QUEUE _IO('b', 7)
+#define HDF_LISTEN_EVENT_GET_STATS _IO('b', 8)
 
 typedef enum {
     DEVMGR_LOAD_SERVICE = 0,
@@ -135,6 +135,59 @@ struct HdfIoService {
     void* priv;
 };
 
+/** Default depth of the event queue of a driver service object */
+#define HDF_EVENT_QUEUE_DEPTH_DEFAULT 100
+/** Maximum depth of the event queue of a driver service object */
+#define HDF_EVENT_QUEUE_DEPTH_MAX 1024
+
+/**
+ * @brief Enumerates what the event queue of a driver service object does with an event arriving when it is full.
+ *
+ * @since 1.0
+ */
+enum HdfEventDropPolicy {
+    /** Drops the oldest queued event to queue the new one, which is the default */
+    HDF_EVENT_DROP_OLDEST = 0,
+    /** Keeps the queued events and drops the new one */
+    HDF_EVENT_DROP_NEWEST,
+    /** Maximum value of a drop policy */
+    HDF_EVENT_DROP_POLICY_MAX,
+};
+
+/**
+ * @brief Defines the event queue settings of a driver service object.
+ *
+ * @since 1.0
+ */
+struct HdfEventQueueConfig {
+    /** Events the queue holds, from 1 to {@link HDF_EVENT_QUEUE_DEPTH_MAX} */
+    uint32_t depth;
+    /** What to do when the queue is full, see {@link HdfEventDropPolicy} */
+    uint32_t dropPolicy;
+};
+
+/**
+ * @brief Defines the counters of the event queue of a driver service object.
+ *
+ * @since 1.0
+ */
+struct HdfEventQueueStats {
+    /** Events the queue holds */
+    uint32_t depth;
+    /** Events in the queue now */
+    uint32_t count;
+    /** Most events ever in the queue at once */
+    uint32_t maxCount;
+    /** Events queued since the driver service object was obtained */
+    uint32_t queued;
+    /** Events dropped as the queue was full */
+    uint32_t dropped;
+    /** Event payloads allocated by the driver service, one for each event reported whatever its listeners */
+    uint32_t eventAllocs;
+    /** Bytes copied into the event payloads by the driver service */
+    uint64_t copyBytes;
+};
+
 /**
  * @brief Defines a driver service group object.
  *
@@ -291,6 +344,32 @@ int HdfIoserviceGroupGetListenerCount(const struct HdfIoServiceGroup *group);
  */
 int HdfIoserviceGroupGetServiceCount(const struct HdfIoServiceGroup *group);
 
+/**
+ * @brief Sets the event queue of a driver service object, which holds the events reported
+ * by the driver service until the listeners take them.
+ *
+ * An event reported to several driver service objects is shared by their queues rather than copied for each.
+ * Events already queued are kept, the oldest ones dropped if they outnumber the new depth.
+ *
+ * @param service Indicates the pointer to the driver service object.
+ * @param config Indicates the pointer to the queue depth and drop policy to use.
+ * @return Returns <b>0</b> if the operation is successful; returns a negative value otherwise.
+ *
+ * @since 1.0
+ */
+int32_t HdfIoServiceSetEventQueue(struct HdfIoService *service, const struct HdfEventQueueConfig *config);
+
+/**
+ * @brief Obtains the counters of the event queue of a driver service object.
+ *
+ * @param service Indicates the pointer to the driver service object.
+ * @param stats Indicates the pointer to receive the counters.
+ * @return Returns <b>0</b> if the operation is successful; returns a negative value otherwise.
+ *
+ * @since 1.0
+ */
+int32_t HdfIoServiceGetEventQueueStats(struct HdfIoService *service, struct HdfEventQueueStats *stats);
+
 /**
  * @brief Obtains the names of device services of a specified device class defined by {@link DeviceClass}.
  *
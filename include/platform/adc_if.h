@@ -22,12 +22,51 @@ struct AdcIoMsg {
     uint32_t channel;
 };
 
+#define ADC_SCAN_CHANNEL_MAX    32         /* channels a scan can cover, one bit each in channelMask */
+#define ADC_SCAN_RATE_MAX       1000000    /* scans per second */
+#define ADC_SCAN_DEPTH_MAX      65536      /* scans the ring of a device can hold */
+#define ADC_SCAN_OVERSAMPLE_MAX 1024
+
+/* how the raw scans of an oversampled scan are reduced to the one stored */
+enum AdcScanReduce {
+    ADC_SCAN_REDUCE_AVERAGE = 0,    /* the mean of each channel */
+    ADC_SCAN_REDUCE_DECIMATE,       /* the first raw scan, the others are dropped */
+};
+
+struct AdcScanConfig {
+    uint32_t channelMask;    /* bit n set to sample channel n */
+    uint32_t rate;           /* raw scans per second */
+    uint32_t oversample;     /* raw scans reduced to each stored scan, 0 or 1 to store every raw scan */
+    uint32_t reduce;         /* enum AdcScanReduce */
+    uint32_t depth;          /* stored scans the ring holds, the oldest are overwritten when it is full */
+};
+
 DevHandle AdcOpen(uint32_t num);
 
 void AdcClose(DevHandle handle);
 
 int32_t AdcRead(DevHandle handle, uint32_t channel, uint32_t *val);
 
+/*
+ * Starts sampling a set of channels in the background, into a ring buffer of the device.
+ * Devices sampling through a hardware FIFO or DMA fill the ring themselves, the others are
+ * sampled by a thread of the core. Returns HDF_ERR_DEVICE_BUSY if a scan is running already.
+ */
+int32_t AdcStartScan(DevHandle handle, const struct AdcScanConfig *config);
+
+/*
+ * Stops the scan this handle started; AdcClose does so too. Returns HDF_ERR_DEVICE_BUSY if another
+ * handle of the device started it.
+ */
+int32_t AdcStopScan(DevHandle handle);
+
+/*
+ * Takes up to count scans from the ring without waiting. A scan is one sample of each channel
+ * of channelMask, lowest channel first, so buf holds count times that many values.
+ * Returns the number of scans read, or a negative value on error.
+ */
+int32_t AdcReadScan(DevHandle handle, uint32_t *buf, uint32_t count);
+
 #ifdef __cplusplus
 #if __cplusplus
 }
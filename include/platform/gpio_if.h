@@ -76,8 +76,12 @@ enum GpioIrqType {
     GPIO_IRQ_TRIGGER_HIGH = OSAL_IRQF_TRIGGER_HIGH,
     /** Low-level triggered */
     GPIO_IRQ_TRIGGER_LOW = OSAL_IRQF_TRIGGER_LOW,
-    /** execute interrupt service routine in thread context */
+    /** execute interrupt service routine in thread context, by a shared dispatch thread */
     GPIO_IRQ_USING_THREAD = (0x1 << 8),
+    /** with GPIO_IRQ_USING_THREAD, dispatch by the high priority thread */
+    GPIO_IRQ_THREAD_HIGH_PRI = (0x1 << 9),
+    /** with GPIO_IRQ_USING_THREAD, use a thread of its own, for routines which block for long */
+    GPIO_IRQ_THREAD_DEDICATED = (0x1 << 10),
 };
 
 /**
@@ -121,6 +125,35 @@ int32_t GpioRead(uint16_t gpio, uint16_t *val);
  */
 int32_t GpioWrite(uint16_t gpio, uint16_t val);
 
+/**
+ * @brief Writes the level values of several GPIO pins.
+ *
+ * Consecutive pins of the same controller are written by one access to the controller, which suits
+ * pins toggled together, such as a bit-banged bus. The pins need not be contiguous.
+ *
+ * @param gpios Indicates the GPIO pin numbers.
+ * @param vals Indicates the level values to be written, one per pin. For details, see {@link GpioValue}.
+ * @param count Indicates the number of pins.
+ *
+ * @return Returns <b>0</b> if all the values are successfully written; returns a negative value otherwise.
+ * @since 1.0
+ */
+int32_t GpioWriteMulti(const uint16_t *gpios, const uint16_t *vals, uint16_t count);
+
+/**
+ * @brief Reads the level values of several GPIO pins.
+ *
+ * Consecutive pins of the same controller are read by one access to the controller.
+ *
+ * @param gpios Indicates the GPIO pin numbers.
+ * @param vals Indicates the read level values, one per pin. For details, see {@link GpioValue}.
+ * @param count Indicates the number of pins.
+ *
+ * @return Returns <b>0</b> if all the values are successfully read; returns a negative value otherwise.
+ * @since 1.0
+ */
+int32_t GpioReadMulti(const uint16_t *gpios, uint16_t *vals, uint16_t count);
+
 /**
  * @brief Sets the input/output direction for a GPIO pin.
  *
@@ -37,6 +37,20 @@ extern "C" {
 #endif
 #endif /* __cplusplus */
 
+/**
+ * @brief Indicates the maximum number of messages in a transfer registered via {@link I2cTransferRegister}.
+ *
+ * @since 1.0
+ */
+#define I2C_XFER_MSG_MAX 32
+
+/**
+ * @brief Indicates the maximum total data length, in bytes, of a transfer registered via {@link I2cTransferRegister}.
+ *
+ * @since 1.0
+ */
+#define I2C_XFER_BUF_MAX 4096
+
 /**
  * @brief Defines the I2C transfer message used during custom transfers.
  *
@@ -136,6 +150,69 @@ void I2cClose(DevHandle handle);
  */
 int32_t I2cTransfer(DevHandle handle, struct I2cMsg *msgs, int16_t count);
 
+/**
+ * @brief Registers a transfer that is repeated many times, such as a sensor register poll.
+ *
+ * The message array and the buffers it points to are kept by reference and must remain valid until
+ * {@link I2cTransferUnregister} is called. Every {@link I2cTransferByHandle} call sends the current contents
+ * of the write buffers and fills the read buffers in place, without allocating memory.
+ *
+ * @param handle Indicates the pointer to the device handle of the I2C controller obtained via {@link I2cOpen}.
+ * @param msgs Indicates the pointer to the I2C transfer message structure array.
+ * @param count Indicates the length of the message structure array, at most {@link I2C_XFER_MSG_MAX}.
+ *
+ * @return Returns the handle of the registered transfer if the operation is successful;
+ * returns <b>NULL</b> otherwise.
+ * @attention A registered transfer must not be launched from several threads at the same time.
+ *
+ * @since 1.0
+ */
+DevHandle I2cTransferRegister(DevHandle handle, struct I2cMsg *msgs, int16_t count);
+
+/**
+ * @brief Launches a transfer registered via {@link I2cTransferRegister}.
+ *
+ * @param xfer Indicates the handle of the registered transfer.
+ *
+ * @return Returns the number of transferred message structures if the operation is successful;
+ * returns a negative value otherwise.
+ *
+ * @since 1.0
+ */
+int32_t I2cTransferByHandle(DevHandle xfer);
+
+/**
+ * @brief Releases a transfer registered via {@link I2cTransferRegister}.
+ *
+ * @param xfer Indicates the handle of the registered transfer.
+ *
+ * @since 1.0
+ */
+void I2cTransferUnregister(DevHandle xfer);
+
+/**
+ * @brief Defines the counters of the I2C manager service, used to profile user-space transfers.
+ *
+ * @since 1.0
+ */
+struct I2cIoStats {
+    /** Number of transfers handled by the I2C manager service */
+    uint32_t transfers;
+    /** Number of buffers the I2C manager service allocated for them */
+    uint32_t allocs;
+};
+
+/**
+ * @brief Obtains the counters of the I2C manager service.
+ *
+ * @param stats Indicates the pointer to the counters to fill.
+ *
+ * @return Returns <b>0</b> if the operation is successful; returns a negative value otherwise.
+ *
+ * @since 1.0
+ */
+int32_t I2cGetIoStats(struct I2cIoStats *stats);
+
 #ifdef __cplusplus
 #if __cplusplus
 }
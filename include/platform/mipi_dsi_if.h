@@ -265,6 +265,22 @@ void MipiDsiSetHsMode(DevHandle handle);
  */
 int32_t MipiDsiTx(DevHandle handle, struct DsiCmdDesc *cmd);
 
+/**
+ * @brief Sends a list of DCS commands, such as a panel init sequence, in one controller transaction.
+ *
+ * The delay of each command is honored before the next one is sent. Compared with calling
+ * {@link MipiDsiTx} for each command, the controller is locked only once for the whole list.
+ *
+ * @param handle Indicates the MIPI DSI device handle obtained via {@link MipiDsiOpen}.
+ * @param cmds Indicates the pointer to the commands to be sent.
+ * @param count Indicates the number of commands.
+ *
+ * @return Returns <b>0</b> if the operation is successful; returns a negative value otherwise.
+ *
+ * @since 1.0
+ */
+int32_t MipiDsiTxBatch(DevHandle handle, struct DsiCmdDesc *cmds, uint32_t count);
+
 /**
 * @brief Receives a DCS command used for reading data, such as the status and parameters of a peripheral
  *
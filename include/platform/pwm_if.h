@@ -94,6 +94,43 @@ struct PwmConfig {
                        */
 };
 
+/**
+ * @brief Indicates the maximum number of PWM devices updated together by {@link PwmSetConfigGroup}
+ * or driven by one {@link PwmSequence}.
+ *
+ * @since 1.0
+ */
+#define PWM_GROUP_MAX 16
+
+/**
+ * @brief Indicates the maximum number of steps of a {@link PwmSequence}.
+ *
+ * @since 1.0
+ */
+#define PWM_SEQUENCE_STEPS_MAX 65536
+
+/**
+ * @brief Indicates the longest time a step of a {@link PwmSequence} can be held, in microseconds.
+ *
+ * @since 1.0
+ */
+#define PWM_SEQUENCE_STEP_US_MAX 1000000
+
+/**
+ * @brief Defines a table of duty cycles played on a group of PWM devices at a fixed rate.
+ *
+ * Step <b>n</b> of the table holds one duty cycle for each device of the group, in the order of
+ * the handles passed to {@link PwmStartSequence}. The other parameters of the devices are kept.
+ *
+ * @since 1.0
+ */
+struct PwmSequence {
+    const uint32_t *duty; /**< Duty cycles, in nanoseconds, <b>steps</b> times the number of devices */
+    uint32_t steps;       /**< Number of steps in the table */
+    uint32_t stepUs;      /**< Time each step is held, in microseconds */
+    uint32_t loops;       /**< Number of times the table is played, <b>0</b> to repeat it until stopped */
+};
+
 /**
  * @brief Obtains the PWM device handle.
  *
@@ -199,6 +236,54 @@ int32_t PwmSetConfig(DevHandle handle, struct PwmConfig *config);
  */
 int32_t PwmGetConfig(DevHandle handle, struct PwmConfig *config);
 
+/**
+ * @brief Sets the configuration parameters of several PWM devices in one update.
+ *
+ * Devices of a controller that can latch its channels together change in the same period. Otherwise
+ * the devices are set one by one, and the ones already set are restored if one of them fails.
+ *
+ * @param handles Indicates the array of PWM device handles obtained via {@link PwmOpen}.
+ * @param configs Indicates the array of {@link PwmConfig} structures, one for each handle.
+ * @param count Indicates the number of devices, at most {@link PWM_GROUP_MAX}.
+ *
+ * @return Returns <b>0</b> if the operation is successful; returns a negative value otherwise.
+ *
+ * @since 1.0
+ */
+int32_t PwmSetConfigGroup(DevHandle *handles, const struct PwmConfig *configs, uint32_t count);
+
+/**
+ * @brief Starts playing a table of duty cycles on a group of PWM devices.
+ *
+ * The steps are applied in the background, as {@link PwmSetConfigGroup} would. A step that falls
+ * more than a whole step behind is skipped. The devices reject other configuration changes until
+ * {@link PwmStopSequence} is called, also after a sequence with a <b>loops</b> limit has finished.
+ *
+ * @param handles Indicates the array of PWM device handles obtained via {@link PwmOpen}.
+ * @param count Indicates the number of devices, at most {@link PWM_GROUP_MAX}.
+ * @param seq Indicates the pointer to the {@link PwmSequence} to play. The table is copied.
+ *
+ * @return Returns <b>0</b> if the operation is successful; returns <b>HDF_ERR_DEVICE_BUSY</b> if
+ * one of the devices is playing a sequence; returns a negative value otherwise.
+ *
+ * @since 1.0
+ */
+int32_t PwmStartSequence(DevHandle *handles, uint32_t count, const struct PwmSequence *seq);
+
+/**
+ * @brief Stops the sequence a PWM device is playing, for all the devices of its group.
+ *
+ * The devices keep the duty cycle of the last step played. If another caller is already stopping the
+ * sequence, waits until that stop has finished.
+ *
+ * @param handle Indicates the handle of any PWM device of the group.
+ *
+ * @return Returns <b>0</b> if the operation is successful; returns a negative value otherwise.
+ *
+ * @since 1.0
+ */
+int32_t PwmStopSequence(DevHandle handle);
+
 #ifdef __cplusplus
 #if __cplusplus
 }
@@ -29,6 +29,15 @@ enum RegulatorChangeMode {
     REGULATOR_CHANGE_VOLTAGE = 1,
     REGULATOR_CHANGE_CURRENT,
 };
+
+/* max entries of a power profile */
+#define REGULATOR_PROFILE_ENTRY_MAX 1024
+
+/* a regulator of a power profile and the status to set it to */
+struct RegulatorProfileEntry {
+    const char *name;
+    uint32_t status;    /* REGULATOR_STATUS_ON or REGULATOR_STATUS_OFF */
+};
 /**
  * @brief Gets a regulator.
  *
@@ -141,6 +150,21 @@ int32_t RegulatorGetCurrent(DevHandle handle, uint32_t *current);
  * @since 1.0
  */
 int32_t RegulatorGetStatus(DevHandle handle, uint32_t *status);
+/**
+ * @brief Applies a power profile, enabling and disabling a set of regulators in one pass.
+ *
+ * Regulators to disable are handled first, children before parents, then regulators to enable,
+ * parents before children. A parent left without an enabled child is disabled along with it.
+ *
+ * @param entries Represents the regulators and the status to set each of them to.
+ * @param count Indicates the number of entries, at most {@link REGULATOR_PROFILE_ENTRY_MAX}.
+ * @return <b>0</b> If the profile is applied successfully; Otherwise, a negative value is returned.
+ *
+ * @attention Nothing is changed if a regulator does not exist or a status is invalid.
+ *
+ * @since 1.0
+ */
+int32_t RegulatorApplyProfile(const struct RegulatorProfileEntry *entries, uint32_t count);
 #ifdef __cplusplus
 #if __cplusplus
 }
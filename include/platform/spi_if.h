@@ -166,6 +166,32 @@ struct SpiCfg {
     uint8_t bitsPerWord;     /**< Data transfer bit width */
 };
 
+struct SpiAsyncMsg;
+
+/**
+ * @brief Defines the callback of an asynchronous transfer.
+ *
+ * It is called in the context of the queue thread of the controller once the transfer is done.
+ *
+ * @param async Indicates the pointer to the completed request.
+ * @param status Indicates the result of the transfer, <b>0</b> on success.
+ *
+ * @since 1.0
+ */
+typedef void (*SpiAsyncFunc)(struct SpiAsyncMsg *async, int32_t status);
+
+/**
+ * @brief Defines an asynchronous transfer request.
+ *
+ * @since 1.0
+ */
+struct SpiAsyncMsg {
+    struct SpiMsg *msgs;   /**< Messages to transfer */
+    uint32_t count;        /**< Number of messages */
+    SpiAsyncFunc callback; /**< Called when the transfer is done */
+    void *priv;            /**< Private data of the caller */
+};
+
 /**
  * @brief Obtains the handle of an SPI device.
  *
@@ -200,6 +226,23 @@ void SpiClose(DevHandle handle);
  */
 int32_t SpiTransfer(DevHandle handle, struct SpiMsg *msgs, uint32_t count);
 
+/**
+ * @brief Queues a transfer to an SPI device and returns without waiting for it.
+ *
+ * The transfer is sent by the queue thread of the controller, which calls the callback of the request
+ * when it is done. Transfers of a device are sent in the order they are queued, and back to back
+ * with the other pending transfers of the device, so the controller is configured once for them.
+ *
+ * @param handle Indicates the pointer to the SPI device handle obtained via {@link SpiOpen}.
+ * @param async Indicates the pointer to the request, which must stay valid until its callback is called.
+ *
+ * @return Returns <b>0</b> if the transfer is queued; returns <b>HDF_ERR_QUEUE_FULL</b> if too many
+ * transfers of the controller are pending; returns a negative value otherwise.
+ * @see SpiAsyncMsg
+ * @since 1.0
+ */
+int32_t SpiTransferAsync(DevHandle handle, struct SpiAsyncMsg *async);
+
 /**
  * @brief Reads data of a specified length from an SPI device.
  *
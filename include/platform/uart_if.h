@@ -258,8 +258,36 @@ enum UartIoCmd {
     UART_IO_GET_ATTRIBUTE,   /**< Obtain the device attributes. */
     UART_IO_SET_ATTRIBUTE,   /**< Set the device attributes. */
     UART_IO_SET_TRANSMODE,   /**< Set the transmission mode. */
+    UART_IO_SET_BUFFER_CONFIG, /**< Set the receive ring and the write queue. */
+    UART_IO_FLUSH,           /**< Send the queued writes. */
 };
 
+/**
+ * @brief Defines the buffering of a UART port, which is set via {@link UartSetBufferConfig}.
+ *
+ * With a receive ring, the controller stores received data in the ring as it arrives, and {@link UartRead}
+ * returns at once what the ring holds, <b>0</b> if it is empty. With a write queue, small writes are
+ * collected and sent together.
+ *
+ * @since 1.0
+ */
+struct UartBufferConfig {
+    uint32_t rxRingSize;   /**< Bytes of the receive ring, a power of 2; <b>0</b> to read from the controller */
+    uint32_t rxWatermark;  /**< Bytes in the ring which raise {@link UART_EVENT_RX_WATERMARK}; <b>0</b> for none */
+    uint32_t txQueueSize;  /**< Bytes of the write queue; <b>0</b> to write through */
+    uint32_t txFlushDelay; /**< Milliseconds a queued write waits at most before it is sent */
+};
+
+/**
+ * @brief Indicates the event sent to the clients of a UART port when its receive ring reaches the watermark.
+ *
+ * The event data holds the number of bytes in the ring as a uint32. It is sent again only after
+ * the ring was read below the watermark.
+ *
+ * @since 1.0
+ */
+#define UART_EVENT_RX_WATERMARK 1
+
 /**
  * @brief Obtains the UART device handle.
  *
@@ -366,6 +394,31 @@ int32_t UartSetAttribute(DevHandle handle, struct UartAttribute *attribute);
  */
 int32_t UartSetTransMode(DevHandle handle, enum UartTransMode mode);
 
+/**
+ * @brief Sets the receive ring and the write queue of the UART port.
+ *
+ * Queued writes are sent before the configuration changes, and data left in the old ring is dropped.
+ * Do not call it while other threads read or write the port.
+ *
+ * @param handle Indicates the pointer to the UART device handle, which is obtained via {@link UartOpen}.
+ * @param config Indicates the pointer to the buffer configuration, see {@link UartBufferConfig}.
+ *
+ * @return Returns <b>0</b> if the setting is successful; returns <b>HDF_ERR_NOT_SUPPORT</b> if the controller
+ * can not fill a receive ring; returns a negative number otherwise.
+ * @since 1.0
+ */
+int32_t UartSetBufferConfig(DevHandle handle, const struct UartBufferConfig *config);
+
+/**
+ * @brief Sends the writes waiting in the write queue.
+ *
+ * @param handle Indicates the pointer to the UART device handle, which is obtained via {@link UartOpen}.
+ *
+ * @return Returns <b>0</b> if the queued data is successfully written; returns a negative number otherwise.
+ * @since 1.0
+ */
+int32_t UartFlush(DevHandle handle);
+
 #ifdef __cplusplus
 #if __cplusplus
 }
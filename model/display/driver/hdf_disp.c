@@ -655,6 +655,41 @@ static int32_t DispManagerInit(struct PanelManager *panelManager)
     return HDF_SUCCESS;
 }
 
+static void PowerOnWorkHandler(void *arg)
+{
+    uint32_t devId = (uint32_t)(uintptr_t)arg;
+
+    if (SetDispPower(devId, POWER_STATUS_ON) != HDF_SUCCESS) {
+        HDF_LOGE("%s: panel[%u] power on fail", __func__, devId);
+        return;
+    }
+    HDF_LOGI("%s: panel[%u] power on done", __func__, devId);
+}
+
+/*
+ * Panels that opt in with powerOnAtInit run their init command sequence on the
+ * disp work queue, so the probe of the remaining drivers does not wait on it.
+ */
+static void PanelPowerOnAsync(struct DispManager *disp)
+{
+    uint32_t i;
+    struct PanelData *panel = NULL;
+
+    for (i = 0; i < disp->panelManager->panelNum; i++) {
+        panel = disp->panelManager->panel[i];
+        if ((panel == NULL) || !panel->powerOnAtInit) {
+            continue;
+        }
+        if (HdfWorkInit(&disp->powerOnWork[i], PowerOnWorkHandler, (void *)(uintptr_t)i) != HDF_SUCCESS) {
+            HDF_LOGE("%s: panel[%u] HdfWorkInit fail", __func__, i);
+            continue;
+        }
+        if (!HdfAddWork(&disp->dispWorkQueue, &disp->powerOnWork[i])) {
+            HDF_LOGE("%s: panel[%u] HdfAddWork fail", __func__, i);
+        }
+    }
+}
+
 static int32_t HdfDispEntryInit(struct HdfDeviceObject *object)
 {
     int32_t ret;
@@ -674,6 +709,7 @@ static int32_t HdfDispEntryInit(struct HdfDeviceObject *object)
         HDF_LOGE("%s: DispManagerInit fail", __func__);
         return HDF_FAILURE;
     }
+    PanelPowerOnAsync(g_dispManager);
     HDF_LOGI("%s success", __func__);
     return HDF_SUCCESS;
 }
@@ -109,6 +109,7 @@ struct PanelData {
     enum PowerStatus powerStatus;
     struct PanelEsd *esd;
     struct BacklightDev *blDev;
+    bool powerOnAtInit; // power the panel up from the disp work queue once the disp manager is ready
     void *priv;
 };
 
@@ -161,6 +162,7 @@ struct DispManager {
     struct PanelManager *panelManager;
     struct OsalMutex dispMutex;
     HdfWorkQueue dispWorkQueue;
+    HdfWork powerOnWork[PANEL_MAX];
     bool initialzed;
     struct DispEsd *esd;
 };
@@ -78,20 +78,16 @@ static int32_t MipiDsiOn(void)
 {
     int32_t ret;
     struct PanelConfig *panelCfg = GetPanelCfg();
-    int32_t i;
 
     if (panelCfg->dsiHandle == NULL) {
         HDF_LOGE("%s:dsiHandle is null", __func__);
         return HDF_FAILURE;
     }
     /* send mipi init code */
-    int32_t count = panelCfg->onCmd.count;
-    for (i = 0; i < count; i++) {
-        ret = MipiDsiTx(panelCfg->dsiHandle, &(panelCfg->onCmd.dsiCmd[i]));
-        if (ret != HDF_SUCCESS) {
-            HDF_LOGE("%s:MipiDsiTx failed", __func__);
-            return ret;
-        }
+    ret = MipiDsiTxBatch(panelCfg->dsiHandle, panelCfg->onCmd.dsiCmd, panelCfg->onCmd.count);
+    if (ret != HDF_SUCCESS) {
+        HDF_LOGE("%s:MipiDsiTxBatch failed", __func__);
+        return ret;
     }
     /* set mipi to hs mode */
     MipiDsiSetHsMode(panelCfg->dsiHandle);
@@ -102,20 +98,16 @@ static int32_t MipiDsiOff(void)
 {
     int32_t ret;
     struct PanelConfig *panelCfg = GetPanelCfg();
-    int32_t i;
 
     if (panelCfg->dsiHandle == NULL) {
         HDF_LOGE("%s:dsiHandle is null", __func__);
         return HDF_FAILURE;
     }
     /* send mipi panel off code */
-    int32_t count = panelCfg->offCmd.count;
-    for (i = 0; i < count; i++) {
-        ret = MipiDsiTx(panelCfg->dsiHandle, &(panelCfg->offCmd.dsiCmd[i]));
-        if (ret != HDF_SUCCESS) {
-            HDF_LOGE("%s:MipiDsiTx failed", __func__);
-            return ret;
-        }
+    ret = MipiDsiTxBatch(panelCfg->dsiHandle, panelCfg->offCmd.dsiCmd, panelCfg->offCmd.count);
+    if (ret != HDF_SUCCESS) {
+        HDF_LOGE("%s:MipiDsiTxBatch failed", __func__);
+        return ret;
     }
     /* set mipi to lp mode */
     MipiDsiSetLpMode(panelCfg->dsiHandle);
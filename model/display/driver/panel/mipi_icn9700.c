@@ -191,16 +191,13 @@ static int32_t Icn9700On(struct PanelData *panel)
         return HDF_FAILURE;
     }
     /* send mipi init code */
-    int32_t count = sizeof(g_OnCmd) / sizeof(g_OnCmd[0]);
-    int32_t i;
+    uint32_t count = sizeof(g_OnCmd) / sizeof(g_OnCmd[0]);
     /* set mipi to lp mode */
     MipiDsiSetLpMode(icn9700->mipiHandle);
-    for (i = 0; i < count; i++) {
-        ret = MipiDsiTx(icn9700->mipiHandle, &(g_OnCmd[i]));
-        if (ret != HDF_SUCCESS) {
-            HDF_LOGE("%s: MipiDsiTx failed", __func__);
-            return HDF_FAILURE;
-        }
+    ret = MipiDsiTxBatch(icn9700->mipiHandle, g_OnCmd, count);
+    if (ret != HDF_SUCCESS) {
+        HDF_LOGE("%s: MipiDsiTxBatch failed", __func__);
+        return HDF_FAILURE;
     }
     /* set mipi to hs mode */
     MipiDsiSetHsMode(icn9700->mipiHandle);
@@ -222,16 +219,13 @@ static int32_t Icn9700Off(struct PanelData *panel)
         return HDF_FAILURE;
     }
     /* send mipi init code */
-    int32_t count = sizeof(g_offCmd) / sizeof(g_offCmd[0]);
-    int32_t i;
+    uint32_t count = sizeof(g_offCmd) / sizeof(g_offCmd[0]);
     /* set mipi to lp mode */
     MipiDsiSetLpMode(icn9700->mipiHandle);
-    for (i = 0; i < count; i++) {
-        ret = MipiDsiTx(icn9700->mipiHandle, &(g_offCmd[i]));
-        if (ret != HDF_SUCCESS) {
-            HDF_LOGE("%s: MipiDsiTx failed", __func__);
-            return HDF_FAILURE;
-        }
+    ret = MipiDsiTxBatch(icn9700->mipiHandle, g_offCmd, count);
+    if (ret != HDF_SUCCESS) {
+        HDF_LOGE("%s: MipiDsiTxBatch failed", __func__);
+        return HDF_FAILURE;
     }
     /* lcd reset power off */
     ret = LcdResetOff(icn9700);
@@ -287,6 +281,7 @@ static void Icn9700PanelInit(struct PanelData *panel)
     panel->init = Icn9700Init;
     panel->on = Icn9700On;
     panel->off = Icn9700Off;
+    panel->powerOnAtInit = true;
 }
 
 int32_t Icn9700EntryInit(struct HdfDeviceObject *object)
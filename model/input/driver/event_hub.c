@@ -12,59 +12,116 @@
 
 #define SEC_TO_USEC    1000000
 
-static void SendFramePackages(InputDevice *inputDev)
+void SendFramePackages(void *arg)
 {
-    struct HdfDeviceObject *hdfDev = inputDev->hdfDevObj;
-    if (hdfDev == NULL || inputDev->pkgBuf == NULL) {
-        HDF_LOGE("%s: hdf dev is null", __func__);
+    InputDevice *inputDev = (InputDevice *)arg;
+    struct HdfSBuf *frameBuf = NULL;
+    uint32_t flags = 0;
+
+    if (inputDev == NULL) {
         return;
     }
-    HdfDeviceSendEvent(hdfDev, 0, inputDev->pkgBuf);
+
+    while (true) {
+        (void)OsalSpinLockIrqSave(&inputDev->pkgLock, &flags);
+        if (inputDev->sendCount == 0) {
+            (void)OsalSpinUnlockIrqRestore(&inputDev->pkgLock, &flags);
+            break;
+        }
+        frameBuf = inputDev->frameBuf[inputDev->sendHead];
+        (void)OsalSpinUnlockIrqRestore(&inputDev->pkgLock, &flags);
+
+        if (inputDev->hdfDevObj == NULL) {
+            HDF_LOGE("%s: hdf dev is null", __func__);
+        } else {
+            HdfDeviceSendEvent(inputDev->hdfDevObj, 0, frameBuf);
+        }
+        HdfSbufFlush(frameBuf);
+
+        (void)OsalSpinLockIrqSave(&inputDev->pkgLock, &flags);
+        inputDev->sendHead = (inputDev->sendHead + 1) % INPUT_FRAME_BUF_NUM;
+        inputDev->sendCount--;
+        (void)OsalSpinUnlockIrqRestore(&inputDev->pkgLock, &flags);
+    }
 }
 
+/* called with pkgLock held, returns true when sendWork has to be scheduled */
+static bool CommitFramePackagesLocked(InputDevice *inputDev)
+{
+    uint8_t next;
+
+    /* the last free buffer is the one being built, so the frame cannot be queued without blocking */
+    if (inputDev->sendCount >= INPUT_FRAME_BUF_NUM - 1) {
+        inputDev->dropFrameCount++;
+        HdfSbufFlush(inputDev->pkgBuf);
+        return false;
+    }
+    inputDev->sendCount++;
+    next = (inputDev->sendHead + inputDev->sendCount) % INPUT_FRAME_BUF_NUM;
+    inputDev->pkgBuf = inputDev->frameBuf[next];
+    return true;
+}
+
+/*
+ * A device may report from more than one context, e.g. the HID report path and the key repeat timer,
+ * so the frame being built is guarded by the per-device pkgLock. Pushing never sleeps: completed frames
+ * are queued to sendWork, and a frame is dropped when every buffer is still waiting to be sent.
+ */
 void PushOnePackage(InputDevice *inputDev, uint32_t type, uint32_t code, int32_t value)
 {
     OsalTimespec time;
     EventPackage package = {0};
-    InputManager *g_inputManager = GetInputManager();
+    InputManager *inputManager = GetInputManager();
+    uint32_t flags = 0;
+    bool needSend = false;
 
-    if (inputDev == NULL) {
+    if (inputDev == NULL || inputDev->pkgBuf == NULL) {
         HDF_LOGE("%s: parm is null", __func__);
         return;
     }
-    OsalMutexLock(&g_inputManager->mutex);
+
+    (void)OsalSpinLockIrqSave(&inputDev->pkgLock, &flags);
+    if (inputDev->pkgCount == 0) {
+        OsalGetTime(&time);
+        inputDev->frameTime = time.sec * SEC_TO_USEC + time.usec;
+    }
     package.type = type;
     package.code = code;
     package.value = value;
-    OsalGetTime(&time);
-    package.time = time.sec * SEC_TO_USEC + time.usec;
+    package.time = inputDev->frameTime;
 
-    if (!HdfSbufWriteBuffer(inputDev->pkgBuf, &package, sizeof(EventPackage))) {
+    /* once the frame is broken nothing more is written, so the sbuf never has to grow under the lock */
+    if (!inputDev->errFrameFlag && !HdfSbufWriteBuffer(inputDev->pkgBuf, &package, sizeof(EventPackage))) {
         HDF_LOGE("%s: sbuf write pkg failed, clear sbuf", __func__);
         HdfSbufFlush(inputDev->pkgBuf);
         inputDev->errFrameFlag = true;
     }
     inputDev->pkgCount++;
 
-    if (inputDev->pkgCount >= inputDev->pkgNum) {
+    if (inputDev->pkgCount >= inputDev->pkgNum && !inputDev->errFrameFlag) {
         HDF_LOGE("%s: current pkgs num beyond the sbuf limit", __func__);
         inputDev->errFrameFlag = true;
     }
 
     if (type == EV_SYN && code == SYN_REPORT) {
-        if (!HdfSbufWriteBuffer(inputDev->pkgBuf, NULL, 0)) {
+        if (!inputDev->errFrameFlag && !HdfSbufWriteBuffer(inputDev->pkgBuf, NULL, 0)) {
             HDF_LOGE("%s: sbuf write null pkg failed, clear sbuf", __func__);
-            HdfSbufFlush(inputDev->pkgBuf);
             inputDev->errFrameFlag = true;
         }
 
         if (!inputDev->errFrameFlag) {
-            SendFramePackages(inputDev);
+            needSend = CommitFramePackagesLocked(inputDev);
+        } else {
+            HdfSbufFlush(inputDev->pkgBuf);
         }
 
         inputDev->pkgCount = 0;
-        HdfSbufFlush(inputDev->pkgBuf);
         inputDev->errFrameFlag = false;
     }
-    OsalMutexUnlock(&g_inputManager->mutex);
-}
\ No newline at end of file
+    (void)OsalSpinUnlockIrqRestore(&inputDev->pkgLock, &flags);
+
+    /* a work already queued drains every committed frame, so a failed add loses nothing */
+    if (needSend && inputManager != NULL) {
+        (void)HdfAddWork(&inputManager->workQueue, &inputDev->sendWork);
+    }
+}
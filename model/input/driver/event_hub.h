@@ -26,6 +26,7 @@ typedef struct {
     uint64_t time;
 } EventPackage;
 
+void SendFramePackages(void *arg);
 void PushOnePackage(InputDevice *inputDev, uint32_t type, uint32_t code, int32_t value);
 
 static inline void ReportAbs(InputDevice *inputDev, uint32_t code, int32_t value)
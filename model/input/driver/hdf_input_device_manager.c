@@ -201,9 +201,26 @@ EXIT:
 #define DEFAULT_ROCKER_BUF_PKG_NUM     40
 #define DEFAULT_TRACKBALL_BUF_PKG_NUM  30
 
+/* every package is written with a length word, and a frame ends with an empty buffer */
+#define INPUT_FRAME_SBUF_SIZE(pkgNum)  ((sizeof(EventPackage) + sizeof(uint32_t)) * ((pkgNum) + 1))
+
+static void FreePackageBuffer(InputDevice *inputDev)
+{
+    uint32_t i;
+
+    for (i = 0; i < INPUT_FRAME_BUF_NUM; i++) {
+        if (inputDev->frameBuf[i] != NULL) {
+            HdfSBufRecycle(inputDev->frameBuf[i]);
+            inputDev->frameBuf[i] = NULL;
+        }
+    }
+    inputDev->pkgBuf = NULL;
+}
+
 static int32_t AllocPackageBuffer(InputDevice *inputDev)
 {
     uint16_t pkgNum;
+    uint32_t i;
     switch (inputDev->devType) {
         case INDEV_TYPE_TOUCH:
             pkgNum = DEFAULT_TOUCH_BUF_PKG_NUM;
@@ -233,16 +250,36 @@ static int32_t AllocPackageBuffer(InputDevice *inputDev)
             HDF_LOGE("%s: devType not exist", __func__);
             return HDF_FAILURE;
     }
-    inputDev->pkgBuf = HdfSBufObtain(sizeof(EventPackage) * pkgNum);
-    if (inputDev->pkgBuf == NULL) {
-        HDF_LOGE("%s: malloc sbuf failed", __func__);
-        return HDF_ERR_MALLOC_FAIL;
+    for (i = 0; i < INPUT_FRAME_BUF_NUM; i++) {
+        inputDev->frameBuf[i] = HdfSBufObtain(INPUT_FRAME_SBUF_SIZE(pkgNum));
+        if (inputDev->frameBuf[i] == NULL) {
+            HDF_LOGE("%s: malloc sbuf failed", __func__);
+            FreePackageBuffer(inputDev);
+            return HDF_ERR_MALLOC_FAIL;
+        }
+    }
+    if (OsalSpinInit(&inputDev->pkgLock) != HDF_SUCCESS) {
+        HDF_LOGE("%s: init pkg lock failed", __func__);
+        FreePackageBuffer(inputDev);
+        return HDF_FAILURE;
+    }
+    if (HdfWorkInit(&inputDev->sendWork, SendFramePackages, inputDev) != HDF_SUCCESS) {
+        HDF_LOGE("%s: init send work failed", __func__);
+        (void)OsalSpinDestroy(&inputDev->pkgLock);
+        FreePackageBuffer(inputDev);
+        return HDF_FAILURE;
     }
     inputDev->eventBuf = HdfSBufObtain(sizeof(HotPlugEvent));
     if (inputDev->eventBuf == NULL) {
         HDF_LOGE("%s: malloc sbuf failed", __func__);
+        HdfWorkDestroy(&inputDev->sendWork);
+        (void)OsalSpinDestroy(&inputDev->pkgLock);
+        FreePackageBuffer(inputDev);
         return HDF_ERR_MALLOC_FAIL;
     }
+    inputDev->pkgBuf = inputDev->frameBuf[0];
+    inputDev->sendHead = 0;
+    inputDev->sendCount = 0;
     inputDev->pkgNum = pkgNum;
     return HDF_SUCCESS;
 }
@@ -337,9 +374,13 @@ void UnregisterInputDevice(InputDevice *inputDev)
         goto EXIT;
     }
 
+    /* let the frames already reported leave the ring before tearing it down */
+    (void)HdfCancelWorkSync(&inputDev->sendWork);
+    SendFramePackages(inputDev);
+    HdfWorkDestroy(&inputDev->sendWork);
+    (void)OsalSpinDestroy(&inputDev->pkgLock);
     DeleteDeviceNode(inputDev);
-    HdfSBufRecycle(inputDev->pkgBuf);
-    inputDev->pkgBuf = NULL;
+    FreePackageBuffer(inputDev);
     ret = DeleteInputDevice(inputDev);
     if (ret != HDF_SUCCESS) {
         goto EXIT;
@@ -442,6 +483,13 @@ static int32_t HdfInputManagerInit(struct HdfDeviceObject *device)
         g_inputManager = NULL;
         return HDF_FAILURE;
     }
+    if (HdfWorkQueueInit(&g_inputManager->workQueue, INPUT_EVENT_WORK_QUEUE_NAME) != HDF_SUCCESS) {
+        HDF_LOGE("%s: work queue init failed", __func__);
+        OsalMutexDestroy(&g_inputManager->mutex);
+        OsalMemFree(g_inputManager);
+        g_inputManager = NULL;
+        return HDF_FAILURE;
+    }
     g_inputManager->initialized = true;
     g_inputManager->hdfDevObj = device;
     HDF_LOGI("%s: exit succ", __func__);
@@ -455,6 +503,7 @@ static void HdfInputManagerRelease(struct HdfDeviceObject *device)
         return;
     }
     if (g_inputManager != NULL) {
+        HdfWorkQueueDestroy(&g_inputManager->workQueue);
         OsalMutexDestroy(&g_inputManager->mutex);
         OsalMemFree(g_inputManager);
         g_inputManager = NULL;
@@ -11,7 +11,9 @@
 
 #include "input-event-codes.h"
 #include "osal_mutex.h"
+#include "osal_spinlock.h"
 #include "hdf_types.h"
+#include "hdf_workqueue.h"
 #include "hdf_device_desc.h"
 
 #ifdef HDF_LOG_TAG
@@ -21,6 +23,8 @@
 #define INPUT_DEV_PATH_LEN 64
 #define MAX_INPUT_DEV_NUM  32
 #define DEV_NAME_LEN 64
+#define INPUT_EVENT_WORK_QUEUE_NAME "hdf_input_event_queue"
+#define INPUT_FRAME_BUF_NUM 3
 #define ONLINE    0
 #define OFFLINE   1
 
@@ -107,7 +111,14 @@ typedef struct InputDeviceInfo {
     uint16_t pkgNum;
     uint16_t pkgCount;
     bool errFrameFlag;
-    struct HdfSBuf *pkgBuf;
+    uint64_t frameTime;          /* timestamp shared by all packages of the frame being built */
+    OsalSpinlock pkgLock;        /* guards the frame being built and the frame ring */
+    struct HdfSBuf *pkgBuf;      /* frame being built, always frameBuf[(sendHead + sendCount) % num] */
+    struct HdfSBuf *frameBuf[INPUT_FRAME_BUF_NUM];
+    uint8_t sendHead;            /* oldest completed frame not sent yet */
+    uint8_t sendCount;           /* completed frames queued to sendWork */
+    uint32_t dropFrameCount;     /* frames dropped because every buffer was still being sent */
+    HdfWork sendWork;
     struct HdfSBuf *eventBuf;
     void *pvtData;
     DevAttr attrSet;
@@ -119,6 +130,7 @@ typedef struct {
     struct HdfDeviceObject *hdfDevObj;
     uint32_t devCount;
     struct OsalMutex mutex;
+    HdfWorkQueue workQueue;
     bool initialized;
     InputDevice *inputDevList;
 } InputManager;
@@ -19,6 +19,9 @@
 #define MAX_TOUCH_DEVICE 5
 #define REGISTER_BYTE_SIZE 4
 #define TOUCH_CHIP_NAME_LEN 10
+#define TOUCH_IRQ_THREAD_NAME "touch_irq_thread"
+#define TOUCH_IRQ_THREAD_STACK_SIZE 0x2000
+#define SEC_TO_USEC 1000000
 
 
 static TouchDriver *g_touchDriverList[MAX_TOUCH_DEVICE];
@@ -184,25 +187,72 @@ static void EventHandle(TouchDriver *driver, ChipDevice *chipDev)
     }
 }
 
+/*
+ * Top half: only stamp the interrupt and hand the bus work over to the irq thread. Masking the line
+ * takes the gpio manager lock, which is not irq safe, so the irq thread does it.
+ */
 static int32_t IrqHandle(uint16_t intGpioNum, void *data)
 {
     TouchDriver *driver = (TouchDriver *)data;
-    int ret = GpioDisableIrq(intGpioNum);
-    if (ret != HDF_SUCCESS) {
-        HDF_LOGE("%s: disable irq failed, ret %d", __func__, ret);
-        return HDF_FAILURE;
-    }
 
-    EventHandle(driver, driver->device);
+    (void)intGpioNum;
+    (void)OsalGetTime(&driver->irqTime);
+    (void)OsalSemPost(&driver->irqSem);
+    return HDF_SUCCESS;
+}
 
-    ret = GpioEnableIrq(intGpioNum);
-    if (ret != HDF_SUCCESS) {
-        HDF_LOGE("%s: enable irq failed, ret %d", __func__, ret);
-        return HDF_FAILURE;
+static int TouchIrqThread(void *arg)
+{
+    TouchDriver *driver = (TouchDriver *)arg;
+    ChipDevice *chipDev = NULL;
+    uint16_t intGpioNum;
+    int32_t ret;
+
+    while (driver->irqThreadRunning) {
+        if (OsalSemWait(&driver->irqSem, HDF_WAIT_FOREVER) != HDF_SUCCESS || !driver->irqThreadRunning) {
+            continue;
+        }
+        chipDev = driver->device;
+        if (chipDev == NULL) {
+            continue;
+        }
+
+        /* keep the line masked until the chip has been drained */
+        intGpioNum = chipDev->boardCfg->pins.intGpio;
+        (void)GpioDisableIrq(intGpioNum);
+        EventHandle(driver, chipDev);
+
+        ret = GpioEnableIrq(intGpioNum);
+        if (ret != HDF_SUCCESS) {
+            HDF_LOGE("%s: enable irq failed, ret %d", __func__, ret);
+        }
     }
+    (void)OsalSemPost(&driver->irqExited);
     return HDF_SUCCESS;
 }
 
+static void TouchTraceLatency(TouchDriver *driver)
+{
+    OsalTimespec now;
+    OsalTimespec diff;
+    uint32_t latencyUs;
+    TouchLatencyStat *stat = &driver->latency;
+
+    (void)OsalGetTime(&now);
+    if (OsalDiffTime(&driver->irqTime, &now, &diff) != HDF_SUCCESS) {
+        return;
+    }
+    latencyUs = (uint32_t)(diff.sec * SEC_TO_USEC + diff.usec);
+
+    stat->frameCount++;
+    stat->lastUs = latencyUs;
+    stat->totalUs += latencyUs;
+    if (latencyUs > stat->maxUs) {
+        stat->maxUs = latencyUs;
+    }
+    HDF_LOGD("%s: irq to sync %u us, max %u us, frames %u", __func__, latencyUs, stat->maxUs, stat->frameCount);
+}
+
 static void InputFrameReport(TouchDriver *driver)
 {
     InputDevice *dev = driver->inputDev;
@@ -226,6 +276,68 @@ static void InputFrameReport(TouchDriver *driver)
     }
     OsalMutexUnlock(&driver->mutex);
     input_sync(dev);
+    TouchTraceLatency(driver);
+}
+
+static int32_t StartIrqThread(TouchDriver *driver)
+{
+    int32_t ret;
+    struct OsalThreadParam param = {
+        .name = TOUCH_IRQ_THREAD_NAME,
+        .stackSize = TOUCH_IRQ_THREAD_STACK_SIZE,
+        .priority = OSAL_THREAD_PRI_HIGHEST,
+    };
+
+    if (driver->irqThreadRunning) {
+        return HDF_SUCCESS;
+    }
+
+    ret = OsalSemInit(&driver->irqSem, 0);
+    if (ret != HDF_SUCCESS) {
+        HDF_LOGE("%s: init irq sem failed, ret %d", __func__, ret);
+        return ret;
+    }
+    ret = OsalSemInit(&driver->irqExited, 0);
+    if (ret != HDF_SUCCESS) {
+        HDF_LOGE("%s: init irq exit sem failed, ret %d", __func__, ret);
+        (void)OsalSemDestroy(&driver->irqSem);
+        return ret;
+    }
+    ret = OsalThreadCreate(&driver->irqThread, TouchIrqThread, driver);
+    if (ret != HDF_SUCCESS) {
+        HDF_LOGE("%s: create irq thread failed, ret %d", __func__, ret);
+        (void)OsalSemDestroy(&driver->irqExited);
+        (void)OsalSemDestroy(&driver->irqSem);
+        return ret;
+    }
+    driver->irqThreadRunning = true;
+    ret = OsalThreadStart(&driver->irqThread, &param);
+    if (ret != HDF_SUCCESS) {
+        HDF_LOGE("%s: start irq thread failed, ret %d", __func__, ret);
+        driver->irqThreadRunning = false;
+        (void)OsalThreadDestroy(&driver->irqThread);
+        (void)OsalSemDestroy(&driver->irqExited);
+        (void)OsalSemDestroy(&driver->irqSem);
+        return ret;
+    }
+    return HDF_SUCCESS;
+}
+
+static void StopIrqThread(TouchDriver *driver)
+{
+    if (!driver->irqThreadRunning) {
+        return;
+    }
+    if (driver->device != NULL) {
+        (void)GpioUnSetIrq(driver->device->boardCfg->pins.intGpio);
+    }
+    driver->irqThreadRunning = false;
+    (void)OsalSemPost(&driver->irqSem);
+    /* the thread may still be in EventHandle or waiting on irqSem, let it leave before the sems go */
+    (void)OsalSemWait(&driver->irqExited, HDF_WAIT_FOREVER);
+    (void)OsalThreadDestroy(&driver->irqThread);
+    (void)OsalSemDestroy(&driver->irqExited);
+    (void)OsalSemDestroy(&driver->irqSem);
 }
 
 static int32_t SetupChipIrq(ChipDevice *chipDev)
@@ -238,11 +350,14 @@ static int32_t SetupChipIrq(ChipDevice *chipDev)
         HDF_LOGE("%s: invalid param", __func__);
         return HDF_FAILURE;
     }
-    irqFlag |= GPIO_IRQ_USING_THREAD;
+    ret = StartIrqThread(chipDev->driver);
+    CHECK_RETURN_VALUE(ret);
+
     HDF_LOGD("%s: gpioNum = %u, irqFlag = %u", __func__, intGpioNum, irqFlag);
     ret = GpioSetIrq(intGpioNum, irqFlag, IrqHandle, chipDev->driver);
     if (ret != 0) {
         HDF_LOGE("%s: register irq failed, ret %d", __func__, ret);
+        StopIrqThread(chipDev->driver);
         return ret;
     }
 
@@ -773,6 +888,7 @@ static void HdfTouchDriverRelease(struct HdfDeviceObject *device)
         }
     }
 
+    StopIrqThread(driver);
     if (inputDev != NULL) {
         UnregisterInputDevice(inputDev);
         driver->inputDev = NULL;
@@ -10,6 +10,8 @@
 #define HDF_TOUCH_H
 
 #include <securec.h>
+#include "osal_sem.h"
+#include "osal_thread.h"
 #include "osal_time.h"
 #include "hdf_input_device_manager.h"
 #include "input_config.h"
@@ -60,6 +62,13 @@ typedef struct {
     OsalTimespec time;
 } FrameData;
 
+typedef struct {
+    uint32_t frameCount;
+    uint32_t lastUs;    /* irq to input_sync latency of the latest frame */
+    uint32_t maxUs;
+    uint64_t totalUs;
+} TouchLatencyStat;
+
 struct TouchChipDevice;
 typedef struct TouchPlatformDriver {
     struct HdfDeviceObject *hdfTouchDev;
@@ -75,6 +84,12 @@ typedef struct TouchPlatformDriver {
     uint32_t gestureMode;
     bool initedFlag;
     bool irqStopFlag;
+    struct OsalThread irqThread;
+    struct OsalSem irqSem;
+    struct OsalSem irqExited;  /* posted by the irq thread when it leaves */
+    volatile bool irqThreadRunning;
+    OsalTimespec irqTime;    /* captured by the top half of the interrupt being handled */
+    TouchLatencyStat latency;
 } TouchDriver;
 
 struct TouchChipOps;
@@ -128,16 +128,18 @@ static void ParsePointData(ChipDevice *device, FrameData *frame, uint8_t *buf, u
 static int32_t ChipDataHandle(ChipDevice *device)
 {
     int32_t ret;
-    uint8_t touchStatus = 0;
+    uint8_t touchStatus;
     uint8_t pointNum;
-    uint8_t buf[GT_POINT_SIZE * MAX_SUPPORT_POINT] = {0};
+    uint8_t buf[GT_STATUS_LEN + GT_POINT_SIZE * MAX_SUPPORT_POINT] = {0};
     InputI2cClient *i2cClient = &device->driver->i2cClient;
     uint8_t reg[GT_ADDR_LEN] = {0};
     FrameData *frame = &device->driver->frameData;
 
+    /* status and all point slots are adjacent, fetch them in one transfer */
     reg[0] = (GT_BUF_STATE_ADDR >> ONE_BYTE_OFFSET) & ONE_BYTE_MASK;
     reg[1] = GT_BUF_STATE_ADDR & ONE_BYTE_MASK;
-    ret = InputI2cRead(i2cClient, reg, GT_ADDR_LEN, &touchStatus, 1);
+    ret = InputI2cRead(i2cClient, reg, GT_ADDR_LEN, buf, sizeof(buf));
+    touchStatus = buf[0];
     if (ret < 0 || touchStatus == GT_EVENT_INVALID) {
         return HDF_FAILURE;
     }
@@ -150,8 +152,6 @@ static int32_t ChipDataHandle(ChipDevice *device)
         goto EXIT;
     }
 
-    reg[0] = (GT_X_LOW_BYTE_BASE >> ONE_BYTE_OFFSET) & ONE_BYTE_MASK;
-    reg[1] = GT_X_LOW_BYTE_BASE & ONE_BYTE_MASK;
     pointNum = touchStatus & GT_FINGER_NUM_MASK;
     if (pointNum == 0 || pointNum > MAX_SUPPORT_POINT) {
         HDF_LOGE("%s: pointNum is invalid, %u", __func__, pointNum);
@@ -161,8 +161,7 @@ static int32_t ChipDataHandle(ChipDevice *device)
     }
     frame->realPointNum = pointNum;
     frame->definedEvent = TOUCH_DOWN;
-    (void)InputI2cRead(i2cClient, reg, GT_ADDR_LEN, buf, GT_POINT_SIZE * pointNum);
-    ParsePointData(device, frame, buf, pointNum);
+    ParsePointData(device, frame, buf + GT_STATUS_LEN, pointNum);
 
 EXIT:
     OsalMutexUnlock(&device->driver->mutex);
@@ -25,6 +25,7 @@
 #define GT_ADDR_LEN           2
 #define GT_BUF_STATE_ADDR     0x814E
 #define GT_X_LOW_BYTE_BASE    0x814F
+#define GT_STATUS_LEN         1     /* point data follows the status byte */
 #define GT_FINGER_NUM_MASK    0x0F
 #define GT_CLEAN_DATA_LEN     3
 #define GT_REG_HIGH_POS       0
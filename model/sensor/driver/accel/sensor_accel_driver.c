@@ -10,7 +10,6 @@
 #include <securec.h>
 #include "hdf_base.h"
 #include "hdf_device_desc.h"
-#include "osal_math.h"
 #include "osal_mem.h"
 #include "sensor_config_controller.h"
 #include "sensor_device_manager.h"
@@ -18,7 +17,6 @@
 
 #define HDF_LOG_TAG    sensor_accel_driver_c
 
-#define HDF_ACCEL_WORK_QUEUE_NAME    "hdf_accel_work_queue"
 
 static struct AccelDrvData *g_accelDrvData = NULL;
 
@@ -57,37 +55,8 @@ static void AccelDataWorkEntry(void *arg)
     }
 }
 
-static void AccelTimerEntry(uintptr_t arg)
-{
-    int64_t interval;
-    int32_t ret;
-    struct AccelDrvData *drvData = (struct AccelDrvData *)arg;
-    CHECK_NULL_PTR_RETURN(drvData);
-
-    if (!HdfAddWork(&drvData->accelWorkQueue, &drvData->accelWork)) {
-        HDF_LOGE("%s: Accel add work queue failed", __func__);
-    }
-
-    interval = OsalDivS64(drvData->interval, (SENSOR_CONVERT_UNIT * SENSOR_CONVERT_UNIT));
-    interval = (interval < SENSOR_TIMER_MIN_TIME) ? SENSOR_TIMER_MIN_TIME : interval;
-    ret = OsalTimerSetTimeout(&drvData->accelTimer, interval);
-    if (ret != HDF_SUCCESS) {
-        HDF_LOGE("%s: Accel modify time failed", __func__);
-    }
-}
-
 static int32_t InitAccelData(struct AccelDrvData *drvData)
 {
-    if (HdfWorkQueueInit(&drvData->accelWorkQueue, HDF_ACCEL_WORK_QUEUE_NAME) != HDF_SUCCESS) {
-        HDF_LOGE("%s: Accel init work queue failed", __func__);
-        return HDF_FAILURE;
-    }
-
-    if (HdfWorkInit(&drvData->accelWork, AccelDataWorkEntry, drvData) != HDF_SUCCESS) {
-        HDF_LOGE("%s: Accel create thread failed", __func__);
-        return HDF_FAILURE;
-    }
-
     drvData->interval = SENSOR_TIMER_MIN_TIME;
     drvData->enable = false;
     drvData->detectFlag = false;
@@ -114,15 +83,14 @@ static int32_t SetAccelEnable(void)
         return ret;
     }
 
-    ret = OsalTimerCreate(&drvData->accelTimer, SENSOR_TIMER_MIN_TIME, AccelTimerEntry, (uintptr_t)drvData);
-    if (ret != HDF_SUCCESS) {
-        HDF_LOGE("%s: Accel create timer failed[%d]", __func__, ret);
-        return ret;
+    if (drvData->accelCfg->busCfg.irqCfg.enable) {
+        ret = SensorSchedStartIrq(&drvData->accelSchedNode, &drvData->accelCfg->busCfg.irqCfg, AccelDataWorkEntry,
+            drvData);
+    } else {
+        ret = SensorSchedStart(&drvData->accelSchedNode, AccelDataWorkEntry, drvData, drvData->interval);
     }
-
-    ret = OsalTimerStartLoop(&drvData->accelTimer);
     if (ret != HDF_SUCCESS) {
-        HDF_LOGE("%s: Accel start timer failed[%d]", __func__, ret);
+        HDF_LOGE("%s: Accel start sched failed[%d]", __func__, ret);
         return ret;
     }
     drvData->enable = true;
@@ -149,9 +117,9 @@ static int32_t SetAccelDisable(void)
         return ret;
     }
 
-    ret = OsalTimerDelete(&drvData->accelTimer);
+    ret = SensorSchedStop(&drvData->accelSchedNode);
     if (ret != HDF_SUCCESS) {
-        HDF_LOGE("%s: Accel delete timer failed", __func__);
+        HDF_LOGE("%s: Accel stop sched failed", __func__);
         return ret;
     }
     drvData->enable = false;
@@ -169,6 +137,9 @@ static int32_t SetAccelBatch(int64_t samplingInterval, int64_t interval)
     CHECK_NULL_PTR_RETURN_VALUE(drvData, HDF_ERR_INVALID_PARAM);
 
     drvData->interval = samplingInterval;
+    if (drvData->enable) {
+        return SensorSchedSetInterval(&drvData->accelSchedNode, samplingInterval);
+    }
 
     return HDF_SUCCESS;
 }
@@ -346,6 +317,9 @@ void AccelReleaseDriver(struct HdfDeviceObject *device)
     struct AccelDrvData *drvData = (struct AccelDrvData *)device->service;
     CHECK_NULL_PTR_RETURN(drvData);
 
+    /* stop the reads first, they use the cfg freed below */
+    (void)SensorSchedStop(&drvData->accelSchedNode);
+
     if (drvData->detectFlag && drvData->accelCfg != NULL) {
         AccelReleaseCfgData(drvData->accelCfg);
     }
@@ -353,8 +327,6 @@ void AccelReleaseDriver(struct HdfDeviceObject *device)
     OsalMemFree(drvData->accelCfg);
     drvData->accelCfg = NULL;
 
-    HdfWorkDestroy(&drvData->accelWork);
-    HdfWorkQueueDestroy(&drvData->accelWorkQueue);
     OsalMemFree(drvData);
 }
 
@@ -9,11 +9,10 @@
 #ifndef SENSOR_ACCEL_DRIVER_H
 #define SENSOR_ACCEL_DRIVER_H
 
-#include "hdf_workqueue.h"
 #include "osal_mutex.h"
-#include "osal_timer.h"
 #include "sensor_config_parser.h"
 #include "sensor_platform_if.h"
+#include "sensor_sched.h"
 
 enum AccelAxisNum {
     ACCEL_X_AXIS   = 0,
@@ -46,9 +45,7 @@ struct AccelOpsCall {
 struct AccelDrvData {
     struct IDeviceIoService ioService;
     struct HdfDeviceObject *device;
-    HdfWorkQueue accelWorkQueue;
-    HdfWork accelWork;
-    OsalTimer accelTimer;
+    struct SensorSchedNode accelSchedNode;
     bool detectFlag;
     bool enable;
     int64_t interval;
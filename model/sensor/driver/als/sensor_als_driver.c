@@ -9,7 +9,6 @@
 #include "sensor_als_driver.h"
 #include <securec.h>
 #include "als_bh1745.h"
-#include "osal_math.h"
 #include "osal_mem.h"
 #include "sensor_config_controller.h"
 #include "sensor_device_manager.h"
@@ -17,7 +16,6 @@
 
 #define HDF_LOG_TAG    sensor_als_driver_c
 
-#define HDF_ALS_WORK_QUEUE_NAME    "hdf_als_work_queue"
 
 static struct AlsDrvData *g_alsDrvData = NULL;
 
@@ -56,37 +54,8 @@ static void AlsDataWorkEntry(void *arg)
     }
 }
 
-static void AlsTimerEntry(uintptr_t arg)
-{
-    int64_t interval;
-    int32_t ret;
-    struct AlsDrvData *drvData = (struct AlsDrvData *)arg;
-    CHECK_NULL_PTR_RETURN(drvData);
-
-    if (!HdfAddWork(&drvData->alsWorkQueue, &drvData->alsWork)) {
-        HDF_LOGE("%s: Als add work queue failed", __func__);
-    }
-
-    interval = OsalDivS64(drvData->interval, (SENSOR_CONVERT_UNIT * SENSOR_CONVERT_UNIT));
-    interval = (interval < SENSOR_TIMER_MIN_TIME) ? SENSOR_TIMER_MIN_TIME : interval;
-    ret = OsalTimerSetTimeout(&drvData->alsTimer, interval);
-    if (ret != HDF_SUCCESS) {
-        HDF_LOGE("%s: Als modify time failed", __func__);
-    }
-}
-
 static int32_t InitAlsData(struct AlsDrvData *drvData)
 {
-    if (HdfWorkQueueInit(&drvData->alsWorkQueue, HDF_ALS_WORK_QUEUE_NAME) != HDF_SUCCESS) {
-        HDF_LOGE("%s: Als init work queue failed", __func__);
-        return HDF_FAILURE;
-    }
-
-    if (HdfWorkInit(&drvData->alsWork, AlsDataWorkEntry, drvData) != HDF_SUCCESS) {
-        HDF_LOGE("%s: Als create thread failed", __func__);
-        return HDF_FAILURE;
-    }
-
     drvData->interval = SENSOR_TIMER_MIN_TIME;
     drvData->enable = false;
     drvData->detectFlag = false;
@@ -113,15 +82,9 @@ static int32_t SetAlsEnable(void)
         return ret;
     }
 
-    ret = OsalTimerCreate(&drvData->alsTimer, SENSOR_TIMER_MIN_TIME, AlsTimerEntry, (uintptr_t)drvData);
+    ret = SensorSchedStart(&drvData->alsSchedNode, AlsDataWorkEntry, drvData, drvData->interval);
     if (ret != HDF_SUCCESS) {
-        HDF_LOGE("%s: Als create timer failed[%d]", __func__, ret);
-        return ret;
-    }
-
-    ret = OsalTimerStartLoop(&drvData->alsTimer);
-    if (ret != HDF_SUCCESS) {
-        HDF_LOGE("%s: Als start timer failed[%d]", __func__, ret);
+        HDF_LOGE("%s: Als start sched failed[%d]", __func__, ret);
         return ret;
     }
     drvData->enable = true;
@@ -148,9 +111,9 @@ static int32_t SetAlsDisable(void)
         return ret;
     }
 
-    ret = OsalTimerDelete(&drvData->alsTimer);
+    ret = SensorSchedStop(&drvData->alsSchedNode);
     if (ret != HDF_SUCCESS) {
-        HDF_LOGE("%s: Als delete timer failed", __func__);
+        HDF_LOGE("%s: Als stop sched failed", __func__);
         return ret;
     }
     drvData->enable = false;
@@ -168,6 +131,9 @@ static int32_t SetAlsBatch(int64_t samplingInterval, int64_t interval)
     CHECK_NULL_PTR_RETURN_VALUE(drvData, HDF_ERR_INVALID_PARAM);
 
     drvData->interval = samplingInterval;
+    if (drvData->enable) {
+        return SensorSchedSetInterval(&drvData->alsSchedNode, samplingInterval);
+    }
 
     return HDF_SUCCESS;
 }
@@ -346,6 +312,9 @@ void AlsReleaseDriver(struct HdfDeviceObject *device)
     struct AlsDrvData *drvData = (struct AlsDrvData *)device->service;
     CHECK_NULL_PTR_RETURN(drvData);
 
+    /* stop the reads first, they use the cfg freed below */
+    (void)SensorSchedStop(&drvData->alsSchedNode);
+
     if (drvData->detectFlag && drvData->alsCfg != NULL) {
         AlsReleaseCfgData(drvData->alsCfg);
     }
@@ -353,8 +322,6 @@ void AlsReleaseDriver(struct HdfDeviceObject *device)
     OsalMemFree(drvData->alsCfg);
     drvData->alsCfg = NULL;
 
-    HdfWorkDestroy(&drvData->alsWork);
-    HdfWorkQueueDestroy(&drvData->alsWorkQueue);
     OsalMemFree(drvData);
 }
 
@@ -9,10 +9,9 @@
 #ifndef SENSOR_ALS_DRIVER_H
 #define SENSOR_ALS_DRIVER_H
 
-#include "hdf_workqueue.h"
-#include "osal_timer.h"
 #include "sensor_config_parser.h"
 #include "sensor_platform_if.h"
+#include "sensor_sched.h"
 
 #define ALS_DEFAULT_SAMPLING_200_MS    200000000
 #define ALS_CHIP_NAME_BH1745    "bh1745"
@@ -52,9 +51,7 @@ struct AlsOpsCall {
 struct AlsDrvData {
     struct IDeviceIoService ioService;
     struct HdfDeviceObject *device;
-    HdfWorkQueue alsWorkQueue;
-    HdfWork alsWork;
-    OsalTimer alsTimer;
+    struct SensorSchedNode alsSchedNode;
     bool detectFlag;
     bool enable;
     int64_t interval;
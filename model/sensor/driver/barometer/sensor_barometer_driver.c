@@ -10,7 +10,6 @@
 #include <securec.h>
 #include "hdf_base.h"
 #include "hdf_device_desc.h"
-#include "osal_math.h"
 #include "osal_mem.h"
 #include "sensor_config_controller.h"
 #include "sensor_device_manager.h"
@@ -18,7 +17,6 @@
 
 #define HDF_LOG_TAG    sensor_barometer_driver_c
 
-#define HDF_BAROMETER_WORK_QUEUE_NAME    "hdf_barometer_work_queue"
 
 static struct BarometerDrvData *g_barometerDrvData = NULL;
 
@@ -57,37 +55,8 @@ static void BarometerDataWorkEntry(void *arg)
     }
 }
 
-static void BarometerTimerEntry(uintptr_t arg)
-{
-    int64_t interval;
-    int32_t ret;
-    struct BarometerDrvData *drvData = (struct BarometerDrvData *)arg;
-    CHECK_NULL_PTR_RETURN(drvData);
-
-    if (!HdfAddWork(&drvData->barometerWorkQueue, &drvData->barometerWork)) {
-        HDF_LOGE("%s: barometer add work queue failed", __func__);
-    }
-
-    interval = OsalDivS64(drvData->interval, (SENSOR_CONVERT_UNIT * SENSOR_CONVERT_UNIT));
-    interval = (interval < SENSOR_TIMER_MIN_TIME) ? SENSOR_TIMER_MIN_TIME : interval;
-    ret = OsalTimerSetTimeout(&drvData->barometerTimer, interval);
-    if (ret != HDF_SUCCESS) {
-        HDF_LOGE("%s: barometer modify time failed", __func__);
-    }
-}
-
 static int32_t InitBarometerData(struct BarometerDrvData *drvData)
 {
-    if (HdfWorkQueueInit(&drvData->barometerWorkQueue, HDF_BAROMETER_WORK_QUEUE_NAME) != HDF_SUCCESS) {
-        HDF_LOGE("%s: barometer init work queue failed", __func__);
-        return HDF_FAILURE;
-    }
-
-    if (HdfWorkInit(&drvData->barometerWork, BarometerDataWorkEntry, drvData) != HDF_SUCCESS) {
-        HDF_LOGE("%s: barometer create thread failed", __func__);
-        return HDF_FAILURE;
-    }
-
     drvData->interval = SENSOR_TIMER_MIN_TIME;
     drvData->enable = false;
     drvData->detectFlag = false;
@@ -114,15 +83,9 @@ static int32_t SetBarometerEnable(void)
         return ret;
     }
 
-    ret = OsalTimerCreate(&drvData->barometerTimer, SENSOR_TIMER_MIN_TIME, BarometerTimerEntry, (uintptr_t)drvData);
+    ret = SensorSchedStart(&drvData->barometerSchedNode, BarometerDataWorkEntry, drvData, drvData->interval);
     if (ret != HDF_SUCCESS) {
-        HDF_LOGE("%s: barometer create timer failed[%d]", __func__, ret);
-        return ret;
-    }
-
-    ret = OsalTimerStartLoop(&drvData->barometerTimer);
-    if (ret != HDF_SUCCESS) {
-        HDF_LOGE("%s: barometer start timer failed[%d]", __func__, ret);
+        HDF_LOGE("%s: barometer start sched failed[%d]", __func__, ret);
         return ret;
     }
     drvData->enable = true;
@@ -150,9 +113,9 @@ static int32_t SetBarometerDisable(void)
         return ret;
     }
 
-    ret = OsalTimerDelete(&drvData->barometerTimer);
+    ret = SensorSchedStop(&drvData->barometerSchedNode);
     if (ret != HDF_SUCCESS) {
-        HDF_LOGE("%s: barometer delete timer failed", __func__);
+        HDF_LOGE("%s: barometer stop sched failed", __func__);
         return ret;
     }
     drvData->enable = false;
@@ -169,6 +132,9 @@ static int32_t SetBarometerBatch(int64_t samplingInterval, int64_t interval)
     CHECK_NULL_PTR_RETURN_VALUE(drvData, HDF_ERR_INVALID_PARAM);
 
     drvData->interval = samplingInterval;
+    if (drvData->enable) {
+        return SensorSchedSetInterval(&drvData->barometerSchedNode, samplingInterval);
+    }
 
     return HDF_SUCCESS;
 }
@@ -347,6 +313,9 @@ void BarometerReleaseDriver(struct HdfDeviceObject *device)
     struct BarometerDrvData *drvData = (struct BarometerDrvData *)device->service;
     CHECK_NULL_PTR_RETURN(drvData);
 
+    /* stop the reads first, they use the cfg freed below */
+    (void)SensorSchedStop(&drvData->barometerSchedNode);
+
     if (drvData->detectFlag && drvData->barometerCfg != NULL) {
         BarometerReleaseCfgData(drvData->barometerCfg);
     }
@@ -354,8 +323,6 @@ void BarometerReleaseDriver(struct HdfDeviceObject *device)
     OsalMemFree(drvData->barometerCfg);
     drvData->barometerCfg = NULL;
 
-    HdfWorkDestroy(&drvData->barometerWork);
-    HdfWorkQueueDestroy(&drvData->barometerWorkQueue);
     OsalMemFree(drvData);
 }
 
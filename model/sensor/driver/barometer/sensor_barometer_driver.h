@@ -9,10 +9,9 @@
 #ifndef SENSOR_BAROMETER_DRIVER_H
 #define SENSOR_BAROMETER_DRIVER_H
 
-#include "hdf_workqueue.h"
-#include "osal_timer.h"
 #include "sensor_config_parser.h"
 #include "sensor_platform_if.h"
+#include "sensor_sched.h"
 
 #define BAR_DEFAULT_SAMPLING_200_MS    200000000
 #define BAROMETER_CHIP_NAME_BMP180    "bmp180"
@@ -102,9 +101,7 @@ struct BarometerOpsCall {
 struct BarometerDrvData {
     struct IDeviceIoService ioService;
     struct HdfDeviceObject *device;
-    HdfWorkQueue barometerWorkQueue;
-    HdfWork barometerWork;
-    OsalTimer barometerTimer;
+    struct SensorSchedNode barometerSchedNode;
     bool detectFlag;
     bool enable;
     int64_t interval;
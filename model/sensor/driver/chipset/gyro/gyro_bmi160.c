@@ -30,6 +30,7 @@ struct Bmi160DrvData *Bmi160GetDrvData(void)
 
 static int32_t ReadBmi160GyroRawData(struct SensorCfgData *data, struct GyroData *rawData, int64_t *timestamp)
 {
+    int32_t ret;
     uint8_t status = 0;
     uint8_t reg[GYRO_AXIS_BUTT];
     OsalTimespec time;
@@ -39,15 +40,21 @@ static int32_t ReadBmi160GyroRawData(struct SensorCfgData *data, struct GyroData
 
     CHECK_NULL_PTR_RETURN_VALUE(data, HDF_ERR_INVALID_PARAM);
 
-    if (OsalGetTime(&time) != HDF_SUCCESS) {
-        HDF_LOGE("%s: Get time failed", __func__);
-        return HDF_FAILURE;
-    }
-    *timestamp = time.sec * SENSOR_SECOND_CONVERT_NANOSECOND + time.usec * SENSOR_CONVERT_UNIT; /* unit nanosecond */
-
-    int32_t ret = ReadSensor(&data->busCfg, BMI160_STATUS_ADDR, &status, sizeof(uint8_t));
-    if (!(status & BMI160_GYRO_DATA_READY_MASK) || (ret != HDF_SUCCESS)) {
-        return HDF_FAILURE;
+    if (data->busCfg.irqCfg.enable) {
+        /* the data-ready interrupt has already signalled this sample, skip the status register */
+        *timestamp = data->busCfg.irqCfg.timestamp;
+    } else {
+        if (OsalGetTime(&time) != HDF_SUCCESS) {
+            HDF_LOGE("%s: Get time failed", __func__);
+            return HDF_FAILURE;
+        }
+        *timestamp = time.sec * SENSOR_SECOND_CONVERT_NANOSECOND +
+            time.usec * SENSOR_CONVERT_UNIT; /* unit nanosecond */
+
+        ret = ReadSensor(&data->busCfg, BMI160_STATUS_ADDR, &status, sizeof(uint8_t));
+        if (!(status & BMI160_GYRO_DATA_READY_MASK) || (ret != HDF_SUCCESS)) {
+            return HDF_FAILURE;
+        }
     }
 
     ret = ReadSensor(&data->busCfg, BMI160_GYRO_X_LSB_ADDR, &reg[GYRO_X_AXIS_LSB], sizeof(uint8_t));
@@ -28,6 +28,7 @@ struct Lsm303DrvData *Lsm303GetDrvData(void)
 
 static int32_t ReadLsm303RawData(struct SensorCfgData *data, struct MagneticData *rawData, int64_t *timestamp)
 {
+    int32_t ret;
     uint8_t status = 0;
     uint8_t reg[MAGNETIC_AXIS_BUTT];
     OsalTimespec time;
@@ -36,18 +37,23 @@ static int32_t ReadLsm303RawData(struct SensorCfgData *data, struct MagneticData
     (void)memset_s(reg, sizeof(reg), 0, sizeof(reg));
 
     CHECK_NULL_PTR_RETURN_VALUE(data, HDF_ERR_INVALID_PARAM);
-   
-    if (OsalGetTime(&time) != HDF_SUCCESS) {
-        HDF_LOGE("%s: Get time failed", __func__);
-        return HDF_FAILURE;
-    }
-    *timestamp = time.sec * SENSOR_SECOND_CONVERT_NANOSECOND + time.usec * SENSOR_CONVERT_UNIT; /* unit nanosecond */
 
-    int32_t ret = ReadSensor(&data->busCfg, LSM303_STATUS_ADDR, &status, sizeof(uint8_t));
-    if (!(status & LSM303_DATA_READY_MASK) || (ret != HDF_SUCCESS)) {
-        HDF_LOGE("%s: data status [%u] ret [%d]", __func__, status, ret);
-        
-        return HDF_FAILURE;
+    if (data->busCfg.irqCfg.enable) {
+        /* the data-ready interrupt has already signalled this sample, skip the status register */
+        *timestamp = data->busCfg.irqCfg.timestamp;
+    } else {
+        if (OsalGetTime(&time) != HDF_SUCCESS) {
+            HDF_LOGE("%s: Get time failed", __func__);
+            return HDF_FAILURE;
+        }
+        *timestamp = time.sec * SENSOR_SECOND_CONVERT_NANOSECOND +
+            time.usec * SENSOR_CONVERT_UNIT; /* unit nanosecond */
+
+        ret = ReadSensor(&data->busCfg, LSM303_STATUS_ADDR, &status, sizeof(uint8_t));
+        if (!(status & LSM303_DATA_READY_MASK) || (ret != HDF_SUCCESS)) {
+            HDF_LOGE("%s: data status [%u] ret [%d]", __func__, status, ret);
+            return HDF_FAILURE;
+        }
     }
 
     ret = ReadSensor(&data->busCfg, LSM303_MAGNETIC_X_MSB_ADDR, &reg[MAGNETIC_X_AXIS_MSB], sizeof(uint8_t));
@@ -37,7 +37,22 @@ struct SensorOpsCall {
     int32_t (*ops)(struct SensorBusCfg *busCfg, struct SensorRegCfg *cfgItem);
 };
 
-int32_t SetSensorRegCfgArray(struct SensorBusCfg *busCfg, const struct SensorRegCfgGroupNode *group);
+struct SensorRegCfgStep {
+    struct SensorRegCfg *cfgItem; // first item covered by this step
+    uint8_t *burstBuf;            // regAddr followed by the values of merged consecutive writes
+    uint16_t burstLen;
+    uint16_t delay;               // ms to wait after the step, taken from the last merged item
+};
+
+struct SensorRegCfgPlan {
+    uint16_t stepNum;
+    struct SensorRegCfgStep *steps;
+    uint8_t *burstPool;
+};
+
+int32_t CompileSensorRegCfgPlan(struct SensorBusCfg *busCfg, struct SensorRegCfgGroupNode *group);
+int32_t SetSensorRegCfgArray(struct SensorBusCfg *busCfg, struct SensorRegCfgGroupNode *group);
+void ReleaseSensorRegCfgPlan(struct SensorRegCfgGroupNode *group);
 int32_t SetSensorRegCfgArrayByBuff(struct SensorBusCfg *busCfg, const struct SensorRegCfgGroupNode *group, uint8_t *buff, int16_t len);
 
 #endif /* SENSOR_CONFIG_CONTROLLER_H */
\ No newline at end of file
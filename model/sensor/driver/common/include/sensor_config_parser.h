@@ -61,9 +61,12 @@ struct SensorRegCfg {
     uint32_t save : 2;
 };
 
+struct SensorRegCfgPlan;
+
 struct SensorRegCfgGroupNode {
     uint8_t itemNum;
     struct SensorRegCfg *regCfgItem;
+    struct SensorRegCfgPlan *plan; // compiled when the config is parsed, see ParseSensorRegGroup
 };
 
 struct SensorCfgData {
@@ -0,0 +1,67 @@
+/*
+ * Copyright (c) 2021 Huawei Device Co., Ltd.
+ *
+ * HDF is dual licensed: you can use it either under the terms of
+ * the GPL, or the BSD license, at your option.
+ * See the LICENSE file in the root of this repository for complete details.
+ */
+
+#ifndef SENSOR_SCHED_H
+#define SENSOR_SCHED_H
+
+#include "hdf_dlist.h"
+#include "hdf_workqueue.h"
+#include "osal_mutex.h"
+#include "osal_timer.h"
+#include "sensor_platform_if.h"
+
+#define HDF_SENSOR_SCHED_WORK_QUEUE_NAME    "hdf_sensor_sched_queue"
+#define SENSOR_SCHED_MIN_PERIOD_MS          5
+#define SENSOR_SCHED_GROUP_SLACK_MS         2
+
+typedef void (*SensorSchedReadFunc)(void *arg);
+
+/*
+ * One sampling client of the shared scheduler, embedded in the sensor driver data.
+ * All fields are owned by the scheduler once the node has been started.
+ */
+struct SensorSchedNode {
+    struct DListHead entry;
+    SensorSchedReadFunc read;
+    void *arg;
+    int64_t period;   // ms
+    int64_t deadline; // ms, absolute on the OsalGetSysTimeMs time base
+    bool active;
+    struct SensorIrqCfg *irqCfg; // set while the node is driven by its data-ready interrupt
+    HdfWork irqWork;
+};
+
+struct SensorSchedStats {
+    uint32_t wakeups;  // timer expirations handled by the sched worker
+    uint32_t reads;    // sensor reads dispatched, one wakeup each with per-driver timers
+    uint32_t irqReads; // sensor reads triggered by data-ready interrupts
+};
+
+struct SensorSchedData {
+    struct DListHead nodeHead;
+    struct OsalMutex mutex;
+    HdfWorkQueue workQueue;
+    HdfWork work;
+    OsalTimer timer;
+    bool timerRunning;
+    uint32_t activeNum;
+    int64_t nextDeadline;
+    struct SensorSchedStats stats;
+};
+
+int32_t SensorSchedInit(void);
+void SensorSchedRelease(void);
+int32_t SensorSchedStart(struct SensorSchedNode *node, SensorSchedReadFunc read, void *arg,
+    int64_t samplingInterval);
+int32_t SensorSchedStartIrq(struct SensorSchedNode *node, struct SensorIrqCfg *irqCfg, SensorSchedReadFunc read,
+    void *arg);
+int32_t SensorSchedStop(struct SensorSchedNode *node);
+int32_t SensorSchedSetInterval(struct SensorSchedNode *node, int64_t samplingInterval);
+void SensorSchedGetStats(struct SensorSchedStats *stats);
+
+#endif /* SENSOR_SCHED_H */
@@ -50,19 +50,25 @@ static uint32_t GetSensorRegRealValueMask(struct SensorRegCfg *cfgItem, uint32_t
     return mask;
 }
 
-static int32_t SensorOpsWrite(struct SensorBusCfg *busCfg, struct SensorRegCfg *cfgItem)
+static uint8_t GetSensorRegWriteValue(struct SensorBusCfg *busCfg, struct SensorRegCfg *cfgItem)
 {
-    uint8_t value[SENSOR_VALUE_BUTT];
-    int32_t ret = HDF_FAILURE;
     uint32_t originValue;
-    uint32_t busMask = 0xffff;
+    uint32_t busMask;
     uint32_t mask;
 
     busMask = (busCfg->i2cCfg.regWidth == SENSOR_ADDR_WIDTH_1_BYTE) ? 0x00ff : 0xffff;
     mask = GetSensorRegRealValueMask(cfgItem, &originValue, busMask);
 
+    return (uint8_t)(originValue & mask);
+}
+
+static int32_t SensorOpsWrite(struct SensorBusCfg *busCfg, struct SensorRegCfg *cfgItem)
+{
+    uint8_t value[SENSOR_VALUE_BUTT];
+    int32_t ret = HDF_FAILURE;
+
     value[SENSOR_ADDR_INDEX] = cfgItem->regAddr;
-    value[SENSOR_VALUE_INDEX] = originValue & mask;
+    value[SENSOR_VALUE_INDEX] = GetSensorRegWriteValue(busCfg, cfgItem);
 
     ret = WriteSensor(busCfg, value, sizeof(value));
     CHECK_PARSER_RESULT_RETURN_VALUE(ret, "write i2c reg");
@@ -210,34 +216,127 @@ static struct SensorOpsCall g_doOpsCall[] = {
     { SENSOR_OPS_TYPE_EXTBUFF_WRITE,               SensorOpsExtBuffWrite },
 };
 
-int32_t SetSensorRegCfgArray(struct SensorBusCfg *busCfg, const struct SensorRegCfgGroupNode *group)
+static bool SensorRegCfgCanMerge(struct SensorBusCfg *busCfg, struct SensorRegCfg *prev, struct SensorRegCfg *cur,
+    uint16_t runLen)
 {
-    int32_t num = 0;
-    uint32_t count;
-    struct SensorRegCfg *cfgItem = NULL;
+    if (busCfg->regBurstWrite == 0 || runLen >= LENGTH_NUMBER) {
+        return false;
+    }
+    if (busCfg->busType == SENSOR_BUS_I2C && busCfg->i2cCfg.regWidth != SENSOR_ADDR_WIDTH_1_BYTE) {
+        return false;
+    }
 
-    CHECK_NULL_PTR_RETURN_VALUE(busCfg, HDF_FAILURE);
-    CHECK_NULL_PTR_RETURN_VALUE(group, HDF_FAILURE);
-    CHECK_NULL_PTR_RETURN_VALUE(group->regCfgItem, HDF_FAILURE);
+    return (prev->opsType == SENSOR_OPS_TYPE_WRITE) && (cur->opsType == SENSOR_OPS_TYPE_WRITE) &&
+        (prev->delay == 0) && (cur->regAddr == prev->regAddr + 1);
+}
 
-    count = sizeof(g_doOpsCall) / sizeof(g_doOpsCall[0]);
+void ReleaseSensorRegCfgPlan(struct SensorRegCfgGroupNode *group)
+{
+    if (group == NULL || group->plan == NULL) {
+        return;
+    }
+
+    OsalMemFree(group->plan->burstPool);
+    OsalMemFree(group->plan->steps);
+    OsalMemFree(group->plan);
+    group->plan = NULL;
+}
+
+/*
+ * Turn the hcs item list into execution steps once: runs of writes to consecutive registers are
+ * folded into one bus transfer, everything else stays a single step that goes through g_doOpsCall.
+ */
+int32_t CompileSensorRegCfgPlan(struct SensorBusCfg *busCfg, struct SensorRegCfgGroupNode *group)
+{
+    uint16_t num = 0;
+    uint16_t run;
+    uint16_t index;
+    uint32_t poolOffset = 0;
+    uint32_t count = sizeof(g_doOpsCall) / sizeof(g_doOpsCall[0]);
+    struct SensorRegCfg *cfgItem = NULL;
+    struct SensorRegCfgStep *step = NULL;
+    struct SensorRegCfgPlan *plan = NULL;
+
+    CHECK_NULL_PTR_RETURN_VALUE(busCfg, HDF_ERR_INVALID_PARAM);
+    CHECK_NULL_PTR_RETURN_VALUE(group, HDF_ERR_INVALID_PARAM);
+    CHECK_NULL_PTR_RETURN_VALUE(group->regCfgItem, HDF_ERR_INVALID_PARAM);
+
+    ReleaseSensorRegCfgPlan(group);
+    plan = (struct SensorRegCfgPlan *)OsalMemCalloc(sizeof(*plan));
+    CHECK_NULL_PTR_RETURN_VALUE(plan, HDF_ERR_MALLOC_FAIL);
+    plan->steps = (struct SensorRegCfgStep *)OsalMemCalloc(sizeof(*plan->steps) * group->itemNum);
+    plan->burstPool = (uint8_t *)OsalMemCalloc(SENSOR_VALUE_BUTT * group->itemNum);
+    if (plan->steps == NULL || plan->burstPool == NULL) {
+        HDF_LOGE("%s: malloc sensor reg config plan failed", __func__);
+        OsalMemFree(plan->steps);
+        OsalMemFree(plan->burstPool);
+        OsalMemFree(plan);
+        return HDF_ERR_MALLOC_FAIL;
+    }
 
     while (num < group->itemNum) {
-        cfgItem = (group->regCfgItem + num);
+        cfgItem = group->regCfgItem + num;
         if (cfgItem->opsType >= count) {
             HDF_LOGE("%s: cfg item para invalid", __func__);
             break;
         }
-        if ((g_doOpsCall[cfgItem->opsType].ops != NULL) && (cfgItem->opsType <= SENSOR_OPS_TYPE_UPDATE_BITWISE)) {
+
+        step = &plan->steps[plan->stepNum++];
+        step->cfgItem = cfgItem;
+        step->delay = cfgItem->delay;
+
+        run = 1;
+        while ((num + run < group->itemNum) && SensorRegCfgCanMerge(busCfg, cfgItem + run - 1, cfgItem + run, run)) {
+            run++;
+        }
+        if (run > 1) {
+            step->burstBuf = plan->burstPool + poolOffset;
+            step->burstBuf[SENSOR_ADDR_INDEX] = cfgItem->regAddr;
+            for (index = 0; index < run; ++index) {
+                step->burstBuf[SENSOR_VALUE_INDEX + index] = GetSensorRegWriteValue(busCfg, cfgItem + index);
+            }
+            step->burstLen = run + 1;
+            step->delay = (cfgItem + run - 1)->delay;
+            poolOffset += step->burstLen;
+        }
+        num += run;
+    }
+
+    group->plan = plan;
+    HDF_LOGD("%s: %u reg config items compiled to %u steps", __func__, group->itemNum, plan->stepNum);
+    return HDF_SUCCESS;
+}
+
+int32_t SetSensorRegCfgArray(struct SensorBusCfg *busCfg, struct SensorRegCfgGroupNode *group)
+{
+    uint16_t num;
+    struct SensorRegCfgStep *step = NULL;
+    struct SensorRegCfg *cfgItem = NULL;
+
+    CHECK_NULL_PTR_RETURN_VALUE(busCfg, HDF_FAILURE);
+    CHECK_NULL_PTR_RETURN_VALUE(group, HDF_FAILURE);
+    CHECK_NULL_PTR_RETURN_VALUE(group->regCfgItem, HDF_FAILURE);
+    CHECK_NULL_PTR_RETURN_VALUE(group->plan, HDF_FAILURE);
+
+    for (num = 0; num < group->plan->stepNum; ++num) {
+        step = &group->plan->steps[num];
+        cfgItem = step->cfgItem;
+        if (step->burstBuf != NULL) {
+            if (WriteSensor(busCfg, step->burstBuf, step->burstLen) != HDF_SUCCESS) {
+                HDF_LOGE("%s: burst write reg[0x%x] len[%u] failed", __func__, cfgItem->regAddr, step->burstLen);
+                return HDF_FAILURE;
+            }
+        } else if ((g_doOpsCall[cfgItem->opsType].ops != NULL) &&
+            (cfgItem->opsType <= SENSOR_OPS_TYPE_UPDATE_BITWISE)) {
             if (g_doOpsCall[cfgItem->opsType].ops(busCfg, cfgItem) != HDF_SUCCESS) {
                 HDF_LOGE("%s: malloc sensor reg config item data failed", __func__);
                 return HDF_FAILURE;
             }
         }
-        if (cfgItem->delay != 0) {
-            OsalMDelay(cfgItem->delay);
+        /* reg config groups are only applied from thread context, so sleep instead of spinning */
+        if (step->delay != 0) {
+            OsalMSleep(step->delay);
         }
-        num++;
     }
 
     return HDF_SUCCESS;
@@ -9,7 +9,9 @@
 #include "sensor_config_parser.h"
 #include <securec.h>
 #include "device_resource_if.h"
+#include "osal_irq.h"
 #include "osal_mem.h"
+#include "sensor_config_controller.h"
 #include "sensor_platform_if.h"
 
 #define HDF_LOG_TAG    sensor_config_parser_c
@@ -47,6 +49,7 @@ void ReleaseSensorAllRegConfig(struct SensorCfgData *config)
 
     for (index = 0; index < SENSOR_GROUP_MAX; ++index) {
         if (config->regCfgGroup[index] != NULL) {
+            ReleaseSensorRegCfgPlan(config->regCfgGroup[index]);
             if (config->regCfgGroup[index]->regCfgItem != NULL) {
                 OsalMemFree(config->regCfgGroup[index]->regCfgItem);
                 config->regCfgGroup[index]->regCfgItem = NULL;
@@ -108,7 +111,7 @@ static int32_t ParseSensorRegItem(struct DeviceResourceIface *parser, const stru
 }
 
 static int32_t ParseSensorRegGroup(struct DeviceResourceIface *parser, const struct DeviceResourceNode *regCfgNode,
-    const char *groupName, struct SensorRegCfgGroupNode **groupNode)
+    const char *groupName, struct SensorBusCfg *busCfg, struct SensorRegCfgGroupNode **groupNode)
 {
     int32_t num;
     struct SensorRegCfgGroupNode *group = NULL;
@@ -116,6 +119,7 @@ static int32_t ParseSensorRegGroup(struct DeviceResourceIface *parser, const str
     CHECK_NULL_PTR_RETURN_VALUE(parser, HDF_ERR_INVALID_PARAM);
     CHECK_NULL_PTR_RETURN_VALUE(regCfgNode, HDF_ERR_INVALID_PARAM);
     CHECK_NULL_PTR_RETURN_VALUE(groupName, HDF_ERR_INVALID_PARAM);
+    CHECK_NULL_PTR_RETURN_VALUE(busCfg, HDF_ERR_INVALID_PARAM);
     CHECK_NULL_PTR_RETURN_VALUE(groupNode, HDF_ERR_INVALID_PARAM);
 
     num = parser->GetElemNum(regCfgNode, groupName);
@@ -123,6 +127,7 @@ static int32_t ParseSensorRegGroup(struct DeviceResourceIface *parser, const str
 
     if (num > 0) {
         if (group != NULL) {
+            ReleaseSensorRegCfgPlan(group);
             if (group->regCfgItem != NULL) {
                 OsalMemFree(group->regCfgItem);
             }
@@ -149,6 +154,12 @@ static int32_t ParseSensorRegGroup(struct DeviceResourceIface *parser, const str
             HDF_LOGE("%s: malloc sensor reg config item data failed", __func__);
             return HDF_FAILURE;
         }
+
+        /* compile once here, so the groups are read only by the time drivers apply them */
+        if (CompileSensorRegCfgPlan(busCfg, group) != HDF_SUCCESS) {
+            HDF_LOGE("%s: compile sensor reg config plan failed", __func__);
+            return HDF_FAILURE;
+        }
     }
 
     return HDF_SUCCESS;
@@ -180,7 +191,8 @@ int32_t ParseSensorRegConfig(struct SensorCfgData *config)
             goto error;
         }
 
-        if (ParseSensorRegGroup(parser, regCfgNode, regAttr->name, &config->regCfgGroup[index]) != HDF_SUCCESS) {
+        if (ParseSensorRegGroup(parser, regCfgNode, regAttr->name, &config->busCfg,
+            &config->regCfgGroup[index]) != HDF_SUCCESS) {
             HDF_LOGE("%s: parse sensor register group failed", __func__);
             goto error;
         }
@@ -336,6 +348,22 @@ static int32_t ParseSensorInfo(struct DeviceResourceIface *parser, const struct
     return ret;
 }
 
+static void ParseSensorBusIrq(struct DeviceResourceIface *parser, const struct DeviceResourceNode *busNode,
+    struct SensorCfgData *config)
+{
+    struct SensorIrqCfg *irqCfg = &config->busCfg.irqCfg;
+
+    irqCfg->enable = false;
+    if (parser->GetUint16(busNode, "dataReadyGpio", &irqCfg->gpioNum, 0) != HDF_SUCCESS) {
+        return;
+    }
+    if (parser->GetUint16(busNode, "dataReadyTrigger", &irqCfg->trigger, OSAL_IRQF_TRIGGER_RISING) != HDF_SUCCESS) {
+        irqCfg->trigger = OSAL_IRQF_TRIGGER_RISING;
+    }
+    irqCfg->enable = true;
+    HDF_LOGI("%s: sensor data ready irq on gpio[%u]", __func__, irqCfg->gpioNum);
+}
+
 static int32_t ParseSensorBus(struct DeviceResourceIface *parser, const struct DeviceResourceNode *busNode,
     struct SensorCfgData *config)
 {
@@ -345,6 +373,9 @@ static int32_t ParseSensorBus(struct DeviceResourceIface *parser, const struct D
     CHECK_PARSER_RESULT_RETURN_VALUE(ret, "busType");
     ret = parser->GetUint8(busNode, "regBigEndian", &config->busCfg.regBigEndian, 0);
     CHECK_PARSER_RESULT_RETURN_VALUE(ret, "regBigEndian");
+    if (parser->GetUint8(busNode, "regBurstWrite", &config->busCfg.regBurstWrite, 0) != HDF_SUCCESS) {
+        config->busCfg.regBurstWrite = 0;
+    }
 
     if (config->busCfg.busType == SENSOR_BUS_I2C) {
         ret = parser->GetUint16(busNode, "busNum", &config->busCfg.i2cCfg.busNum, 0);
@@ -353,11 +384,13 @@ static int32_t ParseSensorBus(struct DeviceResourceIface *parser, const struct D
         CHECK_PARSER_RESULT_RETURN_VALUE(ret, "busAddr");
         ret = parser->GetUint16(busNode, "regWidth", &config->busCfg.i2cCfg.regWidth, 0);
         CHECK_PARSER_RESULT_RETURN_VALUE(ret, "regWidth");
+        ParseSensorBusIrq(parser, busNode, config);
     } else if (config->busCfg.busType == SENSOR_BUS_SPI) {
         ret = parser->GetUint32(busNode, "busNum", &config->busCfg.spiCfg.busNum, 0);
         CHECK_PARSER_RESULT_RETURN_VALUE(ret, "busNum");
         ret = parser->GetUint32(busNode, "busAddr", &config->busCfg.spiCfg.csNum, 0);
         CHECK_PARSER_RESULT_RETURN_VALUE(ret, "busAddr");
+        ParseSensorBusIrq(parser, busNode, config);
     } else if (config->busCfg.busType == SENSOR_BUS_GPIO) {
         ret = parser->GetUint32(busNode, "gpioIrq1", &config->busCfg.GpioNum[SENSOR_GPIO_NUM1], 0);
         CHECK_PARSER_RESULT_RETURN_VALUE(ret, "gpioIrq1");
@@ -11,6 +11,7 @@
 #include "asm/io.h"
 #include "osal_mem.h"
 #include "sensor_platform_if.h"
+#include "sensor_sched.h"
 
 #define HDF_LOG_TAG    sensor_device_manager_c
 
@@ -345,6 +346,11 @@ int32_t InitSensorDevManager(struct HdfDeviceObject *device)
         return HDF_FAILURE;
     }
 
+    if (SensorSchedInit() != HDF_SUCCESS) {
+        HDF_LOGE("%s: init sensor sched failed", __func__);
+        return HDF_FAILURE;
+    }
+
     if (!HdfDeviceSetClass(device, DEVICE_CLASS_SENSOR)) {
         HDF_LOGE("%s: init sensor set class failed", __func__);
         return HDF_FAILURE;
@@ -370,6 +376,7 @@ void ReleaseSensorDevManager(struct HdfDeviceObject *device)
         OsalMemFree(pos);
     }
 
+    SensorSchedRelease();
     OsalMutexDestroy(&manager->mutex);
     OsalMemFree(manager);
     g_sensorDeviceManager = NULL;
@@ -0,0 +1,423 @@
+/*
+ * Copyright (c) 2021 Huawei Device Co., Ltd.
+ *
+ * HDF is dual licensed: you can use it either under the terms of
+ * the GPL, or the BSD license, at your option.
+ * See the LICENSE file in the root of this repository for complete details.
+ */
+
+#include "sensor_sched.h"
+#include <securec.h>
+#include "gpio_if.h"
+#include "osal_irq.h"
+#include "osal_math.h"
+#include "osal_mem.h"
+#include "osal_time.h"
+#include "sensor_platform_if.h"
+
+#define HDF_LOG_TAG    sensor_sched_c
+
+#define SENSOR_SCHED_DEADLINE_MAX    0x7FFFFFFFFFFFFFFFLL
+
+static struct SensorSchedData *g_sensorSched = NULL;
+
+static struct SensorSchedData *SensorSchedGetData(void)
+{
+    return g_sensorSched;
+}
+
+static int64_t SensorSchedGetPeriod(int64_t samplingInterval)
+{
+    int64_t period = OsalDivS64(samplingInterval, (SENSOR_CONVERT_UNIT * SENSOR_CONVERT_UNIT));
+
+    return (period < SENSOR_SCHED_MIN_PERIOD_MS) ? SENSOR_SCHED_MIN_PERIOD_MS : period;
+}
+
+/*
+ * Deadlines are aligned to multiples of the period on a common time base, so sensors whose
+ * periods divide each other (10ms/20ms/100ms ...) expire on the same tick and share one wakeup.
+ */
+static int64_t SensorSchedAlignDeadline(int64_t now, int64_t period)
+{
+    return (OsalDivS64(now, (int32_t)period) + 1) * period;
+}
+
+static void SensorSchedTimerEntry(uintptr_t arg)
+{
+    struct SensorSchedData *sched = (struct SensorSchedData *)arg;
+    CHECK_NULL_PTR_RETURN(sched);
+
+    if (!HdfAddWork(&sched->workQueue, &sched->work)) {
+        HDF_LOGD("%s: sensor sched work already pending", __func__);
+    }
+}
+
+static int32_t SensorSchedArmLocked(struct SensorSchedData *sched, int64_t now)
+{
+    int32_t ret;
+    int64_t timeout;
+    int64_t next = SENSOR_SCHED_DEADLINE_MAX;
+    struct SensorSchedNode *pos = NULL;
+
+    DLIST_FOR_EACH_ENTRY(pos, &sched->nodeHead, struct SensorSchedNode, entry) {
+        next = (pos->deadline < next) ? pos->deadline : next;
+    }
+    if (next == SENSOR_SCHED_DEADLINE_MAX) {
+        return HDF_SUCCESS;
+    }
+
+    sched->nextDeadline = next;
+    timeout = next - now;
+    timeout = (timeout < 1) ? 1 : timeout;
+
+    if (!sched->timerRunning) {
+        ret = OsalTimerCreate(&sched->timer, (uint32_t)timeout, SensorSchedTimerEntry, (uintptr_t)sched);
+        if (ret != HDF_SUCCESS) {
+            HDF_LOGE("%s: sensor sched create timer failed[%d]", __func__, ret);
+            return ret;
+        }
+        ret = OsalTimerStartLoop(&sched->timer);
+        if (ret != HDF_SUCCESS) {
+            HDF_LOGE("%s: sensor sched start timer failed[%d]", __func__, ret);
+            (void)OsalTimerDelete(&sched->timer);
+            return ret;
+        }
+        sched->timerRunning = true;
+        return HDF_SUCCESS;
+    }
+
+    ret = OsalTimerSetTimeout(&sched->timer, (uint32_t)timeout);
+    if (ret != HDF_SUCCESS) {
+        HDF_LOGE("%s: sensor sched modify time failed[%d]", __func__, ret);
+    }
+    return ret;
+}
+
+static void SensorSchedWorkEntry(void *arg)
+{
+    int64_t now;
+    struct SensorSchedNode *pos = NULL;
+    struct SensorSchedData *sched = (struct SensorSchedData *)arg;
+    CHECK_NULL_PTR_RETURN(sched);
+
+    (void)OsalMutexLock(&sched->mutex);
+    if (sched->activeNum == 0) {
+        (void)OsalMutexUnlock(&sched->mutex);
+        return;
+    }
+
+    sched->stats.wakeups++;
+    now = (int64_t)OsalGetSysTimeMs();
+    DLIST_FOR_EACH_ENTRY(pos, &sched->nodeHead, struct SensorSchedNode, entry) {
+        if (pos->deadline > now + SENSOR_SCHED_GROUP_SLACK_MS) {
+            continue;
+        }
+        if (pos->read != NULL) {
+            pos->read(pos->arg);
+            sched->stats.reads++;
+        }
+        pos->deadline += pos->period;
+        if (pos->deadline <= now) {
+            pos->deadline = SensorSchedAlignDeadline(now, pos->period);
+        }
+    }
+
+    (void)SensorSchedArmLocked(sched, (int64_t)OsalGetSysTimeMs());
+    (void)OsalMutexUnlock(&sched->mutex);
+}
+
+int32_t SensorSchedStart(struct SensorSchedNode *node, SensorSchedReadFunc read, void *arg,
+    int64_t samplingInterval)
+{
+    int32_t ret;
+    int64_t now;
+    struct SensorSchedData *sched = SensorSchedGetData();
+
+    CHECK_NULL_PTR_RETURN_VALUE(sched, HDF_ERR_INVALID_PARAM);
+    CHECK_NULL_PTR_RETURN_VALUE(node, HDF_ERR_INVALID_PARAM);
+    CHECK_NULL_PTR_RETURN_VALUE(read, HDF_ERR_INVALID_PARAM);
+
+    (void)OsalMutexLock(&sched->mutex);
+    if (node->active) {
+        (void)OsalMutexUnlock(&sched->mutex);
+        return HDF_SUCCESS;
+    }
+
+    now = (int64_t)OsalGetSysTimeMs();
+    node->read = read;
+    node->arg = arg;
+    node->period = SensorSchedGetPeriod(samplingInterval);
+    node->deadline = SensorSchedAlignDeadline(now, node->period);
+    DListInsertTail(&node->entry, &sched->nodeHead);
+    node->active = true;
+    sched->activeNum++;
+
+    ret = SensorSchedArmLocked(sched, now);
+    if (ret != HDF_SUCCESS) {
+        DListRemove(&node->entry);
+        node->active = false;
+        sched->activeNum--;
+    }
+    (void)OsalMutexUnlock(&sched->mutex);
+
+    return ret;
+}
+
+static bool SensorSchedIrqIsLevel(const struct SensorIrqCfg *irqCfg)
+{
+    return (irqCfg->trigger & (OSAL_IRQF_TRIGGER_HIGH | OSAL_IRQF_TRIGGER_LOW)) != 0;
+}
+
+/*
+ * Top half: only take the timestamp and hand the rest over to the sched worker. Masking a level
+ * triggered line takes the gpio manager lock, which is not irq safe, so the worker does it.
+ */
+static int32_t SensorSchedIrqHandler(uint16_t gpio, void *data)
+{
+    (void)gpio;
+    OsalTimespec time;
+    struct SensorSchedNode *node = (struct SensorSchedNode *)data;
+    struct SensorSchedData *sched = SensorSchedGetData();
+
+    if (node == NULL || node->irqCfg == NULL || sched == NULL) {
+        return HDF_ERR_INVALID_PARAM;
+    }
+
+    if (OsalGetTime(&time) == HDF_SUCCESS) {
+        node->irqCfg->timestamp = time.sec * SENSOR_SECOND_CONVERT_NANOSECOND + time.usec * SENSOR_CONVERT_UNIT;
+    }
+    (void)HdfAddWork(&sched->workQueue, &node->irqWork);
+    return HDF_SUCCESS;
+}
+
+/* a level triggered line stays masked until the sample has been read out */
+static void SensorSchedIrqWorkEntry(void *arg)
+{
+    bool level = false;
+    struct SensorSchedNode *node = (struct SensorSchedNode *)arg;
+    struct SensorSchedData *sched = SensorSchedGetData();
+
+    CHECK_NULL_PTR_RETURN(node);
+    CHECK_NULL_PTR_RETURN(sched);
+
+    (void)OsalMutexLock(&sched->mutex);
+    if (!node->active || node->irqCfg == NULL) {
+        (void)OsalMutexUnlock(&sched->mutex);
+        return;
+    }
+
+    level = SensorSchedIrqIsLevel(node->irqCfg);
+    if (level) {
+        (void)GpioDisableIrq(node->irqCfg->gpioNum);
+    }
+    node->read(node->arg);
+    sched->stats.irqReads++;
+    if (level) {
+        (void)GpioEnableIrq(node->irqCfg->gpioNum);
+    }
+    (void)OsalMutexUnlock(&sched->mutex);
+}
+
+int32_t SensorSchedStartIrq(struct SensorSchedNode *node, struct SensorIrqCfg *irqCfg, SensorSchedReadFunc read,
+    void *arg)
+{
+    int32_t ret;
+    struct SensorSchedData *sched = SensorSchedGetData();
+
+    CHECK_NULL_PTR_RETURN_VALUE(sched, HDF_ERR_INVALID_PARAM);
+    CHECK_NULL_PTR_RETURN_VALUE(node, HDF_ERR_INVALID_PARAM);
+    CHECK_NULL_PTR_RETURN_VALUE(irqCfg, HDF_ERR_INVALID_PARAM);
+    CHECK_NULL_PTR_RETURN_VALUE(read, HDF_ERR_INVALID_PARAM);
+
+    (void)OsalMutexLock(&sched->mutex);
+    if (node->active) {
+        (void)OsalMutexUnlock(&sched->mutex);
+        return HDF_SUCCESS;
+    }
+
+    if (HdfWorkInit(&node->irqWork, SensorSchedIrqWorkEntry, node) != HDF_SUCCESS) {
+        HDF_LOGE("%s: init sensor irq work failed", __func__);
+        (void)OsalMutexUnlock(&sched->mutex);
+        return HDF_FAILURE;
+    }
+    node->read = read;
+    node->arg = arg;
+    node->irqCfg = irqCfg;
+    node->active = true;
+    (void)OsalMutexUnlock(&sched->mutex);
+
+    ret = GpioSetIrq(irqCfg->gpioNum, irqCfg->trigger, SensorSchedIrqHandler, node);
+    if (ret != HDF_SUCCESS) {
+        HDF_LOGE("%s: set sensor irq gpio[%u] failed[%d]", __func__, irqCfg->gpioNum, ret);
+        goto ERROR;
+    }
+    ret = GpioEnableIrq(irqCfg->gpioNum);
+    if (ret != HDF_SUCCESS) {
+        HDF_LOGE("%s: enable sensor irq gpio[%u] failed[%d]", __func__, irqCfg->gpioNum, ret);
+        (void)GpioUnSetIrq(irqCfg->gpioNum);
+        goto ERROR;
+    }
+    return HDF_SUCCESS;
+
+ERROR:
+    (void)OsalMutexLock(&sched->mutex);
+    node->active = false;
+    node->irqCfg = NULL;
+    (void)OsalMutexUnlock(&sched->mutex);
+    HdfWorkDestroy(&node->irqWork);
+    return ret;
+}
+
+static int32_t SensorSchedStopIrq(struct SensorSchedData *sched, struct SensorSchedNode *node)
+{
+    uint16_t gpio = node->irqCfg->gpioNum;
+
+    (void)GpioDisableIrq(gpio);
+    (void)GpioUnSetIrq(gpio);
+    (void)HdfCancelWorkSync(&node->irqWork);
+
+    (void)OsalMutexLock(&sched->mutex);
+    node->active = false;
+    node->irqCfg = NULL;
+    (void)OsalMutexUnlock(&sched->mutex);
+    HdfWorkDestroy(&node->irqWork);
+
+    return HDF_SUCCESS;
+}
+
+int32_t SensorSchedStop(struct SensorSchedNode *node)
+{
+    int32_t ret = HDF_SUCCESS;
+    struct SensorSchedData *sched = SensorSchedGetData();
+
+    CHECK_NULL_PTR_RETURN_VALUE(sched, HDF_ERR_INVALID_PARAM);
+    CHECK_NULL_PTR_RETURN_VALUE(node, HDF_ERR_INVALID_PARAM);
+
+    if (node->active && node->irqCfg != NULL) {
+        return SensorSchedStopIrq(sched, node);
+    }
+
+    (void)OsalMutexLock(&sched->mutex);
+    if (!node->active) {
+        (void)OsalMutexUnlock(&sched->mutex);
+        return HDF_SUCCESS;
+    }
+
+    DListRemove(&node->entry);
+    node->active = false;
+    sched->activeNum--;
+
+    if (sched->activeNum == 0 && sched->timerRunning) {
+        ret = OsalTimerDelete(&sched->timer);
+        if (ret != HDF_SUCCESS) {
+            HDF_LOGE("%s: sensor sched delete timer failed", __func__);
+        }
+        sched->timerRunning = false;
+    }
+    (void)OsalMutexUnlock(&sched->mutex);
+
+    return ret;
+}
+
+int32_t SensorSchedSetInterval(struct SensorSchedNode *node, int64_t samplingInterval)
+{
+    int32_t ret = HDF_SUCCESS;
+    int64_t now;
+    struct SensorSchedData *sched = SensorSchedGetData();
+
+    CHECK_NULL_PTR_RETURN_VALUE(sched, HDF_ERR_INVALID_PARAM);
+    CHECK_NULL_PTR_RETURN_VALUE(node, HDF_ERR_INVALID_PARAM);
+
+    (void)OsalMutexLock(&sched->mutex);
+    node->period = SensorSchedGetPeriod(samplingInterval);
+    if (node->active && node->irqCfg == NULL) {
+        now = (int64_t)OsalGetSysTimeMs();
+        node->deadline = SensorSchedAlignDeadline(now, node->period);
+        if (node->deadline < sched->nextDeadline) {
+            ret = SensorSchedArmLocked(sched, now);
+        }
+    }
+    (void)OsalMutexUnlock(&sched->mutex);
+
+    return ret;
+}
+
+void SensorSchedGetStats(struct SensorSchedStats *stats)
+{
+    struct SensorSchedData *sched = SensorSchedGetData();
+
+    CHECK_NULL_PTR_RETURN(sched);
+    CHECK_NULL_PTR_RETURN(stats);
+
+    (void)OsalMutexLock(&sched->mutex);
+    (void)memcpy_s(stats, sizeof(*stats), &sched->stats, sizeof(sched->stats));
+    (void)OsalMutexUnlock(&sched->mutex);
+}
+
+int32_t SensorSchedInit(void)
+{
+    struct SensorSchedData *sched = NULL;
+
+    if (g_sensorSched != NULL) {
+        return HDF_SUCCESS;
+    }
+
+    sched = (struct SensorSchedData *)OsalMemCalloc(sizeof(*sched));
+    if (sched == NULL) {
+        HDF_LOGE("%s: malloc sensor sched data failed", __func__);
+        return HDF_ERR_MALLOC_FAIL;
+    }
+
+    DListHeadInit(&sched->nodeHead);
+    if (OsalMutexInit(&sched->mutex) != HDF_SUCCESS) {
+        HDF_LOGE("%s: init sensor sched mutex failed", __func__);
+        OsalMemFree(sched);
+        return HDF_FAILURE;
+    }
+
+    if (HdfWorkQueueInit(&sched->workQueue, HDF_SENSOR_SCHED_WORK_QUEUE_NAME) != HDF_SUCCESS) {
+        HDF_LOGE("%s: init sensor sched work queue failed", __func__);
+        (void)OsalMutexDestroy(&sched->mutex);
+        OsalMemFree(sched);
+        return HDF_FAILURE;
+    }
+
+    if (HdfWorkInit(&sched->work, SensorSchedWorkEntry, sched) != HDF_SUCCESS) {
+        HDF_LOGE("%s: init sensor sched work failed", __func__);
+        HdfWorkQueueDestroy(&sched->workQueue);
+        (void)OsalMutexDestroy(&sched->mutex);
+        OsalMemFree(sched);
+        return HDF_FAILURE;
+    }
+
+    sched->nextDeadline = SENSOR_SCHED_DEADLINE_MAX;
+    g_sensorSched = sched;
+    return HDF_SUCCESS;
+}
+
+void SensorSchedRelease(void)
+{
+    struct SensorSchedNode *pos = NULL;
+    struct SensorSchedNode *tmp = NULL;
+    struct SensorSchedData *sched = SensorSchedGetData();
+
+    CHECK_NULL_PTR_RETURN(sched);
+
+    (void)OsalMutexLock(&sched->mutex);
+    if (sched->timerRunning) {
+        (void)OsalTimerDelete(&sched->timer);
+        sched->timerRunning = false;
+    }
+    DLIST_FOR_EACH_ENTRY_SAFE(pos, tmp, &sched->nodeHead, struct SensorSchedNode, entry) {
+        DListRemove(&pos->entry);
+        pos->active = false;
+    }
+    sched->activeNum = 0;
+    (void)OsalMutexUnlock(&sched->mutex);
+
+    HdfWorkDestroy(&sched->work);
+    HdfWorkQueueDestroy(&sched->workQueue);
+    (void)OsalMutexDestroy(&sched->mutex);
+    OsalMemFree(sched);
+    g_sensorSched = NULL;
+}
@@ -10,7 +10,6 @@
 #include <securec.h>
 #include "hdf_base.h"
 #include "hdf_device_desc.h"
-#include "osal_math.h"
 #include "osal_mem.h"
 #include "sensor_config_controller.h"
 #include "sensor_device_manager.h"
@@ -18,7 +17,6 @@
 
 #define HDF_LOG_TAG    sensor_gyro_driver_c
 
-#define HDF_GYRO_WORK_QUEUE_NAME    "hdf_gyro_work_queue"
 
 static struct GyroDrvData *g_gyroDrvData = NULL;
 
@@ -57,37 +55,8 @@ static void GyroDataWorkEntry(void *arg)
     }
 }
 
-static void GyroTimerEntry(uintptr_t arg)
-{
-    int64_t interval;
-    int32_t ret;
-    struct GyroDrvData *drvData = (struct GyroDrvData *)arg;
-    CHECK_NULL_PTR_RETURN(drvData);
-
-    if (!HdfAddWork(&drvData->gyroWorkQueue, &drvData->gyroWork)) {
-        HDF_LOGE("%s: Gyro add work queue failed", __func__);
-    }
-
-    interval = OsalDivS64(drvData->interval, (SENSOR_CONVERT_UNIT * SENSOR_CONVERT_UNIT));
-    interval = (interval < SENSOR_TIMER_MIN_TIME) ? SENSOR_TIMER_MIN_TIME : interval;
-    ret = OsalTimerSetTimeout(&drvData->gyroTimer, interval);
-    if (ret != HDF_SUCCESS) {
-        HDF_LOGE("%s: Gyro modify time failed", __func__);
-    }
-}
-
 static int32_t InitGyroData(struct GyroDrvData *drvData)
 {
-    if (HdfWorkQueueInit(&drvData->gyroWorkQueue, HDF_GYRO_WORK_QUEUE_NAME) != HDF_SUCCESS) {
-        HDF_LOGE("%s: Gyro init work queue failed", __func__);
-        return HDF_FAILURE;
-    }
-
-    if (HdfWorkInit(&drvData->gyroWork, GyroDataWorkEntry, drvData) != HDF_SUCCESS) {
-        HDF_LOGE("%s: Gyro create thread failed", __func__);
-        return HDF_FAILURE;
-    }
-
     drvData->interval = SENSOR_TIMER_MIN_TIME;
     drvData->enable = false;
     drvData->detectFlag = false;
@@ -114,15 +83,14 @@ static int32_t SetGyroEnable(void)
         return ret;
     }
 
-    ret = OsalTimerCreate(&drvData->gyroTimer, SENSOR_TIMER_MIN_TIME, GyroTimerEntry, (uintptr_t)drvData);
-    if (ret != HDF_SUCCESS) {
-        HDF_LOGE("%s: Gyro create timer failed[%d]", __func__, ret);
-        return ret;
+    if (drvData->gyroCfg->busCfg.irqCfg.enable) {
+        ret = SensorSchedStartIrq(&drvData->gyroSchedNode, &drvData->gyroCfg->busCfg.irqCfg, GyroDataWorkEntry,
+            drvData);
+    } else {
+        ret = SensorSchedStart(&drvData->gyroSchedNode, GyroDataWorkEntry, drvData, drvData->interval);
     }
-
-    ret = OsalTimerStartLoop(&drvData->gyroTimer);
     if (ret != HDF_SUCCESS) {
-        HDF_LOGE("%s: Gyro start timer failed[%d]", __func__, ret);
+        HDF_LOGE("%s: Gyro start sched failed[%d]", __func__, ret);
         return ret;
     }
     drvData->enable = true;
@@ -149,9 +117,9 @@ static int32_t SetGyroDisable(void)
         return ret;
     }
 
-    ret = OsalTimerDelete(&drvData->gyroTimer);
+    ret = SensorSchedStop(&drvData->gyroSchedNode);
     if (ret != HDF_SUCCESS) {
-        HDF_LOGE("%s: Gyro delete timer failed", __func__);
+        HDF_LOGE("%s: Gyro stop sched failed", __func__);
         return ret;
     }
     drvData->enable = false;
@@ -169,6 +137,9 @@ static int32_t SetGyroBatch(int64_t samplingInterval, int64_t interval)
     CHECK_NULL_PTR_RETURN_VALUE(drvData, HDF_ERR_INVALID_PARAM);
 
     drvData->interval = samplingInterval;
+    if (drvData->enable) {
+        return SensorSchedSetInterval(&drvData->gyroSchedNode, samplingInterval);
+    }
 
     return HDF_SUCCESS;
 }
@@ -347,6 +318,9 @@ void GyroReleaseDriver(struct HdfDeviceObject *device)
     struct GyroDrvData *drvData = (struct GyroDrvData *)device->service;
     CHECK_NULL_PTR_RETURN(drvData);
 
+    /* stop the reads first, they use the cfg freed below */
+    (void)SensorSchedStop(&drvData->gyroSchedNode);
+
     if (drvData->detectFlag && drvData->gyroCfg != NULL) {
         GyroReleaseCfgData(drvData->gyroCfg);
     }
@@ -354,8 +328,6 @@ void GyroReleaseDriver(struct HdfDeviceObject *device)
     OsalMemFree(drvData->gyroCfg);
     drvData->gyroCfg = NULL;
 
-    HdfWorkDestroy(&drvData->gyroWork);
-    HdfWorkQueueDestroy(&drvData->gyroWorkQueue);
     OsalMemFree(drvData);
 }
 
@@ -74,14 +74,23 @@ struct SensorSpiCfg {
     uint32_t csNum;
 };
 
+struct SensorIrqCfg {
+    uint8_t enable;             // data-ready or FIFO watermark interrupt configured in hcs
+    uint16_t gpioNum;           // gpio of the data-ready or FIFO watermark interrupt
+    uint16_t trigger;           // OSAL_IRQF_TRIGGER_*
+    volatile int64_t timestamp; // captured in the interrupt top half, unit nanosecond
+};
+
 struct SensorBusCfg {
     uint8_t busType; // enum SensorBusType
     uint8_t regBigEndian;
+    uint8_t regBurstWrite; // register address auto-increments on multi-byte writes
     union {
         struct SensorI2cCfg i2cCfg;
         struct SensorSpiCfg spiCfg;
         uint32_t GpioNum[SENSOR_GPIO_NUM_MAX];
     };
+    struct SensorIrqCfg irqCfg;
 };
 
 enum SENSORConfigValueIndex {
@@ -10,7 +10,6 @@
 #include <securec.h>
 #include "hdf_base.h"
 #include "hdf_device_desc.h"
-#include "osal_math.h"
 #include "osal_mem.h"
 #include "sensor_config_controller.h"
 #include "sensor_device_manager.h"
@@ -18,7 +17,6 @@
 
 #define HDF_LOG_TAG    sensor_magnetic_driver_c
 
-#define HDF_MAGNETIC_WORK_QUEUE_NAME    "hdf_magnetic_work_queue"
 
 static struct MagneticDrvData *g_magneticDrvData = NULL;
 
@@ -57,37 +55,8 @@ static void MagneticDataWorkEntry(void *arg)
     }
 }
 
-static void MagneticTimerEntry(uintptr_t arg)
-{
-    int64_t interval;
-    int32_t ret;
-    struct MagneticDrvData *drvData = (struct MagneticDrvData *)arg;
-    CHECK_NULL_PTR_RETURN(drvData);
-
-    if (!HdfAddWork(&drvData->magneticWorkQueue, &drvData->magneticWork)) {
-        HDF_LOGE("%s: Magnetic add work queue failed", __func__);
-    }
-
-    interval = OsalDivS64(drvData->interval, (SENSOR_CONVERT_UNIT * SENSOR_CONVERT_UNIT));
-    interval = (interval < SENSOR_TIMER_MIN_TIME) ? SENSOR_TIMER_MIN_TIME : interval;
-    ret = OsalTimerSetTimeout(&drvData->magneticTimer, interval);
-    if (ret != HDF_SUCCESS) {
-        HDF_LOGE("%s: Magnetic modify time failed", __func__);
-    }
-}
-
 static int32_t InitMagneticData(struct MagneticDrvData *drvData)
 {
-    if (HdfWorkQueueInit(&drvData->magneticWorkQueue, HDF_MAGNETIC_WORK_QUEUE_NAME) != HDF_SUCCESS) {
-        HDF_LOGE("%s: Magnetic init work queue failed", __func__);
-        return HDF_FAILURE;
-    }
-
-    if (HdfWorkInit(&drvData->magneticWork, MagneticDataWorkEntry, drvData) != HDF_SUCCESS) {
-        HDF_LOGE("%s: Magnetic create thread failed", __func__);
-        return HDF_FAILURE;
-    }
-
     drvData->interval = SENSOR_TIMER_MIN_TIME;
     drvData->enable = false;
     drvData->detectFlag = false;
@@ -114,15 +83,14 @@ static int32_t SetMagneticEnable(void)
         return ret;
     }
 
-    ret = OsalTimerCreate(&drvData->magneticTimer, SENSOR_TIMER_MIN_TIME, MagneticTimerEntry, (uintptr_t)drvData);
-    if (ret != HDF_SUCCESS) {
-        HDF_LOGE("%s: Magnetic create timer failed[%d]", __func__, ret);
-        return ret;
+    if (drvData->magneticCfg->busCfg.irqCfg.enable) {
+        ret = SensorSchedStartIrq(&drvData->magneticSchedNode, &drvData->magneticCfg->busCfg.irqCfg,
+            MagneticDataWorkEntry, drvData);
+    } else {
+        ret = SensorSchedStart(&drvData->magneticSchedNode, MagneticDataWorkEntry, drvData, drvData->interval);
     }
-
-    ret = OsalTimerStartLoop(&drvData->magneticTimer);
     if (ret != HDF_SUCCESS) {
-        HDF_LOGE("%s: Magnetic start timer failed[%d]", __func__, ret);
+        HDF_LOGE("%s: Magnetic start sched failed[%d]", __func__, ret);
         return ret;
     }
     drvData->enable = true;
@@ -149,9 +117,9 @@ static int32_t SetMagneticDisable(void)
         return ret;
     }
 
-    ret = OsalTimerDelete(&drvData->magneticTimer);
+    ret = SensorSchedStop(&drvData->magneticSchedNode);
     if (ret != HDF_SUCCESS) {
-        HDF_LOGE("%s: Magnetic delete timer failed", __func__);
+        HDF_LOGE("%s: Magnetic stop sched failed", __func__);
         return ret;
     }
     drvData->enable = false;
@@ -169,6 +137,9 @@ static int32_t SetMagneticBatch(int64_t samplingInterval, int64_t interval)
     CHECK_NULL_PTR_RETURN_VALUE(drvData, HDF_ERR_INVALID_PARAM);
 
     drvData->interval = samplingInterval;
+    if (drvData->enable) {
+        return SensorSchedSetInterval(&drvData->magneticSchedNode, samplingInterval);
+    }
 
     return HDF_SUCCESS;
 }
@@ -355,6 +326,9 @@ void MagneticReleaseDriver(struct HdfDeviceObject *device)
     struct MagneticDrvData *drvData = (struct MagneticDrvData *)device->service;
     CHECK_NULL_PTR_RETURN(drvData);
 
+    /* stop the reads first, they use the cfg freed below */
+    (void)SensorSchedStop(&drvData->magneticSchedNode);
+
     if (drvData->detectFlag && drvData->magneticCfg != NULL) {
         MagneticReleaseCfgData(drvData->magneticCfg);
     }
@@ -362,8 +336,6 @@ void MagneticReleaseDriver(struct HdfDeviceObject *device)
     OsalMemFree(drvData->magneticCfg);
     drvData->magneticCfg = NULL;
 
-    HdfWorkDestroy(&drvData->magneticWork);
-    HdfWorkQueueDestroy(&drvData->magneticWorkQueue);
     OsalMemFree(drvData);
 }
 
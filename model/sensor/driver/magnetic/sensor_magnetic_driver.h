@@ -9,10 +9,9 @@
 #ifndef SENSOR_MAGNETIC_DRIVER_H
 #define SENSOR_MAGNETIC_DRIVER_H
 
-#include "hdf_workqueue.h"
-#include "osal_timer.h"
 #include "sensor_config_parser.h"
 #include "sensor_platform_if.h"
+#include "sensor_sched.h"
 
 #define MAGNETIC_DEFAULT_SAMPLING_200_MS    200000000
 #define MAGNETIC_CHIP_NAME_LSM303    "lsm303"
@@ -48,9 +47,7 @@ struct MagneticOpsCall {
 struct MagneticDrvData {
     struct IDeviceIoService ioService;
     struct HdfDeviceObject *device;
-    HdfWorkQueue magneticWorkQueue;
-    HdfWork magneticWork;
-    OsalTimer magneticTimer;
+    struct SensorSchedNode magneticSchedNode;
     bool detectFlag;
     bool enable;
     int64_t interval;
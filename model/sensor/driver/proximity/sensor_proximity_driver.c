@@ -10,7 +10,6 @@
 #include <securec.h>
 #include "hdf_base.h"
 #include "hdf_device_desc.h"
-#include "osal_math.h"
 #include "osal_mem.h"
 #include "sensor_config_controller.h"
 #include "sensor_device_manager.h"
@@ -18,7 +17,6 @@
 
 #define HDF_LOG_TAG    sensor_proximity_driver_c
 
-#define HDF_PROXIMITY_WORK_QUEUE_NAME    "hdf_proximity_work_queue"
 
 static struct ProximityDrvData *g_proximityDrvData = NULL;
 
@@ -56,37 +54,8 @@ static void ProximityDataWorkEntry(void *arg)
     }
 }
 
-static void ProximityTimerEntry(uintptr_t arg)
-{
-    int64_t interval;
-    int32_t ret;
-    struct ProximityDrvData *drvData = (struct ProximityDrvData *)arg;
-    CHECK_NULL_PTR_RETURN(drvData);
-
-    if (!HdfAddWork(&drvData->proximityWorkQueue, &drvData->proximityWork)) {
-        HDF_LOGE("%s: proximity add work queue failed", __func__);
-    }
-
-    interval = OsalDivS64(drvData->interval, (SENSOR_CONVERT_UNIT * SENSOR_CONVERT_UNIT));
-    interval = (interval < SENSOR_TIMER_MIN_TIME) ? SENSOR_TIMER_MIN_TIME : interval;
-    ret = OsalTimerSetTimeout(&drvData->proximityTimer, interval);
-    if (ret != HDF_SUCCESS) {
-        HDF_LOGE("%s: proximity modify time failed", __func__);
-    }
-}
-
 static int32_t InitProximityData(struct ProximityDrvData *drvData)
 {
-    if (HdfWorkQueueInit(&drvData->proximityWorkQueue, HDF_PROXIMITY_WORK_QUEUE_NAME) != HDF_SUCCESS) {
-        HDF_LOGE("%s: proximity init work queue failed", __func__);
-        return HDF_FAILURE;
-    }
-
-    if (HdfWorkInit(&drvData->proximityWork, ProximityDataWorkEntry, drvData) != HDF_SUCCESS) {
-        HDF_LOGE("%s: proximity create thread failed", __func__);
-        return HDF_FAILURE;
-    }
-
     drvData->interval = SENSOR_TIMER_MIN_TIME;
     drvData->enable = false;
     drvData->detectFlag = false;
@@ -113,15 +82,9 @@ static int32_t SetProximityEnable(void)
         return ret;
     }
 
-    ret = OsalTimerCreate(&drvData->proximityTimer, SENSOR_TIMER_MIN_TIME, ProximityTimerEntry, (uintptr_t)drvData);
-    if (ret != HDF_SUCCESS) {
-        HDF_LOGE("%s: proximity create timer failed[%d]", __func__, ret);
-        return ret;
-    }
-
-    ret = OsalTimerStartLoop(&drvData->proximityTimer);
+    ret = SensorSchedStart(&drvData->proximitySchedNode, ProximityDataWorkEntry, drvData, drvData->interval);
     if (ret != HDF_SUCCESS) {
-        HDF_LOGE("%s: proximity start timer failed[%d]", __func__, ret);
+        HDF_LOGE("%s: proximity start sched failed[%d]", __func__, ret);
         return ret;
     }
     drvData->enable = true;
@@ -149,9 +112,9 @@ static int32_t SetProximityDisable(void)
         return ret;
     }
 
-    ret = OsalTimerDelete(&drvData->proximityTimer);
+    ret = SensorSchedStop(&drvData->proximitySchedNode);
     if (ret != HDF_SUCCESS) {
-        HDF_LOGE("%s: proximity delete timer failed", __func__);
+        HDF_LOGE("%s: proximity stop sched failed", __func__);
         return ret;
     }
     drvData->enable = false;
@@ -168,6 +131,9 @@ static int32_t SetProximityBatch(int64_t samplingInterval, int64_t interval)
     CHECK_NULL_PTR_RETURN_VALUE(drvData, HDF_ERR_INVALID_PARAM);
 
     drvData->interval = samplingInterval;
+    if (drvData->enable) {
+        return SensorSchedSetInterval(&drvData->proximitySchedNode, samplingInterval);
+    }
 
     return HDF_SUCCESS;
 }
@@ -351,6 +317,9 @@ void ProximityReleaseDriver(struct HdfDeviceObject *device)
     struct ProximityDrvData *drvData = (struct ProximityDrvData *)device->service;
     CHECK_NULL_PTR_RETURN(drvData);
 
+    /* stop the reads first, they use the cfg freed below */
+    (void)SensorSchedStop(&drvData->proximitySchedNode);
+
     if (drvData->detectFlag && drvData->proximityCfg != NULL) {
         ProximityReleaseCfgData(drvData->proximityCfg);
     }
@@ -358,8 +327,6 @@ void ProximityReleaseDriver(struct HdfDeviceObject *device)
     OsalMemFree(drvData->proximityCfg);
     drvData->proximityCfg = NULL;
 
-    HdfWorkDestroy(&drvData->proximityWork);
-    HdfWorkQueueDestroy(&drvData->proximityWorkQueue);
     OsalMemFree(drvData);
 }
 
@@ -9,10 +9,9 @@
 #ifndef SENSOR_PROXIMITY_DRIVER_H
 #define SENSOR_PROXIMITY_DRIVER_H
 
-#include "hdf_workqueue.h"
-#include "osal_timer.h"
 #include "sensor_config_parser.h"
 #include "sensor_platform_if.h"
+#include "sensor_sched.h"
 
 struct ProximityData {
     uint8_t stateFlag;
@@ -26,9 +25,7 @@ struct ProximityOpsCall {
 struct ProximityDrvData {
     struct IDeviceIoService ioService;
     struct HdfDeviceObject *device;
-    HdfWorkQueue proximityWorkQueue;
-    HdfWork proximityWork;
-    OsalTimer proximityTimer;
+    struct SensorSchedNode proximitySchedNode;
     bool detectFlag;
     bool enable;
     int64_t interval;
@@ -16,6 +16,9 @@
 #include "mmc_protocol.h"
 #include "osal_mem.h"
 #include "osal_mutex.h"
+#include "osal_sem.h"
+#include "osal_spinlock.h"
+#include "osal_thread.h"
 #include "osal_time.h"
 #include "platform_core.h"
 
@@ -38,6 +41,7 @@ struct MmcDevice;
 struct MmcMsg;
 struct MmcData;
 struct MmcCmd;
+struct MmcReq;
 enum MmcMsgCode;
 enum MmcCmdCode;
 union MmcDevState;
@@ -50,6 +54,27 @@ enum MmcDevType {
     MMC_DEV_INVALID
 };
 
+struct MmcReqStats {
+    uint32_t submitted;    /* requests accepted by MmcDeviceSubmitRequest */
+    uint32_t merged;       /* requests folded into the transfer of a preceding request */
+    uint32_t transfers;    /* read/write commands issued on the bus */
+    uint32_t sbcTransfers; /* transfers bounded by CMD23 instead of a stop command */
+};
+
+/*
+ * Submission queue for block read/write requests, served by one worker per controller.
+ * Sequential requests queued back to back are merged into one bus transfer.
+ */
+struct MmcReqQueue {
+    struct DListHead reqs;
+    OsalSpinlock spin;
+    struct OsalSem sem;
+    struct OsalSem exited; /* posted by the worker when it leaves */
+    struct OsalThread thread;
+    bool running;
+    struct MmcReqStats stats; /* under spin */
+};
+
 struct MmcCntlr {
     struct IDeviceIoService service;
     struct HdfDeviceObject *hdfDevObj;
@@ -60,6 +85,7 @@ struct MmcCntlr {
     struct MmcDevice *curDev;
     struct MmcCntlrOps *ops;
     struct PlatformQueue *msgQueue;
+    struct MmcReqQueue reqQueue;
     uint16_t index;
     uint16_t voltDef;
     uint32_t vddBit;
@@ -151,6 +177,9 @@ int32_t MmcCntlrAddRequestMsgToQueue(struct MmcCntlr *cntlr, struct MmcCmd *cmd)
 int32_t MmcCntlrAddDetectMsgToQueue(struct MmcCntlr *cntlr);
 int32_t MmcCntlrAddPlugMsgToQueue(struct MmcCntlr *cntlr);
 int32_t MmcCntlrAddSdioRescanMsgToQueue(struct MmcCntlr *cntlr);
+int32_t MmcCntlrReqQueueStart(struct MmcCntlr *cntlr);
+void MmcCntlrReqQueueStop(struct MmcCntlr *cntlr);
+void MmcCntlrGetReqStats(struct MmcCntlr *cntlr, struct MmcReqStats *stats);
 int32_t MmcCntlrParse(struct MmcCntlr *cntlr, struct HdfDeviceObject *obj);
 int32_t MmcCntlrCreatSdioIrqThread(struct MmcCntlr *cntlr);
 void MmcCntlrDestroySdioIrqThread(struct MmcCntlr *cntlr);
@@ -240,6 +269,26 @@ ssize_t MmcDeviceRead(struct MmcDevice *mmc, uint8_t *buf, size_t startSec, size
 ssize_t MmcDeviceWrite(struct MmcDevice *mmc, uint8_t *buf, size_t startSec, size_t nSec);
 ssize_t MmcDeviceErase(struct MmcDevice *mmc, size_t startSec, size_t nSec);
 
+typedef void (*MmcReqDone)(struct MmcReq *req);
+
+/*
+ * An asynchronous block read/write request. The caller owns the memory until done is called,
+ * done runs on the controller request worker and must not block.
+ */
+struct MmcReq {
+    struct DListHead node;
+    struct MmcDevice *mmc;
+    uint8_t *buf;
+    size_t startSec;
+    size_t nSec;
+    bool writeFlag;
+    int32_t error;
+    MmcReqDone done;
+    void *priv;
+};
+
+int32_t MmcDeviceSubmitRequest(struct MmcDevice *mmc, struct MmcReq *req);
+
 static inline bool MmcDeviceIsPresent(struct MmcDevice *mmc)
 {
     return (mmc != NULL && mmc->state.bits.present);
@@ -102,6 +102,8 @@ struct MtdDeviceMethod {
     int32_t (*write)(struct MtdDevice *mtdDevice, off_t to, size_t len, const uint8_t *buf);
     int32_t (*erase)(struct MtdDevice *mtdDevice, off_t addr, size_t len, off_t *faddr);
     int32_t (*pageTransfer)(struct MtdDevice *mtdDevice, struct MtdPage *mtdPage);
+    /* optional, transfers whole pages inside one erase block at once, without oob, e.g. by dma */
+    int32_t (*multiPageTransfer)(struct MtdDevice *mtdDevice, struct MtdPage *mtdPage);
     bool (*isBadBlock)(struct MtdDevice *mtdDevice, off_t addr);
     int32_t (*markBadBlock)(struct MtdDevice *mtdDevice, off_t addr);
     void (*dump)(struct MtdDevice *mtdDevice);
@@ -148,6 +150,10 @@ struct MtdDevice {
     unsigned int writeSizeShift;
     /** Mutex lock for accessing protection */
     struct OsalMutex lock;
+    /** Bad block table built when the device is added, one bit per erase block */
+    uint8_t *bbt;
+    /** Number of erase blocks covered by the bad block table */
+    size_t blockNum;
     /** The callback method set to access the device */
     struct MtdDeviceMethod *ops;
     /** Os specific data */
@@ -16,6 +16,7 @@
 #include "mmc_sdio.h"
 #include "osal_mem.h"
 #include "osal_time.h"
+#include "securec.h"
 
 #define HDF_LOG_TAG mmc_core_c
 
@@ -27,6 +28,7 @@
 #define MMC_MAX_SECTOR_NUM 2048
 #define MMC_MAX_ERASE_SECTOR 0x100000 /* 512M */
 #define SDIO_IRQ_TASK_STACK_SIZE 0x2000
+#define MMC_REQ_TASK_STACK_SIZE 0x4000
 
 int32_t MmcCntlrDoRequest(struct MmcCntlr *cntlr, struct MmcCmd *cmd)
 {
@@ -232,6 +234,12 @@ static int32_t MmcCntlrInit(struct MmcCntlr *cntlr)
         PlatformQueueDestroy(cntlr->msgQueue);
         return ret;
     }
+    ret = MmcCntlrReqQueueStart(cntlr);
+    if (ret != HDF_SUCCESS) {
+        HDF_LOGE("MmcCntlrInit: failed to start request queue!");
+        PlatformQueueDestroy(cntlr->msgQueue);
+        return ret;
+    }
 
     cntlr->service.Dispatch = MmcIoDispatch;
     cntlr->hdfDevObj->service = &(cntlr->service);
@@ -243,6 +251,7 @@ static int32_t MmcCntlrInit(struct MmcCntlr *cntlr)
 static void MmcCntlrUninit(struct MmcCntlr *cntlr)
 {
     if (cntlr != NULL) {
+        MmcCntlrReqQueueStop(cntlr);
         (void)OsalMutexDestroy(&cntlr->mutex);
         PlatformQueueDestroy(cntlr->msgQueue);
     }
@@ -1074,15 +1083,354 @@ static void MmcDeviceFillRwInfo(struct MmcRwData *info, uint8_t *buf,
     info->sectors = nSec;
 }
 
-ssize_t MmcDeviceRead(struct MmcDevice *mmc, uint8_t *buf, size_t startSec, size_t nSec)
+static bool MmcCntlrUseSbc(struct MmcCntlr *cntlr, size_t nSec)
+{
+    if (nSec <= 1 || cntlr->caps.bits.cmd23 == 0) {
+        return false;
+    }
+    return (MmcCntlrEmmcSupportCmd23(cntlr) || MmcCntlrSdSupportCmd23(cntlr));
+}
+
+static size_t MmcCntlrMaxTransferSec(struct MmcCntlr *cntlr)
+{
+    if (cntlr->maxBlkNum > 0 && cntlr->maxBlkNum < MMC_MAX_SECTOR_NUM) {
+        return cntlr->maxBlkNum;
+    }
+    return MMC_MAX_SECTOR_NUM;
+}
+
+static int32_t MmcCntlrExecRwBlocks(struct MmcCntlr *cntlr, struct MmcDevice *mmc, struct MmcRwData *info)
 {
+    struct MmcCmd sbc = {0};
     struct MmcCmd cmd = {0};
     struct MmcData data = {0};
+    bool useSbc = MmcCntlrUseSbc(cntlr, info->sectors);
+    uint32_t i;
+    int32_t ret = HDF_FAILURE;
+
+    cmd.data = &data;
+    MmcSetupReadWriteBlocksCmd(mmc, &cmd, info);
+    if (useSbc) {
+        /* CMD23 pre-defines the block count, so the transfer ends without CMD12. */
+        sbc.cmdCode = SET_BLOCK_COUNT;
+        sbc.argument = (uint32_t)info->sectors;
+        sbc.respType = MMC_RESP_R1 | MMC_CMD_TYPE_AC;
+        data.sendStopCmd = false;
+    }
+
+    for (i = 0; i < MMC_REQUEST_RETRY; i++) {
+        MmcCntlrLock(cntlr);
+        ret = HDF_SUCCESS;
+        if (useSbc) {
+            ret = MmcCntlrDoRequest(cntlr, &sbc);
+            if (ret == HDF_SUCCESS) {
+                ret = sbc.returnError;
+            }
+        }
+        if (ret == HDF_SUCCESS) {
+            ret = MmcCntlrDoRequest(cntlr, &cmd);
+        }
+        MmcCntlrUnlock(cntlr);
+        if (ret == HDF_SUCCESS) {
+            ret = (cmd.returnError != HDF_SUCCESS) ? cmd.returnError : data.returnError;
+        }
+        if (ret == HDF_SUCCESS) {
+            break;
+        }
+    }
+    if (ret == HDF_SUCCESS) {
+        (void)OsalSpinLock(&cntlr->reqQueue.spin);
+        cntlr->reqQueue.stats.transfers++;
+        if (useSbc) {
+            cntlr->reqQueue.stats.sbcTransfers++;
+        }
+        (void)OsalSpinUnlock(&cntlr->reqQueue.spin);
+    }
+    return ret;
+}
+
+static bool MmcReqCanMerge(const struct MmcReq *prev, const struct MmcReq *next)
+{
+    return (next->mmc == prev->mmc && next->writeFlag == prev->writeFlag &&
+        next->startSec == prev->startSec + prev->nSec &&
+        next->buf == prev->buf + prev->nSec * BYTES_PER_BLOCK);
+}
+
+/* Move the head request and every queued request continuing it into the batch. */
+static size_t MmcReqQueueFetchBatch(struct MmcReqQueue *queue, struct DListHead *batch)
+{
+    struct MmcReq *req = NULL;
+    struct MmcReq *last = NULL;
+    size_t nSec = 0;
+
+    (void)OsalSpinLock(&queue->spin);
+    while (!DListIsEmpty(&queue->reqs)) {
+        req = DLIST_FIRST_ENTRY(&queue->reqs, struct MmcReq, node);
+        if (last != NULL) {
+            if (!MmcReqCanMerge(last, req)) {
+                break;
+            }
+            queue->stats.merged++;
+        }
+        DListRemove(&req->node);
+        DListInsertTail(&req->node, batch);
+        nSec += req->nSec;
+        last = req;
+    }
+    (void)OsalSpinUnlock(&queue->spin);
+    return nSec;
+}
+
+static void MmcReqCompleteBatch(struct DListHead *batch, size_t doneSec, int32_t error)
+{
+    struct MmcReq *req = NULL;
+    struct MmcReq *tmp = NULL;
+    size_t reqEnd = 0;
+
+    DLIST_FOR_EACH_ENTRY_SAFE(req, tmp, batch, struct MmcReq, node) {
+        reqEnd += req->nSec;
+        DListRemove(&req->node);
+        req->error = (reqEnd <= doneSec) ? HDF_SUCCESS : error;
+        req->done(req);
+    }
+}
+
+static void MmcReqQueueProcessBatch(struct MmcCntlr *cntlr, struct DListHead *batch, size_t nSec)
+{
+    struct MmcReq *head = DLIST_FIRST_ENTRY(batch, struct MmcReq, node);
+    struct MmcRwData info = {0};
+    size_t maxSec = MmcCntlrMaxTransferSec(cntlr);
+    size_t doneSec = 0;
+    size_t curSec;
+    int32_t ret = HDF_SUCCESS;
+
+    if (MmcCntlrDevPluged(cntlr) == false) {
+        HDF_LOGE("MmcReqQueueProcessBatch: host%d dev is unplug!", cntlr->index);
+        ret = HDF_PLT_ERR_NO_DEV;
+    }
+    while (ret == HDF_SUCCESS && doneSec < nSec) {
+        curSec = MMC_MIN(nSec - doneSec, maxSec);
+        MmcDeviceFillRwInfo(&info, head->buf + doneSec * BYTES_PER_BLOCK, head->writeFlag,
+            head->startSec + doneSec, curSec);
+        ret = MmcCntlrExecRwBlocks(cntlr, head->mmc, &info);
+        if (ret != HDF_SUCCESS) {
+            HDF_LOGE("MmcReqQueueProcessBatch: transfer at sector %u fail, ret: %d!", (uint32_t)info.startSector, ret);
+            break;
+        }
+        doneSec += curSec;
+    }
+    MmcReqCompleteBatch(batch, doneSec, ret);
+}
+
+static int32_t MmcReqQueueWorker(void *data)
+{
+    struct MmcCntlr *cntlr = (struct MmcCntlr *)data;
+    struct MmcReqQueue *queue = &cntlr->reqQueue;
+    struct DListHead batch;
+    size_t nSec;
+
+    while (true) {
+        /* wait envent */
+        if (OsalSemWait(&queue->sem, HDF_WAIT_FOREVER) != HDF_SUCCESS) {
+            continue;
+        }
+        if (!queue->running) {
+            break;
+        }
+        DListHeadInit(&batch);
+        nSec = MmcReqQueueFetchBatch(queue, &batch);
+        if (nSec > 0) {
+            MmcReqQueueProcessBatch(cntlr, &batch, nSec);
+        }
+    }
+    /* a batch in progress has been completed, MmcCntlrReqQueueStop may tear the queue down now */
+    (void)OsalSemPost(&queue->exited);
+    return HDF_SUCCESS;
+}
+
+int32_t MmcCntlrReqQueueStart(struct MmcCntlr *cntlr)
+{
+    int32_t ret;
+    struct OsalThreadParam config = {0};
+    struct MmcReqQueue *queue = NULL;
+
+    if (cntlr == NULL) {
+        return HDF_ERR_INVALID_OBJECT;
+    }
+
+    queue = &cntlr->reqQueue;
+    DListHeadInit(&queue->reqs);
+    (void)memset_s(&queue->stats, sizeof(queue->stats), 0, sizeof(queue->stats));
+    (void)OsalSpinInit(&queue->spin);
+    ret = OsalSemInit(&queue->sem, 0);
+    if (ret != HDF_SUCCESS) {
+        HDF_LOGE("MmcCntlrReqQueueStart: sem init fail!");
+        (void)OsalSpinDestroy(&queue->spin);
+        return ret;
+    }
+    ret = OsalSemInit(&queue->exited, 0);
+    if (ret != HDF_SUCCESS) {
+        HDF_LOGE("MmcCntlrReqQueueStart: exit sem init fail!");
+        (void)OsalSemDestroy(&queue->sem);
+        (void)OsalSpinDestroy(&queue->spin);
+        return ret;
+    }
+
+    ret = OsalThreadCreate(&queue->thread, (OsalThreadEntry)MmcReqQueueWorker, cntlr);
+    if (ret != HDF_SUCCESS) {
+        HDF_LOGE("MmcCntlrReqQueueStart: thread create fail!");
+        (void)OsalSemDestroy(&queue->exited);
+        (void)OsalSemDestroy(&queue->sem);
+        (void)OsalSpinDestroy(&queue->spin);
+        return ret;
+    }
+
+    queue->running = true;
+    config.name = "MmcReqTask";
+    config.priority = OSAL_THREAD_PRI_HIGHEST;
+    config.stackSize = MMC_REQ_TASK_STACK_SIZE;
+    ret = OsalThreadStart(&queue->thread, &config);
+    if (ret != HDF_SUCCESS) {
+        HDF_LOGE("MmcCntlrReqQueueStart: thread start fail!");
+        queue->running = false;
+        (void)OsalThreadDestroy(&queue->thread);
+        (void)OsalSemDestroy(&queue->exited);
+        (void)OsalSemDestroy(&queue->sem);
+        (void)OsalSpinDestroy(&queue->spin);
+        return ret;
+    }
+    return HDF_SUCCESS;
+}
+
+void MmcCntlrReqQueueStop(struct MmcCntlr *cntlr)
+{
+    struct MmcReqQueue *queue = NULL;
+    struct DListHead pending;
+
+    if (cntlr == NULL || cntlr->reqQueue.running == false) {
+        return;
+    }
+
+    queue = &cntlr->reqQueue;
+    DListHeadInit(&pending);
+    (void)OsalSpinLock(&queue->spin);
+    queue->running = false;
+    if (!DListIsEmpty(&queue->reqs)) {
+        DListMerge(&queue->reqs, &pending);
+    }
+    (void)OsalSpinUnlock(&queue->spin);
+    /* fail the queued requests, then let the worker finish the batch it is on and leave */
+    MmcReqCompleteBatch(&pending, 0, HDF_PLT_ERR_NO_DEV);
+    (void)OsalSemPost(&queue->sem);
+    (void)OsalSemWait(&queue->exited, HDF_WAIT_FOREVER);
+    (void)OsalThreadDestroy(&queue->thread);
+    (void)OsalSemDestroy(&queue->exited);
+    (void)OsalSemDestroy(&queue->sem);
+    (void)OsalSpinDestroy(&queue->spin);
+}
+
+void MmcCntlrGetReqStats(struct MmcCntlr *cntlr, struct MmcReqStats *stats)
+{
+    if (cntlr == NULL || stats == NULL) {
+        return;
+    }
+    (void)OsalSpinLock(&cntlr->reqQueue.spin);
+    *stats = cntlr->reqQueue.stats;
+    (void)OsalSpinUnlock(&cntlr->reqQueue.spin);
+}
+
+int32_t MmcDeviceSubmitRequest(struct MmcDevice *mmc, struct MmcReq *req)
+{
+    struct MmcReqQueue *queue = NULL;
+
+    if (mmc == NULL || mmc->cntlr == NULL) {
+        return HDF_ERR_INVALID_OBJECT;
+    }
+    if (req == NULL || req->buf == NULL || req->nSec == 0 || req->done == NULL) {
+        return HDF_ERR_INVALID_PARAM;
+    }
+    if (MmcCntlrDevPluged(mmc->cntlr) == false) {
+        HDF_LOGE("MmcDeviceSubmitRequest: host%d dev is unplug!", mmc->cntlr->index);
+        return HDF_PLT_ERR_NO_DEV;
+    }
+
+    queue = &mmc->cntlr->reqQueue;
+    req->mmc = mmc;
+    req->error = HDF_SUCCESS;
+    DListHeadInit(&req->node);
+    (void)OsalSpinLock(&queue->spin);
+    if (queue->running == false) {
+        (void)OsalSpinUnlock(&queue->spin);
+        return HDF_ERR_DEVICE_BUSY;
+    }
+    DListInsertTail(&req->node, &queue->reqs);
+    queue->stats.submitted++;
+    (void)OsalSpinUnlock(&queue->spin);
+    /* notify the worker thread */
+    (void)OsalSemPost(&queue->sem);
+    return HDF_SUCCESS;
+}
+
+static int32_t MmcDeviceRwDirect(struct MmcDevice *mmc, uint8_t *buf, size_t startSec, size_t nSec, bool writeFlag)
+{
     struct MmcRwData info = {0};
     size_t curSec = nSec;
     size_t curStartSec = startSec;
-    size_t readSec;
-    ssize_t ret;
+    size_t rwSec;
+    int32_t ret;
+
+    while (curSec > 0) {
+        rwSec = MMC_MIN(curSec, MMC_MAX_SECTOR_NUM);
+        MmcDeviceFillRwInfo(&info, buf, writeFlag, curStartSec, rwSec);
+        ret = MmcSendReadWriteBlocks(mmc->cntlr, &info);
+        if (ret != HDF_SUCCESS) {
+            return ret;
+        }
+        curSec -= rwSec;
+        curStartSec += rwSec;
+        buf += (rwSec * BYTES_PER_BLOCK);
+    }
+    return HDF_SUCCESS;
+}
+
+static void MmcReqWakeUp(struct MmcReq *req)
+{
+    (void)OsalSemPost((struct OsalSem *)req->priv);
+}
+
+static int32_t MmcDeviceRwSync(struct MmcDevice *mmc, uint8_t *buf, size_t startSec, size_t nSec, bool writeFlag)
+{
+    struct MmcReq req = {0};
+    struct OsalSem sem;
+    int32_t ret;
+
+    if (mmc->cntlr->detecting == true) {
+        /* In SD device detecting, VFS will read/write SD. */
+        return MmcDeviceRwDirect(mmc, buf, startSec, nSec, writeFlag);
+    }
+
+    ret = OsalSemInit(&sem, 0);
+    if (ret != HDF_SUCCESS) {
+        return ret;
+    }
+    req.buf = buf;
+    req.startSec = startSec;
+    req.nSec = nSec;
+    req.writeFlag = writeFlag;
+    req.done = MmcReqWakeUp;
+    req.priv = &sem;
+    ret = MmcDeviceSubmitRequest(mmc, &req);
+    if (ret == HDF_SUCCESS) {
+        (void)OsalSemWait(&sem, HDF_WAIT_FOREVER);
+        ret = req.error;
+    }
+    (void)OsalSemDestroy(&sem);
+    return ret;
+}
+
+ssize_t MmcDeviceRead(struct MmcDevice *mmc, uint8_t *buf, size_t startSec, size_t nSec)
+{
+    int32_t ret;
 
     if (mmc == NULL) {
         HDF_LOGE("MmcDeviceRead: mmc is null!");
@@ -1092,43 +1440,21 @@ ssize_t MmcDeviceRead(struct MmcDevice *mmc, uint8_t *buf, size_t startSec, size
         HDF_LOGE("MmcDeviceRead: buf is null!");
         return HDF_ERR_INVALID_PARAM;
     }
+    if (nSec == 0) {
+        return 0;
+    }
 
-    do {
-        if (curSec >= MMC_MAX_SECTOR_NUM) {
-            readSec = MMC_MAX_SECTOR_NUM;
-        } else {
-            readSec = curSec;
-        }
-        MmcDeviceFillRwInfo(&info, buf, false, curStartSec, readSec);
-        if (mmc->cntlr->detecting == true) {
-            /* In SD device detecting, VFS will read/write SD. */
-            ret = MmcSendReadWriteBlocks(mmc->cntlr, &info);
-        } else {
-            cmd.data = &data;
-            MmcSetupReadWriteBlocksCmd(mmc, &cmd, &info);
-            ret = MmcCntlrAddRequestMsgToQueue(mmc->cntlr, &cmd);
-        }
-        if (ret != HDF_SUCCESS) {
-            HDF_LOGE("MmcDeviceRead: fail!");
-            return ret;
-        }
-        curSec -= readSec;
-        curStartSec += readSec;
-        buf += (readSec * BYTES_PER_BLOCK);
-    } while (curSec > 0);
-
+    ret = MmcDeviceRwSync(mmc, buf, startSec, nSec, false);
+    if (ret != HDF_SUCCESS) {
+        HDF_LOGE("MmcDeviceRead: fail!");
+        return ret;
+    }
     return nSec;
 }
 
 ssize_t MmcDeviceWrite(struct MmcDevice *mmc, uint8_t *buf, size_t startSec, size_t nSec)
 {
-    struct MmcCmd cmd = {0};
-    struct MmcData data = {0};
-    struct MmcRwData info = {0};
-    size_t curSec = nSec;
-    size_t curStartSec = startSec;
-    size_t writeSec;
-    ssize_t ret;
+    int32_t ret;
 
     if (mmc == NULL) {
         HDF_LOGE("MmcDeviceWrite: mmc is null!");
@@ -1138,31 +1464,15 @@ ssize_t MmcDeviceWrite(struct MmcDevice *mmc, uint8_t *buf, size_t startSec, siz
         HDF_LOGE("MmcDeviceWrite: buf is null!");
         return HDF_ERR_INVALID_PARAM;
     }
+    if (nSec == 0) {
+        return 0;
+    }
 
-    do {
-        if (curSec >= MMC_MAX_SECTOR_NUM) {
-            writeSec = MMC_MAX_SECTOR_NUM;
-        } else {
-            writeSec = curSec;
-        }
-        MmcDeviceFillRwInfo(&info, buf, true, curStartSec, writeSec);
-        if (mmc->cntlr->detecting == true) {
-            /* In SD device detecting, VFS will read/write SD. */
-            ret = MmcSendReadWriteBlocks(mmc->cntlr, &info);
-        } else {
-            cmd.data = &data;
-            MmcSetupReadWriteBlocksCmd(mmc, &cmd, &info);
-            ret = MmcCntlrAddRequestMsgToQueue(mmc->cntlr, &cmd);
-        }
-        if (ret != HDF_SUCCESS) {
-            HDF_LOGE("MmcDeviceWrite: fail!");
-            return ret;
-        }
-        curSec -= writeSec;
-        curStartSec += writeSec;
-        buf += (writeSec * BYTES_PER_BLOCK);
-    } while (curSec > 0);
-
+    ret = MmcDeviceRwSync(mmc, buf, startSec, nSec, true);
+    if (ret != HDF_SUCCESS) {
+        HDF_LOGE("MmcDeviceWrite: fail!");
+        return ret;
+    }
     return nSec;
 }
 
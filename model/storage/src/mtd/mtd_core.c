@@ -12,8 +12,11 @@
 #include "hdf_log.h"
 #include "mtd_block.h"
 #include "mtd_char.h"
+#include "osal_mem.h"
 #include "platform_core.h"
 
+#define MTD_BBT_BITS_PER_BYTE 8
+
 static int32_t MtdDeviceCheckParms(struct MtdDevice *mtdDevice)
 {
     if (mtdDevice->index < 0 || mtdDevice->index >= MTD_DEVICE_NUM_MAX) {
@@ -96,6 +99,54 @@ static void MtdDeviceUnlockDefault(struct MtdDevice *mtdDevice)
     return;
 }
 
+static inline bool MtdBbtTest(const uint8_t *bbt, size_t block)
+{
+    return (bbt[block / MTD_BBT_BITS_PER_BYTE] & (1 << (block % MTD_BBT_BITS_PER_BYTE))) != 0;
+}
+
+static inline void MtdBbtSet(uint8_t *bbt, size_t block)
+{
+    bbt[block / MTD_BBT_BITS_PER_BYTE] |= (uint8_t)(1 << (block % MTD_BBT_BITS_PER_BYTE));
+}
+
+/*
+ * Scan the bad block markers once, so later accesses do not need an oob read per block.
+ * Devices without bad block management, e.g. nor flash, get no table.
+ */
+static int32_t MtdDeviceBbtInit(struct MtdDevice *mtdDevice)
+{
+    size_t block;
+    size_t badNum = 0;
+
+    if (mtdDevice->ops->isBadBlock == NULL) {
+        return HDF_SUCCESS;
+    }
+
+    mtdDevice->blockNum = mtdDevice->capacity / mtdDevice->eraseSize;
+    mtdDevice->bbt = (uint8_t *)OsalMemCalloc((mtdDevice->blockNum + MTD_BBT_BITS_PER_BYTE - 1) /
+        MTD_BBT_BITS_PER_BYTE);
+    if (mtdDevice->bbt == NULL) {
+        HDF_LOGE("%s: alloc bbt failed, blockNum=%zu", __func__, mtdDevice->blockNum);
+        return HDF_ERR_MALLOC_FAIL;
+    }
+
+    for (block = 0; block < mtdDevice->blockNum; block++) {
+        if (mtdDevice->ops->isBadBlock(mtdDevice, (off_t)(block * mtdDevice->eraseSize))) {
+            MtdBbtSet(mtdDevice->bbt, block);
+            badNum++;
+        }
+    }
+    HDF_LOGI("%s: %zu bad blocks in %zu", __func__, badNum, mtdDevice->blockNum);
+    return HDF_SUCCESS;
+}
+
+static void MtdDeviceBbtUninit(struct MtdDevice *mtdDevice)
+{
+    OsalMemFree(mtdDevice->bbt);
+    mtdDevice->bbt = NULL;
+    mtdDevice->blockNum = 0;
+}
+
 struct PlatformManager *MtdManagerGet(void)
 {
     static struct PlatformManager *g_mtdManager = NULL;
@@ -134,11 +185,17 @@ int32_t MtdDeviceAdd(struct MtdDevice *mtdDevice)
         mtdDevice->ops->unlock = MtdDeviceUnlockDefault;
     }
 
+    ret = MtdDeviceBbtInit(mtdDevice);
+    if (ret != HDF_SUCCESS) {
+        return ret;
+    }
+
     mtdDevice->device.manager = MtdManagerGet();
     mtdDevice->device.number = mtdDevice->index;
     ret = PlatformDeviceAdd(&mtdDevice->device);
     if (ret != HDF_SUCCESS) {
         HDF_LOGE("%s: mtd device add fail", __func__);
+        MtdDeviceBbtUninit(mtdDevice);
         return ret;
     }
 
@@ -147,12 +204,14 @@ int32_t MtdDeviceAdd(struct MtdDevice *mtdDevice)
     ret = MtdCharInit(mtdDevice);
     if (ret != HDF_SUCCESS) {
         PlatformDeviceDel(&mtdDevice->device);
+        MtdDeviceBbtUninit(mtdDevice);
         return ret;
     }
 
     ret = MtdBlockInit(mtdDevice);
     if (ret != HDF_SUCCESS) {
         PlatformDeviceDel(&mtdDevice->device);
+        MtdDeviceBbtUninit(mtdDevice);
         return ret;
     }
 
@@ -165,6 +224,7 @@ void MtdDeviceDel(struct MtdDevice *mtdDevice)
         MtdCharUninit(mtdDevice);
         MtdBlockUninit(mtdDevice);
         PlatformDeviceDel(&mtdDevice->device);
+        MtdDeviceBbtUninit(mtdDevice);
         (void)OsalMutexDestroy(&mtdDevice->lock);
     }
 }
@@ -256,6 +316,14 @@ ssize_t MtdDeviceErase(struct MtdDevice *mtdDevice, off_t addr, size_t len, off_
 
 static bool MtdDeviceIsBadBlockUnlocked(struct MtdDevice *mtdDevice, off_t addr)
 {
+    size_t block;
+
+    if (mtdDevice != NULL && mtdDevice->bbt != NULL && addr >= 0) {
+        block = (size_t)addr / mtdDevice->eraseSize;
+        if (block < mtdDevice->blockNum) {
+            return MtdBbtTest(mtdDevice->bbt, block);
+        }
+    }
     if (mtdDevice != NULL && mtdDevice->ops != NULL && mtdDevice->ops->isBadBlock != NULL) {
         return mtdDevice->ops->isBadBlock(mtdDevice, addr);
     }
@@ -269,14 +337,18 @@ static int32_t MtdDeviceMarkBadBlockUnlocked(struct MtdDevice *mtdDevice, off_t
     if (mtdDevice == NULL) {
         return HDF_ERR_INVALID_OBJECT;
     }
-    if (mtdDevice->ops == NULL && mtdDevice->ops->markBadBlock == NULL) {
+    if (mtdDevice->ops == NULL || mtdDevice->ops->markBadBlock == NULL) {
         return HDF_ERR_NOT_SUPPORT;
     }
     ret = mtdDevice->ops->markBadBlock(mtdDevice, addr);
     if (ret != HDF_SUCCESS) {
         HDF_LOGE("%s: mark bad block failed, addr=%jx, ret=%d", __func__, addr, ret);
+        return ret;
     }
-    return ret;
+    if (mtdDevice->bbt != NULL && addr >= 0 && ((size_t)addr / mtdDevice->eraseSize) < mtdDevice->blockNum) {
+        MtdBbtSet(mtdDevice->bbt, (size_t)addr / mtdDevice->eraseSize);
+    }
+    return HDF_SUCCESS;
 }
 
 bool MtdDeviceIsBadBlock(struct MtdDevice *mtdDevice, off_t addr)
@@ -327,6 +399,34 @@ static int32_t MtdDevicePageTransferUnlocked(struct MtdDevice *mtdDevice, struct
     return ret;
 }
 
+static int32_t MtdDeviceMultiPageTransferUnlocked(struct MtdDevice *mtdDevice, struct MtdPage *mtdPage)
+{
+    int32_t ret;
+
+#ifdef MTD_DEBUG
+    HDF_LOGD("%s: mtdPage-> type=%d, addr=0x%jx, databuf=%p, datalen=%zu", __func__,
+        mtdPage->type, mtdPage->addr, mtdPage->dataBuf, mtdPage->dataLen);
+#endif
+
+    ret = mtdDevice->ops->multiPageTransfer(mtdDevice, mtdPage);
+    if (ret != HDF_SUCCESS) {
+        HDF_LOGE("%s: do multi page transfer failed, ret = %d, addr = 0x%jx", __func__, ret, mtdPage->addr);
+    }
+    return ret;
+}
+
+/* Length of the whole pages which can go in one multi page transfer, 0 if a single page transfer is needed. */
+static size_t MtdDeviceMultiPageLen(struct MtdDevice *mtdDevice, struct MtdMsg *msg, off_t addr, size_t blockSize)
+{
+    size_t len;
+
+    if (msg->withOob || mtdDevice->ops->multiPageTransfer == NULL || !MtdDeviceIsPageAligned(mtdDevice, addr)) {
+        return 0;
+    }
+    len = blockSize - (blockSize % mtdDevice->writeSize);
+    return (len > mtdDevice->writeSize) ? len : 0;
+}
+
 static int32_t MtdDeviceCheckMsg(struct MtdDevice *mtdDevice, struct MtdMsg *msg)
 {
     size_t oobSize;
@@ -400,13 +500,20 @@ static int32_t MtdDeviceWriteReadByPageUnlock(struct MtdDevice *mtdDevice, struc
         while (blockSize > 0) {
             mtdPage.addr = addr;
             mtdPage.dataBuf = (uint8_t *)buf;
-            mtdPage.dataLen = mtdDevice->writeSize - (addr & (mtdDevice->writeSize - 1));
-            if (mtdPage.dataLen > blockSize) {
-                mtdPage.dataLen = blockSize;
+            mtdPage.dataLen = MtdDeviceMultiPageLen(mtdDevice, msg, addr, blockSize);
+            if (mtdPage.dataLen > 0) {
+                mtdPage.oobBuf = NULL;
+                mtdPage.oobLen = 0;
+                ret = MtdDeviceMultiPageTransferUnlocked(mtdDevice, &mtdPage);
+            } else {
+                mtdPage.dataLen = mtdDevice->writeSize - (addr & (mtdDevice->writeSize - 1));
+                if (mtdPage.dataLen > blockSize) {
+                    mtdPage.dataLen = blockSize;
+                }
+                mtdPage.oobBuf = msg->withOob ? (buf + mtdPage.dataLen) : NULL;
+                mtdPage.oobLen = msg->withOob ? mtdDevice->oobSize : 0;
+                ret = MtdDevicePageTransferUnlocked(mtdDevice, &mtdPage);
             }
-            mtdPage.oobBuf = msg->withOob ? (buf + mtdPage.dataLen) : NULL;
-            mtdPage.oobLen = msg->withOob ? mtdDevice->oobSize : 0;
-            ret = MtdDevicePageTransferUnlocked(mtdDevice, &mtdPage);
             if (ret != HDF_SUCCESS) {
                 MtdDumpBuf(mtdPage.dataBuf, mtdPage.dataLen + mtdPage.oobLen);
                 return ret;
@@ -26,15 +26,9 @@ struct UsbPnpMatchIdTable {
     const char *deviceMatchAttr;
 
     int32_t interfaceClassLength;
-    uint32_t interfaceClassMask;
     int32_t interfaceSubClassLength;
-    uint32_t interfaceSubClassMask;
     int32_t interfaceProtocolLength;
-    uint32_t interfaceProtocolMask;
     int32_t interfaceLength;
-    uint32_t interfaceMask;
-
-    uint8_t pnpMatchFlag;
 
     uint8_t length;
 
@@ -15,6 +15,7 @@
 #include "hdf_log.h"
 #include "hdf_sbuf.h"
 #include "osal_mem.h"
+#include "osal_mutex.h"
 #include "osal_time.h"
 #include "securec.h"
 #include "usb_pnp_manager.h"
@@ -22,9 +23,49 @@
 #define HDF_LOG_TAG USB_DDK_PNP_LOADER
 
 #define USB_DDK_PNP_CLASS_VENDOR_SPEC   0xFF
+#define USB_PNP_INDEX_KIND_SHIFT        32
+#define USB_PNP_VENDOR_ID_SHIFT         16
+#define USB_PNP_BITS_PER_WORD           32
+
+enum UsbPnpMatchIndexKind {
+    USB_PNP_INDEX_VENDOR_PRODUCT,
+    USB_PNP_INDEX_VENDOR,
+    USB_PNP_INDEX_DEV_CLASS,
+    USB_PNP_INDEX_INT_CLASS,
+    USB_PNP_INDEX_ANY,
+};
+
+struct UsbPnpMatchIndexEntry {
+    uint64_t key;
+    int32_t tableIndex;
+};
+
+/*
+ * Built once from the hcs match tables and sorted by key, read-only afterwards. Every table is
+ * filed under its most selective key so that a hot-plug event only visits the tables it can match.
+ */
+struct UsbPnpMatchIndex {
+    int32_t tableCount;
+    int32_t entryCount;
+    struct UsbPnpMatchIndexEntry *entries;
+};
+
+/* matching progress of one candidate table, private to a single hot-plug event */
+struct UsbPnpMatchState {
+    const struct UsbPnpMatchIdTable *idTable;
+    int32_t matchIndex;
+    uint32_t interfaceClassMask;
+    uint32_t interfaceSubClassMask;
+    uint32_t interfaceProtocolMask;
+    uint32_t interfaceMask;
+    int32_t interfaceLength;
+    uint8_t interfaceNumber[USB_PNP_INFO_MAX_INTERFACES];
+};
 
 static struct DListHead g_usbPnpDeviceTableListHead;
+static struct OsalMutex g_usbPnpDeviceTableListLock;
 static struct UsbPnpMatchIdTable **g_usbPnpMatchIdTable = NULL;
+static struct UsbPnpMatchIndex g_usbPnpMatchIndex;
 
 static struct HdfSBuf *UsbDdkPnpLoaderBufCreate(const char *moduleName,
     const char *serviceName, const char *deviceMatchAttr, struct UsbPnpNotifyServiceInfo serviceInfo)
@@ -106,200 +147,185 @@ static bool UsbDdkPnpLoaderMatchDevice(const struct UsbPnpNotifyMatchInfoTable *
     return true;
 }
 
-static void UsbDdkPnpLoaderMatchHandle(const struct UsbPnpNotifyMatchInfoTable *dev,
-    int8_t index, struct UsbPnpMatchIdTable *id, bool flag)
+static bool UsbDdkPnpLoaderMatchField(bool enabled, const uint8_t *list, int32_t length, uint8_t value,
+    uint32_t *mask)
 {
-    if ((!id->pnpMatchFlag) && flag) {
-        if (!(id->matchFlag & USB_PNP_NOTIFY_MATCH_INT_CLASS)) {
-            id->interfaceClass[id->interfaceClassLength++] = dev->interfaceInfo[index].interfaceClass;
-        }
-        if (!(id->matchFlag & USB_PNP_NOTIFY_MATCH_INT_SUBCLASS)) {
-            id->interfaceSubClass[id->interfaceSubClassLength++] = dev->interfaceInfo[index].interfaceSubClass;
-        }
-        if (!(id->matchFlag & USB_PNP_NOTIFY_MATCH_INT_PROTOCOL)) {
-            id->interfaceProtocol[id->interfaceProtocolLength++] = dev->interfaceInfo[index].interfaceProtocol;
-        }
-        if (!(id->matchFlag & USB_PNP_NOTIFY_MATCH_INT_NUMBER)) {
-            id->interfaceNumber[id->interfaceLength++] = dev->interfaceInfo[index].interfaceNumber;
+    int32_t i;
+
+    if (!enabled) {
+        return true;
+    }
+    for (i = 0; i < length; i++) {
+        if (list[i] == value) {
+            *mask |= (1U << (uint32_t)i);
+            return true;
         }
     }
+    return false;
 }
 
-static bool UsbDdkPnpLoaderMatchFlagFirst(struct UsbPnpMatchIdTable *id)
+static bool UsbDdkPnpLoaderMaskFull(bool enabled, int32_t length, uint32_t mask)
 {
     int32_t i;
-    bool ret = true;
-    uint32_t offset;
 
-    if (id->matchFlag & USB_PNP_NOTIFY_MATCH_INT_CLASS) {
-        for (i = 0; i < id->interfaceClassLength; i++) {
-            offset = i;
-            if (!((id->interfaceClassMask >> offset) & 0x01)) {
-                break;
-            }
-        }
-        if (i < id->interfaceClassLength) {
-            ret = false;
-            goto OUT;
-        }
+    if (!enabled) {
+        return true;
     }
-
-    if (id->matchFlag & USB_PNP_NOTIFY_MATCH_INT_SUBCLASS) {
-        for (i = 0; i < id->interfaceSubClassLength; i++) {
-            offset = i;
-            if (!((id->interfaceSubClassMask >> offset) & 0x01)) {
-                break;
-            }
-        }
-        if (i < id->interfaceSubClassLength) {
-            ret = false;
-            goto OUT;
+    for (i = 0; i < length; i++) {
+        if (!((mask >> (uint32_t)i) & 0x01)) {
+            return false;
         }
     }
+    return true;
+}
 
-    ret = true;
+static bool UsbDdkPnpLoaderMatchOneIdIntf(const struct UsbPnpNotifyMatchInfoTable *dev,
+    int8_t index, struct UsbPnpMatchState *state)
+{
+    bool maskFlag = true;
+    const struct UsbPnpMatchIdTable *id = state->idTable;
+    const struct UsbPnpNotifyInterfaceInfo *intf = &dev->interfaceInfo[index];
 
-OUT:
-    return ret;
+    if (dev->deviceInfo.deviceClass == USB_DDK_PNP_CLASS_VENDOR_SPEC &&
+        !(id->matchFlag & USB_PNP_NOTIFY_MATCH_VENDOR) &&
+        (id->matchFlag & (USB_PNP_NOTIFY_MATCH_INT_CLASS | USB_PNP_NOTIFY_MATCH_INT_SUBCLASS |
+        USB_PNP_NOTIFY_MATCH_INT_PROTOCOL | USB_PNP_NOTIFY_MATCH_INT_NUMBER))) {
+        return false;
+    }
+
+    maskFlag = UsbDdkPnpLoaderMatchField(id->matchFlag & USB_PNP_NOTIFY_MATCH_INT_CLASS, id->interfaceClass,
+        id->interfaceClassLength, intf->interfaceClass, &state->interfaceClassMask) && maskFlag;
+    maskFlag = UsbDdkPnpLoaderMatchField(id->matchFlag & USB_PNP_NOTIFY_MATCH_INT_SUBCLASS, id->interfaceSubClass,
+        id->interfaceSubClassLength, intf->interfaceSubClass, &state->interfaceSubClassMask) && maskFlag;
+    maskFlag = UsbDdkPnpLoaderMatchField(id->matchFlag & USB_PNP_NOTIFY_MATCH_INT_PROTOCOL, id->interfaceProtocol,
+        id->interfaceProtocolLength, intf->interfaceProtocol, &state->interfaceProtocolMask) && maskFlag;
+    maskFlag = UsbDdkPnpLoaderMatchField(id->matchFlag & USB_PNP_NOTIFY_MATCH_INT_NUMBER, id->interfaceNumber,
+        id->interfaceLength, intf->interfaceNumber, &state->interfaceMask) && maskFlag;
+
+    /* interfaces matching every configured field are handed to the driver unless it names them itself */
+    if (maskFlag && !(id->matchFlag & USB_PNP_NOTIFY_MATCH_INT_NUMBER) &&
+        (state->interfaceLength < USB_PNP_INFO_MAX_INTERFACES)) {
+        state->interfaceNumber[state->interfaceLength++] = intf->interfaceNumber;
+    }
+
+    return UsbDdkPnpLoaderMaskFull(id->matchFlag & USB_PNP_NOTIFY_MATCH_INT_CLASS,
+        id->interfaceClassLength, state->interfaceClassMask) &&
+        UsbDdkPnpLoaderMaskFull(id->matchFlag & USB_PNP_NOTIFY_MATCH_INT_SUBCLASS,
+        id->interfaceSubClassLength, state->interfaceSubClassMask) &&
+        UsbDdkPnpLoaderMaskFull(id->matchFlag & USB_PNP_NOTIFY_MATCH_INT_PROTOCOL,
+        id->interfaceProtocolLength, state->interfaceProtocolMask) &&
+        UsbDdkPnpLoaderMaskFull(id->matchFlag & USB_PNP_NOTIFY_MATCH_INT_NUMBER,
+        id->interfaceLength, state->interfaceMask);
 }
 
-static bool UsbDdkPnpLoaderMatchFlag(const struct UsbPnpNotifyMatchInfoTable *dev,
-    int8_t index, struct UsbPnpMatchIdTable *id, bool flag)
+static uint64_t UsbDdkPnpLoaderIndexKey(enum UsbPnpMatchIndexKind kind, uint32_t value)
 {
-    int32_t i;
-    bool ret = true;
-    uint32_t offset;
+    return ((uint64_t)kind << USB_PNP_INDEX_KIND_SHIFT) | value;
+}
 
-    if (!UsbDdkPnpLoaderMatchFlagFirst(id)) {
-        ret = false;
-        goto OUT;
+static uint64_t UsbDdkPnpLoaderTableKey(const struct UsbPnpMatchIdTable *id)
+{
+    if ((id->matchFlag & USB_PNP_NOTIFY_MATCH_VENDOR) && (id->matchFlag & USB_PNP_NOTIFY_MATCH_PRODUCT)) {
+        return UsbDdkPnpLoaderIndexKey(USB_PNP_INDEX_VENDOR_PRODUCT,
+            ((uint32_t)id->vendorId << USB_PNP_VENDOR_ID_SHIFT) | id->productId);
     }
-
-    if (id->matchFlag & USB_PNP_NOTIFY_MATCH_INT_PROTOCOL) {
-        for (i = 0; i < id->interfaceProtocolLength; i++) {
-            offset = i;
-            if (!((id->interfaceProtocolMask >> offset) & 0x01)) {
-                break;
-            }
-        }
-        if (i < id->interfaceProtocolLength) {
-            ret = false;
-            goto OUT;
-        }
+    if (id->matchFlag & USB_PNP_NOTIFY_MATCH_VENDOR) {
+        return UsbDdkPnpLoaderIndexKey(USB_PNP_INDEX_VENDOR, id->vendorId);
     }
-
-    if (id->matchFlag & USB_PNP_NOTIFY_MATCH_INT_NUMBER) {
-        for (i = 0; i < id->interfaceLength; i++) {
-            offset = i;
-            if (!((id->interfaceMask >> offset) & 0x01)) {
-                break;
-            }
-        }
-        if (i < id->interfaceLength) {
-            ret = false;
-            goto OUT;
-        }
+    if (id->matchFlag & USB_PNP_NOTIFY_MATCH_DEV_CLASS) {
+        return UsbDdkPnpLoaderIndexKey(USB_PNP_INDEX_DEV_CLASS, id->deviceClass);
     }
-
-    ret = true;
-
-OUT:
-    UsbDdkPnpLoaderMatchHandle(dev, index, id, flag);
-
-    return ret;
+    /* every listed interface class has to be present, so the first one is a valid filter */
+    if ((id->matchFlag & USB_PNP_NOTIFY_MATCH_INT_CLASS) && (id->interfaceClassLength > 0)) {
+        return UsbDdkPnpLoaderIndexKey(USB_PNP_INDEX_INT_CLASS, id->interfaceClass[0]);
+    }
+    return UsbDdkPnpLoaderIndexKey(USB_PNP_INDEX_ANY, 0);
 }
 
-static bool UsbDdkPnpLoaderMatchInterface(const struct UsbPnpNotifyMatchInfoTable *dev,
-    int8_t index, struct UsbPnpMatchIdTable *id)
+static void UsbDdkPnpLoaderReleaseIndex(struct UsbPnpMatchIndex *index)
 {
-    uint32_t i;
-    bool maskFlag = true;
-
-    if (id->matchFlag & USB_PNP_NOTIFY_MATCH_INT_CLASS) {
-        for (i = 0; i < id->interfaceClassLength; i++) {
-            if (id->interfaceClass[i] == dev->interfaceInfo[index].interfaceClass) {
-                id->interfaceClassMask |= (1 << i);
-                break;
-            }
-        }
-
-        if (i >= id->interfaceClassLength) {
-            maskFlag = false;
-        }
+    if (index->entries != NULL) {
+        OsalMemFree(index->entries);
+        index->entries = NULL;
     }
+    index->entryCount = 0;
+    index->tableCount = 0;
+}
 
-    if (id->matchFlag & USB_PNP_NOTIFY_MATCH_INT_SUBCLASS) {
-        for (i = 0; i < id->interfaceSubClassLength; i++) {
-            if (id->interfaceSubClass[i] == dev->interfaceInfo[index].interfaceSubClass) {
-                id->interfaceSubClassMask |= (1 << i);
-                break;
-            }
-        }
+static int32_t UsbDdkPnpLoaderBuildIndex(struct UsbPnpMatchIndex *index, struct UsbPnpMatchIdTable **idTable)
+{
+    int32_t count = 0;
+    int32_t i;
+    struct UsbPnpMatchIndexEntry entry;
 
-        if (i >= id->interfaceSubClassLength) {
-            maskFlag = false;
-        }
+    while (idTable[count] != NULL) {
+        count++;
     }
 
-    if (id->matchFlag & USB_PNP_NOTIFY_MATCH_INT_PROTOCOL) {
-        for (i = 0; i < id->interfaceProtocolLength; i++) {
-            if (id->interfaceProtocol[i] == dev->interfaceInfo[index].interfaceProtocol) {
-                id->interfaceProtocolMask |= (1 << i);
-                break;
-            }
-        }
-
-        if (i >= id->interfaceProtocolLength) {
-            maskFlag = false;
-        }
+    index->entries = (struct UsbPnpMatchIndexEntry *)OsalMemCalloc(count * sizeof(struct UsbPnpMatchIndexEntry));
+    if (index->entries == NULL) {
+        HDF_LOGE("%s: OsalMemCalloc failure!", __func__);
+        return HDF_ERR_MALLOC_FAIL;
     }
 
-    if (id->matchFlag & USB_PNP_NOTIFY_MATCH_INT_NUMBER) {
-        for (i = 0; i < id->interfaceLength; i++) {
-            if (id->interfaceNumber[i] == dev->interfaceInfo[index].interfaceNumber) {
-                id->interfaceMask |= (1 << i);
-                break;
-            }
-        }
-
-        if (i >= id->interfaceLength) {
-            maskFlag = false;
+    /* insertion sort by key, stable so entries sharing a key keep the hcs table order */
+    for (count = 0; idTable[count] != NULL; count++) {
+        entry.key = UsbDdkPnpLoaderTableKey(idTable[count]);
+        entry.tableIndex = count;
+        for (i = count; (i > 0) && (index->entries[i - 1].key > entry.key); i--) {
+            index->entries[i] = index->entries[i - 1];
         }
+        index->entries[i] = entry;
     }
+    index->tableCount = count;
+    index->entryCount = count;
 
-    return maskFlag;
+    return HDF_SUCCESS;
 }
 
-static bool UsbDdkPnpLoaderMatchOneIdIntf(const struct UsbPnpNotifyMatchInfoTable *dev,
-    int8_t index, struct UsbPnpMatchIdTable *id)
+static void UsbDdkPnpLoaderIndexCollect(const struct UsbPnpMatchIndex *index, uint64_t key, uint32_t *candidates)
 {
-    bool maskFlag = true;
-
-    if (dev->deviceInfo.deviceClass == USB_DDK_PNP_CLASS_VENDOR_SPEC &&
-        !(id->matchFlag & USB_PNP_NOTIFY_MATCH_VENDOR) &&
-        (id->matchFlag & (USB_PNP_NOTIFY_MATCH_INT_CLASS | USB_PNP_NOTIFY_MATCH_INT_SUBCLASS |
-        USB_PNP_NOTIFY_MATCH_INT_PROTOCOL | USB_PNP_NOTIFY_MATCH_INT_NUMBER))) {
-        return false;
+    int32_t low = 0;
+    int32_t high = index->entryCount;
+    int32_t mid;
+    int32_t tableIndex;
+
+    while (low < high) {
+        mid = low + (high - low) / 2;
+        if (index->entries[mid].key < key) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
     }
 
-    maskFlag = UsbDdkPnpLoaderMatchInterface(dev, index, id);
-    if (!UsbDdkPnpLoaderMatchFlag(dev, index, id, maskFlag)) {
-        return false;
+    for (; (low < index->entryCount) && (index->entries[low].key == key); low++) {
+        tableIndex = index->entries[low].tableIndex;
+        candidates[tableIndex / USB_PNP_BITS_PER_WORD] |= (1U << (uint32_t)(tableIndex % USB_PNP_BITS_PER_WORD));
     }
+}
 
-    if (!id->pnpMatchFlag) {
-        id->pnpMatchFlag = true;
-    } else {
-        return false;
-    }
+static void UsbDdkPnpLoaderCollectCandidates(const struct UsbPnpMatchIndex *index,
+    const struct UsbPnpNotifyMatchInfoTable *dev, uint32_t *candidates)
+{
+    int8_t i;
 
-    return true;
+    UsbDdkPnpLoaderIndexCollect(index, UsbDdkPnpLoaderIndexKey(USB_PNP_INDEX_VENDOR_PRODUCT,
+        ((uint32_t)dev->deviceInfo.vendorId << USB_PNP_VENDOR_ID_SHIFT) | dev->deviceInfo.productId), candidates);
+    UsbDdkPnpLoaderIndexCollect(index, UsbDdkPnpLoaderIndexKey(USB_PNP_INDEX_VENDOR, dev->deviceInfo.vendorId),
+        candidates);
+    UsbDdkPnpLoaderIndexCollect(index, UsbDdkPnpLoaderIndexKey(USB_PNP_INDEX_DEV_CLASS, dev->deviceInfo.deviceClass),
+        candidates);
+    for (i = 0; i < dev->numInfos; i++) {
+        UsbDdkPnpLoaderIndexCollect(index, UsbDdkPnpLoaderIndexKey(USB_PNP_INDEX_INT_CLASS,
+            dev->interfaceInfo[i].interfaceClass), candidates);
+    }
+    UsbDdkPnpLoaderIndexCollect(index, UsbDdkPnpLoaderIndexKey(USB_PNP_INDEX_ANY, 0), candidates);
 }
 
 static int32_t UsbDdkPnpLoaderParseIdInfClass(const struct DeviceResourceNode *node,
     const struct DeviceResourceIface *devResIface, struct UsbPnpMatchIdTable *table)
 {
-    table->interfaceClassMask = 0;
     table->interfaceClassLength = devResIface->GetElemNum(node, "interfaceClass");
     if (table->interfaceClassLength <= 0) {
         HDF_LOGE("%s: read interfaceClass length=%d fail!", __func__, table->interfaceClassLength);
@@ -314,7 +340,6 @@ static int32_t UsbDdkPnpLoaderParseIdInfClass(const struct DeviceResourceNode *n
         table->interfaceClassLength = 0;
     }
 
-    table->interfaceSubClassMask = 0;
     table->interfaceSubClassLength = devResIface->GetElemNum(node, "interfaceSubClass");
     if (table->interfaceSubClassLength <= 0) {
         HDF_LOGE("%s: read interfaceSubClass length=%d fail!",
@@ -341,7 +366,6 @@ static int32_t UsbDdkPnpLoaderParseIdInferface(const struct DeviceResourceNode *
         return HDF_FAILURE;
     }
 
-    table->interfaceProtocolMask = 0;
     table->interfaceProtocolLength = devResIface->GetElemNum(node, "interfaceProtocol");
     if (table->interfaceProtocolLength <= 0) {
         HDF_LOGE("%s: read interfaceProtocol length=%d fail!",
@@ -357,7 +381,6 @@ static int32_t UsbDdkPnpLoaderParseIdInferface(const struct DeviceResourceNode *
         table->interfaceProtocolLength = 0;
     }
 
-    table->interfaceMask = 0;
     table->interfaceLength = devResIface->GetElemNum(node, "interfaceNumber");
     if (table->interfaceLength <= 0) {
         HDF_LOGE("%s: read interfaceNumber length=%d fail!", __func__, table->interfaceLength);
@@ -622,8 +645,9 @@ static int32_t UsbDdkPnpLoaderDispatchPnpDevice(
 }
 
 static int UsbDdkPnpLoaderDeviceListAdd(const struct UsbPnpNotifyMatchInfoTable *info,
-    const struct UsbPnpMatchIdTable *idTable)
+    const struct UsbPnpMatchState *state)
 {
+    const struct UsbPnpMatchIdTable *idTable = state->idTable;
     int ret;
     unsigned char *ptr = NULL;
     struct UsbPnpDeviceListTable *deviceTableListTemp = NULL;
@@ -643,9 +667,9 @@ static int UsbDdkPnpLoaderDeviceListAdd(const struct UsbPnpNotifyMatchInfoTable
         deviceTableListTemp->usbDevAddr = info->usbDevAddr;
         deviceTableListTemp->devNum = info->devNum;
         deviceTableListTemp->busNum = info->busNum;
-        deviceTableListTemp->interfaceLength = idTable->interfaceLength;
+        deviceTableListTemp->interfaceLength = state->interfaceLength;
         memcpy_s(deviceTableListTemp->interfaceNumber, USB_PNP_INFO_MAX_INTERFACES, \
-            idTable->interfaceNumber, USB_PNP_INFO_MAX_INTERFACES);
+            state->interfaceNumber, USB_PNP_INFO_MAX_INTERFACES);
 
         DListInsertTail(&deviceTableListTemp->list, &g_usbPnpDeviceTableListHead);
 
@@ -686,9 +710,10 @@ static struct UsbPnpDeviceListTable *UsbDdkPnpLoaderAddInterface(
 }
 
 static int UsbDdkPnpLoaderrAddPnpDevice(const struct IDevmgrService *devmgrSvc,
-    const struct UsbPnpNotifyMatchInfoTable *infoTable, const struct UsbPnpMatchIdTable *idTable, uint32_t cmdId)
+    const struct UsbPnpNotifyMatchInfoTable *infoTable, const struct UsbPnpMatchState *state, uint32_t cmdId)
 {
     int ret;
+    const struct UsbPnpMatchIdTable *idTable = state->idTable;
     struct HdfSBuf *pnpData = NULL;
     struct UsbPnpNotifyServiceInfo serviceInfo;
     struct UsbPnpDeviceListTable *deviceListTable = NULL;
@@ -701,12 +726,12 @@ static int UsbDdkPnpLoaderrAddPnpDevice(const struct IDevmgrService *devmgrSvc,
     }
 
     serviceInfo.length = sizeof(struct UsbPnpNotifyServiceInfo) - (USB_PNP_INFO_MAX_INTERFACES
-        - idTable->interfaceLength);
+        - state->interfaceLength);
     serviceInfo.devNum = infoTable->devNum;
     serviceInfo.busNum = infoTable->busNum;
-    serviceInfo.interfaceLength = idTable->interfaceLength;
+    serviceInfo.interfaceLength = state->interfaceLength;
     memcpy_s(serviceInfo.interfaceNumber, USB_PNP_INFO_MAX_INTERFACES, \
-        idTable->interfaceNumber, USB_PNP_INFO_MAX_INTERFACES);
+        state->interfaceNumber, USB_PNP_INFO_MAX_INTERFACES);
     pnpData = UsbDdkPnpLoaderBufCreate(idTable->moduleName, idTable->serviceName,
         idTable->deviceMatchAttr, serviceInfo);
     if (pnpData == NULL) {
@@ -728,7 +753,7 @@ static int UsbDdkPnpLoaderrAddPnpDevice(const struct IDevmgrService *devmgrSvc,
             }
             deviceListTable->status = USB_PNP_ADD_STATUS;
         } else {
-            ret = UsbDdkPnpLoaderDeviceListAdd(infoTable, idTable);
+            ret = UsbDdkPnpLoaderDeviceListAdd(infoTable, state);
             if (ret != HDF_SUCCESS) {
                 HDF_LOGE("%s:%d UsbDdkPnpLoaderDeviceListAdd faile", __func__, __LINE__);
                 goto ERROR;
@@ -741,30 +766,56 @@ ERROR:
 }
 
 static void UsbDdkPnpLoaderAddDevice(uint32_t cmdId, uint8_t index, const struct IDevmgrService *devmgrSvc,
-    const struct UsbPnpNotifyMatchInfoTable *infoTable, struct UsbPnpMatchIdTable **matchIdTable)
+    const struct UsbPnpNotifyMatchInfoTable *infoTable, const struct UsbPnpMatchState *states, int32_t stateCount)
 {
     int ret;
-    struct UsbPnpMatchIdTable *idTable = NULL;
-    int32_t tableCount;
+    int32_t count;
 
-    for (tableCount = 0, idTable = matchIdTable[0]; idTable != NULL; idTable = matchIdTable[++tableCount]) {
-        if (!UsbDdkPnpLoaderMatchDevice(infoTable, idTable)) {
+    for (count = 0; count < stateCount; count++) {
+        if (states[count].matchIndex != index) {
             continue;
         }
 
-        if (!UsbDdkPnpLoaderMatchOneIdIntf(infoTable, index, idTable)) {
+        HDF_LOGD("%s:%d matchDevice end, index=%d is match idTable=%p, moduleName=%s, serviceName=%s",
+            __func__, __LINE__, index, states[count].idTable, states[count].idTable->moduleName,
+            states[count].idTable->serviceName);
+
+        ret = UsbDdkPnpLoaderrAddPnpDevice(devmgrSvc, infoTable, &states[count], cmdId);
+        if (ret != HDF_SUCCESS) {
             continue;
         }
+    }
+}
 
-        HDF_LOGD("%s:%d matchDevice end, index=%d tableCount=%d is match \
-            idTable=%p, moduleName=%s, serviceName=%s",
-            __func__, __LINE__, index, tableCount, idTable, idTable->moduleName, idTable->serviceName);
+static int32_t UsbDdkPnpLoaderInitMatchStates(const struct UsbPnpNotifyMatchInfoTable *infoTable,
+    const uint32_t *candidates, struct UsbPnpMatchState *states)
+{
+    int32_t tableIndex;
+    int32_t stateCount = 0;
+    struct UsbPnpMatchState *state = NULL;
+    const struct UsbPnpMatchIdTable *idTable = NULL;
 
-        ret = UsbDdkPnpLoaderrAddPnpDevice(devmgrSvc, infoTable, idTable, cmdId);
-        if (ret != HDF_SUCCESS) {
+    for (tableIndex = 0; tableIndex < g_usbPnpMatchIndex.tableCount; tableIndex++) {
+        if (!((candidates[tableIndex / USB_PNP_BITS_PER_WORD] >>
+            (uint32_t)(tableIndex % USB_PNP_BITS_PER_WORD)) & 0x01)) {
+            continue;
+        }
+        idTable = g_usbPnpMatchIdTable[tableIndex];
+        if (!UsbDdkPnpLoaderMatchDevice(infoTable, idTable)) {
             continue;
         }
+
+        state = &states[stateCount++];
+        state->idTable = idTable;
+        state->matchIndex = -1;
+        if (idTable->matchFlag & USB_PNP_NOTIFY_MATCH_INT_NUMBER) {
+            state->interfaceLength = idTable->interfaceLength;
+            (void)memcpy_s(state->interfaceNumber, USB_PNP_INFO_MAX_INTERFACES,
+                idTable->interfaceNumber, USB_PNP_INFO_MAX_INTERFACES);
+        }
     }
+
+    return stateCount;
 }
 
 static int UsbDdkPnpLoaderRemoveHandle(const struct IDevmgrService *devmgrSvc,
@@ -859,39 +910,47 @@ static int UsbDdkPnpLoaderDevice(const struct UsbPnpNotifyMatchInfoTable *infoTa
     const struct IDevmgrService *super, uint32_t id)
 {
     int8_t i;
-    int32_t tableCount;
-    struct UsbPnpMatchIdTable *idTable = NULL;
+    int32_t count;
+    int32_t stateCount;
+    uint32_t wordCount;
+    uint32_t *candidates = NULL;
+    struct UsbPnpMatchState *states = NULL;
 
     if ((infoTable == NULL) || (g_usbPnpMatchIdTable == NULL) || (g_usbPnpMatchIdTable[0] == NULL)) {
         HDF_LOGE("%s:%d infoTable or super or g_usbPnpMatchIdTable is NULL!", __func__, __LINE__);
         return HDF_ERR_INVALID_PARAM;
     }
 
-    for (i = 0; i < infoTable->numInfos; i++) {
-        UsbDdkPnpLoaderAddDevice(id, i, super, infoTable, g_usbPnpMatchIdTable);
+    wordCount = (g_usbPnpMatchIndex.tableCount + USB_PNP_BITS_PER_WORD - 1) / USB_PNP_BITS_PER_WORD;
+    candidates = (uint32_t *)OsalMemCalloc(wordCount * sizeof(uint32_t));
+    states = (struct UsbPnpMatchState *)OsalMemCalloc(g_usbPnpMatchIndex.tableCount *
+        sizeof(struct UsbPnpMatchState));
+    if ((candidates == NULL) || (states == NULL)) {
+        HDF_LOGE("%s:%d OsalMemCalloc failure!", __func__, __LINE__);
+        OsalMemFree(candidates);
+        OsalMemFree(states);
+        return HDF_ERR_MALLOC_FAIL;
     }
 
-    for (tableCount = 0, idTable = g_usbPnpMatchIdTable[0]; idTable != NULL;
-        idTable = g_usbPnpMatchIdTable[++tableCount]) {
-        idTable->interfaceClassMask = 0;
-        if (!(idTable->matchFlag & USB_PNP_NOTIFY_MATCH_INT_CLASS)) {
-            idTable->interfaceClassLength = 0;
-        }
-        idTable->interfaceSubClassMask = 0;
-        if (!(idTable->matchFlag & USB_PNP_NOTIFY_MATCH_INT_SUBCLASS)) {
-            idTable->interfaceSubClassLength = 0;
-        }
-        idTable->interfaceProtocolMask = 0;
-        if (!(idTable->matchFlag & USB_PNP_NOTIFY_MATCH_INT_PROTOCOL)) {
-            idTable->interfaceProtocolLength = 0;
-        }
-        idTable->interfaceMask = 0;
-        if (!(idTable->matchFlag & USB_PNP_NOTIFY_MATCH_INT_NUMBER)) {
-            idTable->interfaceLength = 0;
+    /* matching only reads the shared index, all progress lives in the per-event states */
+    UsbDdkPnpLoaderCollectCandidates(&g_usbPnpMatchIndex, infoTable, candidates);
+    stateCount = UsbDdkPnpLoaderInitMatchStates(infoTable, candidates, states);
+    for (i = 0; i < infoTable->numInfos; i++) {
+        for (count = 0; count < stateCount; count++) {
+            if ((states[count].matchIndex < 0) && UsbDdkPnpLoaderMatchOneIdIntf(infoTable, i, &states[count])) {
+                states[count].matchIndex = i;
+            }
         }
-        idTable->pnpMatchFlag = false;
     }
 
+    OsalMutexLock(&g_usbPnpDeviceTableListLock);
+    for (i = 0; i < infoTable->numInfos; i++) {
+        UsbDdkPnpLoaderAddDevice(id, i, super, infoTable, states, stateCount);
+    }
+    OsalMutexUnlock(&g_usbPnpDeviceTableListLock);
+
+    OsalMemFree(candidates);
+    OsalMemFree(states);
     return HDF_SUCCESS;
 }
 
@@ -983,7 +1042,9 @@ int UsbDdkPnpLoaderEventReceived(void *priv, uint32_t id, struct HdfSBuf *data)
             removeInfo.devNum = infoTable->devNum;
             removeInfo.busNum = infoTable->busNum;
             removeInfo.interfaceNum = infoTable->interfaceInfo[0].interfaceNumber;
+            OsalMutexLock(&g_usbPnpDeviceTableListLock);
             ret = UsbDdkPnpLoaderRemoveDevice(super, removeInfo, id);
+            OsalMutexUnlock(&g_usbPnpDeviceTableListLock);
             break;
         default:
             ret = HDF_ERR_INVALID_PARAM;
@@ -1009,6 +1070,10 @@ int UsbDdkPnpLoaderEventHandle(void)
     }
 
     if (firstInitFlag == true) {
+        if (OsalMutexInit(&g_usbPnpDeviceTableListLock) != HDF_SUCCESS) {
+            HDF_LOGE("%s: init device table list lock failed", __func__);
+            return HDF_FAILURE;
+        }
         firstInitFlag = false;
 
         DListHeadInit(&g_usbPnpDeviceTableListHead);
@@ -1021,6 +1086,12 @@ int UsbDdkPnpLoaderEventHandle(void)
         return status;
     }
 
+    status = UsbDdkPnpLoaderBuildIndex(&g_usbPnpMatchIndex, g_usbPnpMatchIdTable);
+    if (status != HDF_SUCCESS) {
+        HDF_LOGE("%s: UsbDdkPnpLoaderBuildIndex faile status=%d", __func__, status);
+        goto ERROR;
+    }
+
     status = UsbDdkPnpLoaderEventSend(usbPnpServ, "USB PNP Handle Info");
     if (status != HDF_SUCCESS) {
         HDF_LOGE("UsbDdkPnpLoaderEventSend faile status=%d", status);
@@ -1028,6 +1099,7 @@ int UsbDdkPnpLoaderEventHandle(void)
     }
     return status;
 ERROR:
+    UsbDdkPnpLoaderReleaseIndex(&g_usbPnpMatchIndex);
     idTable = g_usbPnpMatchIdTable[0];
     while (idTable != NULL) {
         tableCount++;
@@ -9,7 +9,9 @@
 #ifndef ADC_CORE_H
 #define ADC_CORE_H
 
+#include "osal_sem.h"
 #include "osal_spinlock.h"
+#include "osal_thread.h"
 #include "hdf_base.h"
 #include "adc_if.h"
 #include "platform_core.h"
@@ -22,10 +24,33 @@ extern "C" {
 
 #define ADC_DEVICES_MAX 15
 
+#define ADC_SCAN_NAME_LEN 16
+
 struct AdcDevice;
 struct AdcMethod;
 struct AdcLockMethod;
 
+/* the ring of a scanning device, and the thread sampling it when the driver does not */
+struct AdcScan {
+    struct AdcDevice *device;
+    const void *owner;       /* the handle or client that started it */
+    struct AdcScanConfig config;
+    uint32_t chanCount;      /* samples per scan */
+    uint32_t *ring;          /* config.depth scans */
+    uint32_t head;           /* the slot the next scan is stored in */
+    uint32_t count;          /* scans stored and not read yet */
+    uint64_t *acc;           /* the oversampled scan being reduced */
+    uint32_t accCount;       /* raw scans in acc */
+    uint32_t rawScans;       /* raw scans pushed */
+    uint32_t overruns;       /* stored scans overwritten before they were read */
+    OsalSpinlock spin;
+    struct OsalThread thread;
+    struct OsalSem exited;
+    bool swScan;
+    bool stop;
+    char name[ADC_SCAN_NAME_LEN];
+};
+
 struct AdcDevice {
     const struct AdcMethod *ops;
     OsalSpinlock spin;
@@ -33,12 +58,20 @@ struct AdcDevice {
     uint32_t chanNum;
     const struct AdcLockMethod *lockOps;
     void *priv;
+    struct AdcScan *scan;
 };
 
 struct AdcMethod {
     int32_t (*read)(struct AdcDevice *device, uint32_t channel, uint32_t *val);
     int32_t (*start)(struct AdcDevice *device);
     int32_t (*stop)(struct AdcDevice *device);
+    /*
+     * Optional. Starts sampling config->channelMask at config->rate from a FIFO or DMA, handing the
+     * raw scans to AdcDeviceScanPush. Without it the core samples with read from a thread.
+     * Once stopScan returns, the driver must not call AdcDeviceScanPush any more.
+     */
+    int32_t (*startScan)(struct AdcDevice *device, const struct AdcScanConfig *config);
+    int32_t (*stopScan)(struct AdcDevice *device);
 };
 
 struct AdcLockMethod {
@@ -50,6 +83,9 @@ enum AdcIoCmd {
     ADC_IO_READ = 0,
     ADC_IO_OPEN,
     ADC_IO_CLOSE,
+    ADC_IO_START_SCAN,
+    ADC_IO_STOP_SCAN,
+    ADC_IO_READ_SCAN,
 };
 
 int32_t AdcDeviceAdd(struct AdcDevice *device);
@@ -66,6 +102,23 @@ int32_t AdcDeviceStart(struct AdcDevice *device);
 
 int32_t AdcDeviceStop(struct AdcDevice *device);
 
+/* owner identifies the opener, only the same owner may stop the scan */
+int32_t AdcDeviceStartScan(struct AdcDevice *device, const struct AdcScanConfig *config, const void *owner);
+
+/*
+ * Stops the scan if owner started it, or whoever did if owner is NULL. Returns HDF_ERR_DEVICE_BUSY
+ * if another owner started it, and HDF_SUCCESS if the device is not scanning.
+ */
+int32_t AdcDeviceStopScan(struct AdcDevice *device, const void *owner);
+
+int32_t AdcDeviceReadScan(struct AdcDevice *device, uint32_t *buf, uint32_t count);
+
+/*
+ * Stores count raw scans of a scanning device, reducing them as configured; may be called from
+ * interrupt context. Returns HDF_ERR_NOT_SUPPORT if the device is not scanning.
+ */
+int32_t AdcDeviceScanPush(struct AdcDevice *device, const uint32_t *samples, uint32_t count);
+
 #ifdef __cplusplus
 #if __cplusplus
 }
@@ -16,6 +16,7 @@
 #include "los_event.h"
 #include "osal_mutex.h"
 #include "osal_spinlock.h"
+#include "platform_stats.h"
 
 #ifdef __cplusplus
 #if __cplusplus
@@ -25,6 +26,12 @@ extern "C" {
 
 #define PERIPH_ADDR_INVALID               0xfff
 #define DMAC_CHAN_NUM_MAX                 100
+#define DMAC_CHAN_MAP_BITS                32
+#define DMAC_CHAN_MAP_WORDS               ((DMAC_CHAN_NUM_MAX + DMAC_CHAN_MAP_BITS - 1) / DMAC_CHAN_MAP_BITS)
+#define DMAC_LLI_POOL_DEF                 256
+#define DMAC_LLI_POOL_MAX                 4096
+#define DMAC_LLI_INVALID                  0xffff
+#define DMAC_IRQ_NONE                     0xffffffff
 
 #define DmaEventInit(event)               LOS_EventInit(event)
 #define DmaEventSignal(event, bit)        LOS_EventWrite(event, bit)
@@ -108,6 +115,48 @@ struct DmacLli {
     uint8_t pad[DMAC_LLI_SIZE - DMAC_LLI_HEAD_SIZE];
 };
 
+struct DmaCntlr;
+
+/**
+ * @brief Defines the fence of an asynchronous transfer, signalled when the transfer ends.
+ *
+ * The fence must stay valid until {@link DmacFenceWait} returns, it is detached from the transfer
+ * when the wait times out.
+ *
+ * @since 1.0
+ */
+struct DmacFence {
+    DmacEvent event;
+    int status;               // DMAC_CHN_SUCCESS or DMAC_CHN_ERROR once signalled
+    struct DmaCntlr *cntlr;   // set while a transfer may signal the fence, under the lock of cntlr
+    uint16_t channel;
+};
+
+/* one block of a scatter-gather list, the addresses are physical */
+struct DmacSgEntry {
+    uintptr_t srcAddr;
+    uintptr_t destAddr;
+    size_t len;
+};
+
+/**
+ * @brief Defines an asynchronous transfer, which is sent as one descriptor chain.
+ *
+ * For a peripheral transfer the peripheral side address is the same in all the entries.
+ *
+ * @since 1.0
+ */
+struct DmacAsyncMsg {
+    const struct DmacSgEntry *sg;
+    uint16_t sgNum;
+    uint8_t srcWidth;         // src data width in bytes
+    uint8_t destWidth;        // dest data width in bytes
+    uint8_t transType;        // 0: mem to mem; 1: periph to mem; 2:mem to periph
+    DmacCallback *cb;         // called in interrupt context once the chain ends, optional
+    void *para;
+    struct DmacFence *fence;  // signalled once the chain ends, optional
+};
+
 struct DmacChanInfo {
     uint16_t channel;
     int status;
@@ -123,6 +172,9 @@ struct DmacChanInfo {
     uint16_t lliCnt;
     struct DmacLli *lli;
     void *dummyPage;
+    bool async;               // the chain is sent by DmaCntlrTransferAsync
+    uint16_t poolHead;        // first pool descriptor of an async chain
+    struct DmacFence *fence;
 };
 
 struct DmaCntlr {
@@ -135,8 +187,15 @@ struct DmaCntlr {
     size_t regSize;
     size_t maxTransSize;
     uint16_t channelNum;
+    uint16_t lliPoolSize;     // descriptors for async chains, DMAC_LLI_POOL_DEF if 0
     OsalSpinlock lock;
     struct DmacChanInfo *channelList;
+    uint32_t chanFreeMap[DMAC_CHAN_MAP_WORDS];
+    struct DmacLli *lliPool;
+    uint16_t *lliPoolNext;    // free list of the pool, linked by index
+    uint16_t lliPoolFree;
+    uint16_t lliPoolAvail;
+    struct PlatformStats xferStats; // memory to memory transfers, the others complete in the irq
     int32_t (*getChanInfo)(struct DmaCntlr *cntlr, struct DmacChanInfo *chanInfo, struct DmacMsg *msg);
     int32_t (*dmaChanEnable)(struct DmaCntlr *cntlr, struct DmacChanInfo *chanInfo);
     int32_t (*dmaM2mChanEnable)(struct DmaCntlr *cntlr, struct DmacChanInfo *chanInfo,
@@ -162,6 +221,48 @@ void DmacCntlrRemove(struct DmaCntlr *cntlr);
 
 int32_t DmaCntlrTransfer(struct DmaCntlr *cntlr, struct DmacMsg *msg);
 
+/**
+ * @brief Starts a transfer of a scatter-gather list and returns without waiting for it.
+ *
+ * All the blocks are linked into one descriptor chain taken from the descriptor pool of the
+ * controller, so the engine runs the whole list without the cpu in between. The chain is started
+ * by the dmaChanEnable hook, for memory to memory transfers too. The end of the transfer is
+ * reported by the callback and the fence of the message; a chain which could not be started
+ * reports nothing.
+ *
+ * @param cntlr Indicates the DMA controller.
+ * @param msg Indicates the transfer; it need not stay valid once this function returns.
+ *
+ * @return Returns 0 if the transfer is started; returns HDF_ERR_DEVICE_BUSY if no channel or not
+ * enough descriptors are free; returns a negative value otherwise.
+ * @since 1.0
+ */
+int32_t DmaCntlrTransferAsync(struct DmaCntlr *cntlr, const struct DmacAsyncMsg *msg);
+
+void DmacFenceInit(struct DmacFence *fence);
+
+/**
+ * @brief Waits for the transfer of a fence to end.
+ *
+ * On timeout the fence is detached from the transfer, which then no longer signals it, so the
+ * fence may go out of scope even though the transfer still runs.
+ *
+ * @return Returns 0 if the transfer succeeded; returns DMAC_CHN_TIMEOUT on timeout; returns
+ * a negative value or DMAC_CHN_ERROR otherwise.
+ * @since 1.0
+ */
+int32_t DmacFenceWait(struct DmacFence *fence, uint32_t timeout);
+
+/**
+ * @brief Handles the channel status of a controller whose irq is DMAC_IRQ_NONE.
+ *
+ * Such a controller shares an interrupt line with others, or has none, and calls this when
+ * any of its channels may have ended.
+ *
+ * @since 1.0
+ */
+void DmacCntlrIrqHandle(struct DmaCntlr *cntlr);
+
 uintptr_t DmaGetCurrChanDestAddr(struct DmaCntlr *cntlr, uint16_t chan);
 #else
 static inline struct DmaCntlr *DmaCntlrCreate(struct HdfDeviceObject *dev)
@@ -195,6 +296,30 @@ static inline int32_t DmaCntlrTransfer(struct DmaCntlr *cntlr, struct DmacMsg *m
     return HDF_ERR_NOT_SUPPORT;
 }
 
+static inline int32_t DmaCntlrTransferAsync(struct DmaCntlr *cntlr, const struct DmacAsyncMsg *msg)
+{
+    (void)cntlr;
+    (void)msg;
+    return HDF_ERR_NOT_SUPPORT;
+}
+
+static inline void DmacFenceInit(struct DmacFence *fence)
+{
+    (void)fence;
+}
+
+static inline int32_t DmacFenceWait(struct DmacFence *fence, uint32_t timeout)
+{
+    (void)fence;
+    (void)timeout;
+    return HDF_ERR_NOT_SUPPORT;
+}
+
+static inline void DmacCntlrIrqHandle(struct DmaCntlr *cntlr)
+{
+    (void)cntlr;
+}
+
 static inline uintptr_t DmaGetCurrChanDestAddr(struct DmaCntlr *cntlr, uint16_t chan)
 {
     (void)cntlr;
@@ -13,6 +13,7 @@
 #include "osal_thread.h"
 #include "osal_sem.h"
 #include "osal_spinlock.h"
+#include "osal_time.h"
 
 #ifdef __cplusplus
 #if __cplusplus
@@ -20,6 +21,9 @@ extern "C" {
 #endif
 #endif /* __cplusplus */
 
+#define PLATFORM_QUEUE_WORKER_MAX 8
+#define PLATFORM_QUEUE_NAME_LEN   32
+
 struct PlatformMsg;
 struct PlatformQueue;
 
@@ -30,27 +34,53 @@ struct PlatformMsg {
     int32_t error;
     bool block;    /* whether need to block thread */
     void *data;
+    uint32_t key;  /* messages of a key are handled in order, those of different keys may run in parallel */
+    OsalTimespec stamp; /* when the message was queued */
 };
 
 int32_t PlatformMsgWait(struct PlatformMsg *msg);
 typedef int32_t (*PlatformMsgHandle)(struct PlatformQueue *queue, struct PlatformMsg *msg);
 
+struct PlatformQueueWorker {
+    struct PlatformQueue *queue;
+    struct OsalThread thread;
+    bool busy;
+    uint32_t key;  /* key of the message being handled, when busy */
+    char name[PLATFORM_QUEUE_NAME_LEN];
+};
+
+struct PlatformQueueStats {
+    uint32_t depth;       /* messages waiting for a worker */
+    uint32_t maxDepth;
+    uint32_t handled;
+    uint32_t maxWaitUs;   /* from queued until a worker took it */
+    uint64_t totalWaitUs;
+};
+
 struct PlatformQueue {
     const char *name;
     OsalSpinlock spin;
     struct OsalSem sem;
     struct DListHead msgs;
-    struct OsalThread thread; /* the worker thread of this queue */
+    struct PlatformQueueWorker workers[PLATFORM_QUEUE_WORKER_MAX]; /* the worker threads of this queue */
+    uint32_t workerNum;
+    uint32_t started;
+    bool stop;
+    struct OsalSem exited;
+    struct PlatformQueueStats stats;
     PlatformMsgHandle handle;
     void *data;
 };
 
 void PlatformQueueAddMsg(struct PlatformQueue *queue, struct PlatformMsg *msg);
 struct PlatformQueue *PlatformQueueCreate(PlatformMsgHandle handle, const char *name, void *data);
+struct PlatformQueue *PlatformQueueCreatePool(PlatformMsgHandle handle, const char *name, void *data,
+    uint32_t workerNum);
 void PlatformQueueDestroy(struct PlatformQueue *queue);
 int32_t PlatformQueueStart(struct PlatformQueue *queue);
 int32_t PlatformQueueSuspend(struct PlatformQueue *queue);
 int32_t PlatformQueueResume(struct PlatformQueue *queue);
+int32_t PlatformQueueGetStats(struct PlatformQueue *queue, struct PlatformQueueStats *stats);
 
 #ifdef __cplusplus
 #if __cplusplus
@@ -0,0 +1,223 @@
+/*
+ * Copyright (c) 2021 Huawei Device Co., Ltd.
+ *
+ * HDF is dual licensed: you can use it either under the terms of
+ * the GPL, or the BSD license, at your option.
+ * See the LICENSE file in the root of this repository for complete details.
+ */
+
+#ifndef PLATFORM_STATS_H
+#define PLATFORM_STATS_H
+
+#include "hdf_base.h"
+#include "hdf_dlist.h"
+#include "osal_spinlock.h"
+#include "osal_time.h"
+#include "platform_core.h"
+
+#ifdef __cplusplus
+#if __cplusplus
+extern "C" {
+#endif
+#endif /* __cplusplus */
+
+#if defined(LOSCFG_DRIVERS_HDF_PLATFORM_STATS) || defined(CONFIG_DRIVERS_HDF_PLATFORM_STATS)
+#define PLATFORM_STATS_ENABLE
+#endif
+
+/* bucket 0 counts calls under 1us, bucket n those of [2^(n-1), 2^n) us, the last one all longer */
+#define PLATFORM_STATS_HIST_SIZE 20
+#define PLATFORM_STATS_NUM_ALL   0xFFFFFFFF
+
+enum PlatformStatsHistType {
+    PLATFORM_STATS_HIST_LOCK = 0, /* waiting for the controller, its lock or a channel */
+    PLATFORM_STATS_HIST_BUS,      /* holding the controller until the transfer is done */
+    PLATFORM_STATS_HIST_MAX,
+};
+
+struct PlatformStatsData {
+    uint32_t calls;
+    uint32_t errors;
+    uint64_t bytes;
+    uint64_t totalUs[PLATFORM_STATS_HIST_MAX];
+    uint32_t maxUs[PLATFORM_STATS_HIST_MAX];
+    uint32_t hist[PLATFORM_STATS_HIST_MAX][PLATFORM_STATS_HIST_SIZE];
+};
+
+struct PlatformStatsStamp {
+    OsalTimespec start;
+    OsalTimespec locked;
+};
+
+enum PlatformStatsIoCmd {
+    PLATFORM_STATS_IO_DUMP = 0,
+    PLATFORM_STATS_IO_RESET,
+};
+
+#ifdef PLATFORM_STATS_ENABLE
+/* the counters of one controller, embedded in it */
+struct PlatformStats {
+    struct DListHead node;
+    enum PlatformModuleType module;
+    uint32_t number;
+    OsalSpinlock spin;
+    struct PlatformStatsData data;
+};
+
+/**
+ * @brief Make the counters of a controller visible to the dump service.
+ *
+ * Registering counters already registered only updates the controller number.
+ *
+ * @param stats Indicates the pointer to the counters.
+ * @param module Indicates the module type of the controller.
+ * @param number Indicates the number of the controller in its module.
+ *
+ * @return Returns 0 on success; returns a negative value otherwise.
+ * @since 1.0
+ */
+int32_t PlatformStatsRegister(struct PlatformStats *stats, enum PlatformModuleType module, uint32_t number);
+
+/**
+ * @brief Remove the counters of a controller from the dump service, before the controller is freed.
+ *
+ * @param stats Indicates the pointer to the counters.
+ * @since 1.0
+ */
+void PlatformStatsUnregister(struct PlatformStats *stats);
+
+/**
+ * @brief Account one call of a controller.
+ *
+ * @param stats Indicates the pointer to the counters.
+ * @param lockUs Indicates the time waited for the controller.
+ * @param busUs Indicates the time the controller was held.
+ * @param bytes Indicates the bytes moved.
+ * @param ret Indicates the result of the call, a negative value is counted as an error.
+ * @since 1.0
+ */
+void PlatformStatsAdd(struct PlatformStats *stats, uint32_t lockUs, uint32_t busUs, uint32_t bytes, int32_t ret);
+
+/**
+ * @brief Account one call timed by the stamp, see {@link PlatformStatsBegin} and {@link PlatformStatsLocked}.
+ *
+ * @since 1.0
+ */
+void PlatformStatsEnd(struct PlatformStats *stats, const struct PlatformStatsStamp *stamp, uint32_t bytes,
+    int32_t ret);
+
+/**
+ * @brief Copy the counters of a controller.
+ *
+ * @param module Indicates the module type of the controller.
+ * @param number Indicates the number of the controller.
+ * @param data Indicates the pointer to receive the counters.
+ *
+ * @return Returns 0 on success; returns HDF_ERR_NOT_SUPPORT if the statistics are compiled out,
+ * or HDF_PLT_ERR_NO_DEV if no such controller registered.
+ * @since 1.0
+ */
+int32_t PlatformStatsRead(enum PlatformModuleType module, uint32_t number, struct PlatformStatsData *data);
+
+/**
+ * @brief Clear the counters of a controller, or of all controllers of a module
+ * with {@link PLATFORM_STATS_NUM_ALL}, or of all modules with PLATFORM_MODULE_MAX.
+ *
+ * @since 1.0
+ */
+void PlatformStatsReset(enum PlatformModuleType module, uint32_t number);
+
+/**
+ * @brief Print the counters of all registered controllers.
+ *
+ * @since 1.0
+ */
+void PlatformStatsDump(void);
+
+/* called before taking the controller */
+static inline void PlatformStatsBegin(struct PlatformStatsStamp *stamp)
+{
+    (void)OsalGetTime(&stamp->start);
+    stamp->locked = stamp->start;
+}
+
+/* called once the controller is taken, calls without it count the whole time as bus time */
+static inline void PlatformStatsLocked(struct PlatformStatsStamp *stamp)
+{
+    (void)OsalGetTime(&stamp->locked);
+}
+#else
+struct PlatformStats {
+    uint8_t reserved;
+};
+
+static inline int32_t PlatformStatsRegister(struct PlatformStats *stats, enum PlatformModuleType module,
+    uint32_t number)
+{
+    (void)stats;
+    (void)module;
+    (void)number;
+    return HDF_SUCCESS;
+}
+
+static inline void PlatformStatsUnregister(struct PlatformStats *stats)
+{
+    (void)stats;
+}
+
+static inline void PlatformStatsAdd(struct PlatformStats *stats, uint32_t lockUs, uint32_t busUs, uint32_t bytes,
+    int32_t ret)
+{
+    (void)stats;
+    (void)lockUs;
+    (void)busUs;
+    (void)bytes;
+    (void)ret;
+}
+
+static inline void PlatformStatsEnd(struct PlatformStats *stats, const struct PlatformStatsStamp *stamp,
+    uint32_t bytes, int32_t ret)
+{
+    (void)stats;
+    (void)stamp;
+    (void)bytes;
+    (void)ret;
+}
+
+static inline int32_t PlatformStatsRead(enum PlatformModuleType module, uint32_t number,
+    struct PlatformStatsData *data)
+{
+    (void)module;
+    (void)number;
+    (void)data;
+    return HDF_ERR_NOT_SUPPORT;
+}
+
+static inline void PlatformStatsReset(enum PlatformModuleType module, uint32_t number)
+{
+    (void)module;
+    (void)number;
+}
+
+static inline void PlatformStatsDump(void)
+{
+}
+
+static inline void PlatformStatsBegin(struct PlatformStatsStamp *stamp)
+{
+    (void)stamp;
+}
+
+static inline void PlatformStatsLocked(struct PlatformStatsStamp *stamp)
+{
+    (void)stamp;
+}
+#endif /* PLATFORM_STATS_ENABLE */
+
+#ifdef __cplusplus
+#if __cplusplus
+}
+#endif
+#endif /* __cplusplus */
+
+#endif /* PLATFORM_STATS_H */
@@ -80,6 +80,10 @@ struct GpioMethod {
     int32_t (*enableIrq)(struct GpioCntlr *cntlr, uint16_t local);
     /** disable a GPIO pin interrupt */
     int32_t (*disableIrq)(struct GpioCntlr *cntlr, uint16_t local);
+    /** write the level values of several GPIO pins at once, optional */
+    int32_t (*writeMulti)(struct GpioCntlr *cntlr, const uint16_t *locals, const uint16_t *vals, uint16_t count);
+    /** read the level values of several GPIO pins at once, optional */
+    int32_t (*readMulti)(struct GpioCntlr *cntlr, const uint16_t *locals, uint16_t *vals, uint16_t count);
 };
 
 /**
@@ -118,6 +122,10 @@ int32_t GpioCntlrWrite(struct GpioCntlr *cntlr, uint16_t local, uint16_t val);
 
 int32_t GpioCntlrRead(struct GpioCntlr *cntlr, uint16_t local, uint16_t *val);
 
+int32_t GpioCntlrWriteMulti(struct GpioCntlr *cntlr, const uint16_t *locals, const uint16_t *vals, uint16_t count);
+
+int32_t GpioCntlrReadMulti(struct GpioCntlr *cntlr, const uint16_t *locals, uint16_t *vals, uint16_t count);
+
 int32_t GpioCntlrSetDir(struct GpioCntlr *cntlr, uint16_t local, uint16_t dir);
 
 int32_t GpioCntlrGetDir(struct GpioCntlr *cntlr, uint16_t local, uint16_t *dir);
@@ -134,14 +142,30 @@ int32_t GpioCntlrDisableIrq(struct GpioCntlr *cntlr, uint16_t local);
 
 void GpioCntlrIrqCallback(struct GpioCntlr *cntlr, uint16_t local);
 
+struct GpioIrqFootprint {
+    uint32_t threads; /* threads running threaded irqs */
+    uint32_t bytes;   /* memory of these threads, stacks included, and of the per line records */
+};
+
+void GpioIrqGetFootprint(struct GpioIrqFootprint *footprint);
+
+int32_t GpioIrqPoolStart(void);
+
 struct PlatformManager *GpioManagerGet(void);
 
+/* takes a reference of the controller, dropped with GpioCntlrPut */
 struct GpioCntlr *GpioGetCntlr(uint16_t gpio);
 
+void GpioCntlrPut(struct GpioCntlr *cntlr);
+
 static inline uint16_t GpioToLocal(uint16_t gpio)
 {
+    uint16_t local;
     struct GpioCntlr *cntlr = GpioGetCntlr(gpio);
-    return (cntlr == NULL) ? gpio : (gpio - cntlr->start);
+
+    local = (cntlr == NULL) ? gpio : (gpio - cntlr->start);
+    GpioCntlrPut(cntlr);
+    return local;
 }
 
 static inline uint16_t GpioGetLocalNumber(struct GpioCntlr *cntlr, uint16_t gpio)
@@ -20,6 +20,8 @@ enum GpioIoCmd {
     GPIO_IO_WRITE = 1,
     GPIO_IO_GETDIR = 2,
     GPIO_IO_SETDIR = 3,
+    GPIO_IO_WRITE_MULTI = 4,
+    GPIO_IO_READ_MULTI = 5,
 };
 
 #ifdef __cplusplus
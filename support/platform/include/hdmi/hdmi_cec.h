@@ -10,6 +10,7 @@
 #define HDMI_CEC_H
 
 #include "hdf_base.h"
+#include "osal_spinlock.h"
 
 #ifdef __cplusplus
 #if __cplusplus
@@ -1683,9 +1684,38 @@ struct HdmiCecInfo {
     uint8_t response;
 };
 
+/*
+ * Priority of a queued message. Replies to received messages go first, polls and requests that are
+ * repeated periodically go last.
+ */
+enum HdmiCecTxPriority {
+    HDMI_CEC_TX_PRIORITY_HIGH = 0,
+    HDMI_CEC_TX_PRIORITY_NORMAL,
+    HDMI_CEC_TX_PRIORITY_LOW,
+    HDMI_CEC_TX_PRIORITY_BUTT,
+};
+
+#define HDMI_CEC_TX_QUEUE_LEN 16
+#define HDMI_CEC_TX_RETRY_MAX 5               /* retransmissions CEC allows for a frame */
+#define HDMI_CEC_TX_RETRY_INTERVAL_US 7200    /* 3 bit periods of signal free time */
+
+struct HdmiCecTxStats {
+    uint32_t sent;
+    uint32_t failed;          /* messages given up after HDMI_CEC_TX_RETRY_MAX retries */
+    uint32_t retries;
+    uint32_t deduped;         /* polls and requests dropped as the same frame was queued */
+    uint32_t dropped;         /* messages refused as the queue was full */
+    uint64_t latencySumUs;    /* from queueing to the end of the last attempt */
+    uint32_t latencyMaxUs;
+};
+
+struct HdmiCecTxQueue;
+
 struct HdmiCec {
     struct HdmiCecInfo info;
     void *priv;
+    OsalSpinlock txLock;               /* guards txQueue, initialized along with the HdmiCec */
+    struct HdmiCecTxQueue *txQueue;    /* NULL if messages are sent synchronously */
 };
 
 static inline bool HdmiCecIsBroadcastMsg(struct HdmiCecMsg *msg)
@@ -1726,6 +1756,20 @@ static inline void HdmiCecFillMsgHeader(struct HdmiCecMsg *destMsg, struct HdmiC
 
 int32_t HdmiCecReceivedMsg(struct HdmiCec *cec, struct HdmiCecMsg *msg);
 
+int32_t HdmiCecTxQueueStart(struct HdmiCec *cec);
+
+void HdmiCecTxQueueStop(struct HdmiCec *cec);
+
+/*
+ * Queues a message for the transmit thread and returns without waiting for the bus. A frame that fails
+ * is retried after HDMI_CEC_TX_RETRY_INTERVAL_US while the frames to other destinations go out; no frame
+ * of any priority goes to its destination before it. A poll, or a message expecting a response, that is
+ * queued already is not queued again. Returns HDF_ERR_NOT_SUPPORT when the queue is not running.
+ */
+int32_t HdmiCecQueueMsg(struct HdmiCec *cec, const struct HdmiCecMsg *msg, enum HdmiCecTxPriority priority);
+
+int32_t HdmiCecGetTxStats(struct HdmiCec *cec, struct HdmiCecTxStats *stats);
+
 #ifdef __cplusplus
 #if __cplusplus
 }
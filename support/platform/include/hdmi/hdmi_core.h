@@ -211,6 +211,7 @@ struct HdmiCntlr {
     struct HdmiInfoFrame infoFrame;
     struct HdmiScdc *scdc;
     struct HdmiDdc ddc;
+    struct HdmiEdidCache *edidCache;    /* outlives the sink device, NULL if not allocated */
     struct HdmiFrl *frl;
     struct HdmiHdcp *hdcp;
     struct HdmiCec *cec;
@@ -629,11 +629,39 @@ struct HdmiEdid {
 
 typedef int32_t (*HdmiEdidPhaseFunc)(struct HdmiEdid *edid);
 
+/*
+ * Parsed EDIDs of the sinks seen last, keyed by a fingerprint of block 0. A sink that comes back with
+ * the same block 0 reuses its parsed capability without the extension blocks being read again, so an
+ * extension block that changes while block 0 stays the same is not seen until the entry is evicted.
+ * Only the hdmi event thread uses the cache.
+ */
+#define HDMI_EDID_CACHE_NUM 4
+
+struct HdmiEdidCacheEntry {
+    bool valid;
+    uint32_t fingerprint;
+    uint32_t lastUse;
+    struct HdmiEdid edid;
+};
+
+struct HdmiEdidCache {
+    struct HdmiEdidCacheEntry entries[HDMI_EDID_CACHE_NUM];
+    uint32_t useCnt;
+    uint32_t hits;
+    uint32_t misses;
+};
+
 int32_t HdmiEdidReset(struct HdmiEdid *edid);
 int32_t HdmiEdidPhase(struct HdmiEdid *edid);
 int32_t HdmiEdidGetRaw(struct HdmiEdid *edid, uint8_t *raw, uint32_t len);
 int32_t HdmiEdidRawDataRead(struct HdmiEdid *edid, struct HdmiDdc *ddc);
 
+/*
+ * Reads block 0 and, if the sink is not in the cache, the extension blocks and parses them.
+ * Without a cache it reads and parses the whole EDID.
+ */
+int32_t HdmiEdidCacheRead(struct HdmiEdid *edid, struct HdmiDdc *ddc, struct HdmiEdidCache *cache);
+
 #ifdef __cplusplus
 #if __cplusplus
 }
@@ -13,6 +13,7 @@
 #include "i2c_if.h"
 #include "osal_mutex.h"
 #include "platform_core.h"
+#include "platform_stats.h"
 
 #ifdef __cplusplus
 #if __cplusplus
@@ -33,6 +34,7 @@ struct I2cCntlr {
     void *priv;
     const struct I2cMethod *ops;
     const struct I2cLockMethod *lockOps;
+    struct PlatformStats xferStats;
 };
 
 struct I2cMethod {
@@ -75,6 +77,10 @@ enum I2cIoCmd {
     I2C_IO_TRANSFER = 0,
     I2C_IO_OPEN = 1,
     I2C_IO_CLOSE = 2,
+    I2C_IO_TRANSFER_REGISTER = 3,
+    I2C_IO_TRANSFER_BY_HANDLE = 4,
+    I2C_IO_TRANSFER_UNREGISTER = 5,
+    I2C_IO_GET_STATS = 6,
 };
 
 /**
@@ -129,6 +135,16 @@ void I2cCntlrPut(struct I2cCntlr *cntlr);
  */
 int32_t I2cCntlrTransfer(struct I2cCntlr *cntlr, struct I2cMsg *msgs, int16_t count);
 
+/**
+ * @brief Get the counters of the I2C manager service.
+ *
+ * @param stats Indicates the counters to fill.
+ *
+ * @return Returns 0 on success; returns a negative value otherwise.
+ * @since 1.0
+ */
+int32_t I2cManagerGetIoStats(struct I2cIoStats *stats);
+
 #ifdef __cplusplus
 #if __cplusplus
 }
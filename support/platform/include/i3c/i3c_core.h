@@ -13,6 +13,8 @@
 #include "i3c_ccc.h"
 #include "hdf_base.h"
 #include "hdf_dlist.h"
+#include "osal_atomic.h"
+#include "osal_sem.h"
 #include "osal_spinlock.h"
 #include "platform_core.h"
 
@@ -28,6 +30,8 @@ extern "C" {
 #define ADDRS_STATUS_BITS        2
 #define BITS_PER_UINT16          16
 #define ADDRS_PER_UINT16         8
+#define BITS_PER_UINT32          32
+#define I3C_ADDR_BITMAP_WORDS    ((I3C_ADDR_MAX + 1) / BITS_PER_UINT32)
 
 #define ADDR_STATUS_BIT0_MASK    0x1
 #define ADDR_STATUS_BIT1_MASK    0x2
@@ -84,6 +88,9 @@ struct I3cCntlr {
     int16_t busId;
     struct I3cConfig config;
     uint16_t addrSlot[(I3C_ADDR_MAX + 1) / ADDRS_PER_UINT16];
+    uint32_t addrFree[I3C_ADDR_BITMAP_WORDS];       /* one bit per address, set while the address is free */
+    struct I3cDevice *addrDev[I3C_ADDR_MAX + 1];    /* device on each address, under addrLock */
+    OsalSpinlock addrLock;                          /* irq-safe, so IBI handlers can look devices up */
     struct I3cIbiInfo *ibiSlot[I3C_IBI_MAX];
     const struct I3cMethod *ops;
     const struct I3cLockMethod *lockOps;
@@ -117,6 +124,8 @@ struct I3cDevice {
     struct I3cIbiInfo *ibi;
     struct I3cVendor vendor;
     void *devPriv;
+    OsalAtomic refs;              /* one for the address, one per GetDeviceByAddr not put yet */
+    struct OsalSem released;      /* posted when the last reference is put */
 };
 
 struct I3cMethod {
@@ -336,6 +345,9 @@ int32_t I3cCntlrTransfer(struct I3cCntlr *cntlr, struct I3cMsg *msgs, int16_t co
 /**
  * @brief Add an I3C device or an I2C device to device list.
  *
+ * An I3C device whose static address is not free, or which has no static address,
+ * is assigned the lowest free address as its dynamic address.
+ *
  * @param device Indicates the I3C device or I2C device.
  *
  * @return Returns <b>0</b> on success; Returns a negative value otherwise.
@@ -346,6 +358,9 @@ int32_t I3cDeviceAdd(struct I3cDevice *device);
 /**
  * @brief Remove an I3C device or an I2C device from device list.
  *
+ * Waits until the references taken by {@link GetDeviceByAddr} are put, so the device may be freed
+ * once this returns. Must not be called from interrupt context.
+ *
  * @param device Indicates the I3C device or I2C device.
  *
  * @return Returns <b>0</b> on success; Returns a negative value otherwise.
@@ -394,16 +409,28 @@ int32_t I3cCntlrAdd(struct I3cCntlr *cntlr);
 void I3cCntlrRemove(struct I3cCntlr *cntlr);
 
 /**
- * @brief Get an I3C device by addr.
+ * @brief Get an I3C device by addr, with ref count.
+ *
+ * May be called from interrupt context. The device stays valid until it is released
+ * with {@link I3cDevicePut}.
  *
  * @param cntlr Indicates the I3C controller device.
  * @param addr Indicates the address of the device which you would like to get.
  *
- * @return Returns <b>0</b> on success; Returns a negative value otherwise.
+ * @return Returns an I3C device object on success; Returns <b>NULL</b> otherwise.
  * @since 1.0
  */
 struct I3cDevice *GetDeviceByAddr(struct I3cCntlr *cntlr, uint16_t addr);
 
+/**
+ * @brief Release an I3C device obtained by {@link GetDeviceByAddr}.
+ *
+ * @param device Indicates the I3C device or I2C device.
+ *
+ * @since 1.0
+ */
+void I3cDevicePut(struct I3cDevice *device);
+
 /**
  * @brief IBI(In-bind Interrupt) callback function.
  *
@@ -38,6 +38,8 @@ struct MipiDsiCntlr {
 struct MipiDsiCntlrMethod {
     int32_t (*setCntlrCfg)(struct MipiDsiCntlr *cntlr);
     int32_t (*setCmd)(struct MipiDsiCntlr *cntlr, struct DsiCmdDesc *cmd);
+    /* optional, queues a whole descriptor list and times the per-command delays in hardware */
+    int32_t (*setCmdBatch)(struct MipiDsiCntlr *cntlr, struct DsiCmdDesc *cmds, uint32_t count);
     int32_t (*getCmd)(struct MipiDsiCntlr *cntlr, struct DsiCmdDesc *cmd, uint32_t readLen, uint8_t *out);
     void (*toHs)(struct MipiDsiCntlr *cntlr);
     void (*toLp)(struct MipiDsiCntlr *cntlr);
@@ -135,6 +137,19 @@ void MipiDsiCntlrSetHsMode(struct MipiDsiCntlr *cntlr);
  */
 int32_t MipiDsiCntlrTx(struct MipiDsiCntlr *cntlr, struct DsiCmdDesc *cmd);
 
+/**
+ * @brief Sends a list of DCS commands, such as a panel init sequence, in one controller transaction.
+ *
+ * @param cntlr Indicates the MIPI DSI device obtained via {@link MipiDsiOpen}.
+ * @param cmds Indicates the pointer to the commands to be sent.
+ * @param count Indicates the number of commands.
+ *
+ * @return Returns <b>0</b> if the operation is successful; returns a negative value otherwise.
+ *
+ * @since 1.0
+ */
+int32_t MipiDsiCntlrTxBatch(struct MipiDsiCntlr *cntlr, struct DsiCmdDesc *cmds, uint32_t count);
+
 /**
 * @brief Receives a DCS command used for reading data, such as the status and parameters of a peripheral
  *
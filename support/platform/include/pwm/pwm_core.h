@@ -22,11 +22,17 @@ extern "C" {
 
 struct PwmMethod;
 struct PwmDev;
+struct PwmSequencer;
 
 struct PwmMethod {
     int32_t (*setConfig)(struct PwmDev *pwm, struct PwmConfig *config);
     int32_t (*open)(struct PwmDev *pwm);
     int32_t (*close)(struct PwmDev *pwm);
+    /*
+     * Optional. Applies the configs of several devices sharing this method together, latched in one period.
+     * Returns HDF_ERR_NOT_SUPPORT for devices it cannot update together, which are then set one by one.
+     */
+    int32_t (*setConfigGroup)(struct PwmDev **pwms, struct PwmConfig *configs, uint32_t count);
 };
 
 struct PwmDev {
@@ -38,6 +44,7 @@ struct PwmDev {
     uint32_t num;
     OsalSpinlock lock;
     void *priv;
+    struct PwmSequencer *seq;    /* the sequence the device is playing, shared by its group */
 };
 
 void *PwmGetPriv(struct PwmDev *pwm);
@@ -0,0 +1,198 @@
+/*
+ * Copyright (c) 2021 Huawei Device Co., Ltd.
+ *
+ * HDF is dual licensed: you can use it either under the terms of
+ * the GPL, or the BSD license, at your option.
+ * See the LICENSE file in the root of this repository for complete details.
+ */
+
+#ifndef REGMAP_CORE_H
+#define REGMAP_CORE_H
+
+#include "hdf_base.h"
+#include "hdf_platform.h"
+#include "osal_mutex.h"
+
+#ifdef __cplusplus
+#if __cplusplus
+extern "C" {
+#endif
+#endif /* __cplusplus */
+
+#define REGMAP_BURST_MAX 64 /* max registers of one bus access */
+
+enum RegmapBusType {
+    REGMAP_BUS_I2C = 0,
+    REGMAP_BUS_SPI,
+};
+
+/* registers in [min, max] */
+struct RegmapRange {
+    uint32_t min;
+    uint32_t max;
+};
+
+/*
+ * Register layout of a chip. Register addresses and values of more than one byte
+ * are sent msb first, and a burst access auto-increments the register address.
+ */
+struct RegmapConfig {
+    uint8_t regBytes;                           /* 1 or 2 */
+    uint8_t valBytes;                           /* 1 or 2 */
+    uint32_t maxReg;                            /* highest register, the cache covers 0 to maxReg */
+    const struct RegmapRange *volatileRanges;   /* registers changed by the chip, never cached */
+    uint32_t volatileNum;
+    uint8_t spiReadFlag;                        /* or-ed into the first address byte of spi reads */
+};
+
+struct RegmapStats {
+    uint32_t hits;          /* reads answered from the cache */
+    uint32_t misses;        /* reads which went to the bus */
+    uint32_t skippedWrites; /* writes dropped because the cache already held the value */
+    uint32_t busReads;      /* bus read transactions */
+    uint32_t busWrites;     /* bus write transactions */
+};
+
+struct Regmap {
+    enum RegmapBusType busType;
+    DevHandle handle;
+    uint16_t addr;          /* i2c device address */
+    const struct RegmapConfig *config;
+    struct OsalMutex lock;
+    uint16_t *cache;
+    uint8_t *valid;         /* bitmap of cached registers */
+    uint8_t *dirty;         /* bitmap of registers written while cache only */
+    bool cacheOnly;
+    struct RegmapStats stats;
+    uint8_t buf[(REGMAP_BURST_MAX + 1) * sizeof(uint16_t)];
+};
+
+/**
+ * @brief Create a register map of a device on an opened i2c controller.
+ *
+ * @param handle Indicates the i2c controller handle obtained via I2cOpen.
+ * @param addr Indicates the device address.
+ * @param config Indicates the register layout, which must stay valid for the life of the map.
+ *
+ * @return Returns the register map on success; returns NULL otherwise.
+ * @since 1.0
+ */
+struct Regmap *RegmapInitI2c(DevHandle handle, uint16_t addr, const struct RegmapConfig *config);
+
+/**
+ * @brief Create a register map of an opened spi device.
+ *
+ * @param handle Indicates the spi device handle obtained via SpiOpen.
+ * @param config Indicates the register layout, which must stay valid for the life of the map.
+ *
+ * @return Returns the register map on success; returns NULL otherwise.
+ * @since 1.0
+ */
+struct Regmap *RegmapInitSpi(DevHandle handle, const struct RegmapConfig *config);
+
+/**
+ * @brief Free a register map. The bus handle is not closed.
+ *
+ * @param map Indicates the register map.
+ *
+ * @since 1.0
+ */
+void RegmapExit(struct Regmap *map);
+
+/**
+ * @brief Read a register, from the cache if it holds the value.
+ *
+ * @param map Indicates the register map.
+ * @param reg Indicates the register.
+ * @param val Indicates the value read.
+ *
+ * @return Returns 0 on success; returns a negative value otherwise.
+ * @since 1.0
+ */
+int32_t RegmapRead(struct Regmap *map, uint32_t reg, uint32_t *val);
+
+/**
+ * @brief Write a register, unless the cache shows it already holds the value.
+ *
+ * @param map Indicates the register map.
+ * @param reg Indicates the register.
+ * @param val Indicates the value to write.
+ *
+ * @return Returns 0 on success; returns a negative value otherwise.
+ * @since 1.0
+ */
+int32_t RegmapWrite(struct Regmap *map, uint32_t reg, uint32_t val);
+
+/**
+ * @brief Read-modify-write the bits of a register selected by mask.
+ *
+ * @param map Indicates the register map.
+ * @param reg Indicates the register.
+ * @param mask Indicates the bits to change.
+ * @param val Indicates the new value of these bits.
+ *
+ * @return Returns 0 on success; returns a negative value otherwise.
+ * @since 1.0
+ */
+int32_t RegmapUpdateBits(struct Regmap *map, uint32_t reg, uint32_t mask, uint32_t val);
+
+/**
+ * @brief Read count consecutive registers, in one bus access unless all of them are cached.
+ *
+ * @param map Indicates the register map.
+ * @param reg Indicates the first register.
+ * @param vals Indicates the values read.
+ * @param count Indicates the number of registers, at most REGMAP_BURST_MAX.
+ *
+ * @return Returns 0 on success; returns a negative value otherwise.
+ * @since 1.0
+ */
+int32_t RegmapBulkRead(struct Regmap *map, uint32_t reg, uint32_t *vals, uint32_t count);
+
+/**
+ * @brief Enable or disable the cache only mode, in which writes only update the cache
+ * and mark the registers dirty until RegmapSync.
+ *
+ * @param map Indicates the register map.
+ * @param enable Indicates whether to enable the mode.
+ *
+ * @since 1.0
+ */
+void RegmapCacheOnly(struct Regmap *map, bool enable);
+
+/**
+ * @brief Write the dirty registers to the device, one burst per run of contiguous registers.
+ *
+ * @param map Indicates the register map.
+ *
+ * @return Returns 0 on success; returns a negative value otherwise.
+ * @since 1.0
+ */
+int32_t RegmapSync(struct Regmap *map);
+
+/**
+ * @brief Drop all cached values, e.g. after the device was reset.
+ *
+ * @param map Indicates the register map.
+ *
+ * @since 1.0
+ */
+void RegmapCacheDrop(struct Regmap *map);
+
+/**
+ * @brief Get the cache and bus counters of a register map.
+ *
+ * @param map Indicates the register map.
+ * @param stats Indicates the counters to fill.
+ *
+ * @since 1.0
+ */
+void RegmapGetStats(struct Regmap *map, struct RegmapStats *stats);
+
+#ifdef __cplusplus
+#if __cplusplus
+}
+#endif
+#endif /* __cplusplus */
+
+#endif /* REGMAP_CORE_H */
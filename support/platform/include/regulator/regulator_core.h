@@ -88,9 +88,13 @@ struct RegulatorDesc {
     RegulatorStatusChangecb cb;      /* when regulator status change, can notify by call cb */
 };
 
+struct RegulatorTreeInfo;
+
 struct RegulatorNode {
     struct RegulatorDesc regulatorInfo;
     struct DListHead node;
+    struct DListHead hashNode;          /* in the name hash bucket of the manager */
+    struct RegulatorTreeInfo *tree;     /* parent and children, resolved when the node is added */
     struct RegulatorMethod *ops;
     void *priv;
     struct OsalMutex lock;
@@ -126,6 +130,12 @@ int32_t RegulatorNodeAdd(struct RegulatorNode *node);
  * @return success or fail
  */
 int32_t RegulatorNodeRemoveAll(void);
+/**
+ * @brief remove and free a regulator controller, its children must be removed first
+ * @param name Indicates the regulator name.
+ * @return success or fail
+ */
+int32_t RegulatorNodeRemove(const char *name);
 /**
  * @brief enable a regulator
  * @param node Indicates a regulator controller.
@@ -189,6 +199,13 @@ int32_t RegulatorNodeGetStatus(struct RegulatorNode *node, uint32_t *status);
  */
 int32_t RegulatorNodeRegisterStatusChangeCb(struct RegulatorNode *node, RegulatorStatusChangecb cb);
 int32_t RegulatorNodeStatusCb(struct RegulatorNode *node);
+/**
+ * @brief enable and disable a set of regulators in dependency order, under the manager lock
+ * @param entries Indicates the regulators and the status to set them to.
+ * @param count Indicates the number of entries.
+ * @return success or fail, nothing is changed if an entry is invalid
+ */
+int32_t RegulatorNodeApplyProfile(const struct RegulatorProfileEntry *entries, uint32_t count);
 
 #ifdef __cplusplus
 #if __cplusplus
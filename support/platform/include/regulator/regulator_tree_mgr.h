@@ -41,10 +41,14 @@ int RegulatorTreeManagerInit(void);
 int RegulatorTreeManagerDestory(void);
 int RegulatorTreeNodeRemoveAll(void);
 int RegulatorTreeSet(const char *name, struct RegulatorNode *child, struct RegulatorNode *parent);
+/* detach a node without children from the tree, before the node is freed */
+int RegulatorTreeNodeRemove(struct RegulatorNode *node);
 void RegulatorTreePrint(void);
-struct RegulatorNode *RegulatorTreeGetParent(const char *name);
+struct RegulatorNode *RegulatorTreeGetParent(const struct RegulatorNode *node);
+/* number of ancestors of the node, 0 for a root */
+uint32_t RegulatorTreeGetDepth(const struct RegulatorNode *node);
 int32_t RegulatorTreeChildForceDisable(struct RegulatorNode *node);
-bool RegulatorTreeIsAllChildDisable(const char *name);
+bool RegulatorTreeIsAllChildDisable(const struct RegulatorNode *node);
 
 #ifdef __cplusplus
 #if __cplusplus
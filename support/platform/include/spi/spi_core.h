@@ -14,6 +14,15 @@
 #include "hdf_dlist.h"
 #include "spi_if.h"
 #include "osal_mutex.h"
+#include "osal_sem.h"
+#include "osal_spinlock.h"
+#include "osal_thread.h"
+#include "platform_stats.h"
+
+#define SPI_CS_NONE          0xFFFFFFFF
+#define SPI_QUEUE_DEPTH      64 /* a power of 2 */
+#define SPI_QUEUE_BATCH      16 /* requests of a device sent under one lock and config */
+#define SPI_QUEUE_NAME_LEN   32
 
 struct SpiCntlr;
 struct SpiCntlrMethod;
@@ -24,6 +33,39 @@ struct SpiCntlrMethod {
     int32_t (*Transfer)(struct SpiCntlr *, struct SpiMsg *, uint32_t);
     int32_t (*Open)(struct SpiCntlr *);
     int32_t (*Close)(struct SpiCntlr *);
+    /*
+     * Optional, programs the controller with the config of curCs. The core calls it before
+     * Transfer only when another device or config was programmed last, so a Transfer of a
+     * controller providing it must not program the config itself.
+     */
+    int32_t (*Prepare)(struct SpiCntlr *);
+};
+
+struct SpiQueueEntry {
+    struct SpiAsyncMsg *async;
+    uint32_t csNum;
+};
+
+/* the asynchronous requests of a controller and the thread sending them, created on first use */
+struct SpiQueue {
+    struct SpiCntlr *cntlr;
+    struct SpiQueueEntry entries[SPI_QUEUE_DEPTH];
+    uint32_t head;
+    uint32_t tail;
+    struct SpiQueueEntry run[SPI_QUEUE_BATCH]; /* the batch the thread is sending */
+    OsalSpinlock spin;
+    struct OsalSem sem;
+    struct OsalSem exited;
+    struct OsalThread thread;
+    bool stop;
+    char name[SPI_QUEUE_NAME_LEN];
+};
+
+struct SpiCntlrStats {
+    uint32_t transfers;  /* Transfer calls of the method */
+    uint32_t batches;    /* batches sent by the queue thread */
+    uint32_t cfgWrites;  /* Prepare calls of the method */
+    uint32_t cfgSkips;   /* Prepare calls saved, as the config was already programmed */
 };
 
 struct SpiCntlr {
@@ -36,6 +78,10 @@ struct SpiCntlr {
     struct SpiCntlrMethod *method;
     struct DListHead list;
     void *priv;
+    uint32_t cfgCs;           /* the device whose config is programmed, SPI_CS_NONE if unknown */
+    struct SpiQueue *queue;
+    struct SpiCntlrStats stats;
+    struct PlatformStats xferStats;
 };
 
 struct SpiDev {
@@ -81,4 +127,32 @@ int32_t SpiCntlrGetCfg(struct SpiCntlr *, uint32_t, struct SpiCfg *);
 int32_t SpiCntlrOpen(struct SpiCntlr *, uint32_t);
 int32_t SpiCntlrClose(struct SpiCntlr *, uint32_t);
 
+/**
+ * @brief Queues a transfer, which the queue thread of the controller sends later.
+ *
+ * Requests of a device are sent in the order they are queued. Pending requests of the same
+ * device are sent back to back, ahead of the requests of other devices queued in between,
+ * so the controller is programmed once for all of them.
+ *
+ * @param cntlr Indicates the SPI cntlr device.
+ * @param csNum Indicates the chip select of the device.
+ * @param async Indicates the request, which must stay valid until its callback is called.
+ *
+ * @return Returns 0 if the request is queued; returns HDF_ERR_QUEUE_FULL if too many requests
+ * are pending; returns a negative value otherwise.
+ * @since 1.0
+ */
+int32_t SpiCntlrTransferAsync(struct SpiCntlr *cntlr, uint32_t csNum, struct SpiAsyncMsg *async);
+
+/**
+ * @brief Obtains the transfer statistics of a controller.
+ *
+ * @param cntlr Indicates the SPI cntlr device.
+ * @param stats Indicates the pointer to the statistics.
+ *
+ * @return Returns 0 on success; returns a negative value otherwise.
+ * @since 1.0
+ */
+int32_t SpiCntlrGetStats(struct SpiCntlr *cntlr, struct SpiCntlrStats *stats);
+
 #endif /* SPI_CORE_H */
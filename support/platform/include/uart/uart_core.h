@@ -11,7 +11,11 @@
 
 #include "hdf_base.h"
 #include "hdf_device_desc.h"
+#include "hdf_workqueue.h"
 #include "osal_atomic.h"
+#include "osal_mutex.h"
+#include "osal_spinlock.h"
+#include "platform_stats.h"
 #include "uart_if.h"
 
 #ifdef __cplusplus
@@ -20,6 +24,31 @@ extern "C" {
 #endif
 #endif /* __cplusplus */
 
+/* received data kept until clients read it, filled via UartHostRxPut */
+struct UartRxRing {
+    uint8_t *buf;
+    uint32_t size;          /* a power of 2 */
+    uint32_t head;          /* free running, next byte stored by the rx path */
+    uint32_t tail;          /* free running, next byte read by clients */
+    uint32_t watermark;
+    bool notified;          /* the watermark event was sent and the ring not read below it since */
+    uint32_t dropped;       /* bytes lost because the ring was full */
+    uint32_t events;        /* watermark events raised */
+    OsalSpinlock spin;
+    HdfWork notifyWork;
+    struct UartHost *host;
+};
+
+/* small writes collected and sent together */
+struct UartTxQueue {
+    uint8_t *buf;
+    uint32_t size;
+    uint32_t len;
+    uint32_t flushDelay;    /* ms */
+    HdfWork flushWork;
+    struct UartHost *host;
+};
+
 /**
  * @brief uart device operations.
  */
@@ -30,6 +59,11 @@ struct UartHost {
     OsalAtomic atom;
     void *priv;
     struct UartHostMethod *method;
+    struct UartRxRing *rx;
+    struct UartTxQueue *tx;
+    struct OsalMutex rxLock;        /* guards rx and serialises the readers of the ring */
+    struct OsalMutex txLock;        /* guards tx and serialises the writers of the queue, taken before rxLock */
+    struct PlatformStats xferStats;
 };
 
 struct UartHostMethod {
@@ -43,6 +77,11 @@ struct UartHostMethod {
     int32_t (*SetAttribute)(struct UartHost *host, struct UartAttribute *attribute);
     int32_t (*SetTransMode)(struct UartHost *host, enum UartTransMode mode);
     int32_t (*pollEvent)(struct UartHost *host, void *filep, void *table);
+    /**
+     * optional, hand received data to UartHostRxPut instead of keeping it for Read; once it
+     * returns from disabling, UartHostRxPut must not be called any more
+     */
+    int32_t (*SetRxPush)(struct UartHost *host, bool enable);
 };
 
 struct UartHost *UartHostCreate(struct HdfDeviceObject *device);
@@ -78,21 +117,36 @@ int32_t UartHostInit(struct UartHost *host);
 
 int32_t UartHostDeinit(struct UartHost *host);
 
-static inline int32_t UartHostRead(struct UartHost *host, uint8_t *data, uint32_t size)
-{
-    if (host == NULL || host->method == NULL || host->method->Read == NULL) {
-        return HDF_ERR_NOT_SUPPORT;
-    }
-    return host->method->Read(host, data, size);
-}
+/**
+ * @brief Read received data, from the receive ring if the port has one.
+ *
+ * @return Returns the bytes read on success; returns a negative value otherwise.
+ */
+int32_t UartHostRead(struct UartHost *host, uint8_t *data, uint32_t size);
 
-static inline int32_t UartHostWrite(struct UartHost *host, uint8_t *data, uint32_t size)
-{
-    if (host == NULL || host->method == NULL || host->method->Write == NULL) {
-        return HDF_ERR_NOT_SUPPORT;
-    }
-    return host->method->Write(host, data, size);
-}
+/**
+ * @brief Write data, through the write queue if the port has one.
+ *
+ * @return Returns 0 on success; returns a negative value otherwise.
+ */
+int32_t UartHostWrite(struct UartHost *host, uint8_t *data, uint32_t size);
+
+int32_t UartHostSetBufferConfig(struct UartHost *host, const struct UartBufferConfig *config);
+
+int32_t UartHostFlush(struct UartHost *host);
+
+/**
+ * @brief Store received data in the receive ring, called by the rx path of a controller
+ * after SetRxPush enabled it. May be called in interrupt context.
+ *
+ * @param host Indicates the Uart host device.
+ * @param data Indicates the received data.
+ * @param size Indicates the size of the data.
+ *
+ * @return Returns the bytes stored, less than size if the ring is full; returns a negative value on error.
+ * @since 1.0
+ */
+int32_t UartHostRxPut(struct UartHost *host, const uint8_t *data, uint32_t size);
 
 static inline int32_t UartHostGetBaud(struct UartHost *host, uint32_t *baudRate)
 {
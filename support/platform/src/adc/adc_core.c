@@ -13,10 +13,16 @@
 #include "osal_spinlock.h"
 #include "osal_time.h"
 #include "platform_core.h"
+#include "securec.h"
 
 #define HDF_LOG_TAG adc_core_c
 #define LOCK_WAIT_SECONDS_M 1
 #define ADC_BUFF_SIZE 4
+#define ADC_SCAN_STACK_SIZE 0x2000
+#define ADC_SCAN_USEC_PER_SEC 1000000
+#define ADC_SCAN_USEC_PER_MSEC 1000
+#define ADC_IO_READ_SCAN_MAX 64     /* scans a single ADC_IO_READ_SCAN returns at most */
+#define ADC_SCAN_BURST_MAX 256    /* raw scans sampled back to back before the thread yields */
 
 struct AdcManager {
     struct IDeviceIoService service;
@@ -169,6 +175,7 @@ void AdcDeviceRemove(struct AdcDevice *device)
     if (device == NULL) {
         return;
     }
+    (void)AdcDeviceStopScan(device, NULL);
     AdcManagerRemoveDevice(device);
     (void)OsalSpinDestroy(&device->spin);
 }
@@ -275,6 +282,402 @@ int32_t AdcDeviceStop(struct AdcDevice *device)
     return ret;
 }
 
+static uint32_t AdcScanChanCount(uint32_t mask)
+{
+    uint32_t count = 0;
+
+    while (mask != 0) {
+        mask &= mask - 1;
+        count++;
+    }
+    return count;
+}
+
+static int32_t AdcScanCheckConfig(const struct AdcDevice *device, const struct AdcScanConfig *config)
+{
+    if (config->channelMask == 0 || config->rate == 0 || config->rate > ADC_SCAN_RATE_MAX) {
+        HDF_LOGE("%s: invalid mask:0x%x or rate:%u", __func__, config->channelMask, config->rate);
+        return HDF_ERR_INVALID_PARAM;
+    }
+    if (device->chanNum != 0 && device->chanNum < ADC_SCAN_CHANNEL_MAX &&
+        (config->channelMask >> device->chanNum) != 0) {
+        HDF_LOGE("%s: mask:0x%x exceeds %u channels", __func__, config->channelMask, device->chanNum);
+        return HDF_ERR_INVALID_PARAM;
+    }
+    if (config->depth == 0 || config->depth > ADC_SCAN_DEPTH_MAX ||
+        config->oversample > ADC_SCAN_OVERSAMPLE_MAX || config->reduce > ADC_SCAN_REDUCE_DECIMATE) {
+        HDF_LOGE("%s: invalid depth:%u, oversample:%u or reduce:%u", __func__,
+            config->depth, config->oversample, config->reduce);
+        return HDF_ERR_INVALID_PARAM;
+    }
+    return HDF_SUCCESS;
+}
+
+static void AdcScanFree(struct AdcScan *scan)
+{
+    (void)OsalSpinDestroy(&scan->spin);
+    (void)OsalSemDestroy(&scan->exited);
+    OsalMemFree(scan->acc);
+    OsalMemFree(scan->ring);
+    OsalMemFree(scan);
+}
+
+static struct AdcScan *AdcScanCreate(struct AdcDevice *device, const struct AdcScanConfig *config)
+{
+    struct AdcScan *scan = NULL;
+
+    scan = (struct AdcScan *)OsalMemCalloc(sizeof(*scan));
+    if (scan == NULL) {
+        return NULL;
+    }
+    scan->device = device;
+    scan->config = *config;
+    if (scan->config.oversample == 0) {
+        scan->config.oversample = 1;
+    }
+    scan->chanCount = AdcScanChanCount(config->channelMask);
+    scan->ring = (uint32_t *)OsalMemCalloc(sizeof(*scan->ring) * config->depth * scan->chanCount);
+    scan->acc = (uint64_t *)OsalMemCalloc(sizeof(*scan->acc) * scan->chanCount);
+    if (scan->ring == NULL || scan->acc == NULL) {
+        OsalMemFree(scan->acc);
+        OsalMemFree(scan->ring);
+        OsalMemFree(scan);
+        return NULL;
+    }
+    if (OsalSpinInit(&scan->spin) != HDF_SUCCESS) {
+        OsalMemFree(scan->acc);
+        OsalMemFree(scan->ring);
+        OsalMemFree(scan);
+        return NULL;
+    }
+    if (OsalSemInit(&scan->exited, 0) != HDF_SUCCESS) {
+        (void)OsalSpinDestroy(&scan->spin);
+        OsalMemFree(scan->acc);
+        OsalMemFree(scan->ring);
+        OsalMemFree(scan);
+        return NULL;
+    }
+    return scan;
+}
+
+/* folds one raw scan into the oversampled one and stores that once it is complete */
+static void AdcScanPushOneLocked(struct AdcScan *scan, const uint32_t *raw)
+{
+    uint32_t i;
+    uint32_t *slot = NULL;
+    uint32_t oversample = scan->config.oversample;
+
+    scan->rawScans++;
+    if (oversample > 1) {
+        if (scan->config.reduce == ADC_SCAN_REDUCE_AVERAGE) {
+            for (i = 0; i < scan->chanCount; i++) {
+                scan->acc[i] += raw[i];
+            }
+        } else if (scan->accCount == 0) {
+            for (i = 0; i < scan->chanCount; i++) {
+                scan->acc[i] = raw[i];
+            }
+        }
+        if (++scan->accCount < oversample) {
+            return;
+        }
+    }
+
+    if (scan->count == scan->config.depth) {
+        scan->count--;
+        scan->overruns++;
+    }
+    slot = &scan->ring[scan->head * scan->chanCount];
+    for (i = 0; i < scan->chanCount; i++) {
+        if (oversample == 1) {
+            slot[i] = raw[i];
+        } else if (scan->config.reduce == ADC_SCAN_REDUCE_AVERAGE) {
+            slot[i] = (uint32_t)(scan->acc[i] / oversample);
+        } else {
+            slot[i] = (uint32_t)scan->acc[i];
+        }
+        scan->acc[i] = 0;
+    }
+    scan->accCount = 0;
+    scan->head = (scan->head + 1 == scan->config.depth) ? 0 : scan->head + 1;
+    scan->count++;
+}
+
+static void AdcScanPush(struct AdcScan *scan, const uint32_t *samples, uint32_t count)
+{
+    uint32_t i;
+
+    (void)OsalSpinLockIrq(&scan->spin);
+    for (i = 0; i < count; i++) {
+        AdcScanPushOneLocked(scan, &samples[i * scan->chanCount]);
+    }
+    (void)OsalSpinUnlockIrq(&scan->spin);
+}
+
+/*
+ * Called by the driver, possibly in interrupt context, so the scan is loaded without the device
+ * lock. That is safe because AdcDeviceStopScan detaches the scan, then waits in stopScan until
+ * the driver pushes no more, and only then frees it.
+ */
+int32_t AdcDeviceScanPush(struct AdcDevice *device, const uint32_t *samples, uint32_t count)
+{
+    struct AdcScan *scan = NULL;
+
+    if (device == NULL || samples == NULL) {
+        return HDF_ERR_INVALID_PARAM;
+    }
+    scan = device->scan;
+    if (scan == NULL) {
+        return HDF_ERR_NOT_SUPPORT;
+    }
+    AdcScanPush(scan, samples, count);
+    return HDF_SUCCESS;
+}
+
+/* one raw scan through read, under a single device lock so the channels are sampled together */
+static int32_t AdcScanSample(struct AdcDevice *device, const struct AdcScan *scan, uint32_t *raw)
+{
+    int32_t ret = HDF_SUCCESS;
+    uint32_t channel;
+    uint32_t mask = scan->config.channelMask;
+
+    if (AdcDeviceLock(device) != HDF_SUCCESS) {
+        return HDF_ERR_DEVICE_BUSY;
+    }
+    for (channel = 0; mask != 0 && ret == HDF_SUCCESS; channel++, mask >>= 1) {
+        if ((mask & 1) != 0) {
+            ret = device->ops->read(device, channel, raw++);
+        }
+    }
+    AdcDeviceUnlock(device);
+    return ret;
+}
+
+static void AdcScanSleep(uint64_t us)
+{
+    if (us >= ADC_SCAN_USEC_PER_MSEC) {
+        OsalMSleep((uint32_t)(us / ADC_SCAN_USEC_PER_MSEC));
+    } else {
+        OsalUSleep((uint32_t)us);
+    }
+}
+
+static int AdcScanThreadWorker(void *data)
+{
+    struct AdcScan *scan = (struct AdcScan *)data;
+    struct AdcDevice *device = scan->device;
+    uint32_t raw[ADC_SCAN_CHANNEL_MAX];
+    uint32_t done = 0;
+    uint32_t burst = 0;
+    uint64_t elapsedUs;
+    uint64_t dueUs;
+    OsalTimespec start = {0, 0};
+    OsalTimespec now = {0, 0};
+    OsalTimespec diff = {0, 0};
+
+    (void)OsalGetTime(&start);
+    while (!scan->stop) {
+        if (AdcScanSample(device, scan, raw) == HDF_SUCCESS) {
+            AdcScanPush(scan, raw, 1);
+        }
+        /* paced against the start of the current second, so a late wakeup is caught up */
+        if (++done == scan->config.rate) {
+            start.sec++;
+            done = 0;
+        }
+        (void)OsalGetTime(&now);
+        (void)OsalDiffTime(&start, &now, &diff);
+        elapsedUs = (uint64_t)diff.sec * ADC_SCAN_USEC_PER_SEC + diff.usec;
+        dueUs = (uint64_t)done * ADC_SCAN_USEC_PER_SEC / scan->config.rate;
+        if (dueUs > elapsedUs) {
+            AdcScanSleep(dueUs - elapsedUs);
+            burst = 0;
+        } else if (++burst >= ADC_SCAN_BURST_MAX) {
+            /* read cannot keep up with the rate: give way to the readers and drop the backlog */
+            OsalMSleep(1);
+            (void)OsalGetTime(&start);
+            done = 0;
+            burst = 0;
+        }
+    }
+    (void)OsalSemPost(&scan->exited);
+    return HDF_SUCCESS;
+}
+
+static int32_t AdcScanThreadStart(struct AdcScan *scan)
+{
+    int32_t ret;
+    struct OsalThreadParam param;
+
+    if (sprintf_s(scan->name, sizeof(scan->name), "adc_scan_%u", scan->device->devNum) < 0) {
+        return HDF_FAILURE;
+    }
+    ret = OsalThreadCreate(&scan->thread, AdcScanThreadWorker, scan);
+    if (ret != HDF_SUCCESS) {
+        HDF_LOGE("%s: create thread failed:%d", __func__, ret);
+        return ret;
+    }
+    (void)memset_s(&param, sizeof(param), 0, sizeof(param));
+    param.name = scan->name;
+    param.priority = OSAL_THREAD_PRI_DEFAULT;
+    param.stackSize = ADC_SCAN_STACK_SIZE;
+    scan->swScan = true;
+    ret = OsalThreadStart(&scan->thread, &param);
+    if (ret != HDF_SUCCESS) {
+        HDF_LOGE("%s: start thread failed:%d", __func__, ret);
+        scan->swScan = false;
+        (void)OsalThreadDestroy(&scan->thread);
+    }
+    return ret;
+}
+
+int32_t AdcDeviceStartScan(struct AdcDevice *device, const struct AdcScanConfig *config, const void *owner)
+{
+    int32_t ret;
+    struct AdcScan *scan = NULL;
+
+    if (device == NULL || config == NULL) {
+        HDF_LOGE("%s: device or config is null", __func__);
+        return HDF_ERR_INVALID_PARAM;
+    }
+    if (device->ops == NULL || (device->ops->startScan == NULL && device->ops->read == NULL)) {
+        HDF_LOGE("%s: ops or startScan is null", __func__);
+        return HDF_ERR_NOT_SUPPORT;
+    }
+    ret = AdcScanCheckConfig(device, config);
+    if (ret != HDF_SUCCESS) {
+        return ret;
+    }
+
+    scan = AdcScanCreate(device, config);
+    if (scan == NULL) {
+        HDF_LOGE("%s: alloc scan failed", __func__);
+        return HDF_ERR_MALLOC_FAIL;
+    }
+    scan->owner = owner;
+    if (AdcDeviceLock(device) != HDF_SUCCESS) {
+        AdcScanFree(scan);
+        return HDF_ERR_DEVICE_BUSY;
+    }
+    if (device->scan != NULL) {
+        AdcDeviceUnlock(device);
+        AdcScanFree(scan);
+        HDF_LOGE("%s: adc device(%u) is scanning already", __func__, device->devNum);
+        return HDF_ERR_DEVICE_BUSY;
+    }
+    device->scan = scan;
+    AdcDeviceUnlock(device);
+
+    if (device->ops->startScan != NULL) {
+        ret = device->ops->startScan(device, &scan->config);
+    } else {
+        ret = AdcScanThreadStart(scan);
+    }
+    if (ret != HDF_SUCCESS) {
+        HDF_LOGE("%s: start scan of adc device(%u) failed:%d", __func__, device->devNum, ret);
+        if (AdcDeviceLock(device) == HDF_SUCCESS) {
+            device->scan = NULL;
+            AdcDeviceUnlock(device);
+        }
+        AdcScanFree(scan);
+    }
+    return ret;
+}
+
+int32_t AdcDeviceStopScan(struct AdcDevice *device, const void *owner)
+{
+    int32_t ret = HDF_SUCCESS;
+    struct AdcScan *scan = NULL;
+
+    if (device == NULL) {
+        HDF_LOGE("%s: device is null", __func__);
+        return HDF_ERR_INVALID_OBJECT;
+    }
+    /* detached first, so a concurrent stop finds nothing and readers can no longer reach it */
+    if (AdcDeviceLock(device) != HDF_SUCCESS) {
+        return HDF_ERR_DEVICE_BUSY;
+    }
+    scan = device->scan;
+    if (scan != NULL && owner != NULL && scan->owner != owner) {
+        AdcDeviceUnlock(device);
+        return HDF_ERR_DEVICE_BUSY;
+    }
+    device->scan = NULL;
+    AdcDeviceUnlock(device);
+    if (scan == NULL) {
+        return HDF_SUCCESS;
+    }
+
+    if (scan->swScan) {
+        scan->stop = true;
+        (void)OsalSemWait(&scan->exited, HDF_WAIT_FOREVER);
+        (void)OsalThreadDestroy(&scan->thread);
+    } else if (device->ops->stopScan != NULL) {
+        ret = device->ops->stopScan(device);
+        if (ret != HDF_SUCCESS) {
+            HDF_LOGE("%s: stop scan of adc device(%u) failed:%d", __func__, device->devNum, ret);
+            /* still running, so it is put back rather than freed under the driver */
+            if (AdcDeviceLock(device) == HDF_SUCCESS) {
+                device->scan = (device->scan == NULL) ? scan : device->scan;
+                AdcDeviceUnlock(device);
+            }
+            return ret;
+        }
+    }
+
+    HDF_LOGD("%s: adc device(%u) scanned %u, overran %u", __func__, device->devNum,
+        scan->rawScans, scan->overruns);
+    AdcScanFree(scan);
+    return HDF_SUCCESS;
+}
+
+static int32_t AdcScanRead(struct AdcDevice *device, uint32_t *buf, uint32_t count, uint32_t *chanCount)
+{
+    uint32_t first;
+    uint32_t part;
+    uint32_t width;
+    struct AdcScan *scan = NULL;
+
+    if (device == NULL || buf == NULL) {
+        HDF_LOGE("%s: device or buf is null", __func__);
+        return HDF_ERR_INVALID_PARAM;
+    }
+    /* the device lock keeps AdcDeviceStopScan from detaching and freeing the scan meanwhile */
+    if (AdcDeviceLock(device) != HDF_SUCCESS) {
+        return HDF_ERR_DEVICE_BUSY;
+    }
+    scan = device->scan;
+    if (scan == NULL) {
+        AdcDeviceUnlock(device);
+        HDF_LOGE("%s: adc device(%u) is not scanning", __func__, device->devNum);
+        return HDF_ERR_NOT_SUPPORT;
+    }
+
+    width = scan->chanCount * sizeof(*scan->ring);
+    (void)OsalSpinLockIrq(&scan->spin);
+    if (count > scan->count) {
+        count = scan->count;
+    }
+    first = (scan->head + scan->config.depth - scan->count) % scan->config.depth;
+    part = (count < scan->config.depth - first) ? count : scan->config.depth - first;
+    (void)memcpy_s(buf, count * width, &scan->ring[first * scan->chanCount], part * width);
+    if (count > part) {
+        (void)memcpy_s(&buf[part * scan->chanCount], (count - part) * width, scan->ring, (count - part) * width);
+    }
+    scan->count -= count;
+    (void)OsalSpinUnlockIrq(&scan->spin);
+    if (chanCount != NULL) {
+        *chanCount = scan->chanCount;
+    }
+    AdcDeviceUnlock(device);
+    return (int32_t)count;
+}
+
+int32_t AdcDeviceReadScan(struct AdcDevice *device, uint32_t *buf, uint32_t count)
+{
+    return AdcScanRead(device, buf, count, NULL);
+}
+
 static int32_t AdcManagerIoOpen(struct HdfSBuf *data, struct HdfSBuf *reply)
 {
     uint32_t number;
@@ -297,9 +700,10 @@ static int32_t AdcManagerIoOpen(struct HdfSBuf *data, struct HdfSBuf *reply)
     return HDF_SUCCESS;
 }
 
-static int32_t AdcManagerIoClose(struct HdfSBuf *data, struct HdfSBuf *reply)
+static int32_t AdcManagerIoClose(struct HdfDeviceIoClient *client, struct HdfSBuf *data, struct HdfSBuf *reply)
 {
     uint32_t number;
+    struct AdcDevice *device = NULL;
 
     if (!HdfSbufReadUint32(data, &number)) {
         return HDF_ERR_IO;
@@ -308,7 +712,87 @@ static int32_t AdcManagerIoClose(struct HdfSBuf *data, struct HdfSBuf *reply)
     if (number < 0 || number >= ADC_DEVICES_MAX) {
         return HDF_ERR_INVALID_PARAM;
     }
-    AdcDevicePut(AdcManagerFindDevice(number));
+    device = AdcManagerFindDevice(number);
+    if (device != NULL) {
+        /* a scan another client started keeps running */
+        (void)AdcDeviceStopScan(device, client);
+    }
+    AdcDevicePut(device);
+    return HDF_SUCCESS;
+}
+
+static struct AdcDevice *AdcManagerIoReadDevice(struct HdfSBuf *data)
+{
+    uint32_t number;
+
+    if (!HdfSbufReadUint32(data, &number) || number >= ADC_DEVICES_MAX) {
+        return NULL;
+    }
+    return AdcManagerFindDevice(number);
+}
+
+static int32_t AdcManagerIoStartScan(struct HdfDeviceIoClient *client, struct HdfSBuf *data)
+{
+    uint32_t len;
+    const struct AdcScanConfig *config = NULL;
+    struct AdcDevice *device = NULL;
+
+    device = AdcManagerIoReadDevice(data);
+    if (device == NULL) {
+        return HDF_ERR_INVALID_PARAM;
+    }
+    if (!HdfSbufReadBuffer(data, (const void **)&config, &len) || len != sizeof(*config)) {
+        HDF_LOGE("%s: read scan config failed", __func__);
+        return HDF_ERR_IO;
+    }
+    return AdcDeviceStartScan(device, config, client);
+}
+
+static int32_t AdcManagerIoStopScan(struct HdfDeviceIoClient *client, struct HdfSBuf *data)
+{
+    struct AdcDevice *device = NULL;
+
+    device = AdcManagerIoReadDevice(data);
+    if (device == NULL) {
+        return HDF_ERR_INVALID_PARAM;
+    }
+    return AdcDeviceStopScan(device, client);
+}
+
+static int32_t AdcManagerIoReadScan(struct HdfSBuf *data, struct HdfSBuf *reply)
+{
+    int32_t ret;
+    uint32_t count;
+    uint32_t chanCount = 0;
+    uint32_t *buf = NULL;
+    struct AdcDevice *device = NULL;
+
+    device = AdcManagerIoReadDevice(data);
+    if (device == NULL || reply == NULL) {
+        return HDF_ERR_INVALID_PARAM;
+    }
+    if (!HdfSbufReadUint32(data, &count)) {
+        return HDF_ERR_IO;
+    }
+    if (count > ADC_IO_READ_SCAN_MAX) {
+        count = ADC_IO_READ_SCAN_MAX;
+    }
+    buf = (uint32_t *)OsalMemCalloc(sizeof(*buf) * ADC_SCAN_CHANNEL_MAX * ADC_IO_READ_SCAN_MAX);
+    if (buf == NULL) {
+        return HDF_ERR_MALLOC_FAIL;
+    }
+    ret = AdcScanRead(device, buf, count, &chanCount);
+    if (ret < 0) {
+        OsalMemFree(buf);
+        return ret;
+    }
+    /* the scans read, then their samples, lowest channel first */
+    if (!HdfSbufWriteUint32(reply, (uint32_t)ret) ||
+        !HdfSbufWriteBuffer(reply, buf, sizeof(*buf) * chanCount * (uint32_t)ret)) {
+        OsalMemFree(buf);
+        return HDF_ERR_IO;
+    }
+    OsalMemFree(buf);
     return HDF_SUCCESS;
 }
 
@@ -328,9 +812,15 @@ static int32_t AdcManagerDispatch(struct HdfDeviceIoClient *client, int cmd,
         case ADC_IO_OPEN:
             return AdcManagerIoOpen(data, reply);
         case ADC_IO_CLOSE:
-            return AdcManagerIoClose(data, reply);
+            return AdcManagerIoClose(client, data, reply);
         case ADC_IO_READ:
             return AdcManagerIoRead(data, reply);
+        case ADC_IO_START_SCAN:
+            return AdcManagerIoStartScan(client, data);
+        case ADC_IO_STOP_SCAN:
+            return AdcManagerIoStopScan(client, data);
+        case ADC_IO_READ_SCAN:
+            return AdcManagerIoReadScan(data, reply);
         default:
             ret = HDF_ERR_NOT_SUPPORT;
             break;
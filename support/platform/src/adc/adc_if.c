@@ -14,9 +14,23 @@
 #define HDF_LOG_TAG adc_if_c
 #define ADC_SERVICE_NAME "HDF_PLATFORM_ADC_MANAGER"
 
+/* one per AdcOpen, so a scan is owned by the handle that started it rather than the device */
+struct AdcObject {
+    struct AdcDevice *device;
+};
+
+static struct AdcDevice *AdcHandleToDevice(DevHandle handle)
+{
+    if (handle == NULL) {
+        return NULL;
+    }
+    return ((struct AdcObject *)handle)->device;
+}
+
 DevHandle AdcOpen(uint32_t number)
 {
     int32_t ret;
+    struct AdcObject *object = NULL;
     struct AdcDevice *device = NULL;
 
     device = AdcDeviceGet(number);
@@ -24,24 +38,37 @@ DevHandle AdcOpen(uint32_t number)
         return NULL;
     }
 
+    object = (struct AdcObject *)OsalMemCalloc(sizeof(*object));
+    if (object == NULL) {
+        HDF_LOGE("%s: object malloc error", __func__);
+        AdcDevicePut(device);
+        return NULL;
+    }
+
     ret = AdcDeviceStart(device);
     if (ret != HDF_SUCCESS) {
+        OsalMemFree(object);
+        AdcDevicePut(device);
         return NULL;
     }
 
-    return (DevHandle)device;
+    object->device = device;
+    return (DevHandle)object;
 }
 
 void AdcClose(DevHandle handle)
 {
-    struct AdcDevice *device = (struct AdcDevice *)handle;
+    struct AdcDevice *device = AdcHandleToDevice(handle);
 
     if (device == NULL) {
         return;
     }
 
+    /* a scan another handle started keeps running */
+    (void)AdcDeviceStopScan(device, handle);
     (void)AdcDeviceStop(device);
     AdcDevicePut(device);
+    OsalMemFree(handle);
 }
 
 int32_t AdcRead(DevHandle handle, uint32_t channel, uint32_t *val)
@@ -50,5 +77,32 @@ int32_t AdcRead(DevHandle handle, uint32_t channel, uint32_t *val)
         HDF_LOGE("%s: invalid handle!", __func__);
         return HDF_ERR_INVALID_PARAM;
     }
-    return AdcDeviceRead((struct AdcDevice *)handle, channel, val);
+    return AdcDeviceRead(AdcHandleToDevice(handle), channel, val);
+}
+
+int32_t AdcStartScan(DevHandle handle, const struct AdcScanConfig *config)
+{
+    if (handle == NULL) {
+        HDF_LOGE("%s: invalid handle!", __func__);
+        return HDF_ERR_INVALID_PARAM;
+    }
+    return AdcDeviceStartScan(AdcHandleToDevice(handle), config, handle);
+}
+
+int32_t AdcStopScan(DevHandle handle)
+{
+    if (handle == NULL) {
+        HDF_LOGE("%s: invalid handle!", __func__);
+        return HDF_ERR_INVALID_PARAM;
+    }
+    return AdcDeviceStopScan(AdcHandleToDevice(handle), handle);
+}
+
+int32_t AdcReadScan(DevHandle handle, uint32_t *buf, uint32_t count)
+{
+    if (handle == NULL) {
+        HDF_LOGE("%s: invalid handle!", __func__);
+        return HDF_ERR_INVALID_PARAM;
+    }
+    return AdcDeviceReadScan(AdcHandleToDevice(handle), buf, count);
 }
@@ -77,6 +77,10 @@ static int32_t DmacCntlrCheckParam(struct DmaCntlr *cntlr)
         HDF_LOGE("%s: invalid channelNum:%u", __func__, cntlr->channelNum);
         return HDF_ERR_INVALID_OBJECT;
     }
+    if (cntlr->lliPoolSize > DMAC_LLI_POOL_MAX) {
+        HDF_LOGE("%s: invalid lliPoolSize:%u", __func__, cntlr->lliPoolSize);
+        return HDF_ERR_INVALID_OBJECT;
+    }
     return HDF_SUCCESS;
 }
 
@@ -127,13 +131,26 @@ struct DmaCntlr *DmaCntlrCreate(struct HdfDeviceObject *device)
 
 static void DmacFreeLli(struct DmacChanInfo *chanInfo)
 {
-    if (chanInfo != NULL && chanInfo->lli != NULL) {
+    /* the chain of an async transfer belongs to the pool */
+    if (chanInfo != NULL && chanInfo->lli != NULL && !chanInfo->async) {
         OsalMemFree(chanInfo->lli);
         chanInfo->lli = NULL;
         chanInfo->lliCnt = 0;
     }
 }
 
+static void DmacLliPoolDeinit(struct DmaCntlr *cntlr)
+{
+    if (cntlr->lliPool != NULL) {
+        OsalMemFree(cntlr->lliPool);
+        cntlr->lliPool = NULL;
+    }
+    if (cntlr->lliPoolNext != NULL) {
+        OsalMemFree(cntlr->lliPoolNext);
+        cntlr->lliPoolNext = NULL;
+    }
+}
+
 /*
  * If private is allocated, release private before calling this function
  */
@@ -153,6 +170,8 @@ void DmaCntlrDestroy(struct DmaCntlr *cntlr)
         cntlr->channelList = NULL;
         cntlr->channelNum = 0;
     }
+    DmacLliPoolDeinit(cntlr);
+    PlatformStatsUnregister(&cntlr->xferStats);
     /* Private is released by the caller */
     cntlr->private = NULL;
     OsalMemFree(cntlr);
@@ -167,8 +186,32 @@ static void DmacEventCallback(struct DmacChanInfo *chanInfo)
     }
 }
 
-static void DmacCallbackHandle(struct DmacChanInfo *chanInfo)
+static void DmacAsyncCallback(struct DmaCntlr *cntlr, struct DmacChanInfo *chanInfo)
 {
+    uint32_t flags;
+    struct DmacFence *fence = NULL;
+
+    if (chanInfo->callback != NULL) {
+        chanInfo->callback(chanInfo->callbackData, chanInfo->status);
+    }
+    /* signalled under the lock, so a waiter which timed out and detached the fence is never written */
+    OsalSpinLockIrqSave(&cntlr->lock, &flags);
+    fence = chanInfo->fence;
+    if (fence != NULL) {
+        chanInfo->fence = NULL;
+        fence->cntlr = NULL;
+        fence->status = chanInfo->status;
+        DmaEventSignal(&fence->event, (chanInfo->status == DMAC_CHN_ERROR) ? DMAC_EVENT_ERROR : DMAC_EVENT_DONE);
+    }
+    OsalSpinUnlockIrqRestore(&cntlr->lock, &flags);
+}
+
+static void DmacCallbackHandle(struct DmaCntlr *cntlr, struct DmacChanInfo *chanInfo)
+{
+    if (chanInfo->async) {
+        DmacAsyncCallback(cntlr, chanInfo);
+        return;
+    }
     if (chanInfo->transType == TRASFER_TYPE_M2M) {
         DmacEventCallback(chanInfo);
         return;
@@ -199,9 +242,26 @@ static int32_t DmacWaitM2mSendComplete(struct DmaCntlr *cntlr, struct DmacChanIn
     return DMAC_CHN_SUCCESS;
 }
 
-static uint16_t DmacAllocateChannel(struct DmaCntlr *cntlr)
+/* the lowest set bit of a word which is not 0 */
+static inline uint16_t DmacLowBit(uint32_t word)
 {
-    int i;
+    uint16_t bit = 0;
+    uint16_t half = DMAC_CHAN_MAP_BITS / 2;
+
+    while (half > 0) {
+        if ((word & ((1U << half) - 1)) == 0) {
+            word >>= half;
+            bit += half;
+        }
+        half >>= 1;
+    }
+    return bit;
+}
+
+static int DmacAllocateChannel(struct DmaCntlr *cntlr)
+{
+    uint16_t i;
+    uint16_t chan;
     uint32_t flags;
 
     if (DmacCntlrCheck(cntlr) != HDF_SUCCESS) {
@@ -209,28 +269,79 @@ static uint16_t DmacAllocateChannel(struct DmaCntlr *cntlr)
     }
 
     OsalSpinLockIrqSave(&cntlr->lock, &flags);
-    for (i = 0; i < cntlr->channelNum; i++) {
-        if (cntlr->channelList[i].useStatus ==  DMAC_CHN_VACANCY) {
-            cntlr->channelList[i].useStatus = DMAC_CHN_ALLOCAT;
+    for (i = 0; i < DMAC_CHAN_MAP_WORDS; i++) {
+        if (cntlr->chanFreeMap[i] != 0) {
+            chan = DmacLowBit(cntlr->chanFreeMap[i]);
+            cntlr->chanFreeMap[i] &= ~(1U << chan);
+            chan += i * DMAC_CHAN_MAP_BITS;
+            cntlr->channelList[chan].useStatus = DMAC_CHN_ALLOCAT;
             OsalSpinUnlockIrqRestore(&cntlr->lock, &flags);
-            return i;
+            return chan;
         }
     }
     OsalSpinUnlockIrqRestore(&cntlr->lock, &flags);
     return HDF_FAILURE;
 }
 
+/* called with the lock held, returns DMAC_LLI_INVALID if not enough descriptors are free */
+static uint16_t DmacLliPoolGet(struct DmaCntlr *cntlr, uint16_t num)
+{
+    uint16_t i;
+    uint16_t head;
+    uint16_t tail;
+
+    if (num == 0 || cntlr->lliPoolAvail < num) {
+        return DMAC_LLI_INVALID;
+    }
+    head = tail = cntlr->lliPoolFree;
+    for (i = 1; i < num; i++) {
+        tail = cntlr->lliPoolNext[tail];
+    }
+    cntlr->lliPoolFree = cntlr->lliPoolNext[tail];
+    cntlr->lliPoolNext[tail] = DMAC_LLI_INVALID;
+    cntlr->lliPoolAvail -= num;
+    return head;
+}
+
+/* called with the lock held */
+static void DmacLliPoolPut(struct DmaCntlr *cntlr, uint16_t head, uint16_t num)
+{
+    uint16_t i;
+    uint16_t tail = head;
+
+    for (i = 1; i < num; i++) {
+        tail = cntlr->lliPoolNext[tail];
+    }
+    cntlr->lliPoolNext[tail] = cntlr->lliPoolFree;
+    cntlr->lliPoolFree = head;
+    cntlr->lliPoolAvail += num;
+}
+
 static void DmacFreeChannel(struct DmaCntlr *cntlr, uint16_t channel)
 {
     uint32_t flags;
+    struct DmacChanInfo *chanInfo = NULL;
 
-    if (DmacCntlrCheck(cntlr) != HDF_SUCCESS) {
+    if (DmacCntlrCheck(cntlr) != HDF_SUCCESS || channel >= cntlr->channelNum) {
         return;
     }
 
     OsalSpinLockIrqSave(&cntlr->lock, &flags);
-    DmacFreeLli(&cntlr->channelList[channel]);
-    cntlr->channelList[channel].useStatus = DMAC_CHN_VACANCY;
+    chanInfo = &cntlr->channelList[channel];
+    if (chanInfo->async) {
+        DmacLliPoolPut(cntlr, chanInfo->poolHead, chanInfo->lliCnt);
+        chanInfo->async = false;
+        chanInfo->lli = NULL;
+        chanInfo->lliCnt = 0;
+        if (chanInfo->fence != NULL) {
+            chanInfo->fence->cntlr = NULL;
+            chanInfo->fence = NULL;
+        }
+    } else {
+        DmacFreeLli(chanInfo);
+    }
+    chanInfo->useStatus = DMAC_CHN_VACANCY;
+    cntlr->chanFreeMap[channel / DMAC_CHAN_MAP_BITS] |= 1U << (channel % DMAC_CHAN_MAP_BITS);
     OsalSpinUnlockIrqRestore(&cntlr->lock, &flags);
 }
 
@@ -415,7 +526,7 @@ static int32_t DmacPeriphTransfer(struct DmaCntlr *cntlr, struct DmacMsg *msg)
     return HDF_SUCCESS;
 }
 
-static int32_t DmacM2mTransfer(struct DmaCntlr *cntlr, struct DmacMsg *msg)
+static int32_t DmacM2mTransfer(struct DmaCntlr *cntlr, struct DmacMsg *msg, struct PlatformStatsStamp *stamp)
 {
     int32_t ret;
     size_t leftSize;
@@ -432,6 +543,7 @@ static int32_t DmacM2mTransfer(struct DmaCntlr *cntlr, struct DmacMsg *msg)
         HDF_LOGE("%s: request channel failed", __func__);
         return HDF_FAILURE;
     }
+    PlatformStatsLocked(stamp);
     chanInfo->callback = msg->cb;
     chanInfo->callbackData = msg->para;
     cntlr->dmacCacheFlush((uintptr_t)msg->srcAddr, (uintptr_t)(msg->srcAddr + msg->transLen));
@@ -470,7 +582,9 @@ static int32_t DmacM2mTransfer(struct DmaCntlr *cntlr, struct DmacMsg *msg)
 
 int32_t DmaCntlrTransfer(struct DmaCntlr *cntlr, struct DmacMsg *msg)
 {
+    int32_t ret;
     uintptr_t phyAddr;
+    struct PlatformStatsStamp stamp;
 
     if (DmacCntlrCheck(cntlr) != HDF_SUCCESS) {
         return HDF_ERR_INVALID_OBJECT;
@@ -489,7 +603,11 @@ int32_t DmaCntlrTransfer(struct DmaCntlr *cntlr, struct DmacMsg *msg)
             cntlr->dmacCacheFlush(phyAddr, (uintptr_t)(phyAddr + msg->transLen));
         }
     } else if (msg->transType == TRASFER_TYPE_M2M) {
-        return DmacM2mTransfer(cntlr, msg);
+        /* the lock time is spent getting a channel */
+        PlatformStatsBegin(&stamp);
+        ret = DmacM2mTransfer(cntlr, msg, &stamp);
+        PlatformStatsEnd(&cntlr->xferStats, &stamp, (ret == HDF_SUCCESS) ? (uint32_t)msg->transLen : 0, ret);
+        return ret;
     } else {
         HDF_LOGE("%s: invalid transType %d", __func__, msg->transType);
         return HDF_FAILURE;
@@ -497,6 +615,204 @@ int32_t DmaCntlrTransfer(struct DmaCntlr *cntlr, struct DmacMsg *msg)
     return DmacPeriphTransfer(cntlr, msg);
 }
 
+/* descriptors of the whole list, 0 if it is invalid or does not fit in the pool */
+static uint16_t DmacAsyncLliNum(struct DmaCntlr *cntlr, const struct DmacAsyncMsg *msg, size_t alignedMax)
+{
+    uint16_t i;
+    size_t lliNum = 0;
+
+    for (i = 0; i < msg->sgNum; i++) {
+        if (msg->sg[i].len == 0 ||
+            (msg->sg[i].srcAddr == 0 && msg->transType != TRASFER_TYPE_P2M) ||
+            (msg->sg[i].destAddr == 0 && msg->transType != TRASFER_TYPE_M2P)) {
+            HDF_LOGE("%s: invalid sg entry %u", __func__, i);
+            return 0;
+        }
+        lliNum += (msg->sg[i].len + alignedMax - 1) / alignedMax;
+        if (lliNum > cntlr->lliPoolSize) {
+            HDF_LOGE("%s: %zu descriptors at entry %u, the pool has %u", __func__, lliNum, i, cntlr->lliPoolSize);
+            return 0;
+        }
+    }
+    return (uint16_t)lliNum;
+}
+
+static void DmacAsyncCacheSync(struct DmaCntlr *cntlr, const struct DmacAsyncMsg *msg)
+{
+    uint16_t i;
+    uintptr_t vaddr;
+
+    for (i = 0; i < msg->sgNum; i++) {
+        if (msg->transType != TRASFER_TYPE_P2M) {
+            vaddr = (uintptr_t)cntlr->dmacPaddrToVaddr((paddr_t)msg->sg[i].srcAddr);
+            cntlr->dmacCacheFlush(vaddr, vaddr + msg->sg[i].len);
+        }
+        if (msg->transType != TRASFER_TYPE_M2P) {
+            vaddr = (uintptr_t)cntlr->dmacPaddrToVaddr((paddr_t)msg->sg[i].destAddr);
+            cntlr->dmacCacheInv(vaddr, vaddr + msg->sg[i].len);
+        }
+    }
+}
+
+/* fill the pool descriptors of the channel, following the order of the pool links */
+static void DmacFillChain(struct DmaCntlr *cntlr, struct DmacChanInfo *chanInfo, const struct DmacAsyncMsg *msg,
+    size_t alignedMax)
+{
+    uint16_t i;
+    uint16_t idx = chanInfo->poolHead;
+    size_t left;
+    uintptr_t src;
+    uintptr_t dst;
+    struct DmacLli *plli = NULL;
+
+    for (i = 0; i < msg->sgNum; i++) {
+        src = msg->sg[i].srcAddr;
+        dst = msg->sg[i].destAddr;
+        for (left = msg->sg[i].len; left > 0; left -= plli->count) {
+            plli = &cntlr->lliPool[idx];
+            idx = cntlr->lliPoolNext[idx];
+            plli->nextLli = (idx == DMAC_LLI_INVALID) ? 0 :
+                ((uintptr_t)cntlr->dmacVaddrToPaddr((void *)&cntlr->lliPool[idx]) + chanInfo->lliEnFlag);
+            plli->count = (left > alignedMax) ? alignedMax : left;
+            plli->srcAddr = src;
+            plli->destAddr = dst;
+            plli->config = chanInfo->config;
+            cntlr->dmacCacheFlush((uintptr_t)plli, (uintptr_t)(plli + 1));
+            src += (msg->transType != TRASFER_TYPE_P2M) ? plli->count : 0;
+            dst += (msg->transType != TRASFER_TYPE_M2P) ? plli->count : 0;
+        }
+    }
+}
+
+static int32_t DmacCheckAsyncMsg(struct DmaCntlr *cntlr, const struct DmacAsyncMsg *msg)
+{
+    if (DmacCntlrCheck(cntlr) != HDF_SUCCESS || cntlr->lliPool == NULL) {
+        return HDF_ERR_INVALID_OBJECT;
+    }
+    if (msg == NULL || msg->sg == NULL || msg->sgNum == 0) {
+        return HDF_ERR_INVALID_PARAM;
+    }
+    if (msg->transType != TRASFER_TYPE_M2M && msg->transType != TRASFER_TYPE_P2M &&
+        msg->transType != TRASFER_TYPE_M2P) {
+        HDF_LOGE("%s: invalid transType %d", __func__, msg->transType);
+        return HDF_ERR_INVALID_PARAM;
+    }
+    return HDF_SUCCESS;
+}
+
+int32_t DmaCntlrTransferAsync(struct DmaCntlr *cntlr, const struct DmacAsyncMsg *msg)
+{
+    int32_t ret;
+    uint16_t lliNum;
+    uint16_t head;
+    uint32_t flags;
+    size_t alignedMax;
+    struct DmacChanInfo *chanInfo = NULL;
+    struct DmacMsg first;
+
+    ret = DmacCheckAsyncMsg(cntlr, msg);
+    if (ret != HDF_SUCCESS) {
+        return ret;
+    }
+    /* the channel is configured as for the first block, the peripheral side is the same in all */
+    first.srcAddr = msg->sg[0].srcAddr;
+    first.destAddr = msg->sg[0].destAddr;
+    first.srcWidth = msg->srcWidth;
+    first.destWidth = msg->destWidth;
+    first.transType = msg->transType;
+    first.transLen = msg->sg[0].len;
+    first.cb = msg->cb;
+    first.para = msg->para;
+    chanInfo = DmacRequestChannel(cntlr, &first);
+    if (chanInfo == NULL) {
+        return HDF_ERR_DEVICE_BUSY;
+    }
+    alignedMax = DmacAlignedTransMax(cntlr->maxTransSize, chanInfo->srcWidth, chanInfo->destWidth);
+    lliNum = (alignedMax == 0) ? 0 : DmacAsyncLliNum(cntlr, msg, alignedMax);
+    if (lliNum == 0) {
+        DmacFreeChannel(cntlr, chanInfo->channel);
+        return HDF_ERR_INVALID_PARAM;
+    }
+
+    OsalSpinLockIrqSave(&cntlr->lock, &flags);
+    head = DmacLliPoolGet(cntlr, lliNum);
+    if (head != DMAC_LLI_INVALID) {
+        chanInfo->async = true;
+        chanInfo->poolHead = head;
+        chanInfo->lliCnt = lliNum;
+        chanInfo->lli = &cntlr->lliPool[head];
+    }
+    OsalSpinUnlockIrqRestore(&cntlr->lock, &flags);
+    if (head == DMAC_LLI_INVALID) {
+        DmacFreeChannel(cntlr, chanInfo->channel);
+        return HDF_ERR_DEVICE_BUSY;
+    }
+    chanInfo->callback = msg->cb;
+    chanInfo->callbackData = msg->para;
+    chanInfo->fence = msg->fence;
+    if (msg->fence != NULL) {
+        msg->fence->cntlr = cntlr;
+        msg->fence->channel = chanInfo->channel;
+    }
+    DmacFillChain(cntlr, chanInfo, msg, alignedMax);
+    DmacAsyncCacheSync(cntlr, msg);
+    ret = cntlr->dmaChanEnable(cntlr, chanInfo);
+    if (ret != HDF_SUCCESS) {
+        HDF_LOGE("%s: enable channel failed, ret = %d", __func__, ret);
+        DmacFreeChannel(cntlr, chanInfo->channel);
+        return HDF_FAILURE;
+    }
+    return HDF_SUCCESS;
+}
+
+void DmacFenceInit(struct DmacFence *fence)
+{
+    if (fence == NULL) {
+        return;
+    }
+    DmaEventInit(&fence->event);
+    fence->status = DMAC_NOT_FINISHED;
+    fence->cntlr = NULL;
+}
+
+/* returns false if the transfer has already signalled the fence */
+static bool DmacFenceDetach(struct DmacFence *fence)
+{
+    uint32_t flags;
+    bool detached = false;
+    struct DmaCntlr *cntlr = fence->cntlr;
+
+    if (cntlr == NULL) {
+        return false;
+    }
+    OsalSpinLockIrqSave(&cntlr->lock, &flags);
+    if (fence->cntlr != NULL) {
+        cntlr->channelList[fence->channel].fence = NULL;
+        fence->cntlr = NULL;
+        detached = true;
+    }
+    OsalSpinUnlockIrqRestore(&cntlr->lock, &flags);
+    return detached;
+}
+
+int32_t DmacFenceWait(struct DmacFence *fence, uint32_t timeout)
+{
+    uint32_t ret;
+
+    if (fence == NULL) {
+        return HDF_ERR_INVALID_PARAM;
+    }
+    ret = DmaEventWait(&fence->event, DMAC_EVENT_DONE | DMAC_EVENT_ERROR, timeout);
+    if (ret == LOS_ERRNO_EVENT_READ_TIMEOUT) {
+        if (DmacFenceDetach(fence)) {
+            return DMAC_CHN_TIMEOUT;
+        }
+        /* the transfer ended just after the timeout, and set the status before signalling */
+        return (fence->status == DMAC_CHN_SUCCESS) ? HDF_SUCCESS : DMAC_CHN_ERROR;
+    }
+    return (ret == DMAC_EVENT_DONE) ? HDF_SUCCESS : DMAC_CHN_ERROR;
+}
+
 uintptr_t DmaGetCurrChanDestAddr(struct DmaCntlr *cntlr, uint16_t chan)
 {
     if (DmacCntlrCheck(cntlr) != HDF_SUCCESS) {
@@ -505,10 +821,36 @@ uintptr_t DmaGetCurrChanDestAddr(struct DmaCntlr *cntlr, uint16_t chan)
     return cntlr->dmacGetCurrDestAddr(cntlr, chan);
 }
 
-static uint32_t DmacIsr(uint32_t irq, void *dev)
+void DmacCntlrIrqHandle(struct DmaCntlr *cntlr)
 {
     uint16_t i;
+    bool release;
     int channelStatus;
+    struct DmacChanInfo *chanInfo = NULL;
+
+    if (DmacCntlrCheck(cntlr) != HDF_SUCCESS) {
+        return;
+    }
+    for (i = 0; i < cntlr->channelNum; i++) {
+        channelStatus = cntlr->dmacGetChanStatus(cntlr, i);
+        if (channelStatus == DMAC_CHN_SUCCESS || channelStatus == DMAC_CHN_ERROR) {
+            chanInfo = &(cntlr->channelList[i]);
+            chanInfo->status = channelStatus;
+            /*
+             * a synchronous m2m transfer goes on with its next block and frees the channel itself,
+             * which may be reused as soon as its waiter is woken, so decide before waking it
+             */
+            release = chanInfo->async || chanInfo->transType != TRASFER_TYPE_M2M;
+            DmacCallbackHandle(cntlr, chanInfo);
+            if (release) {
+                DmacFreeChannel(cntlr, i);
+            }
+        }
+    }
+}
+
+static uint32_t DmacIsr(uint32_t irq, void *dev)
+{
     struct DmaCntlr *cntlr = (struct DmaCntlr *)dev;
 
     if (DmacCntlrCheck(cntlr) != HDF_SUCCESS) {
@@ -519,14 +861,32 @@ static uint32_t DmacIsr(uint32_t irq, void *dev)
         HDF_LOGE("%s: cntlr parm err! irq:%d, channel:%u", __func__, cntlr->irq, cntlr->channelNum);
         return HDF_ERR_INVALID_OBJECT;
     }
-    for (i = 0; i < cntlr->channelNum; i++) {
-        channelStatus = cntlr->dmacGetChanStatus(cntlr, i);
-        if (channelStatus == DMAC_CHN_SUCCESS || channelStatus == DMAC_CHN_ERROR) {
-            cntlr->channelList[i].status = channelStatus;
-            DmacCallbackHandle(&(cntlr->channelList[i]));
-            DmacFreeChannel(cntlr, cntlr->channelList[i].channel);
-        }
+    DmacCntlrIrqHandle(cntlr);
+    return HDF_SUCCESS;
+}
+
+static int32_t DmacLliPoolInit(struct DmaCntlr *cntlr)
+{
+    uint16_t i;
+    size_t allocLength;
+
+    if (cntlr->lliPoolSize == 0) {
+        cntlr->lliPoolSize = DMAC_LLI_POOL_DEF;
+    }
+    allocLength = ALIGN(cntlr->lliPoolSize * sizeof(struct DmacLli), CACHE_ALIGNED_SIZE);
+    cntlr->lliPool = (struct DmacLli *)OsalMemAllocAlign(DMA_ALIGN_SIZE, allocLength);
+    cntlr->lliPoolNext = (uint16_t *)OsalMemCalloc(cntlr->lliPoolSize * sizeof(uint16_t));
+    if (cntlr->lliPool == NULL || cntlr->lliPoolNext == NULL) {
+        HDF_LOGE("%s: alloc lli pool of %u failed", __func__, cntlr->lliPoolSize);
+        DmacLliPoolDeinit(cntlr);
+        return HDF_ERR_MALLOC_FAIL;
+    }
+    (void)memset_s(cntlr->lliPool, allocLength, 0, allocLength);
+    for (i = 0; i < cntlr->lliPoolSize; i++) {
+        cntlr->lliPoolNext[i] = (i + 1 < cntlr->lliPoolSize) ? (i + 1) : DMAC_LLI_INVALID;
     }
+    cntlr->lliPoolFree = 0;
+    cntlr->lliPoolAvail = cntlr->lliPoolSize;
     return HDF_SUCCESS;
 }
 
@@ -541,28 +901,47 @@ int32_t DmacCntlrAdd(struct DmaCntlr *cntlr)
     }
 
     (void)OsalSpinInit(&cntlr->lock);
-    ret = OsalRegisterIrq(cntlr->irq, 0, (OsalIRQHandle)DmacIsr, "PlatDmac", cntlr);
-    if (ret != HDF_SUCCESS) {
-        HDF_LOGE("%s: request irq %u failed, ret = %d", __func__, cntlr->irq, ret);
-        (void)OsalSpinDestroy(&cntlr->lock);
-        return ret;
-    }
     cntlr->channelList = (struct DmacChanInfo *)OsalMemCalloc(sizeof(struct DmacChanInfo) * cntlr->channelNum);
     if (cntlr->channelList == NULL) {
         HDF_LOGE("%s: alloc channel list failed", __func__);
-        (void)OsalUnregisterIrq(cntlr->irq, cntlr);
         (void)OsalSpinDestroy(&cntlr->lock);
         return HDF_ERR_MALLOC_FAIL;
     }
+    ret = DmacLliPoolInit(cntlr);
+    if (ret != HDF_SUCCESS) {
+        OsalMemFree(cntlr->channelList);
+        cntlr->channelList = NULL;
+        (void)OsalSpinDestroy(&cntlr->lock);
+        return ret;
+    }
+    (void)memset_s(cntlr->chanFreeMap, sizeof(cntlr->chanFreeMap), 0, sizeof(cntlr->chanFreeMap));
     for (i = 0; i < cntlr->channelNum; i++) {
         cntlr->dmacChanDisable(cntlr, i);
         DmaEventInit(&(cntlr->channelList[i].waitEvent));
         cntlr->channelList[i].useStatus = DMAC_CHN_VACANCY;
+        cntlr->chanFreeMap[i / DMAC_CHAN_MAP_BITS] |= 1U << (i % DMAC_CHAN_MAP_BITS);
+    }
+    (void)PlatformStatsRegister(&cntlr->xferStats, PLATFORM_MODULE_DMA, cntlr->index);
+    if (cntlr->irq == DMAC_IRQ_NONE) {
+        return HDF_SUCCESS;
+    }
+    ret = OsalRegisterIrq(cntlr->irq, 0, (OsalIRQHandle)DmacIsr, "PlatDmac", cntlr);
+    if (ret != HDF_SUCCESS) {
+        HDF_LOGE("%s: request irq %u failed, ret = %d", __func__, cntlr->irq, ret);
+        PlatformStatsUnregister(&cntlr->xferStats);
+        DmacLliPoolDeinit(cntlr);
+        OsalMemFree(cntlr->channelList);
+        cntlr->channelList = NULL;
+        (void)OsalSpinDestroy(&cntlr->lock);
+        return ret;
     }
     return HDF_SUCCESS;
 }
 
 void DmacCntlrRemove(struct DmaCntlr *cntlr)
 {
-    (void)cntlr;
+    if (cntlr == NULL) {
+        return;
+    }
+    PlatformStatsUnregister(&cntlr->xferStats);
 }
@@ -11,47 +11,99 @@
 #include "osal_mem.h"
 #include "osal_mutex.h"
 #include "osal_thread.h"
+#include "securec.h"
 
 #define MMC_QUEUE_THREAD_STAK 20000
+#define PLATFORM_QUEUE_USEC_PER_SEC 1000000
+
+/*
+ * Take the oldest message whose key no worker is handling, with the spinlock held.
+ * Messages of a busy key wait for the worker handling it, which looks again when done.
+ */
+static struct PlatformMsg *PlatformQueueTakeMsg(struct PlatformQueue *queue)
+{
+    uint32_t i;
+    struct PlatformMsg *msg = NULL;
+
+    DLIST_FOR_EACH_ENTRY(msg, &queue->msgs, struct PlatformMsg, node) {
+        for (i = 0; i < queue->workerNum; i++) {
+            if (queue->workers[i].busy && queue->workers[i].key == msg->key) {
+                break;
+            }
+        }
+        if (i == queue->workerNum) {
+            DListRemove(&msg->node);
+            queue->stats.depth--;
+            return msg;
+        }
+    }
+    return NULL;
+}
+
+static uint32_t PlatformMsgWaitUs(const struct PlatformMsg *msg)
+{
+    OsalTimespec now;
+    OsalTimespec diff;
+
+    (void)OsalGetTime(&now);
+    if (OsalDiffTime(&msg->stamp, &now, &diff) != HDF_SUCCESS) {
+        return 0;
+    }
+    return diff.sec * PLATFORM_QUEUE_USEC_PER_SEC + diff.usec;
+}
 
 static int32_t PlatformQueueThreadWorker(void *data)
 {
-    int32_t ret;
-    struct PlatformQueue *queue = (struct PlatformQueue *)data;
+    uint32_t waitUs;
+    struct PlatformQueueWorker *worker = (struct PlatformQueueWorker *)data;
+    struct PlatformQueue *queue = worker->queue;
     struct PlatformMsg *msg = NULL;
 
-    while (true) {
+    while (!queue->stop) {
         /* wait envent */
-        ret = OsalSemWait(&queue->sem, HDF_WAIT_FOREVER);
-        if (ret != HDF_SUCCESS) {
+        if (OsalSemWait(&queue->sem, HDF_WAIT_FOREVER) != HDF_SUCCESS) {
             continue;
         }
 
         (void)OsalSpinLock(&queue->spin);
-        if (DListIsEmpty(&queue->msgs)) {
-            msg = NULL;
-        } else {
-            msg = DLIST_FIRST_ENTRY(&queue->msgs, struct PlatformMsg, node);
-            DListRemove(&msg->node);
-        }
-        (void)OsalSpinUnlock(&queue->spin);
-        /* message process */
-        if (msg != NULL) {
+        while (!queue->stop && (msg = PlatformQueueTakeMsg(queue)) != NULL) {
+            worker->busy = true;
+            worker->key = msg->key;
+            waitUs = PlatformMsgWaitUs(msg);
+            queue->stats.handled++;
+            queue->stats.totalWaitUs += waitUs;
+            if (waitUs > queue->stats.maxWaitUs) {
+                queue->stats.maxWaitUs = waitUs;
+            }
+            (void)OsalSpinUnlock(&queue->spin);
+
+            /* message process */
             (void)(queue->handle(queue, msg));
             if (msg->block == true) {
                 (void)OsalSemPost(&msg->sem);
             }
+
+            (void)OsalSpinLock(&queue->spin);
+            worker->busy = false;
         }
+        (void)OsalSpinUnlock(&queue->spin);
     }
+    (void)OsalSemPost(&queue->exited);
     return HDF_SUCCESS;
 }
 
-struct PlatformQueue *PlatformQueueCreate(PlatformMsgHandle handle, const char *name, void *data)
+/*
+ * Create a queue served by several workers. Messages with the same key are handled one
+ * by one in the order queued, so a slow handler only holds up the messages of its key.
+ */
+struct PlatformQueue *PlatformQueueCreatePool(PlatformMsgHandle handle, const char *name, void *data,
+    uint32_t workerNum)
 {
-    int32_t ret;
+    uint32_t i;
     struct PlatformQueue *queue = NULL;
+    struct PlatformQueueWorker *worker = NULL;
 
-    if (handle == NULL) {
+    if (handle == NULL || workerNum == 0 || workerNum > PLATFORM_QUEUE_WORKER_MAX) {
         return NULL;
     }
 
@@ -62,28 +114,74 @@ struct PlatformQueue *PlatformQueueCreate(PlatformMsgHandle handle, const char *
     }
     (void)OsalSpinInit(&queue->spin);
     (void)OsalSemInit(&queue->sem, 0);
+    (void)OsalSemInit(&queue->exited, 0);
     DListHeadInit(&queue->msgs);
 
-    ret = OsalThreadCreate(&queue->thread, (OsalThreadEntry)PlatformQueueThreadWorker, (void *)queue);
-    if (ret != HDF_SUCCESS) {
-        HDF_LOGE("PlatformQueueCreate: create thread fail!");
-        OsalMemFree(queue);
-        return NULL;
-    }
-
     queue->name = (name == NULL) ? "PlatformWorkerThread" : name;
+    for (i = 0; i < workerNum; i++) {
+        worker = &queue->workers[i];
+        worker->queue = queue;
+        if (workerNum == 1) {
+            (void)strncpy_s(worker->name, PLATFORM_QUEUE_NAME_LEN, queue->name, PLATFORM_QUEUE_NAME_LEN - 1);
+        } else {
+            (void)snprintf_s(worker->name, PLATFORM_QUEUE_NAME_LEN, PLATFORM_QUEUE_NAME_LEN - 1, "%s_%u",
+                queue->name, i);
+        }
+        if (OsalThreadCreate(&worker->thread, (OsalThreadEntry)PlatformQueueThreadWorker, (void *)worker) !=
+            HDF_SUCCESS) {
+            HDF_LOGE("PlatformQueueCreate: create thread fail!");
+            while (i-- > 0) {
+                (void)OsalThreadDestroy(&queue->workers[i].thread);
+            }
+            (void)OsalSemDestroy(&queue->exited);
+            (void)OsalSemDestroy(&queue->sem);
+            (void)OsalSpinDestroy(&queue->spin);
+            OsalMemFree(queue);
+            return NULL;
+        }
+    }
+    queue->workerNum = workerNum;
     queue->handle = handle;
     queue->data = data;
     return queue;
 }
 
+struct PlatformQueue *PlatformQueueCreate(PlatformMsgHandle handle, const char *name, void *data)
+{
+    return PlatformQueueCreatePool(handle, name, data, 1);
+}
+
 void PlatformQueueDestroy(struct PlatformQueue *queue)
 {
+    uint32_t i;
+    struct PlatformMsg *msg = NULL;
+    struct PlatformMsg *tmp = NULL;
+
     if (queue == NULL) {
         return;
     }
 
-    (void)OsalThreadDestroy(&queue->thread);
+    (void)OsalSpinLock(&queue->spin);
+    queue->stop = true;
+    (void)OsalSpinUnlock(&queue->spin);
+    for (i = 0; i < queue->started; i++) {
+        (void)OsalSemPost(&queue->sem);
+    }
+    for (i = 0; i < queue->started; i++) {
+        (void)OsalSemWait(&queue->exited, HDF_WAIT_FOREVER);
+    }
+    for (i = 0; i < queue->workerNum; i++) {
+        (void)OsalThreadDestroy(&queue->workers[i].thread);
+    }
+    /* wake the senders of blocking messages never handled */
+    DLIST_FOR_EACH_ENTRY_SAFE(msg, tmp, &queue->msgs, struct PlatformMsg, node) {
+        DListRemove(&msg->node);
+        if (msg->block == true) {
+            msg->error = HDF_ERR_IO;
+            (void)OsalSemPost(&msg->sem);
+        }
+    }
+    (void)OsalSemDestroy(&queue->exited);
     (void)OsalSemDestroy(&queue->sem);
     (void)OsalSpinDestroy(&queue->spin);
     OsalMemFree(queue);
@@ -98,13 +196,16 @@ int32_t PlatformQueueStart(struct PlatformQueue *queue)
         return HDF_ERR_INVALID_OBJECT;
     }
 
-    cfg.name = (char *)queue->name;
-    cfg.priority = OSAL_THREAD_PRI_HIGHEST;
-    cfg.stackSize = MMC_QUEUE_THREAD_STAK;
-    ret = OsalThreadStart(&queue->thread, &cfg);
-    if (ret != HDF_SUCCESS) {
-        HDF_LOGE("PlatformQueueStart: start thread fail:%d", ret);
-        return ret;
+    while (queue->started < queue->workerNum) {
+        cfg.name = queue->workers[queue->started].name;
+        cfg.priority = OSAL_THREAD_PRI_HIGHEST;
+        cfg.stackSize = MMC_QUEUE_THREAD_STAK;
+        ret = OsalThreadStart(&queue->workers[queue->started].thread, &cfg);
+        if (ret != HDF_SUCCESS) {
+            HDF_LOGE("PlatformQueueStart: start thread fail:%d", ret);
+            return ret;
+        }
+        queue->started++;
     }
 
     return HDF_SUCCESS;
@@ -112,18 +213,36 @@ int32_t PlatformQueueStart(struct PlatformQueue *queue)
 
 int32_t PlatformQueueSuspend(struct PlatformQueue *queue)
 {
+    uint32_t i;
+    int32_t ret;
+
     if (queue == NULL) {
         return HDF_ERR_INVALID_OBJECT;
     }
-    return OsalThreadSuspend(&queue->thread);
+    for (i = 0; i < queue->started; i++) {
+        ret = OsalThreadSuspend(&queue->workers[i].thread);
+        if (ret != HDF_SUCCESS) {
+            return ret;
+        }
+    }
+    return HDF_SUCCESS;
 }
 
 int32_t PlatformQueueResume(struct PlatformQueue *queue)
 {
+    uint32_t i;
+    int32_t ret;
+
     if (queue == NULL) {
         return HDF_ERR_INVALID_OBJECT;
     }
-    return OsalThreadResume(&queue->thread);
+    for (i = 0; i < queue->started; i++) {
+        ret = OsalThreadResume(&queue->workers[i].thread);
+        if (ret != HDF_SUCCESS) {
+            return ret;
+        }
+    }
+    return HDF_SUCCESS;
 }
 
 void PlatformQueueAddMsg(struct PlatformQueue *queue, struct PlatformMsg *msg)
@@ -137,8 +256,13 @@ void PlatformQueueAddMsg(struct PlatformQueue *queue, struct PlatformMsg *msg)
     }
     DListHeadInit(&msg->node);
     msg->error = HDF_SUCCESS;
+    (void)OsalGetTime(&msg->stamp);
     (void)OsalSpinLock(&queue->spin);
     DListInsertTail(&msg->node, &queue->msgs);
+    queue->stats.depth++;
+    if (queue->stats.depth > queue->stats.maxDepth) {
+        queue->stats.maxDepth = queue->stats.depth;
+    }
     (void)OsalSpinUnlock(&queue->spin);
     /* notify the worker thread */
     (void)OsalSemPost(&queue->sem);
@@ -155,3 +279,14 @@ int32_t PlatformMsgWait(struct PlatformMsg *msg)
     }
     return OsalSemWait(&msg->sem, HDF_WAIT_FOREVER);
 }
+
+int32_t PlatformQueueGetStats(struct PlatformQueue *queue, struct PlatformQueueStats *stats)
+{
+    if (queue == NULL || stats == NULL) {
+        return HDF_ERR_INVALID_OBJECT;
+    }
+    (void)OsalSpinLock(&queue->spin);
+    *stats = queue->stats;
+    (void)OsalSpinUnlock(&queue->spin);
+    return HDF_SUCCESS;
+}
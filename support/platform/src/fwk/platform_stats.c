@@ -0,0 +1,366 @@
+/*
+ * Copyright (c) 2021 Huawei Device Co., Ltd.
+ *
+ * HDF is dual licensed: you can use it either under the terms of
+ * the GPL, or the BSD license, at your option.
+ * See the LICENSE file in the root of this repository for complete details.
+ */
+
+#include "platform_stats.h"
+#include "hdf_device_desc.h"
+#include "hdf_log.h"
+#include "osal_mem.h"
+#include "securec.h"
+
+#define HDF_LOG_TAG platform_stats
+
+#ifdef PLATFORM_STATS_ENABLE
+#define PLATFORM_STATS_USEC_PER_SEC 1000000
+
+struct PlatformStatsSnapshot {
+    enum PlatformModuleType module;
+    uint32_t number;
+    struct PlatformStatsData data;
+};
+
+/* all registered counters, protected by the platform global lock */
+static struct DListHead g_statsList = { &g_statsList, &g_statsList };
+
+static bool PlatformStatsIsRegistered(const struct PlatformStats *stats)
+{
+    struct PlatformStats *pos = NULL;
+
+    DLIST_FOR_EACH_ENTRY(pos, &g_statsList, struct PlatformStats, node) {
+        if (pos == stats) {
+            return true;
+        }
+    }
+    return false;
+}
+
+int32_t PlatformStatsRegister(struct PlatformStats *stats, enum PlatformModuleType module, uint32_t number)
+{
+    if (stats == NULL || module >= PLATFORM_MODULE_MAX) {
+        return HDF_ERR_INVALID_PARAM;
+    }
+
+    PlatformGlobalLock();
+    if (!PlatformStatsIsRegistered(stats)) {
+        (void)OsalSpinInit(&stats->spin);
+        (void)memset_s(&stats->data, sizeof(stats->data), 0, sizeof(stats->data));
+        DListInsertTail(&stats->node, &g_statsList);
+    }
+    stats->module = module;
+    stats->number = number;
+    PlatformGlobalUnlock();
+    return HDF_SUCCESS;
+}
+
+void PlatformStatsUnregister(struct PlatformStats *stats)
+{
+    bool registered = false;
+
+    if (stats == NULL) {
+        return;
+    }
+
+    PlatformGlobalLock();
+    if (PlatformStatsIsRegistered(stats)) {
+        DListRemove(&stats->node);
+        registered = true;
+    }
+    PlatformGlobalUnlock();
+    if (registered) {
+        (void)OsalSpinDestroy(&stats->spin);
+    }
+}
+
+static uint32_t PlatformStatsBucket(uint32_t us)
+{
+    uint32_t bucket = 0;
+
+    while (us != 0 && bucket < PLATFORM_STATS_HIST_SIZE - 1) {
+        us >>= 1;
+        bucket++;
+    }
+    return bucket;
+}
+
+static void PlatformStatsAddTime(struct PlatformStatsData *data, enum PlatformStatsHistType type, uint32_t us,
+    uint32_t bucket)
+{
+    data->totalUs[type] += us;
+    if (us > data->maxUs[type]) {
+        data->maxUs[type] = us;
+    }
+    data->hist[type][bucket]++;
+}
+
+void PlatformStatsAdd(struct PlatformStats *stats, uint32_t lockUs, uint32_t busUs, uint32_t bytes, int32_t ret)
+{
+    uint32_t lockBucket;
+    uint32_t busBucket;
+
+    if (stats == NULL) {
+        return;
+    }
+    lockBucket = PlatformStatsBucket(lockUs);
+    busBucket = PlatformStatsBucket(busUs);
+
+    (void)OsalSpinLock(&stats->spin);
+    stats->data.calls++;
+    if (ret < 0) {
+        stats->data.errors++;
+    }
+    stats->data.bytes += bytes;
+    PlatformStatsAddTime(&stats->data, PLATFORM_STATS_HIST_LOCK, lockUs, lockBucket);
+    PlatformStatsAddTime(&stats->data, PLATFORM_STATS_HIST_BUS, busUs, busBucket);
+    (void)OsalSpinUnlock(&stats->spin);
+}
+
+static uint32_t PlatformStatsDiffUs(const OsalTimespec *start, const OsalTimespec *end)
+{
+    OsalTimespec diff;
+
+    if (OsalDiffTime(start, end, &diff) != HDF_SUCCESS) {
+        return 0;
+    }
+    return diff.sec * PLATFORM_STATS_USEC_PER_SEC + diff.usec;
+}
+
+void PlatformStatsEnd(struct PlatformStats *stats, const struct PlatformStatsStamp *stamp, uint32_t bytes,
+    int32_t ret)
+{
+    OsalTimespec now;
+
+    if (stats == NULL || stamp == NULL) {
+        return;
+    }
+    (void)OsalGetTime(&now);
+    PlatformStatsAdd(stats, PlatformStatsDiffUs(&stamp->start, &stamp->locked),
+        PlatformStatsDiffUs(&stamp->locked, &now), bytes, ret);
+}
+
+static bool PlatformStatsMatch(const struct PlatformStats *stats, enum PlatformModuleType module, uint32_t number)
+{
+    if (module == PLATFORM_MODULE_MAX) {
+        return true;
+    }
+    return stats->module == module && (number == PLATFORM_STATS_NUM_ALL || stats->number == number);
+}
+
+int32_t PlatformStatsRead(enum PlatformModuleType module, uint32_t number, struct PlatformStatsData *data)
+{
+    int32_t ret = HDF_PLT_ERR_NO_DEV;
+    struct PlatformStats *pos = NULL;
+
+    if (data == NULL) {
+        return HDF_ERR_INVALID_PARAM;
+    }
+
+    PlatformGlobalLock();
+    DLIST_FOR_EACH_ENTRY(pos, &g_statsList, struct PlatformStats, node) {
+        if (pos->module == module && pos->number == number) {
+            (void)OsalSpinLock(&pos->spin);
+            *data = pos->data;
+            (void)OsalSpinUnlock(&pos->spin);
+            ret = HDF_SUCCESS;
+            break;
+        }
+    }
+    PlatformGlobalUnlock();
+    return ret;
+}
+
+void PlatformStatsReset(enum PlatformModuleType module, uint32_t number)
+{
+    struct PlatformStats *pos = NULL;
+
+    PlatformGlobalLock();
+    DLIST_FOR_EACH_ENTRY(pos, &g_statsList, struct PlatformStats, node) {
+        if (PlatformStatsMatch(pos, module, number)) {
+            (void)OsalSpinLock(&pos->spin);
+            (void)memset_s(&pos->data, sizeof(pos->data), 0, sizeof(pos->data));
+            (void)OsalSpinUnlock(&pos->spin);
+        }
+    }
+    PlatformGlobalUnlock();
+}
+
+/* copy the counters out, so the caller may sleep or print without the global lock */
+static struct PlatformStatsSnapshot *PlatformStatsTakeSnapshot(uint32_t *count)
+{
+    uint32_t num = 0;
+    uint32_t max = 0;
+    struct PlatformStats *pos = NULL;
+    struct PlatformStatsSnapshot *snap = NULL;
+
+    PlatformGlobalLock();
+    DLIST_FOR_EACH_ENTRY(pos, &g_statsList, struct PlatformStats, node) {
+        max++;
+    }
+    PlatformGlobalUnlock();
+    if (max == 0) {
+        *count = 0;
+        return NULL;
+    }
+
+    snap = (struct PlatformStatsSnapshot *)OsalMemCalloc(sizeof(*snap) * max);
+    if (snap == NULL) {
+        *count = 0;
+        return NULL;
+    }
+    /* controllers added meanwhile are left out */
+    PlatformGlobalLock();
+    DLIST_FOR_EACH_ENTRY(pos, &g_statsList, struct PlatformStats, node) {
+        if (num == max) {
+            break;
+        }
+        snap[num].module = pos->module;
+        snap[num].number = pos->number;
+        (void)OsalSpinLock(&pos->spin);
+        snap[num].data = pos->data;
+        (void)OsalSpinUnlock(&pos->spin);
+        num++;
+    }
+    PlatformGlobalUnlock();
+    *count = num;
+    return snap;
+}
+
+static const char *PlatformStatsModuleName(enum PlatformModuleType module)
+{
+    struct PlatformModuleInfo *info = PlatformModuleInfoGet(module);
+
+    return (info == NULL || info->moduleName == NULL) ? "unknown" : info->moduleName;
+}
+
+static void PlatformStatsPrintHist(const struct PlatformStatsData *data, enum PlatformStatsHistType type)
+{
+    uint32_t i;
+
+    for (i = 0; i < PLATFORM_STATS_HIST_SIZE; i++) {
+        if (data->hist[type][i] == 0) {
+            continue;
+        }
+        HDF_LOGI("    %s >=%uus: %u", (type == PLATFORM_STATS_HIST_LOCK) ? "lock" : "bus ",
+            (i == 0) ? 0U : (1U << (i - 1)), data->hist[type][i]);
+    }
+}
+
+void PlatformStatsDump(void)
+{
+    uint32_t i;
+    uint32_t count;
+    struct PlatformStatsData *data = NULL;
+    struct PlatformStatsSnapshot *snap = PlatformStatsTakeSnapshot(&count);
+
+    for (i = 0; i < count; i++) {
+        data = &snap[i].data;
+        HDF_LOGI("%s %u: calls %u, errors %u, bytes %llu, lock avg %llu max %u us, bus avg %llu max %u us",
+            PlatformStatsModuleName(snap[i].module), snap[i].number, data->calls, data->errors,
+            (unsigned long long)data->bytes,
+            (unsigned long long)((data->calls == 0) ? 0 : data->totalUs[PLATFORM_STATS_HIST_LOCK] / data->calls),
+            data->maxUs[PLATFORM_STATS_HIST_LOCK],
+            (unsigned long long)((data->calls == 0) ? 0 : data->totalUs[PLATFORM_STATS_HIST_BUS] / data->calls),
+            data->maxUs[PLATFORM_STATS_HIST_BUS]);
+        PlatformStatsPrintHist(data, PLATFORM_STATS_HIST_LOCK);
+        PlatformStatsPrintHist(data, PLATFORM_STATS_HIST_BUS);
+    }
+    OsalMemFree(snap);
+}
+
+/* reply: the count, then module type, number and counters of each controller */
+static int32_t PlatformStatsIoDump(struct HdfSBuf *reply)
+{
+    uint32_t i;
+    uint32_t count;
+    int32_t ret = HDF_SUCCESS;
+    struct PlatformStatsSnapshot *snap = NULL;
+
+    if (reply == NULL) {
+        return HDF_ERR_INVALID_PARAM;
+    }
+    snap = PlatformStatsTakeSnapshot(&count);
+    if (!HdfSbufWriteUint32(reply, count)) {
+        ret = HDF_ERR_IO;
+    }
+    for (i = 0; i < count && ret == HDF_SUCCESS; i++) {
+        if (!HdfSbufWriteUint32(reply, (uint32_t)snap[i].module) || !HdfSbufWriteUint32(reply, snap[i].number) ||
+            !HdfSbufWriteBuffer(reply, &snap[i].data, sizeof(snap[i].data))) {
+            HDF_LOGE("%s: write stats %u failed", __func__, i);
+            ret = HDF_ERR_IO;
+        }
+    }
+    OsalMemFree(snap);
+    return ret;
+}
+
+static int32_t PlatformStatsIoReset(struct HdfSBuf *data)
+{
+    uint32_t module;
+    uint32_t number;
+
+    if (data == NULL) {
+        return HDF_ERR_INVALID_PARAM;
+    }
+    if (!HdfSbufReadUint32(data, &module) || !HdfSbufReadUint32(data, &number)) {
+        HDF_LOGE("%s: read module or number failed", __func__);
+        return HDF_ERR_IO;
+    }
+    if (module > PLATFORM_MODULE_MAX) {
+        return HDF_ERR_INVALID_PARAM;
+    }
+    PlatformStatsReset((enum PlatformModuleType)module, number);
+    return HDF_SUCCESS;
+}
+
+static int32_t PlatformStatsIoDispatch(struct HdfDeviceIoClient *client, int cmd, struct HdfSBuf *data,
+    struct HdfSBuf *reply)
+{
+    (void)client;
+    switch (cmd) {
+        case PLATFORM_STATS_IO_DUMP:
+            return PlatformStatsIoDump(reply);
+        case PLATFORM_STATS_IO_RESET:
+            return PlatformStatsIoReset(data);
+        default:
+            return HDF_ERR_NOT_SUPPORT;
+    }
+}
+
+static struct IDeviceIoService g_platformStatsService = {
+    .Dispatch = PlatformStatsIoDispatch,
+};
+
+static int32_t PlatformStatsBind(struct HdfDeviceObject *device)
+{
+    if (device == NULL) {
+        return HDF_ERR_INVALID_OBJECT;
+    }
+    device->service = &g_platformStatsService;
+    return HDF_SUCCESS;
+}
+
+static int32_t PlatformStatsInit(struct HdfDeviceObject *device)
+{
+    (void)device;
+    return HDF_SUCCESS;
+}
+
+static void PlatformStatsRelease(struct HdfDeviceObject *device)
+{
+    if (device != NULL) {
+        device->service = NULL;
+    }
+}
+
+struct HdfDriverEntry g_platformStatsEntry = {
+    .moduleVersion = 1,
+    .Bind = PlatformStatsBind,
+    .Init = PlatformStatsInit,
+    .Release = PlatformStatsRelease,
+    .moduleName = "HDF_PLATFORM_STATS",
+};
+HDF_INIT(g_platformStatsEntry);
+#endif /* PLATFORM_STATS_ENABLE */
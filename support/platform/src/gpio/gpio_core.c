@@ -7,6 +7,7 @@
  */
 
 #include "gpio/gpio_core.h"
+#include "osal_atomic.h"
 #include "osal_mem.h"
 #include "platform_core.h"
 #include "securec.h"
@@ -16,6 +17,12 @@
 #define GPIO_IRQ_STACK_SIZE        10000
 #define GPIO_IRQ_THREAD_NAME_LEN   32
 
+#define GPIO_IRQ_POOL_NORMAL_NUM   2
+#define GPIO_IRQ_POOL_WORKER_NUM   (GPIO_IRQ_POOL_NORMAL_NUM + 1) /* the last one runs high priority lines */
+#define GPIO_IRQ_POOL_WORD_BITS    32                             /* bits of a word the osal bit ops work on */
+#define GPIO_IRQ_POOL_WORD_NUM     2
+#define GPIO_IRQ_POOL_SLOT_NUM     (GPIO_IRQ_POOL_WORD_NUM * GPIO_IRQ_POOL_WORD_BITS)
+
 struct GpioIrqBridge {
     uint16_t local;
     GpioIrqFunc func;
@@ -28,6 +35,46 @@ struct GpioIrqBridge {
     bool stop;
 };
 
+struct GpioIrqWorker;
+
+/* a threaded irq line served by the dispatch pool */
+struct GpioIrqLine {
+    struct GpioCntlr *cntlr;
+    uint16_t local;
+    uint16_t slot;
+    GpioIrqFunc func;
+    void *data;
+    struct GpioIrqWorker *worker;
+    bool stop;
+};
+
+/*
+ * A dispatch thread of the pool. The isr only sets the pending bit of the line and wakes the thread,
+ * each line always goes to the same worker, so its routine never runs concurrently with itself.
+ */
+struct GpioIrqWorker {
+    struct OsalThread thread;
+    struct OsalSem sem;
+    OsalSpinlock spin; /* slot allocation */
+    unsigned long pending[GPIO_IRQ_POOL_WORD_NUM];
+    struct GpioIrqLine *lines[GPIO_IRQ_POOL_SLOT_NUM];
+    char name[GPIO_IRQ_THREAD_NAME_LEN];
+    bool stop;
+};
+
+struct GpioIrqPool {
+    struct GpioIrqWorker workers[GPIO_IRQ_POOL_WORKER_NUM];
+    OsalSpinlock lock;     /* started and starting */
+    bool lockReady;        /* lock initialized, under the platform global lock */
+    bool started;
+    bool starting;         /* workers being created, outside the lock */
+    struct OsalSem exited; /* posted by a worker stopped after a failed start */
+    OsalAtomic lineNum;
+    OsalAtomic bridgeNum;
+};
+
+static struct GpioIrqPool g_gpioIrqPool;
+
 int32_t GpioCntlrWrite(struct GpioCntlr *cntlr, uint16_t local, uint16_t val)
 {
     if (cntlr == NULL) {
@@ -53,6 +100,56 @@ int32_t GpioCntlrRead(struct GpioCntlr *cntlr, uint16_t local, uint16_t *val)
     return cntlr->ops->read(cntlr, local, val);
 }
 
+int32_t GpioCntlrWriteMulti(struct GpioCntlr *cntlr, const uint16_t *locals, const uint16_t *vals, uint16_t count)
+{
+    int32_t ret;
+    uint16_t i;
+
+    if (cntlr == NULL) {
+        return HDF_ERR_INVALID_OBJECT;
+    }
+    if (locals == NULL || vals == NULL) {
+        return HDF_ERR_INVALID_PARAM;
+    }
+    if (cntlr->ops == NULL || (cntlr->ops->writeMulti == NULL && cntlr->ops->write == NULL)) {
+        return HDF_ERR_NOT_SUPPORT;
+    }
+    if (cntlr->ops->writeMulti != NULL) {
+        return cntlr->ops->writeMulti(cntlr, locals, vals, count);
+    }
+    for (i = 0; i < count; i++) {
+        if ((ret = cntlr->ops->write(cntlr, locals[i], vals[i])) != HDF_SUCCESS) {
+            return ret;
+        }
+    }
+    return HDF_SUCCESS;
+}
+
+int32_t GpioCntlrReadMulti(struct GpioCntlr *cntlr, const uint16_t *locals, uint16_t *vals, uint16_t count)
+{
+    int32_t ret;
+    uint16_t i;
+
+    if (cntlr == NULL) {
+        return HDF_ERR_INVALID_OBJECT;
+    }
+    if (locals == NULL || vals == NULL) {
+        return HDF_ERR_INVALID_PARAM;
+    }
+    if (cntlr->ops == NULL || (cntlr->ops->readMulti == NULL && cntlr->ops->read == NULL)) {
+        return HDF_ERR_NOT_SUPPORT;
+    }
+    if (cntlr->ops->readMulti != NULL) {
+        return cntlr->ops->readMulti(cntlr, locals, vals, count);
+    }
+    for (i = 0; i < count; i++) {
+        if ((ret = cntlr->ops->read(cntlr, locals[i], &vals[i])) != HDF_SUCCESS) {
+            return ret;
+        }
+    }
+    return HDF_SUCCESS;
+}
+
 int32_t GpioCntlrSetDir(struct GpioCntlr *cntlr, uint16_t local, uint16_t dir)
 {
     if (cntlr == NULL) {
@@ -123,6 +220,7 @@ static int GpioIrqThreadWorker(void *data)
     (void)OsalSemDestroy(&bridge->sem);
     (void)OsalSpinDestroy(&bridge->spin);
     OsalMemFree(bridge);
+    OsalAtomicDec(&g_gpioIrqPool.bridgeNum);
     PLAT_LOGI("GpioIrqThreadWorker: normal exit!");
     return HDF_SUCCESS;
 }
@@ -174,6 +272,7 @@ static struct GpioIrqBridge *GpioIrqBridgeCreate(struct GpioCntlr *cntlr,
         PLAT_LOGE("GpioIrqBridgeCreate: start irq thread fail:%d", ret);
         goto __ERR_START_THREAD;
     }
+    OsalAtomicInc(&g_gpioIrqPool.bridgeNum);
     return bridge;
 __ERR_START_THREAD:
     (void)OsalThreadDestroy(&bridge->thread);
@@ -198,6 +297,257 @@ static void GpioIrqBridgeDestroy(struct GpioIrqBridge *bridge)
     (void)OsalSpinUnlockIrqRestore(&bridge->spin, &flags);
 }
 
+static void GpioIrqWorkerRun(struct GpioIrqWorker *worker, struct GpioIrqLine *line)
+{
+    uint32_t flags;
+
+    if (line == NULL) {
+        return;
+    }
+    if (line->stop) {
+        /* lines are released by their worker, so a routine in progress never sees a freed line */
+        (void)OsalSpinLockIrqSave(&worker->spin, &flags);
+        worker->lines[line->slot] = NULL;
+        (void)OsalSpinUnlockIrqRestore(&worker->spin, &flags);
+        OsalMemFree(line);
+        OsalAtomicDec(&g_gpioIrqPool.lineNum);
+        return;
+    }
+    PLAT_LOGV("GpioIrqWorkerRun: enter! gpio:%u-%u", line->cntlr->start, line->local);
+    (void)line->func(line->local + line->cntlr->start, line->data);
+}
+
+static int GpioIrqWorkerThread(void *data)
+{
+    uint16_t word;
+    uint16_t bit;
+    struct GpioIrqWorker *worker = (struct GpioIrqWorker *)data;
+
+    while (true) {
+        if (OsalSemWait(&worker->sem, HDF_WAIT_FOREVER) != HDF_SUCCESS) {
+            continue;
+        }
+        if (worker->stop) {
+            break;
+        }
+        for (word = 0; word < GPIO_IRQ_POOL_WORD_NUM; word++) {
+            for (bit = 0; worker->pending[word] != 0 && bit < GPIO_IRQ_POOL_WORD_BITS; bit++) {
+                if (OsalTestClearBit(bit, &worker->pending[word]) != 0) {
+                    GpioIrqWorkerRun(worker, worker->lines[word * GPIO_IRQ_POOL_WORD_BITS + bit]);
+                }
+            }
+        }
+    }
+    (void)OsalSemPost(&g_gpioIrqPool.exited);
+    return HDF_SUCCESS;
+}
+
+static int32_t GpioIrqWorkerStart(struct GpioIrqWorker *worker, uint16_t index, OSAL_THREAD_PRIORITY priority)
+{
+    struct OsalThreadParam cfg;
+
+    if (snprintf_s(worker->name, GPIO_IRQ_THREAD_NAME_LEN, GPIO_IRQ_THREAD_NAME_LEN - 1,
+        "GPIO_IRQ_POOL_%u", index) < 0) {
+        return HDF_FAILURE;
+    }
+    worker->stop = false;
+    if (OsalSpinInit(&worker->spin) != HDF_SUCCESS) {
+        return HDF_FAILURE;
+    }
+    if (OsalSemInit(&worker->sem, 0) != HDF_SUCCESS) {
+        (void)OsalSpinDestroy(&worker->spin);
+        return HDF_FAILURE;
+    }
+    if (OsalThreadCreate(&worker->thread, (OsalThreadEntry)GpioIrqWorkerThread, (void *)worker) != HDF_SUCCESS) {
+        (void)OsalSemDestroy(&worker->sem);
+        (void)OsalSpinDestroy(&worker->spin);
+        return HDF_FAILURE;
+    }
+    cfg.name = worker->name;
+    cfg.priority = priority;
+    cfg.stackSize = GPIO_IRQ_STACK_SIZE;
+    if (OsalThreadStart(&worker->thread, &cfg) != HDF_SUCCESS) {
+        (void)OsalThreadDestroy(&worker->thread);
+        (void)OsalSemDestroy(&worker->sem);
+        (void)OsalSpinDestroy(&worker->spin);
+        return HDF_FAILURE;
+    }
+    return HDF_SUCCESS;
+}
+
+/* no line has been given to the worker yet, only the pool start failure path stops one */
+static void GpioIrqWorkerStop(struct GpioIrqWorker *worker)
+{
+    worker->stop = true;
+    (void)OsalSemPost(&worker->sem);
+    (void)OsalSemWait(&g_gpioIrqPool.exited, HDF_WAIT_FOREVER);
+    (void)OsalThreadDestroy(&worker->thread);
+    (void)OsalSemDestroy(&worker->sem);
+    (void)OsalSpinDestroy(&worker->spin);
+}
+
+static void GpioIrqPoolLock(void)
+{
+    PlatformGlobalLock();
+    if (!g_gpioIrqPool.lockReady) {
+        (void)OsalSpinInit(&g_gpioIrqPool.lock);
+        g_gpioIrqPool.lockReady = true;
+    }
+    PlatformGlobalUnlock();
+    (void)OsalSpinLock(&g_gpioIrqPool.lock);
+}
+
+static void GpioIrqPoolUnlock(void)
+{
+    (void)OsalSpinUnlock(&g_gpioIrqPool.lock);
+}
+
+static bool GpioIrqPoolStarted(void)
+{
+    bool started;
+
+    GpioIrqPoolLock();
+    started = g_gpioIrqPool.started;
+    GpioIrqPoolUnlock();
+    return started;
+}
+
+static int32_t GpioIrqPoolStartWorkers(void)
+{
+    uint16_t i;
+    OSAL_THREAD_PRIORITY priority;
+
+    if (OsalSemInit(&g_gpioIrqPool.exited, 0) != HDF_SUCCESS) {
+        return HDF_FAILURE;
+    }
+    for (i = 0; i < GPIO_IRQ_POOL_WORKER_NUM; i++) {
+        priority = (i < GPIO_IRQ_POOL_NORMAL_NUM) ? OSAL_THREAD_PRI_HIGH : OSAL_THREAD_PRI_HIGHEST;
+        if (GpioIrqWorkerStart(&g_gpioIrqPool.workers[i], i, priority) != HDF_SUCCESS) {
+            PLAT_LOGE("GpioIrqPoolStart: start worker %u fail!", i);
+            break;
+        }
+    }
+    if (i == GPIO_IRQ_POOL_WORKER_NUM) {
+        return HDF_SUCCESS;
+    }
+    /* the next controller added tries again from scratch */
+    while (i > 0) {
+        GpioIrqWorkerStop(&g_gpioIrqPool.workers[--i]);
+    }
+    (void)OsalSemDestroy(&g_gpioIrqPool.exited);
+    return HDF_FAILURE;
+}
+
+/*
+ * Start the dispatch pool, called when a controller is added. Without it, threaded irqs
+ * fall back to a thread per line.
+ */
+int32_t GpioIrqPoolStart(void)
+{
+    int32_t ret;
+
+    GpioIrqPoolLock();
+    if (g_gpioIrqPool.started || g_gpioIrqPool.starting) {
+        GpioIrqPoolUnlock();
+        return HDF_SUCCESS;
+    }
+    g_gpioIrqPool.starting = true;
+    GpioIrqPoolUnlock();
+
+    ret = GpioIrqPoolStartWorkers();
+
+    GpioIrqPoolLock();
+    g_gpioIrqPool.started = (ret == HDF_SUCCESS);
+    g_gpioIrqPool.starting = false;
+    GpioIrqPoolUnlock();
+    return ret;
+}
+
+static int32_t GpioIrqLineFunc(uint16_t local, void *data)
+{
+    struct GpioIrqLine *line = (struct GpioIrqLine *)data;
+    struct GpioIrqWorker *worker = line->worker;
+
+    (void)local;
+    /* an irq coming while the line is already pending is merged into it */
+    if (OsalTestSetBit(line->slot % GPIO_IRQ_POOL_WORD_BITS, &worker->pending[line->slot / GPIO_IRQ_POOL_WORD_BITS])
+        == 0) {
+        (void)OsalSemPost(&worker->sem);
+    }
+    return HDF_SUCCESS;
+}
+
+static struct GpioIrqLine *GpioIrqLineCreate(struct GpioCntlr *cntlr, uint16_t local, uint16_t mode,
+    GpioIrqFunc func, void *arg)
+{
+    uint32_t flags;
+    uint16_t slot;
+    struct GpioIrqLine *line = NULL;
+    struct GpioIrqWorker *worker = NULL;
+
+    if (!GpioIrqPoolStarted()) {
+        return NULL;
+    }
+    if ((mode & GPIO_IRQ_THREAD_HIGH_PRI) != 0) {
+        worker = &g_gpioIrqPool.workers[GPIO_IRQ_POOL_NORMAL_NUM];
+    } else {
+        worker = &g_gpioIrqPool.workers[(cntlr->start + local) % GPIO_IRQ_POOL_NORMAL_NUM];
+    }
+
+    line = (struct GpioIrqLine *)OsalMemCalloc(sizeof(*line));
+    if (line == NULL) {
+        return NULL;
+    }
+    line->cntlr = cntlr;
+    line->local = local;
+    line->func = func;
+    line->data = arg;
+    line->worker = worker;
+
+    (void)OsalSpinLockIrqSave(&worker->spin, &flags);
+    for (slot = 0; slot < GPIO_IRQ_POOL_SLOT_NUM; slot++) {
+        if (worker->lines[slot] == NULL) {
+            line->slot = slot;
+            worker->lines[slot] = line;
+            break;
+        }
+    }
+    (void)OsalSpinUnlockIrqRestore(&worker->spin, &flags);
+    if (slot >= GPIO_IRQ_POOL_SLOT_NUM) {
+        PLAT_LOGW("GpioIrqLineCreate: %s full, gpio:%u-%u uses its own thread", worker->name, cntlr->start, local);
+        OsalMemFree(line);
+        return NULL;
+    }
+    OsalAtomicInc(&g_gpioIrqPool.lineNum);
+    return line;
+}
+
+static void GpioIrqLineDestroy(struct GpioIrqLine *line)
+{
+    /* the worker frees it once a routine still running or pending is done */
+    line->stop = true;
+    (void)GpioIrqLineFunc(line->local, line);
+}
+
+void GpioIrqGetFootprint(struct GpioIrqFootprint *footprint)
+{
+    uint32_t lineNum;
+    uint32_t bridgeNum;
+
+    if (footprint == NULL) {
+        return;
+    }
+    lineNum = (uint32_t)OsalAtomicRead(&g_gpioIrqPool.lineNum);
+    bridgeNum = (uint32_t)OsalAtomicRead(&g_gpioIrqPool.bridgeNum);
+    footprint->threads = bridgeNum;
+    footprint->bytes = bridgeNum * (sizeof(struct GpioIrqBridge) + GPIO_IRQ_STACK_SIZE) +
+        lineNum * sizeof(struct GpioIrqLine);
+    if (GpioIrqPoolStarted()) {
+        footprint->threads += GPIO_IRQ_POOL_WORKER_NUM;
+        footprint->bytes += sizeof(g_gpioIrqPool) + GPIO_IRQ_POOL_WORKER_NUM * GPIO_IRQ_STACK_SIZE;
+    }
+}
+
 void GpioCntlrIrqCallback(struct GpioCntlr *cntlr, uint16_t local)
 {
     struct GpioInfo *ginfo = NULL;
@@ -221,6 +571,7 @@ int32_t GpioCntlrSetIrq(struct GpioCntlr *cntlr, uint16_t local, uint16_t mode,
     GpioIrqFunc theFunc = func;
     void *theData = arg;
     struct GpioIrqBridge *bridge = NULL;
+    struct GpioIrqLine *line = NULL;
     void *oldFunc = NULL;
     void *oldData = NULL;
 
@@ -234,7 +585,14 @@ int32_t GpioCntlrSetIrq(struct GpioCntlr *cntlr, uint16_t local, uint16_t mode,
         return HDF_ERR_NOT_SUPPORT;
     }
 
-    if ((mode & GPIO_IRQ_USING_THREAD) != 0) {
+    if ((mode & GPIO_IRQ_USING_THREAD) != 0 && (mode & GPIO_IRQ_THREAD_DEDICATED) == 0) {
+        line = GpioIrqLineCreate(cntlr, local, mode, func, arg);
+        if (line != NULL) {
+            theData = line;
+            theFunc = GpioIrqLineFunc;
+        }
+    }
+    if ((mode & GPIO_IRQ_USING_THREAD) != 0 && line == NULL) {
         bridge = GpioIrqBridgeCreate(cntlr, local, func, arg);
         if (bridge != NULL) {
             theData = bridge;
@@ -254,6 +612,8 @@ int32_t GpioCntlrSetIrq(struct GpioCntlr *cntlr, uint16_t local, uint16_t mode,
     if (ret == HDF_SUCCESS) {
         if (oldFunc == GpioIrqBridgeFunc) {
             GpioIrqBridgeDestroy((struct GpioIrqBridge *)oldData);
+        } else if (oldFunc == GpioIrqLineFunc) {
+            GpioIrqLineDestroy((struct GpioIrqLine *)oldData);
         }
     } else {
         cntlr->ginfos[local].irqFunc = oldFunc;
@@ -262,6 +622,10 @@ int32_t GpioCntlrSetIrq(struct GpioCntlr *cntlr, uint16_t local, uint16_t mode,
             GpioIrqBridgeDestroy(bridge);
             bridge = NULL;
         }
+        if (line != NULL) {
+            GpioIrqLineDestroy(line);
+            line = NULL;
+        }
     }
     (void)OsalSpinUnlockIrqRestore(&cntlr->device.spin, &flags);
     return ret;
@@ -289,6 +653,8 @@ int32_t GpioCntlrUnsetIrq(struct GpioCntlr *cntlr, uint16_t local)
         if (cntlr->ginfos[local].irqFunc == GpioIrqBridgeFunc) {
             bridge = (struct GpioIrqBridge *)cntlr->ginfos[local].irqData;
             GpioIrqBridgeDestroy(bridge);
+        } else if (cntlr->ginfos[local].irqFunc == GpioIrqLineFunc) {
+            GpioIrqLineDestroy((struct GpioIrqLine *)cntlr->ginfos[local].irqData);
         }
         cntlr->ginfos[local].irqFunc = NULL;
         cntlr->ginfos[local].irqData = NULL;
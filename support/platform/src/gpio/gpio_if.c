@@ -12,6 +12,7 @@
 #include "gpio/gpio_service.h"
 #include "hdf_io_service_if.h"
 #include "platform_core.h"
+#include "securec.h"
 #else
 #include "devsvc_manager_clnt.h"
 #include "gpio/gpio_core.h"
@@ -21,6 +22,8 @@
 
 #define PLAT_LOG_TAG gpio_if
 
+#define GPIO_MULTI_CHUNK 32
+
 #ifdef __USER__
 
 static void *GpioManagerServiceGet(void)
@@ -126,6 +129,73 @@ int32_t GpioWrite(uint16_t gpio, uint16_t val)
     return HDF_SUCCESS;
 }
 
+static int32_t GpioMultiDispatch(int cmd, const uint16_t *gpios, const uint16_t *vals, uint16_t *valsRead,
+    uint16_t count)
+{
+    int32_t ret;
+    const void *buf = NULL;
+    uint32_t len;
+    uint32_t size = (uint32_t)count * sizeof(uint16_t);
+    struct HdfIoService *service = NULL;
+    struct HdfSBuf *data = NULL;
+    struct HdfSBuf *reply = NULL;
+
+    service = (struct HdfIoService *)GpioManagerServiceGet();
+    if (service == NULL) {
+        return HDF_PLT_ERR_DEV_GET;
+    }
+
+    /* gpios and values, each as a buffer with its length */
+    data = HdfSBufObtain((size + sizeof(uint64_t)) * 2);
+    if (data == NULL) {
+        return HDF_ERR_MALLOC_FAIL;
+    }
+    if (!HdfSbufWriteBuffer(data, gpios, size) || (vals != NULL && !HdfSbufWriteBuffer(data, vals, size))) {
+        PLAT_LOGE("%s: write gpios failed!", __func__);
+        HdfSBufRecycle(data);
+        return HDF_ERR_IO;
+    }
+    if (valsRead != NULL) {
+        reply = HdfSBufObtain(size + sizeof(uint64_t));
+        if (reply == NULL) {
+            HdfSBufRecycle(data);
+            return HDF_ERR_MALLOC_FAIL;
+        }
+    }
+
+    ret = service->dispatcher->Dispatch(&service->object, cmd, data, reply);
+    if (ret != HDF_SUCCESS) {
+        PLAT_LOGE("%s: service call failed:%d", __func__, ret);
+    } else if (valsRead != NULL) {
+        if (!HdfSbufReadBuffer(reply, &buf, &len) || len != size || memcpy_s(valsRead, size, buf, len) != EOK) {
+            PLAT_LOGE("%s: read values failed", __func__);
+            ret = HDF_ERR_IO;
+        }
+    }
+
+    HdfSBufRecycle(data);
+    if (reply != NULL) {
+        HdfSBufRecycle(reply);
+    }
+    return ret;
+}
+
+int32_t GpioWriteMulti(const uint16_t *gpios, const uint16_t *vals, uint16_t count)
+{
+    if (gpios == NULL || vals == NULL) {
+        return HDF_ERR_INVALID_PARAM;
+    }
+    return GpioMultiDispatch(GPIO_IO_WRITE_MULTI, gpios, vals, NULL, count);
+}
+
+int32_t GpioReadMulti(const uint16_t *gpios, uint16_t *vals, uint16_t count)
+{
+    if (gpios == NULL || vals == NULL) {
+        return HDF_ERR_INVALID_PARAM;
+    }
+    return GpioMultiDispatch(GPIO_IO_READ_MULTI, gpios, NULL, vals, count);
+}
+
 int32_t GpioGetDir(uint16_t gpio, uint16_t *dir)
 {
     int32_t ret;
@@ -243,43 +313,154 @@ int32_t GpioDisableIrq(uint16_t gpio)
 }
 
 #else
+/* resolve the controller once per call, GpioToLocal would look it up again */
 int32_t GpioRead(uint16_t gpio, uint16_t *val)
 {
-    return GpioCntlrRead(GpioGetCntlr(gpio), GpioToLocal(gpio), val);
+    int32_t ret;
+    struct GpioCntlr *cntlr = GpioGetCntlr(gpio);
+
+    ret = GpioCntlrRead(cntlr, GpioGetLocalNumber(cntlr, gpio), val);
+    GpioCntlrPut(cntlr);
+    return ret;
 }
 
 int32_t GpioWrite(uint16_t gpio, uint16_t val)
 {
-    return GpioCntlrWrite(GpioGetCntlr(gpio), GpioToLocal(gpio), val);
+    int32_t ret;
+    struct GpioCntlr *cntlr = GpioGetCntlr(gpio);
+
+    ret = GpioCntlrWrite(cntlr, GpioGetLocalNumber(cntlr, gpio), val);
+    GpioCntlrPut(cntlr);
+    return ret;
+}
+
+/*
+ * Collect the local numbers of the pins from gpios[0] on which belong to cntlr,
+ * up to GPIO_MULTI_CHUNK of them, and return how many.
+ */
+static uint16_t GpioMultiCollect(const struct GpioCntlr *cntlr, const uint16_t *gpios, uint16_t count,
+    uint16_t *locals)
+{
+    uint16_t n;
+
+    for (n = 0; n < count && n < GPIO_MULTI_CHUNK; n++) {
+        if (gpios[n] < cntlr->start || gpios[n] >= cntlr->start + cntlr->count) {
+            break;
+        }
+        locals[n] = gpios[n] - cntlr->start;
+    }
+    return n;
+}
+
+int32_t GpioWriteMulti(const uint16_t *gpios, const uint16_t *vals, uint16_t count)
+{
+    int32_t ret;
+    uint16_t i;
+    uint16_t n;
+    uint16_t locals[GPIO_MULTI_CHUNK];
+    struct GpioCntlr *cntlr = NULL;
+
+    if (gpios == NULL || vals == NULL) {
+        return HDF_ERR_INVALID_PARAM;
+    }
+    for (i = 0; i < count; i += n) {
+        cntlr = GpioGetCntlr(gpios[i]);
+        if (cntlr == NULL) {
+            return HDF_ERR_INVALID_OBJECT;
+        }
+        n = GpioMultiCollect(cntlr, &gpios[i], count - i, locals);
+        ret = GpioCntlrWriteMulti(cntlr, locals, &vals[i], n);
+        GpioCntlrPut(cntlr);
+        if (ret != HDF_SUCCESS) {
+            return ret;
+        }
+    }
+    return HDF_SUCCESS;
+}
+
+int32_t GpioReadMulti(const uint16_t *gpios, uint16_t *vals, uint16_t count)
+{
+    int32_t ret;
+    uint16_t i;
+    uint16_t n;
+    uint16_t locals[GPIO_MULTI_CHUNK];
+    struct GpioCntlr *cntlr = NULL;
+
+    if (gpios == NULL || vals == NULL) {
+        return HDF_ERR_INVALID_PARAM;
+    }
+    for (i = 0; i < count; i += n) {
+        cntlr = GpioGetCntlr(gpios[i]);
+        if (cntlr == NULL) {
+            return HDF_ERR_INVALID_OBJECT;
+        }
+        n = GpioMultiCollect(cntlr, &gpios[i], count - i, locals);
+        ret = GpioCntlrReadMulti(cntlr, locals, &vals[i], n);
+        GpioCntlrPut(cntlr);
+        if (ret != HDF_SUCCESS) {
+            return ret;
+        }
+    }
+    return HDF_SUCCESS;
 }
 
 int32_t GpioSetDir(uint16_t gpio, uint16_t dir)
 {
-    return GpioCntlrSetDir(GpioGetCntlr(gpio), GpioToLocal(gpio), dir);
+    int32_t ret;
+    struct GpioCntlr *cntlr = GpioGetCntlr(gpio);
+
+    ret = GpioCntlrSetDir(cntlr, GpioGetLocalNumber(cntlr, gpio), dir);
+    GpioCntlrPut(cntlr);
+    return ret;
 }
 
 int32_t GpioGetDir(uint16_t gpio, uint16_t *dir)
 {
-    return GpioCntlrGetDir(GpioGetCntlr(gpio), GpioToLocal(gpio), dir);
+    int32_t ret;
+    struct GpioCntlr *cntlr = GpioGetCntlr(gpio);
+
+    ret = GpioCntlrGetDir(cntlr, GpioGetLocalNumber(cntlr, gpio), dir);
+    GpioCntlrPut(cntlr);
+    return ret;
 }
 
 int32_t GpioSetIrq(uint16_t gpio, uint16_t mode, GpioIrqFunc func, void *arg)
 {
-    return GpioCntlrSetIrq(GpioGetCntlr(gpio), GpioToLocal(gpio), mode, func, arg);
+    int32_t ret;
+    struct GpioCntlr *cntlr = GpioGetCntlr(gpio);
+
+    ret = GpioCntlrSetIrq(cntlr, GpioGetLocalNumber(cntlr, gpio), mode, func, arg);
+    GpioCntlrPut(cntlr);
+    return ret;
 }
 
 int32_t GpioUnSetIrq(uint16_t gpio)
 {
-    return GpioCntlrUnsetIrq(GpioGetCntlr(gpio), GpioToLocal(gpio));
+    int32_t ret;
+    struct GpioCntlr *cntlr = GpioGetCntlr(gpio);
+
+    ret = GpioCntlrUnsetIrq(cntlr, GpioGetLocalNumber(cntlr, gpio));
+    GpioCntlrPut(cntlr);
+    return ret;
 }
 
 int32_t GpioEnableIrq(uint16_t gpio)
 {
-    return GpioCntlrEnableIrq(GpioGetCntlr(gpio), GpioToLocal(gpio));
+    int32_t ret;
+    struct GpioCntlr *cntlr = GpioGetCntlr(gpio);
+
+    ret = GpioCntlrEnableIrq(cntlr, GpioGetLocalNumber(cntlr, gpio));
+    GpioCntlrPut(cntlr);
+    return ret;
 }
 
 int32_t GpioDisableIrq(uint16_t gpio)
 {
-    return GpioCntlrDisableIrq(GpioGetCntlr(gpio), GpioToLocal(gpio));
+    int32_t ret;
+    struct GpioCntlr *cntlr = GpioGetCntlr(gpio);
+
+    ret = GpioCntlrDisableIrq(cntlr, GpioGetLocalNumber(cntlr, gpio));
+    GpioCntlrPut(cntlr);
+    return ret;
 }
 #endif
@@ -13,6 +13,84 @@
 #define HDF_LOG_TAG gpio_manager
 
 #define MAX_CNT_PER_CNTLR          1024
+#define GPIO_INDEX_CNTLR_MAX       64
+
+/*
+ * Controllers sorted by start, so a gpio number is resolved by a binary search instead of
+ * walking the device list. Updated with the list, under the manager spin. Controllers added
+ * beyond the capacity are still found by the list walk.
+ */
+struct GpioCntlrIndex {
+    struct GpioCntlr *cntlrs[GPIO_INDEX_CNTLR_MAX];
+    uint16_t num;
+    uint16_t last; /* the entry hit last time, checked first as pins are mostly used in runs */
+};
+
+static struct GpioCntlrIndex g_gpioIndex;
+
+static void GpioCntlrIndexInsert(struct GpioCntlrIndex *index, struct GpioCntlr *cntlr)
+{
+    uint16_t i;
+
+    if (index->num >= GPIO_INDEX_CNTLR_MAX) {
+        PLAT_LOGW("GpioCntlrIndexInsert: index full, gpio:%u-%u are not indexed",
+            cntlr->start, cntlr->start + cntlr->count);
+        return;
+    }
+    for (i = index->num; i > 0 && index->cntlrs[i - 1]->start > cntlr->start; i--) {
+        index->cntlrs[i] = index->cntlrs[i - 1];
+    }
+    index->cntlrs[i] = cntlr;
+    index->num++;
+    index->last = 0;
+}
+
+static void GpioCntlrIndexRemove(struct GpioCntlrIndex *index, struct GpioCntlr *cntlr)
+{
+    uint16_t i;
+    bool found = false;
+
+    for (i = 0; i < index->num; i++) {
+        if (index->cntlrs[i] == cntlr) {
+            found = true;
+        }
+        if (found && i + 1 < index->num) {
+            index->cntlrs[i] = index->cntlrs[i + 1];
+        }
+    }
+    if (found) {
+        index->num--;
+        index->last = 0;
+    }
+}
+
+static inline bool GpioCntlrHas(const struct GpioCntlr *cntlr, uint16_t gpio)
+{
+    return gpio >= cntlr->start && gpio < (cntlr->start + cntlr->count);
+}
+
+static struct GpioCntlr *GpioCntlrIndexFind(struct GpioCntlrIndex *index, uint16_t gpio)
+{
+    uint16_t low = 0;
+    uint16_t high = index->num;
+    uint16_t mid;
+
+    if (index->last < index->num && GpioCntlrHas(index->cntlrs[index->last], gpio)) {
+        return index->cntlrs[index->last];
+    }
+    while (low < high) {
+        mid = low + (high - low) / 2;
+        if (gpio < index->cntlrs[mid]->start) {
+            high = mid;
+        } else if (GpioCntlrHas(index->cntlrs[mid], gpio)) {
+            index->last = mid;
+            return index->cntlrs[mid];
+        } else {
+            low = mid + 1;
+        }
+    }
+    return NULL;
+}
 
 static uint16_t GpioCntlrQueryStart(struct GpioCntlr *cntlr, struct DListHead *list)
 {
@@ -69,6 +147,7 @@ static int32_t GpioManagerAdd(struct PlatformManager *manager, struct PlatformDe
 
     cntlr->start = start;
     DListInsertTail(&device->node, &manager->devices);
+    GpioCntlrIndexInsert(&g_gpioIndex, cntlr);
     PLAT_LOGI("%s: start:%u count:%u", __func__, cntlr->start, cntlr->count);
     return HDF_SUCCESS;
 }
@@ -78,6 +157,7 @@ static int32_t GpioManagerDel(struct PlatformManager *manager, struct PlatformDe
     if (!DListIsEmpty(&device->node)) {
         DListRemove(&device->node);
     }
+    GpioCntlrIndexRemove(&g_gpioIndex, CONTAINER_OF(device, struct GpioCntlr, device));
     return HDF_SUCCESS;
 }
 
@@ -126,6 +206,9 @@ int32_t GpioCntlrAdd(struct GpioCntlr *cntlr)
         return ret;
     }
 
+    if (GpioIrqPoolStart() != HDF_SUCCESS) {
+        PLAT_LOGW("GpioCntlrAdd: irq pool not started, threaded irqs use a thread per line");
+    }
     return HDF_SUCCESS;
 }
 
@@ -148,16 +231,14 @@ static bool GpioCntlrFindMatch(struct PlatformDevice *device, void *data)
     uint16_t gpio = (uint16_t)(uintptr_t)data;
     struct GpioCntlr *cntlr = CONTAINER_OF(device, struct GpioCntlr, device);
 
-    if (gpio >= cntlr->start && gpio < (cntlr->start + cntlr->count)) {
-        return true;
-    }
-    return false;
+    return GpioCntlrHas(cntlr, gpio);
 }
 
 struct GpioCntlr *GpioGetCntlr(uint16_t gpio)
 {
     struct PlatformManager *gpioMgr = NULL;
     struct PlatformDevice *device = NULL;
+    struct GpioCntlr *cntlr = NULL;
 
     gpioMgr = GpioManagerGet();
     if (gpioMgr == NULL) {
@@ -165,6 +246,17 @@ struct GpioCntlr *GpioGetCntlr(uint16_t gpio)
         return NULL;
     }
 
+    /* the reference is taken under the spin, so a controller being removed is not handed out */
+    (void)OsalSpinLock(&gpioMgr->spin);
+    cntlr = GpioCntlrIndexFind(&g_gpioIndex, gpio);
+    if (cntlr != NULL) {
+        (void)PlatformDeviceGet(&cntlr->device);
+    }
+    (void)OsalSpinUnlock(&gpioMgr->spin);
+    if (cntlr != NULL) {
+        return cntlr;
+    }
+
     device = PlatformManagerFindDevice(gpioMgr, (void *)(uintptr_t)gpio, GpioCntlrFindMatch);
     if (device == NULL) {
         PLAT_LOGE("%s: gpio %u not in any controllers!", __func__, gpio);
@@ -172,3 +264,10 @@ struct GpioCntlr *GpioGetCntlr(uint16_t gpio)
     }
     return CONTAINER_OF(device, struct GpioCntlr, device);
 }
+
+void GpioCntlrPut(struct GpioCntlr *cntlr)
+{
+    if (cntlr != NULL) {
+        PlatformDevicePut(&cntlr->device);
+    }
+}
@@ -10,6 +10,7 @@
 #include "gpio/gpio_core.h"
 #include "gpio/gpio_service.h"
 #include "hdf_device_desc.h"
+#include "osal_mem.h"
 #include "platform_core.h"
 
 #define HDF_LOG_TAG gpio_service
@@ -130,6 +131,63 @@ static int32_t GpioServiceIoSetDir(struct HdfSBuf *data, struct HdfSBuf *reply)
     return ret;
 }
 
+static int32_t GpioServiceIoWriteMulti(struct HdfSBuf *data, struct HdfSBuf *reply)
+{
+    const void *gpios = NULL;
+    const void *vals = NULL;
+    uint32_t gpiosLen;
+    uint32_t valsLen;
+
+    (void)reply;
+    if (data == NULL) {
+        return HDF_ERR_INVALID_PARAM;
+    }
+
+    if (!HdfSbufReadBuffer(data, &gpios, &gpiosLen) || !HdfSbufReadBuffer(data, &vals, &valsLen)) {
+        PLAT_LOGE("%s: read gpios or values failed", __func__);
+        return HDF_ERR_IO;
+    }
+    if (gpiosLen != valsLen || gpiosLen / sizeof(uint16_t) > UINT16_MAX) {
+        PLAT_LOGE("%s: invalid lengths:%u %u", __func__, gpiosLen, valsLen);
+        return HDF_ERR_INVALID_PARAM;
+    }
+
+    return GpioWriteMulti((const uint16_t *)gpios, (const uint16_t *)vals, (uint16_t)(gpiosLen / sizeof(uint16_t)));
+}
+
+static int32_t GpioServiceIoReadMulti(struct HdfSBuf *data, struct HdfSBuf *reply)
+{
+    int32_t ret;
+    const void *gpios = NULL;
+    uint16_t *vals = NULL;
+    uint32_t len;
+
+    if (data == NULL || reply == NULL) {
+        return HDF_ERR_INVALID_PARAM;
+    }
+
+    if (!HdfSbufReadBuffer(data, &gpios, &len)) {
+        PLAT_LOGE("%s: read gpios failed", __func__);
+        return HDF_ERR_IO;
+    }
+    if (len == 0 || len / sizeof(uint16_t) > UINT16_MAX) {
+        PLAT_LOGE("%s: invalid length:%u", __func__, len);
+        return HDF_ERR_INVALID_PARAM;
+    }
+
+    vals = (uint16_t *)OsalMemCalloc(len);
+    if (vals == NULL) {
+        return HDF_ERR_MALLOC_FAIL;
+    }
+    ret = GpioReadMulti((const uint16_t *)gpios, vals, (uint16_t)(len / sizeof(uint16_t)));
+    if (ret == HDF_SUCCESS && !HdfSbufWriteBuffer(reply, vals, len)) {
+        PLAT_LOGE("%s: write subf failed", __func__);
+        ret = HDF_ERR_IO;
+    }
+    OsalMemFree(vals);
+    return ret;
+}
+
 static int32_t GpioServiceDispatch(struct HdfDeviceIoClient *client, int cmd,
     struct HdfSBuf *data, struct HdfSBuf *reply)
 {
@@ -144,6 +202,10 @@ static int32_t GpioServiceDispatch(struct HdfDeviceIoClient *client, int cmd,
             return GpioServiceIoGetDir(data, reply);
         case GPIO_IO_SETDIR:
             return GpioServiceIoSetDir(data, reply);
+        case GPIO_IO_WRITE_MULTI:
+            return GpioServiceIoWriteMulti(data, reply);
+        case GPIO_IO_READ_MULTI:
+            return GpioServiceIoReadMulti(data, reply);
         default:
             ret = HDF_ERR_NOT_SUPPORT;
             break;
@@ -6,143 +6,177 @@
  * See the LICENSE file in the root of this repository for complete details.
  */
 
+#include "hdf_dlist.h"
 #include "hdf_log.h"
 #include "hdmi_core.h"
+#include "osal_mem.h"
+#include "osal_sem.h"
+#include "osal_spinlock.h"
+#include "osal_thread.h"
+#include "osal_time.h"
 #include "securec.h"
 
 #define HDF_LOG_TAG hdmi_cec_c
 
+#define HDMI_CEC_OPCODE_NUM 256
+#define HDMI_CEC_TX_STACK_SIZE 0x2000
+#define HDMI_CEC_USEC_PER_SEC 1000000
+#define HDMI_CEC_USEC_PER_MSEC 1000
+
 #define HDMI_CEC_PHY_ADDR_PHASE(addr) \
     ((addr) >> 12), ((addr) >> 8) & 0xf, ((addr) >> 4) & 0xf, (addr) & 0xf
 
 typedef void (*HdmiCecHandleMsgFunc)(struct HdmiCntlr *cntlr, struct HdmiCecMsg *oldMsg, struct HdmiCecMsg *newMsg);
 
-struct HdmiCecHandleMsgFuncMap {
-    uint8_t opcode;
-    HdmiCecHandleMsgFunc func;
-};
-
-struct HdmiCecMsgLenInfo g_cecMsg[] = {
-    { HDMI_CEC_OPCODE_ACTIVE_SOURCE, HDMI_CEC_GET_MSG_LEN(HDMI_CEC_ACTIVE_SOURCE_MSG_PARAM_LEN),
-      HDMI_CEC_MSG_BROADCAST },
-    { HDMI_CEC_OPCODE_IMAGE_VIEW_ON, HDMI_CEC_GET_MSG_LEN(0), HDMI_CEC_MSG_DIRECTED },
-    { HDMI_CEC_OPCODE_TEXT_VIEW_ON, HDMI_CEC_GET_MSG_LEN(0), HDMI_CEC_MSG_DIRECTED },
-    { HDMI_CEC_OPCODE_INACTIVE_SOURCE, HDMI_CEC_GET_MSG_LEN(HDMI_CEC_INACTIVE_SOURCE_MSG_PARAM_LEN),
-      HDMI_CEC_MSG_DIRECTED },
-    { HDMI_CEC_OPCODE_REQUEST_ACTIVE_SOURCE, HDMI_CEC_GET_MSG_LEN(0), HDMI_CEC_MSG_BROADCAST },
-    { HDMI_CEC_OPCODE_ROUTING_CHANGE, HDMI_CEC_GET_MSG_LEN(HDMI_CEC_ROUTING_CHANGE_MSG_PARAM_LEN),
-      HDMI_CEC_MSG_BROADCAST },
-    { HDMI_CEC_OPCODE_ROUTING_INFORMATION, HDMI_CEC_GET_MSG_LEN(HDMI_CEC_ROUTING_INFORMATIO_MSG_PARAM_LEN),
-      HDMI_CEC_MSG_BROADCAST },
-    { HDMI_CEC_OPCODE_SET_STREAM_PATH, HDMI_CEC_GET_MSG_LEN(HDMI_CEC_SET_STREAM_PATH_MSG_PARAM_LEN),
-      HDMI_CEC_MSG_BROADCAST },
-    { HDMI_CEC_OPCODE_STANDBY, HDMI_CEC_GET_MSG_LEN(0), HDMI_CEC_MSG_DIRECTED },
-    { HDMI_CEC_OPCODE_RECORD_OFF, HDMI_CEC_GET_MSG_LEN(0), HDMI_CEC_MSG_DIRECTED },
-    { HDMI_CEC_OPCODE_RECORD_ON, HDMI_CEC_GET_MSG_LEN(HDMI_CEC_RECORD_SOURCE_TYPE_LEN), HDMI_CEC_MSG_DIRECTED },
-    { HDMI_CEC_OPCODE_RECORD_STATUS, HDMI_CEC_GET_MSG_LEN(HDMI_CEC_RECORD_STATUS_MSG_PARAM_LEN),
-      HDMI_CEC_MSG_DIRECTED },
-    { HDMI_CEC_OPCODE_RECORD_TV_SCREEN, HDMI_CEC_GET_MSG_LEN(0), HDMI_CEC_MSG_DIRECTED },
-    { HDMI_CEC_OPCODE_CLEAR_ANALOGUE_TIMER, HDMI_CEC_GET_MSG_LEN(HDMI_CEC_ANALOGUE_TIMER_INFO_LEN),
-      HDMI_CEC_MSG_DIRECTED },
-    { HDMI_CEC_OPCODE_CLEAR_DIGITAL_TIMER, HDMI_CEC_GET_MSG_LEN(HDMI_CEC_DIGITAL_TIMER_INFO_LEN),
-      HDMI_CEC_MSG_DIRECTED },
-    { HDMI_CEC_OPCODE_CLEAR_EXTERNAL_TIMER, HDMI_CEC_GET_MSG_LEN(HDMI_CEC_EXTERNAL_TIMER_INFO_LEN),
-      HDMI_CEC_MSG_DIRECTED },
-    { HDMI_CEC_OPCODE_SET_ANALOGUE_TIMER, HDMI_CEC_GET_MSG_LEN(HDMI_CEC_ANALOGUE_TIMER_INFO_LEN),
-      HDMI_CEC_MSG_DIRECTED },
-    { HDMI_CEC_OPCODE_SET_DIGITAL_TIMER, HDMI_CEC_GET_MSG_LEN(HDMI_CEC_DIGITAL_TIMER_INFO_LEN),
-      HDMI_CEC_MSG_DIRECTED },
-    { HDMI_CEC_OPCODE_SET_EXTERNAL_TIMER, HDMI_CEC_GET_MSG_LEN(HDMI_CEC_EXTERNAL_TIMER_INFO_LEN),
-      HDMI_CEC_MSG_DIRECTED },
-    { HDMI_CEC_OPCODE_SET_TIMER_PROGRAM_TITLE, HDMI_CEC_GET_MSG_LEN(0), HDMI_CEC_MSG_DIRECTED },
-    { HDMI_CEC_OPCODE_TIMER_CLEARED_STATUS, HDMI_CEC_GET_MSG_LEN(HDMI_CEC_TIMER_CLEARED_STATUS_MSG_PARAM_LEN),
-      HDMI_CEC_MSG_DIRECTED },
-    { HDMI_CEC_OPCODE_TIMER_STATUS, HDMI_CEC_GET_MSG_LEN(HDMI_CEC_TIMER_STATUS_DATA_MIN_LEN), HDMI_CEC_MSG_DIRECTED },
-    { HDMI_CEC_OPCODE_CEC_VERSION, HDMI_CEC_GET_MSG_LEN(HDMI_CEC_CEC_VERSION_MSG_PARAM_LEN), HDMI_CEC_MSG_DIRECTED },
-    { HDMI_CEC_OPCODE_GET_CEC_VERSION, HDMI_CEC_GET_MSG_LEN(0), HDMI_CEC_MSG_DIRECTED },
-    { HDMI_CEC_OPCODE_GIVE_PHYSICAL_ADDRESS, HDMI_CEC_GET_MSG_LEN(0), HDMI_CEC_MSG_DIRECTED },
-    { HDMI_CEC_OPCODE_GET_MENU_LANGUAGE, HDMI_CEC_GET_MSG_LEN(0), HDMI_CEC_MSG_DIRECTED },
-    { HDMI_CEC_OPCODE_REPORT_PHYSICAL_ADDRESS, HDMI_CEC_GET_MSG_LEN(HDMI_CEC_REPORT_PHYSICAL_ADDRESS_MSG_PARAM_LEN),
-      HDMI_CEC_MSG_BROADCAST },
-    { HDMI_CEC_OPCODE_SET_MENU_LANGUAGE, HDMI_CEC_GET_MSG_LEN(HDMI_CEC_SET_MENU_LANGUAGE_MSG_PARAM_LEN),
-      HDMI_CEC_MSG_BROADCAST },
-    { HDMI_CEC_OPCODE_REPORT_FEATURES, HDMI_CEC_GET_MSG_LEN(HDMI_CEC_REPORT_FEATURES_MSG_PARAM_MIN_LEN),
-      HDMI_CEC_MSG_BROADCAST },
-    { HDMI_CEC_OPCODE_GIVE_FEATURES, HDMI_CEC_GET_MSG_LEN(0), HDMI_CEC_MSG_DIRECTED },
-    { HDMI_CEC_OPCODE_DECK_CONTROL, HDMI_CEC_GET_MSG_LEN(HDMI_CEC_DECK_CONTROL_MSG_PARAM_LEN), HDMI_CEC_MSG_DIRECTED },
-    { HDMI_CEC_OPCODE_DECK_STATUS, HDMI_CEC_GET_MSG_LEN(HDMI_CEC_DECK_STATUS_MSG_PARAM_LEN), HDMI_CEC_MSG_DIRECTED },
-    { HDMI_CEC_OPCODE_GIVE_DECK_STATUS, HDMI_CEC_GET_MSG_LEN(HDMI_CEC_GIVE_DECK_STATUS_MSG_PARAM_LEN),
-      HDMI_CEC_MSG_DIRECTED },
-    { HDMI_CEC_OPCODE_PLAY, HDMI_CEC_GET_MSG_LEN(HDMI_CEC_PLAY_MSG_PARAM_LEN), HDMI_CEC_MSG_DIRECTED },
-    { HDMI_CEC_OPCODE_GIVE_TUNER_DEVICE_STATUS, HDMI_CEC_GET_MSG_LEN(HDMI_CEC_GIVE_TUNER_DEVICE_STATU_MSG_PARAM_LEN),
-      HDMI_CEC_MSG_DIRECTED },
-    { HDMI_CEC_OPCODE_SELECT_ANALOGUE_SERVICE, HDMI_CEC_GET_MSG_LEN(HDMI_CEC_SELECT_ANALOGUE_SERVICE_MSG_PARAM_LEN),
-      HDMI_CEC_MSG_DIRECTED },
-    { HDMI_CEC_OPCODE_SELECT_DIGITAL_SERVICE, HDMI_CEC_GET_MSG_LEN(HDMI_CEC_SELECT_DIGITAL_SERVICE_MSG_PARAM_LEN),
-      HDMI_CEC_MSG_DIRECTED },
-    { HDMI_CEC_OPCODE_TUNER_DEVICE_STATUS, HDMI_CEC_GET_MSG_LEN(HDMI_CEC_TUNER_DEVICE_STATUS_MSG_ANA_PARAM_LEN),
-      HDMI_CEC_MSG_DIRECTED },
-    { HDMI_CEC_OPCODE_TUNER_STEP_DECREMENT, HDMI_CEC_GET_MSG_LEN(0), HDMI_CEC_MSG_DIRECTED },
-    { HDMI_CEC_OPCODE_TUNER_STEP_INCREMENT, HDMI_CEC_GET_MSG_LEN(0), HDMI_CEC_MSG_DIRECTED },
-    { HDMI_CEC_OPCODE_DEVICE_VENDOR_ID, HDMI_CEC_GET_MSG_LEN(HDMI_CEC_DEVICE_VENDOR_ID_MSG_PARAM_LEN),
-      HDMI_CEC_MSG_DIRECTED },
-    { HDMI_CEC_OPCODE_GIVE_DEVICE_VENDOR_ID, HDMI_CEC_GET_MSG_LEN(0), HDMI_CEC_MSG_DIRECTED },
-    { HDMI_CEC_OPCODE_VENDOR_COMMAND, HDMI_CEC_GET_MSG_LEN(0), HDMI_CEC_MSG_DIRECTED },
-    { HDMI_CEC_OPCODE_VENDOR_COMMAND_WITH_ID, HDMI_CEC_GET_MSG_LEN(HDMI_CEC_VENDOR_ID_LEN), HDMI_CEC_MSG_ALL },
-    { HDMI_CEC_OPCODE_VENDOR_REMOTE_BUTTON_DOWN, HDMI_CEC_GET_MSG_LEN(0), HDMI_CEC_MSG_ALL },
-    { HDMI_CEC_OPCODE_VENDOR_REMOTE_BUTTON_UP, HDMI_CEC_GET_MSG_LEN(0), HDMI_CEC_MSG_ALL },
-    { HDMI_CEC_OPCODE_SET_OSD_STRING, HDMI_CEC_GET_MSG_LEN(HDMI_CEC_DISPLAY_CONTROL_LEN), HDMI_CEC_MSG_DIRECTED },
-    { HDMI_CEC_OPCODE_GIVE_OSD_NAME, HDMI_CEC_GET_MSG_LEN(0), HDMI_CEC_MSG_DIRECTED },
-    { HDMI_CEC_OPCODE_SET_OSD_NAME, HDMI_CEC_GET_MSG_LEN(0), HDMI_CEC_MSG_DIRECTED },
-    { HDMI_CEC_OPCODE_MENU_REQUEST, HDMI_CEC_GET_MSG_LEN(HDMI_CEC_MENU_REQUEST_MSG_PARAM_LEN),
-      HDMI_CEC_MSG_DIRECTED },
-    { HDMI_CEC_OPCODE_MENU_STATUS, HDMI_CEC_GET_MSG_LEN(HDMI_CEC_MENU_STATUS_MSG_PARAM_LEN), HDMI_CEC_MSG_DIRECTED },
-    { HDMI_CEC_OPCODE_USER_CONTROL_PRESSED, HDMI_CEC_GET_MSG_LEN(HDMI_CEC_UI_COMMAND_LEN), HDMI_CEC_MSG_DIRECTED },
-    { HDMI_CEC_OPCODE_USER_CONTROL_RELEASED, HDMI_CEC_GET_MSG_LEN(0), HDMI_CEC_MSG_DIRECTED },
-    { HDMI_CEC_OPCODE_GIVE_DEVICE_POWER_STATUS, HDMI_CEC_GET_MSG_LEN(0), HDMI_CEC_MSG_DIRECTED },
-    { HDMI_CEC_OPCODE_REPORT_POWER_STATUS, HDMI_CEC_GET_MSG_LEN(HDMI_CEC_REPORT_POWER_STATUS_MSG_PARA_LEN),
-      HDMI_CEC_MSG_DIRECTED_OR_BROADCAST_2_0 },
-    { HDMI_CEC_OPCODE_FEATURE_ABORT, HDMI_CEC_GET_MSG_LEN(HDMI_CEC_FEATURE_ABORT_MSG_PARA_LEN),
-      HDMI_CEC_MSG_DIRECTED },
-    { HDMI_CEC_OPCODE_ABORT, HDMI_CEC_GET_MSG_LEN(0), HDMI_CEC_MSG_DIRECTED },
-    { HDMI_CEC_OPCODE_GIVE_AUDIO_STATUS, HDMI_CEC_GET_MSG_LEN(0), HDMI_CEC_MSG_DIRECTED },
-    { HDMI_CEC_OPCODE_GIVE_SYSTEM_AUDIO_MODE_STATUS, HDMI_CEC_GET_MSG_LEN(0), HDMI_CEC_MSG_DIRECTED },
-    { HDMI_CEC_OPCODE_REPORT_AUDIO_STATUS, HDMI_CEC_GET_MSG_LEN(HDMI_CEC_REPORT_AUDIO_STATUSMSG_PARAM_LEN),
-      HDMI_CEC_MSG_DIRECTED },
-    { HDMI_CEC_OPCODE_REPORT_SHORT_AUDIO_DESCRIPTOR, HDMI_CEC_GET_MSG_LEN(0), HDMI_CEC_MSG_DIRECTED },
-    { HDMI_CEC_OPCODE_REQUEST_SHORT_AUDIO_DESCRIPTOR, HDMI_CEC_GET_MSG_LEN(0), HDMI_CEC_MSG_DIRECTED },
-    { HDMI_CEC_OPCODE_SET_SYSTEM_AUDIO_MODE, HDMI_CEC_GET_MSG_LEN(HDMI_CEC_SYSTEM_AUDIO_STATUS_LEN),
-      HDMI_CEC_MSG_DIRECTED },
-    { HDMI_CEC_OPCODE_SYSTEM_AUDIO_MODE_REQUEST, HDMI_CEC_GET_MSG_LEN(HDMI_CEC_SYSTEM_AUDIO_MODE_REQUEST_PARAM_LEN),
-      HDMI_CEC_MSG_DIRECTED },
-    { HDMI_CEC_OPCODE_SYSTEM_AUDIO_MODE_STATUS, HDMI_CEC_GET_MSG_LEN(HDMI_CEC_SYSTEM_AUDIO_STATUS_LEN),
-      HDMI_CEC_MSG_DIRECTED },
-    { HDMI_CEC_OPCODE_SET_AUDIO_RATE, HDMI_CEC_GET_MSG_LEN(HDMI_CEC_SET_AUDIO_RATE_PARAM_LEN),
-      HDMI_CEC_MSG_DIRECTED },
-    { HDMI_CEC_OPCODE_INITIATE_ARC, HDMI_CEC_GET_MSG_LEN(0), HDMI_CEC_MSG_DIRECTED },
-    { HDMI_CEC_OPCODE_REPORT_ARC_INITIATED, HDMI_CEC_GET_MSG_LEN(0), HDMI_CEC_MSG_DIRECTED },
-    { HDMI_CEC_OPCODE_REPORT_ARC_TERMINATION, HDMI_CEC_GET_MSG_LEN(0), HDMI_CEC_MSG_DIRECTED },
-    { HDMI_CEC_OPCODE_REQUEST_ARC_INITIATION, HDMI_CEC_GET_MSG_LEN(0), HDMI_CEC_MSG_DIRECTED },
-    { HDMI_CEC_OPCODE_REQUEST_ARC_TERMINATION, HDMI_CEC_GET_MSG_LEN(0), HDMI_CEC_MSG_DIRECTED },
-    { HDMI_CEC_OPCODE_TERMINATE_ARC, HDMI_CEC_GET_MSG_LEN(0), HDMI_CEC_MSG_DIRECTED },
-    { HDMI_CEC_OPCODE_CDC_MESSAGE, HDMI_CEC_GET_MSG_LEN(0), HDMI_CEC_MSG_BROADCAST },
-    { HDMI_CEC_OPCODE_REQUEST_CURRENT_LATENCY, HDMI_CEC_GET_MSG_LEN(HDMI_CEC_REQUEST_CURRENT_LATENCY_MSG_LEN),
-      HDMI_CEC_MSG_BROADCAST },
-    { HDMI_CEC_OPCODE_REPORT_CURRENT_LATENCY, HDMI_CEC_GET_MSG_LEN(HDMI_CEC_REPORT_CURRENT_LATENCY_MSG_PARAM_MIN_LEN),
-      HDMI_CEC_MSG_BROADCAST }
+/* indexed by opcode, entries of opcodes that are not listed have a minLen of 0 */
+static const struct HdmiCecMsgLenInfo g_cecMsg[HDMI_CEC_OPCODE_NUM] = {
+    [HDMI_CEC_OPCODE_ACTIVE_SOURCE] = { HDMI_CEC_OPCODE_ACTIVE_SOURCE,
+        HDMI_CEC_GET_MSG_LEN(HDMI_CEC_ACTIVE_SOURCE_MSG_PARAM_LEN), HDMI_CEC_MSG_BROADCAST },
+    [HDMI_CEC_OPCODE_IMAGE_VIEW_ON] = { HDMI_CEC_OPCODE_IMAGE_VIEW_ON, HDMI_CEC_GET_MSG_LEN(0), HDMI_CEC_MSG_DIRECTED },
+    [HDMI_CEC_OPCODE_TEXT_VIEW_ON] = { HDMI_CEC_OPCODE_TEXT_VIEW_ON, HDMI_CEC_GET_MSG_LEN(0), HDMI_CEC_MSG_DIRECTED },
+    [HDMI_CEC_OPCODE_INACTIVE_SOURCE] = { HDMI_CEC_OPCODE_INACTIVE_SOURCE,
+        HDMI_CEC_GET_MSG_LEN(HDMI_CEC_INACTIVE_SOURCE_MSG_PARAM_LEN), HDMI_CEC_MSG_DIRECTED },
+    [HDMI_CEC_OPCODE_REQUEST_ACTIVE_SOURCE] = { HDMI_CEC_OPCODE_REQUEST_ACTIVE_SOURCE,
+        HDMI_CEC_GET_MSG_LEN(0), HDMI_CEC_MSG_BROADCAST },
+    [HDMI_CEC_OPCODE_ROUTING_CHANGE] = { HDMI_CEC_OPCODE_ROUTING_CHANGE,
+        HDMI_CEC_GET_MSG_LEN(HDMI_CEC_ROUTING_CHANGE_MSG_PARAM_LEN), HDMI_CEC_MSG_BROADCAST },
+    [HDMI_CEC_OPCODE_ROUTING_INFORMATION] = { HDMI_CEC_OPCODE_ROUTING_INFORMATION,
+        HDMI_CEC_GET_MSG_LEN(HDMI_CEC_ROUTING_INFORMATIO_MSG_PARAM_LEN), HDMI_CEC_MSG_BROADCAST },
+    [HDMI_CEC_OPCODE_SET_STREAM_PATH] = { HDMI_CEC_OPCODE_SET_STREAM_PATH,
+        HDMI_CEC_GET_MSG_LEN(HDMI_CEC_SET_STREAM_PATH_MSG_PARAM_LEN), HDMI_CEC_MSG_BROADCAST },
+    [HDMI_CEC_OPCODE_STANDBY] = { HDMI_CEC_OPCODE_STANDBY, HDMI_CEC_GET_MSG_LEN(0), HDMI_CEC_MSG_DIRECTED },
+    [HDMI_CEC_OPCODE_RECORD_OFF] = { HDMI_CEC_OPCODE_RECORD_OFF, HDMI_CEC_GET_MSG_LEN(0), HDMI_CEC_MSG_DIRECTED },
+    [HDMI_CEC_OPCODE_RECORD_ON] = { HDMI_CEC_OPCODE_RECORD_ON,
+        HDMI_CEC_GET_MSG_LEN(HDMI_CEC_RECORD_SOURCE_TYPE_LEN), HDMI_CEC_MSG_DIRECTED },
+    [HDMI_CEC_OPCODE_RECORD_STATUS] = { HDMI_CEC_OPCODE_RECORD_STATUS,
+        HDMI_CEC_GET_MSG_LEN(HDMI_CEC_RECORD_STATUS_MSG_PARAM_LEN), HDMI_CEC_MSG_DIRECTED },
+    [HDMI_CEC_OPCODE_RECORD_TV_SCREEN] = { HDMI_CEC_OPCODE_RECORD_TV_SCREEN,
+        HDMI_CEC_GET_MSG_LEN(0), HDMI_CEC_MSG_DIRECTED },
+    [HDMI_CEC_OPCODE_CLEAR_ANALOGUE_TIMER] = { HDMI_CEC_OPCODE_CLEAR_ANALOGUE_TIMER,
+        HDMI_CEC_GET_MSG_LEN(HDMI_CEC_ANALOGUE_TIMER_INFO_LEN), HDMI_CEC_MSG_DIRECTED },
+    [HDMI_CEC_OPCODE_CLEAR_DIGITAL_TIMER] = { HDMI_CEC_OPCODE_CLEAR_DIGITAL_TIMER,
+        HDMI_CEC_GET_MSG_LEN(HDMI_CEC_DIGITAL_TIMER_INFO_LEN), HDMI_CEC_MSG_DIRECTED },
+    [HDMI_CEC_OPCODE_CLEAR_EXTERNAL_TIMER] = { HDMI_CEC_OPCODE_CLEAR_EXTERNAL_TIMER,
+        HDMI_CEC_GET_MSG_LEN(HDMI_CEC_EXTERNAL_TIMER_INFO_LEN), HDMI_CEC_MSG_DIRECTED },
+    [HDMI_CEC_OPCODE_SET_ANALOGUE_TIMER] = { HDMI_CEC_OPCODE_SET_ANALOGUE_TIMER,
+        HDMI_CEC_GET_MSG_LEN(HDMI_CEC_ANALOGUE_TIMER_INFO_LEN), HDMI_CEC_MSG_DIRECTED },
+    [HDMI_CEC_OPCODE_SET_DIGITAL_TIMER] = { HDMI_CEC_OPCODE_SET_DIGITAL_TIMER,
+        HDMI_CEC_GET_MSG_LEN(HDMI_CEC_DIGITAL_TIMER_INFO_LEN), HDMI_CEC_MSG_DIRECTED },
+    [HDMI_CEC_OPCODE_SET_EXTERNAL_TIMER] = { HDMI_CEC_OPCODE_SET_EXTERNAL_TIMER,
+        HDMI_CEC_GET_MSG_LEN(HDMI_CEC_EXTERNAL_TIMER_INFO_LEN), HDMI_CEC_MSG_DIRECTED },
+    [HDMI_CEC_OPCODE_SET_TIMER_PROGRAM_TITLE] = { HDMI_CEC_OPCODE_SET_TIMER_PROGRAM_TITLE,
+        HDMI_CEC_GET_MSG_LEN(0), HDMI_CEC_MSG_DIRECTED },
+    [HDMI_CEC_OPCODE_TIMER_CLEARED_STATUS] = { HDMI_CEC_OPCODE_TIMER_CLEARED_STATUS,
+        HDMI_CEC_GET_MSG_LEN(HDMI_CEC_TIMER_CLEARED_STATUS_MSG_PARAM_LEN), HDMI_CEC_MSG_DIRECTED },
+    [HDMI_CEC_OPCODE_TIMER_STATUS] = { HDMI_CEC_OPCODE_TIMER_STATUS,
+        HDMI_CEC_GET_MSG_LEN(HDMI_CEC_TIMER_STATUS_DATA_MIN_LEN), HDMI_CEC_MSG_DIRECTED },
+    [HDMI_CEC_OPCODE_CEC_VERSION] = { HDMI_CEC_OPCODE_CEC_VERSION,
+        HDMI_CEC_GET_MSG_LEN(HDMI_CEC_CEC_VERSION_MSG_PARAM_LEN), HDMI_CEC_MSG_DIRECTED },
+    [HDMI_CEC_OPCODE_GET_CEC_VERSION] = { HDMI_CEC_OPCODE_GET_CEC_VERSION,
+        HDMI_CEC_GET_MSG_LEN(0), HDMI_CEC_MSG_DIRECTED },
+    [HDMI_CEC_OPCODE_GIVE_PHYSICAL_ADDRESS] = { HDMI_CEC_OPCODE_GIVE_PHYSICAL_ADDRESS,
+        HDMI_CEC_GET_MSG_LEN(0), HDMI_CEC_MSG_DIRECTED },
+    [HDMI_CEC_OPCODE_GET_MENU_LANGUAGE] = { HDMI_CEC_OPCODE_GET_MENU_LANGUAGE,
+        HDMI_CEC_GET_MSG_LEN(0), HDMI_CEC_MSG_DIRECTED },
+    [HDMI_CEC_OPCODE_REPORT_PHYSICAL_ADDRESS] = { HDMI_CEC_OPCODE_REPORT_PHYSICAL_ADDRESS,
+        HDMI_CEC_GET_MSG_LEN(HDMI_CEC_REPORT_PHYSICAL_ADDRESS_MSG_PARAM_LEN), HDMI_CEC_MSG_BROADCAST },
+    [HDMI_CEC_OPCODE_SET_MENU_LANGUAGE] = { HDMI_CEC_OPCODE_SET_MENU_LANGUAGE,
+        HDMI_CEC_GET_MSG_LEN(HDMI_CEC_SET_MENU_LANGUAGE_MSG_PARAM_LEN), HDMI_CEC_MSG_BROADCAST },
+    [HDMI_CEC_OPCODE_REPORT_FEATURES] = { HDMI_CEC_OPCODE_REPORT_FEATURES,
+        HDMI_CEC_GET_MSG_LEN(HDMI_CEC_REPORT_FEATURES_MSG_PARAM_MIN_LEN), HDMI_CEC_MSG_BROADCAST },
+    [HDMI_CEC_OPCODE_GIVE_FEATURES] = { HDMI_CEC_OPCODE_GIVE_FEATURES, HDMI_CEC_GET_MSG_LEN(0), HDMI_CEC_MSG_DIRECTED },
+    [HDMI_CEC_OPCODE_DECK_CONTROL] = { HDMI_CEC_OPCODE_DECK_CONTROL,
+        HDMI_CEC_GET_MSG_LEN(HDMI_CEC_DECK_CONTROL_MSG_PARAM_LEN), HDMI_CEC_MSG_DIRECTED },
+    [HDMI_CEC_OPCODE_DECK_STATUS] = { HDMI_CEC_OPCODE_DECK_STATUS,
+        HDMI_CEC_GET_MSG_LEN(HDMI_CEC_DECK_STATUS_MSG_PARAM_LEN), HDMI_CEC_MSG_DIRECTED },
+    [HDMI_CEC_OPCODE_GIVE_DECK_STATUS] = { HDMI_CEC_OPCODE_GIVE_DECK_STATUS,
+        HDMI_CEC_GET_MSG_LEN(HDMI_CEC_GIVE_DECK_STATUS_MSG_PARAM_LEN), HDMI_CEC_MSG_DIRECTED },
+    [HDMI_CEC_OPCODE_PLAY] = { HDMI_CEC_OPCODE_PLAY,
+        HDMI_CEC_GET_MSG_LEN(HDMI_CEC_PLAY_MSG_PARAM_LEN), HDMI_CEC_MSG_DIRECTED },
+    [HDMI_CEC_OPCODE_GIVE_TUNER_DEVICE_STATUS] = { HDMI_CEC_OPCODE_GIVE_TUNER_DEVICE_STATUS,
+        HDMI_CEC_GET_MSG_LEN(HDMI_CEC_GIVE_TUNER_DEVICE_STATU_MSG_PARAM_LEN), HDMI_CEC_MSG_DIRECTED },
+    [HDMI_CEC_OPCODE_SELECT_ANALOGUE_SERVICE] = { HDMI_CEC_OPCODE_SELECT_ANALOGUE_SERVICE,
+        HDMI_CEC_GET_MSG_LEN(HDMI_CEC_SELECT_ANALOGUE_SERVICE_MSG_PARAM_LEN), HDMI_CEC_MSG_DIRECTED },
+    [HDMI_CEC_OPCODE_SELECT_DIGITAL_SERVICE] = { HDMI_CEC_OPCODE_SELECT_DIGITAL_SERVICE,
+        HDMI_CEC_GET_MSG_LEN(HDMI_CEC_SELECT_DIGITAL_SERVICE_MSG_PARAM_LEN), HDMI_CEC_MSG_DIRECTED },
+    [HDMI_CEC_OPCODE_TUNER_DEVICE_STATUS] = { HDMI_CEC_OPCODE_TUNER_DEVICE_STATUS,
+        HDMI_CEC_GET_MSG_LEN(HDMI_CEC_TUNER_DEVICE_STATUS_MSG_ANA_PARAM_LEN), HDMI_CEC_MSG_DIRECTED },
+    [HDMI_CEC_OPCODE_TUNER_STEP_DECREMENT] = { HDMI_CEC_OPCODE_TUNER_STEP_DECREMENT,
+        HDMI_CEC_GET_MSG_LEN(0), HDMI_CEC_MSG_DIRECTED },
+    [HDMI_CEC_OPCODE_TUNER_STEP_INCREMENT] = { HDMI_CEC_OPCODE_TUNER_STEP_INCREMENT,
+        HDMI_CEC_GET_MSG_LEN(0), HDMI_CEC_MSG_DIRECTED },
+    [HDMI_CEC_OPCODE_DEVICE_VENDOR_ID] = { HDMI_CEC_OPCODE_DEVICE_VENDOR_ID,
+        HDMI_CEC_GET_MSG_LEN(HDMI_CEC_DEVICE_VENDOR_ID_MSG_PARAM_LEN), HDMI_CEC_MSG_DIRECTED },
+    [HDMI_CEC_OPCODE_GIVE_DEVICE_VENDOR_ID] = { HDMI_CEC_OPCODE_GIVE_DEVICE_VENDOR_ID,
+        HDMI_CEC_GET_MSG_LEN(0), HDMI_CEC_MSG_DIRECTED },
+    [HDMI_CEC_OPCODE_VENDOR_COMMAND] = { HDMI_CEC_OPCODE_VENDOR_COMMAND,
+        HDMI_CEC_GET_MSG_LEN(0), HDMI_CEC_MSG_DIRECTED },
+    [HDMI_CEC_OPCODE_VENDOR_COMMAND_WITH_ID] = { HDMI_CEC_OPCODE_VENDOR_COMMAND_WITH_ID,
+        HDMI_CEC_GET_MSG_LEN(HDMI_CEC_VENDOR_ID_LEN), HDMI_CEC_MSG_ALL },
+    [HDMI_CEC_OPCODE_VENDOR_REMOTE_BUTTON_DOWN] = { HDMI_CEC_OPCODE_VENDOR_REMOTE_BUTTON_DOWN,
+        HDMI_CEC_GET_MSG_LEN(0), HDMI_CEC_MSG_ALL },
+    [HDMI_CEC_OPCODE_VENDOR_REMOTE_BUTTON_UP] = { HDMI_CEC_OPCODE_VENDOR_REMOTE_BUTTON_UP,
+        HDMI_CEC_GET_MSG_LEN(0), HDMI_CEC_MSG_ALL },
+    [HDMI_CEC_OPCODE_SET_OSD_STRING] = { HDMI_CEC_OPCODE_SET_OSD_STRING,
+        HDMI_CEC_GET_MSG_LEN(HDMI_CEC_DISPLAY_CONTROL_LEN), HDMI_CEC_MSG_DIRECTED },
+    [HDMI_CEC_OPCODE_GIVE_OSD_NAME] = { HDMI_CEC_OPCODE_GIVE_OSD_NAME, HDMI_CEC_GET_MSG_LEN(0), HDMI_CEC_MSG_DIRECTED },
+    [HDMI_CEC_OPCODE_SET_OSD_NAME] = { HDMI_CEC_OPCODE_SET_OSD_NAME, HDMI_CEC_GET_MSG_LEN(0), HDMI_CEC_MSG_DIRECTED },
+    [HDMI_CEC_OPCODE_MENU_REQUEST] = { HDMI_CEC_OPCODE_MENU_REQUEST,
+        HDMI_CEC_GET_MSG_LEN(HDMI_CEC_MENU_REQUEST_MSG_PARAM_LEN), HDMI_CEC_MSG_DIRECTED },
+    [HDMI_CEC_OPCODE_MENU_STATUS] = { HDMI_CEC_OPCODE_MENU_STATUS,
+        HDMI_CEC_GET_MSG_LEN(HDMI_CEC_MENU_STATUS_MSG_PARAM_LEN), HDMI_CEC_MSG_DIRECTED },
+    [HDMI_CEC_OPCODE_USER_CONTROL_PRESSED] = { HDMI_CEC_OPCODE_USER_CONTROL_PRESSED,
+        HDMI_CEC_GET_MSG_LEN(HDMI_CEC_UI_COMMAND_LEN), HDMI_CEC_MSG_DIRECTED },
+    [HDMI_CEC_OPCODE_USER_CONTROL_RELEASED] = { HDMI_CEC_OPCODE_USER_CONTROL_RELEASED,
+        HDMI_CEC_GET_MSG_LEN(0), HDMI_CEC_MSG_DIRECTED },
+    [HDMI_CEC_OPCODE_GIVE_DEVICE_POWER_STATUS] = { HDMI_CEC_OPCODE_GIVE_DEVICE_POWER_STATUS,
+        HDMI_CEC_GET_MSG_LEN(0), HDMI_CEC_MSG_DIRECTED },
+    [HDMI_CEC_OPCODE_REPORT_POWER_STATUS] = { HDMI_CEC_OPCODE_REPORT_POWER_STATUS,
+        HDMI_CEC_GET_MSG_LEN(HDMI_CEC_REPORT_POWER_STATUS_MSG_PARA_LEN), HDMI_CEC_MSG_DIRECTED_OR_BROADCAST_2_0 },
+    [HDMI_CEC_OPCODE_FEATURE_ABORT] = { HDMI_CEC_OPCODE_FEATURE_ABORT,
+        HDMI_CEC_GET_MSG_LEN(HDMI_CEC_FEATURE_ABORT_MSG_PARA_LEN), HDMI_CEC_MSG_DIRECTED },
+    [HDMI_CEC_OPCODE_ABORT] = { HDMI_CEC_OPCODE_ABORT, HDMI_CEC_GET_MSG_LEN(0), HDMI_CEC_MSG_DIRECTED },
+    [HDMI_CEC_OPCODE_GIVE_AUDIO_STATUS] = { HDMI_CEC_OPCODE_GIVE_AUDIO_STATUS,
+        HDMI_CEC_GET_MSG_LEN(0), HDMI_CEC_MSG_DIRECTED },
+    [HDMI_CEC_OPCODE_GIVE_SYSTEM_AUDIO_MODE_STATUS] = { HDMI_CEC_OPCODE_GIVE_SYSTEM_AUDIO_MODE_STATUS,
+        HDMI_CEC_GET_MSG_LEN(0), HDMI_CEC_MSG_DIRECTED },
+    [HDMI_CEC_OPCODE_REPORT_AUDIO_STATUS] = { HDMI_CEC_OPCODE_REPORT_AUDIO_STATUS,
+        HDMI_CEC_GET_MSG_LEN(HDMI_CEC_REPORT_AUDIO_STATUSMSG_PARAM_LEN), HDMI_CEC_MSG_DIRECTED },
+    [HDMI_CEC_OPCODE_REPORT_SHORT_AUDIO_DESCRIPTOR] = { HDMI_CEC_OPCODE_REPORT_SHORT_AUDIO_DESCRIPTOR,
+        HDMI_CEC_GET_MSG_LEN(0), HDMI_CEC_MSG_DIRECTED },
+    [HDMI_CEC_OPCODE_REQUEST_SHORT_AUDIO_DESCRIPTOR] = { HDMI_CEC_OPCODE_REQUEST_SHORT_AUDIO_DESCRIPTOR,
+        HDMI_CEC_GET_MSG_LEN(0), HDMI_CEC_MSG_DIRECTED },
+    [HDMI_CEC_OPCODE_SET_SYSTEM_AUDIO_MODE] = { HDMI_CEC_OPCODE_SET_SYSTEM_AUDIO_MODE,
+        HDMI_CEC_GET_MSG_LEN(HDMI_CEC_SYSTEM_AUDIO_STATUS_LEN), HDMI_CEC_MSG_DIRECTED },
+    [HDMI_CEC_OPCODE_SYSTEM_AUDIO_MODE_REQUEST] = { HDMI_CEC_OPCODE_SYSTEM_AUDIO_MODE_REQUEST,
+        HDMI_CEC_GET_MSG_LEN(HDMI_CEC_SYSTEM_AUDIO_MODE_REQUEST_PARAM_LEN), HDMI_CEC_MSG_DIRECTED },
+    [HDMI_CEC_OPCODE_SYSTEM_AUDIO_MODE_STATUS] = { HDMI_CEC_OPCODE_SYSTEM_AUDIO_MODE_STATUS,
+        HDMI_CEC_GET_MSG_LEN(HDMI_CEC_SYSTEM_AUDIO_STATUS_LEN), HDMI_CEC_MSG_DIRECTED },
+    [HDMI_CEC_OPCODE_SET_AUDIO_RATE] = { HDMI_CEC_OPCODE_SET_AUDIO_RATE,
+        HDMI_CEC_GET_MSG_LEN(HDMI_CEC_SET_AUDIO_RATE_PARAM_LEN), HDMI_CEC_MSG_DIRECTED },
+    [HDMI_CEC_OPCODE_INITIATE_ARC] = { HDMI_CEC_OPCODE_INITIATE_ARC, HDMI_CEC_GET_MSG_LEN(0), HDMI_CEC_MSG_DIRECTED },
+    [HDMI_CEC_OPCODE_REPORT_ARC_INITIATED] = { HDMI_CEC_OPCODE_REPORT_ARC_INITIATED,
+        HDMI_CEC_GET_MSG_LEN(0), HDMI_CEC_MSG_DIRECTED },
+    [HDMI_CEC_OPCODE_REPORT_ARC_TERMINATION] = { HDMI_CEC_OPCODE_REPORT_ARC_TERMINATION,
+        HDMI_CEC_GET_MSG_LEN(0), HDMI_CEC_MSG_DIRECTED },
+    [HDMI_CEC_OPCODE_REQUEST_ARC_INITIATION] = { HDMI_CEC_OPCODE_REQUEST_ARC_INITIATION,
+        HDMI_CEC_GET_MSG_LEN(0), HDMI_CEC_MSG_DIRECTED },
+    [HDMI_CEC_OPCODE_REQUEST_ARC_TERMINATION] = { HDMI_CEC_OPCODE_REQUEST_ARC_TERMINATION,
+        HDMI_CEC_GET_MSG_LEN(0), HDMI_CEC_MSG_DIRECTED },
+    [HDMI_CEC_OPCODE_TERMINATE_ARC] = { HDMI_CEC_OPCODE_TERMINATE_ARC, HDMI_CEC_GET_MSG_LEN(0), HDMI_CEC_MSG_DIRECTED },
+    [HDMI_CEC_OPCODE_CDC_MESSAGE] = { HDMI_CEC_OPCODE_CDC_MESSAGE, HDMI_CEC_GET_MSG_LEN(0), HDMI_CEC_MSG_BROADCAST },
+    [HDMI_CEC_OPCODE_REQUEST_CURRENT_LATENCY] = { HDMI_CEC_OPCODE_REQUEST_CURRENT_LATENCY,
+        HDMI_CEC_GET_MSG_LEN(HDMI_CEC_REQUEST_CURRENT_LATENCY_MSG_LEN), HDMI_CEC_MSG_BROADCAST },
+    [HDMI_CEC_OPCODE_REPORT_CURRENT_LATENCY] = { HDMI_CEC_OPCODE_REPORT_CURRENT_LATENCY,
+        HDMI_CEC_GET_MSG_LEN(HDMI_CEC_REPORT_CURRENT_LATENCY_MSG_PARAM_MIN_LEN), HDMI_CEC_MSG_BROADCAST }
 };
 
-static struct HdmiCecMsgLenInfo *HdmiCecGetMsgLenInfo(uint8_t opcode)
+static const struct HdmiCecMsgLenInfo *HdmiCecGetMsgLenInfo(uint8_t opcode)
 {
-    uint32_t i, len;
-
-    len = sizeof(g_cecMsg) / sizeof(g_cecMsg[0]);
-    for (i = 0; i < len; i++) {
-        if (opcode == g_cecMsg[i].opcode) {
-            return (&g_cecMsg[i]);
-        }
+    if (g_cecMsg[opcode].minLen == 0) {
+        return NULL;
     }
-    return NULL;
+    return &g_cecMsg[opcode];
 }
 
 static bool HdmiCecCheckTimerStatusMsgLen(struct HdmiCecMsg *msg)
@@ -221,7 +255,7 @@ static bool HdmiCecCheckSomeSpecialfMsgLen(struct HdmiCecMsg *msg, uint8_t opcod
 
 static bool HdmiCecCheckMsgLen(struct HdmiCec *cec, struct HdmiCecMsg *msg, uint8_t opcode)
 {
-    struct HdmiCecMsgLenInfo *info = NULL;
+    const struct HdmiCecMsgLenInfo *info = NULL;
 
     info = HdmiCecGetMsgLenInfo(opcode);
     if (info == NULL) {
@@ -1411,6 +1445,337 @@ static int32_t HdmiCecSendMsg(struct HdmiCntlr *cntlr, struct HdmiCecMsg *msg)
     return ret;
 }
 
+struct HdmiCecTxEntry {
+    struct DListHead list;
+    struct HdmiCecMsg msg;
+    uint32_t retries;
+    uint64_t queuedUs;
+    uint64_t dueUs;           /* earliest time of the next attempt */
+};
+
+struct HdmiCecTxQueue {
+    struct HdmiCec *cec;
+    struct HdmiCecTxEntry entries[HDMI_CEC_TX_QUEUE_LEN];
+    struct DListHead free;
+    struct DListHead pending[HDMI_CEC_TX_PRIORITY_BUTT];
+    struct HdmiCecTxStats stats;
+    OsalSpinlock spin;
+    struct OsalSem sem;
+    struct OsalSem exited;
+    struct OsalThread thread;
+    bool stop;
+};
+
+static uint64_t HdmiCecTxNowUs(void)
+{
+    OsalTimespec time = {0, 0};
+
+    (void)OsalGetTime(&time);
+    return (uint64_t)time.sec * HDMI_CEC_USEC_PER_SEC + time.usec;
+}
+
+/*
+ * The first entry due by now, highest priority first. A destination with a failed entry, at any
+ * priority, gets no other entry until that one is done, so a device never sees a later frame
+ * overtake a failed one. Sets *waitUs to the time until the next retry is due when no entry is.
+ */
+static struct HdmiCecTxEntry *HdmiCecTxQueuePeekLocked(struct HdmiCecTxQueue *queue, uint64_t now, uint64_t *waitUs)
+{
+    uint32_t prio;
+    uint16_t retrying = 0;
+    uint16_t dest;
+    struct HdmiCecTxEntry *entry = NULL;
+
+    *waitUs = 0;
+    for (prio = 0; prio < HDMI_CEC_TX_PRIORITY_BUTT; prio++) {
+        DLIST_FOR_EACH_ENTRY(entry, &queue->pending[prio], struct HdmiCecTxEntry, list) {
+            if (entry->retries == 0) {
+                continue;
+            }
+            retrying |= (1 << HdmiCecGetMsgDestination(&entry->msg));
+            if (entry->dueUs > now && (*waitUs == 0 || entry->dueUs - now < *waitUs)) {
+                *waitUs = entry->dueUs - now;
+            }
+        }
+    }
+    for (prio = 0; prio < HDMI_CEC_TX_PRIORITY_BUTT; prio++) {
+        DLIST_FOR_EACH_ENTRY(entry, &queue->pending[prio], struct HdmiCecTxEntry, list) {
+            dest = (1 << HdmiCecGetMsgDestination(&entry->msg));
+            if (entry->dueUs <= now && (entry->retries > 0 || (retrying & dest) == 0)) {
+                return entry;
+            }
+        }
+    }
+    return NULL;
+}
+
+static void HdmiCecTxQueueDoneLocked(struct HdmiCecTxQueue *queue, struct HdmiCecTxEntry *entry,
+    int32_t ret, uint64_t now)
+{
+    uint64_t latencyUs = now - entry->queuedUs;
+
+    if (ret == HDF_SUCCESS) {
+        queue->stats.sent++;
+    } else {
+        queue->stats.failed++;
+    }
+    queue->stats.latencySumUs += latencyUs;
+    if (latencyUs > queue->stats.latencyMaxUs) {
+        queue->stats.latencyMaxUs = (uint32_t)latencyUs;
+    }
+    DListRemove(&entry->list);
+    DListInsertTail(&entry->list, &queue->free);
+}
+
+static int HdmiCecTxQueueWorker(void *data)
+{
+    int32_t ret;
+    uint64_t now;
+    uint64_t waitUs;
+    struct HdmiCecTxQueue *queue = (struct HdmiCecTxQueue *)data;
+    struct HdmiCntlr *cntlr = (struct HdmiCntlr *)queue->cec->priv;
+    struct HdmiCecTxEntry *entry = NULL;
+    struct HdmiCecMsg msg;
+
+    while (!queue->stop) {
+        (void)OsalSpinLockIrq(&queue->spin);
+        entry = HdmiCecTxQueuePeekLocked(queue, HdmiCecTxNowUs(), &waitUs);
+        if (entry != NULL) {
+            msg = entry->msg;
+        }
+        (void)OsalSpinUnlockIrq(&queue->spin);
+        if (entry == NULL) {
+            /* a retry rounds up to the next millisecond, a new message posts the semaphore */
+            (void)OsalSemWait(&queue->sem, (waitUs == 0) ? HDF_WAIT_FOREVER :
+                (uint32_t)((waitUs + HDMI_CEC_USEC_PER_MSEC - 1) / HDMI_CEC_USEC_PER_MSEC));
+            continue;
+        }
+
+        /* the entry stays queued while it is on the bus, only this thread takes entries off */
+        ret = HdmiCecSendMsg(cntlr, &msg);
+        now = HdmiCecTxNowUs();
+        (void)OsalSpinLockIrq(&queue->spin);
+        if (ret != HDF_SUCCESS && entry->retries < HDMI_CEC_TX_RETRY_MAX) {
+            entry->retries++;
+            entry->dueUs = now + HDMI_CEC_TX_RETRY_INTERVAL_US;
+            queue->stats.retries++;
+        } else {
+            HdmiCecTxQueueDoneLocked(queue, entry, ret, now);
+        }
+        (void)OsalSpinUnlockIrq(&queue->spin);
+    }
+    (void)OsalSemPost(&queue->exited);
+    return HDF_SUCCESS;
+}
+
+static bool HdmiCecTxQueueFindLocked(struct HdmiCecTxQueue *queue, const struct HdmiCecMsg *msg)
+{
+    uint32_t prio;
+    struct HdmiCecTxEntry *entry = NULL;
+
+    for (prio = 0; prio < HDMI_CEC_TX_PRIORITY_BUTT; prio++) {
+        DLIST_FOR_EACH_ENTRY(entry, &queue->pending[prio], struct HdmiCecTxEntry, list) {
+            if (entry->msg.len == msg->len && memcmp(entry->msg.data, msg->data, msg->len) == 0) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+/* called with the cec txLock held, which already keeps interrupts off */
+static int32_t HdmiCecTxQueuePutLocked(struct HdmiCecTxQueue *queue, const struct HdmiCecMsg *msg,
+    enum HdmiCecTxPriority priority)
+{
+    struct HdmiCecTxEntry *entry = NULL;
+
+    (void)OsalSpinLock(&queue->spin);
+    if ((msg->len == HDMI_POLLING_MSG_LEN || msg->response == true) && HdmiCecTxQueueFindLocked(queue, msg)) {
+        queue->stats.deduped++;
+        (void)OsalSpinUnlock(&queue->spin);
+        return HDF_SUCCESS;
+    }
+    if (DListIsEmpty(&queue->free)) {
+        queue->stats.dropped++;
+        (void)OsalSpinUnlock(&queue->spin);
+        return HDF_ERR_DEVICE_BUSY;
+    }
+    entry = DLIST_FIRST_ENTRY(&queue->free, struct HdmiCecTxEntry, list);
+    DListRemove(&entry->list);
+    entry->msg = *msg;
+    entry->retries = 0;
+    entry->queuedUs = HdmiCecTxNowUs();
+    entry->dueUs = entry->queuedUs;
+    DListInsertTail(&entry->list, &queue->pending[priority]);
+    (void)OsalSpinUnlock(&queue->spin);
+
+    (void)OsalSemPost(&queue->sem);
+    return HDF_SUCCESS;
+}
+
+int32_t HdmiCecQueueMsg(struct HdmiCec *cec, const struct HdmiCecMsg *msg, enum HdmiCecTxPriority priority)
+{
+    int32_t ret;
+    uint32_t flags = 0;
+
+    if (cec == NULL || msg == NULL || msg->len == 0 || msg->len > HDMI_CEC_MSG_MAX_LEN ||
+        priority >= HDMI_CEC_TX_PRIORITY_BUTT) {
+        HDF_LOGE("cec queue msg, input param invalid.");
+        return HDF_ERR_INVALID_PARAM;
+    }
+
+    /* the queue is used under txLock only, so HdmiCecTxQueueStop can not free it meanwhile */
+    (void)OsalSpinLockIrqSave(&cec->txLock, &flags);
+    if (cec->txQueue == NULL) {
+        (void)OsalSpinUnlockIrqRestore(&cec->txLock, &flags);
+        return HDF_ERR_NOT_SUPPORT;
+    }
+    ret = HdmiCecTxQueuePutLocked(cec->txQueue, msg, priority);
+    (void)OsalSpinUnlockIrqRestore(&cec->txLock, &flags);
+    return ret;
+}
+
+int32_t HdmiCecGetTxStats(struct HdmiCec *cec, struct HdmiCecTxStats *stats)
+{
+    uint32_t flags = 0;
+
+    if (cec == NULL || stats == NULL) {
+        return HDF_ERR_INVALID_PARAM;
+    }
+    (void)OsalSpinLockIrqSave(&cec->txLock, &flags);
+    if (cec->txQueue == NULL) {
+        (void)OsalSpinUnlockIrqRestore(&cec->txLock, &flags);
+        return HDF_ERR_NOT_SUPPORT;
+    }
+    (void)OsalSpinLock(&cec->txQueue->spin);
+    *stats = cec->txQueue->stats;
+    (void)OsalSpinUnlock(&cec->txQueue->spin);
+    (void)OsalSpinUnlockIrqRestore(&cec->txLock, &flags);
+    return HDF_SUCCESS;
+}
+
+static void HdmiCecTxQueueFree(struct HdmiCecTxQueue *queue)
+{
+    (void)OsalSemDestroy(&queue->exited);
+    (void)OsalSemDestroy(&queue->sem);
+    (void)OsalSpinDestroy(&queue->spin);
+    OsalMemFree(queue);
+}
+
+static struct HdmiCecTxQueue *HdmiCecTxQueueCreate(struct HdmiCec *cec)
+{
+    uint32_t i;
+    struct HdmiCecTxQueue *queue = NULL;
+
+    queue = (struct HdmiCecTxQueue *)OsalMemCalloc(sizeof(*queue));
+    if (queue == NULL) {
+        return NULL;
+    }
+    queue->cec = cec;
+    DListHeadInit(&queue->free);
+    for (i = 0; i < HDMI_CEC_TX_PRIORITY_BUTT; i++) {
+        DListHeadInit(&queue->pending[i]);
+    }
+    for (i = 0; i < HDMI_CEC_TX_QUEUE_LEN; i++) {
+        DListInsertTail(&queue->entries[i].list, &queue->free);
+    }
+    if (OsalSpinInit(&queue->spin) != HDF_SUCCESS) {
+        OsalMemFree(queue);
+        return NULL;
+    }
+    if (OsalSemInit(&queue->sem, 0) != HDF_SUCCESS) {
+        (void)OsalSpinDestroy(&queue->spin);
+        OsalMemFree(queue);
+        return NULL;
+    }
+    if (OsalSemInit(&queue->exited, 0) != HDF_SUCCESS) {
+        (void)OsalSemDestroy(&queue->sem);
+        (void)OsalSpinDestroy(&queue->spin);
+        OsalMemFree(queue);
+        return NULL;
+    }
+    return queue;
+}
+
+int32_t HdmiCecTxQueueStart(struct HdmiCec *cec)
+{
+    int32_t ret;
+    uint32_t flags = 0;
+    struct HdmiCecTxQueue *queue = NULL;
+    struct OsalThreadParam param;
+
+    if (cec == NULL || cec->priv == NULL) {
+        return HDF_ERR_INVALID_PARAM;
+    }
+    /* start and stop are called from the controller init and deinit, never at the same time */
+    if (cec->txQueue != NULL) {
+        return HDF_SUCCESS;
+    }
+    queue = HdmiCecTxQueueCreate(cec);
+    if (queue == NULL) {
+        HDF_LOGE("cec tx queue malloc fail.");
+        return HDF_ERR_MALLOC_FAIL;
+    }
+    ret = OsalThreadCreate(&queue->thread, HdmiCecTxQueueWorker, queue);
+    if (ret != HDF_SUCCESS) {
+        HDF_LOGE("cec tx queue create thread fail, ret = %d.", ret);
+        HdmiCecTxQueueFree(queue);
+        return ret;
+    }
+    (void)memset_s(&param, sizeof(param), 0, sizeof(param));
+    param.name = "hdmi_cec_tx";
+    param.priority = OSAL_THREAD_PRI_HIGH;
+    param.stackSize = HDMI_CEC_TX_STACK_SIZE;
+    ret = OsalThreadStart(&queue->thread, &param);
+    if (ret != HDF_SUCCESS) {
+        HDF_LOGE("cec tx queue start thread fail, ret = %d.", ret);
+        (void)OsalThreadDestroy(&queue->thread);
+        HdmiCecTxQueueFree(queue);
+        return ret;
+    }
+    (void)OsalSpinLockIrqSave(&cec->txLock, &flags);
+    cec->txQueue = queue;
+    (void)OsalSpinUnlockIrqRestore(&cec->txLock, &flags);
+    return HDF_SUCCESS;
+}
+
+void HdmiCecTxQueueStop(struct HdmiCec *cec)
+{
+    uint32_t flags = 0;
+    struct HdmiCecTxQueue *queue = NULL;
+
+    if (cec == NULL) {
+        return;
+    }
+    /* once cleared under txLock, no sender can reach the queue any more */
+    (void)OsalSpinLockIrqSave(&cec->txLock, &flags);
+    queue = cec->txQueue;
+    cec->txQueue = NULL;
+    (void)OsalSpinUnlockIrqRestore(&cec->txLock, &flags);
+    if (queue == NULL) {
+        return;
+    }
+    queue->stop = true;
+    (void)OsalSemPost(&queue->sem);
+    (void)OsalSemWait(&queue->exited, HDF_WAIT_FOREVER);
+    (void)OsalThreadDestroy(&queue->thread);
+    HDF_LOGD("cec tx queue stop, sent %u, failed %u, retries %u, deduped %u, dropped %u.",
+        queue->stats.sent, queue->stats.failed, queue->stats.retries, queue->stats.deduped, queue->stats.dropped);
+    HdmiCecTxQueueFree(queue);
+}
+
+/* replies go ahead of the other queued messages, or straight to the bus without a queue */
+static int32_t HdmiCecSendReply(struct HdmiCntlr *cntlr, struct HdmiCecMsg *msg)
+{
+    int32_t ret;
+
+    ret = HdmiCecQueueMsg(cntlr->cec, msg, HDMI_CEC_TX_PRIORITY_HIGH);
+    if (ret == HDF_ERR_NOT_SUPPORT) {
+        return HdmiCecSendMsg(cntlr, msg);
+    }
+    return ret;
+}
+
 static bool HdmiCecMsgIgnore(uint8_t opcode, bool unregistered, bool broadcast)
 {
     switch (opcode) {
@@ -1492,7 +1857,7 @@ static void HdmiCecHandleGetCecVersionMsg(struct HdmiCntlr *cntlr,
     struct HdmiCecMsg *msg, struct HdmiCecMsg *txMsg)
 {
     HdmiCecEncodingCecVersionMsg(txMsg, cntlr->cec->info.cecVersion);
-    if (HdmiCecSendMsg(cntlr, txMsg) != HDF_SUCCESS) {
+    if (HdmiCecSendReply(cntlr, txMsg) != HDF_SUCCESS) {
         HDF_LOGE("get cec version msg send fail");
     }
 }
@@ -1507,7 +1872,7 @@ static void HdmiCecHandleGivePhyAddressMsg(struct HdmiCntlr *cntlr,
     }
 
     HdmiCecEncodingReportPhyAddressMsg(txMsg, cntlr->cec->info.phyAddr, cntlr->cec->info.primaryDeviceType);
-    if (HdmiCecSendMsg(cntlr, txMsg) != HDF_SUCCESS) {
+    if (HdmiCecSendReply(cntlr, txMsg) != HDF_SUCCESS) {
         HDF_LOGE("give phy address msg send fail");
     }
 }
@@ -1519,13 +1884,13 @@ static void HdmiCecHandleGiveDeviceVendorIdMsg(struct HdmiCntlr *cntlr,
         HdmiCecEncodingFeatureAbortMsg(txMsg,
                                        msg->data[HDMI_CEC_MSG_DATA_FIRST_ELEMENT],
                                        HDMI_CEC_ABORT_UNRECOGNIZED_OPCODE);
-        if (HdmiCecSendMsg(cntlr, txMsg) != HDF_SUCCESS) {
+        if (HdmiCecSendReply(cntlr, txMsg) != HDF_SUCCESS) {
             HDF_LOGE("feature abort msg send fail");
         }
         return;
     }
     HdmiCecEncodingDeviceVendorIdMsg(txMsg, cntlr->cec->info.vendorId);
-    if (HdmiCecSendMsg(cntlr, txMsg) != HDF_SUCCESS) {
+    if (HdmiCecSendReply(cntlr, txMsg) != HDF_SUCCESS) {
         HDF_LOGE("give device vendor id msg send fail");
     }
 }
@@ -1538,7 +1903,7 @@ static void HdmiCecHandleAbortMsg(struct HdmiCntlr *cntlr,
         return;
     }
     HdmiCecEncodingFeatureAbortMsg(txMsg, msg->data[HDMI_CEC_MSG_DATA_FIRST_ELEMENT], HDMI_CEC_ABORT_REFUSED);
-    if (HdmiCecSendMsg(cntlr, txMsg) != HDF_SUCCESS) {
+    if (HdmiCecSendReply(cntlr, txMsg) != HDF_SUCCESS) {
         HDF_LOGE("feature abort msg send fail");
     }
 }
@@ -1550,14 +1915,14 @@ static void HdmiCecHandleGiveOsdNameMsg(struct HdmiCntlr *cntlr,
         HdmiCecEncodingFeatureAbortMsg(txMsg,
                                        msg->data[HDMI_CEC_MSG_DATA_FIRST_ELEMENT],
                                        HDMI_CEC_ABORT_UNRECOGNIZED_OPCODE);
-        if (HdmiCecSendMsg(cntlr, txMsg) != HDF_SUCCESS) {
+        if (HdmiCecSendReply(cntlr, txMsg) != HDF_SUCCESS) {
             HDF_LOGE("feature abort msg send fail");
         }
         return;
     }
 
     HdmiCecEncodingSetOsdNameMsg(txMsg, cntlr->cec->info.osdName, cntlr->cec->info.osdNameLen);
-    if (HdmiCecSendMsg(cntlr, txMsg) != HDF_SUCCESS) {
+    if (HdmiCecSendReply(cntlr, txMsg) != HDF_SUCCESS) {
         HDF_LOGE("set osd name msg send fail");
     }
 }
@@ -1569,14 +1934,14 @@ static void HdmiCecHandleGiveFeaturesMsg(struct HdmiCntlr *cntlr,
         HdmiCecEncodingFeatureAbortMsg(txMsg,
                                        msg->data[HDMI_CEC_MSG_DATA_FIRST_ELEMENT],
                                        HDMI_CEC_ABORT_UNRECOGNIZED_OPCODE);
-        if (HdmiCecSendMsg(cntlr, txMsg) != HDF_SUCCESS) {
+        if (HdmiCecSendReply(cntlr, txMsg) != HDF_SUCCESS) {
             HDF_LOGE("feature abort msg send fail");
         }
         return;
     }
 
     HdmiCecEncodingReportFeaturesMsg(txMsg, &(cntlr->cec->info));
-    if (HdmiCecSendMsg(cntlr, txMsg) != HDF_SUCCESS) {
+    if (HdmiCecSendReply(cntlr, txMsg) != HDF_SUCCESS) {
         HDF_LOGE("report feature msg send fail");
     }
 }
@@ -1596,34 +1961,29 @@ static void HdmiCecMsgDefaultHandle(struct HdmiCntlr *cntlr,
     }
 
     HdmiCecEncodingFeatureAbortMsg(txMsg, opcode, HDMI_CEC_ABORT_UNRECOGNIZED_OPCODE);
-    if (HdmiCecSendMsg(cntlr, txMsg) != HDF_SUCCESS) {
+    if (HdmiCecSendReply(cntlr, txMsg) != HDF_SUCCESS) {
         HDF_LOGE("feature abort msg send fail");
     }
 }
 
+static const HdmiCecHandleMsgFunc g_cecHandleMsgFunc[HDMI_CEC_OPCODE_NUM] = {
+    [HDMI_CEC_OPCODE_GET_CEC_VERSION] = HdmiCecHandleGetCecVersionMsg,
+    [HDMI_CEC_OPCODE_REPORT_PHYSICAL_ADDRESS] = HdmiCecHandleReportPhyAddressMsg,
+    [HDMI_CEC_OPCODE_USER_CONTROL_PRESSED] = HdmiCecHandleUserControlPrtessedMsg,
+    [HDMI_CEC_OPCODE_USER_CONTROL_RELEASED] = HdmiCecHandleUserControlReleasedMsg,
+    [HDMI_CEC_OPCODE_GIVE_PHYSICAL_ADDRESS] = HdmiCecHandleGivePhyAddressMsg,
+    [HDMI_CEC_OPCODE_GIVE_DEVICE_VENDOR_ID] = HdmiCecHandleGiveDeviceVendorIdMsg,
+    [HDMI_CEC_OPCODE_ABORT] = HdmiCecHandleAbortMsg,
+    [HDMI_CEC_OPCODE_GIVE_OSD_NAME] = HdmiCecHandleGiveOsdNameMsg,
+    [HDMI_CEC_OPCODE_GIVE_FEATURES] = HdmiCecHandleGiveFeaturesMsg,
+};
+
 static void HdmiCecMsgHandle(struct HdmiCntlr *cntlr, struct HdmiCecMsg *msg,
     struct HdmiCecMsg *txMsg, uint8_t opcode)
 {
-    uint32_t i, len;
-
-    struct HdmiCecHandleMsgFuncMap funcMap[] = {
-        { HDMI_CEC_OPCODE_GET_CEC_VERSION, HdmiCecHandleGetCecVersionMsg },
-        { HDMI_CEC_OPCODE_REPORT_PHYSICAL_ADDRESS, HdmiCecHandleReportPhyAddressMsg },
-        { HDMI_CEC_OPCODE_USER_CONTROL_PRESSED, HdmiCecHandleUserControlPrtessedMsg },
-        { HDMI_CEC_OPCODE_USER_CONTROL_RELEASED, HdmiCecHandleUserControlReleasedMsg },
-        { HDMI_CEC_OPCODE_GIVE_PHYSICAL_ADDRESS, HdmiCecHandleGivePhyAddressMsg },
-        { HDMI_CEC_OPCODE_GIVE_DEVICE_VENDOR_ID, HdmiCecHandleGiveDeviceVendorIdMsg },
-        { HDMI_CEC_OPCODE_ABORT, HdmiCecHandleAbortMsg },
-        { HDMI_CEC_OPCODE_GIVE_OSD_NAME, HdmiCecHandleGiveOsdNameMsg },
-        { HDMI_CEC_OPCODE_GIVE_FEATURES, HdmiCecHandleGiveFeaturesMsg }
-    };
-
-    len = sizeof(funcMap) / sizeof(funcMap[0]);
-    for (i = 0; i < len; i++) {
-        if (opcode == funcMap[i].opcode) {
-            funcMap[i].func(cntlr, msg, txMsg);
-            return;
-        }
+    if (g_cecHandleMsgFunc[opcode] != NULL) {
+        g_cecHandleMsgFunc[opcode](cntlr, msg, txMsg);
+        return;
     }
     HdmiCecMsgDefaultHandle(cntlr, msg, txMsg);
 }
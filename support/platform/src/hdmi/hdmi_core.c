@@ -56,9 +56,18 @@ static void HdmiCecInit(struct HdmiCntlr *cntlr)
             HDF_LOGE("cec malloc fail");
             return;
         }
+        if (OsalSpinInit(&cntlr->cec->txLock) != HDF_SUCCESS) {
+            HDF_LOGE("cec tx lock init fail");
+            OsalMemFree(cntlr->cec);
+            cntlr->cec = NULL;
+            return;
+        }
     }
     HDF_LOGE("HdmiCecInit, success.");
     cntlr->cec->priv = (void *)cntlr;
+    if (HdmiCecTxQueueStart(cntlr->cec) != HDF_SUCCESS) {
+        HDF_LOGE("cec tx queue start fail, send msg synchronously.");
+    }
 }
 
 static void HdmiCecDeinit(struct HdmiCntlr *cntlr)
@@ -67,6 +76,8 @@ static void HdmiCecDeinit(struct HdmiCntlr *cntlr)
         return;
     }
     if (cntlr->cec != NULL) {
+        HdmiCecTxQueueStop(cntlr->cec);
+        (void)OsalSpinDestroy(&cntlr->cec->txLock);
         OsalMemFree(cntlr->cec);
         cntlr->cec = NULL;
     }
@@ -108,6 +119,25 @@ static void HdmiDdcDeinit(struct HdmiCntlr *cntlr)
     cntlr->ddc.init = false;
 }
 
+static void HdmiEdidCacheInit(struct HdmiCntlr *cntlr)
+{
+    if (cntlr->edidCache != NULL) {
+        return;
+    }
+    cntlr->edidCache = (struct HdmiEdidCache *)OsalMemCalloc(sizeof(struct HdmiEdidCache));
+    if (cntlr->edidCache == NULL) {
+        HDF_LOGE("edid cache malloc fail, read edid without cache.");
+    }
+}
+
+static void HdmiEdidCacheDeinit(struct HdmiCntlr *cntlr)
+{
+    if (cntlr->edidCache != NULL) {
+        OsalMemFree(cntlr->edidCache);
+        cntlr->edidCache = NULL;
+    }
+}
+
 static void HdmiFrlInit(struct HdmiCntlr *cntlr)
 {
     if (cntlr == NULL) {
@@ -302,6 +332,7 @@ static int32_t HdmiCntlrInit(struct HdmiCntlr *cntlr)
     cntlr->device.hdfDev = cntlr->hdfDevObj;
     HdmiInfoFrameInit(cntlr);
     HdmiDdcInit(cntlr);
+    HdmiEdidCacheInit(cntlr);
     return HDF_SUCCESS;
 }
 
@@ -311,6 +342,7 @@ static void HdmiCntlrUninit(struct HdmiCntlr *cntlr)
         HdmiInfoFrameDeInit(cntlr);
         HdmiScdcDeinit(cntlr);
         HdmiDdcDeinit(cntlr);
+        HdmiEdidCacheDeinit(cntlr);
         HdmiCecDeinit(cntlr);
         HdmiFrlDeinit(cntlr);
         HdmiHdcpDeinit(cntlr);
@@ -12,6 +12,9 @@
 
 #define HDF_LOG_TAG hdmi_edid_c
 
+#define HDMI_EDID_FNV_OFFSET_BASIS 0x811C9DC5
+#define HDMI_EDID_FNV_PRIME 0x01000193
+
 /*
  * Address locations 0x00 and 0x07 contain data values 0x00 and locations 0x01 through 0x06 contain 0xFF as data
  * values. CTA-861 requires this data. This header is used to determine the beginning of an EDID structure  in a Sink.
@@ -1282,29 +1285,29 @@ int32_t HdmiEdidPhase(struct HdmiEdid *edid)
     return HDF_SUCCESS;
 }
 
-int32_t HdmiEdidRawDataRead(struct HdmiEdid *edid, struct HdmiDdc *ddc)
+static int32_t HdmiEdidFirstBlockRead(struct HdmiEdid *edid, struct HdmiDdc *ddc, struct HdmiDdcCfg *cfg)
 {
-    struct HdmiDdcCfg cfg = {0};
     int32_t ret;
-    uint8_t extBlkNum;
 
-    if (edid == NULL || ddc == NULL) {
-        return HDF_ERR_INVALID_PARAM;
-    }
-
-    /* read block0 */
-    cfg.type = HDMI_DDC_DEV_EDID;
-    cfg.mode = HDMI_DDC_MODE_READ_MUTIL_NO_ACK;
-    cfg.data = edid->raw;
-    cfg.dataLen = HDMI_EDID_SINGLE_BLOCK_SIZE;
-    cfg.readFlag = true;
-    cfg.devAddr = HDMI_DDC_EDID_DEV_ADDRESS;
-    ret = HdmiDdcTransfer(ddc, &cfg);
+    cfg->type = HDMI_DDC_DEV_EDID;
+    cfg->mode = HDMI_DDC_MODE_READ_MUTIL_NO_ACK;
+    cfg->data = edid->raw;
+    cfg->dataLen = HDMI_EDID_SINGLE_BLOCK_SIZE;
+    cfg->readFlag = true;
+    cfg->devAddr = HDMI_DDC_EDID_DEV_ADDRESS;
+    ret = HdmiDdcTransfer(ddc, cfg);
     if (ret != HDF_SUCCESS) {
         HDF_LOGE("edid block0 read fail");
         return ret;
     }
     edid->rawLen += HDMI_EDID_SINGLE_BLOCK_SIZE;
+    return HDF_SUCCESS;
+}
+
+static int32_t HdmiEdidExtBlockRead(struct HdmiEdid *edid, struct HdmiDdc *ddc, struct HdmiDdcCfg *cfg)
+{
+    int32_t ret;
+    uint8_t extBlkNum;
 
     extBlkNum = edid->raw[HDMI_EDID_EXTENSION_BLOCK_ADDR];
     if (extBlkNum > (HDMI_EDID_MAX_BLOCK_NUM - 1)) {
@@ -1316,9 +1319,10 @@ int32_t HdmiEdidRawDataRead(struct HdmiEdid *edid, struct HdmiDdc *ddc)
         return HDF_SUCCESS;
     }
 
-    /* read block1 */
-    cfg.data += HDMI_EDID_SINGLE_BLOCK_SIZE;
-    ret = HdmiDdcTransfer(ddc, &cfg);
+    /* read block1, the second half of segment 0 */
+    cfg->data += HDMI_EDID_SINGLE_BLOCK_SIZE;
+    cfg->offset = HDMI_EDID_SINGLE_BLOCK_SIZE;
+    ret = HdmiDdcTransfer(ddc, cfg);
     if (ret != HDF_SUCCESS) {
         HDF_LOGE("edid block1 read fail");
         return ret;
@@ -1330,11 +1334,12 @@ int32_t HdmiEdidRawDataRead(struct HdmiEdid *edid, struct HdmiDdc *ddc)
         return HDF_SUCCESS;
     }
     /* read block2~3 */
-    cfg.data += HDMI_EDID_SINGLE_BLOCK_SIZE;
-    cfg.dataLen = (extBlkNum - 1) * HDMI_EDID_SINGLE_BLOCK_SIZE;
-    cfg.mode = HDMI_DDC_MODE_READ_SEGMENT_NO_ACK;
-    cfg.segment = 1;
-    ret = HdmiDdcTransfer(ddc, &cfg);
+    cfg->data += HDMI_EDID_SINGLE_BLOCK_SIZE;
+    cfg->dataLen = (extBlkNum - 1) * HDMI_EDID_SINGLE_BLOCK_SIZE;
+    cfg->mode = HDMI_DDC_MODE_READ_SEGMENT_NO_ACK;
+    cfg->offset = 0;
+    cfg->segment = 1;
+    ret = HdmiDdcTransfer(ddc, cfg);
     if (ret != HDF_SUCCESS) {
         HDF_LOGE("edid block2~3 read fail");
         return ret;
@@ -1343,6 +1348,124 @@ int32_t HdmiEdidRawDataRead(struct HdmiEdid *edid, struct HdmiDdc *ddc)
     return HDF_SUCCESS;
 }
 
+int32_t HdmiEdidRawDataRead(struct HdmiEdid *edid, struct HdmiDdc *ddc)
+{
+    struct HdmiDdcCfg cfg = {0};
+    int32_t ret;
+
+    if (edid == NULL || ddc == NULL) {
+        return HDF_ERR_INVALID_PARAM;
+    }
+
+    ret = HdmiEdidFirstBlockRead(edid, ddc, &cfg);
+    if (ret != HDF_SUCCESS) {
+        return ret;
+    }
+    return HdmiEdidExtBlockRead(edid, ddc, &cfg);
+}
+
+/* FNV-1a over block 0, which holds the vendor, product and serial number and the extension count. */
+static uint32_t HdmiEdidFingerprint(const uint8_t *block)
+{
+    uint32_t i;
+    uint32_t hash = HDMI_EDID_FNV_OFFSET_BASIS;
+
+    for (i = 0; i < HDMI_EDID_SINGLE_BLOCK_SIZE; i++) {
+        hash ^= block[i];
+        hash *= HDMI_EDID_FNV_PRIME;
+    }
+    return hash;
+}
+
+static struct HdmiEdidCacheEntry *HdmiEdidCacheFind(struct HdmiEdidCache *cache, const uint8_t *block,
+    uint32_t fingerprint)
+{
+    uint32_t i;
+    struct HdmiEdidCacheEntry *entry = NULL;
+
+    for (i = 0; i < HDMI_EDID_CACHE_NUM; i++) {
+        entry = &(cache->entries[i]);
+        if (entry->valid == true && entry->fingerprint == fingerprint &&
+            memcmp(entry->edid.raw, block, HDMI_EDID_SINGLE_BLOCK_SIZE) == 0) {
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+static void HdmiEdidCacheStore(struct HdmiEdidCache *cache, const struct HdmiEdid *edid, uint32_t fingerprint)
+{
+    uint32_t i;
+    struct HdmiEdidCacheEntry *victim = &(cache->entries[0]);
+
+    /* an unused entry, or else the least recently used one */
+    for (i = 0; i < HDMI_EDID_CACHE_NUM; i++) {
+        if (cache->entries[i].valid == false) {
+            victim = &(cache->entries[i]);
+            break;
+        }
+        if (cache->entries[i].lastUse < victim->lastUse) {
+            victim = &(cache->entries[i]);
+        }
+    }
+    if (memcpy_s(&(victim->edid), sizeof(victim->edid), edid, sizeof(*edid)) != EOK) {
+        HDF_LOGE("edid cache store, memcpy_s fail.");
+        victim->valid = false;
+        return;
+    }
+    victim->fingerprint = fingerprint;
+    victim->lastUse = ++cache->useCnt;
+    victim->valid = true;
+}
+
+int32_t HdmiEdidCacheRead(struct HdmiEdid *edid, struct HdmiDdc *ddc, struct HdmiEdidCache *cache)
+{
+    struct HdmiDdcCfg cfg = {0};
+    struct HdmiEdidCacheEntry *entry = NULL;
+    uint32_t fingerprint;
+    int32_t ret;
+
+    if (edid == NULL || ddc == NULL) {
+        return HDF_ERR_INVALID_PARAM;
+    }
+    if (cache == NULL) {
+        ret = HdmiEdidRawDataRead(edid, ddc);
+        if (ret != HDF_SUCCESS) {
+            return ret;
+        }
+        return HdmiEdidPhase(edid);
+    }
+
+    ret = HdmiEdidFirstBlockRead(edid, ddc, &cfg);
+    if (ret != HDF_SUCCESS) {
+        return ret;
+    }
+    fingerprint = HdmiEdidFingerprint(edid->raw);
+    entry = HdmiEdidCacheFind(cache, edid->raw, fingerprint);
+    if (entry != NULL) {
+        if (memcpy_s(edid, sizeof(*edid), &(entry->edid), sizeof(entry->edid)) != EOK) {
+            HDF_LOGE("edid cache read, memcpy_s fail.");
+            return HDF_ERR_IO;
+        }
+        entry->lastUse = ++cache->useCnt;
+        cache->hits++;
+        HDF_LOGD("edid cache hit, fingerprint 0x%x.", fingerprint);
+        return HDF_SUCCESS;
+    }
+
+    cache->misses++;
+    ret = HdmiEdidExtBlockRead(edid, ddc, &cfg);
+    if (ret != HDF_SUCCESS) {
+        return ret;
+    }
+    ret = HdmiEdidPhase(edid);
+    if (ret != HDF_SUCCESS) {
+        return ret;
+    }
+    HdmiEdidCacheStore(cache, edid, fingerprint);
+    return HDF_SUCCESS;
+}
+
 bool HdmiEdidSupportFrl(struct HdmiDevice *hdmi)
 {
     if (hdmi == NULL) {
@@ -107,11 +107,7 @@ static int32_t HdmiEventHotPlugHandleComm(struct HdmiCntlr *cntlr)
         ret = HDF_ERR_IO;
         goto __END;
     }
-    ret = HdmiEdidRawDataRead(&(cntlr->hdmi->edid), &(cntlr->ddc));
-    if (ret != HDF_SUCCESS) {
-        goto __END;
-    }
-    ret = HdmiEdidPhase(&(cntlr->hdmi->edid));
+    ret = HdmiEdidCacheRead(&(cntlr->hdmi->edid), &(cntlr->ddc), cntlr->edidCache);
     if (ret != HDF_SUCCESS) {
         goto __END;
     }
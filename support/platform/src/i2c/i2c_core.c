@@ -16,11 +16,28 @@
 #define HDF_LOG_TAG i2c_core
 #define LOCK_WAIT_SECONDS_M 1
 #define I2C_HANDLE_SHIFT    ((uintptr_t)(-1) << 16)
+#define I2C_XFER_MAX        32
+
+/*
+ * A transfer registered by a user-space client: the message layout and the reply
+ * buffers are kept across calls, so running it again needs no allocation. Only the
+ * registering client may run or unregister it, and it is released when that client closes.
+ */
+struct I2cManagerXfer {
+    const struct HdfDeviceIoClient *client;
+    struct I2cCntlr *cntlr;
+    struct OsalMutex lock;
+    uint32_t refs; /* the xfers[] slot and each call running it, under the manager lock */
+    int16_t count;
+    struct I2cMsg *msgs;
+};
 
 struct I2cManager {
     struct IDeviceIoService service;
     struct HdfDeviceObject *device;
     struct I2cCntlr *cntlrs[I2C_BUS_MAX];
+    struct I2cManagerXfer *xfers[I2C_XFER_MAX];
+    struct I2cIoStats stats;
     struct OsalMutex lock;
 };
 
@@ -176,6 +193,7 @@ int32_t I2cCntlrAdd(struct I2cCntlr *cntlr)
         (void)OsalMutexDestroy(&cntlr->lock);
         return ret;
     }
+    (void)PlatformStatsRegister(&cntlr->xferStats, PLATFORM_MODULE_I2C, (uint32_t)cntlr->busId);
     return HDF_SUCCESS;
 }
 
@@ -184,6 +202,7 @@ void I2cCntlrRemove(struct I2cCntlr *cntlr)
     if (cntlr == NULL) {
         return;
     }
+    PlatformStatsUnregister(&cntlr->xferStats);
     I2cManagerRemoveCntlr(cntlr);
     (void)OsalMutexDestroy(&cntlr->lock);
 }
@@ -203,9 +222,21 @@ static inline void I2cCntlrUnlock(struct I2cCntlr *cntlr)
     }
 }
 
+static uint32_t I2cMsgsLen(const struct I2cMsg *msgs, int16_t count)
+{
+    int16_t i;
+    uint32_t len = 0;
+
+    for (i = 0; msgs != NULL && i < count; i++) {
+        len += msgs[i].len;
+    }
+    return len;
+}
+
 int32_t I2cCntlrTransfer(struct I2cCntlr *cntlr, struct I2cMsg *msgs, int16_t count)
 {
     int32_t ret;
+    struct PlatformStatsStamp stamp;
 
     if (cntlr == NULL) {
         HDF_LOGE("I2cCntlrTransfer: cntlr is null");
@@ -217,12 +248,17 @@ int32_t I2cCntlrTransfer(struct I2cCntlr *cntlr, struct I2cMsg *msgs, int16_t co
         return HDF_ERR_NOT_SUPPORT;
     }
 
+    PlatformStatsBegin(&stamp);
     if (I2cCntlrLock(cntlr) != HDF_SUCCESS) {
         HDF_LOGE("I2cCntlrTransfer: lock controller fail!");
         return HDF_ERR_DEVICE_BUSY;
     }
+    PlatformStatsLocked(&stamp);
     ret = cntlr->ops->transfer(cntlr, msgs, count);
     I2cCntlrUnlock(cntlr);
+    /* ret is the number of msgs done, a transfer stopped early counts as an error */
+    PlatformStatsEnd(&cntlr->xferStats, &stamp, I2cMsgsLen(msgs, (int16_t)((ret > 0) ? ret : 0)),
+        (ret == count) ? HDF_SUCCESS : HDF_FAILURE);
     return ret;
 }
 
@@ -259,6 +295,11 @@ static int32_t I2cTransferRebuildMsgs(struct HdfSBuf *data, struct I2cMsg **ppms
         if (bufReply == NULL) {
             return HDF_ERR_MALLOC_FAIL;
         }
+        if (g_i2cManager != NULL) {
+            (void)OsalMutexLock(&g_i2cManager->lock);
+            g_i2cManager->stats.allocs++;
+            (void)OsalMutexUnlock(&g_i2cManager->lock);
+        }
         for (i = 0, buf = bufReply; i < count && buf < (bufReply + lenReply); i++) {
             if ((msgs[i].flags & I2C_FLAG_READ) != 0) {
                 msgs[i].buf = buf;
@@ -316,6 +357,11 @@ static int32_t I2cManagerIoTransfer(struct HdfSBuf *data, struct HdfSBuf *reply)
     }
 
     ret = I2cCntlrTransfer(I2cManagerFindCntlr(number), msgs, count);
+    if (g_i2cManager != NULL) {
+        (void)OsalMutexLock(&g_i2cManager->lock);
+        g_i2cManager->stats.transfers++;
+        (void)OsalMutexUnlock(&g_i2cManager->lock);
+    }
     if (ret != count) {
         goto __EXIT__;
     }
@@ -370,6 +416,302 @@ static int32_t I2cManagerIoClose(struct HdfSBuf *data, struct HdfSBuf *reply)
     return HDF_SUCCESS;
 }
 
+static int32_t I2cManagerXferCheckMsgs(const struct I2cMsg *msgs, uint32_t len, int16_t *count, uint32_t *lenReply)
+{
+    uint32_t i;
+    uint32_t num;
+    uint32_t total = 0;
+
+    if (len == 0 || (len % sizeof(*msgs)) != 0) {
+        HDF_LOGE("I2cManagerXferCheckMsgs: invalid msgs len:%u!", len);
+        return HDF_ERR_INVALID_PARAM;
+    }
+    num = len / sizeof(*msgs);
+    if (num > I2C_XFER_MSG_MAX) {
+        HDF_LOGE("I2cManagerXferCheckMsgs: too many msgs:%u!", num);
+        return HDF_ERR_INVALID_PARAM;
+    }
+    /* each len is at most 16 bits and num is capped, so the sum can not wrap */
+    for (i = 0; i < num; i++) {
+        total += msgs[i].len;
+    }
+    if (total > I2C_XFER_BUF_MAX) {
+        HDF_LOGE("I2cManagerXferCheckMsgs: msgs too long:%u!", total);
+        return HDF_ERR_INVALID_PARAM;
+    }
+    total = 0;
+    for (i = 0; i < num; i++) {
+        total += ((msgs[i].flags & I2C_FLAG_READ) != 0) ? msgs[i].len : 0;
+    }
+    *count = (int16_t)num;
+    *lenReply = total;
+    return HDF_SUCCESS;
+}
+
+static struct I2cManagerXfer *I2cManagerXferCreate(const struct HdfDeviceIoClient *client, struct I2cCntlr *cntlr,
+    const struct I2cMsg *msgs, int16_t count, uint32_t lenReply)
+{
+    int16_t i;
+    uint8_t *buf = NULL;
+    struct I2cManagerXfer *xfer = NULL;
+
+    /* the message array and all reply buffers live in the same block as the transfer itself */
+    xfer = (struct I2cManagerXfer *)OsalMemCalloc(sizeof(*xfer) + sizeof(*msgs) * count + lenReply);
+    if (xfer == NULL) {
+        return NULL;
+    }
+    if (OsalMutexInit(&xfer->lock) != HDF_SUCCESS) {
+        OsalMemFree(xfer);
+        return NULL;
+    }
+    xfer->client = client;
+    xfer->cntlr = cntlr;
+    xfer->refs = 1;
+    xfer->count = count;
+    xfer->msgs = (struct I2cMsg *)(xfer + 1);
+    buf = (uint8_t *)(xfer->msgs + count);
+    for (i = 0; i < count; i++) {
+        xfer->msgs[i] = msgs[i];
+        xfer->msgs[i].buf = NULL;
+        if ((msgs[i].flags & I2C_FLAG_READ) != 0) {
+            xfer->msgs[i].buf = buf;
+            buf += msgs[i].len;
+        }
+    }
+    return xfer;
+}
+
+static void I2cManagerXferDestroy(struct I2cManagerXfer *xfer)
+{
+    (void)OsalMutexDestroy(&xfer->lock);
+    I2cCntlrPut(xfer->cntlr);
+    OsalMemFree(xfer);
+}
+
+/* drop a reference, the last one frees the transfer */
+static void I2cManagerXferPut(struct I2cManager *manager, struct I2cManagerXfer *xfer)
+{
+    uint32_t refs;
+
+    (void)OsalMutexLock(&manager->lock);
+    refs = --xfer->refs;
+    (void)OsalMutexUnlock(&manager->lock);
+    if (refs == 0) {
+        I2cManagerXferDestroy(xfer);
+    }
+}
+
+static int32_t I2cManagerIoTransferRegister(struct HdfDeviceIoClient *client, struct HdfSBuf *data,
+    struct HdfSBuf *reply)
+{
+    uint32_t id;
+    uint32_t len;
+    uint32_t lenReply;
+    uint32_t handle;
+    int16_t number;
+    int16_t count;
+    struct I2cCntlr *cntlr = NULL;
+    struct I2cManagerXfer *xfer = NULL;
+    const struct I2cMsg *msgs = NULL;
+    struct I2cManager *manager = g_i2cManager;
+
+    if (manager == NULL || data == NULL || reply == NULL) {
+        return HDF_ERR_INVALID_PARAM;
+    }
+    if (!HdfSbufReadUint32(data, &handle) || !HdfSbufReadBuffer(data, (const void **)&msgs, &len) ||
+        msgs == NULL) {
+        HDF_LOGE("I2cManagerIoTransferRegister: read msgs fail!");
+        return HDF_ERR_IO;
+    }
+    if (I2cManagerXferCheckMsgs(msgs, len, &count, &lenReply) != HDF_SUCCESS) {
+        return HDF_ERR_INVALID_PARAM;
+    }
+    number = (int16_t)(handle - I2C_HANDLE_SHIFT);
+    if (number < 0 || number >= I2C_BUS_MAX) {
+        return HDF_ERR_INVALID_PARAM;
+    }
+    cntlr = I2cCntlrGet(number);
+    if (cntlr == NULL) {
+        return HDF_ERR_NOT_SUPPORT;
+    }
+
+    xfer = I2cManagerXferCreate(client, cntlr, msgs, count, lenReply);
+    if (xfer == NULL) {
+        I2cCntlrPut(cntlr);
+        return HDF_ERR_MALLOC_FAIL;
+    }
+
+    (void)OsalMutexLock(&manager->lock);
+    manager->stats.allocs++;
+    for (id = 0; id < I2C_XFER_MAX; id++) {
+        if (manager->xfers[id] == NULL) {
+            manager->xfers[id] = xfer;
+            break;
+        }
+    }
+    (void)OsalMutexUnlock(&manager->lock);
+    if (id >= I2C_XFER_MAX) {
+        HDF_LOGE("I2cManagerIoTransferRegister: no free transfer slot!");
+        I2cManagerXferDestroy(xfer);
+        return HDF_ERR_DEVICE_BUSY;
+    }
+
+    if (!HdfSbufWriteUint32(reply, id)) {
+        (void)OsalMutexLock(&manager->lock);
+        manager->xfers[id] = NULL;
+        (void)OsalMutexUnlock(&manager->lock);
+        I2cManagerXferPut(manager, xfer);
+        return HDF_ERR_IO;
+    }
+    return HDF_SUCCESS;
+}
+
+/*
+ * Look up a transfer registered by the client and return it locked. The reference taken under
+ * the manager lock keeps it alive after an unregister, so the manager lock is dropped before
+ * waiting for a call still running on the same transfer.
+ */
+static struct I2cManagerXfer *I2cManagerXferGet(const struct HdfDeviceIoClient *client, uint32_t id)
+{
+    struct I2cManagerXfer *xfer = NULL;
+    struct I2cManager *manager = g_i2cManager;
+
+    if (manager == NULL || id >= I2C_XFER_MAX) {
+        return NULL;
+    }
+    (void)OsalMutexLock(&manager->lock);
+    xfer = manager->xfers[id];
+    if (xfer != NULL && xfer->client != client) {
+        xfer = NULL;
+    }
+    if (xfer != NULL) {
+        xfer->refs++;
+        manager->stats.transfers++;
+    }
+    (void)OsalMutexUnlock(&manager->lock);
+    if (xfer != NULL) {
+        (void)OsalMutexLock(&xfer->lock);
+    }
+    return xfer;
+}
+
+static int32_t I2cManagerIoTransferByHandle(struct HdfDeviceIoClient *client, struct HdfSBuf *data,
+    struct HdfSBuf *reply)
+{
+    int16_t i;
+    int32_t ret;
+    uint32_t id;
+    uint32_t len;
+    uint8_t *buf = NULL;
+    struct I2cManagerXfer *xfer = NULL;
+
+    if (data == NULL || reply == NULL || !HdfSbufReadUint32(data, &id)) {
+        return HDF_ERR_INVALID_PARAM;
+    }
+    xfer = I2cManagerXferGet(client, id);
+    if (xfer == NULL) {
+        HDF_LOGE("I2cManagerIoTransferByHandle: transfer %u not registered!", id);
+        return HDF_ERR_INVALID_OBJECT;
+    }
+
+    /* write msgs are sent straight from the request buffer */
+    for (i = 0; i < xfer->count; i++) {
+        if ((xfer->msgs[i].flags & I2C_FLAG_READ) != 0) {
+            continue;
+        }
+        if (!HdfSbufReadBuffer(data, (const void **)&buf, &len) || len != xfer->msgs[i].len) {
+            HDF_LOGE("I2cManagerIoTransferByHandle: read msg[%d] buf fail!", i);
+            (void)OsalMutexUnlock(&xfer->lock);
+            I2cManagerXferPut(g_i2cManager, xfer);
+            return HDF_ERR_IO;
+        }
+        xfer->msgs[i].buf = buf;
+    }
+
+    ret = I2cCntlrTransfer(xfer->cntlr, xfer->msgs, xfer->count);
+    if (ret == xfer->count) {
+        ret = I2cTransferWriteBackMsgs(reply, xfer->msgs, xfer->count);
+    }
+    (void)OsalMutexUnlock(&xfer->lock);
+    I2cManagerXferPut(g_i2cManager, xfer);
+    return ret;
+}
+
+static int32_t I2cManagerIoTransferUnregister(struct HdfDeviceIoClient *client, struct HdfSBuf *data)
+{
+    uint32_t id;
+    struct I2cManagerXfer *xfer = NULL;
+    struct I2cManager *manager = g_i2cManager;
+
+    if (manager == NULL || data == NULL || !HdfSbufReadUint32(data, &id) || id >= I2C_XFER_MAX) {
+        return HDF_ERR_INVALID_PARAM;
+    }
+    (void)OsalMutexLock(&manager->lock);
+    xfer = manager->xfers[id];
+    if (xfer == NULL || xfer->client != client) {
+        (void)OsalMutexUnlock(&manager->lock);
+        return HDF_ERR_INVALID_OBJECT;
+    }
+    manager->xfers[id] = NULL;
+    (void)OsalMutexUnlock(&manager->lock);
+    I2cManagerXferPut(manager, xfer);
+    return HDF_SUCCESS;
+}
+
+/* drop the transfers a client left registered when it closes the service */
+static void I2cManagerIoRelease(struct HdfDeviceIoClient *client)
+{
+    uint32_t id;
+    struct I2cManagerXfer *xfer = NULL;
+    struct I2cManager *manager = g_i2cManager;
+
+    if (manager == NULL || client == NULL) {
+        return;
+    }
+    for (id = 0; id < I2C_XFER_MAX; id++) {
+        (void)OsalMutexLock(&manager->lock);
+        xfer = manager->xfers[id];
+        if (xfer == NULL || xfer->client != client) {
+            (void)OsalMutexUnlock(&manager->lock);
+            continue;
+        }
+        manager->xfers[id] = NULL;
+        (void)OsalMutexUnlock(&manager->lock);
+        I2cManagerXferPut(manager, xfer);
+    }
+}
+
+int32_t I2cManagerGetIoStats(struct I2cIoStats *stats)
+{
+    struct I2cManager *manager = g_i2cManager;
+
+    if (manager == NULL || stats == NULL) {
+        return HDF_ERR_INVALID_OBJECT;
+    }
+    (void)OsalMutexLock(&manager->lock);
+    *stats = manager->stats;
+    (void)OsalMutexUnlock(&manager->lock);
+    return HDF_SUCCESS;
+}
+
+static int32_t I2cManagerIoGetStats(struct HdfSBuf *reply)
+{
+    int32_t ret;
+    struct I2cIoStats stats;
+
+    if (reply == NULL) {
+        return HDF_ERR_INVALID_PARAM;
+    }
+    ret = I2cManagerGetIoStats(&stats);
+    if (ret != HDF_SUCCESS) {
+        return ret;
+    }
+    if (!HdfSbufWriteBuffer(reply, &stats, sizeof(stats))) {
+        return HDF_ERR_IO;
+    }
+    return HDF_SUCCESS;
+}
+
 static int32_t I2cManagerDispatch(struct HdfDeviceIoClient *client, int cmd,
     struct HdfSBuf *data, struct HdfSBuf *reply)
 {
@@ -382,6 +724,14 @@ static int32_t I2cManagerDispatch(struct HdfDeviceIoClient *client, int cmd,
             return I2cManagerIoClose(data, reply);
         case I2C_IO_TRANSFER:
             return I2cManagerIoTransfer(data, reply);
+        case I2C_IO_TRANSFER_REGISTER:
+            return I2cManagerIoTransferRegister(client, data, reply);
+        case I2C_IO_TRANSFER_BY_HANDLE:
+            return I2cManagerIoTransferByHandle(client, data, reply);
+        case I2C_IO_TRANSFER_UNREGISTER:
+            return I2cManagerIoTransferUnregister(client, data);
+        case I2C_IO_GET_STATS:
+            return I2cManagerIoGetStats(reply);
         default:
             ret = HDF_ERR_NOT_SUPPORT;
             break;
@@ -416,6 +766,7 @@ static int32_t I2cManagerBind(struct HdfDeviceObject *device)
     manager->device = device;
     device->service = &manager->service;
     device->service->Dispatch = I2cManagerDispatch;
+    device->service->Release = I2cManagerIoRelease;
     g_i2cManager = manager;
     return HDF_SUCCESS;
 }
@@ -428,6 +779,7 @@ static int32_t I2cManagerInit(struct HdfDeviceObject *device)
 
 static void I2cManagerRelease(struct HdfDeviceObject *device)
 {
+    uint32_t id;
     struct I2cManager *manager = NULL;
 
     HDF_LOGI("I2cManagerRelease: enter");
@@ -440,6 +792,12 @@ static void I2cManagerRelease(struct HdfDeviceObject *device)
         HDF_LOGI("I2cManagerRelease: no service binded!");
         return;
     }
+    for (id = 0; id < I2C_XFER_MAX; id++) {
+        if (manager->xfers[id] != NULL) {
+            I2cManagerXferDestroy(manager->xfers[id]);
+            manager->xfers[id] = NULL;
+        }
+    }
     g_i2cManager = NULL;
     OsalMemFree(manager);
 }
@@ -25,11 +25,26 @@
 
 #define I2C_SERVICE_NAME "HDF_PLATFORM_I2C_MANAGER"
 
+struct I2cTransferDesc {
+    DevHandle handle;
+    struct I2cMsg *msgs;
+    int16_t count;
+#ifdef __USER__
+    uint32_t id;
+    struct HdfSBuf *data;  // reused for every call
+    struct HdfSBuf *reply; // sized for all read msgs at register time
+#endif
+};
+
 #ifdef __USER__
 enum I2cIoCmd {
     I2C_IO_TRANSFER = 0,
     I2C_IO_OPEN = 1,
     I2C_IO_CLOSE = 2,
+    I2C_IO_TRANSFER_REGISTER = 3,
+    I2C_IO_TRANSFER_BY_HANDLE = 4,
+    I2C_IO_TRANSFER_UNREGISTER = 5,
+    I2C_IO_GET_STATS = 6,
 };
 
 static void *I2cManagerGetService(void)
@@ -279,3 +294,212 @@ int32_t I2cTransfer(DevHandle handle, struct I2cMsg *msgs, int16_t count)
 #endif
 }
 
+
+static int32_t I2cTransferCheckMsgs(const struct I2cMsg *msgs, int16_t count)
+{
+    int16_t i;
+
+    if (msgs == NULL || count <= 0 || count > I2C_XFER_MSG_MAX) {
+        HDF_LOGE("I2cTransferRegister: err params! msgs:%s, count:%d", (msgs == NULL) ? "0" : "x", count);
+        return HDF_ERR_INVALID_PARAM;
+    }
+    for (i = 0; i < count; i++) {
+        if (msgs[i].buf == NULL && msgs[i].len > 0) {
+            HDF_LOGE("I2cTransferRegister: msg[%d] has no buf!", i);
+            return HDF_ERR_INVALID_PARAM;
+        }
+    }
+    return HDF_SUCCESS;
+}
+
+#ifdef __USER__
+static int32_t I2cServiceTransferRegister(struct I2cTransferDesc *desc)
+{
+    int16_t i;
+    int32_t ret;
+    uint32_t recvLen = 0;
+    struct HdfIoService *service = NULL;
+
+    service = (struct HdfIoService *)I2cManagerGetService();
+    if (service == NULL) {
+        return HDF_ERR_NOT_SUPPORT;
+    }
+
+    for (i = 0; i < desc->count; i++) {
+        recvLen += ((desc->msgs[i].flags & I2C_FLAG_READ) == 0) ? 0 : (desc->msgs[i].len + sizeof(uint64_t));
+    }
+    desc->data = HdfSBufObtainDefaultSize();
+    desc->reply = (recvLen == 0) ? HdfSBufObtainDefaultSize() : HdfSBufObtain(recvLen);
+    if (desc->data == NULL || desc->reply == NULL) {
+        HDF_LOGE("I2cServiceTransferRegister: failed to obtain sbuf!");
+        return HDF_ERR_MALLOC_FAIL;
+    }
+
+    if (!HdfSbufWriteUint32(desc->data, (uint32_t)(uintptr_t)desc->handle) ||
+        !HdfSbufWriteBuffer(desc->data, (uint8_t *)desc->msgs, sizeof(*desc->msgs) * desc->count)) {
+        HDF_LOGE("I2cServiceTransferRegister: write msgs fail!");
+        return HDF_ERR_IO;
+    }
+    ret = service->dispatcher->Dispatch(&service->object, I2C_IO_TRANSFER_REGISTER, desc->data, desc->reply);
+    if (ret != HDF_SUCCESS) {
+        HDF_LOGE("I2cServiceTransferRegister: failed to send service call:%d", ret);
+        return ret;
+    }
+    if (!HdfSbufReadUint32(desc->reply, &desc->id)) {
+        HDF_LOGE("I2cServiceTransferRegister: read id fail!");
+        return HDF_ERR_IO;
+    }
+    return HDF_SUCCESS;
+}
+
+static int32_t I2cServiceTransferByHandle(struct I2cTransferDesc *desc)
+{
+    int16_t i;
+    int32_t ret;
+    struct HdfIoService *service = NULL;
+
+    service = (struct HdfIoService *)I2cManagerGetService();
+    if (service == NULL) {
+        return HDF_ERR_NOT_SUPPORT;
+    }
+
+    HdfSbufFlush(desc->data);
+    HdfSbufFlush(desc->reply);
+    if (!HdfSbufWriteUint32(desc->data, desc->id)) {
+        return HDF_ERR_IO;
+    }
+    for (i = 0; i < desc->count; i++) {
+        if ((desc->msgs[i].flags & I2C_FLAG_READ) != 0) {
+            continue;
+        }
+        if (!HdfSbufWriteBuffer(desc->data, desc->msgs[i].buf, desc->msgs[i].len)) {
+            HDF_LOGE("I2cServiceTransferByHandle: write msg[%d] buf fail!", i);
+            return HDF_ERR_IO;
+        }
+    }
+
+    ret = service->dispatcher->Dispatch(&service->object, I2C_IO_TRANSFER_BY_HANDLE, desc->data, desc->reply);
+    if (ret != HDF_SUCCESS) {
+        HDF_LOGE("I2cServiceTransferByHandle: failed to send service call:%d", ret);
+        return ret;
+    }
+    ret = I2cMsgReadArray(desc->reply, desc->msgs, desc->count);
+    return (ret == HDF_SUCCESS) ? desc->count : ret;
+}
+
+static void I2cServiceTransferUnregister(struct I2cTransferDesc *desc)
+{
+    struct HdfIoService *service = NULL;
+
+    service = (struct HdfIoService *)I2cManagerGetService();
+    if (service != NULL && desc->data != NULL) {
+        HdfSbufFlush(desc->data);
+        if (HdfSbufWriteUint32(desc->data, desc->id)) {
+            (void)service->dispatcher->Dispatch(&service->object, I2C_IO_TRANSFER_UNREGISTER, desc->data, NULL);
+        }
+    }
+}
+
+static void I2cTransferDescFree(struct I2cTransferDesc *desc)
+{
+    if (desc->data != NULL) {
+        HdfSBufRecycle(desc->data);
+    }
+    if (desc->reply != NULL) {
+        HdfSBufRecycle(desc->reply);
+    }
+    OsalMemFree(desc);
+}
+#else
+static inline void I2cTransferDescFree(struct I2cTransferDesc *desc)
+{
+    OsalMemFree(desc);
+}
+#endif
+
+DevHandle I2cTransferRegister(DevHandle handle, struct I2cMsg *msgs, int16_t count)
+{
+    struct I2cTransferDesc *desc = NULL;
+
+    if (handle == NULL || I2cTransferCheckMsgs(msgs, count) != HDF_SUCCESS) {
+        return NULL;
+    }
+
+    desc = (struct I2cTransferDesc *)OsalMemCalloc(sizeof(*desc));
+    if (desc == NULL) {
+        HDF_LOGE("I2cTransferRegister: malloc desc fail!");
+        return NULL;
+    }
+    desc->handle = handle;
+    desc->msgs = msgs;
+    desc->count = count;
+#ifdef __USER__
+    if (I2cServiceTransferRegister(desc) != HDF_SUCCESS) {
+        I2cTransferDescFree(desc);
+        return NULL;
+    }
+#endif
+    return (DevHandle)desc;
+}
+
+int32_t I2cTransferByHandle(DevHandle xfer)
+{
+    struct I2cTransferDesc *desc = (struct I2cTransferDesc *)xfer;
+
+    if (desc == NULL) {
+        return HDF_ERR_INVALID_OBJECT;
+    }
+#ifdef __USER__
+    return I2cServiceTransferByHandle(desc);
+#else
+    return I2cCntlrTransfer((struct I2cCntlr *)desc->handle, desc->msgs, desc->count);
+#endif
+}
+
+void I2cTransferUnregister(DevHandle xfer)
+{
+    struct I2cTransferDesc *desc = (struct I2cTransferDesc *)xfer;
+
+    if (desc == NULL) {
+        return;
+    }
+#ifdef __USER__
+    I2cServiceTransferUnregister(desc);
+#endif
+    I2cTransferDescFree(desc);
+}
+
+int32_t I2cGetIoStats(struct I2cIoStats *stats)
+{
+#ifdef __USER__
+    int32_t ret;
+    uint32_t len;
+    const void *buf = NULL;
+    struct HdfSBuf *reply = NULL;
+    struct HdfIoService *service = NULL;
+#endif
+
+    if (stats == NULL) {
+        return HDF_ERR_INVALID_PARAM;
+    }
+#ifdef __USER__
+    service = (struct HdfIoService *)I2cManagerGetService();
+    if (service == NULL) {
+        return HDF_ERR_NOT_SUPPORT;
+    }
+    reply = HdfSBufObtainDefaultSize();
+    if (reply == NULL) {
+        return HDF_ERR_MALLOC_FAIL;
+    }
+    ret = service->dispatcher->Dispatch(&service->object, I2C_IO_GET_STATS, NULL, reply);
+    if (ret == HDF_SUCCESS && (!HdfSbufReadBuffer(reply, &buf, &len) || len != sizeof(*stats) ||
+        memcpy_s(stats, sizeof(*stats), buf, len) != EOK)) {
+        HDF_LOGE("I2cGetIoStats: read stats fail!");
+        ret = HDF_ERR_IO;
+    }
+    HdfSBufRecycle(reply);
+    return ret;
+#else
+    return I2cManagerGetIoStats(stats);
+#endif
+}
@@ -77,6 +77,11 @@ static void I3cDeviceListPut(void)
     (void)OsalSpinUnlock(&g_listLock);
 }
 
+static inline uint16_t I3cDeviceGetAddr(const struct I3cDevice *device)
+{
+    return (device->dynaAddr != 0) ? device->dynaAddr : device->addr;
+}
+
 static int32_t GetAddrStatus(struct I3cCntlr *cntlr, uint16_t addr)
 {
     int32_t status;
@@ -92,57 +97,77 @@ static int32_t GetAddrStatus(struct I3cCntlr *cntlr, uint16_t addr)
     return status;
 }
 
-static int32_t SetAddrStatus(struct I3cCntlr *cntlr, uint16_t addr, enum I3cAddrStatus status)
+/* the lowest set bit of a word which is not 0 */
+static inline uint16_t I3cLowBit(uint32_t word)
 {
-    uint16_t temp;
-    uint32_t ret;
-    uint16_t statusMask;
+    uint16_t bit = 0;
+    uint16_t half = BITS_PER_UINT32 / 2;
 
-    if (addr > I3C_ADDR_MAX) {
-        HDF_LOGE("%s: The address 0x%x exceeds the maximum address", __func__, addr);
-        return HDF_ERR_INVALID_PARAM;
+    while (half > 0) {
+        if ((word & ((1U << half) - 1)) == 0) {
+            word >>= half;
+            bit += half;
+        }
+        half >>= 1;
     }
+    return bit;
+}
 
-    if (cntlr == NULL) {
-        HDF_LOGE("%s: cntlr is NULL!", __func__);
-        return HDF_ERR_INVALID_PARAM;
-    }
+/* addrDev is also read by GetDeviceByAddr, which only takes addrLock */
+static void I3cCntlrSetAddrDev(struct I3cCntlr *cntlr, uint16_t addr, struct I3cDevice *device)
+{
+    uint32_t flags;
 
-    ret = I3cCntlrLock(cntlr);
-    if (ret != HDF_SUCCESS) {
-        HDF_LOGE("%s: Lock cntlr failed!", __func__);
-        return ret;
-    }
+    (void)OsalSpinLockIrqSave(&cntlr->addrLock, &flags);
+    cntlr->addrDev[addr] = device;
+    (void)OsalSpinUnlockIrqRestore(&cntlr->addrLock, &flags);
+}
+
+/* the status slots and the free bitmap always change together, under the controller lock */
+static void SetAddrStatusLocked(struct I3cCntlr *cntlr, uint16_t addr, enum I3cAddrStatus status)
+{
+    uint16_t temp;
+    uint16_t statusMask;
+    uint32_t freeBit = 1U << (addr % BITS_PER_UINT32);
 
     statusMask = ADDR_STATUS_MASK << ((addr % ADDRS_PER_UINT16) * ADDRS_STATUS_BITS);
     temp = (cntlr->addrSlot[addr / ADDRS_PER_UINT16]) & ~statusMask;
     temp |= ((uint16_t)status) << ((addr % ADDRS_PER_UINT16) * ADDRS_STATUS_BITS);
     cntlr->addrSlot[addr / ADDRS_PER_UINT16] = temp;
 
-    I3cCntlrUnlock(cntlr);
-
-    return HDF_SUCCESS;
+    if (status == I3C_ADDR_FREE) {
+        cntlr->addrFree[addr / BITS_PER_UINT32] |= freeBit;
+        I3cCntlrSetAddrDev(cntlr, addr, NULL);
+    } else {
+        cntlr->addrFree[addr / BITS_PER_UINT32] &= ~freeBit;
+    }
 }
 
-static void inline I3cInitAddrStatus(struct I3cCntlr *cntlr)
+static inline void I3cInitAddrStatus(struct I3cCntlr *cntlr)
 {
     uint16_t addr;
+    enum I3cAddrStatus status;
 
+    if (I3cCntlrLock(cntlr) != HDF_SUCCESS) {
+        HDF_LOGE("%s: Lock cntlr failed!", __func__);
+        return;
+    }
     for (addr = 0; addr <= I3C_ADDR_MAX; addr++) {
-        if (CHECK_RESERVED_ADDR(addr) == I3C_ADDR_RESERVED) {
-            (void)SetAddrStatus(cntlr, addr, I3C_ADDR_RESERVED);
-        }
+        status = (CHECK_RESERVED_ADDR(addr) == I3C_ADDR_RESERVED) ?
+            I3C_ADDR_RESERVED : (enum I3cAddrStatus)GetAddrStatus(cntlr, addr);
+        SetAddrStatusLocked(cntlr, addr, status);
     }
+    I3cCntlrUnlock(cntlr);
 }
 
-static int32_t GetFreeAddr(struct I3cCntlr *cntlr)
+/* claim a given address for a device, it must be free */
+static int32_t I3cCntlrClaimAddr(struct I3cCntlr *cntlr, uint16_t addr, struct I3cDevice *device,
+    enum I3cAddrStatus status)
 {
-    enum I3cAddrStatus status;
-    int16_t count;
     int32_t ret;
 
-    if (cntlr == NULL) {
-        HDF_LOGE("%s: cntlr is NULL!", __func__);
+    if (addr > I3C_ADDR_MAX) {
+        HDF_LOGE("%s: The address 0x%x exceeds the maximum address", __func__, addr);
         return HDF_ERR_INVALID_PARAM;
     }
 
@@ -151,12 +176,39 @@ static int32_t GetFreeAddr(struct I3cCntlr *cntlr)
         HDF_LOGE("%s: Lock cntlr failed!", __func__);
         return ret;
     }
+    if (GetAddrStatus(cntlr, addr) != I3C_ADDR_FREE) {
+        I3cCntlrUnlock(cntlr);
+        return HDF_ERR_DEVICE_BUSY;
+    }
+    SetAddrStatusLocked(cntlr, addr, status);
+    I3cCntlrSetAddrDev(cntlr, addr, device);
+    I3cCntlrUnlock(cntlr);
 
-    for (count = 0; count <= I3C_ADDR_MAX; count++) {
-        status = (enum I3cAddrStatus)GetAddrStatus(cntlr, count);
-        if (status == I3C_ADDR_FREE) {
-            return (int32_t)count;
+    return HDF_SUCCESS;
+}
+
+/* claim the lowest free address for a device, one find-first-set per bitmap word */
+static int32_t I3cCntlrAllocAddr(struct I3cCntlr *cntlr, struct I3cDevice *device, enum I3cAddrStatus status)
+{
+    uint16_t word;
+    uint16_t addr;
+    int32_t ret;
+
+    ret = I3cCntlrLock(cntlr);
+    if (ret != HDF_SUCCESS) {
+        HDF_LOGE("%s: Lock cntlr failed!", __func__);
+        return ret;
+    }
+
+    for (word = 0; word < I3C_ADDR_BITMAP_WORDS; word++) {
+        if (cntlr->addrFree[word] == 0) {
+            continue;
         }
+        addr = word * BITS_PER_UINT32 + I3cLowBit(cntlr->addrFree[word]);
+        SetAddrStatusLocked(cntlr, addr, status);
+        I3cCntlrSetAddrDev(cntlr, addr, device);
+        I3cCntlrUnlock(cntlr);
+        return (int32_t)addr;
     }
     I3cCntlrUnlock(cntlr);
     HDF_LOGE("%s: No free addresses left!", __func__);
@@ -164,6 +216,19 @@ static int32_t GetFreeAddr(struct I3cCntlr *cntlr)
     return HDF_FAILURE;
 }
 
+static void I3cCntlrReleaseAddr(struct I3cCntlr *cntlr, uint16_t addr)
+{
+    if (addr > I3C_ADDR_MAX) {
+        return;
+    }
+    if (I3cCntlrLock(cntlr) != HDF_SUCCESS) {
+        HDF_LOGE("%s: Lock cntlr failed!", __func__);
+        return;
+    }
+    SetAddrStatusLocked(cntlr, addr, I3C_ADDR_FREE);
+    I3cCntlrUnlock(cntlr);
+}
+
 int32_t I3cCntlrSendCccCmd(struct I3cCntlr *cntlr, struct I3cCccCmd *ccc)
 {
     int32_t ret;
@@ -191,61 +256,69 @@ int32_t I3cCntlrSendCccCmd(struct I3cCntlr *cntlr, struct I3cCccCmd *ccc)
 
 struct I3cDevice *GetDeviceByAddr(struct I3cCntlr *cntlr, uint16_t addr)
 {
-    struct DListHead *head = NULL;
-    struct I3cDevice *pos = NULL;
-    struct I3cDevice *tmp = NULL;
-    enum I3cAddrStatus addrStatus;
+    uint32_t flags;
+    struct I3cDevice *device = NULL;
 
+    if (cntlr == NULL) {
+        HDF_LOGE("%s: cntlr is NULL!", __func__);
+        return NULL;
+    }
     if (addr > I3C_ADDR_MAX) {
         HDF_LOGE("%s: The address 0x%x exceeds the maximum address", __func__, addr);
         return NULL;
     }
-    addrStatus = GetAddrStatus(cntlr, addr);
-    if (addrStatus == I3C_ADDR_FREE) {
-        HDF_LOGE("%s: The addr 0x%x is unavailable", __func__, addr);
-        return NULL;
+
+    /*
+     * Not under the controller lock: the IBI handler looks devices up from interrupt context,
+     * while I3cCntlrTransfer holds that lock across the whole transfer. The reference taken under
+     * addrLock keeps I3cDeviceRemove from returning, and the device from being freed, until it is put.
+     */
+    (void)OsalSpinLockIrqSave(&cntlr->addrLock, &flags);
+    device = cntlr->addrDev[addr];
+    if (device != NULL) {
+        OsalAtomicInc(&device->refs);
     }
-    if (addrStatus == I3C_ADDR_RESERVED) {
-        HDF_LOGE("%s: The addr 0x%x is reserved", __func__, addr);
-        return NULL;
+    (void)OsalSpinUnlockIrqRestore(&cntlr->addrLock, &flags);
+    if (device == NULL) {
+        HDF_LOGE("%s: No such device found! addr: 0x%x", __func__, addr);
     }
+    return device;
+}
 
-    if (addrStatus == I3C_ADDR_I2C_DEVICE || addrStatus == I3C_ADDR_I3C_DEVICE) {
-        head = I3cDeviceListGet();
-        DLIST_FOR_EACH_ENTRY_SAFE(pos, tmp, head, struct I3cDevice, list) {
-            if ((pos->dynaAddr == addr) && (pos->cntlr == cntlr)) {
-                I3cDeviceListPut();
-                HDF_LOGI("%s: found by dynaAddr,done!", __func__);
-                return pos;
-            } else if ((!pos->dynaAddr) && (pos->addr == addr) && (pos->cntlr == cntlr)) {
-                HDF_LOGI("%s: found by Addr,done!", __func__);
-                I3cDeviceListPut();
-                return pos;
-            }
-        }
+void I3cDevicePut(struct I3cDevice *device)
+{
+    if (device == NULL) {
+        return;
+    }
+    if (OsalAtomicDecReturn(&device->refs) == 0) {
+        (void)OsalSemPost(&device->released);
     }
-    HDF_LOGE("%s: No such device found! addr: 0x%x", __func__, addr);
+}
 
-    return NULL;
+/* frees the address of a device, then waits until the lookups that still hold it put it */
+static void I3cDeviceRelease(struct I3cDevice *device)
+{
+    I3cCntlrReleaseAddr(device->cntlr, I3cDeviceGetAddr(device));
+    if (OsalAtomicDecReturn(&device->refs) != 0) {
+        (void)OsalSemWait(&device->released, HDF_WAIT_FOREVER);
+    }
+    (void)OsalSemDestroy(&device->released);
 }
 
 static int32_t I3cDeviceDefineI3cDevices(struct I3cDevice *device)
 {
-    int32_t ret, addr;
+    int32_t addr;
 
-    ret = SetAddrStatus(device->cntlr, device->addr, I3C_ADDR_I3C_DEVICE);
-    if (ret != HDF_SUCCESS) {
-        addr = GetFreeAddr(device->cntlr);
-        if (addr <= 0) {
-            HDF_LOGE("%s: No free addresses left!", __func__);
-            return HDF_ERR_DEVICE_BUSY;
-        }
-        ret = SetAddrStatus(device->cntlr, (uint16_t)addr, I3C_ADDR_I3C_DEVICE);
-        if (ret != HDF_SUCCESS) {
-            HDF_LOGE("%s: Add I3C device failed!", __func__);
-            return ret;
-        }
+    if (I3cCntlrClaimAddr(device->cntlr, I3cDeviceGetAddr(device), device, I3C_ADDR_I3C_DEVICE) == HDF_SUCCESS) {
+        return HDF_SUCCESS;
+    }
+
+    addr = I3cCntlrAllocAddr(device->cntlr, device, I3C_ADDR_I3C_DEVICE);
+    if (addr <= 0) {
+        HDF_LOGE("%s: No free addresses left!", __func__);
+        return HDF_ERR_DEVICE_BUSY;
     }
+    device->dynaAddr = (uint16_t)addr;
 
     return HDF_SUCCESS;
 }
@@ -257,57 +330,58 @@ int32_t I3cDeviceAdd(struct I3cDevice *device)
     struct I3cDevice *tmp = NULL;
     int32_t ret;
 
-    if ((device == NULL) || (GetAddrStatus(device->cntlr, device->addr) != I3C_ADDR_FREE)) {
-        HDF_LOGE("%s: device or addr is unavailable", __func__);
+    if (device == NULL || device->cntlr == NULL) {
+        HDF_LOGE("%s: device or cntlr is unavailable", __func__);
         return HDF_ERR_INVALID_OBJECT;
     }
+    if (OsalSemInit(&device->released, 0) != HDF_SUCCESS) {
+        HDF_LOGE("%s: init sem fail!", __func__);
+        return HDF_FAILURE;
+    }
+    OsalAtomicSet(&device->refs, 1);
     if (device->type == I3C_CNTLR_I2C_DEVICE || device->type == I3C_CNTLR_I2C_LEGACY_DEVICE) {
-        ret = SetAddrStatus(device->cntlr, device->addr, I3C_ADDR_I2C_DEVICE);
+        ret = I3cCntlrClaimAddr(device->cntlr, device->addr, device, I3C_ADDR_I2C_DEVICE);
         if (ret != HDF_SUCCESS) {
-            HDF_LOGE("%s: Add I2C device failed!", __func__);
-            return ret;
+            HDF_LOGE("%s: Add I2C device failed, addr 0x%x is unavailable!", __func__, device->addr);
+            (void)OsalSemDestroy(&device->released);
+            return HDF_ERR_INVALID_OBJECT;
         }
     } else {
         ret = I3cDeviceDefineI3cDevices(device);
         if (ret != HDF_SUCCESS) {
             HDF_LOGE("%s: I3c DEFSLVS error!", __func__);
+            (void)OsalSemDestroy(&device->released);
             return ret;
         }
     }
     head = I3cDeviceListGet();
     DLIST_FOR_EACH_ENTRY_SAFE(pos, tmp, head, struct I3cDevice, list) {
-        if (pos == NULL) { // empty list
-            break;
-        }
         if ((pos->pid == device->pid) && (pos->cntlr == device->cntlr)) {
             I3cDeviceListPut();
             HDF_LOGE("%s: device already existed!: 0x%llx", __func__, device->pid);
-            (void)SetAddrStatus(device->cntlr, device->addr, I3C_ADDR_RESERVED);
+            I3cDeviceRelease(device);
+            device->dynaAddr = 0;
             return HDF_ERR_IO;
         }
     }
     DListHeadInit(&device->list);
     DListInsertTail(&device->list, head);
     I3cDeviceListPut();
-    HDF_LOGI("%s: done!", __func__);
+    HDF_LOGD("%s: device added at 0x%x", __func__, I3cDeviceGetAddr(device));
 
     return HDF_SUCCESS;
 }
 
 void I3cDeviceRemove(struct I3cDevice *device)
 {
-    int32_t ret;
-    if (device == NULL) {
+    if (device == NULL || device->cntlr == NULL) {
         return;
     }
 
-    ret = SetAddrStatus(device->cntlr, device->addr, I3C_ADDR_RESERVED); 
-    if (ret != HDF_SUCCESS) {
-        return;
-    }
     (void)I3cDeviceListGet();
     DListRemove(&device->list);
     I3cDeviceListPut();
+    I3cDeviceRelease(device);
 }
 
 static int32_t I3cManagerAddCntlr(struct I3cCntlr *cntlr)
@@ -421,10 +495,16 @@ int32_t I3cCntlrAdd(struct I3cCntlr *cntlr)
         HDF_LOGE("%s: init lock fail!", __func__);
         return HDF_FAILURE;
     }
+    if (OsalSpinInit(&cntlr->addrLock) != HDF_SUCCESS) {
+        HDF_LOGE("%s: init addr lock fail!", __func__);
+        (void)OsalSpinDestroy(&cntlr->lock);
+        return HDF_FAILURE;
+    }
 
     I3cInitAddrStatus(cntlr);
     ret = I3cManagerAddCntlr(cntlr);
     if (ret != HDF_SUCCESS) {
+        (void)OsalSpinDestroy(&cntlr->addrLock);
         (void)OsalSpinDestroy(&cntlr->lock);
         return ret;
     }
@@ -438,6 +518,7 @@ void I3cCntlrRemove(struct I3cCntlr *cntlr)
         return;
     }
     I3cManagerRemoveCntlr(cntlr);
+    (void)OsalSpinDestroy(&cntlr->addrLock);
     (void)OsalSpinDestroy(&cntlr->lock);
 }
 
@@ -577,10 +658,12 @@ int32_t I3cCntlrRequestIbi(struct I3cCntlr *cntlr, uint16_t addr, I3cIbiFunc fun
     }
     if (device->supportIbi != I3C_DEVICE_SUPPORT_IBI) {
         HDF_LOGE("%s: not support!", __func__);
+        I3cDevicePut(device);
         return HDF_ERR_NOT_SUPPORT;
     }
     if (I3cCntlrLock(cntlr) != HDF_SUCCESS) {
         HDF_LOGE("%s: lock controller fail!", __func__);
+        I3cDevicePut(device);
         return HDF_ERR_DEVICE_BUSY;
     }
 
@@ -590,6 +673,8 @@ int32_t I3cCntlrRequestIbi(struct I3cCntlr *cntlr, uint16_t addr, I3cIbiFunc fun
         }
         ibi = (struct I3cIbiInfo *)OsalMemCalloc(sizeof(*ibi));
         if (ibi == NULL) {
+            I3cCntlrUnlock(cntlr);
+            I3cDevicePut(device);
             HDF_LOGE("func:%s ibi is NULL!", __func__);
             return HDF_ERR_MALLOC_FAIL;
         }
@@ -600,9 +685,11 @@ int32_t I3cCntlrRequestIbi(struct I3cCntlr *cntlr, uint16_t addr, I3cIbiFunc fun
         cntlr->ibiSlot[ptr] = device->ibi;
         ret = cntlr->ops->requestIbi(device);
         I3cCntlrUnlock(cntlr);
+        I3cDevicePut(device);
         return ret;
     }
     I3cCntlrUnlock(cntlr);
+    I3cDevicePut(device);
 
     return HDF_ERR_DEVICE_BUSY;
 }
@@ -627,12 +714,14 @@ int32_t I3cCntlrFreeIbi(struct I3cCntlr *cntlr, uint16_t addr)
         return HDF_ERR_INVALID_OBJECT;
     }
 
+    if (device->ibi == NULL) {
+        I3cDevicePut(device);
+        return HDF_SUCCESS;
+    }
+
     for (ptr = 0; ptr < I3C_IBI_MAX; ptr++) {
-        if (cntlr->ibiSlot[ptr] == NULL || device->ibi == NULL) {
-            break;
-        }
         if (cntlr->ibiSlot[ptr] != device->ibi) {
-            break;
+            continue;
         }
         cntlr->ibiSlot[ptr] = NULL;
         if (device->ibi->data != NULL) {
@@ -642,40 +731,29 @@ int32_t I3cCntlrFreeIbi(struct I3cCntlr *cntlr, uint16_t addr)
         device->ibi = NULL;
         break;
     }
+    I3cDevicePut(device);
 
     return HDF_SUCCESS;
 }
 
 int32_t I3cCntlrIbiCallback(struct I3cDevice *device)
 {
-    struct I3cIbiData *ibiData = NULL;
+    struct I3cIbiData ibiData;
 
     if (device == NULL) {
-            HDF_LOGW("%s: invalid device!", __func__);
-            return HDF_ERR_INVALID_PARAM;
-    }
-
-    ibiData = (struct I3cIbiData *)OsalMemCalloc(sizeof(*ibiData));
-    if (ibiData == NULL) {
-        HDF_LOGE("%s: Memcalloc failed", __func__);
-        return HDF_ERR_MALLOC_FAIL;
+        HDF_LOGW("%s: invalid device!", __func__);
+        return HDF_ERR_INVALID_PARAM;
     }
 
-    ibiData->buf = device->ibi->data;
-    ibiData->payload = device->ibi->payload;
-
-    if (device->ibi->ibiFunc == NULL) {
+    if (device->ibi == NULL || device->ibi->ibiFunc == NULL) {
         HDF_LOGW("%s: device->ibi or ibiFunc is NULL!", __func__);
         return HDF_ERR_NOT_SUPPORT;
     }
 
-    if (device->dynaAddr != 0) {
-        (void)device->ibi->ibiFunc(device->cntlr, device->dynaAddr, *ibiData);
-        OsalMemFree(ibiData);
-    } else {
-        (void)device->ibi->ibiFunc(device->cntlr, device->addr, *ibiData);
-        OsalMemFree(ibiData);
-    }
+    // the data is passed by value, no need to allocate it on every interrupt
+    ibiData.buf = device->ibi->data;
+    ibiData.payload = device->ibi->payload;
+    (void)device->ibi->ibiFunc(device->cntlr, I3cDeviceGetAddr(device), ibiData);
 
     return HDF_SUCCESS;
 }
@@ -12,6 +12,8 @@
 #include "osal_time.h"
 
 #define HDF_LOG_TAG mipi_dsi_core
+#define MIPI_DSI_HR_WAIT_MAX_MS 20
+#define MIPI_DSI_MS_TO_US       1000
 
 struct MipiDsiHandle {
     struct MipiDsiCntlr *cntlr;
@@ -270,6 +272,62 @@ int32_t MipiDsiCntlrTx(struct MipiDsiCntlr *cntlr, struct DsiCmdDesc *cmd)
     return ret;
 }
 
+static void MipiDsiCmdWait(uint16_t delay)
+{
+    /* tick based sleeps overshoot short waits by up to a tick, use the high resolution sleep there */
+    if (delay == 0) {
+        return;
+    }
+    if (delay <= MIPI_DSI_HR_WAIT_MAX_MS) {
+        OsalUSleep((uint32_t)delay * MIPI_DSI_MS_TO_US);
+    } else {
+        OsalMSleep(delay);
+    }
+}
+
+int32_t MipiDsiCntlrTxBatch(struct MipiDsiCntlr *cntlr, struct DsiCmdDesc *cmds, uint32_t count)
+{
+    int32_t ret = HDF_SUCCESS;
+    uint32_t i;
+
+    if ((cntlr == NULL) || (cntlr->ops == NULL)) {
+        HDF_LOGE("%s: cntlr or ops is NULL.", __func__);
+        return HDF_ERR_INVALID_OBJECT;
+    }
+    if ((cmds == NULL) || (count == 0)) {
+        HDF_LOGE("%s: cmds is NULL or count is 0.", __func__);
+        return HDF_ERR_INVALID_OBJECT;
+    }
+
+    if ((cntlr->ops->setCmdBatch == NULL) && (cntlr->ops->setCmd == NULL)) {
+        HDF_LOGE("%s: setCmdBatch and setCmd are NULL.", __func__);
+        return HDF_ERR_NOT_SUPPORT;
+    }
+
+    (void)OsalMutexLock(&(cntlr->lock));
+    if (cntlr->ops->setCmdBatch != NULL) {
+        ret = cntlr->ops->setCmdBatch(cntlr, cmds, count);
+    } else {
+        for (i = 0; i < count; i++) {
+            ret = cntlr->ops->setCmd(cntlr, &cmds[i]);
+            if (ret != HDF_SUCCESS) {
+                HDF_LOGE("%s: cmd[%u] failed, ret %d", __func__, i, ret);
+                break;
+            }
+            MipiDsiCmdWait(cmds[i].delay);
+        }
+    }
+    (void)OsalMutexUnlock(&(cntlr->lock));
+
+    if (ret == HDF_SUCCESS) {
+        HDF_LOGI("%s: %u cmds success!", __func__, count);
+    } else {
+        HDF_LOGE("%s: failed!", __func__);
+    }
+
+    return ret;
+}
+
 int32_t MipiDsiCntlrRx(struct MipiDsiCntlr *cntlr, struct DsiCmdDesc *cmd, int32_t readLen, uint8_t *out)
 {
     int32_t ret;
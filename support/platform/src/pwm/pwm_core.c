@@ -8,11 +8,19 @@
 
 #include "pwm_core.h"
 #include "hdf_log.h"
+#include "osal_atomic.h"
 #include "osal_mem.h"
+#include "osal_sem.h"
+#include "osal_thread.h"
+#include "osal_time.h"
 #include "securec.h"
 
 #define HDF_LOG_TAG pwm_core
 #define PWM_NAME_LEN 32
+#define PWM_SEQ_NAME_LEN 16
+#define PWM_SEQ_STACK_SIZE 0x2000
+#define PWM_USEC_PER_SEC 1000000
+#define PWM_USEC_PER_MSEC 1000
 
 static struct PwmDev *PwmGetDevByNum(uint32_t num)
 {
@@ -73,6 +81,11 @@ void PwmClose(DevHandle handle)
         return;
     }
 
+    ret = PwmStopSequence(handle);
+    if (ret != HDF_SUCCESS) {
+        HDF_LOGE("%s: stop sequence failed, ret %d", __func__, ret);
+        return;
+    }
     if (pwm->method != NULL && pwm->method->close != NULL) {
         ret = pwm->method->close(pwm);
         if (ret != HDF_SUCCESS) {
@@ -85,6 +98,16 @@ void PwmClose(DevHandle handle)
     (void)OsalSpinUnlock(&(pwm->lock));
 }
 
+static bool PwmIsPlaying(struct PwmDev *pwm)
+{
+    bool playing;
+
+    (void)OsalSpinLock(&(pwm->lock));
+    playing = (pwm->seq != NULL);
+    (void)OsalSpinUnlock(&(pwm->lock));
+    return playing;
+}
+
 int32_t PwmSetConfig(DevHandle handle, struct PwmConfig *config)
 {
     int32_t ret;
@@ -100,6 +123,10 @@ int32_t PwmSetConfig(DevHandle handle, struct PwmConfig *config)
         return HDF_ERR_INVALID_PARAM;
     }
     pwm = (struct PwmDev *)handle;
+    if (PwmIsPlaying(pwm)) {
+        HDF_LOGE("%s: pwm%u is playing a sequence", __func__, pwm->num);
+        return HDF_ERR_DEVICE_BUSY;
+    }
     if (memcmp(config, &(pwm->cfg), sizeof(*config)) == 0) {
         HDF_LOGE("%s: do not need to set config", __func__);
         return HDF_SUCCESS;
@@ -236,6 +263,380 @@ int32_t PwmSetPolarity(DevHandle handle, uint8_t polarity)
     return ret;
 }
 
+struct PwmSequencer {
+    struct PwmDev *pwms[PWM_GROUP_MAX];
+    struct PwmConfig cfgs[PWM_GROUP_MAX];
+    uint32_t count;
+    uint32_t *duty;
+    uint32_t steps;
+    uint32_t stepUs;
+    uint32_t loops;
+    uint32_t played;    /* steps applied */
+    uint32_t missed;    /* steps skipped for being late */
+    uint32_t errors;    /* steps the controller failed to apply */
+    bool stop;
+    bool stopping;
+    OsalAtomic refs;            /* the stopper and the callers waiting for it to finish */
+    struct OsalThread thread;
+    struct OsalSem exited;
+    struct OsalSem stopped;     /* posted once for each caller waiting for the stop */
+    char name[PWM_SEQ_NAME_LEN];
+};
+
+/*
+ * Applies the configs of a group through setConfigGroup when the controller has it, otherwise one
+ * device at a time, restoring the devices already set if one of them fails.
+ */
+static int32_t PwmApplyGroup(struct PwmDev **pwms, struct PwmConfig *configs, uint32_t count)
+{
+    int32_t ret;
+    uint32_t i;
+    struct PwmMethod *method = pwms[0]->method;
+
+    if (method->setConfigGroup != NULL) {
+        for (i = 1; i < count && pwms[i]->method == method; i++) {
+        }
+        ret = (i == count) ? method->setConfigGroup(pwms, configs, count) : HDF_ERR_NOT_SUPPORT;
+        if (ret != HDF_ERR_NOT_SUPPORT) {
+            for (i = 0; ret == HDF_SUCCESS && i < count; i++) {
+                pwms[i]->cfg = configs[i];
+            }
+            return ret;
+        }
+    }
+
+    for (i = 0; i < count; i++) {
+        if (memcmp(&configs[i], &(pwms[i]->cfg), sizeof(configs[i])) == 0) {
+            continue;
+        }
+        ret = pwms[i]->method->setConfig(pwms[i], &configs[i]);
+        if (ret == HDF_SUCCESS) {
+            continue;
+        }
+        HDF_LOGE("%s: set pwm%u failed, ret %d", __func__, pwms[i]->num, ret);
+        while (i-- > 0) {
+            if (memcmp(&configs[i], &(pwms[i]->cfg), sizeof(configs[i])) != 0) {
+                (void)pwms[i]->method->setConfig(pwms[i], &(pwms[i]->cfg));
+            }
+        }
+        return ret;
+    }
+    for (i = 0; i < count; i++) {
+        pwms[i]->cfg = configs[i];
+    }
+    return HDF_SUCCESS;
+}
+
+static int32_t PwmGetGroup(DevHandle *handles, uint32_t count, struct PwmDev **pwms)
+{
+    uint32_t i;
+    uint32_t j;
+
+    if (handles == NULL || count == 0 || count > PWM_GROUP_MAX) {
+        HDF_LOGE("%s: invalid handles or count %u", __func__, count);
+        return HDF_ERR_INVALID_PARAM;
+    }
+    for (i = 0; i < count; i++) {
+        pwms[i] = (struct PwmDev *)handles[i];
+        if (pwms[i] == NULL || pwms[i]->method == NULL || pwms[i]->method->setConfig == NULL) {
+            HDF_LOGE("%s: handle %u is invalid", __func__, i);
+            return HDF_ERR_INVALID_OBJECT;
+        }
+        for (j = 0; j < i; j++) {
+            if (pwms[j] == pwms[i]) {
+                HDF_LOGE("%s: pwm%u is in the group twice", __func__, pwms[i]->num);
+                return HDF_ERR_INVALID_PARAM;
+            }
+        }
+    }
+    return HDF_SUCCESS;
+}
+
+int32_t PwmSetConfigGroup(DevHandle *handles, const struct PwmConfig *configs, uint32_t count)
+{
+    int32_t ret;
+    uint32_t i;
+    struct PwmDev *pwms[PWM_GROUP_MAX];
+    struct PwmConfig cfgs[PWM_GROUP_MAX];
+
+    if (configs == NULL) {
+        HDF_LOGE("%s: configs is NULL", __func__);
+        return HDF_ERR_INVALID_PARAM;
+    }
+    ret = PwmGetGroup(handles, count, pwms);
+    if (ret != HDF_SUCCESS) {
+        return ret;
+    }
+    for (i = 0; i < count; i++) {
+        if (PwmIsPlaying(pwms[i])) {
+            HDF_LOGE("%s: pwm%u is playing a sequence", __func__, pwms[i]->num);
+            return HDF_ERR_DEVICE_BUSY;
+        }
+        cfgs[i] = configs[i];
+    }
+    return PwmApplyGroup(pwms, cfgs, count);
+}
+
+static void PwmSequencerSleep(uint64_t us)
+{
+    if (us >= PWM_USEC_PER_MSEC) {
+        OsalMSleep((uint32_t)(us / PWM_USEC_PER_MSEC));
+    } else {
+        OsalUSleep((uint32_t)us);
+    }
+}
+
+static uint64_t PwmSequencerElapsedUs(const OsalTimespec *start)
+{
+    OsalTimespec now = {0, 0};
+    OsalTimespec diff = {0, 0};
+
+    (void)OsalGetTime(&now);
+    (void)OsalDiffTime(start, &now, &diff);
+    return (uint64_t)diff.sec * PWM_USEC_PER_SEC + diff.usec;
+}
+
+static int PwmSequencerWorker(void *data)
+{
+    struct PwmSequencer *seq = (struct PwmSequencer *)data;
+    uint64_t total = (uint64_t)seq->steps * seq->loops;
+    uint64_t step = 0;
+    uint64_t elapsedUs;
+    uint64_t dueUs;
+    uint32_t row;
+    uint32_t i;
+    OsalTimespec start = {0, 0};
+
+    (void)OsalGetTime(&start);
+    while (!seq->stop && (total == 0 || step < total)) {
+        row = (uint32_t)(step % seq->steps);
+        for (i = 0; i < seq->count; i++) {
+            seq->cfgs[i].duty = seq->duty[row * seq->count + i];
+        }
+        if (PwmApplyGroup(seq->pwms, seq->cfgs, seq->count) != HDF_SUCCESS) {
+            seq->errors++;
+        }
+        seq->played++;
+        step++;
+
+        /* steps are due at fixed offsets from the start, so a late wakeup does not shift the ones after it */
+        elapsedUs = PwmSequencerElapsedUs(&start);
+        if (elapsedUs / seq->stepUs > step) {
+            seq->missed += (uint32_t)(elapsedUs / seq->stepUs - step);
+            step = elapsedUs / seq->stepUs;
+        }
+        /* a millisecond sleep drops the rest below a millisecond, so check again until the step is due */
+        dueUs = step * seq->stepUs;
+        while (!seq->stop && (elapsedUs = PwmSequencerElapsedUs(&start)) < dueUs) {
+            PwmSequencerSleep(dueUs - elapsedUs);
+        }
+    }
+    (void)OsalSemPost(&seq->exited);
+    return HDF_SUCCESS;
+}
+
+static void PwmSequencerFree(struct PwmSequencer *seq)
+{
+    (void)OsalSemDestroy(&seq->stopped);
+    (void)OsalSemDestroy(&seq->exited);
+    OsalMemFree(seq->duty);
+    OsalMemFree(seq);
+}
+
+static struct PwmSequencer *PwmSequencerCreate(struct PwmDev **pwms, uint32_t count, const struct PwmSequence *seq)
+{
+    uint32_t i;
+    uint32_t row;
+    struct PwmSequencer *sequencer = NULL;
+
+    for (row = 0; row < seq->steps; row++) {
+        for (i = 0; i < count; i++) {
+            if (seq->duty[row * count + i] > pwms[i]->cfg.period) {
+                HDF_LOGE("%s: step %u duty %u exceeds period %u of pwm%u", __func__, row,
+                    seq->duty[row * count + i], pwms[i]->cfg.period, pwms[i]->num);
+                return NULL;
+            }
+        }
+    }
+
+    sequencer = (struct PwmSequencer *)OsalMemCalloc(sizeof(*sequencer));
+    if (sequencer == NULL) {
+        return NULL;
+    }
+    sequencer->duty = (uint32_t *)OsalMemCalloc(sizeof(*sequencer->duty) * seq->steps * count);
+    if (sequencer->duty == NULL || OsalSemInit(&sequencer->exited, 0) != HDF_SUCCESS) {
+        OsalMemFree(sequencer->duty);
+        OsalMemFree(sequencer);
+        return NULL;
+    }
+    if (OsalSemInit(&sequencer->stopped, 0) != HDF_SUCCESS) {
+        (void)OsalSemDestroy(&sequencer->exited);
+        OsalMemFree(sequencer->duty);
+        OsalMemFree(sequencer);
+        return NULL;
+    }
+    OsalAtomicSet(&sequencer->refs, 1);
+    (void)memcpy_s(sequencer->duty, sizeof(*sequencer->duty) * seq->steps * count,
+        seq->duty, sizeof(*seq->duty) * seq->steps * count);
+    for (i = 0; i < count; i++) {
+        sequencer->pwms[i] = pwms[i];
+        sequencer->cfgs[i] = pwms[i]->cfg;
+    }
+    sequencer->count = count;
+    sequencer->steps = seq->steps;
+    sequencer->stepUs = seq->stepUs;
+    sequencer->loops = seq->loops;
+    return sequencer;
+}
+
+/* the first count devices of the group stop pointing at the sequencer */
+static void PwmSequencerRelease(struct PwmSequencer *seq, uint32_t count)
+{
+    uint32_t i;
+
+    for (i = 0; i < count; i++) {
+        (void)OsalSpinLock(&(seq->pwms[i]->lock));
+        seq->pwms[i]->seq = NULL;
+        (void)OsalSpinUnlock(&(seq->pwms[i]->lock));
+    }
+}
+
+static int32_t PwmSequencerClaim(struct PwmSequencer *seq)
+{
+    uint32_t i;
+    bool busy = false;
+
+    for (i = 0; i < seq->count && !busy; i++) {
+        (void)OsalSpinLock(&(seq->pwms[i]->lock));
+        busy = (seq->pwms[i]->seq != NULL);
+        if (!busy) {
+            seq->pwms[i]->seq = seq;
+        }
+        (void)OsalSpinUnlock(&(seq->pwms[i]->lock));
+    }
+    if (busy) {
+        HDF_LOGE("%s: pwm%u is playing a sequence", __func__, seq->pwms[i - 1]->num);
+        PwmSequencerRelease(seq, i - 1);
+        return HDF_ERR_DEVICE_BUSY;
+    }
+    return HDF_SUCCESS;
+}
+
+int32_t PwmStartSequence(DevHandle *handles, uint32_t count, const struct PwmSequence *seq)
+{
+    int32_t ret;
+    struct PwmDev *pwms[PWM_GROUP_MAX];
+    struct PwmSequencer *sequencer = NULL;
+    struct OsalThreadParam param;
+
+    if (seq == NULL || seq->duty == NULL || seq->steps == 0 || seq->steps > PWM_SEQUENCE_STEPS_MAX ||
+        seq->stepUs == 0 || seq->stepUs > PWM_SEQUENCE_STEP_US_MAX) {
+        HDF_LOGE("%s: invalid sequence", __func__);
+        return HDF_ERR_INVALID_PARAM;
+    }
+    ret = PwmGetGroup(handles, count, pwms);
+    if (ret != HDF_SUCCESS) {
+        return ret;
+    }
+    sequencer = PwmSequencerCreate(pwms, count, seq);
+    if (sequencer == NULL) {
+        return HDF_FAILURE;
+    }
+    ret = PwmSequencerClaim(sequencer);
+    if (ret != HDF_SUCCESS) {
+        PwmSequencerFree(sequencer);
+        return ret;
+    }
+
+    ret = OsalThreadCreate(&sequencer->thread, PwmSequencerWorker, sequencer);
+    if (ret != HDF_SUCCESS) {
+        HDF_LOGE("%s: create thread failed, ret %d", __func__, ret);
+        PwmSequencerRelease(sequencer, count);
+        PwmSequencerFree(sequencer);
+        return ret;
+    }
+    (void)snprintf_s(sequencer->name, sizeof(sequencer->name), sizeof(sequencer->name) - 1,
+        "pwm_seq_%u", pwms[0]->num);
+    (void)memset_s(&param, sizeof(param), 0, sizeof(param));
+    param.name = sequencer->name;
+    param.priority = OSAL_THREAD_PRI_HIGH;
+    param.stackSize = PWM_SEQ_STACK_SIZE;
+    ret = OsalThreadStart(&sequencer->thread, &param);
+    if (ret != HDF_SUCCESS) {
+        HDF_LOGE("%s: start thread failed, ret %d", __func__, ret);
+        (void)OsalThreadDestroy(&sequencer->thread);
+        PwmSequencerRelease(sequencer, count);
+        PwmSequencerFree(sequencer);
+    }
+    return ret;
+}
+
+/* the last of the stopper and its waiters frees the sequencer */
+static void PwmSequencerPut(struct PwmSequencer *seq)
+{
+    if (OsalAtomicDecReturn(&seq->refs) == 0) {
+        PwmSequencerFree(seq);
+    }
+}
+
+int32_t PwmStopSequence(DevHandle handle)
+{
+    bool stopping;
+    int32_t waiters;
+    struct PwmDev *pwm = (struct PwmDev *)handle;
+    struct PwmDev *first = NULL;
+    struct PwmSequencer *seq = NULL;
+
+    if (pwm == NULL) {
+        HDF_LOGE("%s: handle is NULL", __func__);
+        return HDF_ERR_INVALID_OBJECT;
+    }
+    /*
+     * seq is only touched under pwm->lock here: the stop that wins releases every device of the group,
+     * taking this lock too, before it drops its reference to seq. stopping and the references of the
+     * waiters are guarded by the lock of the first device, which is only ever taken inside the lock of
+     * another device, never the other way round.
+     */
+    (void)OsalSpinLock(&(pwm->lock));
+    seq = pwm->seq;
+    if (seq == NULL) {
+        (void)OsalSpinUnlock(&(pwm->lock));
+        return HDF_SUCCESS;
+    }
+    first = seq->pwms[0];
+    if (first != pwm) {
+        (void)OsalSpinLock(&(first->lock));
+    }
+    stopping = seq->stopping;
+    seq->stopping = true;
+    if (stopping) {
+        OsalAtomicInc(&seq->refs);
+    }
+    if (first != pwm) {
+        (void)OsalSpinUnlock(&(first->lock));
+    }
+    (void)OsalSpinUnlock(&(pwm->lock));
+    if (stopping) {
+        /* returning early would let a close or remove run while the worker still sets the device */
+        (void)OsalSemWait(&seq->stopped, HDF_WAIT_FOREVER);
+        PwmSequencerPut(seq);
+        return HDF_SUCCESS;
+    }
+
+    seq->stop = true;
+    (void)OsalSemWait(&seq->exited, HDF_WAIT_FOREVER);
+    (void)OsalThreadDestroy(&seq->thread);
+    PwmSequencerRelease(seq, seq->count);
+    HDF_LOGD("%s: pwm%u played %u steps, missed %u, failed %u", __func__, seq->pwms[0]->num,
+        seq->played, seq->missed, seq->errors);
+    /* no device points at seq any more, so no caller can start waiting after this */
+    for (waiters = OsalAtomicRead(&seq->refs) - 1; waiters > 0; waiters--) {
+        (void)OsalSemPost(&seq->stopped);
+    }
+    PwmSequencerPut(seq);
+    return HDF_SUCCESS;
+}
+
 int32_t PwmSetPriv(struct PwmDev *pwm, void *priv)
 {
     if (pwm == NULL) {
@@ -280,6 +681,10 @@ void PwmDeviceRemove(struct HdfDeviceObject *obj, struct PwmDev *pwm)
         HDF_LOGE("%s: invalid parameter", __func__);
         return;
     }
+    /* waits for a stop already running elsewhere, which still takes pwm->lock */
+    if (PwmStopSequence((DevHandle)pwm) != HDF_SUCCESS) {
+        HDF_LOGE("%s: stop sequence of pwm%u failed", __func__, pwm->num);
+    }
     (void)OsalSpinDestroy(&(pwm->lock));
     pwm->device = NULL;
     obj->service = NULL;
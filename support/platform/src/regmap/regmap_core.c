@@ -0,0 +1,404 @@
+/*
+ * Copyright (c) 2021 Huawei Device Co., Ltd.
+ *
+ * HDF is dual licensed: you can use it either under the terms of
+ * the GPL, or the BSD license, at your option.
+ * See the LICENSE file in the root of this repository for complete details.
+ */
+
+#include "regmap_core.h"
+#include "hdf_log.h"
+#include "i2c_if.h"
+#include "osal_mem.h"
+#include "securec.h"
+#include "spi_if.h"
+
+#define HDF_LOG_TAG regmap_core
+
+#define REGMAP_BITS_PER_BYTE 8
+#define REGMAP_I2C_MSG_NUM   2
+#define REGMAP_SPI_MSG_NUM   2
+
+static inline bool RegmapBitTest(const uint8_t *map, uint32_t bit)
+{
+    return (map[bit / REGMAP_BITS_PER_BYTE] & (1 << (bit % REGMAP_BITS_PER_BYTE))) != 0;
+}
+
+static inline void RegmapBitSet(uint8_t *map, uint32_t bit)
+{
+    map[bit / REGMAP_BITS_PER_BYTE] |= (uint8_t)(1 << (bit % REGMAP_BITS_PER_BYTE));
+}
+
+static inline void RegmapBitClear(uint8_t *map, uint32_t bit)
+{
+    map[bit / REGMAP_BITS_PER_BYTE] &= (uint8_t)~(1 << (bit % REGMAP_BITS_PER_BYTE));
+}
+
+static inline uint32_t RegmapBitmapSize(const struct RegmapConfig *config)
+{
+    return (config->maxReg + REGMAP_BITS_PER_BYTE) / REGMAP_BITS_PER_BYTE;
+}
+
+static bool RegmapIsVolatile(const struct Regmap *map, uint32_t reg)
+{
+    uint32_t i;
+    const struct RegmapConfig *config = map->config;
+
+    for (i = 0; i < config->volatileNum; i++) {
+        if (reg >= config->volatileRanges[i].min && reg <= config->volatileRanges[i].max) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/* msb first, returns the bytes used */
+static uint32_t RegmapFormat(uint8_t *buf, uint32_t value, uint8_t bytes)
+{
+    uint8_t i;
+
+    for (i = 0; i < bytes; i++) {
+        buf[i] = (uint8_t)(value >> ((bytes - 1 - i) * REGMAP_BITS_PER_BYTE));
+    }
+    return bytes;
+}
+
+static uint32_t RegmapParse(const uint8_t *buf, uint8_t bytes)
+{
+    uint8_t i;
+    uint32_t value = 0;
+
+    for (i = 0; i < bytes; i++) {
+        value = (value << REGMAP_BITS_PER_BYTE) | buf[i];
+    }
+    return value;
+}
+
+static int32_t RegmapBusRead(struct Regmap *map, uint32_t reg, uint32_t *vals, uint32_t count)
+{
+    int32_t ret;
+    uint32_t i;
+    uint8_t regBytes = map->config->regBytes;
+    uint8_t valBytes = map->config->valBytes;
+    uint8_t *data = map->buf + regBytes;
+
+    (void)RegmapFormat(map->buf, reg, regBytes);
+    if (map->busType == REGMAP_BUS_I2C) {
+        struct I2cMsg msgs[REGMAP_I2C_MSG_NUM] = {
+            { .addr = map->addr, .buf = map->buf, .len = regBytes, .flags = 0 },
+            { .addr = map->addr, .buf = data, .len = (uint16_t)(count * valBytes), .flags = I2C_FLAG_READ },
+        };
+        ret = (I2cTransfer(map->handle, msgs, REGMAP_I2C_MSG_NUM) == REGMAP_I2C_MSG_NUM) ? HDF_SUCCESS : HDF_ERR_IO;
+    } else {
+        struct SpiMsg msgs[REGMAP_SPI_MSG_NUM];
+
+        (void)memset_s(msgs, sizeof(msgs), 0, sizeof(msgs));
+        map->buf[0] |= map->config->spiReadFlag;
+        msgs[0].wbuf = map->buf;
+        msgs[0].len = regBytes;
+        msgs[1].rbuf = data;
+        msgs[1].len = count * valBytes;
+        ret = SpiTransfer(map->handle, msgs, REGMAP_SPI_MSG_NUM);
+    }
+    map->stats.busReads++;
+    if (ret != HDF_SUCCESS) {
+        HDF_LOGE("%s: read reg 0x%x count %u failed, ret %d", __func__, reg, count, ret);
+        return ret;
+    }
+
+    for (i = 0; i < count; i++) {
+        vals[i] = RegmapParse(data + i * valBytes, valBytes);
+        if (RegmapIsVolatile(map, reg + i)) {
+            continue;
+        }
+        /* a dirty register holds a write the device has not seen yet, keep it for RegmapSync */
+        if (RegmapBitTest(map->dirty, reg + i)) {
+            vals[i] = map->cache[reg + i];
+            continue;
+        }
+        map->cache[reg + i] = (uint16_t)vals[i];
+        RegmapBitSet(map->valid, reg + i);
+    }
+    return HDF_SUCCESS;
+}
+
+/* writes count registers from the cache, or val when count is 0 */
+static int32_t RegmapBusWrite(struct Regmap *map, uint32_t reg, uint32_t val, uint32_t count)
+{
+    int32_t ret;
+    uint32_t i;
+    uint32_t len;
+    uint8_t valBytes = map->config->valBytes;
+
+    len = RegmapFormat(map->buf, reg, map->config->regBytes);
+    if (count == 0) {
+        len += RegmapFormat(map->buf + len, val, valBytes);
+    }
+    for (i = 0; i < count; i++) {
+        len += RegmapFormat(map->buf + len, map->cache[reg + i], valBytes);
+    }
+
+    if (map->busType == REGMAP_BUS_I2C) {
+        struct I2cMsg msg = { .addr = map->addr, .buf = map->buf, .len = (uint16_t)len, .flags = 0 };
+        ret = (I2cTransfer(map->handle, &msg, 1) == 1) ? HDF_SUCCESS : HDF_ERR_IO;
+    } else {
+        ret = SpiWrite(map->handle, map->buf, len);
+    }
+    map->stats.busWrites++;
+    if (ret != HDF_SUCCESS) {
+        HDF_LOGE("%s: write reg 0x%x count %u failed, ret %d", __func__, reg, count, ret);
+    }
+    return ret;
+}
+
+static int32_t RegmapReadUnlocked(struct Regmap *map, uint32_t reg, uint32_t *val)
+{
+    if (!RegmapIsVolatile(map, reg) && RegmapBitTest(map->valid, reg)) {
+        map->stats.hits++;
+        *val = map->cache[reg];
+        return HDF_SUCCESS;
+    }
+    if (map->cacheOnly) {
+        return HDF_ERR_DEVICE_BUSY;
+    }
+    map->stats.misses++;
+    return RegmapBusRead(map, reg, val, 1);
+}
+
+static int32_t RegmapWriteUnlocked(struct Regmap *map, uint32_t reg, uint32_t val)
+{
+    int32_t ret;
+    bool isVolatile = RegmapIsVolatile(map, reg);
+
+    if (!isVolatile && RegmapBitTest(map->valid, reg) && map->cache[reg] == val) {
+        map->stats.skippedWrites++;
+        return HDF_SUCCESS;
+    }
+    if (map->cacheOnly) {
+        if (isVolatile) {
+            return HDF_ERR_DEVICE_BUSY;
+        }
+        map->cache[reg] = (uint16_t)val;
+        RegmapBitSet(map->valid, reg);
+        RegmapBitSet(map->dirty, reg);
+        return HDF_SUCCESS;
+    }
+
+    ret = RegmapBusWrite(map, reg, val, 0);
+    if (ret == HDF_SUCCESS && !isVolatile) {
+        map->cache[reg] = (uint16_t)val;
+        RegmapBitSet(map->valid, reg);
+        RegmapBitClear(map->dirty, reg);
+    }
+    return ret;
+}
+
+static inline bool RegmapCheckReg(const struct Regmap *map, uint32_t reg, uint32_t count)
+{
+    return map != NULL && count > 0 && count <= REGMAP_BURST_MAX && reg + count - 1 <= map->config->maxReg;
+}
+
+int32_t RegmapRead(struct Regmap *map, uint32_t reg, uint32_t *val)
+{
+    int32_t ret;
+
+    if (!RegmapCheckReg(map, reg, 1) || val == NULL) {
+        return HDF_ERR_INVALID_PARAM;
+    }
+    (void)OsalMutexLock(&map->lock);
+    ret = RegmapReadUnlocked(map, reg, val);
+    (void)OsalMutexUnlock(&map->lock);
+    return ret;
+}
+
+int32_t RegmapWrite(struct Regmap *map, uint32_t reg, uint32_t val)
+{
+    int32_t ret;
+
+    if (!RegmapCheckReg(map, reg, 1) || (val >> (map->config->valBytes * REGMAP_BITS_PER_BYTE)) != 0) {
+        return HDF_ERR_INVALID_PARAM;
+    }
+    (void)OsalMutexLock(&map->lock);
+    ret = RegmapWriteUnlocked(map, reg, val);
+    (void)OsalMutexUnlock(&map->lock);
+    return ret;
+}
+
+int32_t RegmapUpdateBits(struct Regmap *map, uint32_t reg, uint32_t mask, uint32_t val)
+{
+    int32_t ret;
+    uint32_t old;
+
+    if (!RegmapCheckReg(map, reg, 1)) {
+        return HDF_ERR_INVALID_PARAM;
+    }
+    (void)OsalMutexLock(&map->lock);
+    ret = RegmapReadUnlocked(map, reg, &old);
+    if (ret == HDF_SUCCESS) {
+        ret = RegmapWriteUnlocked(map, reg, (old & ~mask) | (val & mask));
+    }
+    (void)OsalMutexUnlock(&map->lock);
+    return ret;
+}
+
+int32_t RegmapBulkRead(struct Regmap *map, uint32_t reg, uint32_t *vals, uint32_t count)
+{
+    int32_t ret;
+    uint32_t i;
+
+    if (!RegmapCheckReg(map, reg, count) || vals == NULL) {
+        return HDF_ERR_INVALID_PARAM;
+    }
+    (void)OsalMutexLock(&map->lock);
+    for (i = 0; i < count; i++) {
+        if (RegmapIsVolatile(map, reg + i) || !RegmapBitTest(map->valid, reg + i)) {
+            break;
+        }
+        vals[i] = map->cache[reg + i];
+    }
+    if (i == count) {
+        map->stats.hits += count;
+        (void)OsalMutexUnlock(&map->lock);
+        return HDF_SUCCESS;
+    }
+    if (map->cacheOnly) {
+        (void)OsalMutexUnlock(&map->lock);
+        return HDF_ERR_DEVICE_BUSY;
+    }
+    map->stats.misses += count;
+    ret = RegmapBusRead(map, reg, vals, count);
+    (void)OsalMutexUnlock(&map->lock);
+    return ret;
+}
+
+void RegmapCacheOnly(struct Regmap *map, bool enable)
+{
+    if (map == NULL) {
+        return;
+    }
+    (void)OsalMutexLock(&map->lock);
+    map->cacheOnly = enable;
+    (void)OsalMutexUnlock(&map->lock);
+}
+
+int32_t RegmapSync(struct Regmap *map)
+{
+    int32_t ret = HDF_SUCCESS;
+    uint32_t i;
+    uint32_t reg = 0;
+    uint32_t count;
+
+    if (map == NULL) {
+        return HDF_ERR_INVALID_OBJECT;
+    }
+    (void)OsalMutexLock(&map->lock);
+    if (map->cacheOnly) {
+        (void)OsalMutexUnlock(&map->lock);
+        return HDF_ERR_DEVICE_BUSY;
+    }
+    while (reg <= map->config->maxReg) {
+        if (!RegmapBitTest(map->dirty, reg)) {
+            reg++;
+            continue;
+        }
+        /* one burst for the run of contiguous dirty registers */
+        count = 1;
+        while (count < REGMAP_BURST_MAX && reg + count <= map->config->maxReg &&
+            RegmapBitTest(map->dirty, reg + count)) {
+            count++;
+        }
+        ret = RegmapBusWrite(map, reg, 0, count);
+        if (ret != HDF_SUCCESS) {
+            break;
+        }
+        for (i = 0; i < count; i++) {
+            RegmapBitClear(map->dirty, reg + i);
+        }
+        reg += count;
+    }
+    (void)OsalMutexUnlock(&map->lock);
+    return ret;
+}
+
+void RegmapCacheDrop(struct Regmap *map)
+{
+    uint32_t size;
+
+    if (map == NULL) {
+        return;
+    }
+    size = RegmapBitmapSize(map->config);
+    (void)OsalMutexLock(&map->lock);
+    (void)memset_s(map->valid, size, 0, size);
+    (void)memset_s(map->dirty, size, 0, size);
+    (void)OsalMutexUnlock(&map->lock);
+}
+
+void RegmapGetStats(struct Regmap *map, struct RegmapStats *stats)
+{
+    if (map == NULL || stats == NULL) {
+        return;
+    }
+    (void)OsalMutexLock(&map->lock);
+    *stats = map->stats;
+    (void)OsalMutexUnlock(&map->lock);
+}
+
+static struct Regmap *RegmapCreate(enum RegmapBusType busType, DevHandle handle, const struct RegmapConfig *config)
+{
+    uint32_t regNum;
+    uint32_t bitmapSize;
+    struct Regmap *map = NULL;
+
+    if (handle == NULL || config == NULL || config->regBytes == 0 || config->regBytes > sizeof(uint16_t) ||
+        config->valBytes == 0 || config->valBytes > sizeof(uint16_t) ||
+        (config->maxReg >> (config->regBytes * REGMAP_BITS_PER_BYTE)) != 0 ||
+        (config->volatileNum > 0 && config->volatileRanges == NULL)) {
+        HDF_LOGE("%s: invalid config", __func__);
+        return NULL;
+    }
+
+    /* cache and bitmaps live behind the map in one block */
+    regNum = config->maxReg + 1;
+    bitmapSize = RegmapBitmapSize(config);
+    map = (struct Regmap *)OsalMemCalloc(sizeof(*map) + regNum * sizeof(uint16_t) + bitmapSize * 2);
+    if (map == NULL) {
+        HDF_LOGE("%s: malloc map failed, maxReg 0x%x", __func__, config->maxReg);
+        return NULL;
+    }
+    if (OsalMutexInit(&map->lock) != HDF_SUCCESS) {
+        OsalMemFree(map);
+        return NULL;
+    }
+    map->busType = busType;
+    map->handle = handle;
+    map->config = config;
+    map->cache = (uint16_t *)(map + 1);
+    map->valid = (uint8_t *)(map->cache + regNum);
+    map->dirty = map->valid + bitmapSize;
+    return map;
+}
+
+struct Regmap *RegmapInitI2c(DevHandle handle, uint16_t addr, const struct RegmapConfig *config)
+{
+    struct Regmap *map = RegmapCreate(REGMAP_BUS_I2C, handle, config);
+
+    if (map != NULL) {
+        map->addr = addr;
+    }
+    return map;
+}
+
+struct Regmap *RegmapInitSpi(DevHandle handle, const struct RegmapConfig *config)
+{
+    return RegmapCreate(REGMAP_BUS_SPI, handle, config);
+}
+
+void RegmapExit(struct Regmap *map)
+{
+    if (map == NULL) {
+        return;
+    }
+    (void)OsalMutexDestroy(&map->lock);
+    OsalMemFree(map);
+}
@@ -14,16 +14,46 @@
 #include "regulator_tree_mgr.h"
 
 #define HDF_LOG_TAG regulator_core
+#define REGULATOR_HASH_SIZE 256  /* power of 2 */
+#define REGULATOR_HASH_SEED 131
 
 struct RegulatorManager {
     struct IDeviceIoService service;
     struct HdfDeviceObject *device;
     struct DListHead regulatorHead;
+    struct DListHead hashHead[REGULATOR_HASH_SIZE];  /* regulators by name */
     struct OsalMutex lock;
 };
 
 static struct RegulatorManager *g_regulatorManager = NULL;
 
+static uint32_t RegulatorNameHash(const char *name)
+{
+    uint32_t hash = 0;
+
+    while (*name != '\0') {
+        hash = hash * REGULATOR_HASH_SEED + (uint8_t)(*name++);
+    }
+    return hash & (REGULATOR_HASH_SIZE - 1);
+}
+
+static struct RegulatorNode *RegulatorNodeFindLocked(struct RegulatorManager *manager, const char *name)
+{
+    struct RegulatorNode *pos = NULL;
+
+    DLIST_FOR_EACH_ENTRY(pos, &manager->hashHead[RegulatorNameHash(name)], struct RegulatorNode, hashNode) {
+        if (strcmp(name, pos->regulatorInfo.name) == 0) {
+            return pos;
+        }
+    }
+    return NULL;
+}
+
+static bool RegulatorNodeHasParentName(const struct RegulatorNode *node)
+{
+    return (node->regulatorInfo.parentName != NULL) && (strlen(node->regulatorInfo.parentName) > 0);
+}
+
 struct RegulatorNode *RegulatorNodeOpen(const char *name)
 {
     CHECK_NULL_PTR_RETURN_VALUE(name, NULL);
@@ -36,18 +66,13 @@ struct RegulatorNode *RegulatorNodeOpen(const char *name)
         HDF_LOGE("RegulatorNodeOpen: lock regulator manager fail!");
         return NULL;
     }
+    pos = RegulatorNodeFindLocked(manager, name);
+    (void)OsalMutexUnlock(&manager->lock);
 
-    DLIST_FOR_EACH_ENTRY(pos, &manager->regulatorHead, struct RegulatorNode, node) {
-        if (strcmp(name, pos->regulatorInfo.name) == 0) {
-            HDF_LOGD("RegulatorNodeOpen:[%s] SUCCESS", name);
-            (void)OsalMutexUnlock(&manager->lock);
-            return pos;
-        }
+    if (pos == NULL) {
+        HDF_LOGE("RegulatorNodeOpen: No %s regulator exist", name);
     }
-
-    (void)OsalMutexUnlock(&manager->lock);
-    HDF_LOGE("RegulatorNodeOpen: No %s regulator exist", name);
-    return NULL;
+    return pos;
 }
 
 int32_t RegulatorNodeClose(struct RegulatorNode *node)
@@ -95,20 +120,17 @@ int32_t RegulatorNodeSetParent(struct RegulatorNode *node)
         return HDF_ERR_DEVICE_BUSY;
     }
     // parent set
-    if ((node->regulatorInfo.parentName != NULL) 
-        && (strlen(node->regulatorInfo.parentName) > 0)) {
-        DLIST_FOR_EACH_ENTRY(pos, &manager->regulatorHead, struct RegulatorNode, node) {
-            if (strcmp(node->regulatorInfo.parentName, pos->regulatorInfo.name) == 0) {
-                if (RegulatorTreeSet(node->regulatorInfo.name, node, pos) != HDF_SUCCESS) {
-                    HDF_LOGE("%s: RegulatorTreeSet failed", __func__);
-                    (void)OsalMutexUnlock(&manager->lock);
-                    return HDF_FAILURE;
-                } else {
-                    HDF_LOGI("%s:regulator [%s] RegulatorTreeSet success", __func__, node->regulatorInfo.name);
-                    (void)OsalMutexUnlock(&manager->lock);
-                    return HDF_SUCCESS;
-                }
+    if (RegulatorNodeHasParentName(node)) {
+        pos = RegulatorNodeFindLocked(manager, node->regulatorInfo.parentName);
+        if (pos != NULL) {
+            if (RegulatorTreeSet(node->regulatorInfo.name, node, pos) != HDF_SUCCESS) {
+                HDF_LOGE("%s: RegulatorTreeSet failed", __func__);
+                (void)OsalMutexUnlock(&manager->lock);
+                return HDF_FAILURE;
             }
+            HDF_LOGD("%s:regulator [%s] RegulatorTreeSet success", __func__, node->regulatorInfo.name);
+            (void)OsalMutexUnlock(&manager->lock);
+            return HDF_SUCCESS;
         }
 
         HDF_LOGE("%s: RegulatorTreeSet find %s parent %s error", 
@@ -118,7 +140,7 @@ int32_t RegulatorNodeSetParent(struct RegulatorNode *node)
     }
 
     (void)OsalMutexUnlock(&manager->lock);
-    HDF_LOGE("%s: the node %s no need to set parent", __func__, node->regulatorInfo.name);
+    HDF_LOGD("%s: the node %s no need to set parent", __func__, node->regulatorInfo.name);
     return HDF_SUCCESS;
 }
 
@@ -153,22 +175,15 @@ int32_t RegulatorNodeInitProcess(struct RegulatorNode *node)
 int32_t RegulatorNodeAdd(struct RegulatorNode *node)
 {
     CHECK_NULL_PTR_RETURN_VALUE(node, HDF_ERR_INVALID_PARAM);
-    struct RegulatorNode *pos = NULL;
+    CHECK_NULL_PTR_RETURN_VALUE(node->regulatorInfo.name, HDF_ERR_INVALID_PARAM);
     struct RegulatorManager *manager = g_regulatorManager;
     CHECK_NULL_PTR_RETURN_VALUE(manager, HDF_FAILURE);
 
-    DLIST_FOR_EACH_ENTRY(pos, &manager->regulatorHead, struct RegulatorNode, node) {
-        if (strcmp(node->regulatorInfo.name, pos->regulatorInfo.name) == 0) {
-            HDF_LOGE("%s: regulatorInfo[%s] existed", __func__, node->regulatorInfo.name);
-            return HDF_FAILURE;
-        }
-    }
-
     // init node info
     node->regulatorInfo.cb = NULL;
     node->regulatorInfo.useCount = 0;
     node->regulatorInfo.status = REGULATOR_STATUS_OFF;
-    node->regulatorInfo.useCount = 0;
+    node->tree = NULL;
     if (OsalMutexInit(&node->lock) != HDF_SUCCESS) {
         HDF_LOGE("%s: OsalMutexInit %s failed", __func__, node->regulatorInfo.name);
         return HDF_FAILURE;
@@ -176,9 +191,17 @@ int32_t RegulatorNodeAdd(struct RegulatorNode *node)
 
     if (OsalMutexLock(&manager->lock) != HDF_SUCCESS) {
         HDF_LOGE("RegulatorManagerAddNode: lock regulator manager fail!");
+        (void)OsalMutexDestroy(&node->lock);
         return HDF_ERR_DEVICE_BUSY;
     }
+    if (RegulatorNodeFindLocked(manager, node->regulatorInfo.name) != NULL) {
+        (void)OsalMutexUnlock(&manager->lock);
+        HDF_LOGE("%s: regulatorInfo[%s] existed", __func__, node->regulatorInfo.name);
+        (void)OsalMutexDestroy(&node->lock);
+        return HDF_FAILURE;
+    }
     DListInsertTail(&node->node, &manager->regulatorHead);
+    DListInsertTail(&node->hashNode, &manager->hashHead[RegulatorNameHash(node->regulatorInfo.name)]);
     (void)OsalMutexUnlock(&manager->lock);
 
     if (RegulatorNodeInitProcess(node) != HDF_SUCCESS) {
@@ -186,10 +209,41 @@ int32_t RegulatorNodeAdd(struct RegulatorNode *node)
         return HDF_FAILURE;
     }
 
-    HDF_LOGI("%s: add regulator name[%s] success", __func__, node->regulatorInfo.name);
-    RegulatorNodeListPrint();
+    HDF_LOGD("%s: add regulator name[%s] success", __func__, node->regulatorInfo.name);
+    return HDF_SUCCESS;
+}
+
+int32_t RegulatorNodeRemove(const char *name)
+{
+    CHECK_NULL_PTR_RETURN_VALUE(name, HDF_ERR_INVALID_PARAM);
+    struct RegulatorNode *node = NULL;
+    struct RegulatorManager *manager = g_regulatorManager;
+    CHECK_NULL_PTR_RETURN_VALUE(manager, HDF_ERR_NOT_SUPPORT);
+
+    if (OsalMutexLock(&manager->lock) != HDF_SUCCESS) {
+        HDF_LOGE("RegulatorNodeRemove: lock regulator manager fail!");
+        return HDF_ERR_DEVICE_BUSY;
+    }
+    node = RegulatorNodeFindLocked(manager, name);
+    if (node == NULL) {
+        (void)OsalMutexUnlock(&manager->lock);
+        HDF_LOGE("RegulatorNodeRemove: No %s regulator exist", name);
+        return HDF_FAILURE;
+    }
+    if (RegulatorTreeNodeRemove(node) != HDF_SUCCESS) {
+        (void)OsalMutexUnlock(&manager->lock);
+        HDF_LOGE("RegulatorNodeRemove: %s is in use by the tree", name);
+        return HDF_ERR_DEVICE_BUSY;
+    }
+    DListRemove(&node->node);
+    DListRemove(&node->hashNode);
+    (void)OsalMutexUnlock(&manager->lock);
+
+    (void)OsalMutexDestroy(&node->lock);
+    OsalMemFree(node);
     return HDF_SUCCESS;
 }
+
 int32_t RegulatorNodeRemoveAll(void)
 {
     if (RegulatorTreeNodeRemoveAll() != HDF_SUCCESS) {
@@ -198,6 +252,7 @@ int32_t RegulatorNodeRemoveAll(void)
     }
 
     struct RegulatorNode *pos = NULL;
+    struct RegulatorNode *tmp = NULL;
     struct RegulatorManager *manager = g_regulatorManager;
     if (manager == NULL) {
         HDF_LOGE("RegulatorNodeRemoveAll: regulator manager null!");
@@ -209,8 +264,9 @@ int32_t RegulatorNodeRemoveAll(void)
         return HDF_ERR_DEVICE_BUSY;
     }
 
-    DLIST_FOR_EACH_ENTRY(pos, &manager->regulatorHead, struct RegulatorNode, node) {
+    DLIST_FOR_EACH_ENTRY_SAFE(pos, tmp, &manager->regulatorHead, struct RegulatorNode, node) {
         DListRemove(&pos->node);
+        DListRemove(&pos->hashNode);
         (void)OsalMutexDestroy(&pos->lock);
         OsalMemFree(pos);
     }
@@ -228,7 +284,7 @@ int32_t RegulatorNodeStatusCb(struct RegulatorNode *node)
 
     info.status = node->regulatorInfo.status;
     info.name = node->regulatorInfo.name;
-    HDF_LOGI("%s: Cb %s %d", __func__, info.name, info.status);
+    HDF_LOGD("%s: Cb %s %d", __func__, info.name, info.status);
 
     return node->regulatorInfo.cb(&info);
 }
@@ -245,8 +301,8 @@ int32_t RegulatorNodeEnable(struct RegulatorNode *node)
         return HDF_ERR_DEVICE_BUSY;
     }
 
-    if ((node->regulatorInfo.parentName != NULL) && (strlen(node->regulatorInfo.parentName) > 0)) {
-        struct RegulatorNode *parent = RegulatorTreeGetParent(node->regulatorInfo.name);
+    if (RegulatorNodeHasParentName(node)) {
+        struct RegulatorNode *parent = RegulatorTreeGetParent(node);
         if (parent == NULL) {
             (void)OsalMutexUnlock(&node->lock);
             HDF_LOGE("RegulatorNodeEnable: %s failed", node->regulatorInfo.name);
@@ -273,11 +329,33 @@ int32_t RegulatorNodeEnable(struct RegulatorNode *node)
     return HDF_SUCCESS;
 }
 
-static int32_t RegulatorNodeDisable(struct RegulatorNode *node)
+/* disable the parent of a node just disabled, unless it still supplies another child */
+static int32_t RegulatorNodeDisableParent(struct RegulatorNode *node)
+{
+    if (!RegulatorNodeHasParentName(node)) {
+        return HDF_SUCCESS;
+    }
+
+    struct RegulatorNode *parent = RegulatorTreeGetParent(node);
+    if (parent == NULL) {
+        HDF_LOGE("RegulatorNodeDisableParent: %s failed", node->regulatorInfo.name);
+        return HDF_FAILURE;
+    }
+    if (!RegulatorTreeIsAllChildDisable(parent)) {
+        return HDF_SUCCESS;
+    }
+    if (RegulatorNodeDisable(parent) != HDF_SUCCESS) {
+        HDF_LOGE("RegulatorNodeDisableParent: %s failed", parent->regulatorInfo.name);
+        return HDF_FAILURE;
+    }
+    return HDF_SUCCESS;
+}
+
+int32_t RegulatorNodeDisable(struct RegulatorNode *node)
 {
     CHECK_NULL_PTR_RETURN_VALUE(node, HDF_ERR_INVALID_PARAM);
     if ((node->regulatorInfo.status == REGULATOR_STATUS_OFF) || (node->regulatorInfo.constraints.alwaysOn)) {
-        HDF_LOGI("RegulatorNodeDisable: %s [%d][%d], unsatisfied closing adjusment", 
+        HDF_LOGD("RegulatorNodeDisable: %s [%d][%d], unsatisfied closing adjusment", 
             node->regulatorInfo.name, node->regulatorInfo.status, node->regulatorInfo.constraints.alwaysOn);
         return HDF_SUCCESS;
     }
@@ -287,7 +365,7 @@ static int32_t RegulatorNodeDisable(struct RegulatorNode *node)
         return HDF_ERR_DEVICE_BUSY;
     }
 
-    if (!RegulatorTreeIsAllChildDisable(node->regulatorInfo.name)) {
+    if (!RegulatorTreeIsAllChildDisable(node)) {
         (void)OsalMutexUnlock(&node->lock);
         HDF_LOGE("RegulatorNodeDisable:there is %s child not disable ", node->regulatorInfo.name);
         return HDF_FAILURE;
@@ -304,18 +382,9 @@ static int32_t RegulatorNodeDisable(struct RegulatorNode *node)
     HDF_LOGD("RegulatorNodeDisable:disable %s success", node->regulatorInfo.name);
 
     // set parent
-    if (strlen(node->regulatorInfo.parentName) != 0) {
-        struct RegulatorNode *parent = RegulatorTreeGetParent(node->regulatorInfo.name);
-        if (parent == NULL) {
-            (void)OsalMutexUnlock(&node->lock);
-            HDF_LOGE("RegulatorNodeDisable: %s failed", node->regulatorInfo.name);
-            return HDF_FAILURE;
-        }
-        if (RegulatorNodeDisable(parent) != HDF_SUCCESS) {
-            (void)OsalMutexUnlock(&node->lock);
-            HDF_LOGE("RegulatorNodeDisable: %s failed", parent->regulatorInfo.name);
-            return HDF_FAILURE;
-        }
+    if (RegulatorNodeDisableParent(node) != HDF_SUCCESS) {
+        (void)OsalMutexUnlock(&node->lock);
+        return HDF_FAILURE;
     }
 
     (void)OsalMutexUnlock(&node->lock);
@@ -332,7 +401,7 @@ int32_t RegulatorNodeForceDisable(struct RegulatorNode *node)
 
     if (node->regulatorInfo.status == REGULATOR_STATUS_OFF) {
         (void)OsalMutexUnlock(&node->lock);
-        HDF_LOGI(": %s useCount[%d] has been closed", 
+        HDF_LOGD(": %s useCount[%d] has been closed", 
             node->regulatorInfo.name, node->regulatorInfo.useCount);
         return HDF_SUCCESS;
     }
@@ -354,18 +423,9 @@ int32_t RegulatorNodeForceDisable(struct RegulatorNode *node)
     HDF_LOGD(":regulator %s force disable success", node->regulatorInfo.name);
 
     // set parent
-    if (strlen(node->regulatorInfo.parentName) != 0) {
-        struct RegulatorNode *parent = RegulatorTreeGetParent(node->regulatorInfo.name);
-        if (parent == NULL) {
-            (void)OsalMutexUnlock(&node->lock);
-            HDF_LOGE(": %s failed", node->regulatorInfo.name);
-            return HDF_FAILURE;
-        }
-        if (RegulatorNodeDisable(parent) != HDF_SUCCESS) {
-            (void)OsalMutexUnlock(&node->lock);
-            HDF_LOGE(": %s failed", parent->regulatorInfo.name);
-            return HDF_FAILURE;
-        }
+    if (RegulatorNodeDisableParent(node) != HDF_SUCCESS) {
+        (void)OsalMutexUnlock(&node->lock);
+        return HDF_FAILURE;
     }
 
     (void)OsalMutexUnlock(&node->lock);
@@ -531,18 +591,15 @@ int32_t RegulatorTreeInfoInit(struct RegulatorNode *node)
     struct RegulatorManager *manager = g_regulatorManager;
     CHECK_NULL_PTR_RETURN_VALUE(manager, HDF_ERR_INVALID_OBJECT);
 
-    if ((node->regulatorInfo.parentName != NULL) 
-        && (strlen(node->regulatorInfo.parentName) > 0)) {
-        DLIST_FOR_EACH_ENTRY(pos, &manager->regulatorHead, struct RegulatorNode, node) {
-            if (strcmp(node->regulatorInfo.parentName, pos->regulatorInfo.name) == 0) {
-                if (RegulatorTreeSet(node->regulatorInfo.name, node, pos) != HDF_SUCCESS) {
-                    HDF_LOGE("%s: RegulatorTreeSet failed", __func__);
-                    return HDF_FAILURE;
-                } else {
-                    HDF_LOGI("%s:regulator [%s] RegulatorTreeSet success", __func__, node->regulatorInfo.name);
-                    return HDF_SUCCESS;
-                }
+    if (RegulatorNodeHasParentName(node)) {
+        pos = RegulatorNodeFindLocked(manager, node->regulatorInfo.parentName);
+        if (pos != NULL) {
+            if (RegulatorTreeSet(node->regulatorInfo.name, node, pos) != HDF_SUCCESS) {
+                HDF_LOGE("%s: RegulatorTreeSet failed", __func__);
+                return HDF_FAILURE;
             }
+            HDF_LOGD("%s:regulator [%s] RegulatorTreeSet success", __func__, node->regulatorInfo.name);
+            return HDF_SUCCESS;
         }
 
         HDF_LOGE("%s: RegulatorTreeSet find %s parent %s error", 
@@ -552,9 +609,94 @@ int32_t RegulatorTreeInfoInit(struct RegulatorNode *node)
     return HDF_SUCCESS;
 }
 
+struct RegulatorProfileStep {
+    struct RegulatorNode *node;
+    uint32_t status;
+    uint32_t depth;
+};
+
+/* disables come first, children before parents, then enables, parents before children */
+static bool RegulatorProfileStepBefore(const struct RegulatorProfileStep *a, const struct RegulatorProfileStep *b)
+{
+    if (a->status != b->status) {
+        return a->status == REGULATOR_STATUS_OFF;
+    }
+    return (a->status == REGULATOR_STATUS_OFF) ? (a->depth > b->depth) : (a->depth < b->depth);
+}
+
+/* resolve and order the steps of a profile, with the manager lock held */
+static int32_t RegulatorProfilePrepareLocked(struct RegulatorManager *manager,
+    const struct RegulatorProfileEntry *entries, uint32_t count, struct RegulatorProfileStep *steps)
+{
+    uint32_t i;
+    uint32_t j;
+    struct RegulatorProfileStep step;
+
+    for (i = 0; i < count; i++) {
+        if (entries[i].name == NULL ||
+            (entries[i].status != REGULATOR_STATUS_ON && entries[i].status != REGULATOR_STATUS_OFF)) {
+            HDF_LOGE("%s: entry %u invalid", __func__, i);
+            return HDF_ERR_INVALID_PARAM;
+        }
+        step.node = RegulatorNodeFindLocked(manager, entries[i].name);
+        if (step.node == NULL) {
+            HDF_LOGE("%s: No %s regulator exist", __func__, entries[i].name);
+            return HDF_ERR_INVALID_PARAM;
+        }
+        step.status = entries[i].status;
+        step.depth = RegulatorTreeGetDepth(step.node);
+        // insertion sort, profiles are short and mostly given in order already
+        for (j = i; j > 0 && RegulatorProfileStepBefore(&step, &steps[j - 1]); j--) {
+            steps[j] = steps[j - 1];
+        }
+        steps[j] = step;
+    }
+    return HDF_SUCCESS;
+}
+
+int32_t RegulatorNodeApplyProfile(const struct RegulatorProfileEntry *entries, uint32_t count)
+{
+    int32_t ret;
+    uint32_t i;
+    struct RegulatorProfileStep *steps = NULL;
+    struct RegulatorManager *manager = g_regulatorManager;
+    CHECK_NULL_PTR_RETURN_VALUE(manager, HDF_ERR_NOT_SUPPORT);
+    CHECK_NULL_PTR_RETURN_VALUE(entries, HDF_ERR_INVALID_PARAM);
+
+    if (count == 0 || count > REGULATOR_PROFILE_ENTRY_MAX) {
+        HDF_LOGE("%s: count %u invalid", __func__, count);
+        return HDF_ERR_INVALID_PARAM;
+    }
+    steps = (struct RegulatorProfileStep *)OsalMemCalloc(sizeof(*steps) * count);
+    if (steps == NULL) {
+        HDF_LOGE("%s: malloc steps fail!", __func__);
+        return HDF_ERR_MALLOC_FAIL;
+    }
+
+    // the manager lock keeps the regulators from being removed until the whole profile is applied
+    if (OsalMutexLock(&manager->lock) != HDF_SUCCESS) {
+        HDF_LOGE("%s: lock regulator manager fail!", __func__);
+        OsalMemFree(steps);
+        return HDF_ERR_DEVICE_BUSY;
+    }
+    ret = RegulatorProfilePrepareLocked(manager, entries, count, steps);
+    for (i = 0; ret == HDF_SUCCESS && i < count; i++) {
+        ret = (steps[i].status == REGULATOR_STATUS_ON) ?
+            RegulatorNodeEnable(steps[i].node) : RegulatorNodeDisable(steps[i].node);
+        if (ret != HDF_SUCCESS) {
+            HDF_LOGE("%s: set %s to %u fail", __func__, steps[i].node->regulatorInfo.name, steps[i].status);
+        }
+    }
+    (void)OsalMutexUnlock(&manager->lock);
+
+    OsalMemFree(steps);
+    return ret;
+}
+
 static int32_t RegulatorManagerBind(struct HdfDeviceObject *device)
 {
     int32_t ret;
+    uint32_t i;
     struct RegulatorManager *manager = NULL;
 
     HDF_LOGI("RegulatorManagerBind: Enter!");
@@ -576,6 +718,9 @@ static int32_t RegulatorManagerBind(struct HdfDeviceObject *device)
     manager->device = device;
     device->service = &manager->service;
     DListHeadInit(&manager->regulatorHead);
+    for (i = 0; i < REGULATOR_HASH_SIZE; i++) {
+        DListHeadInit(&manager->hashHead[i]);
+    }
     g_regulatorManager = manager;
 
     if (RegulatorTreeManagerInit() != HDF_SUCCESS) {
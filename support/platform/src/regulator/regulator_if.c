@@ -180,3 +180,19 @@ int32_t RegulatorGetStatus(DevHandle handle, uint32_t *status)
 
     return HDF_SUCCESS;
 }
+
+int32_t RegulatorApplyProfile(const struct RegulatorProfileEntry *entries, uint32_t count)
+{
+    if (entries == NULL || count == 0 || count > REGULATOR_PROFILE_ENTRY_MAX) {
+        HDF_LOGE("%s: invalid profile", __func__);
+        return HDF_ERR_INVALID_PARAM;
+    }
+
+    int ret = RegulatorNodeApplyProfile(entries, count);
+    if (ret != HDF_SUCCESS) {
+        HDF_LOGE("%s: RegulatorNodeApplyProfile fail", __func__);
+        return ret;
+    }
+
+    return HDF_SUCCESS;
+}
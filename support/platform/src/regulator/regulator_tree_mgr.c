@@ -25,101 +25,80 @@ static int RegulatorChildNodeAdd(struct RegulatorTreeInfo *pRegulator, struct Re
     nodeInfo->child = child;
 
     DListInsertTail(&nodeInfo->node, &pRegulator->childHead);
-    HDF_LOGI("RegulatorChildNodeAdd: add %s child node success!", pRegulator->name);
+    HDF_LOGD("RegulatorChildNodeAdd: add %s child node success!", pRegulator->name);
     return HDF_SUCCESS;
 }
 void RegulatorChildListDestroy(struct RegulatorTreeInfo *pRegulator)
 {
     CHECK_NULL_PTR_RETURN(pRegulator);
     struct RegulatorChildNode *nodeInfo = NULL;
+    struct RegulatorChildNode *tmp = NULL;
 
-    DLIST_FOR_EACH_ENTRY(nodeInfo, &pRegulator->childHead, struct RegulatorChildNode, node) {
+    DLIST_FOR_EACH_ENTRY_SAFE(nodeInfo, tmp, &pRegulator->childHead, struct RegulatorChildNode, node) {
         DListRemove(&nodeInfo->node);
         OsalMemFree(nodeInfo);
     }
 }
-struct RegulatorNode *RegulatorTreeGetParent(const char *name)
+/* the parent is resolved once at RegulatorTreeSet, so no lookup is needed on enable and disable */
+struct RegulatorNode *RegulatorTreeGetParent(const struct RegulatorNode *node)
 {
-    CHECK_NULL_PTR_RETURN_VALUE(name, NULL);
+    CHECK_NULL_PTR_RETURN_VALUE(node, NULL);
 
-    struct RegulatorTreeInfo *pos = NULL;
-    struct RegulatorTreeManager *manager = g_regulatorTreeManager;
-    CHECK_NULL_PTR_RETURN_VALUE(manager, NULL);
-
-    if (OsalMutexLock(&manager->lock) != HDF_SUCCESS) {
-        HDF_LOGE("RegulatorTreeGetParent: lock regulator manager fail!");
+    if (node->tree == NULL) {
         return NULL;
     }
-
-    DLIST_FOR_EACH_ENTRY(pos, &manager->treeMgrHead, struct RegulatorTreeInfo, node) {
-        if (strcmp(pos->name, name) == 0) {
-            if (pos->parent == NULL) {
-                (void)OsalMutexUnlock(&manager->lock);
-                HDF_LOGI("RegulatorTreeGetParent: %s no parent", name);
-                return NULL;
-            }
-            (void)OsalMutexUnlock(&manager->lock);
-            HDF_LOGI("RegulatorTreeGetParent: get %s parent %s success!", 
-                name, pos->parent->regulatorInfo.name);
-            return pos->parent;
-        }
-    }
-
-    (void)OsalMutexUnlock(&manager->lock);
-    HDF_LOGI("RegulatorTreeGetParent: no %s Tree node", name);
-    return NULL;
+    return node->tree->parent;
 }
 
-static struct DListHead *RegulatorTreeGetChild(const char *name)
+static struct DListHead *RegulatorTreeGetChild(const struct RegulatorNode *node)
 {
-    CHECK_NULL_PTR_RETURN_VALUE(name, NULL);
+    CHECK_NULL_PTR_RETURN_VALUE(node, NULL);
 
-    struct RegulatorTreeInfo *pos = NULL;
-    struct RegulatorTreeManager *manager = g_regulatorTreeManager;
-    CHECK_NULL_PTR_RETURN_VALUE(manager, NULL);
-
-    if (OsalMutexLock(&manager->lock) != HDF_SUCCESS) {
-        HDF_LOGE("RegulatorTreeGetChild: lock regulator manager fail!");
+    if (node->tree == NULL) {
         return NULL;
     }
+    return &node->tree->childHead;
+}
 
-    DLIST_FOR_EACH_ENTRY(pos, &manager->treeMgrHead, struct RegulatorTreeInfo, node) {
-        if (strcmp(pos->name, name) == 0) {
-            (void)OsalMutexUnlock(&manager->lock);
-            HDF_LOGI("RegulatorTreeGetChild: get %s child success!", name);
-            return (&pos->childHead);
-        }
-    }
+uint32_t RegulatorTreeGetDepth(const struct RegulatorNode *node)
+{
+    uint32_t depth = 0;
 
-    (void)OsalMutexUnlock(&manager->lock);
-    HDF_LOGE("RegulatorTreeGetChild: get %s child failed!", name);
-    return NULL;
+    while ((node = RegulatorTreeGetParent(node)) != NULL) {
+        depth++;
+    }
+    return depth;
 }
 
-bool RegulatorTreeIsAllChildDisable(const char *name)
+bool RegulatorTreeIsAllChildDisable(const struct RegulatorNode *node)
 {
-    CHECK_NULL_PTR_RETURN_VALUE(name, true);
-    struct DListHead *pList = RegulatorTreeGetChild(name);
-    CHECK_NULL_PTR_RETURN_VALUE(pList, true);
+    CHECK_NULL_PTR_RETURN_VALUE(node, true);
+    struct DListHead *pList = RegulatorTreeGetChild(node);
+    if (pList == NULL) {
+        return true;
+    }
 
     struct RegulatorChildNode *nodeInfo = NULL;
     DLIST_FOR_EACH_ENTRY(nodeInfo, pList, struct RegulatorChildNode, node) {
         if (nodeInfo->child->regulatorInfo.status == REGULATOR_STATUS_ON) {
-            HDF_LOGI("RegulatorTreeIsAllChildDisable:%s's child %s on!", name, nodeInfo->child->regulatorInfo.name);
+            HDF_LOGD("RegulatorTreeIsAllChildDisable:%s's child %s on!",
+                node->regulatorInfo.name, nodeInfo->child->regulatorInfo.name);
             return false;
         }
     }
 
-    HDF_LOGI("RegulatorTreeIsAllChildDisable:%s's all child off!", name);
     return true;
 }
 
 int32_t RegulatorTreeChildForceDisable(struct RegulatorNode *node)
 {
     CHECK_NULL_PTR_RETURN_VALUE(node, HDF_ERR_INVALID_PARAM);
-    struct DListHead *pList = RegulatorTreeGetChild(node->regulatorInfo.name);
-    CHECK_NULL_PTR_RETURN_VALUE(pList, HDF_ERR_INVALID_PARAM);
-    
+    struct DListHead *pList = RegulatorTreeGetChild(node);
+    if (pList == NULL) {
+        return HDF_SUCCESS;
+    }
+
+
     struct RegulatorChildNode *nodeInfo = NULL;
     DLIST_FOR_EACH_ENTRY(nodeInfo, pList, struct RegulatorChildNode, node) {
         if (RegulatorTreeChildForceDisable(nodeInfo->child) != HDF_SUCCESS) {
@@ -137,54 +116,51 @@ int32_t RegulatorTreeChildForceDisable(struct RegulatorNode *node)
             RegulatorNodeStatusCb(nodeInfo->child);
         }
         (void)OsalMutexUnlock(&nodeInfo->child->lock);
-        HDF_LOGI("RegulatorTreeChildForceDisable: child %s ForceDisable success!", nodeInfo->child->regulatorInfo.name);
+        HDF_LOGD("RegulatorTreeChildForceDisable: child %s ForceDisable success!", nodeInfo->child->regulatorInfo.name);
     }
 
     return HDF_SUCCESS;
 }
 
 // if Tree regulator node not exist, then add
-static int32_t RegulatorTreeManagerNodeInit(const char *name)
+static int32_t RegulatorTreeManagerNodeInit(struct RegulatorNode *node)
 {
-    CHECK_NULL_PTR_RETURN_VALUE(name, HDF_FAILURE);
+    CHECK_NULL_PTR_RETURN_VALUE(node, HDF_FAILURE);
 
     struct RegulatorTreeInfo *nodeInfo = NULL;
-    struct RegulatorTreeInfo *pos = NULL;
     struct RegulatorTreeManager *manager = g_regulatorTreeManager;
     CHECK_NULL_PTR_RETURN_VALUE(manager, HDF_FAILURE);
 
     if (OsalMutexLock(&manager->lock) != HDF_SUCCESS) {
-        HDF_LOGE("RegulatorTreeSetParent: lock regulator manager fail!");
+        HDF_LOGE("RegulatorTreeManagerNodeInit: lock regulator manager fail!");
         return HDF_ERR_DEVICE_BUSY;
     }
 
-    DLIST_FOR_EACH_ENTRY(pos, &manager->treeMgrHead, struct RegulatorTreeInfo, node) {
-        if (strcmp(pos->name, name) == 0) {
-            HDF_LOGI("node %s has exists!", name);
-            (void)OsalMutexUnlock(&manager->lock);
-            return HDF_SUCCESS;
-        }
+    if (node->tree != NULL) {
+        (void)OsalMutexUnlock(&manager->lock);
+        return HDF_SUCCESS;
     }
 
     nodeInfo = (struct RegulatorTreeInfo *)OsalMemCalloc(sizeof(*nodeInfo));
-    CHECK_NULL_PTR_RETURN_VALUE(nodeInfo, HDF_FAILURE);
+    if (nodeInfo == NULL) {
+        (void)OsalMutexUnlock(&manager->lock);
+        HDF_LOGE("%s: OsalMemCalloc failed", __func__);
+        return HDF_FAILURE;
+    }
 
     DListHeadInit(&nodeInfo->childHead);
-    nodeInfo->name = name;
+    nodeInfo->name = node->regulatorInfo.name;
+    node->tree = nodeInfo;
 
     DListInsertTail(&nodeInfo->node, &manager->treeMgrHead);
     (void)OsalMutexUnlock(&manager->lock);
-    
-    HDF_LOGI("RegulatorTreeManagerNodeInit: init %s node success!", name);
+
+    HDF_LOGD("RegulatorTreeManagerNodeInit: init %s node success!", node->regulatorInfo.name);
     return HDF_SUCCESS;
 }
 
-static int RegulatorTreeSetParent(const char *name, struct RegulatorNode *parent)
+static int RegulatorTreeSetParent(struct RegulatorNode *child, struct RegulatorNode *parent)
 {
-    CHECK_NULL_PTR_RETURN_VALUE(name, HDF_ERR_INVALID_PARAM);
-    CHECK_NULL_PTR_RETURN_VALUE(parent, HDF_ERR_INVALID_PARAM);
-    
-    struct RegulatorTreeInfo *pos = NULL;
     struct RegulatorTreeManager *manager = g_regulatorTreeManager;
     CHECK_NULL_PTR_RETURN_VALUE(manager, HDF_FAILURE);
 
@@ -192,26 +168,14 @@ static int RegulatorTreeSetParent(const char *name, struct RegulatorNode *parent
         HDF_LOGE("RegulatorTreeSetParent: lock regulator manager fail!");
         return HDF_ERR_DEVICE_BUSY;
     }
-
-    DLIST_FOR_EACH_ENTRY(pos, &manager->treeMgrHead, struct RegulatorTreeInfo, node) {
-        if (strcmp(pos->name, name) == 0) {
-            pos->parent = parent;
-            (void)OsalMutexUnlock(&manager->lock);
-            HDF_LOGI("RegulatorTreeSetParent: set %s parent success!", name);
-            return HDF_SUCCESS;
-        }
-    }
-
+    child->tree->parent = parent;
     (void)OsalMutexUnlock(&manager->lock);
-    HDF_LOGI("RegulatorTreeSetParent:%s does not exist!", name);
-    return HDF_FAILURE;
+    return HDF_SUCCESS;
 }
-static int RegulatorTreeSetChild(const char *name, struct RegulatorNode *child)
-{
-    CHECK_NULL_PTR_RETURN_VALUE(name, HDF_ERR_INVALID_PARAM);
-    CHECK_NULL_PTR_RETURN_VALUE(child, HDF_ERR_INVALID_PARAM);
 
-    struct RegulatorTreeInfo *pos = NULL;
+static int RegulatorTreeSetChild(struct RegulatorNode *parent, struct RegulatorNode *child)
+{
+    int ret;
     struct RegulatorTreeManager *manager = g_regulatorTreeManager;
     CHECK_NULL_PTR_RETURN_VALUE(manager, HDF_FAILURE);
 
@@ -219,23 +183,12 @@ static int RegulatorTreeSetChild(const char *name, struct RegulatorNode *child)
         HDF_LOGE("RegulatorTreeSetChild: lock regulator manager fail!");
         return HDF_ERR_DEVICE_BUSY;
     }
-
-    DLIST_FOR_EACH_ENTRY(pos, &manager->treeMgrHead, struct RegulatorTreeInfo, node) {
-        if (strcmp(pos->name, name) == 0) {
-            if (RegulatorChildNodeAdd(pos, child) != HDF_SUCCESS) {
-                HDF_LOGE("RegulatorTreeSetChild: RegulatorChildNodeAdd fail!");
-                (void)OsalMutexUnlock(&manager->lock);
-                return HDF_FAILURE;
-            }
-            (void)OsalMutexUnlock(&manager->lock);
-            HDF_LOGI("RegulatorTreeSetChild: set %s parent success!", name);
-            return HDF_SUCCESS;
-        }
-    }
-
+    ret = RegulatorChildNodeAdd(parent->tree, child);
     (void)OsalMutexUnlock(&manager->lock);
-    HDF_LOGI("RegulatorTreeSetChild:%s does not exist!", name);
-    return HDF_FAILURE;
+    if (ret != HDF_SUCCESS) {
+        HDF_LOGE("RegulatorTreeSetChild: RegulatorChildNodeAdd fail!");
+    }
+    return ret;
 }
 
 int RegulatorTreeSet(const char *name, struct RegulatorNode *child, struct RegulatorNode *parent)
@@ -244,25 +197,61 @@ int RegulatorTreeSet(const char *name, struct RegulatorNode *child, struct Regul
     CHECK_NULL_PTR_RETURN_VALUE(child, HDF_ERR_INVALID_PARAM);
     CHECK_NULL_PTR_RETURN_VALUE(parent, HDF_ERR_INVALID_PARAM);
 
-    if (RegulatorTreeManagerNodeInit(name) != HDF_SUCCESS) {
+    if (RegulatorTreeManagerNodeInit(child) != HDF_SUCCESS) {
         HDF_LOGE("RegulatorTreeSet: RegulatorTreeManagerNodeInit %s fail!", name);
         return HDF_FAILURE;
     }
-    if (RegulatorTreeSetParent(name, parent) != HDF_SUCCESS) {
+    if (RegulatorTreeSetParent(child, parent) != HDF_SUCCESS) {
         HDF_LOGE("RegulatorTreeSet: RegulatorTreeSetParent %s fail!", name);
         return HDF_FAILURE;
     }
 
-    if (RegulatorTreeManagerNodeInit(parent->regulatorInfo.name) != HDF_SUCCESS) {
+    if (RegulatorTreeManagerNodeInit(parent) != HDF_SUCCESS) {
         HDF_LOGE("RegulatorTreeSet: RegulatorTreeManagerNodeInit %s fail!", parent->regulatorInfo.name);
         return HDF_FAILURE;
     }
-    if (RegulatorTreeSetChild(parent->regulatorInfo.name, child) != HDF_SUCCESS) {
+    if (RegulatorTreeSetChild(parent, child) != HDF_SUCCESS) {
         HDF_LOGE("RegulatorTreeSet: RegulatorTreeSetChild %s fail!", name);
         return HDF_FAILURE;
     }
 
-    HDF_LOGI("RegulatorTreeSet: set [%s], parent[%s]  success!", name, parent->regulatorInfo.name);
+    HDF_LOGD("RegulatorTreeSet: set [%s], parent[%s]  success!", name, parent->regulatorInfo.name);
+    return HDF_SUCCESS;
+}
+
+int RegulatorTreeNodeRemove(struct RegulatorNode *node)
+{
+    CHECK_NULL_PTR_RETURN_VALUE(node, HDF_ERR_INVALID_PARAM);
+    struct RegulatorTreeInfo *info = node->tree;
+    struct RegulatorChildNode *nodeInfo = NULL;
+    struct RegulatorChildNode *tmp = NULL;
+    struct RegulatorTreeManager *manager = g_regulatorTreeManager;
+    CHECK_NULL_PTR_RETURN_VALUE(manager, HDF_FAILURE);
+
+    if (info == NULL) {
+        return HDF_SUCCESS;
+    }
+    if (OsalMutexLock(&manager->lock) != HDF_SUCCESS) {
+        HDF_LOGE("RegulatorTreeNodeRemove: lock regulator manager fail!");
+        return HDF_ERR_DEVICE_BUSY;
+    }
+    if (!DListIsEmpty(&info->childHead)) {
+        (void)OsalMutexUnlock(&manager->lock);
+        HDF_LOGE("RegulatorTreeNodeRemove: %s still has children", node->regulatorInfo.name);
+        return HDF_ERR_DEVICE_BUSY;
+    }
+    if (info->parent != NULL && info->parent->tree != NULL) {
+        DLIST_FOR_EACH_ENTRY_SAFE(nodeInfo, tmp, &info->parent->tree->childHead, struct RegulatorChildNode, node) {
+            if (nodeInfo->child == node) {
+                DListRemove(&nodeInfo->node);
+                OsalMemFree(nodeInfo);
+            }
+        }
+    }
+    DListRemove(&info->node);
+    node->tree = NULL;
+    (void)OsalMutexUnlock(&manager->lock);
+    OsalMemFree(info);
     return HDF_SUCCESS;
 }
 static void RegulatorTreePrintChild(const char *name, struct DListHead *childHead)
@@ -278,7 +267,7 @@ static void RegulatorTreePrintChild(const char *name, struct DListHead *childHea
     }
 }
 
-static void RegulatorTreePrint(void)
+void RegulatorTreePrint(void)
 {
     struct RegulatorTreeInfo *pos = NULL;
     struct RegulatorTreeManager *manager = g_regulatorTreeManager;
@@ -305,6 +294,7 @@ static void RegulatorTreePrint(void)
 int RegulatorTreeNodeRemoveAll(void)
 {
     struct RegulatorTreeInfo *nodeInfo = NULL;
+    struct RegulatorTreeInfo *tmp = NULL;
     struct RegulatorTreeManager *manager = g_regulatorTreeManager;
     CHECK_NULL_PTR_RETURN_VALUE(manager, HDF_FAILURE);
 
@@ -313,7 +303,7 @@ int RegulatorTreeNodeRemoveAll(void)
         return HDF_ERR_DEVICE_BUSY;
     }
 
-    DLIST_FOR_EACH_ENTRY(nodeInfo, &manager->treeMgrHead, struct RegulatorTreeInfo, node) {
+    DLIST_FOR_EACH_ENTRY_SAFE(nodeInfo, tmp, &manager->treeMgrHead, struct RegulatorTreeInfo, node) {
         RegulatorChildListDestroy(nodeInfo);
         DListRemove(&nodeInfo->node);
         OsalMemFree(nodeInfo);
@@ -9,10 +9,60 @@
 #include "spi_core.h"
 #include "hdf_log.h"
 #include "osal_mem.h"
+#include "securec.h"
 #include "spi_if.h"
 
 #define HDF_LOG_TAG spi_core
 
+#define SPI_QUEUE_STACK_SIZE 10000
+
+/* program the config of curCs unless it is the one programmed last, with the lock held */
+static int32_t SpiCntlrPrepare(struct SpiCntlr *cntlr)
+{
+    int32_t ret;
+
+    if (cntlr->method->Prepare == NULL) {
+        return HDF_SUCCESS;
+    }
+    if (cntlr->cfgCs == cntlr->curCs) {
+        cntlr->stats.cfgSkips++;
+        return HDF_SUCCESS;
+    }
+    ret = cntlr->method->Prepare(cntlr);
+    cntlr->stats.cfgWrites++;
+    cntlr->cfgCs = (ret == HDF_SUCCESS) ? cntlr->curCs : SPI_CS_NONE;
+    return ret;
+}
+
+static uint32_t SpiMsgsLen(const struct SpiMsg *msg, uint32_t count)
+{
+    uint32_t i;
+    uint32_t len = 0;
+
+    for (i = 0; msg != NULL && i < count; i++) {
+        len += msg[i].len;
+    }
+    return len;
+}
+
+static int32_t SpiCntlrTransferLocked(struct SpiCntlr *cntlr, struct SpiMsg *msg, uint32_t count)
+{
+    int32_t ret;
+
+    ret = SpiCntlrPrepare(cntlr);
+    if (ret != HDF_SUCCESS) {
+        HDF_LOGE("%s: prepare cs %u failed, ret %d", __func__, cntlr->curCs, ret);
+        return ret;
+    }
+    ret = cntlr->method->Transfer(cntlr, msg, count);
+    cntlr->stats.transfers++;
+    if (ret != HDF_SUCCESS) {
+        /* the controller may have been reset */
+        cntlr->cfgCs = SPI_CS_NONE;
+    }
+    return ret;
+}
+
 int32_t SpiCntlrOpen(struct SpiCntlr *cntlr, uint32_t csNum)
 {
     int32_t ret;
@@ -27,8 +77,11 @@ int32_t SpiCntlrOpen(struct SpiCntlr *cntlr, uint32_t csNum)
     }
     (void)OsalMutexLock(&(cntlr->lock));
     cntlr->curCs = csNum;
+    cntlr->cfgCs = SPI_CS_NONE;
     ret = cntlr->method->Open(cntlr);
     (void)OsalMutexUnlock(&(cntlr->lock));
+    /* busNum is known once the driver is initialized, not when the cntlr is created */
+    (void)PlatformStatsRegister(&cntlr->xferStats, PLATFORM_MODULE_SPI, cntlr->busNum);
     return ret;
 }
 
@@ -46,6 +99,7 @@ int32_t SpiCntlrClose(struct SpiCntlr *cntlr, uint32_t csNum)
     }
     (void)OsalMutexLock(&(cntlr->lock));
     cntlr->curCs = csNum;
+    cntlr->cfgCs = SPI_CS_NONE;
     ret = cntlr->method->Close(cntlr);
     (void)OsalMutexUnlock(&(cntlr->lock));
     return ret;
@@ -54,6 +108,7 @@ int32_t SpiCntlrClose(struct SpiCntlr *cntlr, uint32_t csNum)
 int32_t SpiCntlrTransfer(struct SpiCntlr *cntlr, uint32_t csNum, struct SpiMsg *msg, uint32_t count)
 {
     int32_t ret;
+    struct PlatformStatsStamp stamp;
 
     if (cntlr == NULL) {
         HDF_LOGE("%s: invalid parameter", __func__);
@@ -64,10 +119,13 @@ int32_t SpiCntlrTransfer(struct SpiCntlr *cntlr, uint32_t csNum, struct SpiMsg *
         return HDF_ERR_NOT_SUPPORT;
     }
 
+    PlatformStatsBegin(&stamp);
     (void)OsalMutexLock(&(cntlr->lock));
+    PlatformStatsLocked(&stamp);
     cntlr->curCs = csNum;
-    ret = cntlr->method->Transfer(cntlr, msg, count);
+    ret = SpiCntlrTransferLocked(cntlr, msg, count);
     (void)OsalMutexUnlock(&(cntlr->lock));
+    PlatformStatsEnd(&cntlr->xferStats, &stamp, SpiMsgsLen(msg, count), ret);
     return ret;
 }
 
@@ -87,6 +145,7 @@ int32_t SpiCntlrSetCfg(struct SpiCntlr *cntlr, uint32_t csNum, struct SpiCfg *cf
 
     (void)OsalMutexLock(&(cntlr->lock));
     cntlr->curCs = csNum;
+    cntlr->cfgCs = SPI_CS_NONE;
     ret = cntlr->method->SetCfg(cntlr, cfg);
     (void)OsalMutexUnlock(&(cntlr->lock));
     return ret;
@@ -113,11 +172,224 @@ int32_t SpiCntlrGetCfg(struct SpiCntlr *cntlr, uint32_t csNum, struct SpiCfg *cf
     return ret;
 }
 
+/*
+ * Take the oldest request and the other pending requests of its device, with the spinlock held.
+ * Requests left behind keep their order.
+ */
+static uint32_t SpiQueueTakeBatch(struct SpiQueue *queue)
+{
+    uint32_t i;
+    uint32_t csNum;
+    uint32_t num = 0;
+    uint32_t kept = 0;
+    struct SpiQueueEntry *entry = NULL;
+
+    if (queue->head == queue->tail) {
+        return 0;
+    }
+    csNum = queue->entries[queue->tail & (SPI_QUEUE_DEPTH - 1)].csNum;
+    for (i = queue->tail; i != queue->head; i++) {
+        entry = &queue->entries[i & (SPI_QUEUE_DEPTH - 1)];
+        if (entry->csNum == csNum && num < SPI_QUEUE_BATCH) {
+            queue->run[num++] = *entry;
+        } else {
+            queue->entries[(queue->tail + kept) & (SPI_QUEUE_DEPTH - 1)] = *entry;
+            kept++;
+        }
+    }
+    queue->head = queue->tail + kept;
+    return num;
+}
+
+static void SpiQueueSendBatch(struct SpiCntlr *cntlr, struct SpiQueue *queue, uint32_t num)
+{
+    uint32_t i;
+    int32_t status[SPI_QUEUE_BATCH];
+    struct SpiAsyncMsg *async = NULL;
+    struct PlatformStatsStamp stamp;
+
+    /* the config is programmed for the first request at most, the others find it in place */
+    PlatformStatsBegin(&stamp);
+    (void)OsalMutexLock(&(cntlr->lock));
+    PlatformStatsLocked(&stamp);
+    cntlr->curCs = queue->run[0].csNum;
+    for (i = 0; i < num; i++) {
+        async = queue->run[i].async;
+        status[i] = SpiCntlrTransferLocked(cntlr, async->msgs, async->count);
+        /* only the first request of a batch waits for the lock */
+        PlatformStatsEnd(&cntlr->xferStats, &stamp, SpiMsgsLen(async->msgs, async->count), status[i]);
+        PlatformStatsBegin(&stamp);
+    }
+    cntlr->stats.batches++;
+    (void)OsalMutexUnlock(&(cntlr->lock));
+
+    /* callbacks run unlocked, so they may queue or send further transfers */
+    for (i = 0; i < num; i++) {
+        async = queue->run[i].async;
+        async->callback(async, status[i]);
+    }
+}
+
+static int SpiQueueThread(void *data)
+{
+    uint32_t num;
+    struct SpiQueue *queue = (struct SpiQueue *)data;
+
+    while (!queue->stop) {
+        if (OsalSemWait(&queue->sem, HDF_WAIT_FOREVER) != HDF_SUCCESS) {
+            continue;
+        }
+        do {
+            (void)OsalSpinLock(&queue->spin);
+            num = queue->stop ? 0 : SpiQueueTakeBatch(queue);
+            (void)OsalSpinUnlock(&queue->spin);
+            if (num > 0) {
+                SpiQueueSendBatch(queue->cntlr, queue, num);
+            }
+        } while (num > 0);
+    }
+    (void)OsalSemPost(&queue->exited);
+    return HDF_SUCCESS;
+}
+
+static int32_t SpiQueueCreate(struct SpiCntlr *cntlr)
+{
+    struct OsalThreadParam cfg;
+    struct SpiQueue *queue = NULL;
+
+    queue = (struct SpiQueue *)OsalMemCalloc(sizeof(*queue));
+    if (queue == NULL) {
+        HDF_LOGE("%s: OsalMemCalloc error", __func__);
+        return HDF_ERR_MALLOC_FAIL;
+    }
+    queue->cntlr = cntlr;
+    if (snprintf_s(queue->name, SPI_QUEUE_NAME_LEN, SPI_QUEUE_NAME_LEN - 1, "spi_queue_%u", cntlr->busNum) < 0 ||
+        OsalSpinInit(&queue->spin) != HDF_SUCCESS) {
+        OsalMemFree(queue);
+        return HDF_FAILURE;
+    }
+    if (OsalSemInit(&queue->sem, 0) != HDF_SUCCESS) {
+        (void)OsalSpinDestroy(&queue->spin);
+        OsalMemFree(queue);
+        return HDF_FAILURE;
+    }
+    if (OsalSemInit(&queue->exited, 0) != HDF_SUCCESS) {
+        (void)OsalSemDestroy(&queue->sem);
+        (void)OsalSpinDestroy(&queue->spin);
+        OsalMemFree(queue);
+        return HDF_FAILURE;
+    }
+    cfg.name = queue->name;
+    cfg.priority = OSAL_THREAD_PRI_HIGH;
+    cfg.stackSize = SPI_QUEUE_STACK_SIZE;
+    if (OsalThreadCreate(&queue->thread, (OsalThreadEntry)SpiQueueThread, (void *)queue) != HDF_SUCCESS) {
+        HDF_LOGE("%s: create queue thread failed", __func__);
+        (void)OsalSemDestroy(&queue->exited);
+        (void)OsalSemDestroy(&queue->sem);
+        (void)OsalSpinDestroy(&queue->spin);
+        OsalMemFree(queue);
+        return HDF_ERR_THREAD_CREATE_FAIL;
+    }
+    if (OsalThreadStart(&queue->thread, &cfg) != HDF_SUCCESS) {
+        HDF_LOGE("%s: start queue thread failed", __func__);
+        (void)OsalThreadDestroy(&queue->thread);
+        (void)OsalSemDestroy(&queue->exited);
+        (void)OsalSemDestroy(&queue->sem);
+        (void)OsalSpinDestroy(&queue->spin);
+        OsalMemFree(queue);
+        return HDF_FAILURE;
+    }
+    cntlr->queue = queue;
+    return HDF_SUCCESS;
+}
+
+static void SpiQueueDestroy(struct SpiQueue *queue)
+{
+    uint32_t i;
+    struct SpiAsyncMsg *async = NULL;
+
+    (void)OsalSpinLock(&queue->spin);
+    queue->stop = true;
+    (void)OsalSpinUnlock(&queue->spin);
+    (void)OsalSemPost(&queue->sem);
+    (void)OsalSemWait(&queue->exited, HDF_WAIT_FOREVER);
+
+    /* requests never sent are failed, so their owners do not wait forever */
+    for (i = queue->tail; i != queue->head; i++) {
+        async = queue->entries[i & (SPI_QUEUE_DEPTH - 1)].async;
+        async->callback(async, HDF_ERR_IO);
+    }
+    (void)OsalThreadDestroy(&queue->thread);
+    (void)OsalSemDestroy(&queue->exited);
+    (void)OsalSemDestroy(&queue->sem);
+    (void)OsalSpinDestroy(&queue->spin);
+    OsalMemFree(queue);
+}
+
+int32_t SpiCntlrTransferAsync(struct SpiCntlr *cntlr, uint32_t csNum, struct SpiAsyncMsg *async)
+{
+    int32_t ret = HDF_SUCCESS;
+    struct SpiQueue *queue = NULL;
+
+    if (cntlr == NULL || async == NULL || async->msgs == NULL || async->count == 0 || async->callback == NULL) {
+        HDF_LOGE("%s: invalid parameter", __func__);
+        return HDF_ERR_INVALID_PARAM;
+    }
+    if (cntlr->method == NULL || cntlr->method->Transfer == NULL) {
+        HDF_LOGE("%s: transfer not support", __func__);
+        return HDF_ERR_NOT_SUPPORT;
+    }
+    if (cntlr->queue == NULL) {
+        (void)OsalMutexLock(&(cntlr->lock));
+        if (cntlr->queue == NULL) {
+            ret = SpiQueueCreate(cntlr);
+        }
+        (void)OsalMutexUnlock(&(cntlr->lock));
+        if (ret != HDF_SUCCESS) {
+            return ret;
+        }
+    }
+
+    queue = cntlr->queue;
+    (void)OsalSpinLock(&queue->spin);
+    if (queue->stop) {
+        ret = HDF_ERR_INVALID_OBJECT;
+    } else if (queue->head - queue->tail >= SPI_QUEUE_DEPTH) {
+        ret = HDF_ERR_QUEUE_FULL;
+    } else {
+        queue->entries[queue->head & (SPI_QUEUE_DEPTH - 1)].async = async;
+        queue->entries[queue->head & (SPI_QUEUE_DEPTH - 1)].csNum = csNum;
+        queue->head++;
+    }
+    (void)OsalSpinUnlock(&queue->spin);
+    if (ret == HDF_SUCCESS) {
+        (void)OsalSemPost(&queue->sem);
+    }
+    return ret;
+}
+
+int32_t SpiCntlrGetStats(struct SpiCntlr *cntlr, struct SpiCntlrStats *stats)
+{
+    if (cntlr == NULL || stats == NULL) {
+        HDF_LOGE("%s: invalid parameter", __func__);
+        return HDF_ERR_INVALID_PARAM;
+    }
+    (void)OsalMutexLock(&(cntlr->lock));
+    *stats = cntlr->stats;
+    (void)OsalMutexUnlock(&(cntlr->lock));
+    return HDF_SUCCESS;
+}
+
 void SpiCntlrDestroy(struct SpiCntlr *cntlr)
 {
     if (cntlr == NULL) {
         return;
     }
+    if (cntlr->queue != NULL) {
+        SpiQueueDestroy(cntlr->queue);
+        cntlr->queue = NULL;
+    }
+    PlatformStatsUnregister(&cntlr->xferStats);
     (void)OsalMutexDestroy(&(cntlr->lock));
     OsalMemFree(cntlr);
 }
@@ -141,5 +413,6 @@ struct SpiCntlr *SpiCntlrCreate(struct HdfDeviceObject *device)
     (void)OsalMutexInit(&cntlr->lock);
     DListHeadInit(&cntlr->list);
     cntlr->priv = NULL;
+    cntlr->cfgCs = SPI_CS_NONE;
     return cntlr;
 }
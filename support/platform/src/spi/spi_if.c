@@ -53,6 +53,17 @@ int32_t SpiTransfer(DevHandle handle, struct SpiMsg *msgs, uint32_t count)
     return SpiCntlrTransfer(obj->cntlr, obj->csNum, msgs, count);
 }
 
+int32_t SpiTransferAsync(DevHandle handle, struct SpiAsyncMsg *async)
+{
+    struct SpiObject *obj = NULL;
+
+    if (handle == NULL) {
+        return HDF_ERR_INVALID_PARAM;
+    }
+    obj = (struct SpiObject *)handle;
+    return SpiCntlrTransferAsync(obj->cntlr, obj->csNum, async);
+}
+
 int32_t SpiRead(DevHandle handle, uint8_t *buf, uint32_t len)
 {
     struct SpiMsg msg = {0};
@@ -9,10 +9,449 @@
 #include "uart_core.h"
 #include "hdf_log.h"
 #include "osal_mem.h"
+#include "platform_core.h"
+#include "securec.h"
 #include "uart_if.h"
 
 #define HDF_LOG_TAG uart_core
 
+#define UART_BUFFER_SIZE_MAX 0x10000
+
+/* runs the watermark notifications and the delayed flushes of all ports */
+static HdfWorkQueue g_uartWorkQueue;
+static bool g_uartWorkQueueReady = false;
+static struct OsalMutex g_uartWorkQueueLock;
+static bool g_uartWorkQueueLockReady = false;
+
+/* the first port configuring a buffer creates the work queue, ports may be configured concurrently */
+static int32_t UartWorkQueueInit(void)
+{
+    int32_t ret = HDF_SUCCESS;
+
+    PlatformGlobalLock();
+    if (!g_uartWorkQueueLockReady) {
+        ret = OsalMutexInit(&g_uartWorkQueueLock);
+        g_uartWorkQueueLockReady = (ret == HDF_SUCCESS);
+    }
+    PlatformGlobalUnlock();
+    if (ret != HDF_SUCCESS) {
+        return ret;
+    }
+
+    (void)OsalMutexLock(&g_uartWorkQueueLock);
+    if (!g_uartWorkQueueReady) {
+        ret = HdfWorkQueueInit(&g_uartWorkQueue, "uart_buffer");
+        g_uartWorkQueueReady = (ret == HDF_SUCCESS);
+    }
+    (void)OsalMutexUnlock(&g_uartWorkQueueLock);
+    return ret;
+}
+
+static void UartRxNotifyWork(void *arg)
+{
+    uint32_t flags;
+    uint32_t count;
+    struct HdfSBuf *event = NULL;
+    struct UartRxRing *rx = (struct UartRxRing *)arg;
+    struct UartHost *host = rx->host;
+
+    (void)OsalSpinLockIrqSave(&rx->spin, &flags);
+    count = rx->head - rx->tail;
+    rx->events++;
+    (void)OsalSpinUnlockIrqRestore(&rx->spin, &flags);
+
+    event = HdfSBufObtainDefaultSize();
+    if (event == NULL) {
+        HDF_LOGE("%s: obtain event sbuf failed", __func__);
+        return;
+    }
+    if (!HdfSbufWriteUint32(event, count) ||
+        HdfDeviceSendEvent(host->device, UART_EVENT_RX_WATERMARK, event) != HDF_SUCCESS) {
+        HDF_LOGE("%s: send watermark event of uart %u failed", __func__, host->num);
+    }
+    HdfSBufRecycle(event);
+}
+
+/* takes no lock on host->rx: the ring is set before rx push is enabled and freed after it is disabled */
+int32_t UartHostRxPut(struct UartHost *host, const uint8_t *data, uint32_t size)
+{
+    uint32_t flags;
+    uint32_t count;
+    uint32_t offset;
+    uint32_t first;
+    bool notify = false;
+    struct UartRxRing *rx = NULL;
+
+    if (host == NULL || data == NULL) {
+        return HDF_ERR_INVALID_PARAM;
+    }
+    rx = host->rx;
+    if (rx == NULL) {
+        return HDF_ERR_NOT_SUPPORT;
+    }
+
+    (void)OsalSpinLockIrqSave(&rx->spin, &flags);
+    count = rx->size - (rx->head - rx->tail);
+    count = (size < count) ? size : count;
+    offset = rx->head & (rx->size - 1);
+    first = (count < rx->size - offset) ? count : (rx->size - offset);
+    (void)memcpy_s(&rx->buf[offset], rx->size - offset, data, first);
+    (void)memcpy_s(rx->buf, rx->size, data + first, count - first);
+    rx->head += count;
+    rx->dropped += size - count;
+    if (rx->watermark != 0 && !rx->notified && rx->head - rx->tail >= rx->watermark) {
+        rx->notified = true;
+        notify = true;
+    }
+    (void)OsalSpinUnlockIrqRestore(&rx->spin, &flags);
+
+    if (notify) {
+        (void)HdfAddWork(&g_uartWorkQueue, &rx->notifyWork);
+    }
+    return (int32_t)count;
+}
+
+/* mark count bytes from the tail as read, the caller must have copied them */
+static void UartRxRingConsume(struct UartRxRing *rx, uint32_t count)
+{
+    uint32_t flags;
+
+    (void)OsalSpinLockIrqSave(&rx->spin, &flags);
+    rx->tail += count;
+    if (rx->notified && rx->head - rx->tail < rx->watermark) {
+        rx->notified = false;
+    }
+    (void)OsalSpinUnlockIrqRestore(&rx->spin, &flags);
+}
+
+/*
+ * The bytes available from the tail up to the end of the buffer. The rx path never overwrites
+ * unread data and readers hold host->rxLock until they consumed, so they can be copied without the spin.
+ */
+static uint32_t UartRxRingSegment(struct UartRxRing *rx, uint32_t *offset)
+{
+    uint32_t flags;
+    uint32_t count;
+
+    (void)OsalSpinLockIrqSave(&rx->spin, &flags);
+    count = rx->head - rx->tail;
+    *offset = rx->tail & (rx->size - 1);
+    (void)OsalSpinUnlockIrqRestore(&rx->spin, &flags);
+    return (count < rx->size - *offset) ? count : (rx->size - *offset);
+}
+
+/* called with host->rxLock held */
+static int32_t UartRxRingRead(struct UartRxRing *rx, uint8_t *data, uint32_t size)
+{
+    uint32_t done = 0;
+    uint32_t count;
+    uint32_t offset;
+
+    /* at most two segments, before and after the wrap */
+    while (done < size && (count = UartRxRingSegment(rx, &offset)) > 0) {
+        count = (count < size - done) ? count : (size - done);
+        (void)memcpy_s(data + done, size - done, &rx->buf[offset], count);
+        UartRxRingConsume(rx, count);
+        done += count;
+    }
+    return (int32_t)done;
+}
+
+int32_t UartHostRead(struct UartHost *host, uint8_t *data, uint32_t size)
+{
+    int32_t ret = HDF_SUCCESS;
+    bool ring = false;
+    struct PlatformStatsStamp stamp;
+
+    if (host == NULL || host->method == NULL) {
+        return HDF_ERR_NOT_SUPPORT;
+    }
+    PlatformStatsBegin(&stamp);
+    (void)OsalMutexLock(&host->rxLock);
+    ring = (host->rx != NULL);
+    if (ring && data != NULL) {
+        ret = UartRxRingRead(host->rx, data, size);
+    }
+    (void)OsalMutexUnlock(&host->rxLock);
+    if (ring && data == NULL) {
+        return HDF_ERR_INVALID_PARAM;
+    }
+    if (!ring) {
+        if (host->method->Read == NULL) {
+            return HDF_ERR_NOT_SUPPORT;
+        }
+        /* may block until data arrives, so not under rxLock */
+        ret = host->method->Read(host, data, size);
+    }
+    /* ret is the number of bytes read */
+    PlatformStatsEnd(&host->xferStats, &stamp, (ret > 0) ? (uint32_t)ret : 0, ret);
+    return ret;
+}
+
+static int32_t UartTxQueueFlushLocked(struct UartHost *host, struct UartTxQueue *tx)
+{
+    int32_t ret = HDF_SUCCESS;
+
+    if (tx->len > 0) {
+        ret = host->method->Write(host, tx->buf, tx->len);
+        tx->len = 0;
+    }
+    return ret;
+}
+
+static void UartTxFlushWork(void *arg)
+{
+    int32_t ret = HDF_SUCCESS;
+    struct UartTxQueue *tx = (struct UartTxQueue *)arg;
+    struct UartHost *host = tx->host;
+
+    (void)OsalMutexLock(&host->txLock);
+    /* a queue detached by a reconfiguration was flushed there */
+    if (host->tx == tx) {
+        ret = UartTxQueueFlushLocked(host, tx);
+    }
+    (void)OsalMutexUnlock(&host->txLock);
+    if (ret != HDF_SUCCESS) {
+        HDF_LOGE("%s: flush uart %u failed, ret %d", __func__, host->num, ret);
+    }
+}
+
+int32_t UartHostWrite(struct UartHost *host, uint8_t *data, uint32_t size)
+{
+    int32_t ret = HDF_SUCCESS;
+    struct UartTxQueue *tx = NULL;
+    struct PlatformStatsStamp stamp;
+
+    if (host == NULL || host->method == NULL || host->method->Write == NULL) {
+        return HDF_ERR_NOT_SUPPORT;
+    }
+    PlatformStatsBegin(&stamp);
+    (void)OsalMutexLock(&host->txLock);
+    tx = host->tx;
+    if (tx == NULL) {
+        (void)OsalMutexUnlock(&host->txLock);
+        ret = host->method->Write(host, data, size);
+        PlatformStatsEnd(&host->xferStats, &stamp, (ret == HDF_SUCCESS) ? size : 0, ret);
+        return ret;
+    }
+    if (data == NULL) {
+        (void)OsalMutexUnlock(&host->txLock);
+        return HDF_ERR_INVALID_PARAM;
+    }
+
+    PlatformStatsLocked(&stamp);
+    if (tx->len + size > tx->size) {
+        ret = UartTxQueueFlushLocked(host, tx);
+    }
+    if (ret == HDF_SUCCESS && size >= tx->size) {
+        /* too large to gain from queueing */
+        ret = host->method->Write(host, data, size);
+    } else if (ret == HDF_SUCCESS) {
+        (void)memcpy_s(tx->buf + tx->len, tx->size - tx->len, data, size);
+        if (tx->len == 0) {
+            /* armed under txLock, so a queue detached from the host is never armed again */
+            (void)HdfAddDelayedWork(&g_uartWorkQueue, &tx->flushWork, tx->flushDelay);
+        }
+        tx->len += size;
+    }
+    (void)OsalMutexUnlock(&host->txLock);
+    /* a queued write counts the copy into the queue, its flush is part of a later call */
+    PlatformStatsEnd(&host->xferStats, &stamp, (ret == HDF_SUCCESS) ? size : 0, ret);
+    return ret;
+}
+
+int32_t UartHostFlush(struct UartHost *host)
+{
+    int32_t ret = HDF_SUCCESS;
+
+    if (host == NULL || host->method == NULL) {
+        return HDF_ERR_INVALID_PARAM;
+    }
+    (void)OsalMutexLock(&host->txLock);
+    if (host->tx != NULL) {
+        ret = UartTxQueueFlushLocked(host, host->tx);
+    }
+    (void)OsalMutexUnlock(&host->txLock);
+    return ret;
+}
+
+/* called with host->rxLock held, the ring is freed by UartRxRingFree once the lock is dropped */
+static struct UartRxRing *UartHostRxRingDetach(struct UartHost *host)
+{
+    struct UartRxRing *rx = host->rx;
+
+    if (rx == NULL) {
+        return NULL;
+    }
+    if (host->method->SetRxPush != NULL) {
+        (void)host->method->SetRxPush(host, false);
+    }
+    host->rx = NULL;
+    return rx;
+}
+
+static void UartRxRingFree(struct UartRxRing *rx)
+{
+    if (rx == NULL) {
+        return;
+    }
+    (void)HdfCancelWorkSync(&rx->notifyWork);
+    HdfWorkDestroy(&rx->notifyWork);
+    (void)OsalSpinDestroy(&rx->spin);
+    if (rx->dropped != 0) {
+        HDF_LOGW("%s: uart %u dropped %u bytes on a full ring", __func__, rx->host->num, rx->dropped);
+    }
+    OsalMemFree(rx);
+}
+
+/* called with host->rxLock held */
+static int32_t UartHostRxRingAlloc(struct UartHost *host, uint32_t size, uint32_t watermark)
+{
+    int32_t ret;
+    struct UartRxRing *rx = NULL;
+
+    if (host->method->SetRxPush == NULL) {
+        HDF_LOGE("%s: uart %u can not fill a receive ring", __func__, host->num);
+        return HDF_ERR_NOT_SUPPORT;
+    }
+    rx = (struct UartRxRing *)OsalMemCalloc(sizeof(*rx) + size);
+    if (rx == NULL) {
+        return HDF_ERR_MALLOC_FAIL;
+    }
+    rx->buf = (uint8_t *)(rx + 1);
+    rx->size = size;
+    rx->watermark = watermark;
+    rx->host = host;
+    if (OsalSpinInit(&rx->spin) != HDF_SUCCESS) {
+        OsalMemFree(rx);
+        return HDF_FAILURE;
+    }
+    if (HdfWorkInit(&rx->notifyWork, UartRxNotifyWork, rx) != HDF_SUCCESS) {
+        (void)OsalSpinDestroy(&rx->spin);
+        OsalMemFree(rx);
+        return HDF_FAILURE;
+    }
+    host->rx = rx;
+    ret = host->method->SetRxPush(host, true);
+    if (ret != HDF_SUCCESS) {
+        HDF_LOGE("%s: enable rx push of uart %u failed, ret %d", __func__, host->num, ret);
+        host->rx = NULL;
+        HdfWorkDestroy(&rx->notifyWork);
+        (void)OsalSpinDestroy(&rx->spin);
+        OsalMemFree(rx);
+    }
+    return ret;
+}
+
+/*
+ * Called with host->txLock held. The queue is flushed and taken from the host before its work
+ * is cancelled by UartTxQueueFree, so no writer can arm the work again in between.
+ */
+static struct UartTxQueue *UartHostTxQueueDetach(struct UartHost *host)
+{
+    struct UartTxQueue *tx = host->tx;
+
+    if (tx == NULL) {
+        return NULL;
+    }
+    if (UartTxQueueFlushLocked(host, tx) != HDF_SUCCESS) {
+        HDF_LOGE("%s: flush uart %u failed", __func__, host->num);
+    }
+    host->tx = NULL;
+    return tx;
+}
+
+/* called without host->txLock, the flush work takes it */
+static void UartTxQueueFree(struct UartTxQueue *tx)
+{
+    if (tx == NULL) {
+        return;
+    }
+    (void)HdfCancelDelayedWorkSync(&tx->flushWork);
+    HdfDelayedWorkDestroy(&tx->flushWork);
+    OsalMemFree(tx);
+}
+
+/* called with host->txLock held */
+static int32_t UartHostTxQueueAlloc(struct UartHost *host, uint32_t size, uint32_t flushDelay)
+{
+    struct UartTxQueue *tx = NULL;
+
+    tx = (struct UartTxQueue *)OsalMemCalloc(sizeof(*tx) + size);
+    if (tx == NULL) {
+        return HDF_ERR_MALLOC_FAIL;
+    }
+    tx->buf = (uint8_t *)(tx + 1);
+    tx->size = size;
+    tx->flushDelay = flushDelay;
+    tx->host = host;
+    if (HdfDelayedWorkInit(&tx->flushWork, UartTxFlushWork, tx) != HDF_SUCCESS) {
+        OsalMemFree(tx);
+        return HDF_FAILURE;
+    }
+    host->tx = tx;
+    return HDF_SUCCESS;
+}
+
+static void UartHostBufferFree(struct UartHost *host)
+{
+    struct UartRxRing *rx = NULL;
+    struct UartTxQueue *tx = NULL;
+
+    (void)OsalMutexLock(&host->txLock);
+    (void)OsalMutexLock(&host->rxLock);
+    tx = UartHostTxQueueDetach(host);
+    rx = UartHostRxRingDetach(host);
+    (void)OsalMutexUnlock(&host->rxLock);
+    (void)OsalMutexUnlock(&host->txLock);
+    UartTxQueueFree(tx);
+    UartRxRingFree(rx);
+}
+
+int32_t UartHostSetBufferConfig(struct UartHost *host, const struct UartBufferConfig *config)
+{
+    int32_t ret = HDF_SUCCESS;
+    struct UartRxRing *oldRx = NULL;
+    struct UartTxQueue *oldTx = NULL;
+    struct UartRxRing *failedRx = NULL;
+
+    if (host == NULL || host->method == NULL || config == NULL) {
+        return HDF_ERR_INVALID_PARAM;
+    }
+    if (config->rxRingSize > UART_BUFFER_SIZE_MAX || (config->rxRingSize & (config->rxRingSize - 1)) != 0 ||
+        config->rxWatermark > config->rxRingSize || config->txQueueSize > UART_BUFFER_SIZE_MAX) {
+        HDF_LOGE("%s: invalid config, ring %u watermark %u queue %u", __func__,
+            config->rxRingSize, config->rxWatermark, config->txQueueSize);
+        return HDF_ERR_INVALID_PARAM;
+    }
+    if ((config->rxRingSize != 0 || config->txQueueSize != 0) && UartWorkQueueInit() != HDF_SUCCESS) {
+        HDF_LOGE("%s: init work queue failed", __func__);
+        return HDF_FAILURE;
+    }
+
+    /* readers and writers see either the old buffers or the new ones, never freed ones */
+    (void)OsalMutexLock(&host->txLock);
+    (void)OsalMutexLock(&host->rxLock);
+    oldTx = UartHostTxQueueDetach(host);
+    oldRx = UartHostRxRingDetach(host);
+    if (config->rxRingSize != 0) {
+        ret = UartHostRxRingAlloc(host, config->rxRingSize, config->rxWatermark);
+    }
+    if (ret == HDF_SUCCESS && config->txQueueSize != 0) {
+        ret = UartHostTxQueueAlloc(host, config->txQueueSize, config->txFlushDelay);
+        if (ret != HDF_SUCCESS) {
+            failedRx = UartHostRxRingDetach(host);
+        }
+    }
+    (void)OsalMutexUnlock(&host->rxLock);
+    (void)OsalMutexUnlock(&host->txLock);
+
+    UartTxQueueFree(oldTx);
+    UartRxRingFree(oldRx);
+    UartRxRingFree(failedRx);
+    return ret;
+}
+
 int32_t UartHostInit(struct UartHost *host)
 {
     int32_t ret;
@@ -31,6 +470,7 @@ int32_t UartHostInit(struct UartHost *host)
             return ret;
         }
     }
+    (void)PlatformStatsRegister(&host->xferStats, PLATFORM_MODULE_UART, host->num);
     return HDF_SUCCESS;
 }
 
@@ -41,6 +481,7 @@ int32_t UartHostDeinit(struct UartHost *host)
     if (host == NULL || host->method == NULL) {
         return HDF_ERR_INVALID_PARAM;
     }
+    UartHostBufferFree(host);
     if (host->method->Deinit != NULL) {
         ret = host->method->Deinit(host);
         if (ret != HDF_SUCCESS) {
@@ -51,17 +492,44 @@ int32_t UartHostDeinit(struct UartHost *host)
     return HDF_SUCCESS;
 }
 
+/* the receive ring is written to the reply as it is, without a bounce buffer; called with host->rxLock held */
+static int32_t UartUserReadRing(struct UartRxRing *rx, struct HdfSBuf *reply, size_t size)
+{
+    uint32_t count;
+    uint32_t offset;
+
+    count = UartRxRingSegment(rx, &offset);
+    count = (count < size) ? count : (uint32_t)size;
+    if (!HdfSbufWriteBuffer(reply, &rx->buf[offset], count)) {
+        HDF_LOGE("%s: sbuf write buffer failed", __func__);
+        return HDF_ERR_IO;
+    }
+    UartRxRingConsume(rx, count);
+    return HDF_SUCCESS;
+}
+
 static int32_t UartUserRead(struct UartHost *host, struct HdfSBuf *reply)
 {
     size_t size;
+    int32_t ret;
     int32_t len;
     uint8_t *buf = NULL;
 
     size = HdfSbufGetCapacity(reply);
-    if (size == 0) {
-        HDF_LOGE("%s: the size of Sbuf is 0", __func__);
+    if (size <= sizeof(uint64_t)) {
+        HDF_LOGE("%s: the size of Sbuf is %u", __func__, (uint32_t)size);
         return HDF_ERR_INVALID_PARAM;
     }
+    /* room for the buffer length, as reserved by the reader */
+    size -= sizeof(uint64_t);
+    (void)OsalMutexLock(&host->rxLock);
+    if (host->rx != NULL) {
+        ret = UartUserReadRing(host->rx, reply, size);
+        (void)OsalMutexUnlock(&host->rxLock);
+        return ret;
+    }
+    (void)OsalMutexUnlock(&host->rxLock);
+
     buf = (uint8_t *)OsalMemCalloc(sizeof(*buf) * size);
     if (buf == NULL) {
         HDF_LOGE("%s: OsalMemCalloc error", __func__);
@@ -162,6 +630,18 @@ static int32_t UartUserSetTransMode(struct UartHost *host, struct HdfSBuf *data)
     return UartHostSetTransMode(host, *mode);
 }
 
+static int32_t UartUserSetBufferConfig(struct UartHost *host, struct HdfSBuf *data)
+{
+    uint32_t size;
+    struct UartBufferConfig *config = NULL;
+
+    if (!HdfSbufReadBuffer(data, (const void **)&config, &size) || config == NULL || size != sizeof(*config)) {
+        HDF_LOGE("%s: sbuf read buffer failed", __func__);
+        return HDF_ERR_IO;
+    }
+    return UartHostSetBufferConfig(host, config);
+}
+
 static int32_t UartIoDispatch(struct HdfDeviceIoClient *client, int cmd,
     struct HdfSBuf *data, struct HdfSBuf *reply)
 {
@@ -202,6 +682,10 @@ static int32_t UartIoDispatch(struct HdfDeviceIoClient *client, int cmd,
             return UartUserSetAttribute(host, data);
         case UART_IO_SET_TRANSMODE:
             return UartUserSetTransMode(host, data);
+        case UART_IO_SET_BUFFER_CONFIG:
+            return UartUserSetBufferConfig(host, data);
+        case UART_IO_FLUSH:
+            return UartHostFlush(host);
         default:
             return HDF_ERR_NOT_SUPPORT;
     }
@@ -212,6 +696,12 @@ void UartHostDestroy(struct UartHost *host)
     if (host == NULL) {
         return;
     }
+    if (host->method != NULL) {
+        UartHostBufferFree(host);
+    }
+    PlatformStatsUnregister(&host->xferStats);
+    (void)OsalMutexDestroy(&host->rxLock);
+    (void)OsalMutexDestroy(&host->txLock);
     OsalMemFree(host);
 }
 
@@ -228,6 +718,17 @@ struct UartHost *UartHostCreate(struct HdfDeviceObject *device)
         HDF_LOGE("%s: OsalMemCalloc error", __func__);
         return NULL;
     }
+    if (OsalMutexInit(&host->rxLock) != HDF_SUCCESS) {
+        HDF_LOGE("%s: init rx lock failed", __func__);
+        OsalMemFree(host);
+        return NULL;
+    }
+    if (OsalMutexInit(&host->txLock) != HDF_SUCCESS) {
+        HDF_LOGE("%s: init tx lock failed", __func__);
+        (void)OsalMutexDestroy(&host->rxLock);
+        OsalMemFree(host);
+        return NULL;
+    }
     host->device = device;
     device->service = &(host->service);
     host->device->service->Dispatch = UartIoDispatch;
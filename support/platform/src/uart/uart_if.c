@@ -254,3 +254,30 @@ int32_t UartSetTransMode(DevHandle handle, enum UartTransMode mode)
     return UartHostSetTransMode((struct UartHost *)handle, mode);
 #endif
 }
+
+int32_t UartSetBufferConfig(DevHandle handle, const struct UartBufferConfig *config)
+{
+    if (config == NULL) {
+        return HDF_ERR_INVALID_PARAM;
+    }
+#ifdef __USER__
+    return UartUserSend(handle, (void *)config, sizeof(*config), UART_IO_SET_BUFFER_CONFIG);
+#else
+    return UartHostSetBufferConfig((struct UartHost *)handle, config);
+#endif
+}
+
+int32_t UartFlush(DevHandle handle)
+{
+#ifdef __USER__
+    struct HdfIoService *service = (struct HdfIoService *)handle;
+
+    if (service == NULL || service->dispatcher == NULL || service->dispatcher->Dispatch == NULL) {
+        HDF_LOGE("%s: service is invalid", __func__);
+        return HDF_ERR_INVALID_PARAM;
+    }
+    return service->dispatcher->Dispatch(&service->object, UART_IO_FLUSH, NULL, NULL);
+#else
+    return UartHostFlush((struct UartHost *)handle);
+#endif
+}
@@ -81,3 +81,27 @@ HWTEST_F(HdfLiteAdcTest, AdcTestReliability001, TestSize.Level1)
     EXPECT_EQ(0, HdfTestSendMsgToService(&msg));
 }
 
+
+/**
+  * @tc.name: AdcTestScan001
+  * @tc.desc: adc scan ring, oversampling and software sampling test
+  * @tc.type: FUNC
+  * @tc.require: NA
+  */
+HWTEST_F(HdfLiteAdcTest, AdcTestScan001, TestSize.Level1)
+{
+    struct HdfTestMsg msg = {TEST_PAL_ADC_TYPE, ADC_TEST_CMD_SCAN, -1};
+    EXPECT_EQ(0, HdfTestSendMsgToService(&msg));
+}
+
+/**
+  * @tc.name: AdcTestScanBench001
+  * @tc.desc: adc scan throughput against single reads
+  * @tc.type: PERF
+  * @tc.require: NA
+  */
+HWTEST_F(HdfLiteAdcTest, AdcTestScanBench001, TestSize.Level1)
+{
+    struct HdfTestMsg msg = {TEST_PAL_ADC_TYPE, ADC_TEST_CMD_SCAN_BENCH, -1};
+    EXPECT_EQ(0, HdfTestSendMsgToService(&msg));
+}
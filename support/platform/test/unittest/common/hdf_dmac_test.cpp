@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2021 Huawei Device Co., Ltd.
+ *
+ * HDF is dual licensed: you can use it either under the terms of
+ * the GPL, or the BSD license, at your option.
+ * See the LICENSE file in the root of this repository for complete details.
+ */
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fcntl.h>
+#include <gtest/gtest.h>
+#include <string>
+#include <unistd.h>
+#include "hdf_io_service_if.h"
+#include "hdf_uhdf_test.h"
+
+using namespace testing::ext;
+
+enum DmacTestCmd {
+    DMAC_TEST_ASYNC_SG = 0,
+    DMAC_TEST_BENCH,
+};
+
+class HdfLiteDmacTest : public testing::Test {
+public:
+    static void SetUpTestCase();
+    static void TearDownTestCase();
+    void SetUp();
+    void TearDown();
+};
+
+void HdfLiteDmacTest::SetUpTestCase()
+{
+    HdfTestOpenService();
+}
+
+void HdfLiteDmacTest::TearDownTestCase()
+{
+    HdfTestCloseService();
+}
+
+void HdfLiteDmacTest::SetUp()
+{
+}
+
+void HdfLiteDmacTest::TearDown()
+{
+}
+
+/**
+  * @tc.name: DmacAsyncSg001
+  * @tc.desc: a scatter-gather list is copied by one descriptor chain and ends through its fence.
+  * @tc.type: FUNC
+  * @tc.require: NA
+  */
+HWTEST_F(HdfLiteDmacTest, DmacAsyncSg001, TestSize.Level1)
+{
+    struct HdfTestMsg msg = {TEST_PAL_DMAC_TYPE, DMAC_TEST_ASYNC_SG, -1};
+    EXPECT_EQ(0, HdfTestSendMsgToService(&msg));
+}
+
+/**
+  * @tc.name: DmacBench001
+  * @tc.desc: throughput and per request cost of blocking and async transfers on the virtual engine.
+  * @tc.type: PERF
+  * @tc.require: NA
+  */
+HWTEST_F(HdfLiteDmacTest, DmacBench001, TestSize.Level1)
+{
+    struct HdfTestMsg msg = {TEST_PAL_DMAC_TYPE, DMAC_TEST_BENCH, -1};
+    EXPECT_EQ(0, HdfTestSendMsgToService(&msg));
+}
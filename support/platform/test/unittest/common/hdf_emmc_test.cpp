@@ -21,6 +21,7 @@ using namespace testing::ext;
 
 enum EmmcTestCmd {
     EMMC_GET_CID_01 = 0,
+    EMMC_REQ_QUEUE_BENCH_02,
 };
 
 class HdfLiteEmmcTest : public testing::Test {
@@ -72,3 +73,15 @@ HWTEST_F(HdfLiteEmmcTest, EmmcGetCid001, TestSize.Level1)
     EXPECT_EQ(0, HdfTestSendMsgToService(&msg));
     TestUserEmmcGetCid();
 }
+
+/**
+  * @tc.name: EmmcReqQueueBench001
+  * @tc.desc: compare blocking and queued sequential writes on a fake mmc controller.
+  * @tc.type: FUNC
+  * @tc.require: NA
+  */
+HWTEST_F(HdfLiteEmmcTest, EmmcReqQueueBench001, TestSize.Level1)
+{
+    struct HdfTestMsg msg = {TEST_PAL_EMMC_TYPE, EMMC_REQ_QUEUE_BENCH_02, -1};
+    EXPECT_EQ(0, HdfTestSendMsgToService(&msg));
+}
@@ -140,3 +140,35 @@ HWTEST_F(HdfLiteGpioTest, GpioTestReliability001, TestSize.Level1)
     EXPECT_EQ(0, GpioTestExecute(GPIO_TEST_RELIABILITY));
     printf("%s: exit!\n", __func__);
 }
+
+/**
+  * @tc.name: GpioTestIrqPoolBench001
+  * @tc.desc: gpio threaded irq dispatch pool benchmark
+  * @tc.type: FUNC
+  * @tc.require: AR000F868H
+  */
+HWTEST_F(HdfLiteGpioTest, GpioTestIrqPoolBench001, TestSize.Level1)
+{
+    struct HdfTestMsg msg = {TEST_PAL_GPIO_TYPE, GPIO_TEST_IRQ_POOL_BENCH, -1};
+    EXPECT_EQ(0, HdfTestSendMsgToService(&msg));
+    printf("%s: kernel test done, then for user...\n", __func__);
+
+    EXPECT_EQ(0, GpioTestExecute(GPIO_TEST_IRQ_POOL_BENCH));
+    printf("%s: exit!\n", __func__);
+}
+
+/**
+  * @tc.name: GpioTestToggleBench001
+  * @tc.desc: gpio toggle rate with many controllers registered
+  * @tc.type: FUNC
+  * @tc.require: AR000F868H
+  */
+HWTEST_F(HdfLiteGpioTest, GpioTestToggleBench001, TestSize.Level1)
+{
+    struct HdfTestMsg msg = {TEST_PAL_GPIO_TYPE, GPIO_TEST_TOGGLE_BENCH, -1};
+    EXPECT_EQ(0, HdfTestSendMsgToService(&msg));
+    printf("%s: kernel test done, then for user...\n", __func__);
+
+    EXPECT_EQ(0, GpioTestExecute(GPIO_TEST_TOGGLE_BENCH));
+    printf("%s: exit!\n", __func__);
+}
@@ -29,6 +29,9 @@ enum HdmiTestCmd {
     HDMI_EDID_RAW_DATA_GET_01 = 5,
     HDMI_DEEP_COLOR_SET_AND_GET_01 = 6,
     HDMI_HPD_REGISTER_AND_UNREGISTER_01 = 7,
+    HDMI_CEC_TX_QUEUE_01 = 8,
+    HDMI_CEC_TX_QUEUE_BENCH_01 = 9,
+    HDMI_EDID_CACHE_01 = 10,
 };
 
 class HdfLiteHdmiTest : public testing::Test {
@@ -254,6 +257,42 @@ HWTEST_F(HdfLiteHdmiTest, HdmiHpdRegisterAndUngister001, TestSize.Level1)
     EXPECT_EQ(0, HdfTestSendMsgToService(&msg));
 }
 
+/**
+  * @tc.name: HdmiCecTxQueue001
+  * @tc.desc: test cec transmit queue priority, dedup and retry on a simulated bus in kernel status.
+  * @tc.type: FUNC
+  * @tc.require: NA
+  */
+HWTEST_F(HdfLiteHdmiTest, HdmiCecTxQueue001, TestSize.Level1)
+{
+    struct HdfTestMsg msg = { TEST_PAL_HDMI_TYPE, HDMI_CEC_TX_QUEUE_01, -1 };
+    EXPECT_EQ(0, HdfTestSendMsgToService(&msg));
+}
+
+/**
+  * @tc.name: HdmiCecTxQueueBench001
+  * @tc.desc: test cec transmit queue throughput and reply latency on a simulated bus in kernel status.
+  * @tc.type: PERF
+  * @tc.require: NA
+  */
+HWTEST_F(HdfLiteHdmiTest, HdmiCecTxQueueBench001, TestSize.Level1)
+{
+    struct HdfTestMsg msg = { TEST_PAL_HDMI_TYPE, HDMI_CEC_TX_QUEUE_BENCH_01, -1 };
+    EXPECT_EQ(0, HdfTestSendMsgToService(&msg));
+}
+
+/**
+  * @tc.name: HdmiEdidCache001
+  * @tc.desc: test edid cache on hot plug with a scripted ddc in kernel status.
+  * @tc.type: FUNC
+  * @tc.require: NA
+  */
+HWTEST_F(HdfLiteHdmiTest, HdmiEdidCache001, TestSize.Level1)
+{
+    struct HdfTestMsg msg = { TEST_PAL_HDMI_TYPE, HDMI_EDID_CACHE_01, -1 };
+    EXPECT_EQ(0, HdfTestSendMsgToService(&msg));
+}
+
 /**
   * @tc.name: HdmiUserTest001
   * @tc.desc: test hdmi all interface in user status.
@@ -122,3 +122,18 @@ HWTEST_F(HdfLiteI2cTest, HdfLiteI2cTestReliability001, TestSize.Level1)
     EXPECT_EQ(0, I2cTestExecute(I2C_TEST_CMD_RELIABILITY));
     printf("%s: exit!\n", __func__);
 }
+
+/**
+  * @tc.name: HdfLiteI2cTestXferBench001
+  * @tc.desc: compare I2cTransfer with I2cTransferByHandle on a simulated controller
+  * @tc.type: FUNC
+  * @tc.require: NA
+  */
+HWTEST_F(HdfLiteI2cTest, HdfLiteI2cTestXferBench001, TestSize.Level1)
+{
+    struct HdfTestMsg msg = {TEST_PAL_I2C_TYPE, I2C_TEST_CMD_XFER_BENCH, -1};
+    EXPECT_EQ(0, HdfTestSendMsgToService(&msg));
+    printf("%s: kernel test done, then for user...\n", __func__);
+    EXPECT_EQ(0, I2cTestExecute(I2C_TEST_CMD_XFER_BENCH));
+    printf("%s: exit!\n", __func__);
+}
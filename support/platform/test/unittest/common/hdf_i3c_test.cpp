@@ -132,3 +132,27 @@ HWTEST_F(HdfI3cTest, HdfI3cTestReliability001, TestSize.Level1)
     struct HdfTestMsg msg = {TEST_PAL_I3C_TYPE, I3C_TEST_CMD_RELIABILITY, -1};
     EXPECT_EQ(0, HdfTestSendMsgToService(&msg));
 }
+
+/**
+  * @tc.name: HdfI3cTestAddrAlloc001
+  * @tc.desc: i3c dynamic address allocation and address to device lookup test
+  * @tc.type: FUNC
+  * @tc.require: N/A
+  */
+HWTEST_F(HdfI3cTest, HdfI3cTestAddrAlloc001, TestSize.Level1)
+{
+    struct HdfTestMsg msg = {TEST_PAL_I3C_TYPE, I3C_TEST_CMD_ADDR_ALLOC, -1};
+    EXPECT_EQ(0, HdfTestSendMsgToService(&msg));
+}
+
+/**
+  * @tc.name: HdfI3cTestIbiBench001
+  * @tc.desc: i3c ibi dispatch latency with a full bus of targets
+  * @tc.type: PERF
+  * @tc.require: N/A
+  */
+HWTEST_F(HdfI3cTest, HdfI3cTestIbiBench001, TestSize.Level1)
+{
+    struct HdfTestMsg msg = {TEST_PAL_I3C_TYPE, I3C_TEST_CMD_IBI_BENCH, -1};
+    EXPECT_EQ(0, HdfTestSendMsgToService(&msg));
+}
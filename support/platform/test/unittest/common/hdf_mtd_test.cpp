@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2021 Huawei Device Co., Ltd.
+ *
+ * HDF is dual licensed: you can use it either under the terms of
+ * the GPL, or the BSD license, at your option.
+ * See the LICENSE file in the root of this repository for complete details.
+ */
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fcntl.h>
+#include <gtest/gtest.h>
+#include <string>
+#include <unistd.h>
+#include "hdf_io_service_if.h"
+#include "hdf_uhdf_test.h"
+
+using namespace testing::ext;
+
+enum MtdTestCmd {
+    MTD_TEST_BAD_BLOCK_TABLE = 0,
+    MTD_TEST_MULTI_PAGE_RW,
+};
+
+class HdfLiteMtdTest : public testing::Test {
+public:
+    static void SetUpTestCase();
+    static void TearDownTestCase();
+    void SetUp();
+    void TearDown();
+};
+
+void HdfLiteMtdTest::SetUpTestCase()
+{
+    HdfTestOpenService();
+}
+
+void HdfLiteMtdTest::TearDownTestCase()
+{
+    HdfTestCloseService();
+}
+
+void HdfLiteMtdTest::SetUp()
+{
+}
+
+void HdfLiteMtdTest::TearDown()
+{
+}
+
+/**
+  * @tc.name: MtdBadBlockTable001
+  * @tc.desc: bad block queries are answered from the cached table of a virtual nand.
+  * @tc.type: FUNC
+  * @tc.require: NA
+  */
+HWTEST_F(HdfLiteMtdTest, MtdBadBlockTable001, TestSize.Level1)
+{
+    struct HdfTestMsg msg = {TEST_PAL_FLASH_TYPE, MTD_TEST_BAD_BLOCK_TABLE, -1};
+    EXPECT_EQ(0, HdfTestSendMsgToService(&msg));
+}
+
+/**
+  * @tc.name: MtdMultiPageRw001
+  * @tc.desc: aligned read and write across a bad block use multi page transfers.
+  * @tc.type: FUNC
+  * @tc.require: NA
+  */
+HWTEST_F(HdfLiteMtdTest, MtdMultiPageRw001, TestSize.Level1)
+{
+    struct HdfTestMsg msg = {TEST_PAL_FLASH_TYPE, MTD_TEST_MULTI_PAGE_RW, -1};
+    EXPECT_EQ(0, HdfTestSendMsgToService(&msg));
+}
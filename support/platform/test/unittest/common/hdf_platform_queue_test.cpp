@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2021 Huawei Device Co., Ltd.
+ *
+ * HDF is dual licensed: you can use it either under the terms of
+ * the GPL, or the BSD license, at your option.
+ * See the LICENSE file in the root of this repository for complete details.
+ */
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fcntl.h>
+#include <gtest/gtest.h>
+#include <string>
+#include <unistd.h>
+#include "hdf_io_service_if.h"
+#include "hdf_uhdf_test.h"
+
+using namespace testing::ext;
+
+enum PlatformQueueTestCmd {
+    PLATFORM_QUEUE_TEST_KEY_ORDER = 0,
+    PLATFORM_QUEUE_TEST_BENCH,
+};
+
+class HdfLitePlatformQueueTest : public testing::Test {
+public:
+    static void SetUpTestCase();
+    static void TearDownTestCase();
+    void SetUp();
+    void TearDown();
+};
+
+void HdfLitePlatformQueueTest::SetUpTestCase()
+{
+    HdfTestOpenService();
+}
+
+void HdfLitePlatformQueueTest::TearDownTestCase()
+{
+    HdfTestCloseService();
+}
+
+void HdfLitePlatformQueueTest::SetUp()
+{
+}
+
+void HdfLitePlatformQueueTest::TearDown()
+{
+}
+
+/**
+  * @tc.name: PlatformQueueKeyOrder001
+  * @tc.desc: messages of a key are handled in order while the keys spread over the workers.
+  * @tc.type: FUNC
+  * @tc.require: NA
+  */
+HWTEST_F(HdfLitePlatformQueueTest, PlatformQueueKeyOrder001, TestSize.Level1)
+{
+    struct HdfTestMsg msg = {TEST_PAL_QUEUE_TYPE, PLATFORM_QUEUE_TEST_KEY_ORDER, -1};
+    EXPECT_EQ(0, HdfTestSendMsgToService(&msg));
+}
+
+/**
+  * @tc.name: PlatformQueueBench001
+  * @tc.desc: latency of fast messages queued among slow ones, with one worker and with a pool.
+  * @tc.type: PERF
+  * @tc.require: NA
+  */
+HWTEST_F(HdfLitePlatformQueueTest, PlatformQueueBench001, TestSize.Level1)
+{
+    struct HdfTestMsg msg = {TEST_PAL_QUEUE_TYPE, PLATFORM_QUEUE_TEST_BENCH, -1};
+    EXPECT_EQ(0, HdfTestSendMsgToService(&msg));
+}
@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2021 Huawei Device Co., Ltd.
+ *
+ * HDF is dual licensed: you can use it either under the terms of
+ * the GPL, or the BSD license, at your option.
+ * See the LICENSE file in the root of this repository for complete details.
+ */
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fcntl.h>
+#include <gtest/gtest.h>
+#include <string>
+#include <unistd.h>
+#include "hdf_io_service_if.h"
+#include "hdf_uhdf_test.h"
+
+using namespace testing::ext;
+
+enum PlatformStatsTestCmd {
+    PLATFORM_STATS_TEST_HIST = 0,
+    PLATFORM_STATS_TEST_CNTLR,
+    PLATFORM_STATS_TEST_OVERHEAD,
+};
+
+class HdfLitePlatformStatsTest : public testing::Test {
+public:
+    static void SetUpTestCase();
+    static void TearDownTestCase();
+    void SetUp();
+    void TearDown();
+};
+
+void HdfLitePlatformStatsTest::SetUpTestCase()
+{
+    HdfTestOpenService();
+}
+
+void HdfLitePlatformStatsTest::TearDownTestCase()
+{
+    HdfTestCloseService();
+}
+
+void HdfLitePlatformStatsTest::SetUp()
+{
+}
+
+void HdfLitePlatformStatsTest::TearDown()
+{
+}
+
+/**
+  * @tc.name: PlatformStatsHist001
+  * @tc.desc: known lock and bus times land in their log2 buckets, and reset clears them.
+  * @tc.type: FUNC
+  * @tc.require: NA
+  */
+HWTEST_F(HdfLitePlatformStatsTest, PlatformStatsHist001, TestSize.Level1)
+{
+    struct HdfTestMsg msg = {TEST_PAL_STATS_TYPE, PLATFORM_STATS_TEST_HIST, -1};
+    EXPECT_EQ(0, HdfTestSendMsgToService(&msg));
+}
+
+/**
+  * @tc.name: PlatformStatsCntlr001
+  * @tc.desc: counters of simulated i2c controllers, with a contended transfer and failed ones.
+  * @tc.type: FUNC
+  * @tc.require: NA
+  */
+HWTEST_F(HdfLitePlatformStatsTest, PlatformStatsCntlr001, TestSize.Level1)
+{
+    struct HdfTestMsg msg = {TEST_PAL_STATS_TYPE, PLATFORM_STATS_TEST_CNTLR, -1};
+    EXPECT_EQ(0, HdfTestSendMsgToService(&msg));
+}
+
+/**
+  * @tc.name: PlatformStatsOverhead001
+  * @tc.desc: time the counters add to each transfer.
+  * @tc.type: PERF
+  * @tc.require: NA
+  */
+HWTEST_F(HdfLitePlatformStatsTest, PlatformStatsOverhead001, TestSize.Level1)
+{
+    struct HdfTestMsg msg = {TEST_PAL_STATS_TYPE, PLATFORM_STATS_TEST_OVERHEAD, -1};
+    EXPECT_EQ(0, HdfTestSendMsgToService(&msg));
+}
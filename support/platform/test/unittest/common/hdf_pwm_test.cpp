@@ -21,6 +21,8 @@ enum PwmTestCmd {
     PWM_GET_CONFIG_TEST,
     PWM_RELIABILITY_TEST,
     PWM_TEST_ALL,
+    PWM_GROUP_TEST,
+    PWM_SEQUENCE_TEST,
 };
 
 class HdfLitePwmTest : public testing::Test {
@@ -132,3 +134,27 @@ HWTEST_F(HdfLitePwmTest, PwmDisableTest001, TestSize.Level1)
     struct HdfTestMsg msg = {TEST_PAL_PWM_TYPE, PWM_DISABLE_TEST, -1};
     EXPECT_EQ(0, HdfTestSendMsgToService(&msg));
 }
+
+/**
+  * @tc.name: PwmGroupTest001
+  * @tc.desc: pwm grouped update test on a simulated controller
+  * @tc.type: FUNC
+  * @tc.require: NA
+  */
+HWTEST_F(HdfLitePwmTest, PwmGroupTest001, TestSize.Level1)
+{
+    struct HdfTestMsg msg = {TEST_PAL_PWM_TYPE, PWM_GROUP_TEST, -1};
+    EXPECT_EQ(0, HdfTestSendMsgToService(&msg));
+}
+
+/**
+  * @tc.name: PwmSequenceTest001
+  * @tc.desc: pwm duty cycle sequence test on a simulated controller
+  * @tc.type: FUNC
+  * @tc.require: NA
+  */
+HWTEST_F(HdfLitePwmTest, PwmSequenceTest001, TestSize.Level1)
+{
+    struct HdfTestMsg msg = {TEST_PAL_PWM_TYPE, PWM_SEQUENCE_TEST, -1};
+    EXPECT_EQ(0, HdfTestSendMsgToService(&msg));
+}
@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2021 Huawei Device Co., Ltd.
+ *
+ * HDF is dual licensed: you can use it either under the terms of
+ * the GPL, or the BSD license, at your option.
+ * See the LICENSE file in the root of this repository for complete details.
+ */
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fcntl.h>
+#include <gtest/gtest.h>
+#include <string>
+#include <unistd.h>
+#include "hdf_io_service_if.h"
+#include "hdf_uhdf_test.h"
+
+using namespace testing::ext;
+
+enum RegmapTestCmd {
+    REGMAP_TEST_CACHE = 0,
+    REGMAP_TEST_SYNC,
+};
+
+class HdfLiteRegmapTest : public testing::Test {
+public:
+    static void SetUpTestCase();
+    static void TearDownTestCase();
+    void SetUp();
+    void TearDown();
+};
+
+void HdfLiteRegmapTest::SetUpTestCase()
+{
+    HdfTestOpenService();
+}
+
+void HdfLiteRegmapTest::TearDownTestCase()
+{
+    HdfTestCloseService();
+}
+
+void HdfLiteRegmapTest::SetUp()
+{
+}
+
+void HdfLiteRegmapTest::TearDown()
+{
+}
+
+/**
+  * @tc.name: RegmapCache001
+  * @tc.desc: repeated reads and writes through a register map are served by its cache.
+  * @tc.type: FUNC
+  * @tc.require: NA
+  */
+HWTEST_F(HdfLiteRegmapTest, RegmapCache001, TestSize.Level1)
+{
+    struct HdfTestMsg msg = {TEST_PAL_REGMAP_TYPE, REGMAP_TEST_CACHE, -1};
+    EXPECT_EQ(0, HdfTestSendMsgToService(&msg));
+}
+
+/**
+  * @tc.name: RegmapSync001
+  * @tc.desc: dirty registers written in cache only mode are synced in one burst per run.
+  * @tc.type: FUNC
+  * @tc.require: NA
+  */
+HWTEST_F(HdfLiteRegmapTest, RegmapSync001, TestSize.Level1)
+{
+    struct HdfTestMsg msg = {TEST_PAL_REGMAP_TYPE, REGMAP_TEST_SYNC, -1};
+    EXPECT_EQ(0, HdfTestSendMsgToService(&msg));
+}
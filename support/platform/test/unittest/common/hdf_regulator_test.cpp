@@ -29,6 +29,8 @@ enum RegulatorTestCmd {
     REGULATOR_GET_STATUS_TEST,
     REGULATOR_MULTI_THREAD_TEST,
     REGULATOR_RELIABILITY_TEST,
+    REGULATOR_PROFILE_TEST,
+    REGULATOR_TREE_BENCH_TEST,
 };
 
 class HdfLiteRegulatorTest : public testing::Test {
@@ -166,3 +168,25 @@ HWTEST_F(HdfLiteRegulatorTest, RegulatorTestReliability001, TestSize.Level1)
     struct HdfTestMsg msg = {TEST_PAL_REGULATOR_TYPE, REGULATOR_RELIABILITY_TEST, -1};
     EXPECT_EQ(0, HdfTestSendMsgToService(&msg));
 }
+/**
+  * @tc.name: RegulatorTestProfile001
+  * @tc.desc: regulator power profile applied in tree order
+  * @tc.type: FUNC
+  * @tc.require: NA
+  */
+HWTEST_F(HdfLiteRegulatorTest, RegulatorTestProfile001, TestSize.Level1)
+{
+    struct HdfTestMsg msg = {TEST_PAL_REGULATOR_TYPE, REGULATOR_PROFILE_TEST, -1};
+    EXPECT_EQ(0, HdfTestSendMsgToService(&msg));
+}
+/**
+  * @tc.name: RegulatorTestTreeBench001
+  * @tc.desc: regulator lookup and profile cost on a 500 rail tree
+  * @tc.type: PERF
+  * @tc.require: NA
+  */
+HWTEST_F(HdfLiteRegulatorTest, RegulatorTestTreeBench001, TestSize.Level1)
+{
+    struct HdfTestMsg msg = {TEST_PAL_REGULATOR_TYPE, REGULATOR_TREE_BENCH_TEST, -1};
+    EXPECT_EQ(0, HdfTestSendMsgToService(&msg));
+}
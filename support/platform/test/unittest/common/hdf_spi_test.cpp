@@ -25,6 +25,8 @@ enum HdfTestCaseCmd {
     SPI_INT_TRANSFER_TEST,
     SPI_RELIABILITY_TEST,
     SPI_PERFORMANCE_TEST,
+    SPI_TEST_ALL,
+    SPI_QUEUE_BENCH_TEST,
 };
 
 class HdfLiteSpiTest : public testing::Test {
@@ -139,3 +141,15 @@ HWTEST_F(HdfLiteSpiTest, SpiReliabilityTest001, TestSize.Level1)
     struct HdfTestMsg msg = {TEST_PAL_SPI_TYPE, SPI_RELIABILITY_TEST, -1};
     EXPECT_EQ(0, HdfTestSendMsgToService(&msg));
 }
+
+/**
+  * @tc.name: SpiQueueBenchTest001
+  * @tc.desc: spi queued transfers of several devices sharing a virtual bus, benchmark
+  * @tc.type: PERF
+  * @tc.require: SR000DQ0VO
+  */
+HWTEST_F(HdfLiteSpiTest, SpiQueueBenchTest001, TestSize.Level1)
+{
+    struct HdfTestMsg msg = {TEST_PAL_SPI_TYPE, SPI_QUEUE_BENCH_TEST, -1};
+    EXPECT_EQ(0, HdfTestSendMsgToService(&msg));
+}
@@ -31,6 +31,9 @@ enum HdfLiteUartTestCmd {
     UART_SET_TRANSMODE_TEST,
     UART_RELIABILITY_TEST,
     UART_PERFORMANCE_TEST,
+    UART_TEST_ALL,
+    UART_BUFFER_BENCH_TEST,
+    UART_RX_WATERMARK_TEST,
 };
 
 class HdfLiteUartTest : public testing::Test {
@@ -156,3 +159,27 @@ HWTEST_F(HdfLiteUartTest, UartReliabilityTest001, TestSize.Level1)
     struct HdfTestMsg msg = {TEST_PAL_UART_TYPE, UART_RELIABILITY_TEST, -1};
     EXPECT_EQ(0, HdfTestSendMsgToService(&msg));
 }
+
+/**
+  * @tc.name: UartBufferBenchTest001
+  * @tc.desc: uart receive ring and write queue benchmark on a loopback port
+  * @tc.type: PERF
+  * @tc.require: AR000F8689
+  */
+HWTEST_F(HdfLiteUartTest, UartBufferBenchTest001, TestSize.Level1)
+{
+    struct HdfTestMsg msg = {TEST_PAL_UART_TYPE, UART_BUFFER_BENCH_TEST, -1};
+    EXPECT_EQ(0, HdfTestSendMsgToService(&msg));
+}
+
+/**
+  * @tc.name: UartRxWatermarkTest001
+  * @tc.desc: uart receive ring raises the watermark event once per crossing
+  * @tc.type: FUNC
+  * @tc.require: AR000F8689
+  */
+HWTEST_F(HdfLiteUartTest, UartRxWatermarkTest001, TestSize.Level1)
+{
+    struct HdfTestMsg msg = {TEST_PAL_UART_TYPE, UART_RX_WATERMARK_TEST, -1};
+    EXPECT_EQ(0, HdfTestSendMsgToService(&msg));
+}
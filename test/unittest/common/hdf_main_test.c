@@ -22,6 +22,7 @@
 #endif
 #if defined(LOSCFG_DRIVERS_HDF_PLATFORM_I2C) || defined(CONFIG_DRIVERS_HDF_PLATFORM_I2C)
 #include "hdf_i2c_entry_test.h"
+#include "hdf_regmap_entry_test.h"
 #endif
 #if defined(LOSCFG_DRIVERS_HDF_PLATFORM_I2S) || defined(CONFIG_DRIVERS_HDF_PLATFORM_I2S)
 #include "hdf_i2s_entry_test.h"
@@ -60,9 +61,19 @@
      defined(CONFIG_DRIVERS_HDF_PLATFORM_EMMC)
 #include "hdf_emmc_entry_test.h"
 #endif
+#if defined(LOSCFG_DRIVERS_HDF_PLATFORM_MTD) || defined(CONFIG_DRIVERS_HDF_PLATFORM_MTD)
+#include "hdf_mtd_entry_test.h"
+#endif
 #if defined(LOSCFG_DRIVERS_HDF_PLATFORM_PWM) || defined(CONFIG_DRIVERS_HDF_PLATFORM_PWM)
 #include "hdf_pwm_entry_test.h"
 #endif
+#if defined(LOSCFG_DRIVERS_HDF_PLATFORM_DMAC)
+#include "hdf_dmac_entry_test.h"
+#endif
+#include "hdf_platform_queue_entry_test.h"
+#if defined(LOSCFG_DRIVERS_HDF_PLATFORM_STATS) || defined(CONFIG_DRIVERS_HDF_PLATFORM_STATS)
+#include "hdf_platform_stats_entry_test.h"
+#endif
 #endif
 #if defined(LOSCFG_DRIVERS_HDF_WIFI) || defined(CONFIG_DRIVERS_HDF_WIFI)
 #include "hdf_wifi_test.h"
@@ -91,6 +102,7 @@ HdfTestFuncList g_hdfTestFuncList[] = {
 #endif
 #if defined(LOSCFG_DRIVERS_HDF_PLATFORM_I2C) || defined(CONFIG_DRIVERS_HDF_PLATFORM_I2C)
     { TEST_PAL_I2C_TYPE, HdfI2cTestEntry },
+    { TEST_PAL_REGMAP_TYPE, HdfRegmapUnitTestEntry },
 #endif
 #if defined(LOSCFG_DRIVERS_HDF_PLATFORM_I2S) || defined(CONFIG_DRIVERS_HDF_PLATFORM_I2S)
     { TEST_PAL_I2S_TYPE, HdfI2sUnitTestEntry },
@@ -129,9 +141,19 @@ HdfTestFuncList g_hdfTestFuncList[] = {
      defined(CONFIG_DRIVERS_HDF_PLATFORM_EMMC)
     { TEST_PAL_EMMC_TYPE, HdfEmmcUnitTestEntry },
 #endif
+#if defined(LOSCFG_DRIVERS_HDF_PLATFORM_MTD) || defined(CONFIG_DRIVERS_HDF_PLATFORM_MTD)
+    { TEST_PAL_FLASH_TYPE, HdfMtdUnitTestEntry },
+#endif
 #if defined(LOSCFG_DRIVERS_HDF_PLATFORM_PWM) || defined(CONFIG_DRIVERS_HDF_PLATFORM_PWM)
     { TEST_PAL_PWM_TYPE, HdfPwmUnitTestEntry },
 #endif
+#if defined(LOSCFG_DRIVERS_HDF_PLATFORM_DMAC)
+    { TEST_PAL_DMAC_TYPE, HdfDmacUnitTestEntry },
+#endif
+    { TEST_PAL_QUEUE_TYPE, HdfPlatformQueueTestEntry },
+#if defined(LOSCFG_DRIVERS_HDF_PLATFORM_STATS) || defined(CONFIG_DRIVERS_HDF_PLATFORM_STATS)
+    { TEST_PAL_STATS_TYPE, HdfPlatformStatsTestEntry },
+#endif
 #endif
     { TEST_CONFIG_TYPE, HdfConfigEntry },
     { TEST_OSAL_ITEM, HdfOsalEntry },
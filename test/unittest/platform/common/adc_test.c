@@ -8,6 +8,7 @@
 
 #include "adc_test.h"
 #include "adc_if.h"
+#include "adc_core.h"
 #include "hdf_base.h"
 #include "hdf_io_service_if.h"
 #include "hdf_log.h"
@@ -23,6 +24,24 @@
 #define ADC_TEST_WAIT_TIMES      100
 #define ADC_TEST_STACK_SIZE        (1024 * 64)
 
+#define ADC_TEST_SIM_NUM           (ADC_DEVICES_MAX - 1)
+#define ADC_TEST_SIM_CHANNELS      8
+#define ADC_TEST_SIM_STEP          1000
+#define ADC_TEST_SCAN_MASK         0x0D    /* channels 0, 2 and 3 */
+#define ADC_TEST_SCAN_THREAD_MASK  0x05    /* channels 0 and 2 */
+#define ADC_TEST_SCAN_RATE         1000
+#define ADC_TEST_SCAN_OVERSAMPLE   4
+#define ADC_TEST_SCAN_DEPTH        8
+#define ADC_TEST_SCAN_WAIT_MS      20
+#define ADC_TEST_BENCH_MASK        0x0F
+#define ADC_TEST_BENCH_CHANNELS    4
+#define ADC_TEST_BENCH_DEPTH       4096
+#define ADC_TEST_BENCH_BLOCK       256
+#define ADC_TEST_BENCH_READS       100000
+#define ADC_TEST_BENCH_MS          200
+#define ADC_TEST_USEC_PER_SEC      1000000
+#define ADC_TEST_USEC_PER_MSEC     1000
+
 static int32_t AdcTestGetConfig(struct AdcTestConfig *config)
 {
     int32_t ret;
@@ -220,6 +239,380 @@ int32_t AdcTestReliability(void)
     return HDF_SUCCESS;
 }
 
+struct AdcTestSim {
+    struct AdcDevice device;
+    uint32_t reads[ADC_TEST_SIM_CHANNELS];
+    bool scanning;
+};
+
+/* channel n reads n * ADC_TEST_SIM_STEP plus the number of reads of it so far */
+static int32_t AdcTestSimRead(struct AdcDevice *device, uint32_t channel, uint32_t *val)
+{
+    struct AdcTestSim *sim = (struct AdcTestSim *)device->priv;
+
+    if (channel >= ADC_TEST_SIM_CHANNELS) {
+        return HDF_ERR_INVALID_PARAM;
+    }
+    *val = channel * ADC_TEST_SIM_STEP + sim->reads[channel]++ % ADC_TEST_SIM_STEP;
+    return HDF_SUCCESS;
+}
+
+static int32_t AdcTestSimStart(struct AdcDevice *device)
+{
+    (void)device;
+    return HDF_SUCCESS;
+}
+
+static int32_t AdcTestSimStartScan(struct AdcDevice *device, const struct AdcScanConfig *config)
+{
+    (void)config;
+    ((struct AdcTestSim *)device->priv)->scanning = true;
+    return HDF_SUCCESS;
+}
+
+static int32_t AdcTestSimStopScan(struct AdcDevice *device)
+{
+    ((struct AdcTestSim *)device->priv)->scanning = false;
+    return HDF_SUCCESS;
+}
+
+static const struct AdcMethod g_adcTestSimOps = {
+    .read = AdcTestSimRead,
+    .start = AdcTestSimStart,
+    .stop = AdcTestSimStart,
+};
+
+/* a device filling the ring itself, as a FIFO interrupt would */
+static const struct AdcMethod g_adcTestSimFifoOps = {
+    .read = AdcTestSimRead,
+    .start = AdcTestSimStart,
+    .stop = AdcTestSimStart,
+    .startScan = AdcTestSimStartScan,
+    .stopScan = AdcTestSimStopScan,
+};
+
+static struct AdcTestSim *AdcTestSimCreate(const struct AdcMethod *ops)
+{
+    struct AdcTestSim *sim = NULL;
+
+    sim = (struct AdcTestSim *)OsalMemCalloc(sizeof(*sim));
+    if (sim == NULL) {
+        return NULL;
+    }
+    sim->device.ops = ops;
+    sim->device.devNum = ADC_TEST_SIM_NUM;
+    sim->device.chanNum = ADC_TEST_SIM_CHANNELS;
+    sim->device.priv = sim;
+    if (AdcDeviceAdd(&sim->device) != HDF_SUCCESS) {
+        HDF_LOGE("%s: add adc device:%u failed", __func__, ADC_TEST_SIM_NUM);
+        OsalMemFree(sim);
+        return NULL;
+    }
+    return sim;
+}
+
+static void AdcTestSimDestroy(struct AdcTestSim *sim)
+{
+    AdcDeviceRemove(&sim->device);
+    OsalMemFree(sim);
+}
+
+/* pushes count raw scans, channel n of scan k reading n * ADC_TEST_SIM_STEP + first + k */
+static int32_t AdcTestScanPush(struct AdcTestSim *sim, uint32_t mask, uint32_t first, uint32_t count)
+{
+    uint32_t raw[ADC_TEST_SIM_CHANNELS];
+    uint32_t channel;
+    uint32_t i;
+    uint32_t k;
+
+    for (k = 0; k < count; k++) {
+        for (channel = 0, i = 0; channel < ADC_TEST_SIM_CHANNELS; channel++) {
+            if ((mask & (1U << channel)) != 0) {
+                raw[i++] = channel * ADC_TEST_SIM_STEP + first + k;
+            }
+        }
+        if (AdcDeviceScanPush(&sim->device, raw, 1) != HDF_SUCCESS) {
+            return HDF_FAILURE;
+        }
+    }
+    return HDF_SUCCESS;
+}
+
+/* checks scans read back, lowest channel first, against first + k * step */
+static int32_t AdcTestScanCheck(const uint32_t *buf, uint32_t mask, uint32_t count, uint32_t first, uint32_t step)
+{
+    uint32_t channel;
+    uint32_t expect;
+    uint32_t k;
+
+    for (k = 0; k < count; k++) {
+        for (channel = 0; channel < ADC_TEST_SIM_CHANNELS; channel++) {
+            if ((mask & (1U << channel)) == 0) {
+                continue;
+            }
+            expect = channel * ADC_TEST_SIM_STEP + first + k * step;
+            if (*buf != expect) {
+                HDF_LOGE("%s: scan %u channel %u read %u, expect %u", __func__, k, channel, *buf, expect);
+                return HDF_FAILURE;
+            }
+            buf++;
+        }
+    }
+    return HDF_SUCCESS;
+}
+
+static int32_t AdcTestScanFifo(void)
+{
+    int32_t ret = HDF_FAILURE;
+    uint32_t buf[ADC_TEST_SCAN_DEPTH * ADC_TEST_SIM_CHANNELS];
+    struct AdcScanConfig config = {ADC_TEST_SCAN_MASK, ADC_TEST_SCAN_RATE, ADC_TEST_SCAN_OVERSAMPLE,
+        ADC_SCAN_REDUCE_AVERAGE, ADC_TEST_SCAN_DEPTH};
+    struct AdcTestSim *sim = AdcTestSimCreate(&g_adcTestSimFifoOps);
+    DevHandle handle = NULL;
+    DevHandle other = NULL;
+
+    if (sim == NULL) {
+        return HDF_ERR_MALLOC_FAIL;
+    }
+    handle = AdcOpen(ADC_TEST_SIM_NUM);
+    if (handle == NULL) {
+        AdcTestSimDestroy(sim);
+        return HDF_ERR_NOT_SUPPORT;
+    }
+
+    // two raw scans short of the third stored one: the mean of raw scans 0..3 and of 4..7, rounded down
+    if (AdcStartScan(handle, &config) != HDF_SUCCESS || !sim->scanning ||
+        AdcTestScanPush(sim, config.channelMask, 0, ADC_TEST_SCAN_OVERSAMPLE * 3 - 2) != HDF_SUCCESS ||
+        AdcReadScan(handle, buf, ADC_TEST_SCAN_DEPTH) != 2 ||
+        AdcTestScanCheck(buf, config.channelMask, 2, 1, ADC_TEST_SCAN_OVERSAMPLE) != HDF_SUCCESS ||
+        AdcStopScan(handle) != HDF_SUCCESS || sim->scanning) {
+        HDF_LOGE("%s: average scan failed", __func__);
+        goto __OUT;
+    }
+
+    config.reduce = ADC_SCAN_REDUCE_DECIMATE;
+    if (AdcStartScan(handle, &config) != HDF_SUCCESS ||
+        AdcTestScanPush(sim, config.channelMask, 0, ADC_TEST_SCAN_OVERSAMPLE * 2) != HDF_SUCCESS ||
+        AdcReadScan(handle, buf, ADC_TEST_SCAN_DEPTH) != 2 ||
+        AdcTestScanCheck(buf, config.channelMask, 2, 0, ADC_TEST_SCAN_OVERSAMPLE) != HDF_SUCCESS ||
+        AdcStopScan(handle) != HDF_SUCCESS) {
+        HDF_LOGE("%s: decimate scan failed", __func__);
+        goto __OUT;
+    }
+
+    // the oldest two scans are overwritten, then the ring wraps around under the reader
+    config.oversample = 1;
+    if (AdcStartScan(handle, &config) != HDF_SUCCESS ||
+        AdcTestScanPush(sim, config.channelMask, 0, ADC_TEST_SCAN_DEPTH + 2) != HDF_SUCCESS ||
+        AdcReadScan(handle, buf, ADC_TEST_SCAN_DEPTH + 1) != ADC_TEST_SCAN_DEPTH ||
+        AdcTestScanCheck(buf, config.channelMask, ADC_TEST_SCAN_DEPTH, 2, 1) != HDF_SUCCESS ||
+        AdcReadScan(handle, buf, ADC_TEST_SCAN_DEPTH) != 0 ||
+        AdcTestScanPush(sim, config.channelMask, ADC_TEST_SCAN_DEPTH + 2, 3) != HDF_SUCCESS ||
+        AdcReadScan(handle, buf, ADC_TEST_SCAN_DEPTH) != 3 ||
+        AdcTestScanCheck(buf, config.channelMask, 3, ADC_TEST_SCAN_DEPTH + 2, 1) != HDF_SUCCESS) {
+        HDF_LOGE("%s: overrun scan failed", __func__);
+        goto __OUT;
+    }
+
+    // another handle of the device can neither stop the scan nor end it by closing
+    other = AdcOpen(ADC_TEST_SIM_NUM);
+    if (other == NULL || AdcStopScan(other) != HDF_ERR_DEVICE_BUSY) {
+        HDF_LOGE("%s: scan stopped by another handle", __func__);
+        goto __OUT;
+    }
+    AdcClose(other);
+    other = NULL;
+    if (!sim->scanning || sim->device.scan == NULL) {
+        HDF_LOGE("%s: scan stopped by closing another handle", __func__);
+        goto __OUT;
+    }
+
+    // closing the handle stops the scan
+    AdcClose(handle);
+    handle = NULL;
+    if (sim->scanning || sim->device.scan != NULL) {
+        HDF_LOGE("%s: scan still running after close", __func__);
+        goto __OUT;
+    }
+    ret = HDF_SUCCESS;
+__OUT:
+    if (other != NULL) {
+        AdcClose(other);
+    }
+    if (handle != NULL) {
+        AdcClose(handle);
+    }
+    AdcTestSimDestroy(sim);
+    return ret;
+}
+
+static int32_t AdcTestScanThread(void)
+{
+    int32_t ret = HDF_FAILURE;
+    int32_t count;
+    int32_t k;
+    uint32_t buf[ADC_TEST_SCAN_DEPTH * 2];
+    struct AdcScanConfig config = {ADC_TEST_SCAN_THREAD_MASK, ADC_TEST_SCAN_RATE, 1,
+        ADC_SCAN_REDUCE_AVERAGE, ADC_TEST_SCAN_DEPTH};
+    struct AdcTestSim *sim = AdcTestSimCreate(&g_adcTestSimOps);
+    DevHandle handle = NULL;
+
+    if (sim == NULL) {
+        return HDF_ERR_MALLOC_FAIL;
+    }
+    handle = AdcOpen(ADC_TEST_SIM_NUM);
+    if (handle == NULL) {
+        AdcTestSimDestroy(sim);
+        return HDF_ERR_NOT_SUPPORT;
+    }
+
+    if (AdcReadScan(handle, buf, 1) != HDF_ERR_NOT_SUPPORT) {
+        HDF_LOGE("%s: read scan before start should fail", __func__);
+        goto __OUT;
+    }
+    config.channelMask |= 1U << ADC_TEST_SIM_CHANNELS;
+    if (AdcStartScan(handle, &config) != HDF_ERR_INVALID_PARAM) {
+        HDF_LOGE("%s: mask beyond the channels of the device should fail", __func__);
+        goto __OUT;
+    }
+    config.channelMask = ADC_TEST_SCAN_THREAD_MASK;
+    if (AdcStartScan(handle, &config) != HDF_SUCCESS) {
+        HDF_LOGE("%s: start scan failed", __func__);
+        goto __OUT;
+    }
+    if (AdcStartScan(handle, &config) != HDF_ERR_DEVICE_BUSY) {
+        HDF_LOGE("%s: second start should be busy", __func__);
+        goto __OUT;
+    }
+
+    OsalMSleep(ADC_TEST_SCAN_WAIT_MS);
+    count = AdcReadScan(handle, buf, ADC_TEST_SCAN_DEPTH);
+    if (count <= 0) {
+        HDF_LOGE("%s: no scans after %ums", __func__, ADC_TEST_SCAN_WAIT_MS);
+        goto __OUT;
+    }
+    // both channels are read in the same pass, so they have been read as often
+    for (k = 0; k < count; k++) {
+        if (buf[k * 2] / ADC_TEST_SIM_STEP != 0 || buf[k * 2 + 1] / ADC_TEST_SIM_STEP != 2 ||
+            buf[k * 2] % ADC_TEST_SIM_STEP != buf[k * 2 + 1] % ADC_TEST_SIM_STEP) {
+            HDF_LOGE("%s: scan %d read %u, %u", __func__, k, buf[k * 2], buf[k * 2 + 1]);
+            goto __OUT;
+        }
+    }
+    if (AdcStopScan(handle) != HDF_SUCCESS) {
+        goto __OUT;
+    }
+    HDF_LOGI("%s: %d scans in %ums", __func__, count, ADC_TEST_SCAN_WAIT_MS);
+    ret = HDF_SUCCESS;
+__OUT:
+    AdcClose(handle);
+    AdcTestSimDestroy(sim);
+    return ret;
+}
+
+int32_t AdcTestScan(void)
+{
+    int32_t ret;
+
+    HDF_LOGI("%s: enter", __func__);
+    ret = AdcTestScanFifo();
+    if (ret != HDF_SUCCESS) {
+        return ret;
+    }
+    ret = AdcTestScanThread();
+    if (ret != HDF_SUCCESS) {
+        return ret;
+    }
+    HDF_LOGI("%s: done", __func__);
+    return HDF_SUCCESS;
+}
+
+static uint64_t AdcTestElapsedUs(const OsalTimespec *start)
+{
+    OsalTimespec end = {0, 0};
+    OsalTimespec diff = {0, 0};
+
+    (void)OsalGetTime(&end);
+    (void)OsalDiffTime(start, &end, &diff);
+    return (uint64_t)diff.sec * ADC_TEST_USEC_PER_SEC + diff.usec;
+}
+
+/* samples per second through AdcRead, then through a software scan at the highest rate */
+int32_t AdcTestScanBench(void)
+{
+    int32_t ret = HDF_FAILURE;
+    int32_t count;
+    uint32_t i;
+    uint32_t val;
+    uint32_t *buf = NULL;
+    uint64_t readUs;
+    uint64_t scanUs;
+    uint64_t copyUs = 0;
+    uint64_t samples = 0;
+    OsalTimespec start = {0, 0};
+    OsalTimespec copyStart = {0, 0};
+    struct AdcScanConfig config = {ADC_TEST_BENCH_MASK, ADC_SCAN_RATE_MAX, 1,
+        ADC_SCAN_REDUCE_AVERAGE, ADC_TEST_BENCH_DEPTH};
+    struct AdcTestSim *sim = NULL;
+    DevHandle handle = NULL;
+
+    HDF_LOGI("%s: enter", __func__);
+    sim = AdcTestSimCreate(&g_adcTestSimOps);
+    if (sim == NULL) {
+        return HDF_ERR_MALLOC_FAIL;
+    }
+    buf = (uint32_t *)OsalMemCalloc(sizeof(*buf) * ADC_TEST_BENCH_BLOCK * ADC_TEST_BENCH_CHANNELS);
+    handle = AdcOpen(ADC_TEST_SIM_NUM);
+    if (buf == NULL || handle == NULL) {
+        goto __OUT;
+    }
+
+    (void)OsalGetTime(&start);
+    for (i = 0; i < ADC_TEST_BENCH_READS; i++) {
+        if (AdcRead(handle, i % ADC_TEST_BENCH_CHANNELS, &val) != HDF_SUCCESS) {
+            goto __OUT;
+        }
+    }
+    readUs = AdcTestElapsedUs(&start);
+
+    if (AdcStartScan(handle, &config) != HDF_SUCCESS) {
+        goto __OUT;
+    }
+    (void)OsalGetTime(&start);
+    while ((scanUs = AdcTestElapsedUs(&start)) < ADC_TEST_BENCH_MS * ADC_TEST_USEC_PER_MSEC) {
+        (void)OsalGetTime(&copyStart);
+        count = AdcReadScan(handle, buf, ADC_TEST_BENCH_BLOCK);
+        copyUs += AdcTestElapsedUs(&copyStart);
+        if (count < 0) {
+            (void)AdcStopScan(handle);
+            goto __OUT;
+        }
+        samples += (uint64_t)count * ADC_TEST_BENCH_CHANNELS;
+        if (count < ADC_TEST_BENCH_BLOCK) {
+            OsalMSleep(1);
+        }
+    }
+    (void)AdcStopScan(handle);
+    if (samples == 0) {
+        HDF_LOGE("%s: no samples scanned", __func__);
+        goto __OUT;
+    }
+
+    HDF_LOGI("%s: AdcRead %llu samples/s, scan %llu samples/s with %llu us of %llu in AdcReadScan",
+        __func__, (unsigned long long)((uint64_t)ADC_TEST_BENCH_READS * ADC_TEST_USEC_PER_SEC / (readUs + 1)),
+        (unsigned long long)(samples * ADC_TEST_USEC_PER_SEC / (scanUs + 1)),
+        (unsigned long long)copyUs, (unsigned long long)scanUs);
+    ret = HDF_SUCCESS;
+__OUT:
+    if (handle != NULL) {
+        AdcClose(handle);
+    }
+    OsalMemFree(buf);
+    AdcTestSimDestroy(sim);
+    HDF_LOGI("%s: done", __func__);
+    return ret;
+}
+
 struct AdcTestEntry {
     int cmd;
     int32_t (*func)(void);
@@ -230,6 +623,8 @@ static struct AdcTestEntry g_entry[] = {
     { ADC_TEST_CMD_READ, AdcTestRead, "AdcTestRead" },
     { ADC_TEST_CMD_MULTI_THREAD, AdcTestMultiThread, "AdcTestMultiThread" },
     { ADC_TEST_CMD_RELIABILITY, AdcTestReliability, "AdcTestReliability" },
+    { ADC_TEST_CMD_SCAN, AdcTestScan, "AdcTestScan" },
+    { ADC_TEST_CMD_SCAN_BENCH, AdcTestScanBench, "AdcTestScanBench" },
 };
 
 int32_t AdcTestExecute(int cmd)
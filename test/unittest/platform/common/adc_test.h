@@ -34,6 +34,8 @@ enum AdcTestCmd {
     ADC_TEST_CMD_READ = 0,
     ADC_TEST_CMD_MULTI_THREAD,
     ADC_TEST_CMD_RELIABILITY,
+    ADC_TEST_CMD_SCAN,
+    ADC_TEST_CMD_SCAN_BENCH,
     ADC_TEST_CMD_MAX,
 };
 
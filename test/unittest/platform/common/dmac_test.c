@@ -0,0 +1,325 @@
+/*
+ * Copyright (c) 2021 Huawei Device Co., Ltd.
+ *
+ * HDF is dual licensed: you can use it either under the terms of
+ * the GPL, or the BSD license, at your option.
+ * See the LICENSE file in the root of this repository for complete details.
+ */
+
+#include "dmac_test.h"
+#include "device_resource_if.h"
+#include "dmac_core.h"
+#include "hdf_base.h"
+#include "hdf_log.h"
+#include "osal_mem.h"
+#include "osal_time.h"
+#include "securec.h"
+
+#define HDF_LOG_TAG dmac_test_c
+
+#define DMAC_TEST_SG_NUM         3
+#define DMAC_TEST_BENCH_SIZE     (64 * 1024)
+#define DMAC_TEST_BENCH_ROUNDS   32
+#define DMAC_TEST_DEPTH          4  /* async transfers in flight */
+#define DMAC_TEST_SMALL_SIZE     64
+#define DMAC_TEST_SMALL_ROUNDS   256
+#define DMAC_TEST_USEC_PER_SEC   1000000
+#define DMAC_TEST_PERCENT        100
+
+static const size_t g_dmacTestSgLens[DMAC_TEST_SG_NUM] = { 100, 5000, 8192 };
+
+struct DmacTestFunc {
+    enum DmacTestCmd type;
+    int32_t (*Func)(struct DmaCntlr *cntlr);
+};
+
+static uint64_t DmacTestElapsedUs(const OsalTimespec *start)
+{
+    OsalTimespec now;
+    OsalTimespec diff;
+
+    (void)OsalGetTime(&now);
+    (void)OsalDiffTime(start, &now, &diff);
+    return (uint64_t)diff.sec * DMAC_TEST_USEC_PER_SEC + diff.usec;
+}
+
+static void DmacTestFill(uint8_t *buf, size_t len, uint8_t seed)
+{
+    size_t i;
+
+    for (i = 0; i < len; i++) {
+        buf[i] = (uint8_t)(seed + i * 3 + (i >> 8));
+    }
+}
+
+static void DmacTestCountCallback(void *callbackData, int status)
+{
+    uint32_t *count = (uint32_t *)callbackData;
+
+    if (status == DMAC_CHN_SUCCESS) {
+        (*count)++;
+    }
+}
+
+/* a list of blocks of unaligned sizes is copied by one chain, and ends once */
+static int32_t DmacTestAsyncSg(struct DmaCntlr *cntlr)
+{
+    int32_t ret;
+    uint16_t i;
+    uint32_t count = 0;
+    size_t total = 0;
+    uint8_t *src = NULL;
+    uint8_t *dst = NULL;
+    struct DmacFence fence;
+    struct DmacSgEntry sg[DMAC_TEST_SG_NUM];
+    struct DmacAsyncMsg msg = {
+        .sg = sg, .sgNum = DMAC_TEST_SG_NUM, .srcWidth = 1, .destWidth = 1, .transType = TRASFER_TYPE_M2M,
+        .cb = DmacTestCountCallback, .para = &count, .fence = &fence,
+    };
+
+    for (i = 0; i < DMAC_TEST_SG_NUM; i++) {
+        total += g_dmacTestSgLens[i];
+    }
+    src = (uint8_t *)OsalMemCalloc(total);
+    dst = (uint8_t *)OsalMemCalloc(total);
+    if (src == NULL || dst == NULL) {
+        OsalMemFree(src);
+        OsalMemFree(dst);
+        return HDF_ERR_MALLOC_FAIL;
+    }
+    DmacTestFill(src, total, 1);
+    /* the blocks land in the reverse order, so each entry is really used by itself */
+    for (i = 0, total = 0; i < DMAC_TEST_SG_NUM; total += g_dmacTestSgLens[i], i++) {
+        sg[i].srcAddr = (uintptr_t)(src + total);
+        sg[i].len = g_dmacTestSgLens[i];
+    }
+    for (i = DMAC_TEST_SG_NUM, total = 0; i > 0; total += g_dmacTestSgLens[i - 1], i--) {
+        sg[i - 1].destAddr = (uintptr_t)(dst + total);
+    }
+
+    DmacFenceInit(&fence);
+    ret = DmaCntlrTransferAsync(cntlr, &msg);
+    if (ret == HDF_SUCCESS) {
+        ret = DmacFenceWait(&fence, DMA_EVENT_WAIT_DEF_TIME);
+    }
+    for (i = 0; ret == HDF_SUCCESS && i < DMAC_TEST_SG_NUM; i++) {
+        if (memcmp((void *)sg[i].destAddr, (void *)sg[i].srcAddr, sg[i].len) != 0) {
+            HDF_LOGE("%s: entry %u mismatch", __func__, i);
+            ret = HDF_FAILURE;
+        }
+    }
+    if (ret == HDF_SUCCESS && (count != 1 || fence.status != DMAC_CHN_SUCCESS)) {
+        HDF_LOGE("%s: callback count %u, fence status %d", __func__, count, fence.status);
+        ret = HDF_FAILURE;
+    }
+    OsalMemFree(src);
+    OsalMemFree(dst);
+    HDF_LOGI("%s: ret %d", __func__, ret);
+    return ret;
+}
+
+static void DmacTestLogRate(const char *name, size_t bytes, uint64_t us)
+{
+    /* bytes per us are MB/s */
+    uint64_t rate = (uint64_t)bytes * DMAC_TEST_PERCENT / (us + 1);
+
+    HDF_LOGI("%s: %zu bytes in %llu us, %llu.%02llu MB/s", name, bytes, (unsigned long long)us,
+        (unsigned long long)(rate / DMAC_TEST_PERCENT), (unsigned long long)(rate % DMAC_TEST_PERCENT));
+}
+
+static int32_t DmacTestSyncRounds(struct DmaCntlr *cntlr, uint8_t *src, uint8_t *dst, size_t len,
+    uint32_t rounds, uint64_t *us)
+{
+    uint32_t i;
+    OsalTimespec start;
+    struct DmacMsg msg = {
+        .srcAddr = (uintptr_t)src, .destAddr = (uintptr_t)dst, .srcWidth = 1, .destWidth = 1,
+        .transType = TRASFER_TYPE_M2M, .transLen = len,
+    };
+
+    (void)OsalGetTime(&start);
+    for (i = 0; i < rounds; i++) {
+        if (DmaCntlrTransfer(cntlr, &msg) != HDF_SUCCESS) {
+            HDF_LOGE("%s: transfer %u failed", __func__, i);
+            return HDF_FAILURE;
+        }
+    }
+    *us = DmacTestElapsedUs(&start);
+    return HDF_SUCCESS;
+}
+
+/* keeps up to depth transfers in flight, each slot copying into its own part of dst */
+static int32_t DmacTestAsyncRounds(struct DmaCntlr *cntlr, uint8_t *src, uint8_t *dst, size_t len,
+    uint32_t rounds, uint32_t depth, uint64_t *us)
+{
+    uint32_t i;
+    uint32_t failed = 0;
+    int32_t ret = HDF_SUCCESS;
+    OsalTimespec start;
+    struct DmacFence fences[DMAC_TEST_DEPTH];
+    struct DmacSgEntry sg = { .srcAddr = (uintptr_t)src, .len = len };
+    struct DmacAsyncMsg msg = {
+        .sg = &sg, .sgNum = 1, .srcWidth = 1, .destWidth = 1, .transType = TRASFER_TYPE_M2M,
+    };
+
+    (void)OsalGetTime(&start);
+    for (i = 0; i < rounds && ret == HDF_SUCCESS; i++) {
+        failed = i;
+        if (i >= depth) {
+            failed = i - depth;
+            ret = DmacFenceWait(&fences[i % depth], DMA_EVENT_WAIT_DEF_TIME);
+            if (ret != HDF_SUCCESS) {
+                break;
+            }
+            failed = i;
+        }
+        DmacFenceInit(&fences[i % depth]);
+        sg.destAddr = (uintptr_t)(dst + (i % depth) * len);
+        msg.fence = &fences[i % depth];
+        ret = DmaCntlrTransferAsync(cntlr, &msg);
+    }
+    /* drain the transfers still in flight */
+    for (i = (rounds > depth) ? (rounds - depth) : 0; i < rounds && ret == HDF_SUCCESS; i++) {
+        failed = i;
+        ret = DmacFenceWait(&fences[i % depth], DMA_EVENT_WAIT_DEF_TIME);
+    }
+    *us = DmacTestElapsedUs(&start);
+    if (ret != HDF_SUCCESS) {
+        HDF_LOGE("%s: round %u failed, ret %d", __func__, failed, ret);
+    }
+    return ret;
+}
+
+/* throughput of large copies, and the cost of a small one, blocking against async */
+static int32_t DmacTestBench(struct DmaCntlr *cntlr)
+{
+    int32_t ret;
+    uint32_t i;
+    uint64_t syncUs = 0;
+    uint64_t asyncUs = 0;
+    uint8_t *src = NULL;
+    uint8_t *dst = NULL;
+
+    src = (uint8_t *)OsalMemCalloc(DMAC_TEST_BENCH_SIZE);
+    dst = (uint8_t *)OsalMemCalloc(DMAC_TEST_BENCH_SIZE * DMAC_TEST_DEPTH);
+    if (src == NULL || dst == NULL) {
+        OsalMemFree(src);
+        OsalMemFree(dst);
+        return HDF_ERR_MALLOC_FAIL;
+    }
+    DmacTestFill(src, DMAC_TEST_BENCH_SIZE, 0);
+
+    ret = DmacTestSyncRounds(cntlr, src, dst, DMAC_TEST_BENCH_SIZE, DMAC_TEST_BENCH_ROUNDS, &syncUs);
+    if (ret == HDF_SUCCESS) {
+        ret = DmacTestAsyncRounds(cntlr, src, dst, DMAC_TEST_BENCH_SIZE, DMAC_TEST_BENCH_ROUNDS,
+            DMAC_TEST_DEPTH, &asyncUs);
+    }
+    for (i = 0; ret == HDF_SUCCESS && i < DMAC_TEST_DEPTH; i++) {
+        if (memcmp(dst + i * DMAC_TEST_BENCH_SIZE, src, DMAC_TEST_BENCH_SIZE) != 0) {
+            HDF_LOGE("%s: slot %u mismatch", __func__, i);
+            ret = HDF_FAILURE;
+        }
+    }
+    if (ret == HDF_SUCCESS) {
+        DmacTestLogRate("blocking", DMAC_TEST_BENCH_SIZE * DMAC_TEST_BENCH_ROUNDS, syncUs);
+        DmacTestLogRate("async chain", DMAC_TEST_BENCH_SIZE * DMAC_TEST_BENCH_ROUNDS, asyncUs);
+        ret = DmacTestSyncRounds(cntlr, src, dst, DMAC_TEST_SMALL_SIZE, DMAC_TEST_SMALL_ROUNDS, &syncUs);
+    }
+    if (ret == HDF_SUCCESS) {
+        ret = DmacTestAsyncRounds(cntlr, src, dst, DMAC_TEST_SMALL_SIZE, DMAC_TEST_SMALL_ROUNDS, 1, &asyncUs);
+    }
+    if (ret == HDF_SUCCESS) {
+        HDF_LOGI("%s: %d bytes per request, blocking %llu us, async %llu us", __func__, DMAC_TEST_SMALL_SIZE,
+            (unsigned long long)(syncUs / DMAC_TEST_SMALL_ROUNDS),
+            (unsigned long long)(asyncUs / DMAC_TEST_SMALL_ROUNDS));
+    }
+    OsalMemFree(src);
+    OsalMemFree(dst);
+    return ret;
+}
+
+static struct DmacTestFunc g_dmacTestFunc[] = {
+    { DMAC_TEST_ASYNC_SG, DmacTestAsyncSg },
+    { DMAC_TEST_BENCH, DmacTestBench },
+};
+
+static int32_t DmacTestEntry(struct DmacTester *tester, int32_t cmd)
+{
+    uint32_t i;
+    int32_t ret = HDF_ERR_NOT_SUPPORT;
+    struct DmaCntlr *cntlr = NULL;
+
+    if (tester == NULL || tester->cntlrService == NULL) {
+        return HDF_ERR_INVALID_OBJECT;
+    }
+    cntlr = (struct DmaCntlr *)DevSvcManagerClntGetService(tester->cntlrService);
+    if (cntlr == NULL) {
+        HDF_LOGE("%s: get dma controller %s failed", __func__, tester->cntlrService);
+        return HDF_FAILURE;
+    }
+    for (i = 0; i < sizeof(g_dmacTestFunc) / sizeof(g_dmacTestFunc[0]); i++) {
+        if (cmd == g_dmacTestFunc[i].type && g_dmacTestFunc[i].Func != NULL) {
+            ret = g_dmacTestFunc[i].Func(cntlr);
+            break;
+        }
+    }
+    if (ret == HDF_ERR_NOT_SUPPORT) {
+        HDF_LOGE("%s: cmd %d not supported", __func__, cmd);
+    }
+    return ret;
+}
+
+static int32_t DmacTestBind(struct HdfDeviceObject *device)
+{
+    static struct DmacTester tester;
+
+    if (device == NULL) {
+        HDF_LOGE("%s: device is null!", __func__);
+        return HDF_ERR_IO;
+    }
+
+    device->service = &tester.service;
+    HDF_LOGI("%s: DMAC_TEST service init success!", __func__);
+    return HDF_SUCCESS;
+}
+
+static int32_t DmacTestInit(struct HdfDeviceObject *device)
+{
+    struct DmacTester *tester = NULL;
+    struct DeviceResourceIface *drsOps = NULL;
+
+    if (device == NULL || device->service == NULL || device->property == NULL) {
+        HDF_LOGE("%s: invalid parameter", __func__);
+        return HDF_ERR_INVALID_PARAM;
+    }
+
+    drsOps = DeviceResourceGetIfaceInstance(HDF_CONFIG_SOURCE);
+    if (drsOps == NULL || drsOps->GetString == NULL) {
+        HDF_LOGE("%s: invalid drs ops", __func__);
+        return HDF_FAILURE;
+    }
+    tester = (struct DmacTester *)device->service;
+    if (drsOps->GetString(device->property, "cntlr_service", &tester->cntlrService, NULL) != HDF_SUCCESS) {
+        HDF_LOGE("%s: read cntlr_service failed", __func__);
+        return HDF_FAILURE;
+    }
+    tester->TestEntry = DmacTestEntry;
+    HDF_LOGI("%s: success", __func__);
+    return HDF_SUCCESS;
+}
+
+static void DmacTestRelease(struct HdfDeviceObject *device)
+{
+    if (device != NULL) {
+        device->service = NULL;
+    }
+}
+
+struct HdfDriverEntry g_dmacTestEntry = {
+    .moduleVersion = 1,
+    .Bind = DmacTestBind,
+    .Init = DmacTestInit,
+    .Release = DmacTestRelease,
+    .moduleName = "PLATFORM_DMAC_TEST",
+};
+HDF_INIT(g_dmacTestEntry);
@@ -0,0 +1,32 @@
+/*
+ * Copyright (c) 2021 Huawei Device Co., Ltd.
+ *
+ * HDF is dual licensed: you can use it either under the terms of
+ * the GPL, or the BSD license, at your option.
+ * See the LICENSE file in the root of this repository for complete details.
+ */
+
+#ifndef DMAC_TEST_H
+#define DMAC_TEST_H
+
+#include "hdf_device_desc.h"
+#include "hdf_platform.h"
+
+enum DmacTestCmd {
+    DMAC_TEST_ASYNC_SG = 0,
+    DMAC_TEST_BENCH,
+};
+
+struct DmacTester {
+    struct IDeviceIoService service;
+    struct HdfDeviceObject *device;
+    int32_t (*TestEntry)(struct DmacTester *tester, int32_t cmd);
+    const char *cntlrService;  /* the service of a virtual dma controller */
+};
+
+static inline struct DmacTester *GetDmacTester(void)
+{
+    return (struct DmacTester *)DevSvcManagerClntGetService("DMAC_TEST");
+}
+
+#endif /* DMAC_TEST_H */
@@ -13,9 +13,18 @@
 #include "osal_time.h"
 #include "emmc_if.h"
 #include "emmc_test.h"
+#include "mmc_corex.h"
+#include "mmc_emmc.h"
+#include "securec.h"
 
 #define HDF_LOG_TAG emmc_test_c
 
+#define EMMC_BENCH_REQ_SEC      8    /* 4KB per request, a typical page cache writeback unit */
+#define EMMC_BENCH_REQ_NUM      128
+#define EMMC_BENCH_CMD_COST_US  50   /* command setup and completion cost of the fake bus */
+#define EMMC_BENCH_TIME_MS      1000
+#define EMMC_BENCH_TIME_US      1000000
+
 struct EmmcTestFunc {
     enum EmmcTestCmd type;
     int32_t (*Func)(struct EmmcTester *tester);
@@ -55,8 +64,174 @@ static int32_t TestEmmcGetCid(struct EmmcTester *tester)
     return HDF_SUCCESS;
 }
 
+struct EmmcBenchCntlr {
+    struct MmcCntlr cntlr;
+    struct EmmcDevice dev;
+    uint8_t *disk;
+    struct OsalSem done;
+    uint32_t doneNum;
+    uint32_t errNum;
+};
+
+static int32_t EmmcBenchRequest(struct MmcCntlr *cntlr, struct MmcCmd *cmd)
+{
+    struct EmmcBenchCntlr *bench = (struct EmmcBenchCntlr *)cntlr;
+    struct MmcData *data = cmd->data;
+    uint8_t *sector = NULL;
+    uint32_t len;
+
+    OsalUSleep(EMMC_BENCH_CMD_COST_US);
+    cmd->returnError = HDF_SUCCESS;
+    if (data == NULL) {
+        return HDF_SUCCESS;
+    }
+    sector = bench->disk + (size_t)cmd->argument * BYTES_PER_BLOCK;
+    len = data->blockNum * data->blockSize;
+    if ((data->dataFlags & DATA_WRITE) != 0) {
+        data->returnError = memcpy_s(sector, len, data->dataBuffer, len);
+    } else {
+        data->returnError = memcpy_s(data->dataBuffer, len, sector, len);
+    }
+    return HDF_SUCCESS;
+}
+
+static bool EmmcBenchDevPluged(struct MmcCntlr *cntlr)
+{
+    (void)cntlr;
+    return true;
+}
+
+static struct MmcCntlrOps g_emmcBenchOps = {
+    .request = EmmcBenchRequest,
+    .devPluged = EmmcBenchDevPluged,
+};
+
+static void EmmcBenchReqDone(struct MmcReq *req)
+{
+    struct EmmcBenchCntlr *bench = (struct EmmcBenchCntlr *)req->priv;
+
+    if (req->error != HDF_SUCCESS) {
+        bench->errNum++;
+    }
+    if (++bench->doneNum == EMMC_BENCH_REQ_NUM) {
+        (void)OsalSemPost(&bench->done);
+    }
+}
+
+static uint32_t EmmcBenchRate(const OsalTimespec *start, const OsalTimespec *end)
+{
+    OsalTimespec diff = {0};
+    uint64_t us;
+
+    (void)OsalDiffTime(start, end, &diff);
+    us = diff.sec * EMMC_BENCH_TIME_US + diff.usec;
+    if (us == 0) {
+        return 0;
+    }
+    /* KB/s */
+    return (uint32_t)((uint64_t)EMMC_BENCH_REQ_NUM * EMMC_BENCH_REQ_SEC * BYTES_PER_BLOCK * EMMC_BENCH_TIME_MS / us);
+}
+
+static int32_t EmmcBenchRun(struct EmmcBenchCntlr *bench, uint8_t *buf, struct MmcReq *reqs)
+{
+    struct MmcDevice *mmc = &bench->dev.mmc;
+    OsalTimespec start = {0};
+    OsalTimespec mid = {0};
+    OsalTimespec end = {0};
+    struct MmcReqStats stats = {0};
+    uint32_t i;
+    uint32_t len = EMMC_BENCH_REQ_SEC * BYTES_PER_BLOCK;
+
+    (void)OsalGetTime(&start);
+    for (i = 0; i < EMMC_BENCH_REQ_NUM; i++) {
+        if (MmcDeviceWrite(mmc, buf + i * len, i * EMMC_BENCH_REQ_SEC, EMMC_BENCH_REQ_SEC) != EMMC_BENCH_REQ_SEC) {
+            HDF_LOGE("%s: blocking write %u failed", __func__, i);
+            return HDF_FAILURE;
+        }
+    }
+    (void)memset_s(bench->disk, EMMC_BENCH_REQ_NUM * len, 0, EMMC_BENCH_REQ_NUM * len);
+    (void)OsalGetTime(&mid);
+    for (i = 0; i < EMMC_BENCH_REQ_NUM; i++) {
+        reqs[i].buf = buf + i * len;
+        reqs[i].startSec = i * EMMC_BENCH_REQ_SEC;
+        reqs[i].nSec = EMMC_BENCH_REQ_SEC;
+        reqs[i].writeFlag = true;
+        reqs[i].done = EmmcBenchReqDone;
+        reqs[i].priv = bench;
+        if (MmcDeviceSubmitRequest(mmc, &reqs[i]) != HDF_SUCCESS) {
+            HDF_LOGE("%s: submit %u failed", __func__, i);
+            return HDF_FAILURE;
+        }
+    }
+    (void)OsalSemWait(&bench->done, HDF_WAIT_FOREVER);
+    (void)OsalGetTime(&end);
+
+    MmcCntlrGetReqStats(&bench->cntlr, &stats);
+    HDF_LOGI("%s: blocking %u KB/s, queued %u KB/s", __func__, EmmcBenchRate(&start, &mid), EmmcBenchRate(&mid, &end));
+    HDF_LOGI("%s: submitted %u, merged %u, transfers %u, cmd23 %u", __func__, stats.submitted, stats.merged,
+        stats.transfers, stats.sbcTransfers);
+    if (bench->errNum != 0 || memcmp(bench->disk, buf, EMMC_BENCH_REQ_NUM * len) != 0) {
+        HDF_LOGE("%s: queued write data mismatch, errNum %u", __func__, bench->errNum);
+        return HDF_FAILURE;
+    }
+    return HDF_SUCCESS;
+}
+
+static void EmmcBenchCntlrInit(struct EmmcBenchCntlr *bench)
+{
+    bench->cntlr.ops = &g_emmcBenchOps;
+    bench->cntlr.caps.bits.nonremovable = 1;
+    bench->cntlr.caps.bits.cmd23 = 1;
+    bench->cntlr.curDev = &bench->dev.mmc;
+    bench->dev.mmc.cntlr = &bench->cntlr;
+    bench->dev.mmc.type = MMC_DEV_EMMC;
+    bench->dev.mmc.state.bits.blockAddr = 1;
+    bench->dev.mmc.reg.csd.ccc = MMC_CSD_CCC_BLOCK_READ | MMC_CSD_CCC_BLOCK_WRITE;
+}
+
+static int32_t TestEmmcReqQueueBench(struct EmmcTester *tester)
+{
+    struct EmmcBenchCntlr *bench = NULL;
+    struct MmcReq *reqs = NULL;
+    uint8_t *buf = NULL;
+    uint32_t size = EMMC_BENCH_REQ_NUM * EMMC_BENCH_REQ_SEC * BYTES_PER_BLOCK;
+    uint32_t i;
+    int32_t ret = HDF_ERR_MALLOC_FAIL;
+
+    (void)tester;
+    bench = (struct EmmcBenchCntlr *)OsalMemCalloc(sizeof(*bench));
+    if (bench == NULL) {
+        HDF_LOGE("%s: malloc bench failed", __func__);
+        return ret;
+    }
+    reqs = (struct MmcReq *)OsalMemCalloc(sizeof(*reqs) * EMMC_BENCH_REQ_NUM);
+    buf = (uint8_t *)OsalMemCalloc(size);
+    bench->disk = (uint8_t *)OsalMemCalloc(size);
+    if (reqs != NULL && buf != NULL && bench->disk != NULL) {
+        for (i = 0; i < size; i++) {
+            buf[i] = (uint8_t)i;
+        }
+        EmmcBenchCntlrInit(bench);
+        (void)OsalMutexInit(&bench->cntlr.mutex);
+        (void)OsalSemInit(&bench->done, 0);
+        ret = MmcCntlrReqQueueStart(&bench->cntlr);
+        if (ret == HDF_SUCCESS) {
+            ret = EmmcBenchRun(bench, buf, reqs);
+            MmcCntlrReqQueueStop(&bench->cntlr);
+        }
+        (void)OsalSemDestroy(&bench->done);
+        (void)OsalMutexDestroy(&bench->cntlr.mutex);
+    }
+    OsalMemFree(bench->disk);
+    OsalMemFree(bench);
+    OsalMemFree(buf);
+    OsalMemFree(reqs);
+    return ret;
+}
+
 struct EmmcTestFunc g_emmcTestFunc[] = {
     { EMMC_GET_CID_01, TestEmmcGetCid },
+    { EMMC_REQ_QUEUE_BENCH_02, TestEmmcReqQueueBench },
 };
 
 static int32_t EmmcTestEntry(struct EmmcTester *tester, int32_t cmd)
@@ -69,6 +244,10 @@ static int32_t EmmcTestEntry(struct EmmcTester *tester, int32_t cmd)
         HDF_LOGE("%s: tester is NULL", __func__);
         return HDF_ERR_INVALID_OBJECT;
     }
+    if (cmd == EMMC_REQ_QUEUE_BENCH_02) {
+        /* runs on a fake controller, no emmc host is needed */
+        return TestEmmcReqQueueBench(tester);
+    }
     tester->handle = EmmcTestGetHandle(tester);
     if (tester->handle == NULL) {
         HDF_LOGE("%s: emmc test get handle failed", __func__);
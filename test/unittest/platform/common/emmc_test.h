@@ -14,6 +14,7 @@
 
 enum EmmcTestCmd {
     EMMC_GET_CID_01 = 0,
+    EMMC_REQ_QUEUE_BENCH_02,
 };
 
 struct EmmcTester {
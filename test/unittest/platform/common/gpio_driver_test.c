@@ -67,6 +67,12 @@ static int32_t GpioTestReadConfig(struct GpioTestConfig *config, const struct De
     }
     config->testUserApi = (uint16_t)tmp;
 
+    /* optional, the irq benchmark is skipped without a virtual controller */
+    if (drsOps->GetUint16(node, "virtual_gpio_start", &config->virtualGpioStart, 0) != HDF_SUCCESS ||
+        drsOps->GetUint16(node, "virtual_gpio_count", &config->virtualGpioCount, 0) != HDF_SUCCESS) {
+        config->virtualGpioCount = 0;
+    }
+
     return HDF_SUCCESS;
 }
 
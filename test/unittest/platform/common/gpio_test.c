@@ -14,6 +14,11 @@
 #include "osal_irq.h"
 #include "osal_time.h"
 #include "securec.h"
+#if !defined(_LINUX_USER_) && !defined(__USER__)
+#include "gpio/gpio_core.h"
+#include "osal_sem.h"
+#include "osal_spinlock.h"
+#endif
 
 #define HDF_LOG_TAG gpio_test
 
@@ -394,6 +399,323 @@ static int32_t GpioTestReliability(void)
     return HDF_SUCCESS;
 }
 
+#if !defined(_LINUX_USER_) && !defined(__USER__)
+#define GPIO_TEST_BENCH_LINES  32
+#define GPIO_TEST_BENCH_ROUNDS 16
+#define GPIO_TEST_BENCH_WAIT   1000 /* ms for a round to be handled */
+#define GPIO_TEST_USEC_PER_SEC 1000000
+#define GPIO_TEST_PERCENT      100
+#define GPIO_TEST_P50          50
+#define GPIO_TEST_P90          90
+#define GPIO_TEST_P99          99
+
+struct GpioTestBench {
+    uint16_t start;
+    uint16_t count;
+    OsalTimespec fired[GPIO_TEST_BENCH_LINES];
+    uint32_t lat[GPIO_TEST_BENCH_LINES * GPIO_TEST_BENCH_ROUNDS]; /* us from callback to routine */
+    uint32_t latNum;
+    uint32_t handled;
+    OsalSpinlock spin;
+    struct OsalSem done;
+};
+
+static struct GpioTestBench g_gpioBench;
+
+static int32_t GpioTestBenchHandler(uint16_t gpio, void *data)
+{
+    uint32_t flags;
+    OsalTimespec now;
+    OsalTimespec diff;
+    struct GpioTestBench *bench = (struct GpioTestBench *)data;
+
+    (void)OsalGetTime(&now);
+    (void)OsalDiffTime(&bench->fired[gpio - bench->start], &now, &diff);
+    (void)OsalSpinLockIrqSave(&bench->spin, &flags);
+    if (bench->latNum < GPIO_TEST_BENCH_LINES * GPIO_TEST_BENCH_ROUNDS) {
+        bench->lat[bench->latNum++] = (uint32_t)(diff.sec * GPIO_TEST_USEC_PER_SEC + diff.usec);
+    }
+    if (++bench->handled == bench->count) {
+        (void)OsalSemPost(&bench->done);
+    }
+    (void)OsalSpinUnlockIrqRestore(&bench->spin, &flags);
+    return HDF_SUCCESS;
+}
+
+static void GpioTestBenchSort(uint32_t *vals, uint32_t num)
+{
+    uint32_t i;
+    uint32_t j;
+    uint32_t tmp;
+
+    for (i = 1; i < num; i++) {
+        tmp = vals[i];
+        for (j = i; j > 0 && vals[j - 1] > tmp; j--) {
+            vals[j] = vals[j - 1];
+        }
+        vals[j] = tmp;
+    }
+}
+
+static int32_t GpioTestBenchModel(struct GpioTestBench *bench, uint16_t mode, const char *model)
+{
+    int32_t ret = HDF_SUCCESS;
+    uint16_t i;
+    uint16_t round;
+    uint32_t flags;
+    struct GpioIrqFootprint footprint;
+    struct GpioCntlr *cntlr = GpioGetCntlr(bench->start);
+
+    if (cntlr == NULL) {
+        HDF_LOGE("%s: no controller for gpio:%u", __func__, bench->start);
+        return HDF_ERR_NOT_SUPPORT;
+    }
+    for (i = 0; i < bench->count; i++) {
+        ret = GpioSetIrq(bench->start + i, mode, GpioTestBenchHandler, bench);
+        if (ret != HDF_SUCCESS) {
+            HDF_LOGE("%s: set irq of gpio:%u fail! ret:%d", __func__, bench->start + i, ret);
+            bench->count = i;
+            goto __UNSET;
+        }
+    }
+    GpioIrqGetFootprint(&footprint);
+
+    bench->latNum = 0;
+    for (round = 0; round < GPIO_TEST_BENCH_ROUNDS; round++) {
+        (void)OsalSpinLockIrqSave(&bench->spin, &flags);
+        bench->handled = 0;
+        (void)OsalSpinUnlockIrqRestore(&bench->spin, &flags);
+        for (i = 0; i < bench->count; i++) {
+            (void)OsalGetTime(&bench->fired[i]);
+            GpioCntlrIrqCallback(cntlr, GpioGetLocalNumber(cntlr, bench->start + i));
+        }
+        if (OsalSemWait(&bench->done, GPIO_TEST_BENCH_WAIT) != HDF_SUCCESS) {
+            HDF_LOGE("%s: %s round:%u handled %u of %u", __func__, model, round, bench->handled, bench->count);
+            ret = HDF_FAILURE;
+            goto __UNSET;
+        }
+    }
+
+    GpioTestBenchSort(bench->lat, bench->latNum);
+    HDF_LOGI("%s: %s lines:%u threads:%u bytes:%u latency(us) p50:%u p90:%u p99:%u max:%u", __func__, model,
+        bench->count, footprint.threads, footprint.bytes,
+        bench->lat[bench->latNum * GPIO_TEST_P50 / GPIO_TEST_PERCENT],
+        bench->lat[bench->latNum * GPIO_TEST_P90 / GPIO_TEST_PERCENT],
+        bench->lat[bench->latNum * GPIO_TEST_P99 / GPIO_TEST_PERCENT], bench->lat[bench->latNum - 1]);
+
+__UNSET:
+    for (i = 0; i < bench->count; i++) {
+        (void)GpioUnSetIrq(bench->start + i);
+    }
+    GpioCntlrPut(cntlr);
+    return ret;
+}
+#endif
+
+/*
+ * Fire the threaded irq of many lines of a virtual controller, once dispatched by the shared
+ * pool and once by a thread per line, and compare the latency and the memory of both.
+ */
+static int32_t GpioTestIrqPoolBench(void)
+{
+#if defined(_LINUX_USER_) || defined(__USER__)
+    return HDF_SUCCESS;
+#else
+    int32_t ret;
+    uint16_t count;
+    struct GpioTester *tester = NULL;
+    struct GpioTestBench *bench = &g_gpioBench;
+
+    tester = GpioTesterGet();
+    if (tester == NULL) {
+        HDF_LOGE("%s: get tester failed", __func__);
+        return HDF_ERR_INVALID_OBJECT;
+    }
+    if (tester->cfg.virtualGpioCount == 0) {
+        HDF_LOGI("%s: no virtual controller configured, skip", __func__);
+        return HDF_SUCCESS;
+    }
+    count = (tester->cfg.virtualGpioCount < GPIO_TEST_BENCH_LINES) ?
+        tester->cfg.virtualGpioCount : GPIO_TEST_BENCH_LINES;
+
+    (void)memset_s(bench, sizeof(*bench), 0, sizeof(*bench));
+    bench->start = tester->cfg.virtualGpioStart;
+    if (OsalSpinInit(&bench->spin) != HDF_SUCCESS) {
+        return HDF_FAILURE;
+    }
+    if (OsalSemInit(&bench->done, 0) != HDF_SUCCESS) {
+        (void)OsalSpinDestroy(&bench->spin);
+        return HDF_FAILURE;
+    }
+
+    bench->count = count;
+    ret = GpioTestBenchModel(bench, GPIO_IRQ_TRIGGER_RISING | GPIO_IRQ_USING_THREAD, "pool");
+    if (ret == HDF_SUCCESS) {
+        bench->count = count;
+        ret = GpioTestBenchModel(bench, GPIO_IRQ_TRIGGER_RISING | GPIO_IRQ_USING_THREAD |
+            GPIO_IRQ_THREAD_DEDICATED, "dedicated");
+    }
+
+    (void)OsalSemDestroy(&bench->done);
+    (void)OsalSpinDestroy(&bench->spin);
+    return ret;
+#endif
+}
+
+#if !defined(_LINUX_USER_) && !defined(__USER__)
+#define GPIO_TEST_TOGGLE_CNTLRS 32
+#define GPIO_TEST_TOGGLE_PINS   8
+#define GPIO_TEST_TOGGLE_BASE   0x8000 /* above the numbers of real controllers */
+#define GPIO_TEST_TOGGLE_TIMES  100000
+#define GPIO_TEST_USEC_PER_MSEC 1000
+
+struct GpioTestToggleCntlr {
+    struct GpioCntlr cntlr;
+    uint16_t vals[GPIO_TEST_TOGGLE_PINS];
+    uint32_t multiCalls;
+};
+
+static struct GpioTestToggleCntlr g_gpioToggleCntlrs[GPIO_TEST_TOGGLE_CNTLRS];
+
+static int32_t GpioTestToggleWrite(struct GpioCntlr *cntlr, uint16_t local, uint16_t val)
+{
+    ((struct GpioTestToggleCntlr *)cntlr)->vals[local] = val;
+    return HDF_SUCCESS;
+}
+
+static int32_t GpioTestToggleRead(struct GpioCntlr *cntlr, uint16_t local, uint16_t *val)
+{
+    *val = ((struct GpioTestToggleCntlr *)cntlr)->vals[local];
+    return HDF_SUCCESS;
+}
+
+static int32_t GpioTestToggleWriteMulti(struct GpioCntlr *cntlr, const uint16_t *locals, const uint16_t *vals,
+    uint16_t count)
+{
+    uint16_t i;
+    struct GpioTestToggleCntlr *toggle = (struct GpioTestToggleCntlr *)cntlr;
+
+    toggle->multiCalls++;
+    for (i = 0; i < count; i++) {
+        toggle->vals[locals[i]] = vals[i];
+    }
+    return HDF_SUCCESS;
+}
+
+static struct GpioMethod g_gpioToggleMethod = {
+    .write = GpioTestToggleWrite,
+    .read = GpioTestToggleRead,
+    .writeMulti = GpioTestToggleWriteMulti,
+};
+
+static uint32_t GpioTestToggleRate(const OsalTimespec *begin, uint32_t times)
+{
+    OsalTimespec end;
+    OsalTimespec diff;
+    uint64_t ms;
+
+    (void)OsalGetTime(&end);
+    (void)OsalDiffTime(begin, &end, &diff);
+    ms = (uint64_t)diff.sec * GPIO_TEST_USEC_PER_MSEC + diff.usec / GPIO_TEST_USEC_PER_MSEC;
+    return (ms == 0) ? times * GPIO_TEST_USEC_PER_MSEC : (uint32_t)((uint64_t)times * GPIO_TEST_USEC_PER_MSEC / ms);
+}
+
+/* toggle one pin of the first and of the last controller, then all pins of the last one per batch */
+static int32_t GpioTestToggleRun(void)
+{
+    uint32_t i;
+    uint16_t j;
+    uint16_t gpios[GPIO_TEST_TOGGLE_PINS];
+    uint16_t vals[GPIO_TEST_TOGGLE_PINS];
+    uint32_t rates[3]; /* first, last, batch */
+    OsalTimespec begin;
+    struct GpioTestToggleCntlr *last = &g_gpioToggleCntlrs[GPIO_TEST_TOGGLE_CNTLRS - 1];
+
+    (void)OsalGetTime(&begin);
+    for (i = 0; i < GPIO_TEST_TOGGLE_TIMES; i++) {
+        (void)GpioWrite(g_gpioToggleCntlrs[0].cntlr.start, i & GPIO_VAL_HIGH);
+    }
+    rates[0] = GpioTestToggleRate(&begin, GPIO_TEST_TOGGLE_TIMES);
+
+    (void)OsalGetTime(&begin);
+    for (i = 0; i < GPIO_TEST_TOGGLE_TIMES; i++) {
+        (void)GpioWrite(last->cntlr.start, i & GPIO_VAL_HIGH);
+    }
+    rates[1] = GpioTestToggleRate(&begin, GPIO_TEST_TOGGLE_TIMES);
+
+    for (j = 0; j < GPIO_TEST_TOGGLE_PINS; j++) {
+        gpios[j] = last->cntlr.start + j;
+    }
+    last->multiCalls = 0;
+    (void)OsalGetTime(&begin);
+    for (i = 0; i < GPIO_TEST_TOGGLE_TIMES; i++) {
+        for (j = 0; j < GPIO_TEST_TOGGLE_PINS; j++) {
+            vals[j] = (i + j) & GPIO_VAL_HIGH;
+        }
+        if (GpioWriteMulti(gpios, vals, GPIO_TEST_TOGGLE_PINS) != HDF_SUCCESS) {
+            HDF_LOGE("%s: write multi fail!", __func__);
+            return HDF_FAILURE;
+        }
+    }
+    rates[2] = GpioTestToggleRate(&begin, GPIO_TEST_TOGGLE_TIMES * GPIO_TEST_TOGGLE_PINS);
+    if (last->multiCalls != GPIO_TEST_TOGGLE_TIMES) {
+        HDF_LOGE("%s: %u batches took %u controller accesses", __func__, GPIO_TEST_TOGGLE_TIMES, last->multiCalls);
+        return HDF_FAILURE;
+    }
+
+    if (GpioReadMulti(gpios, vals, GPIO_TEST_TOGGLE_PINS) != HDF_SUCCESS) {
+        HDF_LOGE("%s: read multi fail!", __func__);
+        return HDF_FAILURE;
+    }
+    for (j = 0; j < GPIO_TEST_TOGGLE_PINS; j++) {
+        if (vals[j] != ((GPIO_TEST_TOGGLE_TIMES - 1 + j) & GPIO_VAL_HIGH)) {
+            HDF_LOGE("%s: pin:%u read %u after batch write", __func__, gpios[j], vals[j]);
+            return HDF_FAILURE;
+        }
+    }
+
+    HDF_LOGI("%s: %u controllers, toggles/s first:%u last:%u batched pins/s:%u", __func__,
+        GPIO_TEST_TOGGLE_CNTLRS, rates[0], rates[1], rates[2]);
+    return HDF_SUCCESS;
+}
+#endif
+
+/*
+ * Register many controllers and measure how fast a pin is toggled, which shows the
+ * cost of resolving a gpio number to its controller.
+ */
+static int32_t GpioTestToggleBench(void)
+{
+#if defined(_LINUX_USER_) || defined(__USER__)
+    return HDF_SUCCESS;
+#else
+    int32_t ret = HDF_SUCCESS;
+    uint16_t i;
+    uint16_t added;
+
+    (void)memset_s(g_gpioToggleCntlrs, sizeof(g_gpioToggleCntlrs), 0, sizeof(g_gpioToggleCntlrs));
+    for (added = 0; added < GPIO_TEST_TOGGLE_CNTLRS; added++) {
+        g_gpioToggleCntlrs[added].cntlr.start = GPIO_TEST_TOGGLE_BASE + added * GPIO_TEST_TOGGLE_PINS;
+        g_gpioToggleCntlrs[added].cntlr.count = GPIO_TEST_TOGGLE_PINS;
+        g_gpioToggleCntlrs[added].cntlr.ops = &g_gpioToggleMethod;
+        ret = GpioCntlrAdd(&g_gpioToggleCntlrs[added].cntlr);
+        if (ret != HDF_SUCCESS) {
+            HDF_LOGE("%s: add controller %u fail! ret:%d", __func__, added, ret);
+            break;
+        }
+    }
+
+    if (ret == HDF_SUCCESS) {
+        ret = GpioTestToggleRun();
+    }
+
+    for (i = 0; i < added; i++) {
+        GpioCntlrRemove(&g_gpioToggleCntlrs[i].cntlr);
+    }
+    return ret;
+#endif
+}
+
 struct GpioTestEntry {
     int cmd;
     int32_t (*func)(void);
@@ -407,6 +729,8 @@ static struct GpioTestEntry g_entry[] = {
     { GPIO_TEST_IRQ_EDGE, GpioTestIrqEdge, "GpioTestIrqEdge" },
     { GPIO_TEST_IRQ_THREAD, GpioTestIrqThread, "GpioTestIrqThread" },
     { GPIO_TEST_RELIABILITY, GpioTestReliability, "GpioTestReliability" },
+    { GPIO_TEST_IRQ_POOL_BENCH, GpioTestIrqPoolBench, "GpioTestIrqPoolBench" },
+    { GPIO_TEST_TOGGLE_BENCH, GpioTestToggleBench, "GpioTestToggleBench" },
 };
 
 int32_t GpioTestExecute(int cmd)
@@ -24,13 +24,17 @@ enum GpioTestCmd {
     GPIO_TEST_IRQ_EDGE = 3,
     GPIO_TEST_IRQ_THREAD = 4,
     GPIO_TEST_RELIABILITY = 5,
-    GPIO_TEST_MAX = 6,
+    GPIO_TEST_IRQ_POOL_BENCH = 6,
+    GPIO_TEST_TOGGLE_BENCH = 7,
+    GPIO_TEST_MAX = 8,
 };
 
 struct GpioTestConfig {
     uint16_t gpio;
     uint16_t gpioIrq;
     uint16_t testUserApi;
+    uint16_t virtualGpioStart; /* lines of a virtual controller for the irq benchmark */
+    uint16_t virtualGpioCount; /* 0 if there is none */
 };
 
 struct GpioTester {
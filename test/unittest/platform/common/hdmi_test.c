@@ -10,8 +10,13 @@
 #include "device_resource_if.h"
 #include "hdf_base.h"
 #include "hdf_log.h"
+#include "hdmi_core.h"
 #include "hdmi_if.h"
+#include "osal_mem.h"
+#include "osal_sem.h"
+#include "osal_spinlock.h"
 #include "osal_time.h"
+#include "securec.h"
 
 #define HDF_LOG_TAG hdmi_test_c
 
@@ -185,6 +190,531 @@ static int32_t TestHdmiHpdRegisterAndUnregister(struct HdmiTester *tester)
     return ret;
 }
 
+#define HDMI_TEST_CEC_OWN_ADDR 1
+#define HDMI_TEST_CEC_TV_ADDR 0
+#define HDMI_TEST_CEC_ABSENT_ADDR 9
+#define HDMI_TEST_CEC_ADDR_NUM 16
+#define HDMI_TEST_CEC_LOG_LEN 64
+#define HDMI_TEST_CEC_POLL_TAG 0xFF
+#define HDMI_TEST_CEC_WAIT_MS 1000
+#define HDMI_TEST_CEC_BENCH_FRAMES 10000
+#define HDMI_TEST_CEC_BENCH_REQUESTS 100
+#define HDMI_TEST_CEC_BENCH_BACKLOG 8
+#define HDMI_TEST_CEC_BUSY_WAIT_US 100
+#define HDMI_TEST_USEC_PER_SEC 1000000
+
+struct HdmiTestCecFrame {
+    uint8_t header;
+    uint8_t tag;
+    bool ack;
+};
+
+/* A CEC bus with a few logical devices behind a simulated controller. */
+struct HdmiTestCecBus {
+    struct HdmiCntlr cntlr;
+    struct HdmiCntlrOps ops;
+    uint16_t present;                               /* logical addresses that acknowledge a frame */
+    uint8_t nack[HDMI_TEST_CEC_ADDR_NUM];           /* injected failures left per destination */
+    bool gated;                                     /* the next frame waits for the gate */
+    struct OsalSem gate;
+    struct OsalSem gateEntered;
+    OsalSpinlock spin;
+    uint32_t frames;
+    struct HdmiTestCecFrame log[HDMI_TEST_CEC_LOG_LEN];
+    uint32_t replies;
+    uint64_t replyUs;
+};
+
+static struct HdmiTestCecBus g_hdmiTestCecBus;
+
+static uint64_t HdmiTestNowUs(void)
+{
+    OsalTimespec time = {0, 0};
+
+    (void)OsalGetTime(&time);
+    return (uint64_t)time.sec * HDMI_TEST_USEC_PER_SEC + time.usec;
+}
+
+static int32_t HdmiTestCecMsgSend(struct HdmiCntlr *cntlr, struct HdmiCecMsg *msg)
+{
+    struct HdmiTestCecBus *bus = (struct HdmiTestCecBus *)cntlr->priv;
+    uint8_t dest = HdmiCecGetMsgDestination(msg);
+    bool ack = false;
+
+    if (bus->gated) {
+        bus->gated = false;
+        (void)OsalSemPost(&bus->gateEntered);
+        (void)OsalSemWait(&bus->gate, HDF_WAIT_FOREVER);
+    }
+    (void)OsalSpinLock(&bus->spin);
+    if (bus->nack[dest] > 0) {
+        bus->nack[dest]--;
+    } else {
+        ack = ((bus->present & (1 << dest)) != 0);
+    }
+    if (bus->frames < HDMI_TEST_CEC_LOG_LEN) {
+        bus->log[bus->frames].header = msg->data[HDMI_CEC_MSG_DATA_ZEROTH_ELEMENT];
+        bus->log[bus->frames].tag = (msg->len > HDMI_CEC_MSG_DATA_SECOND_ELEMENT) ?
+            msg->data[HDMI_CEC_MSG_DATA_SECOND_ELEMENT] : HDMI_TEST_CEC_POLL_TAG;
+        bus->log[bus->frames].ack = ack;
+    }
+    bus->frames++;
+    if (msg->len > HDMI_CEC_MSG_DATA_FIRST_ELEMENT &&
+        msg->data[HDMI_CEC_MSG_DATA_FIRST_ELEMENT] == HDMI_CEC_OPCODE_REPORT_PHYSICAL_ADDRESS) {
+        bus->replies++;
+        bus->replyUs = HdmiTestNowUs();
+    }
+    (void)OsalSpinUnlock(&bus->spin);
+    return ack ? HDF_SUCCESS : HDF_ERR_IO;
+}
+
+static int32_t HdmiTestCecBusInit(struct HdmiTestCecBus *bus)
+{
+    int32_t ret;
+
+    (void)memset_s(bus, sizeof(*bus), 0, sizeof(*bus));
+    bus->present = (1 << HDMI_TEST_CEC_TV_ADDR) | (1 << 4) | (1 << 5) | (1 << 8) |
+        (1 << HDMI_CEC_LOG_ADDR_UNREGISTERED_OR_BROADCAST);
+    bus->ops.cecMsgSend = HdmiTestCecMsgSend;
+    bus->cntlr.ops = &bus->ops;
+    bus->cntlr.priv = bus;
+    bus->cntlr.cap.baseCap.bits.cec = 1;
+    (void)OsalSpinInit(&bus->spin);
+    (void)OsalSemInit(&bus->gate, 0);
+    (void)OsalSemInit(&bus->gateEntered, 0);
+    (void)OsalMutexInit(&bus->cntlr.mutex);
+    bus->cntlr.cec = (struct HdmiCec *)OsalMemCalloc(sizeof(struct HdmiCec));
+    if (bus->cntlr.cec == NULL) {
+        HDF_LOGE("%s: malloc cec fail", __func__);
+        return HDF_ERR_MALLOC_FAIL;
+    }
+    (void)OsalSpinInit(&bus->cntlr.cec->txLock);
+    bus->cntlr.cec->priv = &bus->cntlr;
+    /* logAddr holds a mask of the logical addresses taken */
+    bus->cntlr.cec->info.logAddr = (1 << HDMI_TEST_CEC_OWN_ADDR);
+    bus->cntlr.cec->info.logAddrMask = (1 << HDMI_TEST_CEC_OWN_ADDR);
+    bus->cntlr.cec->info.primaryDeviceType = HDMI_CEC_DEVICE_TYPE_PLAYBACK_DEVICE;
+    ret = HdmiCecTxQueueStart(bus->cntlr.cec);
+    if (ret != HDF_SUCCESS) {
+        HDF_LOGE("%s: tx queue start fail, ret = %d", __func__, ret);
+    }
+    return ret;
+}
+
+static void HdmiTestCecBusDeinit(struct HdmiTestCecBus *bus)
+{
+    if (bus->cntlr.cec != NULL) {
+        HdmiCecTxQueueStop(bus->cntlr.cec);
+        (void)OsalSpinDestroy(&bus->cntlr.cec->txLock);
+        OsalMemFree(bus->cntlr.cec);
+        bus->cntlr.cec = NULL;
+    }
+    (void)OsalMutexDestroy(&bus->cntlr.mutex);
+    (void)OsalSemDestroy(&bus->gateEntered);
+    (void)OsalSemDestroy(&bus->gate);
+    (void)OsalSpinDestroy(&bus->spin);
+}
+
+static int32_t HdmiTestCecQueue(struct HdmiCec *cec, uint8_t dest, uint8_t tag, enum HdmiCecTxPriority priority)
+{
+    struct HdmiCecMsg msg = {0};
+
+    msg.data[HDMI_CEC_MSG_DATA_ZEROTH_ELEMENT] =
+        (HDMI_TEST_CEC_OWN_ADDR << HDMI_CEC_HEADER_BLOCK_INITIATOR_SHIFT) | dest;
+    if (tag == HDMI_TEST_CEC_POLL_TAG) {
+        msg.len = HDMI_POLLING_MSG_LEN;
+    } else {
+        msg.len = HDMI_CEC_GET_MSG_LEN(1);
+        msg.data[HDMI_CEC_MSG_DATA_FIRST_ELEMENT] = HDMI_CEC_OPCODE_VENDOR_COMMAND;
+        msg.data[HDMI_CEC_MSG_DATA_SECOND_ELEMENT] = tag;
+    }
+    return HdmiCecQueueMsg(cec, &msg, priority);
+}
+
+static int32_t HdmiTestCecWaitDone(struct HdmiCec *cec, uint32_t done, struct HdmiCecTxStats *stats)
+{
+    uint32_t i;
+
+    for (i = 0; i < HDMI_TEST_CEC_WAIT_MS; i++) {
+        (void)HdmiCecGetTxStats(cec, stats);
+        if (stats->sent + stats->failed >= done) {
+            return HDF_SUCCESS;
+        }
+        OsalMSleep(1);
+    }
+    HDF_LOGE("%s: %u of %u messages done", __func__, stats->sent + stats->failed, done);
+    return HDF_ERR_TIMEOUT;
+}
+
+/* index of the first logged frame with the tag, acknowledged or not as asked */
+static int32_t HdmiTestCecFindFrame(const struct HdmiTestCecBus *bus, uint8_t tag, bool ack)
+{
+    uint32_t i;
+
+    for (i = 0; i < bus->frames && i < HDMI_TEST_CEC_LOG_LEN; i++) {
+        if (bus->log[i].tag == tag && bus->log[i].ack == ack) {
+            return (int32_t)i;
+        }
+    }
+    return -1;
+}
+
+static int32_t TestHdmiCecTxQueueOrder(struct HdmiTestCecBus *bus)
+{
+    uint32_t i;
+    struct HdmiCecTxStats stats = {0};
+    struct HdmiCec *cec = bus->cntlr.cec;
+    static const uint8_t expect[] = { 0, 3, 2, 1, HDMI_TEST_CEC_POLL_TAG };
+
+    /* hold the bus on the first frame so that the rest wait in the queue */
+    bus->gated = true;
+    (void)HdmiTestCecQueue(cec, 4, 0, HDMI_CEC_TX_PRIORITY_NORMAL);
+    if (OsalSemWait(&bus->gateEntered, HDMI_TEST_CEC_WAIT_MS) != HDF_SUCCESS) {
+        HDF_LOGE("%s: first frame not sent", __func__);
+        return HDF_FAILURE;
+    }
+    (void)HdmiTestCecQueue(cec, 5, 1, HDMI_CEC_TX_PRIORITY_LOW);
+    (void)HdmiTestCecQueue(cec, 8, 2, HDMI_CEC_TX_PRIORITY_NORMAL);
+    (void)HdmiTestCecQueue(cec, HDMI_TEST_CEC_TV_ADDR, 3, HDMI_CEC_TX_PRIORITY_HIGH);
+    (void)HdmiTestCecQueue(cec, 5, HDMI_TEST_CEC_POLL_TAG, HDMI_CEC_TX_PRIORITY_LOW);
+    (void)HdmiTestCecQueue(cec, 5, HDMI_TEST_CEC_POLL_TAG, HDMI_CEC_TX_PRIORITY_LOW);
+    (void)OsalSemPost(&bus->gate);
+
+    if (HdmiTestCecWaitDone(cec, sizeof(expect), &stats) != HDF_SUCCESS) {
+        return HDF_FAILURE;
+    }
+    if (bus->frames != sizeof(expect) || stats.deduped != 1) {
+        HDF_LOGE("%s: %u frames on the bus, %u deduped", __func__, bus->frames, stats.deduped);
+        return HDF_FAILURE;
+    }
+    for (i = 0; i < sizeof(expect); i++) {
+        if (bus->log[i].tag != expect[i] || !bus->log[i].ack) {
+            HDF_LOGE("%s: frame %u has tag 0x%x, expect 0x%x", __func__, i, bus->log[i].tag, expect[i]);
+            return HDF_FAILURE;
+        }
+    }
+    return HDF_SUCCESS;
+}
+
+static int32_t TestHdmiCecTxQueueRetry(struct HdmiTestCecBus *bus)
+{
+    uint32_t i;
+    int32_t firstSent, secondSent, otherSent, replySent;
+    struct HdmiCecTxStats stats = {0};
+    struct HdmiCecTxStats old = {0};
+    struct HdmiCec *cec = bus->cntlr.cec;
+    const uint32_t nack = 2;
+
+    (void)HdmiCecGetTxStats(cec, &old);
+    (void)OsalSpinLock(&bus->spin);
+    bus->frames = 0;
+    bus->nack[4] = nack;
+    (void)OsalSpinUnlock(&bus->spin);
+    (void)HdmiTestCecQueue(cec, 4, 10, HDMI_CEC_TX_PRIORITY_NORMAL);
+    (void)HdmiTestCecQueue(cec, 4, 11, HDMI_CEC_TX_PRIORITY_NORMAL);
+    (void)HdmiTestCecQueue(cec, 5, 12, HDMI_CEC_TX_PRIORITY_NORMAL);
+    (void)HdmiTestCecQueue(cec, HDMI_TEST_CEC_ABSENT_ADDR, 13, HDMI_CEC_TX_PRIORITY_NORMAL);
+    /* once the first frame waits for its retry, a reply to the same device must not overtake it */
+    for (i = 0; i < HDMI_TEST_CEC_WAIT_MS && HdmiTestCecFindFrame(bus, 10, false) < 0; i++) {
+        OsalMSleep(1);
+    }
+    (void)HdmiTestCecQueue(cec, 4, 14, HDMI_CEC_TX_PRIORITY_HIGH);
+    if (HdmiTestCecWaitDone(cec, old.sent + old.failed + 5, &stats) != HDF_SUCCESS) {
+        return HDF_FAILURE;
+    }
+
+    /* the other device is served while the first frame waits, the later ones to it stay behind it */
+    firstSent = HdmiTestCecFindFrame(bus, 10, true);
+    secondSent = HdmiTestCecFindFrame(bus, 11, true);
+    otherSent = HdmiTestCecFindFrame(bus, 12, true);
+    replySent = HdmiTestCecFindFrame(bus, 14, true);
+    if (firstSent < 0 || secondSent < firstSent || otherSent < 0 || otherSent > firstSent || replySent < firstSent) {
+        HDF_LOGE("%s: frames sent at %d, %d, %d, %d", __func__, firstSent, secondSent, otherSent, replySent);
+        return HDF_FAILURE;
+    }
+    if (stats.failed - old.failed != 1 || stats.retries - old.retries != nack + HDMI_CEC_TX_RETRY_MAX) {
+        HDF_LOGE("%s: %u failed, %u retries", __func__, stats.failed - old.failed, stats.retries - old.retries);
+        return HDF_FAILURE;
+    }
+    return HDF_SUCCESS;
+}
+
+static int32_t TestHdmiCecTxQueue(struct HdmiTester *tester)
+{
+    int32_t ret;
+    struct HdmiTestCecBus *bus = &g_hdmiTestCecBus;
+
+    (void)tester;
+    ret = HdmiTestCecBusInit(bus);
+    if (ret == HDF_SUCCESS) {
+        ret = TestHdmiCecTxQueueOrder(bus);
+    }
+    if (ret == HDF_SUCCESS) {
+        ret = TestHdmiCecTxQueueRetry(bus);
+    }
+    HdmiTestCecBusDeinit(bus);
+    return ret;
+}
+
+static int32_t TestHdmiCecTxQueueThroughput(struct HdmiTestCecBus *bus)
+{
+    uint32_t i;
+    uint64_t start, costUs;
+    struct HdmiCecTxStats stats = {0};
+    struct HdmiCec *cec = bus->cntlr.cec;
+    static const uint8_t dests[] = { HDMI_TEST_CEC_TV_ADDR, 4, 5, 8 };
+
+    start = HdmiTestNowUs();
+    for (i = 0; i < HDMI_TEST_CEC_BENCH_FRAMES; i++) {
+        while (HdmiTestCecQueue(cec, dests[i % sizeof(dests)], (uint8_t)i, HDMI_CEC_TX_PRIORITY_NORMAL) ==
+            HDF_ERR_DEVICE_BUSY) {
+            OsalUSleep(HDMI_TEST_CEC_BUSY_WAIT_US);
+        }
+    }
+    if (HdmiTestCecWaitDone(cec, HDMI_TEST_CEC_BENCH_FRAMES, &stats) != HDF_SUCCESS) {
+        return HDF_FAILURE;
+    }
+    costUs = HdmiTestNowUs() - start;
+    HDF_LOGI("%s: %u frames in %llu us, %llu frames/s, mean queue latency %llu us, max %u us", __func__,
+        HDMI_TEST_CEC_BENCH_FRAMES, (unsigned long long)costUs,
+        (unsigned long long)HDMI_TEST_CEC_BENCH_FRAMES * HDMI_TEST_USEC_PER_SEC / (costUs + 1),
+        (unsigned long long)(stats.latencySumUs / HDMI_TEST_CEC_BENCH_FRAMES), stats.latencyMaxUs);
+    return HDF_SUCCESS;
+}
+
+/* time from a request received to the reply on the bus, with a backlog of low priority frames */
+static int32_t TestHdmiCecTxQueueResponse(struct HdmiTestCecBus *bus)
+{
+    uint32_t i, j, replies;
+    uint64_t start, latencyUs;
+    uint64_t sumUs = 0;
+    uint64_t maxUs = 0;
+    struct HdmiCec *cec = bus->cntlr.cec;
+    struct HdmiCecMsg request = {0};
+
+    for (i = 0; i < HDMI_TEST_CEC_BENCH_REQUESTS; i++) {
+        for (j = 0; j < HDMI_TEST_CEC_BENCH_BACKLOG; j++) {
+            (void)HdmiTestCecQueue(cec, 8, (uint8_t)j, HDMI_CEC_TX_PRIORITY_LOW);
+        }
+        (void)OsalSpinLock(&bus->spin);
+        replies = bus->replies;
+        (void)OsalSpinUnlock(&bus->spin);
+        request.len = HDMI_CEC_GET_MSG_LEN(0);
+        request.data[HDMI_CEC_MSG_DATA_ZEROTH_ELEMENT] =
+            (HDMI_TEST_CEC_TV_ADDR << HDMI_CEC_HEADER_BLOCK_INITIATOR_SHIFT) | HDMI_TEST_CEC_OWN_ADDR;
+        request.data[HDMI_CEC_MSG_DATA_FIRST_ELEMENT] = HDMI_CEC_OPCODE_GIVE_PHYSICAL_ADDRESS;
+        start = HdmiTestNowUs();
+        if (HdmiCecReceivedMsg(cec, &request) != HDF_SUCCESS) {
+            HDF_LOGE("%s: request %u not handled", __func__, i);
+            return HDF_FAILURE;
+        }
+        for (j = 0; j < HDMI_TEST_CEC_WAIT_MS && bus->replies == replies; j++) {
+            OsalMSleep(1);
+        }
+        (void)OsalSpinLock(&bus->spin);
+        latencyUs = bus->replyUs - start;
+        replies = bus->replies - replies;
+        (void)OsalSpinUnlock(&bus->spin);
+        if (replies != 1) {
+            HDF_LOGE("%s: request %u got %u replies", __func__, i, replies);
+            return HDF_FAILURE;
+        }
+        sumUs += latencyUs;
+        maxUs = (latencyUs > maxUs) ? latencyUs : maxUs;
+    }
+    HDF_LOGI("%s: %u requests, mean reply latency %llu us, max %llu us", __func__, HDMI_TEST_CEC_BENCH_REQUESTS,
+        (unsigned long long)(sumUs / HDMI_TEST_CEC_BENCH_REQUESTS), (unsigned long long)maxUs);
+    return HDF_SUCCESS;
+}
+
+static int32_t TestHdmiCecTxQueueBench(struct HdmiTester *tester)
+{
+    int32_t ret;
+    struct HdmiTestCecBus *bus = &g_hdmiTestCecBus;
+
+    (void)tester;
+    ret = HdmiTestCecBusInit(bus);
+    if (ret == HDF_SUCCESS) {
+        ret = TestHdmiCecTxQueueThroughput(bus);
+    }
+    if (ret == HDF_SUCCESS) {
+        ret = TestHdmiCecTxQueueResponse(bus);
+    }
+    HdmiTestCecBusDeinit(bus);
+    return ret;
+}
+
+#define HDMI_TEST_EDID_SEGMENT_SIZE 256
+#define HDMI_TEST_DDC_US_PER_BYTE 90    /* 9 bit times per byte at 100 kHz */
+#define HDMI_TEST_EDID_REPLUG_TIMES 10
+#define HDMI_TEST_EDID_SERIAL_ADDR 12
+#define HDMI_TEST_EDID_VERSION_ADDR 18
+#define HDMI_TEST_EDID_EXT_FLAGS 0x70   /* audio, ycbcr444 and ycbcr422 */
+
+/* A DDC that serves the EDID of the sink currently plugged and counts the transfers. */
+struct HdmiTestDdc {
+    struct HdmiCntlr cntlr;
+    struct HdmiCntlrOps ops;
+    uint8_t image[HDMI_EDID_TOTAL_SIZE];
+    uint32_t transfers;
+};
+
+static struct HdmiTestDdc g_hdmiTestDdc;
+
+static int32_t HdmiTestDdcTransfer(struct HdmiCntlr *cntlr, struct HdmiDdcCfg *ddcCfg)
+{
+    struct HdmiTestDdc *ddc = (struct HdmiTestDdc *)cntlr->priv;
+    uint32_t pos = ddcCfg->segment * HDMI_TEST_EDID_SEGMENT_SIZE + ddcCfg->offset;
+
+    if (ddcCfg->type != HDMI_DDC_DEV_EDID || ddcCfg->readFlag != true ||
+        pos + ddcCfg->dataLen > HDMI_EDID_TOTAL_SIZE) {
+        HDF_LOGE("%s: invalid transfer at %u, len %u", __func__, pos, ddcCfg->dataLen);
+        return HDF_ERR_INVALID_PARAM;
+    }
+    OsalUSleep(ddcCfg->dataLen * HDMI_TEST_DDC_US_PER_BYTE);
+    ddc->transfers++;
+    return memcpy_s(ddcCfg->data, ddcCfg->dataLen, ddc->image + pos, ddcCfg->dataLen);
+}
+
+static void HdmiTestEdidCheckSum(uint8_t *block)
+{
+    uint32_t i;
+    uint8_t sum = 0;
+
+    for (i = 0; i < HDMI_EDID_CHECKSUM_ADDR; i++) {
+        sum += block[i];
+    }
+    block[HDMI_EDID_CHECKSUM_ADDR] = (uint8_t)(0 - sum);
+}
+
+/* plugs a sink whose EDID has extNum CTA extension blocks */
+static void HdmiTestEdidPlug(struct HdmiTestDdc *ddc, uint8_t extNum, uint8_t serial)
+{
+    uint8_t i;
+    uint8_t *block = ddc->image;
+    static const uint8_t header[HDMI_EDID_BLOCK_HEADER_FIELD_LEN] = { 0x00, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x00 };
+
+    (void)memset_s(ddc->image, sizeof(ddc->image), 0, sizeof(ddc->image));
+    (void)memcpy_s(block, HDMI_EDID_BLOCK_HEADER_FIELD_LEN, header, HDMI_EDID_BLOCK_HEADER_FIELD_LEN);
+    block[HDMI_EDID_BLOCK_HEADER_FIELD_LEN] = 0x4C;
+    block[HDMI_EDID_BLOCK_HEADER_FIELD_LEN + 1] = 0x2D;
+    block[HDMI_TEST_EDID_SERIAL_ADDR] = serial;
+    block[HDMI_TEST_EDID_VERSION_ADDR] = HDMI_EDID_VERSION_NUM;
+    block[HDMI_TEST_EDID_VERSION_ADDR + 1] = HDMI_EDID_REVISION_NUM;
+    block[HDMI_EDID_EXTENSION_BLOCK_ADDR] = extNum;
+    HdmiTestEdidCheckSum(block);
+    for (i = 1; i <= extNum; i++) {
+        block = ddc->image + i * HDMI_EDID_SINGLE_BLOCK_SIZE;
+        block[UINT8_ARRAY_TElEMENT_0] = HDMI_EDID_CTA_EXTENSION_TAG;
+        block[UINT8_ARRAY_TElEMENT_1] = HDMI_EDID_CTA_EXTENSION3_REVISION;
+        block[UINT8_ARRAY_TElEMENT_2] = HDMI_EDID_EXTENSION_D_INVALID_MIN_VAL;
+        block[UINT8_ARRAY_TElEMENT_3] = HDMI_TEST_EDID_EXT_FLAGS;
+        HdmiTestEdidCheckSum(block);
+    }
+}
+
+/* reads the EDID as the hot plug handler does, returns the time to ready in us */
+static int32_t HdmiTestEdidRead(struct HdmiTestDdc *ddc, struct HdmiEdid *edid, struct HdmiEdidCache *cache,
+    uint32_t *transfers, uint64_t *costUs)
+{
+    int32_t ret;
+    uint64_t start = HdmiTestNowUs();
+
+    ddc->transfers = 0;
+    (void)HdmiEdidReset(edid);
+    ret = HdmiEdidCacheRead(edid, &(ddc->cntlr.ddc), cache);
+    *costUs = HdmiTestNowUs() - start;
+    *transfers = ddc->transfers;
+    if (ret != HDF_SUCCESS) {
+        HDF_LOGE("%s: read edid fail, ret = %d", __func__, ret);
+    }
+    return ret;
+}
+
+static int32_t TestHdmiEdidCacheCheck(struct HdmiTestDdc *ddc, struct HdmiEdid *edid, struct HdmiEdid *ref,
+    struct HdmiEdidCache *cache)
+{
+    uint32_t i, transfers;
+    uint64_t costUs;
+    uint64_t coldUs = 0;
+    uint64_t hotUs = 0;
+
+    /* the first plug reads block 0, block 1 and blocks 2~3, a replug only reads block 0 */
+    HdmiTestEdidPlug(ddc, HDMI_EDID_MAX_BLOCK_NUM - 1, 1);
+    if (HdmiTestEdidRead(ddc, ref, NULL, &transfers, &coldUs) != HDF_SUCCESS ||
+        HdmiTestEdidRead(ddc, edid, cache, &transfers, &costUs) != HDF_SUCCESS || transfers != 3) {
+        HDF_LOGE("%s: first plug fail, %u transfers", __func__, transfers);
+        return HDF_FAILURE;
+    }
+    for (i = 0; i < HDMI_TEST_EDID_REPLUG_TIMES; i++) {
+        if (HdmiTestEdidRead(ddc, edid, cache, &transfers, &costUs) != HDF_SUCCESS || transfers != 1) {
+            HDF_LOGE("%s: replug %u fail, %u transfers", __func__, i, transfers);
+            return HDF_FAILURE;
+        }
+        hotUs += costUs;
+    }
+    if (memcmp(&(edid->sinkCap), &(ref->sinkCap), sizeof(ref->sinkCap)) != 0 || edid->rawLen != ref->rawLen ||
+        edid->sinkCap.extBlockNum != HDMI_EDID_MAX_BLOCK_NUM - 1 || edid->sinkCap.supportAudio != true) {
+        HDF_LOGE("%s: cached capability differs from the parsed one", __func__);
+        return HDF_FAILURE;
+    }
+    HDF_LOGI("%s: time to ready %llu us without cache, %llu us on a replug", __func__,
+        (unsigned long long)coldUs, (unsigned long long)(hotUs / HDMI_TEST_EDID_REPLUG_TIMES));
+
+    /* another sink, then the first one again, both stay cached */
+    HdmiTestEdidPlug(ddc, 1, 2);
+    if (HdmiTestEdidRead(ddc, edid, cache, &transfers, &costUs) != HDF_SUCCESS || transfers != 2) {
+        HDF_LOGE("%s: second sink fail, %u transfers", __func__, transfers);
+        return HDF_FAILURE;
+    }
+    HdmiTestEdidPlug(ddc, HDMI_EDID_MAX_BLOCK_NUM - 1, 1);
+    if (HdmiTestEdidRead(ddc, edid, cache, &transfers, &costUs) != HDF_SUCCESS || transfers != 1) {
+        HDF_LOGE("%s: first sink replug fail, %u transfers", __func__, transfers);
+        return HDF_FAILURE;
+    }
+    /* the same model with another serial number is another sink */
+    HdmiTestEdidPlug(ddc, HDMI_EDID_MAX_BLOCK_NUM - 1, 3);
+    if (HdmiTestEdidRead(ddc, edid, cache, &transfers, &costUs) != HDF_SUCCESS || transfers != 3) {
+        HDF_LOGE("%s: third sink fail, %u transfers", __func__, transfers);
+        return HDF_FAILURE;
+    }
+    if (cache->hits != HDMI_TEST_EDID_REPLUG_TIMES + 1 || cache->misses != 3) {
+        HDF_LOGE("%s: %u hits, %u misses", __func__, cache->hits, cache->misses);
+        return HDF_FAILURE;
+    }
+    return HDF_SUCCESS;
+}
+
+static int32_t TestHdmiEdidCache(struct HdmiTester *tester)
+{
+    int32_t ret = HDF_ERR_MALLOC_FAIL;
+    struct HdmiTestDdc *ddc = &g_hdmiTestDdc;
+    struct HdmiEdid *edid = NULL;
+    struct HdmiEdid *ref = NULL;
+    struct HdmiEdidCache *cache = NULL;
+
+    (void)tester;
+    (void)memset_s(ddc, sizeof(*ddc), 0, sizeof(*ddc));
+    ddc->ops.ddcTransfer = HdmiTestDdcTransfer;
+    ddc->cntlr.ops = &ddc->ops;
+    ddc->cntlr.priv = ddc;
+    ddc->cntlr.ddc.priv = &ddc->cntlr;
+    (void)OsalMutexInit(&ddc->cntlr.mutex);
+    (void)OsalMutexInit(&ddc->cntlr.ddc.ddcMutex);
+    edid = (struct HdmiEdid *)OsalMemCalloc(sizeof(*edid));
+    ref = (struct HdmiEdid *)OsalMemCalloc(sizeof(*ref));
+    cache = (struct HdmiEdidCache *)OsalMemCalloc(sizeof(*cache));
+    if (edid != NULL && ref != NULL && cache != NULL) {
+        ret = TestHdmiEdidCacheCheck(ddc, edid, ref, cache);
+    }
+    OsalMemFree(cache);
+    OsalMemFree(ref);
+    OsalMemFree(edid);
+    (void)OsalMutexDestroy(&ddc->cntlr.ddc.ddcMutex);
+    (void)OsalMutexDestroy(&ddc->cntlr.mutex);
+    return ret;
+}
+
 struct HdmiTestFunc g_hdmiTestFunc[] = {
     { HDMI_START_AND_STOP_01, TestHdmiStartAndStop },
     { HDMI_SET_AUDIO_ATTR_01, TestHdmiSetAudioAttr },
@@ -206,6 +736,16 @@ static int32_t HdmiTestEntry(struct HdmiTester *tester, int32_t cmd)
         HDF_LOGE("%s: tester is NULL", __func__);
         return HDF_ERR_INVALID_OBJECT;
     }
+    // The cec transmit queue and edid cache cases run on a simulated controller, not the configured device.
+    if (cmd == HDMI_CEC_TX_QUEUE_01) {
+        return TestHdmiCecTxQueue(tester);
+    }
+    if (cmd == HDMI_CEC_TX_QUEUE_BENCH_01) {
+        return TestHdmiCecTxQueueBench(tester);
+    }
+    if (cmd == HDMI_EDID_CACHE_01) {
+        return TestHdmiEdidCache(tester);
+    }
     tester->handle = HdmiTestGetHandle(tester);
     if (tester->handle == NULL) {
         HDF_LOGE("%s: hdmi test get handle failed", __func__);
@@ -21,6 +21,9 @@ enum HdmiTestCmd {
     HDMI_EDID_RAW_DATA_GET_01 = 5,
     HDMI_DEEP_COLOR_SET_AND_GET_01 = 6,
     HDMI_HPD_REGISTER_AND_UNREGISTER_01 = 7,
+    HDMI_CEC_TX_QUEUE_01 = 8,
+    HDMI_CEC_TX_QUEUE_BENCH_01 = 9,
+    HDMI_EDID_CACHE_01 = 10,
 };
 
 struct HdmiTester {
@@ -75,6 +75,12 @@ static int32_t I2cTestReadConfig(struct I2cTestConfig *config, const struct Devi
         return ret;
     }
 
+    /* optional, the transfer benchmark is skipped without a virtual controller */
+    if (drsOps->GetUint16(node, "virtual_bus_num", &config->virtualBusNum, 0) != HDF_SUCCESS ||
+        drsOps->GetUint16(node, "virtual_dev_addr", &config->virtualDevAddr, 0) != HDF_SUCCESS) {
+        config->virtualDevAddr = 0;
+    }
+
     return HDF_SUCCESS;
 }
 
@@ -25,6 +25,10 @@
 #define I2C_TEST_MLTTHD_TIMES  1000
 #define I2C_TEST_STACK_SIZE    (1024 * 100)
 #define I2C_TEST_WAIT_TIMES    200
+#define I2C_TEST_BENCH_TIMES   2000
+#define I2C_TEST_BENCH_REG     0x10
+#define I2C_TEST_BENCH_LEN     16
+#define I2C_TEST_TIME_US       1000000
 
 static struct I2cMsg g_msgs[I2C_TEST_MSG_NUM];
 static uint8_t *g_buf;
@@ -316,6 +320,146 @@ int32_t I2cTestReliability(void)
     return HDF_SUCCESS;
 }
 
+struct I2cTestBench {
+    DevHandle handle;
+    uint8_t reg;
+    uint8_t data[I2C_TEST_BENCH_LEN];
+    struct I2cMsg msgs[I2C_TEST_MSG_NUM];
+};
+
+static uint32_t I2cTestBenchRate(const OsalTimespec *start, const OsalTimespec *end)
+{
+    OsalTimespec diff = {0};
+    uint64_t us;
+
+    (void)OsalDiffTime(start, end, &diff);
+    us = diff.sec * I2C_TEST_TIME_US + diff.usec;
+    if (us == 0) {
+        return 0;
+    }
+    /* calls per second */
+    return (uint32_t)((uint64_t)I2C_TEST_BENCH_TIMES * I2C_TEST_TIME_US / us);
+}
+
+static int32_t I2cTestBenchSetUp(struct I2cTestBench *bench, const struct I2cTestConfig *config)
+{
+    uint8_t i;
+    uint8_t fill[I2C_TEST_BENCH_LEN + 1];
+    struct I2cMsg msg;
+
+    /* store a known pattern in the simulated device */
+    fill[0] = I2C_TEST_BENCH_REG;
+    for (i = 0; i < I2C_TEST_BENCH_LEN; i++) {
+        fill[i + 1] = i + 1;
+    }
+    msg.addr = config->virtualDevAddr;
+    msg.flags = 0;
+    msg.len = sizeof(fill);
+    msg.buf = fill;
+    if (I2cTransfer(bench->handle, &msg, 1) != 1) {
+        return HDF_FAILURE;
+    }
+
+    bench->reg = I2C_TEST_BENCH_REG;
+    bench->msgs[0].addr = config->virtualDevAddr;
+    bench->msgs[0].flags = 0;
+    bench->msgs[0].len = sizeof(bench->reg);
+    bench->msgs[0].buf = &bench->reg;
+    bench->msgs[1].addr = config->virtualDevAddr;
+    bench->msgs[1].flags = I2C_FLAG_READ;
+    bench->msgs[1].len = sizeof(bench->data);
+    bench->msgs[1].buf = bench->data;
+    return HDF_SUCCESS;
+}
+
+static bool I2cTestBenchCheckData(const struct I2cTestBench *bench)
+{
+    uint8_t i;
+
+    for (i = 0; i < I2C_TEST_BENCH_LEN; i++) {
+        if (bench->data[i] != i + 1) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static int32_t I2cTestBenchRun(struct I2cTestBench *bench)
+{
+    int32_t i;
+    DevHandle xfer = NULL;
+    OsalTimespec time[4] = {0};       /* before and after each path */
+    struct I2cIoStats stats[4] = {0};
+
+    (void)I2cGetIoStats(&stats[0]);
+    (void)OsalGetTime(&time[0]);
+    for (i = 0; i < I2C_TEST_BENCH_TIMES; i++) {
+        if (I2cTransfer(bench->handle, bench->msgs, I2C_TEST_MSG_NUM) != I2C_TEST_MSG_NUM) {
+            HDF_LOGE("I2cTestBenchRun: I2cTransfer err at %d", i);
+            return HDF_FAILURE;
+        }
+    }
+    (void)OsalGetTime(&time[1]);
+    (void)I2cGetIoStats(&stats[1]);
+
+    xfer = I2cTransferRegister(bench->handle, bench->msgs, I2C_TEST_MSG_NUM);
+    if (xfer == NULL) {
+        HDF_LOGE("I2cTestBenchRun: register transfer fail!");
+        return HDF_FAILURE;
+    }
+    (void)memset_s(bench->data, sizeof(bench->data), 0, sizeof(bench->data));
+    (void)I2cGetIoStats(&stats[2]);
+    (void)OsalGetTime(&time[2]);
+    for (i = 0; i < I2C_TEST_BENCH_TIMES; i++) {
+        if (I2cTransferByHandle(xfer) != I2C_TEST_MSG_NUM) {
+            HDF_LOGE("I2cTestBenchRun: I2cTransferByHandle err at %d", i);
+            I2cTransferUnregister(xfer);
+            return HDF_FAILURE;
+        }
+    }
+    (void)OsalGetTime(&time[3]);
+    (void)I2cGetIoStats(&stats[3]);
+    I2cTransferUnregister(xfer);
+
+    HDF_LOGI("I2cTestBenchRun: I2cTransfer %u calls/s, %u service allocs; I2cTransferByHandle %u calls/s, "
+        "%u service allocs, in %d calls", I2cTestBenchRate(&time[0], &time[1]), stats[1].allocs - stats[0].allocs,
+        I2cTestBenchRate(&time[2], &time[3]), stats[3].allocs - stats[2].allocs, I2C_TEST_BENCH_TIMES);
+    if (!I2cTestBenchCheckData(bench) || stats[3].allocs != stats[2].allocs) {
+        HDF_LOGE("I2cTestBenchRun: transfer by handle read wrong data or allocated!");
+        return HDF_FAILURE;
+    }
+    return HDF_SUCCESS;
+}
+
+int32_t I2cTestXferBench(void)
+{
+    int32_t ret;
+    struct I2cTester *tester = NULL;
+    struct I2cTestBench bench;
+
+    tester = I2cTesterGet();
+    if (tester == NULL) {
+        return HDF_ERR_INVALID_OBJECT;
+    }
+    if (tester->config.virtualDevAddr == 0) {
+        HDF_LOGI("I2cTestXferBench: no virtual controller configured, skip");
+        return HDF_SUCCESS;
+    }
+
+    (void)memset_s(&bench, sizeof(bench), 0, sizeof(bench));
+    bench.handle = I2cOpen(tester->config.virtualBusNum);
+    if (bench.handle == NULL) {
+        HDF_LOGE("I2cTestXferBench: open virtual i2cBus:%u fail!", tester->config.virtualBusNum);
+        return HDF_FAILURE;
+    }
+    ret = I2cTestBenchSetUp(&bench, &tester->config);
+    if (ret == HDF_SUCCESS) {
+        ret = I2cTestBenchRun(&bench);
+    }
+    I2cClose(bench.handle);
+    return ret;
+}
+
 struct I2cTestEntry {
     int cmd;
     int32_t (*func)(void);
@@ -327,6 +471,7 @@ static struct I2cTestEntry g_entry[] = {
     { I2C_TEST_CMD_WRITE_READ, I2cTestWriteRead, "I2cTestWriteRead" },
     { I2C_TEST_CMD_MULTI_THREAD, I2cTestMultiThread, "I2cTestMultiThread" },
     { I2C_TEST_CMD_RELIABILITY, I2cTestReliability, "I2cTestReliability" },
+    { I2C_TEST_CMD_XFER_BENCH, I2cTestXferBench, "I2cTestXferBench" },
     { I2C_TEST_CMD_SETUP_ALL, I2cTestSetUpAll, "I2cTestSetUpAll" },
     { I2C_TEST_CMD_TEARDOWN_ALL, I2cTestTearDownAll, "I2cTestTearDownAll" },
     { I2C_TEST_CMD_SETUP_SINGLE, I2cTestSetUpSingle, "I2cTestSetUpSingle" },
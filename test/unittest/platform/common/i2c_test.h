@@ -23,6 +23,7 @@ enum I2cTestCmd {
     I2C_TEST_CMD_WRITE_READ = 1,
     I2C_TEST_CMD_MULTI_THREAD = 2,
     I2C_TEST_CMD_RELIABILITY = 3,
+    I2C_TEST_CMD_XFER_BENCH = 4,
     I2C_TEST_CMD_SETUP_ALL = 5,
     I2C_TEST_CMD_TEARDOWN_ALL = 6,
     I2C_TEST_CMD_SETUP_SINGLE = 7,
@@ -36,6 +37,8 @@ struct I2cTestConfig {
     uint16_t regAddr;
     uint16_t regLen;
     uint16_t bufSize;
+    uint16_t virtualBusNum;  // simulated controller for the benchmark, none if virtualDevAddr is 0
+    uint16_t virtualDevAddr;
 };
 
 struct I2cTester {
@@ -9,6 +9,7 @@
 #include "i3c_test.h"
 #include "i3c_if.h"
 #include "i3c_ccc.h"
+#include "i3c_core.h"
 #include "hdf_base.h"
 #include "hdf_io_service_if.h"
 #include "hdf_log.h"
@@ -26,6 +27,13 @@
 #define I3C_TEST_STACK_SIZE        (1024 * 256)
 #define I3C_TEST_IBI_PAYLOAD       16
 #define I3C_TEST_REG_LEN           2
+#define I3C_TEST_SIM_BUS           (I3C_CNTLR_MAX - 1)
+#define I3C_TEST_SIM_DEV_MAX       (I3C_ADDR_MAX + 1)
+#define I3C_TEST_SIM_FREE_NUM      113    /* 128 addresses, 15 of them reserved */
+#define I3C_TEST_SIM_REUSE_INDEX   40
+#define I3C_TEST_IBI_LOOP_NUM      100000
+#define I3C_TEST_USEC_PER_SEC      1000000
+#define I3C_TEST_NSEC_PER_USEC     1000
 
 static struct I3cMsg g_msgs[I3C_TEST_MSG_NUM];
 static uint8_t *g_buf;
@@ -478,6 +486,314 @@ int32_t I3cTestReliability(void *param)
     return HDF_SUCCESS;
 }
 
+/* a controller without hardware, with as many targets as the address space holds */
+struct I3cTestSim {
+    struct I3cCntlr cntlr;
+    struct I3cDevice *devices;
+    uint16_t devNum;
+    uint32_t ibiCount;
+    uint32_t ibiErrors;
+    volatile bool removed;
+};
+
+static struct I3cTestSim g_sim;
+
+static int32_t I3cTestSimRequestIbi(struct I3cDevice *dev)
+{
+    (void)dev;
+    return HDF_SUCCESS;
+}
+
+static void I3cTestSimFreeIbi(struct I3cDevice *dev)
+{
+    (void)dev;
+}
+
+static const struct I3cMethod g_simMethod = {
+    .requestIbi = I3cTestSimRequestIbi,
+    .freeIbi = I3cTestSimFreeIbi,
+};
+
+static int32_t I3cTestSimAddDevice(struct I3cTestSim *sim)
+{
+    int32_t ret;
+    struct I3cDevice *device = &sim->devices[sim->devNum];
+
+    device->cntlr = &sim->cntlr;
+    device->type = I3C_CNTLR_I3C_DEVICE;
+    device->pid = sim->devNum + 1;
+    device->addr = 0;    // no static address, a dynamic one is assigned
+    device->dynaAddr = 0;
+    device->supportIbi = I3C_DEVICE_SUPPORT_IBI;
+    ret = I3cDeviceAdd(device);
+    if (ret == HDF_SUCCESS) {
+        sim->devNum++;
+    }
+    return ret;
+}
+
+static void I3cTestSimDestroy(struct I3cTestSim *sim)
+{
+    uint16_t i;
+
+    if (sim->devices != NULL) {
+        for (i = 0; i < sim->devNum; i++) {
+            if (sim->devices[i].list.next == NULL) {
+                continue;    // removed by a failed test already
+            }
+            (void)I3cCntlrFreeIbi(&sim->cntlr, sim->devices[i].dynaAddr);
+            I3cDeviceRemove(&sim->devices[i]);
+        }
+        OsalMemFree(sim->devices);
+        sim->devices = NULL;
+    }
+    I3cCntlrRemove(&sim->cntlr);
+}
+
+/* fill the whole address space of a simulated controller */
+static int32_t I3cTestSimCreate(struct I3cTestSim *sim)
+{
+    int32_t ret;
+
+    (void)memset_s(sim, sizeof(*sim), 0, sizeof(*sim));
+    sim->cntlr.busId = I3C_TEST_SIM_BUS;
+    sim->cntlr.ops = &g_simMethod;
+    ret = I3cCntlrAdd(&sim->cntlr);
+    if (ret != HDF_SUCCESS) {
+        HDF_LOGE("%s: add cntlr failed, ret: %d", __func__, ret);
+        return ret;
+    }
+    sim->devices = (struct I3cDevice *)OsalMemCalloc(sizeof(*sim->devices) * I3C_TEST_SIM_DEV_MAX);
+    if (sim->devices == NULL) {
+        I3cTestSimDestroy(sim);
+        return HDF_ERR_MALLOC_FAIL;
+    }
+
+    while (sim->devNum < I3C_TEST_SIM_DEV_MAX && I3cTestSimAddDevice(sim) == HDF_SUCCESS) {
+    }
+    if (sim->devNum != I3C_TEST_SIM_FREE_NUM) {
+        HDF_LOGE("%s: %u devices added, expect %u", __func__, sim->devNum, I3C_TEST_SIM_FREE_NUM);
+        I3cTestSimDestroy(sim);
+        return HDF_FAILURE;
+    }
+    return HDF_SUCCESS;
+}
+
+static int32_t I3cTestSimCheckAddrs(struct I3cTestSim *sim)
+{
+    uint16_t i;
+    uint16_t addr;
+    struct I3cDevice *device = NULL;
+
+    for (i = 0; i < sim->devNum; i++) {
+        addr = sim->devices[i].dynaAddr;
+        // handed out lowest first, never a reserved one
+        if ((i > 0 && addr <= sim->devices[i - 1].dynaAddr) || CHECK_RESERVED_ADDR(addr) == I3C_ADDR_RESERVED) {
+            HDF_LOGE("%s: device %u got addr 0x%x", __func__, i, addr);
+            return HDF_FAILURE;
+        }
+        device = GetDeviceByAddr(&sim->cntlr, addr);
+        I3cDevicePut(device);
+        if (device != &sim->devices[i]) {
+            HDF_LOGE("%s: addr 0x%x maps to the wrong device", __func__, addr);
+            return HDF_FAILURE;
+        }
+    }
+    return HDF_SUCCESS;
+}
+
+static int32_t I3cTestSimReuseAddr(struct I3cTestSim *sim)
+{
+    struct I3cDevice i2cDevice = {0};
+    struct I3cDevice *device = &sim->devices[I3C_TEST_SIM_REUSE_INDEX];
+    struct I3cDevice *found = NULL;
+    uint16_t addr = device->dynaAddr;
+
+    // a static address already taken is refused for an i2c device
+    i2cDevice.cntlr = &sim->cntlr;
+    i2cDevice.type = I3C_CNTLR_I2C_DEVICE;
+    i2cDevice.addr = addr;
+    i2cDevice.pid = I3C_TEST_SIM_DEV_MAX + 1;
+    if (I3cDeviceAdd(&i2cDevice) == HDF_SUCCESS) {
+        HDF_LOGE("%s: busy addr 0x%x given to an i2c device", __func__, addr);
+        I3cDeviceRemove(&i2cDevice);
+        return HDF_FAILURE;
+    }
+
+    // the address of a removed device is the next one handed out
+    I3cDeviceRemove(device);
+    found = GetDeviceByAddr(&sim->cntlr, addr);
+    if (found != NULL) {
+        I3cDevicePut(found);
+        HDF_LOGE("%s: addr 0x%x still mapped after remove", __func__, addr);
+        return HDF_FAILURE;
+    }
+    device->dynaAddr = 0;
+    if (I3cDeviceAdd(device) != HDF_SUCCESS) {
+        HDF_LOGE("%s: device not added back", __func__);
+        return HDF_FAILURE;
+    }
+    found = GetDeviceByAddr(&sim->cntlr, addr);
+    I3cDevicePut(found);
+    if (device->dynaAddr != addr || found != device) {
+        HDF_LOGE("%s: addr 0x%x not reused, got 0x%x", __func__, addr, device->dynaAddr);
+        return HDF_FAILURE;
+    }
+    return HDF_SUCCESS;
+}
+
+static int I3cTestSimRemoveThread(void *data)
+{
+    I3cDeviceRemove((struct I3cDevice *)data);
+    g_sim.removed = true;
+    return HDF_SUCCESS;
+}
+
+/* a device found by address is not removed, so not freed, under its finder */
+static int32_t I3cTestSimRemoveHeld(struct I3cTestSim *sim)
+{
+    bool held;
+    uint32_t time = 0;
+    struct OsalThread thread;
+    struct OsalThreadParam cfg = {0};
+    struct I3cDevice *device = &sim->devices[I3C_TEST_SIM_REUSE_INDEX];
+    struct I3cDevice *found = GetDeviceByAddr(&sim->cntlr, device->dynaAddr);
+
+    if (found != device) {
+        I3cDevicePut(found);
+        HDF_LOGE("%s: addr 0x%x maps to the wrong device", __func__, device->dynaAddr);
+        return HDF_FAILURE;
+    }
+    sim->removed = false;
+    cfg.name = "I3cTestRemove";
+    cfg.priority = OSAL_THREAD_PRI_DEFAULT;
+    cfg.stackSize = I3C_TEST_STACK_SIZE;
+    if (OsalThreadCreate(&thread, I3cTestSimRemoveThread, device) != HDF_SUCCESS ||
+        OsalThreadStart(&thread, &cfg) != HDF_SUCCESS) {
+        I3cDevicePut(found);
+        HDF_LOGE("%s: start remove thread failed", __func__);
+        return HDF_FAILURE;
+    }
+
+    OsalMSleep(I3C_TEST_WAIT_TIMES);
+    held = !sim->removed;
+    I3cDevicePut(found);
+    while (!sim->removed && time++ < I3C_TEST_WAIT_TIMEOUT) {
+        OsalMSleep(I3C_TEST_WAIT_TIMES);
+    }
+    (void)OsalThreadDestroy(&thread);
+    if (!held || !sim->removed) {
+        HDF_LOGE("%s: removal %s", __func__, held ? "never finished" : "did not wait for the finder");
+        return HDF_FAILURE;
+    }
+    return HDF_SUCCESS;
+}
+
+int32_t I3cTestAddrAlloc(void *param)
+{
+    int32_t ret;
+
+    (void)param;
+    ret = I3cTestSimCreate(&g_sim);
+    if (ret != HDF_SUCCESS) {
+        return ret;
+    }
+
+    // the address space is full now
+    if (I3cTestSimAddDevice(&g_sim) == HDF_SUCCESS) {
+        HDF_LOGE("%s: device added to a full bus", __func__);
+        ret = HDF_FAILURE;
+    }
+    if (ret == HDF_SUCCESS) {
+        ret = I3cTestSimCheckAddrs(&g_sim);
+    }
+    if (ret == HDF_SUCCESS) {
+        ret = I3cTestSimReuseAddr(&g_sim);
+    }
+    if (ret == HDF_SUCCESS) {
+        ret = I3cTestSimRemoveHeld(&g_sim);
+    }
+    I3cTestSimDestroy(&g_sim);
+    HDF_LOGD("%s: done, ret: %d", __func__, ret);
+
+    return ret;
+}
+
+static int32_t I3cTestSimIbiFunc(DevHandle handle, uint16_t addr, struct I3cIbiData data)
+{
+    struct I3cDevice *device = GetDeviceByAddr((struct I3cCntlr *)handle, addr);
+
+    if (device == NULL || device->ibi == NULL || data.payload != I3C_TEST_IBI_PAYLOAD) {
+        g_sim.ibiErrors++;
+    }
+    I3cDevicePut(device);
+    g_sim.ibiCount++;
+    return HDF_SUCCESS;
+}
+
+static int32_t I3cTestIbiDispatch(struct I3cTestSim *sim, const uint16_t *addrs, uint16_t addrNum)
+{
+    uint32_t i;
+    int32_t ret;
+    uint64_t us;
+    struct I3cDevice *device = NULL;
+    OsalTimespec start;
+    OsalTimespec end;
+    OsalTimespec diff;
+
+    (void)OsalGetTime(&start);
+    for (i = 0; i < I3C_TEST_IBI_LOOP_NUM; i++) {
+        // what a controller driver does when an IBI comes in
+        device = GetDeviceByAddr(&sim->cntlr, addrs[i % addrNum]);
+        ret = I3cCntlrIbiCallback(device);
+        I3cDevicePut(device);
+        if (ret != HDF_SUCCESS) {
+            HDF_LOGE("%s: dispatch to 0x%x failed, ret: %d", __func__, addrs[i % addrNum], ret);
+            return ret;
+        }
+    }
+    (void)OsalGetTime(&end);
+    (void)OsalDiffTime(&start, &end, &diff);
+    us = (uint64_t)diff.sec * I3C_TEST_USEC_PER_SEC + diff.usec;
+
+    HDF_LOGI("%s: %u targets, %u IBIs in %llu us, %llu ns per IBI", __func__, sim->devNum, I3C_TEST_IBI_LOOP_NUM,
+        (unsigned long long)us, (unsigned long long)(us * I3C_TEST_NSEC_PER_USEC / I3C_TEST_IBI_LOOP_NUM));
+    if (sim->ibiCount != I3C_TEST_IBI_LOOP_NUM || sim->ibiErrors != 0) {
+        HDF_LOGE("%s: %u IBIs handled, %u misrouted", __func__, sim->ibiCount, sim->ibiErrors);
+        return HDF_FAILURE;
+    }
+    return HDF_SUCCESS;
+}
+
+int32_t I3cTestIbiBench(void *param)
+{
+    int32_t ret;
+    uint16_t i;
+    uint16_t addrs[I3C_IBI_MAX];
+
+    (void)param;
+    ret = I3cTestSimCreate(&g_sim);
+    if (ret != HDF_SUCCESS) {
+        return ret;
+    }
+
+    // the targets added last, the worst case for a walk of the device list
+    for (i = 0; i < I3C_IBI_MAX; i++) {
+        addrs[i] = g_sim.devices[g_sim.devNum - 1 - i].dynaAddr;
+        ret = I3cCntlrRequestIbi(&g_sim.cntlr, addrs[i], I3cTestSimIbiFunc, I3C_TEST_IBI_PAYLOAD);
+        if (ret != HDF_SUCCESS) {
+            HDF_LOGE("%s: request IBI of 0x%x failed, ret: %d", __func__, addrs[i], ret);
+            break;
+        }
+    }
+    if (ret == HDF_SUCCESS) {
+        ret = I3cTestIbiDispatch(&g_sim, addrs, I3C_IBI_MAX);
+    }
+    I3cTestSimDestroy(&g_sim);
+
+    return ret;
+}
+
 static struct I3cTestEntry g_entry[] = {
     { I3C_TEST_CMD_TRANSFER, I3cTestTransfer, "I3cTestTransfer" },
     { I3C_TEST_CMD_SET_CONFIG, I3cTestSetConfig, "I3cTestSetConfig" },
@@ -488,6 +804,8 @@ static struct I3cTestEntry g_entry[] = {
     { I3C_TEST_CMD_RELIABILITY, I3cTestReliability, "I3cTestReliability" },
     { I3C_TEST_CMD_SETUP_ALL, I3cTestSetUpAll, "I3cTestSetUpAll" },
     { I3C_TEST_CMD_TEARDOWN_ALL, I3cTestTearDownAll, "I3cTestTearDownAll" },
+    { I3C_TEST_CMD_ADDR_ALLOC, I3cTestAddrAlloc, "I3cTestAddrAlloc" },
+    { I3C_TEST_CMD_IBI_BENCH, I3cTestIbiBench, "I3cTestIbiBench" },
 };
 
 int32_t I3cTestExecute(int cmd)
@@ -44,6 +44,8 @@ enum I3cTestCmd {
     I3C_TEST_CMD_TEARDOWN_ALL,
     I3C_TEST_CMD_SETUP_SINGLE,
     I3C_TEST_CMD_TEARDOWN_SINGLE,
+    I3C_TEST_CMD_ADDR_ALLOC,
+    I3C_TEST_CMD_IBI_BENCH,
     I3C_TEST_CMD_MAX,
 };
 
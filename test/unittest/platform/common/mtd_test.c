@@ -0,0 +1,209 @@
+/*
+ * Copyright (c) 2021 Huawei Device Co., Ltd.
+ *
+ * HDF is dual licensed: you can use it either under the terms of
+ * the GPL, or the BSD license, at your option.
+ * See the LICENSE file in the root of this repository for complete details.
+ */
+
+#include "mtd_test.h"
+#include "device_resource_if.h"
+#include "hdf_base.h"
+#include "hdf_log.h"
+#include "mtd_core.h"
+#include "osal_mem.h"
+#include "securec.h"
+
+#define HDF_LOG_TAG mtd_test_c
+
+#define MTD_TEST_RW_BLOCKS        2
+#define MTD_TEST_UNALIGNED_OFFSET 100
+#define MTD_TEST_UNALIGNED_LEN    1000
+
+struct MtdTestFunc {
+    enum MtdTestCmd type;
+    int32_t (*Func)(struct MtdDevice *mtd);
+};
+
+static int32_t MtdTestBadBlockTable(struct MtdDevice *mtd)
+{
+    struct MtdVirtualNandStats *stats = (struct MtdVirtualNandStats *)mtd->priv;
+    uint32_t checks = stats->badBlockChecks;
+    off_t badBlock = (off_t)(MTD_VIRTUAL_NAND_BAD_BLOCK * mtd->eraseSize);
+    off_t lastBlock = (off_t)(mtd->capacity - mtd->eraseSize);
+
+    if (!MtdDeviceIsBadBlock(mtd, badBlock + mtd->writeSize)) {
+        HDF_LOGE("%s: factory bad block not found", __func__);
+        return HDF_FAILURE;
+    }
+    if (MtdDeviceIsBadBlock(mtd, 0)) {
+        HDF_LOGE("%s: good block reported bad", __func__);
+        return HDF_FAILURE;
+    }
+    if (MtdDeviceMarkBadBlock(mtd, lastBlock) != HDF_SUCCESS || !MtdDeviceIsBadBlock(mtd, lastBlock)) {
+        HDF_LOGE("%s: mark bad block failed", __func__);
+        return HDF_FAILURE;
+    }
+    if (stats->badBlockChecks != checks) {
+        HDF_LOGE("%s: %u bad block marker reads after add", __func__, stats->badBlockChecks - checks);
+        return HDF_FAILURE;
+    }
+    return HDF_SUCCESS;
+}
+
+static int32_t MtdTestCheckRw(struct MtdDevice *mtd, const uint8_t *wbuf, uint8_t *rbuf, size_t len)
+{
+    struct MtdVirtualNandStats *stats = (struct MtdVirtualNandStats *)mtd->priv;
+    struct MtdVirtualNandStats before = *stats;
+    off_t start = (off_t)((MTD_VIRTUAL_NAND_BAD_BLOCK - 1) * mtd->eraseSize);
+
+    /* spans the factory bad block, which is skipped */
+    if (MtdDeviceWrite(mtd, start, len, wbuf) != (ssize_t)len || MtdDeviceRead(mtd, start, len, rbuf) != (ssize_t)len) {
+        HDF_LOGE("%s: write/read failed", __func__);
+        return HDF_FAILURE;
+    }
+    if (memcmp(wbuf, rbuf, len) != 0) {
+        HDF_LOGE("%s: data mismatch", __func__);
+        return HDF_FAILURE;
+    }
+    HDF_LOGI("%s: multi page transfers %u, page transfers %u, bad block marker reads %u", __func__,
+        stats->multiPageTransfers - before.multiPageTransfers, stats->pageTransfers - before.pageTransfers,
+        stats->badBlockChecks - before.badBlockChecks);
+    if (stats->multiPageTransfers - before.multiPageTransfers != MTD_TEST_RW_BLOCKS * 2 ||
+        stats->pageTransfers != before.pageTransfers || stats->badBlockChecks != before.badBlockChecks) {
+        HDF_LOGE("%s: aligned access not done by block", __func__);
+        return HDF_FAILURE;
+    }
+
+    /* an unaligned read falls back to page transfers */
+    start = (off_t)((MTD_VIRTUAL_NAND_BAD_BLOCK + 1) * mtd->eraseSize + MTD_TEST_UNALIGNED_OFFSET);
+    if (MtdDeviceRead(mtd, start, MTD_TEST_UNALIGNED_LEN, rbuf) != MTD_TEST_UNALIGNED_LEN ||
+        memcmp(wbuf + mtd->eraseSize + MTD_TEST_UNALIGNED_OFFSET, rbuf, MTD_TEST_UNALIGNED_LEN) != 0) {
+        HDF_LOGE("%s: unaligned read failed", __func__);
+        return HDF_FAILURE;
+    }
+    return HDF_SUCCESS;
+}
+
+static int32_t MtdTestMultiPageRw(struct MtdDevice *mtd)
+{
+    int32_t ret;
+    size_t i;
+    size_t len = MTD_TEST_RW_BLOCKS * mtd->eraseSize;
+    off_t faddr = 0;
+    uint8_t *wbuf = NULL;
+    uint8_t *rbuf = NULL;
+
+    if (MtdDeviceErase(mtd, (off_t)((MTD_VIRTUAL_NAND_BAD_BLOCK - 1) * mtd->eraseSize), mtd->eraseSize,
+        &faddr) != HDF_SUCCESS ||
+        MtdDeviceErase(mtd, (off_t)((MTD_VIRTUAL_NAND_BAD_BLOCK + 1) * mtd->eraseSize), mtd->eraseSize,
+        &faddr) != HDF_SUCCESS) {
+        HDF_LOGE("%s: erase failed @0x%jx", __func__, faddr);
+        return HDF_FAILURE;
+    }
+
+    wbuf = (uint8_t *)OsalMemAlloc(len);
+    rbuf = (uint8_t *)OsalMemAlloc(len);
+    if (wbuf == NULL || rbuf == NULL) {
+        OsalMemFree(wbuf);
+        OsalMemFree(rbuf);
+        return HDF_ERR_MALLOC_FAIL;
+    }
+    for (i = 0; i < len; i++) {
+        wbuf[i] = (uint8_t)(i % MTD_VIRTUAL_NAND_OOB_SIZE + i / mtd->writeSize);
+    }
+    ret = MtdTestCheckRw(mtd, wbuf, rbuf, len);
+    OsalMemFree(wbuf);
+    OsalMemFree(rbuf);
+    return ret;
+}
+
+static struct MtdTestFunc g_mtdTestFunc[] = {
+    { MTD_TEST_BAD_BLOCK_TABLE, MtdTestBadBlockTable },
+    { MTD_TEST_MULTI_PAGE_RW, MtdTestMultiPageRw },
+};
+
+static int32_t MtdTestEntry(struct MtdTester *tester, int32_t cmd)
+{
+    int32_t i;
+    int32_t ret = HDF_ERR_NOT_SUPPORT;
+    struct MtdDevice *mtd = NULL;
+
+    if (tester == NULL) {
+        HDF_LOGE("%s: tester is NULL", __func__);
+        return HDF_ERR_INVALID_OBJECT;
+    }
+    mtd = MtdDeviceGetByNum((int16_t)tester->mtdIndex);
+    if (mtd == NULL || mtd->priv == NULL) {
+        HDF_LOGE("%s: virtual nand %u not found", __func__, tester->mtdIndex);
+        return HDF_FAILURE;
+    }
+    for (i = 0; i < sizeof(g_mtdTestFunc) / sizeof(g_mtdTestFunc[0]); i++) {
+        if (cmd == g_mtdTestFunc[i].type && g_mtdTestFunc[i].Func != NULL) {
+            ret = g_mtdTestFunc[i].Func(mtd);
+            break;
+        }
+    }
+    if (ret == HDF_ERR_NOT_SUPPORT) {
+        HDF_LOGE("%s: cmd %d not supported", __func__, cmd);
+    }
+    MtdDevicePut(mtd);
+    return ret;
+}
+
+static int32_t MtdTestBind(struct HdfDeviceObject *device)
+{
+    static struct MtdTester tester;
+
+    if (device == NULL) {
+        HDF_LOGE("%s: device is null!", __func__);
+        return HDF_ERR_IO;
+    }
+
+    device->service = &tester.service;
+    HDF_LOGI("%s: MTD_TEST service init success!", __func__);
+    return HDF_SUCCESS;
+}
+
+static int32_t MtdTestInit(struct HdfDeviceObject *device)
+{
+    int32_t ret;
+    struct MtdTester *tester = NULL;
+    struct DeviceResourceIface *drsOps = NULL;
+
+    if (device == NULL || device->service == NULL || device->property == NULL) {
+        HDF_LOGE("%s: invalid parameter", __func__);
+        return HDF_ERR_INVALID_PARAM;
+    }
+
+    drsOps = DeviceResourceGetIfaceInstance(HDF_CONFIG_SOURCE);
+    if (drsOps == NULL || drsOps->GetUint32 == NULL) {
+        HDF_LOGE("%s: invalid drs ops", __func__);
+        return HDF_FAILURE;
+    }
+    tester = (struct MtdTester *)device->service;
+    ret = drsOps->GetUint32(device->property, "mtdIndex", &tester->mtdIndex, 0);
+    if (ret != HDF_SUCCESS) {
+        HDF_LOGE("%s: read mtdIndex failed", __func__);
+        return ret;
+    }
+    tester->TestEntry = MtdTestEntry;
+    HDF_LOGI("%s: success", __func__);
+    return HDF_SUCCESS;
+}
+
+static void MtdTestRelease(struct HdfDeviceObject *device)
+{
+    if (device != NULL) {
+        device->service = NULL;
+    }
+}
+
+struct HdfDriverEntry g_mtdTestEntry = {
+    .moduleVersion = 1,
+    .Bind = MtdTestBind,
+    .Init = MtdTestInit,
+    .Release = MtdTestRelease,
+    .moduleName = "PLATFORM_MTD_TEST",
+};
+HDF_INIT(g_mtdTestEntry);
@@ -0,0 +1,45 @@
+/*
+ * Copyright (c) 2021 Huawei Device Co., Ltd.
+ *
+ * HDF is dual licensed: you can use it either under the terms of
+ * the GPL, or the BSD license, at your option.
+ * See the LICENSE file in the root of this repository for complete details.
+ */
+
+#ifndef MTD_TEST_H
+#define MTD_TEST_H
+
+#include "hdf_device_desc.h"
+#include "hdf_platform.h"
+
+enum MtdTestCmd {
+    MTD_TEST_BAD_BLOCK_TABLE = 0,
+    MTD_TEST_MULTI_PAGE_RW,
+};
+
+/* Access counters of the virtual nand, reachable through MtdDevice.priv */
+struct MtdVirtualNandStats {
+    uint32_t badBlockChecks; /* bad block marker reads, an oob read each on real nand */
+    uint32_t pageTransfers;
+    uint32_t multiPageTransfers;
+};
+
+#define MTD_VIRTUAL_NAND_PAGE_SIZE    2048
+#define MTD_VIRTUAL_NAND_OOB_SIZE     64
+#define MTD_VIRTUAL_NAND_BLOCK_PAGES  64
+#define MTD_VIRTUAL_NAND_BLOCK_NUM    16
+#define MTD_VIRTUAL_NAND_BAD_BLOCK    2 /* factory bad block */
+
+struct MtdTester {
+    struct IDeviceIoService service;
+    struct HdfDeviceObject *device;
+    int32_t (*TestEntry)(struct MtdTester *tester, int32_t cmd);
+    uint32_t mtdIndex;
+};
+
+static inline struct MtdTester *GetMtdTester(void)
+{
+    return (struct MtdTester *)DevSvcManagerClntGetService("MTD_TEST");
+}
+
+#endif /* MTD_TEST_H */
@@ -0,0 +1,237 @@
+/*
+ * Copyright (c) 2021 Huawei Device Co., Ltd.
+ *
+ * HDF is dual licensed: you can use it either under the terms of
+ * the GPL, or the BSD license, at your option.
+ * See the LICENSE file in the root of this repository for complete details.
+ */
+
+#include "platform_queue_test.h"
+#include "hdf_dlist.h"
+#include "hdf_log.h"
+#include "osal_atomic.h"
+#include "osal_mem.h"
+#include "osal_sem.h"
+#include "osal_time.h"
+#include "platform_queue.h"
+
+#define HDF_LOG_TAG platform_queue_test
+
+#define PLAT_QUEUE_TEST_KEY_NUM      8
+#define PLAT_QUEUE_TEST_SLOW_KEYS    0x3 /* keys 0 and 1 have slow handlers */
+#define PLAT_QUEUE_TEST_SLOW_MS      2
+#define PLAT_QUEUE_TEST_MSG_NUM      256
+#define PLAT_QUEUE_TEST_WORKERS      4
+#define PLAT_QUEUE_TEST_WAIT_MS      5000
+#define PLAT_QUEUE_TEST_USEC_PER_SEC 1000000
+
+struct PlatformQueueTester;
+
+struct PlatformQueueTestMsg {
+    struct PlatformMsg msg;
+    uint32_t seq;        /* order among the messages of its key */
+    uint32_t latencyUs;  /* from queued until handled */
+};
+
+struct PlatformQueueTester {
+    struct PlatformQueue *queue;
+    struct PlatformQueueTestMsg *msgs;
+    uint32_t next[PLAT_QUEUE_TEST_KEY_NUM];
+    OsalAtomic running;
+    int32_t maxRunning;
+    OsalAtomic done;
+    OsalAtomic errors;
+    struct OsalSem sem;
+};
+
+struct PlatformQueueTestResult {
+    uint32_t fastAvgUs;
+    uint32_t fastMaxUs;
+    uint32_t slowAvgUs;
+    uint64_t totalUs;
+};
+
+static uint32_t PlatformQueueTestElapsedUs(const OsalTimespec *start)
+{
+    OsalTimespec now;
+    OsalTimespec diff;
+
+    (void)OsalGetTime(&now);
+    (void)OsalDiffTime(start, &now, &diff);
+    return diff.sec * PLAT_QUEUE_TEST_USEC_PER_SEC + diff.usec;
+}
+
+static bool PlatformQueueTestKeyIsSlow(uint32_t key)
+{
+    return ((1U << key) & PLAT_QUEUE_TEST_SLOW_KEYS) != 0;
+}
+
+static int32_t PlatformQueueTestHandle(struct PlatformQueue *queue, struct PlatformMsg *msg)
+{
+    int32_t running;
+    struct PlatformQueueTester *tester = (struct PlatformQueueTester *)queue->data;
+    struct PlatformQueueTestMsg *testMsg = CONTAINER_OF(msg, struct PlatformQueueTestMsg, msg);
+
+    running = OsalAtomicIncReturn(&tester->running);
+    if (running > tester->maxRunning) {
+        tester->maxRunning = running;
+    }
+    /* messages of a key never run concurrently, so next needs no lock */
+    if (testMsg->seq != tester->next[msg->key]) {
+        HDF_LOGE("%s: key %u got %u, expect %u", __func__, msg->key, testMsg->seq, tester->next[msg->key]);
+        OsalAtomicInc(&tester->errors);
+    }
+    tester->next[msg->key] = testMsg->seq + 1;
+    if (PlatformQueueTestKeyIsSlow(msg->key)) {
+        OsalMSleep(PLAT_QUEUE_TEST_SLOW_MS);
+    }
+    testMsg->latencyUs = PlatformQueueTestElapsedUs(&msg->stamp);
+    OsalAtomicDec(&tester->running);
+
+    OsalAtomicInc(&tester->done);
+    (void)OsalSemPost(&tester->sem);
+    return HDF_SUCCESS;
+}
+
+static void PlatformQueueTestSummary(struct PlatformQueueTester *tester, struct PlatformQueueTestResult *result)
+{
+    uint32_t i;
+    uint32_t fastNum = 0;
+    uint64_t fastUs = 0;
+    uint64_t slowUs = 0;
+    struct PlatformQueueTestMsg *testMsg = NULL;
+
+    result->fastMaxUs = 0;
+    for (i = 0; i < PLAT_QUEUE_TEST_MSG_NUM; i++) {
+        testMsg = &tester->msgs[i];
+        if (PlatformQueueTestKeyIsSlow(testMsg->msg.key)) {
+            slowUs += testMsg->latencyUs;
+            continue;
+        }
+        fastNum++;
+        fastUs += testMsg->latencyUs;
+        if (testMsg->latencyUs > result->fastMaxUs) {
+            result->fastMaxUs = testMsg->latencyUs;
+        }
+    }
+    result->fastAvgUs = (fastNum == 0) ? 0 : (uint32_t)(fastUs / fastNum);
+    result->slowAvgUs = (fastNum == PLAT_QUEUE_TEST_MSG_NUM) ? 0 :
+        (uint32_t)(slowUs / (PLAT_QUEUE_TEST_MSG_NUM - fastNum));
+}
+
+/* queue messages of all keys in turns, then wait for all of them */
+static int32_t PlatformQueueTestRun(uint32_t workerNum, struct PlatformQueueTestResult *result)
+{
+    uint32_t i;
+    int32_t ret = HDF_SUCCESS;
+    OsalTimespec start;
+    struct PlatformQueueStats stats;
+    struct PlatformQueueTester tester = {0};
+
+    tester.msgs = (struct PlatformQueueTestMsg *)OsalMemCalloc(sizeof(*tester.msgs) * PLAT_QUEUE_TEST_MSG_NUM);
+    if (tester.msgs == NULL) {
+        return HDF_ERR_MALLOC_FAIL;
+    }
+    (void)OsalSemInit(&tester.sem, 0);
+    OsalAtomicSet(&tester.running, 0);
+    OsalAtomicSet(&tester.done, 0);
+    OsalAtomicSet(&tester.errors, 0);
+    tester.queue = PlatformQueueCreatePool(PlatformQueueTestHandle, "platform_queue_test", &tester, workerNum);
+    if (tester.queue == NULL || PlatformQueueStart(tester.queue) != HDF_SUCCESS) {
+        HDF_LOGE("%s: start queue of %u workers failed", __func__, workerNum);
+        ret = HDF_FAILURE;
+        goto __EXIT;
+    }
+
+    (void)OsalGetTime(&start);
+    for (i = 0; i < PLAT_QUEUE_TEST_MSG_NUM; i++) {
+        tester.msgs[i].msg.key = i % PLAT_QUEUE_TEST_KEY_NUM;
+        tester.msgs[i].seq = i / PLAT_QUEUE_TEST_KEY_NUM;
+        tester.msgs[i].msg.block = false;
+        PlatformQueueAddMsg(tester.queue, &tester.msgs[i].msg);
+    }
+    while (OsalAtomicRead(&tester.done) < PLAT_QUEUE_TEST_MSG_NUM) {
+        if (OsalSemWait(&tester.sem, PLAT_QUEUE_TEST_WAIT_MS) != HDF_SUCCESS) {
+            HDF_LOGE("%s: %d of %d handled", __func__, OsalAtomicRead(&tester.done), PLAT_QUEUE_TEST_MSG_NUM);
+            ret = HDF_ERR_TIMEOUT;
+            goto __EXIT;
+        }
+    }
+    result->totalUs = PlatformQueueTestElapsedUs(&start);
+    if (OsalAtomicRead(&tester.errors) != 0) {
+        ret = HDF_FAILURE;
+        goto __EXIT;
+    }
+
+    PlatformQueueTestSummary(&tester, result);
+    (void)PlatformQueueGetStats(tester.queue, &stats);
+    HDF_LOGE("%s: %u workers, %u concurrent, total %llu us, fast avg %u max %u us, slow avg %u us", __func__,
+        workerNum, tester.maxRunning, (unsigned long long)result->totalUs, result->fastAvgUs, result->fastMaxUs,
+        result->slowAvgUs);
+    HDF_LOGE("%s: handled %u, max depth %u, wait avg %llu max %u us", __func__, stats.handled, stats.maxDepth,
+        (unsigned long long)(stats.totalWaitUs / (stats.handled + 1)), stats.maxWaitUs);
+
+__EXIT:
+    PlatformQueueDestroy(tester.queue);
+    (void)OsalSemDestroy(&tester.sem);
+    OsalMemFree(tester.msgs);
+    return ret;
+}
+
+static int32_t PlatformQueueTestKeyOrder(void)
+{
+    struct PlatformQueueTestResult result;
+
+    return PlatformQueueTestRun(PLAT_QUEUE_TEST_WORKERS, &result);
+}
+
+/* fast messages stuck behind slow ones with one worker, not with a pool */
+static int32_t PlatformQueueTestBench(void)
+{
+    int32_t ret;
+    struct PlatformQueueTestResult single;
+    struct PlatformQueueTestResult pool;
+
+    ret = PlatformQueueTestRun(1, &single);
+    if (ret != HDF_SUCCESS) {
+        return ret;
+    }
+    ret = PlatformQueueTestRun(PLAT_QUEUE_TEST_WORKERS, &pool);
+    if (ret != HDF_SUCCESS) {
+        return ret;
+    }
+    if (pool.fastMaxUs >= single.fastMaxUs) {
+        HDF_LOGE("%s: fast messages still blocked, max %u us vs %u us", __func__, pool.fastMaxUs, single.fastMaxUs);
+        return HDF_FAILURE;
+    }
+    return HDF_SUCCESS;
+}
+
+struct PlatformQueueTestEntry {
+    int cmd;
+    int32_t (*func)(void);
+};
+
+static struct PlatformQueueTestEntry g_entry[] = {
+    { PLATFORM_QUEUE_TEST_KEY_ORDER, PlatformQueueTestKeyOrder },
+    { PLATFORM_QUEUE_TEST_BENCH, PlatformQueueTestBench },
+};
+
+int32_t PlatformQueueTestExecute(int cmd)
+{
+    uint32_t i;
+    int32_t ret = HDF_ERR_NOT_SUPPORT;
+
+    if (cmd >= PLATFORM_QUEUE_TEST_CMD_MAX) {
+        HDF_LOGE("PlatformQueueTestExecute: invalid cmd:%d", cmd);
+        return ret;
+    }
+    for (i = 0; i < sizeof(g_entry) / sizeof(g_entry[0]); i++) {
+        if (g_entry[i].cmd == cmd && g_entry[i].func != NULL) {
+            ret = g_entry[i].func();
+            break;
+        }
+    }
+    HDF_LOGE("PlatformQueueTestExecute: cmd:%d ret:%d", cmd, ret);
+    return ret;
+}
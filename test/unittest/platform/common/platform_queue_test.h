@@ -0,0 +1,22 @@
+/*
+ * Copyright (c) 2021 Huawei Device Co., Ltd.
+ *
+ * HDF is dual licensed: you can use it either under the terms of
+ * the GPL, or the BSD license, at your option.
+ * See the LICENSE file in the root of this repository for complete details.
+ */
+
+#ifndef PLATFORM_QUEUE_TEST_H
+#define PLATFORM_QUEUE_TEST_H
+
+#include "hdf_base.h"
+
+enum PlatformQueueTestCmd {
+    PLATFORM_QUEUE_TEST_KEY_ORDER = 0,
+    PLATFORM_QUEUE_TEST_BENCH,
+    PLATFORM_QUEUE_TEST_CMD_MAX,
+};
+
+int32_t PlatformQueueTestExecute(int cmd);
+
+#endif /* PLATFORM_QUEUE_TEST_H */
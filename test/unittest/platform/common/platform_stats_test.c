@@ -0,0 +1,427 @@
+/*
+ * Copyright (c) 2021 Huawei Device Co., Ltd.
+ *
+ * HDF is dual licensed: you can use it either under the terms of
+ * the GPL, or the BSD license, at your option.
+ * See the LICENSE file in the root of this repository for complete details.
+ */
+
+#include "platform_stats_test.h"
+#include "hdf_log.h"
+#include "i2c_core.h"
+#include "osal_sem.h"
+#include "osal_thread.h"
+#include "osal_time.h"
+#include "platform_stats.h"
+
+#define HDF_LOG_TAG platform_stats_test
+
+#define PLAT_STATS_TEST_NUM             0x5A5A
+#define PLAT_STATS_TEST_BUS_A           (I2C_BUS_MAX - 2)
+#define PLAT_STATS_TEST_BUS_B           (I2C_BUS_MAX - 1)
+#define PLAT_STATS_TEST_ADDR            0x50
+#define PLAT_STATS_TEST_BAD_ADDR        0x51
+#define PLAT_STATS_TEST_LEN             16
+#define PLAT_STATS_TEST_BYTE_US         2
+#define PLAT_STATS_TEST_XFER_NUM        64
+#define PLAT_STATS_TEST_NACK_NUM        4
+#define PLAT_STATS_TEST_HOLD_MS         2
+#define PLAT_STATS_TEST_WAIT_MS         1000
+#define PLAT_STATS_TEST_STACK_SIZE      4096
+#define PLAT_STATS_TEST_LOOP_NUM        10000
+#define PLAT_STATS_TEST_OVERHEAD_MAX_NS 10000
+#define PLAT_STATS_TEST_USEC_PER_SEC    1000000
+#define PLAT_STATS_TEST_USEC_PER_MSEC   1000
+#define PLAT_STATS_TEST_NSEC_PER_USEC   1000
+
+/* an i2c controller with one device, each byte takes a fixed time on the bus */
+struct PlatformStatsTestCntlr {
+    struct I2cCntlr cntlr;
+    uint32_t byteUs;
+};
+
+struct PlatformStatsTestWorker {
+    struct I2cCntlr *cntlr;
+    struct OsalSem done;
+    int32_t ret;
+};
+
+struct PlatformStatsTestSample {
+    uint32_t lockUs;
+    uint32_t busUs;
+    uint32_t bytes;
+    int32_t ret;
+    uint32_t lockBucket;
+    uint32_t busBucket;
+};
+
+static uint8_t g_buf[PLAT_STATS_TEST_LEN];
+
+static const struct PlatformStatsTestSample g_samples[] = {
+    { 0, 1, 4, HDF_SUCCESS, 0, 1 },
+    { 1, 2, 4, HDF_SUCCESS, 1, 2 },
+    { 3, 1000, 8, HDF_FAILURE, 2, 10 },
+    { 1024, 0xFFFFFFFF, 0, HDF_SUCCESS, 11, PLATFORM_STATS_HIST_SIZE - 1 },
+};
+
+static uint32_t PlatformStatsTestBucket(uint32_t us)
+{
+    uint32_t bucket = 0;
+
+    while (us != 0 && bucket < PLATFORM_STATS_HIST_SIZE - 1) {
+        us >>= 1;
+        bucket++;
+    }
+    return bucket;
+}
+
+static uint32_t PlatformStatsTestHistSum(const struct PlatformStatsData *data, enum PlatformStatsHistType type,
+    uint32_t from, uint32_t to)
+{
+    uint32_t i;
+    uint32_t sum = 0;
+
+    for (i = from; i < to && i < PLATFORM_STATS_HIST_SIZE; i++) {
+        sum += data->hist[type][i];
+    }
+    return sum;
+}
+
+static int32_t PlatformStatsTestHistCheck(const struct PlatformStatsData *data)
+{
+    uint32_t i;
+    uint32_t num = sizeof(g_samples) / sizeof(g_samples[0]);
+    uint32_t lockHist[PLATFORM_STATS_HIST_SIZE] = {0};
+    uint32_t busHist[PLATFORM_STATS_HIST_SIZE] = {0};
+
+    if (data->calls != num || data->errors != 1 || data->bytes != 16) {
+        HDF_LOGE("%s: calls %u errors %u bytes %llu", __func__, data->calls, data->errors,
+            (unsigned long long)data->bytes);
+        return HDF_FAILURE;
+    }
+    if (data->maxUs[PLATFORM_STATS_HIST_LOCK] != 1024 || data->maxUs[PLATFORM_STATS_HIST_BUS] != 0xFFFFFFFF ||
+        data->totalUs[PLATFORM_STATS_HIST_LOCK] != 1028) {
+        HDF_LOGE("%s: wrong max or total", __func__);
+        return HDF_FAILURE;
+    }
+    for (i = 0; i < num; i++) {
+        lockHist[g_samples[i].lockBucket]++;
+        busHist[g_samples[i].busBucket]++;
+    }
+    for (i = 0; i < PLATFORM_STATS_HIST_SIZE; i++) {
+        if (data->hist[PLATFORM_STATS_HIST_LOCK][i] != lockHist[i] ||
+            data->hist[PLATFORM_STATS_HIST_BUS][i] != busHist[i]) {
+            HDF_LOGE("%s: bucket %u: lock %u bus %u, expect %u %u", __func__, i,
+                data->hist[PLATFORM_STATS_HIST_LOCK][i], data->hist[PLATFORM_STATS_HIST_BUS][i],
+                lockHist[i], busHist[i]);
+            return HDF_FAILURE;
+        }
+    }
+    return HDF_SUCCESS;
+}
+
+/* known times land in the expected buckets, reset clears them and unregistered counters are gone */
+static int32_t PlatformStatsTestHist(void)
+{
+    uint32_t i;
+    int32_t ret;
+    struct PlatformStats stats = {0};
+    struct PlatformStatsData data;
+
+    ret = PlatformStatsRegister(&stats, PLATFORM_MODULE_DEFAULT, PLAT_STATS_TEST_NUM);
+    if (ret != HDF_SUCCESS) {
+        return ret;
+    }
+    for (i = 0; i < sizeof(g_samples) / sizeof(g_samples[0]); i++) {
+        PlatformStatsAdd(&stats, g_samples[i].lockUs, g_samples[i].busUs, g_samples[i].bytes, g_samples[i].ret);
+    }
+    ret = PlatformStatsRead(PLATFORM_MODULE_DEFAULT, PLAT_STATS_TEST_NUM, &data);
+    if (ret == HDF_SUCCESS) {
+        ret = PlatformStatsTestHistCheck(&data);
+    }
+    if (ret == HDF_SUCCESS) {
+        PlatformStatsReset(PLATFORM_MODULE_DEFAULT, PLATFORM_STATS_NUM_ALL);
+        ret = PlatformStatsRead(PLATFORM_MODULE_DEFAULT, PLAT_STATS_TEST_NUM, &data);
+        if (ret == HDF_SUCCESS && (data.calls != 0 || PlatformStatsTestHistSum(&data, PLATFORM_STATS_HIST_BUS, 0,
+            PLATFORM_STATS_HIST_SIZE) != 0)) {
+            HDF_LOGE("%s: reset left %u calls", __func__, data.calls);
+            ret = HDF_FAILURE;
+        }
+    }
+    PlatformStatsUnregister(&stats);
+    if (ret == HDF_SUCCESS && PlatformStatsRead(PLATFORM_MODULE_DEFAULT, PLAT_STATS_TEST_NUM, &data) == HDF_SUCCESS) {
+        HDF_LOGE("%s: unregistered stats still readable", __func__);
+        ret = HDF_FAILURE;
+    }
+    return ret;
+}
+
+static int32_t PlatformStatsTestTransfer(struct I2cCntlr *cntlr, struct I2cMsg *msgs, int16_t count)
+{
+    int16_t i;
+    struct PlatformStatsTestCntlr *test = (struct PlatformStatsTestCntlr *)cntlr;
+
+    for (i = 0; i < count; i++) {
+        if (msgs[i].addr != PLAT_STATS_TEST_ADDR) {
+            return i;
+        }
+        OsalUDelay(msgs[i].len * test->byteUs);
+    }
+    return count;
+}
+
+static const struct I2cMethod g_testMethod = {
+    .transfer = PlatformStatsTestTransfer,
+};
+
+static int32_t PlatformStatsTestCntlrAdd(struct PlatformStatsTestCntlr *test, int16_t busId, uint32_t byteUs)
+{
+    int32_t ret;
+
+    test->cntlr.busId = busId;
+    test->cntlr.ops = &g_testMethod;
+    test->byteUs = byteUs;
+    ret = I2cCntlrAdd(&test->cntlr);
+    if (ret != HDF_SUCCESS) {
+        HDF_LOGE("%s: add i2c %d failed, ret %d", __func__, busId, ret);
+        return ret;
+    }
+    PlatformStatsReset(PLATFORM_MODULE_I2C, (uint32_t)busId);
+    return HDF_SUCCESS;
+}
+
+static int32_t PlatformStatsTestXfer(struct I2cCntlr *cntlr, uint16_t addr)
+{
+    struct I2cMsg msg;
+
+    msg.addr = addr;
+    msg.buf = g_buf;
+    msg.len = PLAT_STATS_TEST_LEN;
+    msg.flags = 0;
+    return I2cCntlrTransfer(cntlr, &msg, 1);
+}
+
+static int PlatformStatsTestWorkerFunc(void *param)
+{
+    struct PlatformStatsTestWorker *worker = (struct PlatformStatsTestWorker *)param;
+
+    worker->ret = PlatformStatsTestXfer(worker->cntlr, PLAT_STATS_TEST_ADDR);
+    (void)OsalSemPost(&worker->done);
+    return HDF_SUCCESS;
+}
+
+/* one transfer waits while the test holds the controller */
+static int32_t PlatformStatsTestContend(struct I2cCntlr *cntlr)
+{
+    int32_t ret;
+    struct OsalThread thread;
+    struct OsalThreadParam cfg;
+    struct PlatformStatsTestWorker worker;
+
+    worker.cntlr = cntlr;
+    worker.ret = HDF_FAILURE;
+    (void)OsalSemInit(&worker.done, 0);
+    ret = OsalThreadCreate(&thread, (OsalThreadEntry)PlatformStatsTestWorkerFunc, &worker);
+    if (ret != HDF_SUCCESS) {
+        (void)OsalSemDestroy(&worker.done);
+        return ret;
+    }
+    cfg.name = "PlatformStatsTest";
+    cfg.priority = OSAL_THREAD_PRI_DEFAULT;
+    cfg.stackSize = PLAT_STATS_TEST_STACK_SIZE;
+
+    (void)cntlr->lockOps->lock(cntlr);
+    ret = OsalThreadStart(&thread, &cfg);
+    if (ret == HDF_SUCCESS) {
+        OsalMSleep(PLAT_STATS_TEST_HOLD_MS);
+    }
+    cntlr->lockOps->unlock(cntlr);
+    if (ret == HDF_SUCCESS) {
+        ret = OsalSemWait(&worker.done, PLAT_STATS_TEST_WAIT_MS);
+    }
+    (void)OsalThreadDestroy(&thread);
+    (void)OsalSemDestroy(&worker.done);
+    if (ret == HDF_SUCCESS && worker.ret != 1) {
+        HDF_LOGE("%s: contended transfer ret %d", __func__, worker.ret);
+        ret = HDF_FAILURE;
+    }
+    return ret;
+}
+
+static int32_t PlatformStatsTestCheckBusA(const struct PlatformStatsData *data)
+{
+    uint32_t busMin = PlatformStatsTestBucket(PLAT_STATS_TEST_LEN * PLAT_STATS_TEST_BYTE_US);
+    uint32_t lockMin = PlatformStatsTestBucket(PLAT_STATS_TEST_HOLD_MS * PLAT_STATS_TEST_USEC_PER_MSEC / 2);
+
+    if (data->calls != PLAT_STATS_TEST_XFER_NUM + 1 || data->errors != 0 ||
+        data->bytes != (uint64_t)(PLAT_STATS_TEST_XFER_NUM + 1) * PLAT_STATS_TEST_LEN) {
+        HDF_LOGE("%s: calls %u errors %u bytes %llu", __func__, data->calls, data->errors,
+            (unsigned long long)data->bytes);
+        return HDF_FAILURE;
+    }
+    if (PlatformStatsTestHistSum(data, PLATFORM_STATS_HIST_BUS, 0, PLATFORM_STATS_HIST_SIZE) != data->calls ||
+        PlatformStatsTestHistSum(data, PLATFORM_STATS_HIST_LOCK, 0, PLATFORM_STATS_HIST_SIZE) != data->calls) {
+        HDF_LOGE("%s: histograms do not add up to the calls", __func__);
+        return HDF_FAILURE;
+    }
+    /* no transfer is shorter than its bytes take, and the held one waited about as long as it was held */
+    if (PlatformStatsTestHistSum(data, PLATFORM_STATS_HIST_BUS, 0, busMin) != 0) {
+        HDF_LOGE("%s: bus time under %u us", __func__, 1U << (busMin - 1));
+        return HDF_FAILURE;
+    }
+    if (PlatformStatsTestHistSum(data, PLATFORM_STATS_HIST_LOCK, lockMin, PLATFORM_STATS_HIST_SIZE) == 0) {
+        HDF_LOGE("%s: no lock wait over %u us, max %u", __func__, 1U << (lockMin - 1),
+            data->maxUs[PLATFORM_STATS_HIST_LOCK]);
+        return HDF_FAILURE;
+    }
+    return HDF_SUCCESS;
+}
+
+static int32_t PlatformStatsTestRunCntlrs(struct I2cCntlr *cntlrA, struct I2cCntlr *cntlrB)
+{
+    uint32_t i;
+    int32_t ret;
+    struct PlatformStatsData data;
+
+    ret = PlatformStatsTestContend(cntlrA);
+    if (ret != HDF_SUCCESS) {
+        return ret;
+    }
+    for (i = 0; i < PLAT_STATS_TEST_XFER_NUM; i++) {
+        (void)PlatformStatsTestXfer(cntlrA, PLAT_STATS_TEST_ADDR);
+    }
+    for (i = 0; i < PLAT_STATS_TEST_XFER_NUM / 2; i++) {
+        (void)PlatformStatsTestXfer(cntlrB, PLAT_STATS_TEST_ADDR);
+    }
+    for (i = 0; i < PLAT_STATS_TEST_NACK_NUM; i++) {
+        (void)PlatformStatsTestXfer(cntlrB, PLAT_STATS_TEST_BAD_ADDR);
+    }
+
+    ret = PlatformStatsRead(PLATFORM_MODULE_I2C, PLAT_STATS_TEST_BUS_A, &data);
+    if (ret != HDF_SUCCESS || PlatformStatsTestCheckBusA(&data) != HDF_SUCCESS) {
+        return HDF_FAILURE;
+    }
+    ret = PlatformStatsRead(PLATFORM_MODULE_I2C, PLAT_STATS_TEST_BUS_B, &data);
+    if (ret != HDF_SUCCESS || data.calls != PLAT_STATS_TEST_XFER_NUM / 2 + PLAT_STATS_TEST_NACK_NUM ||
+        data.errors != PLAT_STATS_TEST_NACK_NUM ||
+        data.bytes != (uint64_t)(PLAT_STATS_TEST_XFER_NUM / 2) * PLAT_STATS_TEST_LEN) {
+        HDF_LOGE("%s: bus b: calls %u errors %u", __func__, data.calls, data.errors);
+        return HDF_FAILURE;
+    }
+
+    /* resetting one controller leaves the other alone */
+    PlatformStatsReset(PLATFORM_MODULE_I2C, PLAT_STATS_TEST_BUS_A);
+    if (PlatformStatsRead(PLATFORM_MODULE_I2C, PLAT_STATS_TEST_BUS_A, &data) != HDF_SUCCESS || data.calls != 0 ||
+        PlatformStatsRead(PLATFORM_MODULE_I2C, PLAT_STATS_TEST_BUS_B, &data) != HDF_SUCCESS || data.calls == 0) {
+        HDF_LOGE("%s: reset of bus a failed", __func__);
+        return HDF_FAILURE;
+    }
+    PlatformStatsDump();
+    return HDF_SUCCESS;
+}
+
+/* drive two simulated i2c controllers and check what their counters saw */
+static int32_t PlatformStatsTestCntlr(void)
+{
+    int32_t ret;
+    struct PlatformStatsTestCntlr testA = {0};
+    struct PlatformStatsTestCntlr testB = {0};
+
+    ret = PlatformStatsTestCntlrAdd(&testA, PLAT_STATS_TEST_BUS_A, PLAT_STATS_TEST_BYTE_US);
+    if (ret != HDF_SUCCESS) {
+        return ret;
+    }
+    ret = PlatformStatsTestCntlrAdd(&testB, PLAT_STATS_TEST_BUS_B, 0);
+    if (ret != HDF_SUCCESS) {
+        I2cCntlrRemove(&testA.cntlr);
+        return ret;
+    }
+    ret = PlatformStatsTestRunCntlrs(&testA.cntlr, &testB.cntlr);
+    I2cCntlrRemove(&testB.cntlr);
+    I2cCntlrRemove(&testA.cntlr);
+    return ret;
+}
+
+static uint64_t PlatformStatsTestElapsedUs(const OsalTimespec *start)
+{
+    OsalTimespec now;
+    OsalTimespec diff;
+
+    (void)OsalGetTime(&now);
+    (void)OsalDiffTime(start, &now, &diff);
+    return (uint64_t)diff.sec * PLAT_STATS_TEST_USEC_PER_SEC + diff.usec;
+}
+
+/* the same zero time transfers through the core, and straight to the controller under its lock */
+static int32_t PlatformStatsTestOverhead(void)
+{
+    uint32_t i;
+    int32_t ret;
+    uint64_t rawUs;
+    uint64_t statsUs;
+    uint64_t overheadNs;
+    OsalTimespec start;
+    struct I2cMsg msg;
+    struct PlatformStatsTestCntlr test = {0};
+    struct I2cCntlr *cntlr = &test.cntlr;
+
+    ret = PlatformStatsTestCntlrAdd(&test, PLAT_STATS_TEST_BUS_A, 0);
+    if (ret != HDF_SUCCESS) {
+        return ret;
+    }
+    msg.addr = PLAT_STATS_TEST_ADDR;
+    msg.buf = g_buf;
+    msg.len = PLAT_STATS_TEST_LEN;
+    msg.flags = 0;
+
+    (void)OsalGetTime(&start);
+    for (i = 0; i < PLAT_STATS_TEST_LOOP_NUM; i++) {
+        (void)cntlr->lockOps->lock(cntlr);
+        (void)cntlr->ops->transfer(cntlr, &msg, 1);
+        cntlr->lockOps->unlock(cntlr);
+    }
+    rawUs = PlatformStatsTestElapsedUs(&start);
+
+    (void)OsalGetTime(&start);
+    for (i = 0; i < PLAT_STATS_TEST_LOOP_NUM; i++) {
+        (void)I2cCntlrTransfer(cntlr, &msg, 1);
+    }
+    statsUs = PlatformStatsTestElapsedUs(&start);
+    I2cCntlrRemove(cntlr);
+
+    overheadNs = (statsUs > rawUs) ?
+        (statsUs - rawUs) * PLAT_STATS_TEST_NSEC_PER_USEC / PLAT_STATS_TEST_LOOP_NUM : 0;
+    HDF_LOGE("%s: %u calls, raw %llu us, counted %llu us, %llu ns per call", __func__, PLAT_STATS_TEST_LOOP_NUM,
+        (unsigned long long)rawUs, (unsigned long long)statsUs, (unsigned long long)overheadNs);
+    return (overheadNs <= PLAT_STATS_TEST_OVERHEAD_MAX_NS) ? HDF_SUCCESS : HDF_FAILURE;
+}
+
+struct PlatformStatsTestEntry {
+    int cmd;
+    int32_t (*func)(void);
+};
+
+static struct PlatformStatsTestEntry g_entry[] = {
+    { PLATFORM_STATS_TEST_HIST, PlatformStatsTestHist },
+    { PLATFORM_STATS_TEST_CNTLR, PlatformStatsTestCntlr },
+    { PLATFORM_STATS_TEST_OVERHEAD, PlatformStatsTestOverhead },
+};
+
+int32_t PlatformStatsTestExecute(int cmd)
+{
+    uint32_t i;
+    int32_t ret = HDF_ERR_NOT_SUPPORT;
+
+    if (cmd >= PLATFORM_STATS_TEST_CMD_MAX) {
+        HDF_LOGE("PlatformStatsTestExecute: invalid cmd:%d", cmd);
+        return ret;
+    }
+    for (i = 0; i < sizeof(g_entry) / sizeof(g_entry[0]); i++) {
+        if (g_entry[i].cmd == cmd && g_entry[i].func != NULL) {
+            ret = g_entry[i].func();
+            break;
+        }
+    }
+    HDF_LOGE("PlatformStatsTestExecute: cmd:%d ret:%d", cmd, ret);
+    return ret;
+}
@@ -0,0 +1,23 @@
+/*
+ * Copyright (c) 2021 Huawei Device Co., Ltd.
+ *
+ * HDF is dual licensed: you can use it either under the terms of
+ * the GPL, or the BSD license, at your option.
+ * See the LICENSE file in the root of this repository for complete details.
+ */
+
+#ifndef PLATFORM_STATS_TEST_H
+#define PLATFORM_STATS_TEST_H
+
+#include "hdf_base.h"
+
+enum PlatformStatsTestCmd {
+    PLATFORM_STATS_TEST_HIST = 0,
+    PLATFORM_STATS_TEST_CNTLR,
+    PLATFORM_STATS_TEST_OVERHEAD,
+    PLATFORM_STATS_TEST_CMD_MAX,
+};
+
+int32_t PlatformStatsTestExecute(int cmd);
+
+#endif /* PLATFORM_STATS_TEST_H */
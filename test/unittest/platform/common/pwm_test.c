@@ -10,12 +10,25 @@
 #include "device_resource_if.h"
 #include "hdf_base.h"
 #include "hdf_log.h"
+#include "osal_mem.h"
 #include "osal_time.h"
+#include "pwm_core.h"
 
 #define HDF_LOG_TAG           pwm_test
 #define SEQ_OUTPUT_DELAY      100 /* Delay time of sequential output, unit: ms */
 #define OUTPUT_WAVES_DELAY    1 /* Delay time of waves output, unit: second */
 #define TEST_WAVES_NUMBER     10 /* The number of waves for test. */
+#define PWM_TEST_SIM_CHANNELS 3
+#define PWM_TEST_SIM_NUM      100 /* Number of the first simulated channel, clear of real devices. */
+#define PWM_TEST_SIM_NO_FAIL  0xFFFFFFFF
+#define PWM_TEST_SIM_PERIOD   1000000 /* unit: ns */
+#define PWM_TEST_DUTY_DIV     2
+#define PWM_TEST_SEQ_STEPS    16
+#define PWM_TEST_SEQ_LOOPS    2
+#define PWM_TEST_SEQ_STEP_US  2000
+#define PWM_TEST_SEQ_MARGIN_MS 50
+#define PWM_TEST_USEC_PER_SEC  1000000
+#define PWM_TEST_USEC_PER_MSEC 1000
 
 struct PwmTestFunc {
     enum PwmTestCmd type;
@@ -263,6 +276,260 @@ static int32_t PwmReliabilityTest(struct PwmTest *test)
     return HDF_SUCCESS;
 }
 
+/*
+ * A controller of PWM_TEST_SIM_CHANNELS channels that only records the calls it gets. Its channels are
+ * not published as services, the tests below use the devices as handles as PwmOpen would return them.
+ */
+struct PwmTestSim {
+    struct PwmDev pwms[PWM_TEST_SIM_CHANNELS];
+    struct HdfDeviceObject objs[PWM_TEST_SIM_CHANNELS];
+    DevHandle handles[PWM_TEST_SIM_CHANNELS];
+    uint32_t setCalls;
+    uint32_t groupCalls;
+    uint32_t failNum;
+    uint32_t lastDuty[PWM_TEST_SIM_CHANNELS];
+    OsalTimespec lastUpdate;
+    uint64_t gapSumUs;
+    uint64_t gapMaxUs;
+};
+
+static void PwmTestSimRecord(struct PwmTestSim *sim)
+{
+    OsalTimespec now = {0, 0};
+    OsalTimespec diff = {0, 0};
+    uint64_t gapUs;
+
+    (void)OsalGetTime(&now);
+    if (sim->groupCalls > 1) {
+        (void)OsalDiffTime(&sim->lastUpdate, &now, &diff);
+        gapUs = (uint64_t)diff.sec * PWM_TEST_USEC_PER_SEC + diff.usec;
+        sim->gapSumUs += gapUs;
+        sim->gapMaxUs = (gapUs > sim->gapMaxUs) ? gapUs : sim->gapMaxUs;
+    }
+    sim->lastUpdate = now;
+}
+
+static int32_t PwmTestSimSetConfig(struct PwmDev *pwm, struct PwmConfig *config)
+{
+    struct PwmTestSim *sim = (struct PwmTestSim *)pwm->priv;
+
+    sim->setCalls++;
+    if (pwm->num == sim->failNum) {
+        return HDF_ERR_IO;
+    }
+    sim->lastDuty[pwm->num - PWM_TEST_SIM_NUM] = config->duty;
+    return HDF_SUCCESS;
+}
+
+static int32_t PwmTestSimSetConfigGroup(struct PwmDev **pwms, struct PwmConfig *configs, uint32_t count)
+{
+    uint32_t i;
+    struct PwmTestSim *sim = (struct PwmTestSim *)pwms[0]->priv;
+
+    sim->groupCalls++;
+    PwmTestSimRecord(sim);
+    for (i = 0; i < count; i++) {
+        sim->lastDuty[pwms[i]->num - PWM_TEST_SIM_NUM] = configs[i].duty;
+    }
+    return HDF_SUCCESS;
+}
+
+static struct PwmMethod g_pwmTestSimOps = {
+    .setConfig = PwmTestSimSetConfig,
+};
+
+static struct PwmMethod g_pwmTestSimGroupOps = {
+    .setConfig = PwmTestSimSetConfig,
+    .setConfigGroup = PwmTestSimSetConfigGroup,
+};
+
+static struct PwmTestSim *PwmTestSimCreate(struct PwmMethod *method)
+{
+    uint32_t i;
+    struct PwmTestSim *sim = NULL;
+
+    sim = (struct PwmTestSim *)OsalMemCalloc(sizeof(*sim));
+    if (sim == NULL) {
+        return NULL;
+    }
+    sim->failNum = PWM_TEST_SIM_NO_FAIL;
+    for (i = 0; i < PWM_TEST_SIM_CHANNELS; i++) {
+        sim->pwms[i].method = method;
+        sim->pwms[i].num = PWM_TEST_SIM_NUM + i;
+        sim->pwms[i].cfg.period = PWM_TEST_SIM_PERIOD;
+        sim->pwms[i].cfg.status = PWM_ENABLE_STATUS;
+        sim->pwms[i].priv = sim;
+        if (PwmDeviceAdd(&sim->objs[i], &sim->pwms[i]) != HDF_SUCCESS) {
+            while (i-- > 0) {
+                PwmDeviceRemove(&sim->objs[i], &sim->pwms[i]);
+            }
+            OsalMemFree(sim);
+            return NULL;
+        }
+        sim->handles[i] = (DevHandle)&sim->pwms[i];
+    }
+    return sim;
+}
+
+static void PwmTestSimDestroy(struct PwmTestSim *sim)
+{
+    uint32_t i;
+
+    for (i = 0; i < PWM_TEST_SIM_CHANNELS; i++) {
+        PwmDeviceRemove(&sim->objs[i], &sim->pwms[i]);
+    }
+    OsalMemFree(sim);
+}
+
+static int32_t PwmTestSimCheckDuty(struct PwmTestSim *sim, const uint32_t *duty)
+{
+    uint32_t i;
+    struct PwmConfig cfg = {0};
+
+    for (i = 0; i < PWM_TEST_SIM_CHANNELS; i++) {
+        if (PwmGetConfig(sim->handles[i], &cfg) != HDF_SUCCESS || cfg.duty != duty[i] ||
+            sim->lastDuty[i] != duty[i]) {
+            HDF_LOGE("%s: pwm%u duty %u, controller %u, expect %u", __func__, sim->pwms[i].num,
+                cfg.duty, sim->lastDuty[i], duty[i]);
+            return HDF_FAILURE;
+        }
+    }
+    return HDF_SUCCESS;
+}
+
+static int32_t PwmGroupTest(struct PwmTest *test)
+{
+    int32_t ret = HDF_FAILURE;
+    uint32_t i;
+    uint32_t duty[PWM_TEST_SIM_CHANNELS] = {0};
+    struct PwmConfig cfgs[PWM_TEST_SIM_CHANNELS];
+    DevHandle twice[] = {NULL, NULL};
+    struct PwmTestSim *sim = PwmTestSimCreate(&g_pwmTestSimGroupOps);
+
+    (void)test;
+    HDF_LOGI("%s: enter.", __func__);
+    if (sim == NULL) {
+        return HDF_ERR_MALLOC_FAIL;
+    }
+    for (i = 0; i < PWM_TEST_SIM_CHANNELS; i++) {
+        cfgs[i] = sim->pwms[i].cfg;
+        cfgs[i].duty = PWM_TEST_SIM_PERIOD / (i + PWM_TEST_DUTY_DIV);
+        duty[i] = cfgs[i].duty;
+    }
+
+    // the controller latches the group in one call
+    if (PwmSetConfigGroup(sim->handles, cfgs, PWM_TEST_SIM_CHANNELS) != HDF_SUCCESS ||
+        sim->groupCalls != 1 || sim->setCalls != 0 || PwmTestSimCheckDuty(sim, duty) != HDF_SUCCESS) {
+        HDF_LOGE("%s: grouped update failed, %u group calls, %u set calls", __func__,
+            sim->groupCalls, sim->setCalls);
+        goto __OUT;
+    }
+
+    // without setConfigGroup the channels are set one by one and restored when one fails
+    for (i = 0; i < PWM_TEST_SIM_CHANNELS; i++) {
+        sim->pwms[i].method = &g_pwmTestSimOps;
+        cfgs[i].duty /= PWM_TEST_DUTY_DIV;
+    }
+    sim->failNum = sim->pwms[PWM_TEST_SIM_CHANNELS - 1].num;
+    if (PwmSetConfigGroup(sim->handles, cfgs, PWM_TEST_SIM_CHANNELS) != HDF_ERR_IO ||
+        sim->setCalls != PWM_TEST_SIM_CHANNELS * 2 - 1 || PwmTestSimCheckDuty(sim, duty) != HDF_SUCCESS) {
+        HDF_LOGE("%s: rollback failed, %u set calls", __func__, sim->setCalls);
+        goto __OUT;
+    }
+    sim->failNum = PWM_TEST_SIM_NO_FAIL;
+    sim->setCalls = 0;
+    if (PwmSetConfigGroup(sim->handles, cfgs, PWM_TEST_SIM_CHANNELS) != HDF_SUCCESS ||
+        sim->setCalls != PWM_TEST_SIM_CHANNELS) {
+        HDF_LOGE("%s: channel by channel update failed, %u set calls", __func__, sim->setCalls);
+        goto __OUT;
+    }
+
+    twice[0] = twice[1] = sim->handles[0];
+    if (PwmSetConfigGroup(twice, cfgs, sizeof(twice) / sizeof(twice[0])) != HDF_ERR_INVALID_PARAM ||
+        PwmSetConfigGroup(sim->handles, cfgs, PWM_GROUP_MAX + 1) != HDF_ERR_INVALID_PARAM) {
+        HDF_LOGE("%s: invalid group accepted", __func__);
+        goto __OUT;
+    }
+    ret = HDF_SUCCESS;
+    HDF_LOGI("%s: success.", __func__);
+__OUT:
+    PwmTestSimDestroy(sim);
+    return ret;
+}
+
+static int32_t PwmSequenceTest(struct PwmTest *test)
+{
+    int32_t ret = HDF_FAILURE;
+    uint32_t row;
+    uint32_t i;
+    uint32_t table[PWM_TEST_SEQ_STEPS * PWM_TEST_SIM_CHANNELS];
+    struct PwmSequence seq = {table, PWM_TEST_SEQ_STEPS, PWM_TEST_SEQ_STEP_US, PWM_TEST_SEQ_LOOPS};
+    struct PwmTestSim *sim = PwmTestSimCreate(&g_pwmTestSimGroupOps);
+
+    (void)test;
+    HDF_LOGI("%s: enter.", __func__);
+    if (sim == NULL) {
+        return HDF_ERR_MALLOC_FAIL;
+    }
+    // a ramp, each channel a step behind the one before
+    for (row = 0; row < PWM_TEST_SEQ_STEPS; row++) {
+        for (i = 0; i < PWM_TEST_SIM_CHANNELS; i++) {
+            table[row * PWM_TEST_SIM_CHANNELS + i] =
+                PWM_TEST_SIM_PERIOD / PWM_TEST_SEQ_STEPS * ((row + i) % PWM_TEST_SEQ_STEPS);
+        }
+    }
+
+    if (PwmStartSequence(sim->handles, PWM_TEST_SIM_CHANNELS, &seq) != HDF_SUCCESS) {
+        HDF_LOGE("%s: start sequence failed", __func__);
+        goto __OUT;
+    }
+    if (PwmStartSequence(&sim->handles[1], 1, &seq) != HDF_ERR_DEVICE_BUSY ||
+        PwmSetDuty(sim->handles[0], 0) != HDF_ERR_DEVICE_BUSY) {
+        HDF_LOGE("%s: a playing device accepted changes", __func__);
+        (void)PwmStopSequence(sim->handles[0]);
+        goto __OUT;
+    }
+    OsalMSleep(PWM_TEST_SEQ_STEPS * PWM_TEST_SEQ_LOOPS * PWM_TEST_SEQ_STEP_US / PWM_TEST_USEC_PER_MSEC +
+        PWM_TEST_SEQ_MARGIN_MS);
+    if (PwmStopSequence(sim->handles[PWM_TEST_SIM_CHANNELS - 1]) != HDF_SUCCESS) {
+        goto __OUT;
+    }
+    // steps late by more than a step are skipped, so a loaded system may play fewer
+    if (sim->groupCalls == 0 || sim->groupCalls > PWM_TEST_SEQ_STEPS * PWM_TEST_SEQ_LOOPS || sim->setCalls != 0 ||
+        PwmTestSimCheckDuty(sim, sim->lastDuty) != HDF_SUCCESS) {
+        HDF_LOGE("%s: played %u steps, %u set calls", __func__, sim->groupCalls, sim->setCalls);
+        goto __OUT;
+    }
+    HDF_LOGI("%s: %u steps of %uus, mean gap %lluus, max gap %lluus", __func__, sim->groupCalls,
+        PWM_TEST_SEQ_STEP_US, (unsigned long long)(sim->gapSumUs / ((sim->groupCalls > 1) ? sim->groupCalls - 1 : 1)),
+        (unsigned long long)sim->gapMaxUs);
+
+    // a sequence without a loop limit runs until stopped, then the devices take changes again
+    seq.loops = 0;
+    table[0] = PWM_TEST_SIM_PERIOD + 1;
+    if (PwmStartSequence(sim->handles, PWM_TEST_SIM_CHANNELS, &seq) == HDF_SUCCESS) {
+        HDF_LOGE("%s: duty beyond the period accepted", __func__);
+        (void)PwmStopSequence(sim->handles[0]);
+        goto __OUT;
+    }
+    table[0] = 0;
+    sim->groupCalls = 0;
+    if (PwmStartSequence(sim->handles, PWM_TEST_SIM_CHANNELS, &seq) != HDF_SUCCESS) {
+        goto __OUT;
+    }
+    OsalMSleep(PWM_TEST_SEQ_MARGIN_MS);
+    if (PwmStopSequence(sim->handles[0]) != HDF_SUCCESS || sim->groupCalls == 0 ||
+        PwmSetDuty(sim->handles[0], 0) != HDF_SUCCESS) {
+        HDF_LOGE("%s: endless sequence failed, played %u steps", __func__, sim->groupCalls);
+        goto __OUT;
+    }
+    ret = HDF_SUCCESS;
+    HDF_LOGI("%s: success.", __func__);
+__OUT:
+    PwmTestSimDestroy(sim);
+    return ret;
+}
+
 static int32_t PwmTestAll(struct PwmTest *test)
 {
     int32_t total = 0;
@@ -325,6 +592,13 @@ static int32_t PwmTestEntry(struct PwmTest *test, int32_t cmd)
     if (test == NULL) {
         return HDF_ERR_INVALID_OBJECT;
     }
+    // The simulated controller cases do not use the configured device.
+    if (cmd == PWM_GROUP_TEST) {
+        return PwmGroupTest(test);
+    }
+    if (cmd == PWM_SEQUENCE_TEST) {
+        return PwmSequenceTest(test);
+    }
     OsalMSleep(SEQ_OUTPUT_DELAY);
     test->handle = PwmTestGetHandle(test);
     if (test->handle == NULL) {
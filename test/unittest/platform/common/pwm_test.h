@@ -22,6 +22,8 @@ enum PwmTestCmd {
     PWM_GET_CONFIG_TEST,
     PWM_RELIABILITY_TEST,
     PWM_TEST_ALL,
+    PWM_GROUP_TEST,
+    PWM_SEQUENCE_TEST,
 };
 
 struct PwmTest {
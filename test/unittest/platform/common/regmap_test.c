@@ -0,0 +1,295 @@
+/*
+ * Copyright (c) 2021 Huawei Device Co., Ltd.
+ *
+ * HDF is dual licensed: you can use it either under the terms of
+ * the GPL, or the BSD license, at your option.
+ * See the LICENSE file in the root of this repository for complete details.
+ */
+
+#include "regmap_test.h"
+#include "device_resource_if.h"
+#include "hdf_base.h"
+#include "hdf_log.h"
+#include "i2c_if.h"
+#include "regmap_core.h"
+#include "securec.h"
+
+#define HDF_LOG_TAG regmap_test_c
+
+#define REGMAP_TEST_MAX_REG      0xff
+#define REGMAP_TEST_STATUS_REG   0x05 /* in the volatile range */
+#define REGMAP_TEST_CTRL_REG     0x20
+#define REGMAP_TEST_BULK_NUM     16
+#define REGMAP_TEST_RUN1_REG     0x40
+#define REGMAP_TEST_RUN1_NUM     8
+#define REGMAP_TEST_RUN2_REG     0x50
+#define REGMAP_TEST_RUN2_NUM     2
+#define REGMAP_TEST_MODE_MASK    0x0f
+#define REGMAP_TEST_MODE_VAL     0x05
+#define REGMAP_TEST_UNCACHED_NUM 12 /* bus transactions of RegmapTestCacheOps without a cache */
+#define REGMAP_TEST_CACHED_NUM   6
+#define REGMAP_TEST_SKIPPED_NUM  2
+#define REGMAP_TEST_SYNC_NUM     2  /* one burst per run of dirty registers */
+#define REGMAP_TEST_SYNC_READS   2
+#define REGMAP_TEST_RAW_VAL      0xa0
+
+static const struct RegmapRange g_regmapTestVolatile[] = {
+    { 0x00, 0x0f },
+};
+
+static const struct RegmapConfig g_regmapTestConfig = {
+    .regBytes = 1,
+    .valBytes = 1,
+    .maxReg = REGMAP_TEST_MAX_REG,
+    .volatileRanges = g_regmapTestVolatile,
+    .volatileNum = sizeof(g_regmapTestVolatile) / sizeof(g_regmapTestVolatile[0]),
+};
+
+struct RegmapTestFunc {
+    enum RegmapTestCmd type;
+    int32_t (*Func)(struct RegmapTester *tester, struct Regmap *map, DevHandle handle);
+};
+
+/* raw access to the register file, not seen by the regmap counters */
+static int32_t RegmapTestRawRead(struct RegmapTester *tester, DevHandle handle, uint8_t reg, uint8_t *buf,
+    uint16_t len)
+{
+    struct I2cMsg msgs[] = {
+        { .addr = tester->devAddr, .buf = &reg, .len = sizeof(reg), .flags = 0 },
+        { .addr = tester->devAddr, .buf = buf, .len = len, .flags = I2C_FLAG_READ },
+    };
+
+    return (I2cTransfer(handle, msgs, sizeof(msgs) / sizeof(msgs[0])) == sizeof(msgs) / sizeof(msgs[0])) ?
+        HDF_SUCCESS : HDF_FAILURE;
+}
+
+static int32_t RegmapTestRawFill(struct RegmapTester *tester, DevHandle handle, uint8_t reg, uint8_t val,
+    uint16_t len)
+{
+    uint16_t i;
+    uint8_t buf[REGMAP_TEST_BULK_NUM + 1];
+    struct I2cMsg msg = { .addr = tester->devAddr, .buf = buf, .len = len + 1, .flags = 0 };
+
+    buf[0] = reg;
+    for (i = 0; i < len && i < REGMAP_TEST_BULK_NUM; i++) {
+        buf[i + 1] = val + i;
+    }
+    return (I2cTransfer(handle, &msg, 1) == 1) ? HDF_SUCCESS : HDF_FAILURE;
+}
+
+/* the access pattern of a driver reconfiguring a chip */
+static int32_t RegmapTestCacheOps(struct Regmap *map, uint32_t *vals)
+{
+    uint32_t val;
+
+    if (RegmapRead(map, REGMAP_TEST_CTRL_REG, &val) != HDF_SUCCESS ||
+        RegmapRead(map, REGMAP_TEST_CTRL_REG, &val) != HDF_SUCCESS ||
+        RegmapUpdateBits(map, REGMAP_TEST_CTRL_REG, REGMAP_TEST_MODE_MASK, REGMAP_TEST_MODE_VAL) != HDF_SUCCESS ||
+        RegmapUpdateBits(map, REGMAP_TEST_CTRL_REG, REGMAP_TEST_MODE_MASK, REGMAP_TEST_MODE_VAL) != HDF_SUCCESS ||
+        RegmapWrite(map, REGMAP_TEST_CTRL_REG + 1, REGMAP_TEST_MODE_VAL) != HDF_SUCCESS ||
+        RegmapWrite(map, REGMAP_TEST_CTRL_REG + 1, REGMAP_TEST_MODE_VAL) != HDF_SUCCESS ||
+        RegmapRead(map, REGMAP_TEST_STATUS_REG, &val) != HDF_SUCCESS ||
+        RegmapRead(map, REGMAP_TEST_STATUS_REG, &val) != HDF_SUCCESS ||
+        RegmapBulkRead(map, REGMAP_TEST_CTRL_REG, vals, REGMAP_TEST_BULK_NUM) != HDF_SUCCESS ||
+        RegmapBulkRead(map, REGMAP_TEST_CTRL_REG, vals, REGMAP_TEST_BULK_NUM) != HDF_SUCCESS) {
+        return HDF_FAILURE;
+    }
+    return HDF_SUCCESS;
+}
+
+static int32_t RegmapTestCache(struct RegmapTester *tester, struct Regmap *map, DevHandle handle)
+{
+    uint8_t raw[REGMAP_TEST_BULK_NUM];
+    uint32_t vals[REGMAP_TEST_BULK_NUM];
+    uint32_t i;
+    uint32_t busNum;
+    struct RegmapStats stats;
+
+    if (RegmapTestRawFill(tester, handle, REGMAP_TEST_CTRL_REG, 1, REGMAP_TEST_BULK_NUM) != HDF_SUCCESS ||
+        RegmapTestCacheOps(map, vals) != HDF_SUCCESS ||
+        RegmapTestRawRead(tester, handle, REGMAP_TEST_CTRL_REG, raw, sizeof(raw)) != HDF_SUCCESS) {
+        HDF_LOGE("%s: access failed", __func__);
+        return HDF_FAILURE;
+    }
+    for (i = 0; i < REGMAP_TEST_BULK_NUM; i++) {
+        if (vals[i] != raw[i]) {
+            HDF_LOGE("%s: reg 0x%x cached 0x%x, device 0x%x", __func__, REGMAP_TEST_CTRL_REG + i, vals[i], raw[i]);
+            return HDF_FAILURE;
+        }
+    }
+    if ((raw[0] & REGMAP_TEST_MODE_MASK) != REGMAP_TEST_MODE_VAL || raw[1] != REGMAP_TEST_MODE_VAL) {
+        HDF_LOGE("%s: writes not on the device", __func__);
+        return HDF_FAILURE;
+    }
+
+    RegmapGetStats(map, &stats);
+    busNum = stats.busReads + stats.busWrites;
+    HDF_LOGI("%s: %u bus transactions instead of %d, hits %u, misses %u, skipped writes %u", __func__, busNum,
+        REGMAP_TEST_UNCACHED_NUM, stats.hits, stats.misses, stats.skippedWrites);
+    /* first read, one write of the update, one write, two status reads and the first bulk read */
+    if (busNum != REGMAP_TEST_CACHED_NUM || stats.skippedWrites != REGMAP_TEST_SKIPPED_NUM) {
+        return HDF_FAILURE;
+    }
+    return HDF_SUCCESS;
+}
+
+static int32_t RegmapTestSync(struct RegmapTester *tester, struct Regmap *map, DevHandle handle)
+{
+    uint8_t raw[REGMAP_TEST_RUN1_NUM];
+    uint32_t vals[REGMAP_TEST_RUN2_NUM + 1];
+    uint32_t i;
+    uint32_t val;
+    struct RegmapStats stats;
+
+    if (RegmapTestRawFill(tester, handle, REGMAP_TEST_RUN2_REG, REGMAP_TEST_RAW_VAL, REGMAP_TEST_RUN2_NUM + 1) !=
+        HDF_SUCCESS) {
+        return HDF_FAILURE;
+    }
+    RegmapCacheOnly(map, true);
+    for (i = 0; i < REGMAP_TEST_RUN1_NUM; i++) {
+        (void)RegmapWrite(map, REGMAP_TEST_RUN1_REG + i, i);
+    }
+    for (i = 0; i < REGMAP_TEST_RUN2_NUM; i++) {
+        (void)RegmapWrite(map, REGMAP_TEST_RUN2_REG + i, i);
+    }
+    RegmapCacheOnly(map, false);
+    /* a bulk read reaching past the dirty run goes to the bus, the pending writes must survive it */
+    if (RegmapBulkRead(map, REGMAP_TEST_RUN2_REG, vals, REGMAP_TEST_RUN2_NUM + 1) != HDF_SUCCESS ||
+        vals[0] != 0 || vals[1] != 1 || vals[REGMAP_TEST_RUN2_NUM] != REGMAP_TEST_RAW_VAL + REGMAP_TEST_RUN2_NUM) {
+        HDF_LOGE("%s: bulk read over dirty registers got 0x%x 0x%x", __func__, vals[0], vals[1]);
+        return HDF_FAILURE;
+    }
+    if (RegmapSync(map) != HDF_SUCCESS) {
+        HDF_LOGE("%s: sync failed", __func__);
+        return HDF_FAILURE;
+    }
+
+    RegmapGetStats(map, &stats);
+    HDF_LOGI("%s: %u dirty registers synced in %u bus writes", __func__,
+        REGMAP_TEST_RUN1_NUM + REGMAP_TEST_RUN2_NUM, stats.busWrites);
+    if (stats.busWrites != REGMAP_TEST_SYNC_NUM ||
+        RegmapTestRawRead(tester, handle, REGMAP_TEST_RUN1_REG, raw, sizeof(raw)) != HDF_SUCCESS) {
+        return HDF_FAILURE;
+    }
+    for (i = 0; i < REGMAP_TEST_RUN1_NUM; i++) {
+        if (raw[i] != i) {
+            HDF_LOGE("%s: reg 0x%x is 0x%x on the device", __func__, REGMAP_TEST_RUN1_REG + i, raw[i]);
+            return HDF_FAILURE;
+        }
+    }
+    if (RegmapTestRawRead(tester, handle, REGMAP_TEST_RUN2_REG, raw, REGMAP_TEST_RUN2_NUM) != HDF_SUCCESS) {
+        return HDF_FAILURE;
+    }
+    for (i = 0; i < REGMAP_TEST_RUN2_NUM; i++) {
+        if (raw[i] != i) {
+            HDF_LOGE("%s: reg 0x%x is 0x%x on the device", __func__, REGMAP_TEST_RUN2_REG + i, raw[i]);
+            return HDF_FAILURE;
+        }
+    }
+
+    /* after a drop the value comes from the bus again */
+    RegmapCacheDrop(map);
+    if (RegmapRead(map, REGMAP_TEST_RUN2_REG + 1, &val) != HDF_SUCCESS || val != 1) {
+        return HDF_FAILURE;
+    }
+    RegmapGetStats(map, &stats);
+    /* the bulk read above and this one */
+    return (stats.busReads == REGMAP_TEST_SYNC_READS) ? HDF_SUCCESS : HDF_FAILURE;
+}
+
+static struct RegmapTestFunc g_regmapTestFunc[] = {
+    { REGMAP_TEST_CACHE, RegmapTestCache },
+    { REGMAP_TEST_SYNC, RegmapTestSync },
+};
+
+static int32_t RegmapTestEntry(struct RegmapTester *tester, int32_t cmd)
+{
+    uint32_t i;
+    int32_t ret = HDF_ERR_NOT_SUPPORT;
+    DevHandle handle = NULL;
+    struct Regmap *map = NULL;
+
+    if (tester == NULL) {
+        HDF_LOGE("%s: tester is NULL", __func__);
+        return HDF_ERR_INVALID_OBJECT;
+    }
+    handle = I2cOpen((int16_t)tester->busNum);
+    if (handle == NULL) {
+        HDF_LOGE("%s: open i2c bus %u failed", __func__, tester->busNum);
+        return HDF_FAILURE;
+    }
+    /* a new map per case, so the counters start from 0 */
+    map = RegmapInitI2c(handle, tester->devAddr, &g_regmapTestConfig);
+    if (map == NULL) {
+        I2cClose(handle);
+        return HDF_FAILURE;
+    }
+    for (i = 0; i < sizeof(g_regmapTestFunc) / sizeof(g_regmapTestFunc[0]); i++) {
+        if (cmd == g_regmapTestFunc[i].type && g_regmapTestFunc[i].Func != NULL) {
+            ret = g_regmapTestFunc[i].Func(tester, map, handle);
+            break;
+        }
+    }
+    if (ret == HDF_ERR_NOT_SUPPORT) {
+        HDF_LOGE("%s: cmd %d not supported", __func__, cmd);
+    }
+    RegmapExit(map);
+    I2cClose(handle);
+    return ret;
+}
+
+static int32_t RegmapTestBind(struct HdfDeviceObject *device)
+{
+    static struct RegmapTester tester;
+
+    if (device == NULL) {
+        HDF_LOGE("%s: device is null!", __func__);
+        return HDF_ERR_IO;
+    }
+
+    device->service = &tester.service;
+    HDF_LOGI("%s: REGMAP_TEST service init success!", __func__);
+    return HDF_SUCCESS;
+}
+
+static int32_t RegmapTestInit(struct HdfDeviceObject *device)
+{
+    struct RegmapTester *tester = NULL;
+    struct DeviceResourceIface *drsOps = NULL;
+
+    if (device == NULL || device->service == NULL || device->property == NULL) {
+        HDF_LOGE("%s: invalid parameter", __func__);
+        return HDF_ERR_INVALID_PARAM;
+    }
+
+    drsOps = DeviceResourceGetIfaceInstance(HDF_CONFIG_SOURCE);
+    if (drsOps == NULL || drsOps->GetUint16 == NULL) {
+        HDF_LOGE("%s: invalid drs ops", __func__);
+        return HDF_FAILURE;
+    }
+    tester = (struct RegmapTester *)device->service;
+    if (drsOps->GetUint16(device->property, "bus_num", &tester->busNum, 0) != HDF_SUCCESS ||
+        drsOps->GetUint16(device->property, "dev_addr", &tester->devAddr, 0) != HDF_SUCCESS) {
+        HDF_LOGE("%s: read bus_num or dev_addr failed", __func__);
+        return HDF_FAILURE;
+    }
+    tester->TestEntry = RegmapTestEntry;
+    HDF_LOGI("%s: success", __func__);
+    return HDF_SUCCESS;
+}
+
+static void RegmapTestRelease(struct HdfDeviceObject *device)
+{
+    if (device != NULL) {
+        device->service = NULL;
+    }
+}
+
+struct HdfDriverEntry g_regmapTestEntry = {
+    .moduleVersion = 1,
+    .Bind = RegmapTestBind,
+    .Init = RegmapTestInit,
+    .Release = RegmapTestRelease,
+    .moduleName = "PLATFORM_REGMAP_TEST",
+};
+HDF_INIT(g_regmapTestEntry);
@@ -0,0 +1,33 @@
+/*
+ * Copyright (c) 2021 Huawei Device Co., Ltd.
+ *
+ * HDF is dual licensed: you can use it either under the terms of
+ * the GPL, or the BSD license, at your option.
+ * See the LICENSE file in the root of this repository for complete details.
+ */
+
+#ifndef REGMAP_TEST_H
+#define REGMAP_TEST_H
+
+#include "hdf_device_desc.h"
+#include "hdf_platform.h"
+
+enum RegmapTestCmd {
+    REGMAP_TEST_CACHE = 0,
+    REGMAP_TEST_SYNC,
+};
+
+struct RegmapTester {
+    struct IDeviceIoService service;
+    struct HdfDeviceObject *device;
+    int32_t (*TestEntry)(struct RegmapTester *tester, int32_t cmd);
+    uint16_t busNum;  /* a virtual i2c controller, whose device is a plain register file */
+    uint16_t devAddr;
+};
+
+static inline struct RegmapTester *GetRegmapTester(void)
+{
+    return (struct RegmapTester *)DevSvcManagerClntGetService("REGMAP_TEST");
+}
+
+#endif /* REGMAP_TEST_H */
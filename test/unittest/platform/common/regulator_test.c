@@ -9,12 +9,21 @@
 #include "regulator_test.h"
 #include "device_resource_if.h"
 #include "hdf_log.h"
-#include "regulator_if.h"
+#include "osal_mem.h"
 #include "osal_thread.h"
 #include "osal_time.h"
+#include "regulator_core.h"
+#include "regulator_if.h"
+#include "securec.h"
 
 #define HDF_LOG_TAG regulator_test_c
 
+#define REGULATOR_TREE_FANOUT       4
+#define REGULATOR_TREE_NAME_LEN     24
+#define REGULATOR_TREE_PROFILE_NUM  21
+#define REGULATOR_TREE_BENCH_NUM    500
+#define REGULATOR_TEST_USEC_PER_SEC 1000000
+
 struct RegulatorTestFunc {
     enum RegulatorTestCmd type;
     int32_t (*Func)(struct RegulatorTest *test);
@@ -251,6 +260,292 @@ int32_t RegulatorTestReliability(struct RegulatorTest *test)
     return HDF_SUCCESS;
 }
 
+/* synthetic trees: node i is supplied by node (i - 1) / REGULATOR_TREE_FANOUT, node 0 is the root */
+static struct RegulatorNode *g_treeNodes[REGULATOR_TREE_BENCH_NUM];
+static char g_treeNames[REGULATOR_TREE_BENCH_NUM][REGULATOR_TREE_NAME_LEN];
+static uint32_t g_treeNum;
+static uint32_t g_treeOrderErrors;
+
+static uint32_t RegulatorTreeTestParent(uint32_t index)
+{
+    return (index - 1) / REGULATOR_TREE_FANOUT;
+}
+
+/* a rail may only come up with its supply already on */
+static int32_t RegulatorTreeTestEnable(struct RegulatorNode *node)
+{
+    uint32_t index = (uint32_t)(uintptr_t)node->priv;
+
+    if (index != 0 && g_treeNodes[RegulatorTreeTestParent(index)]->regulatorInfo.status != REGULATOR_STATUS_ON) {
+        g_treeOrderErrors++;
+    }
+    return HDF_SUCCESS;
+}
+
+/* and may only go down with all of its consumers already off */
+static int32_t RegulatorTreeTestDisable(struct RegulatorNode *node)
+{
+    uint32_t index = (uint32_t)(uintptr_t)node->priv;
+    uint32_t child;
+
+    for (child = index * REGULATOR_TREE_FANOUT + 1;
+        child <= index * REGULATOR_TREE_FANOUT + REGULATOR_TREE_FANOUT && child < g_treeNum; child++) {
+        if (g_treeNodes[child]->regulatorInfo.status == REGULATOR_STATUS_ON) {
+            g_treeOrderErrors++;
+        }
+    }
+    return HDF_SUCCESS;
+}
+
+static int32_t RegulatorTreeTestGetStatus(struct RegulatorNode *node, uint32_t *status)
+{
+    *status = node->regulatorInfo.status;
+    return HDF_SUCCESS;
+}
+
+static struct RegulatorMethod g_treeTestOps = {
+    .enable = RegulatorTreeTestEnable,
+    .disable = RegulatorTreeTestDisable,
+    .getStatus = RegulatorTreeTestGetStatus,
+};
+
+static void RegulatorTreeTestDestroy(void)
+{
+    // leaves first, a regulator still supplying consumers can not be removed
+    while (g_treeNum > 0) {
+        g_treeNum--;
+        if (RegulatorNodeRemove(g_treeNames[g_treeNum]) != HDF_SUCCESS) {
+            HDF_LOGE("%s: remove %s fail", __func__, g_treeNames[g_treeNum]);
+            OsalMemFree(g_treeNodes[g_treeNum]);
+        }
+        g_treeNodes[g_treeNum] = NULL;
+    }
+}
+
+static int32_t RegulatorTreeTestCreate(uint32_t num)
+{
+    uint32_t i;
+    struct RegulatorNode *node = NULL;
+
+    g_treeNum = 0;
+    g_treeOrderErrors = 0;
+    for (i = 0; i < num; i++) {
+        if (sprintf_s(g_treeNames[i], REGULATOR_TREE_NAME_LEN, "regulator_tree_%u", i) < 0) {
+            RegulatorTreeTestDestroy();
+            return HDF_FAILURE;
+        }
+        node = (struct RegulatorNode *)OsalMemCalloc(sizeof(*node));
+        if (node == NULL) {
+            RegulatorTreeTestDestroy();
+            return HDF_ERR_MALLOC_FAIL;
+        }
+        node->regulatorInfo.name = g_treeNames[i];
+        node->regulatorInfo.parentName = (i == 0) ? NULL : g_treeNames[RegulatorTreeTestParent(i)];
+        node->ops = &g_treeTestOps;
+        node->priv = (void *)(uintptr_t)i;
+        if (RegulatorNodeAdd(node) != HDF_SUCCESS) {
+            HDF_LOGE("%s: add %s fail", __func__, g_treeNames[i]);
+            OsalMemFree(node);
+            RegulatorTreeTestDestroy();
+            return HDF_FAILURE;
+        }
+        g_treeNodes[i] = node;
+        g_treeNum++;
+    }
+    return HDF_SUCCESS;
+}
+
+static int32_t RegulatorTreeTestCheck(const uint32_t *onList, uint32_t onNum)
+{
+    uint32_t i;
+    uint32_t j;
+    uint32_t expect;
+
+    for (i = 0; i < g_treeNum; i++) {
+        expect = REGULATOR_STATUS_OFF;
+        for (j = 0; j < onNum; j++) {
+            if (onList[j] == i) {
+                expect = REGULATOR_STATUS_ON;
+                break;
+            }
+        }
+        if (g_treeNodes[i]->regulatorInfo.status != expect) {
+            HDF_LOGE("%s: %s status %u, expect %u", __func__, g_treeNames[i],
+                g_treeNodes[i]->regulatorInfo.status, expect);
+            return HDF_FAILURE;
+        }
+    }
+    if (g_treeOrderErrors != 0) {
+        HDF_LOGE("%s: %u rails switched out of order", __func__, g_treeOrderErrors);
+        return HDF_FAILURE;
+    }
+    return HDF_SUCCESS;
+}
+
+static int32_t RegulatorTreeTestProfile(void)
+{
+    static const uint32_t onFirst[] = { 0, 1, 4, 5, 6, 7, 8, 20 };
+    static const uint32_t onSecond[] = { 0, 2, 4, 9, 20 };
+    struct RegulatorProfileEntry bad[] = {
+        { g_treeNames[5], REGULATOR_STATUS_ON },
+        { "regulator_tree_none", REGULATOR_STATUS_ON },
+    };
+    // leaves listed before their supplies, and in no particular order
+    struct RegulatorProfileEntry first[] = {
+        { g_treeNames[20], REGULATOR_STATUS_ON },
+        { g_treeNames[8], REGULATOR_STATUS_ON },
+        { g_treeNames[5], REGULATOR_STATUS_ON },
+        { g_treeNames[7], REGULATOR_STATUS_ON },
+        { g_treeNames[6], REGULATOR_STATUS_ON },
+    };
+    // the enable comes first here, disables must still be applied before it
+    struct RegulatorProfileEntry second[] = {
+        { g_treeNames[9], REGULATOR_STATUS_ON },
+        { g_treeNames[5], REGULATOR_STATUS_OFF },
+        { g_treeNames[6], REGULATOR_STATUS_OFF },
+        { g_treeNames[7], REGULATOR_STATUS_OFF },
+        { g_treeNames[8], REGULATOR_STATUS_OFF },
+    };
+
+    if (RegulatorApplyProfile(bad, sizeof(bad) / sizeof(bad[0])) == HDF_SUCCESS ||
+        RegulatorTreeTestCheck(NULL, 0) != HDF_SUCCESS) {
+        HDF_LOGE("%s: invalid profile applied", __func__);
+        return HDF_FAILURE;
+    }
+
+    if (RegulatorApplyProfile(first, sizeof(first) / sizeof(first[0])) != HDF_SUCCESS ||
+        RegulatorTreeTestCheck(onFirst, sizeof(onFirst) / sizeof(onFirst[0])) != HDF_SUCCESS) {
+        HDF_LOGE("%s: first profile fail", __func__);
+        return HDF_FAILURE;
+    }
+
+    // 1 loses all of its consumers and goes down, 0 still supplies 4 and stays up
+    if (RegulatorApplyProfile(second, sizeof(second) / sizeof(second[0])) != HDF_SUCCESS ||
+        RegulatorTreeTestCheck(onSecond, sizeof(onSecond) / sizeof(onSecond[0])) != HDF_SUCCESS) {
+        HDF_LOGE("%s: second profile fail", __func__);
+        return HDF_FAILURE;
+    }
+    return HDF_SUCCESS;
+}
+
+static int32_t RegulatorProfileTest(struct RegulatorTest *test)
+{
+    int32_t ret;
+
+    (void)test;
+    ret = RegulatorTreeTestCreate(REGULATOR_TREE_PROFILE_NUM);
+    if (ret != HDF_SUCCESS) {
+        HDF_LOGE("%s: create tree fail, ret %d", __func__, ret);
+        return ret;
+    }
+    ret = RegulatorTreeTestProfile();
+    RegulatorTreeTestDestroy();
+    return ret;
+}
+
+static uint64_t RegulatorTestElapsedUs(const OsalTimespec *start)
+{
+    OsalTimespec now;
+    OsalTimespec diff;
+
+    (void)OsalGetTime(&now);
+    (void)OsalDiffTime(start, &now, &diff);
+    return (uint64_t)diff.sec * REGULATOR_TEST_USEC_PER_SEC + diff.usec;
+}
+
+static int32_t RegulatorTreeBenchProfile(uint32_t status, uint64_t *us)
+{
+    int32_t ret;
+    uint32_t i;
+    OsalTimespec start;
+    struct RegulatorProfileEntry *entries = NULL;
+
+    entries = (struct RegulatorProfileEntry *)OsalMemCalloc(sizeof(*entries) * g_treeNum);
+    if (entries == NULL) {
+        return HDF_ERR_MALLOC_FAIL;
+    }
+    for (i = 0; i < g_treeNum; i++) {
+        entries[i].name = g_treeNames[i];
+        entries[i].status = status;
+    }
+    (void)OsalGetTime(&start);
+    ret = RegulatorApplyProfile(entries, g_treeNum);
+    *us = RegulatorTestElapsedUs(&start);
+    OsalMemFree(entries);
+    return ret;
+}
+
+static int32_t RegulatorTreeBench(void)
+{
+    uint32_t i;
+    uint64_t openUs;
+    uint64_t leafUs;
+    uint64_t offUs;
+    uint64_t onUs;
+    OsalTimespec start;
+    uint32_t firstLeaf = (g_treeNum - 1 + REGULATOR_TREE_FANOUT - 1) / REGULATOR_TREE_FANOUT;
+
+    (void)OsalGetTime(&start);
+    for (i = 0; i < g_treeNum; i++) {
+        if (RegulatorNodeOpen(g_treeNames[i]) != g_treeNodes[i]) {
+            HDF_LOGE("%s: open %s fail", __func__, g_treeNames[i]);
+            return HDF_FAILURE;
+        }
+    }
+    openUs = RegulatorTestElapsedUs(&start);
+
+    // every leaf brings up its whole supply chain
+    (void)OsalGetTime(&start);
+    for (i = firstLeaf; i < g_treeNum; i++) {
+        if (RegulatorNodeEnable(g_treeNodes[i]) != HDF_SUCCESS) {
+            return HDF_FAILURE;
+        }
+    }
+    leafUs = RegulatorTestElapsedUs(&start);
+
+    if (RegulatorTreeBenchProfile(REGULATOR_STATUS_OFF, &offUs) != HDF_SUCCESS ||
+        RegulatorTreeTestCheck(NULL, 0) != HDF_SUCCESS) {
+        HDF_LOGE("%s: all off profile fail", __func__);
+        return HDF_FAILURE;
+    }
+    if (RegulatorTreeBenchProfile(REGULATOR_STATUS_ON, &onUs) != HDF_SUCCESS || g_treeOrderErrors != 0) {
+        HDF_LOGE("%s: all on profile fail", __func__);
+        return HDF_FAILURE;
+    }
+    for (i = 0; i < g_treeNum; i++) {
+        if (g_treeNodes[i]->regulatorInfo.status != REGULATOR_STATUS_ON) {
+            HDF_LOGE("%s: %s not on", __func__, g_treeNames[i]);
+            return HDF_FAILURE;
+        }
+    }
+
+    HDF_LOGI("%s: %u rails, open %llu us, leaf enable %llu us, profile off %llu us, profile on %llu us",
+        __func__, g_treeNum, (unsigned long long)openUs, (unsigned long long)leafUs,
+        (unsigned long long)offUs, (unsigned long long)onUs);
+    return (RegulatorTreeBenchProfile(REGULATOR_STATUS_OFF, &offUs) == HDF_SUCCESS) ? HDF_SUCCESS : HDF_FAILURE;
+}
+
+static int32_t RegulatorTreeBenchTest(struct RegulatorTest *test)
+{
+    int32_t ret;
+    uint64_t addUs;
+    OsalTimespec start;
+
+    (void)test;
+    (void)OsalGetTime(&start);
+    ret = RegulatorTreeTestCreate(REGULATOR_TREE_BENCH_NUM);
+    addUs = RegulatorTestElapsedUs(&start);
+    if (ret != HDF_SUCCESS) {
+        HDF_LOGE("%s: create tree fail, ret %d", __func__, ret);
+        return ret;
+    }
+    HDF_LOGI("%s: add %u rails %llu us", __func__, g_treeNum, (unsigned long long)addUs);
+
+    ret = RegulatorTreeBench();
+    RegulatorTreeTestDestroy();
+    return ret;
+}
+
 static struct RegulatorTestFunc g_regulatorTestFunc[] = {
     {REGULATOR_ENABLE_TEST, RegulatorEnableTest},
     {REGULATOR_DISABLE_TEST, RegulatorDisableTest},
@@ -262,6 +557,8 @@ static struct RegulatorTestFunc g_regulatorTestFunc[] = {
     {REGULATOR_GET_STATUS_TEST, RegulatorGetStatusTest},
     {REGULATOR_MULTI_THREAD_TEST, RegulatorTestMultiThread},
     {REGULATOR_RELIABILITY_TEST, RegulatorTestReliability},
+    {REGULATOR_PROFILE_TEST, RegulatorProfileTest},
+    {REGULATOR_TREE_BENCH_TEST, RegulatorTreeBenchTest},
 };
 
 static int32_t RegulatorTestEntry(struct RegulatorTest *test, int32_t cmd)
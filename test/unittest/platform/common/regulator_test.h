@@ -36,6 +36,8 @@ enum RegulatorTestCmd {
     REGULATOR_GET_STATUS_TEST,
     REGULATOR_MULTI_THREAD_TEST,
     REGULATOR_RELIABILITY_TEST,
+    REGULATOR_PROFILE_TEST,
+    REGULATOR_TREE_BENCH_TEST,
 };
 
 #define REGULATOR_TEST_STACK_SIZE    (1024 * 100)
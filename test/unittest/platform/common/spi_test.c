@@ -9,8 +9,12 @@
 #include "device_resource_if.h"
 #include "hdf_base.h"
 #include "hdf_log.h"
+#include "osal_atomic.h"
 #include "osal_mem.h"
+#include "osal_sem.h"
 #include "osal_time.h"
+#include "securec.h"
+#include "spi_core.h"
 #include "spi_if.h"
 #include "spi_test.h"
 
@@ -20,6 +24,14 @@
 #define SPI_TEST_8BITS  8
 #define SPI_TEST_16BITS 16
 
+#define SPI_BENCH_DEV_NUM      4
+#define SPI_BENCH_ROUNDS       256       /* transfers per device */
+#define SPI_BENCH_LEN          16
+#define SPI_BENCH_SPEED        10000000  /* of the first device, halved for each next one */
+#define SPI_BENCH_WAIT_MS      1000
+#define SPI_BENCH_USEC_PER_SEC 1000000
+#define SPI_BENCH_NAME_LEN     32
+
 struct SpiTestFunc {
     enum SpiTestCmd type;
     int32_t (*Func)(struct SpiTest *test);
@@ -321,6 +333,229 @@ static int32_t SpiTestAll(struct SpiTest *test)
     return HDF_SUCCESS;
 }
 
+struct SpiBenchReq {
+    struct SpiAsyncMsg async;
+    struct SpiMsg msg;
+    uint8_t wbuf[SPI_BENCH_LEN];
+    uint8_t rbuf[SPI_BENCH_LEN];
+};
+
+struct SpiBench {
+    DevHandle handles[SPI_BENCH_DEV_NUM];
+    struct SpiBenchReq *reqs;
+    struct SpiCntlr *cntlr;
+    struct OsalSem done;
+    OsalAtomic completed;
+    OsalAtomic failed;
+};
+
+static uint64_t SpiBenchElapsedUs(const OsalTimespec *start)
+{
+    OsalTimespec now;
+    OsalTimespec diff;
+
+    (void)OsalGetTime(&now);
+    (void)OsalDiffTime(start, &now, &diff);
+    return (uint64_t)diff.sec * SPI_BENCH_USEC_PER_SEC + diff.usec;
+}
+
+static void SpiBenchCallback(struct SpiAsyncMsg *async, int32_t status)
+{
+    struct SpiBenchReq *req = (struct SpiBenchReq *)async;
+    struct SpiBench *bench = (struct SpiBench *)async->priv;
+
+    if (status != HDF_SUCCESS || memcmp(req->wbuf, req->rbuf, SPI_BENCH_LEN) != 0) {
+        OsalAtomicInc(&bench->failed);
+    }
+    OsalAtomicInc(&bench->completed);
+    (void)OsalSemPost(&bench->done);
+}
+
+static void SpiBenchResetReqs(struct SpiBench *bench)
+{
+    uint32_t i;
+    uint32_t j;
+    struct SpiBenchReq *req = NULL;
+
+    for (i = 0; i < SPI_BENCH_DEV_NUM * SPI_BENCH_ROUNDS; i++) {
+        req = &bench->reqs[i];
+        for (j = 0; j < SPI_BENCH_LEN; j++) {
+            req->wbuf[j] = (uint8_t)(i + j);
+        }
+        (void)memset_s(req->rbuf, SPI_BENCH_LEN, 0, SPI_BENCH_LEN);
+        req->msg.wbuf = req->wbuf;
+        req->msg.rbuf = req->rbuf;
+        req->msg.len = SPI_BENCH_LEN;
+        req->async.msgs = &req->msg;
+        req->async.count = 1;
+        req->async.callback = SpiBenchCallback;
+        req->async.priv = bench;
+    }
+    OsalAtomicSet(&bench->completed, 0);
+    OsalAtomicSet(&bench->failed, 0);
+}
+
+/* the devices take turns, as clients sharing the bus do, so each transfer is for another device */
+static int32_t SpiBenchSync(struct SpiBench *bench)
+{
+    uint32_t i;
+    struct SpiBenchReq *req = NULL;
+
+    for (i = 0; i < SPI_BENCH_DEV_NUM * SPI_BENCH_ROUNDS; i++) {
+        req = &bench->reqs[i];
+        if (SpiTransfer(bench->handles[i % SPI_BENCH_DEV_NUM], &req->msg, 1) != HDF_SUCCESS ||
+            memcmp(req->wbuf, req->rbuf, SPI_BENCH_LEN) != 0) {
+            HDF_LOGE("%s: transfer %u failed", __func__, i);
+            return HDF_FAILURE;
+        }
+    }
+    return HDF_SUCCESS;
+}
+
+static int32_t SpiBenchAsync(struct SpiBench *bench)
+{
+    int32_t ret;
+    uint32_t i = 0;
+    uint32_t total = SPI_BENCH_DEV_NUM * SPI_BENCH_ROUNDS;
+
+    while (i < total) {
+        ret = SpiTransferAsync(bench->handles[i % SPI_BENCH_DEV_NUM], &bench->reqs[i].async);
+        if (ret == HDF_SUCCESS) {
+            i++;
+        } else if (ret == HDF_ERR_QUEUE_FULL) {
+            /* a completion makes room */
+            if (OsalSemWait(&bench->done, SPI_BENCH_WAIT_MS) != HDF_SUCCESS) {
+                HDF_LOGE("%s: queue stuck at %u", __func__, i);
+                return HDF_FAILURE;
+            }
+        } else {
+            HDF_LOGE("%s: queue transfer %u failed, ret %d", __func__, i, ret);
+            return HDF_FAILURE;
+        }
+    }
+    while ((uint32_t)OsalAtomicRead(&bench->completed) < total) {
+        if (OsalSemWait(&bench->done, SPI_BENCH_WAIT_MS) != HDF_SUCCESS) {
+            HDF_LOGE("%s: %d of %u completed", __func__, OsalAtomicRead(&bench->completed), total);
+            return HDF_FAILURE;
+        }
+    }
+    if (OsalAtomicRead(&bench->failed) != 0) {
+        HDF_LOGE("%s: %d transfers failed", __func__, OsalAtomicRead(&bench->failed));
+        return HDF_FAILURE;
+    }
+    return HDF_SUCCESS;
+}
+
+static int32_t SpiBenchRun(struct SpiBench *bench, bool async, struct SpiCntlrStats *delta)
+{
+    int32_t ret;
+    uint64_t totalUs;
+    OsalTimespec start;
+    struct SpiCntlrStats before;
+    uint32_t total = SPI_BENCH_DEV_NUM * SPI_BENCH_ROUNDS;
+
+    SpiBenchResetReqs(bench);
+    (void)SpiCntlrGetStats(bench->cntlr, &before);
+    (void)OsalGetTime(&start);
+    ret = async ? SpiBenchAsync(bench) : SpiBenchSync(bench);
+    totalUs = SpiBenchElapsedUs(&start);
+    if (ret != HDF_SUCCESS) {
+        return ret;
+    }
+    (void)SpiCntlrGetStats(bench->cntlr, delta);
+    delta->transfers -= before.transfers;
+    delta->batches -= before.batches;
+    delta->cfgWrites -= before.cfgWrites;
+    delta->cfgSkips -= before.cfgSkips;
+    HDF_LOGE("%s: %s %llu transfers/s, %u config writes, %u skipped, %u batches", __func__,
+        async ? "async" : "sync", (unsigned long long)((uint64_t)total * SPI_BENCH_USEC_PER_SEC / (totalUs + 1)),
+        delta->cfgWrites, delta->cfgSkips, delta->batches);
+    return HDF_SUCCESS;
+}
+
+static int32_t SpiBenchOpen(struct SpiTest *test, struct SpiBench *bench)
+{
+    uint32_t i;
+    char name[SPI_BENCH_NAME_LEN] = {0};
+    struct SpiCfg cfg = {0};
+    struct SpiDevInfo info;
+
+    if (snprintf_s(name, SPI_BENCH_NAME_LEN, SPI_BENCH_NAME_LEN - 1, "HDF_PLATFORM_SPI_%u", test->virtualBus) < 0) {
+        return HDF_FAILURE;
+    }
+    bench->cntlr = (struct SpiCntlr *)DevSvcManagerClntGetService(name);
+    if (bench->cntlr == NULL) {
+        HDF_LOGE("%s: get %s failed", __func__, name);
+        return HDF_FAILURE;
+    }
+    info.busNum = test->virtualBus;
+    for (i = 0; i < SPI_BENCH_DEV_NUM; i++) {
+        info.csNum = i;
+        bench->handles[i] = SpiOpen(&info);
+        if (bench->handles[i] == NULL) {
+            HDF_LOGE("%s: open cs %u failed", __func__, i);
+            return HDF_FAILURE;
+        }
+        /* every device wants a clock of its own, so switching devices reprograms the controller */
+        cfg.maxSpeedHz = SPI_BENCH_SPEED >> i;
+        cfg.bitsPerWord = SPI_TEST_8BITS;
+        cfg.transferMode = SPI_POLLING_TRANSFER;
+        if (SpiSetCfg(bench->handles[i], &cfg) != HDF_SUCCESS) {
+            HDF_LOGE("%s: set cfg of cs %u failed", __func__, i);
+            return HDF_FAILURE;
+        }
+    }
+    return HDF_SUCCESS;
+}
+
+static void SpiBenchClose(struct SpiBench *bench)
+{
+    uint32_t i;
+
+    for (i = 0; i < SPI_BENCH_DEV_NUM; i++) {
+        if (bench->handles[i] != NULL) {
+            SpiClose(bench->handles[i]);
+        }
+    }
+}
+
+static int32_t SpiQueueBenchTest(struct SpiTest *test)
+{
+    int32_t ret;
+    struct SpiBench bench = {0};
+    struct SpiCntlrStats syncStats = {0};
+    struct SpiCntlrStats asyncStats = {0};
+
+    if (test->virtualBus == SPI_TEST_NO_VIRTUAL) {
+        HDF_LOGE("%s: no virtual bus, skip", __func__);
+        return HDF_SUCCESS;
+    }
+    bench.reqs = (struct SpiBenchReq *)OsalMemCalloc(sizeof(*bench.reqs) * SPI_BENCH_DEV_NUM * SPI_BENCH_ROUNDS);
+    if (bench.reqs == NULL) {
+        return HDF_ERR_MALLOC_FAIL;
+    }
+    if (OsalSemInit(&bench.done, 0) != HDF_SUCCESS) {
+        OsalMemFree(bench.reqs);
+        return HDF_FAILURE;
+    }
+    ret = SpiBenchOpen(test, &bench);
+    if (ret == HDF_SUCCESS) {
+        ret = SpiBenchRun(&bench, false, &syncStats);
+    }
+    if (ret == HDF_SUCCESS) {
+        ret = SpiBenchRun(&bench, true, &asyncStats);
+    }
+    if (ret == HDF_SUCCESS && asyncStats.cfgWrites >= syncStats.cfgWrites) {
+        HDF_LOGE("%s: queue saved no config writes, %u vs %u", __func__, asyncStats.cfgWrites,
+            syncStats.cfgWrites);
+        ret = HDF_FAILURE;
+    }
+    SpiBenchClose(&bench);
+    (void)OsalSemDestroy(&bench.done);
+    OsalMemFree(bench.reqs);
+    return ret;
+}
+
 static struct SpiTestFunc g_spiTestFunc[] = {
     {SPI_TRANSFER_TEST, SpiTransferTest},
     {SPI_DMA_TRANSFER_TEST, SpiDmaTransferTest},
@@ -328,6 +563,7 @@ static struct SpiTestFunc g_spiTestFunc[] = {
     {SPI_RELIABILITY_TEST, SpiReliabilityTest},
     {SPI_PERFORMANCE_TEST, NULL},
     {SPI_TEST_ALL, SpiTestAll},
+    {SPI_QUEUE_BENCH_TEST, SpiQueueBenchTest},
 };
 
 static int32_t SpiTestEntry(struct SpiTest *test, int32_t cmd)
@@ -393,6 +629,9 @@ static int32_t SpiTestInitFromHcs(struct SpiTest *test, const struct DeviceResou
         HDF_LOGE("%s: read cs fail", __func__);
         return HDF_FAILURE;
     }
+    if (face->GetUint32(node, "virtual_bus", &test->virtualBus, SPI_TEST_NO_VIRTUAL) != HDF_SUCCESS) {
+        test->virtualBus = SPI_TEST_NO_VIRTUAL;
+    }
     ret = face->GetUint32(node, "len", &test->len, 0);
     if (ret != HDF_SUCCESS) {
         HDF_LOGE("%s: read len fail", __func__);
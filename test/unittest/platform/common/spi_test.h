@@ -19,8 +19,11 @@ enum SpiTestCmd {
     SPI_RELIABILITY_TEST,
     SPI_PERFORMANCE_TEST,
     SPI_TEST_ALL,
+    SPI_QUEUE_BENCH_TEST,
 };
 
+#define SPI_TEST_NO_VIRTUAL 0xFFFFFFFF
+
 struct SpiTest {
     struct IDeviceIoService service;
     struct HdfDeviceObject *device;
@@ -32,6 +35,7 @@ struct SpiTest {
     uint8_t *rbuf;
     DevHandle handle;
     uint32_t testDma;
+    uint32_t virtualBus; /* bus of a virtual controller with 4 devices, for the queue bench */
 };
 
 static inline struct SpiTest *GetSpiTest(void)
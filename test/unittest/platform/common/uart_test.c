@@ -12,6 +12,7 @@
 #include "hdf_log.h"
 #include "osal_mem.h"
 #include "osal_time.h"
+#include "uart_core.h"
 #include "uart_if.h"
 #include "uart_test.h"
 
@@ -185,6 +186,242 @@ static int32_t UartTestAll(struct UartTest *test)
     return HDF_SUCCESS;
 }
 
+#define UART_BENCH_TOTAL       (16 * 1024)
+#define UART_BENCH_CHUNK       64
+#define UART_BENCH_RING        4096
+#define UART_BENCH_WATERMARK   256
+#define UART_BENCH_QUEUE       512
+#define UART_BENCH_DELAY_MS    1
+#define UART_BENCH_SLACK_MS    1000
+#define UART_BENCH_USEC_PER_SEC 1000000
+#define UART_BENCH_MSEC_PER_SEC 1000
+
+static uint32_t g_uartBenchBauds[] = { 115200, 921600, 3000000 };
+
+static uint64_t UartBenchElapsedUs(const OsalTimespec *start)
+{
+    OsalTimespec now;
+    OsalTimespec diff;
+
+    (void)OsalGetTime(&now);
+    (void)OsalDiffTime(start, &now, &diff);
+    return (uint64_t)diff.sec * UART_BENCH_USEC_PER_SEC + diff.usec;
+}
+
+static int32_t UartBenchReceive(DevHandle handle, uint8_t *buf, uint32_t *recv)
+{
+    int32_t ret;
+
+    ret = UartRead(handle, buf + *recv, UART_BENCH_TOTAL - *recv);
+    if (ret < 0) {
+        HDF_LOGE("%s: read failed, ret=%d", __func__, ret);
+        return ret;
+    }
+    *recv += (uint32_t)ret;
+    return HDF_SUCCESS;
+}
+
+static int32_t UartBenchOneBaud(DevHandle handle, uint32_t baud, uint8_t *wbuf, uint8_t *rbuf)
+{
+    uint32_t i;
+    uint32_t sent = 0;
+    uint32_t recv = 0;
+    uint64_t firstUs = 0;
+    uint64_t totalUs;
+    uint64_t limitUs;
+    OsalTimespec start;
+    struct UartBufferConfig config = {
+        UART_BENCH_RING, UART_BENCH_WATERMARK, UART_BENCH_QUEUE, UART_BENCH_DELAY_MS
+    };
+
+    if (UartSetBaud(handle, baud) != HDF_SUCCESS || UartSetBufferConfig(handle, &config) != HDF_SUCCESS) {
+        HDF_LOGE("%s: config baud %u failed", __func__, baud);
+        return HDF_FAILURE;
+    }
+    /* the whole transfer at the line rate, plus some slack */
+    limitUs = (uint64_t)UART_BENCH_TOTAL * BITS_PER_WORD * UART_BENCH_USEC_PER_SEC / baud +
+        (uint64_t)UART_BENCH_SLACK_MS * UART_BENCH_MSEC_PER_SEC;
+    (void)OsalGetTime(&start);
+    while (recv < UART_BENCH_TOTAL) {
+        if (sent < UART_BENCH_TOTAL) {
+            if (UartWrite(handle, wbuf + sent, UART_BENCH_CHUNK) != HDF_SUCCESS) {
+                HDF_LOGE("%s: write failed at %u", __func__, sent);
+                return HDF_FAILURE;
+            }
+            sent += UART_BENCH_CHUNK;
+            if (sent == UART_BENCH_TOTAL) {
+                (void)UartFlush(handle);
+            }
+        } else {
+            OsalMSleep(UART_BENCH_DELAY_MS);
+        }
+        if (UartBenchReceive(handle, rbuf, &recv) != HDF_SUCCESS) {
+            return HDF_FAILURE;
+        }
+        if (firstUs == 0 && recv > 0) {
+            firstUs = UartBenchElapsedUs(&start);
+        }
+        if (UartBenchElapsedUs(&start) > limitUs) {
+            HDF_LOGE("%s: baud %u timeout, received %u of %u", __func__, baud, recv, UART_BENCH_TOTAL);
+            return HDF_FAILURE;
+        }
+    }
+    totalUs = UartBenchElapsedUs(&start);
+    for (i = 0; i < UART_BENCH_TOTAL; i++) {
+        if (rbuf[i] != wbuf[i]) {
+            HDF_LOGE("%s: baud %u data mismatch at %u", __func__, baud, i);
+            return HDF_FAILURE;
+        }
+    }
+    HDF_LOGE("%s: baud %u first byte after %llu us, %llu bytes/s of %u", __func__, baud,
+        (unsigned long long)firstUs,
+        (unsigned long long)((uint64_t)UART_BENCH_TOTAL * UART_BENCH_USEC_PER_SEC / (totalUs + 1)),
+        baud / BITS_PER_WORD);
+    return HDF_SUCCESS;
+}
+
+static int32_t UartBufferBenchTest(struct UartTest *test)
+{
+    uint32_t i;
+    int32_t ret = HDF_SUCCESS;
+    uint8_t *wbuf = NULL;
+    uint8_t *rbuf = NULL;
+    DevHandle handle = NULL;
+    struct UartBufferConfig none = {0};
+
+    if (test->loopbackPort == UART_TEST_NO_LOOPBACK) {
+        HDF_LOGE("%s: no loopback port, skip", __func__);
+        return HDF_SUCCESS;
+    }
+    handle = UartOpen(test->loopbackPort);
+    if (handle == NULL) {
+        HDF_LOGE("%s: open port %u failed", __func__, test->loopbackPort);
+        return HDF_FAILURE;
+    }
+    wbuf = (uint8_t *)OsalMemCalloc(UART_BENCH_TOTAL);
+    rbuf = (uint8_t *)OsalMemCalloc(UART_BENCH_TOTAL);
+    if (wbuf == NULL || rbuf == NULL) {
+        ret = HDF_ERR_MALLOC_FAIL;
+        goto __EXIT;
+    }
+    for (i = 0; i < UART_BENCH_TOTAL; i++) {
+        wbuf[i] = (uint8_t)(i * 7 + (i >> 8));
+    }
+    for (i = 0; i < sizeof(g_uartBenchBauds) / sizeof(g_uartBenchBauds[0]); i++) {
+        ret = UartBenchOneBaud(handle, g_uartBenchBauds[i], wbuf, rbuf);
+        if (ret != HDF_SUCCESS) {
+            break;
+        }
+    }
+    (void)UartSetBufferConfig(handle, &none);
+__EXIT:
+    OsalMemFree(wbuf);
+    OsalMemFree(rbuf);
+    UartClose(handle);
+    return ret;
+}
+
+#define UART_WM_RING        1024
+#define UART_WM_LEVEL       256
+#define UART_WM_EXTRA       128
+#define UART_WM_BAUD        921600
+#define UART_WM_WAIT_MS     1000
+#define UART_WM_POLL_MS     1
+
+/* in kernel space the handle is the host, whose ring counts the watermark events it raised */
+static bool UartWmWait(struct UartRxRing *rx, uint32_t events, uint32_t fill)
+{
+    uint32_t i;
+
+    for (i = 0; i < UART_WM_WAIT_MS / UART_WM_POLL_MS; i++) {
+        if (rx->events >= events && rx->head - rx->tail >= fill) {
+            return true;
+        }
+        OsalMSleep(UART_WM_POLL_MS);
+    }
+    HDF_LOGE("%s: got %u events and %u bytes, expect %u and %u", __func__,
+        rx->events, rx->head - rx->tail, events, fill);
+    return false;
+}
+
+static int32_t UartWmDrain(DevHandle handle, uint8_t *buf, uint32_t size)
+{
+    int32_t ret;
+    uint32_t recv = 0;
+
+    while (recv < size) {
+        ret = UartRead(handle, buf + recv, size - recv);
+        if (ret <= 0) {
+            HDF_LOGE("%s: read %u of %u, ret=%d", __func__, recv, size, ret);
+            return HDF_FAILURE;
+        }
+        recv += (uint32_t)ret;
+    }
+    return HDF_SUCCESS;
+}
+
+static int32_t UartRxWatermarkRun(DevHandle handle, struct UartRxRing *rx, uint8_t *buf)
+{
+    /* reaching the watermark raises one event */
+    if (UartWrite(handle, buf, UART_WM_LEVEL) != HDF_SUCCESS || !UartWmWait(rx, 1, UART_WM_LEVEL)) {
+        return HDF_FAILURE;
+    }
+    /* staying above it raises none */
+    if (UartWrite(handle, buf, UART_WM_EXTRA) != HDF_SUCCESS || !UartWmWait(rx, 1, UART_WM_LEVEL + UART_WM_EXTRA)) {
+        return HDF_FAILURE;
+    }
+    OsalMSleep(UART_WM_POLL_MS * 10);
+    if (rx->events != 1) {
+        HDF_LOGE("%s: %u events without a read below the watermark", __func__, rx->events);
+        return HDF_FAILURE;
+    }
+    /* once read below it, reaching it again raises the next one */
+    if (UartWmDrain(handle, buf, UART_WM_LEVEL + UART_WM_EXTRA) != HDF_SUCCESS) {
+        return HDF_FAILURE;
+    }
+    if (UartWrite(handle, buf, UART_WM_LEVEL) != HDF_SUCCESS || !UartWmWait(rx, 2, UART_WM_LEVEL)) {
+        return HDF_FAILURE;
+    }
+    return UartWmDrain(handle, buf, UART_WM_LEVEL);
+}
+
+static int32_t UartRxWatermarkTest(struct UartTest *test)
+{
+    int32_t ret;
+    uint8_t *buf = NULL;
+    DevHandle handle = NULL;
+    struct UartRxRing *rx = NULL;
+    struct UartBufferConfig none = {0};
+    struct UartBufferConfig config = { UART_WM_RING, UART_WM_LEVEL, 0, 0 };
+
+    if (test->loopbackPort == UART_TEST_NO_LOOPBACK) {
+        HDF_LOGE("%s: no loopback port, skip", __func__);
+        return HDF_SUCCESS;
+    }
+    handle = UartOpen(test->loopbackPort);
+    if (handle == NULL) {
+        HDF_LOGE("%s: open port %u failed", __func__, test->loopbackPort);
+        return HDF_FAILURE;
+    }
+    buf = (uint8_t *)OsalMemCalloc(UART_WM_LEVEL + UART_WM_EXTRA);
+    if (buf == NULL) {
+        UartClose(handle);
+        return HDF_ERR_MALLOC_FAIL;
+    }
+    ret = UartSetBaud(handle, UART_WM_BAUD);
+    if (ret == HDF_SUCCESS) {
+        ret = UartSetBufferConfig(handle, &config);
+    }
+    if (ret == HDF_SUCCESS) {
+        rx = ((struct UartHost *)handle)->rx;
+        ret = (rx == NULL) ? HDF_FAILURE : UartRxWatermarkRun(handle, rx, buf);
+    }
+    (void)UartSetBufferConfig(handle, &none);
+    OsalMemFree(buf);
+    UartClose(handle);
+    return ret;
+}
+
 struct UartTestFunc g_uartTestFunc[] = {
     { UAER_WRITE_TEST, UartWriteTest },
     { UART_READ_TEST, UartReadTest },
@@ -196,6 +433,8 @@ struct UartTestFunc g_uartTestFunc[] = {
     { UART_RELIABILITY_TEST, UartReliabilityTest },
     { UART_PERFORMANCE_TEST, NULL },
     { UART_TEST_ALL, UartTestAll },
+    { UART_BUFFER_BENCH_TEST, UartBufferBenchTest },
+    { UART_RX_WATERMARK_TEST, UartRxWatermarkTest },
 };
 
 static int32_t UartTestEntry(struct UartTest *test, int32_t cmd)
@@ -256,6 +495,9 @@ static int32_t UartTestInitFromHcs(struct UartTest *test, const struct DeviceRes
         HDF_LOGE("%s: read port fail", __func__);
         return HDF_FAILURE;
     }
+    if (face->GetUint32(node, "loopback_port", &test->loopbackPort, UART_TEST_NO_LOOPBACK) != HDF_SUCCESS) {
+        test->loopbackPort = UART_TEST_NO_LOOPBACK;
+    }
     ret = face->GetUint32(node, "len", &test->len, 0);
     if (ret != HDF_SUCCESS) {
         HDF_LOGE("%s: read len fail", __func__);
@@ -23,13 +23,18 @@ enum UartTestCmd {
     UART_RELIABILITY_TEST,
     UART_PERFORMANCE_TEST,
     UART_TEST_ALL,
+    UART_BUFFER_BENCH_TEST,
+    UART_RX_WATERMARK_TEST,
 };
 
+#define UART_TEST_NO_LOOPBACK 0xFFFFFFFF
+
 struct UartTest {
     struct IDeviceIoService service;
     struct HdfDeviceObject *device;
     int32_t (*TestEntry)(struct UartTest *test, int32_t cmd);
     uint32_t port;
+    uint32_t loopbackPort; /* a port which receives what it writes, UART_TEST_NO_LOOPBACK for none */
     uint32_t len;
     uint8_t *wbuf;
     uint8_t *rbuf;
@@ -0,0 +1,16 @@
+/*
+ * Copyright (c) 2021 Huawei Device Co., Ltd.
+ *
+ * HDF is dual licensed: you can use it either under the terms of
+ * the GPL, or the BSD license, at your option.
+ * See the LICENSE file in the root of this repository for complete details.
+ */
+
+#ifndef HDF_REGMAP_ENTRY_TEST_H
+#define HDF_REGMAP_ENTRY_TEST_H
+
+#include "hdf_main_test.h"
+
+int32_t HdfRegmapUnitTestEntry(HdfTestMsg *msg);
+
+#endif /* HDF_REGMAP_ENTRY_TEST_H */
@@ -0,0 +1,336 @@
+/*
+ * Copyright (c) 2021 Huawei Device Co., Ltd.
+ *
+ * HDF is dual licensed: you can use it either under the terms of
+ * the GPL, or the BSD license, at your option.
+ * See the LICENSE file in the root of this repository for complete details.
+ */
+
+#include "dmac_core.h"
+#include "device_resource_if.h"
+#include "hdf_device_desc.h"
+#include "hdf_log.h"
+#include "osal_mem.h"
+#include "osal_sem.h"
+#include "osal_thread.h"
+#include "securec.h"
+
+#define HDF_LOG_TAG dmac_virtual
+
+#define VIRTUAL_DMAC_CHAN_MAX       32
+#define VIRTUAL_DMAC_TRANS_SIZE_DEF 4096
+#define VIRTUAL_DMAC_STACK_SIZE     10000
+
+struct VirtualDmacChan {
+    struct DmacLli *lli;    /* chain to run, NULL for a single block */
+    uintptr_t src;
+    uintptr_t dest;
+    size_t len;
+    int status;
+};
+
+/*
+ * A memory to memory engine without hardware: a thread runs the enabled channels with memcpy,
+ * following the descriptor chains, and reports their end through DmacCntlrIrqHandle.
+ * Physical and virtual addresses are the same.
+ */
+struct VirtualDmac {
+    struct DmaCntlr *cntlr;
+    OsalSpinlock spin;
+    uint32_t pending;
+    struct VirtualDmacChan chans[VIRTUAL_DMAC_CHAN_MAX];
+    bool running;
+    struct OsalSem kick;
+    struct OsalSem exited;
+    struct OsalThread thread;
+};
+
+static int32_t VirtualDmacGetChanInfo(struct DmaCntlr *cntlr, struct DmacChanInfo *chanInfo, struct DmacMsg *msg)
+{
+    (void)cntlr;
+    if (msg->transType != TRASFER_TYPE_M2M) {
+        HDF_LOGE("%s: only m2m is supported", __func__);
+        return HDF_ERR_NOT_SUPPORT;
+    }
+    chanInfo->srcWidth = msg->srcWidth;
+    chanInfo->destWidth = msg->destWidth;
+    chanInfo->config = 0;
+    chanInfo->lliEnFlag = 0;
+    return HDF_SUCCESS;
+}
+
+static void VirtualDmacKick(struct VirtualDmac *virtual, uint16_t channel)
+{
+    uint32_t flags;
+
+    (void)OsalSpinLockIrqSave(&virtual->spin, &flags);
+    virtual->pending |= 1U << channel;
+    (void)OsalSpinUnlockIrqRestore(&virtual->spin, &flags);
+    (void)OsalSemPost(&virtual->kick);
+}
+
+static int32_t VirtualDmacChanEnable(struct DmaCntlr *cntlr, struct DmacChanInfo *chanInfo)
+{
+    struct VirtualDmac *virtual = (struct VirtualDmac *)cntlr->private;
+
+    virtual->chans[chanInfo->channel].lli = chanInfo->lli;
+    VirtualDmacKick(virtual, chanInfo->channel);
+    return HDF_SUCCESS;
+}
+
+static int32_t VirtualDmacM2mChanEnable(struct DmaCntlr *cntlr, struct DmacChanInfo *chanInfo,
+    uintptr_t src, uintptr_t dest, size_t length)
+{
+    struct VirtualDmac *virtual = (struct VirtualDmac *)cntlr->private;
+    struct VirtualDmacChan *chan = &virtual->chans[chanInfo->channel];
+
+    chan->lli = NULL;
+    chan->src = src;
+    chan->dest = dest;
+    chan->len = length;
+    VirtualDmacKick(virtual, chanInfo->channel);
+    return HDF_SUCCESS;
+}
+
+static void VirtualDmacChanDisable(struct DmaCntlr *cntlr, uint16_t channel)
+{
+    uint32_t flags;
+    struct VirtualDmac *virtual = (struct VirtualDmac *)cntlr->private;
+
+    (void)OsalSpinLockIrqSave(&virtual->spin, &flags);
+    virtual->pending &= ~(1U << channel);
+    (void)OsalSpinUnlockIrqRestore(&virtual->spin, &flags);
+}
+
+static void VirtualDmacCacheOp(uintptr_t vaddr, uintptr_t vend)
+{
+    (void)vaddr;
+    (void)vend;
+}
+
+static void *VirtualDmacPaddrToVaddr(uintptr_t paddr)
+{
+    return (void *)paddr;
+}
+
+static uintptr_t VirtualDmacVaddrToPaddr(void *vaddr)
+{
+    return (uintptr_t)vaddr;
+}
+
+/* the status is reported once, as a hardware interrupt status is cleared on reading it */
+static int VirtualDmacGetChanStatus(struct DmaCntlr *cntlr, uint16_t chan)
+{
+    int status;
+    struct VirtualDmac *virtual = (struct VirtualDmac *)cntlr->private;
+
+    status = virtual->chans[chan].status;
+    virtual->chans[chan].status = 0;
+    return status;
+}
+
+static uintptr_t VirtualDmacGetCurrDestAddr(struct DmaCntlr *cntlr, uint16_t chan)
+{
+    (void)cntlr;
+    (void)chan;
+    return 0;
+}
+
+static int VirtualDmacRunChan(struct VirtualDmacChan *chan)
+{
+    struct DmacLli *lli = chan->lli;
+
+    if (lli == NULL) {
+        return (memcpy_s((void *)chan->dest, chan->len, (void *)chan->src, chan->len) == EOK) ?
+            DMAC_CHN_SUCCESS : DMAC_CHN_ERROR;
+    }
+    for (; lli != NULL; lli = (struct DmacLli *)lli->nextLli) {
+        if (memcpy_s((void *)lli->destAddr, lli->count, (void *)lli->srcAddr, lli->count) != EOK) {
+            return DMAC_CHN_ERROR;
+        }
+    }
+    return DMAC_CHN_SUCCESS;
+}
+
+static int VirtualDmacThread(void *data)
+{
+    uint16_t i;
+    uint32_t flags;
+    uint32_t pending;
+    struct VirtualDmac *virtual = (struct VirtualDmac *)data;
+
+    while (true) {
+        (void)OsalSemWait(&virtual->kick, HDF_WAIT_FOREVER);
+        if (!virtual->running) {
+            break;
+        }
+        (void)OsalSpinLockIrqSave(&virtual->spin, &flags);
+        pending = virtual->pending;
+        virtual->pending = 0;
+        (void)OsalSpinUnlockIrqRestore(&virtual->spin, &flags);
+        if (pending == 0) {
+            continue;
+        }
+        for (i = 0; i < VIRTUAL_DMAC_CHAN_MAX; i++) {
+            if ((pending & (1U << i)) != 0) {
+                virtual->chans[i].status = VirtualDmacRunChan(&virtual->chans[i]);
+            }
+        }
+        DmacCntlrIrqHandle(virtual->cntlr);
+    }
+    (void)OsalSemPost(&virtual->exited);
+    return HDF_SUCCESS;
+}
+
+static int32_t VirtualDmacStart(struct VirtualDmac *virtual)
+{
+    struct OsalThreadParam cfg;
+
+    if (OsalSpinInit(&virtual->spin) != HDF_SUCCESS) {
+        return HDF_FAILURE;
+    }
+    if (OsalSemInit(&virtual->kick, 0) != HDF_SUCCESS) {
+        (void)OsalSpinDestroy(&virtual->spin);
+        return HDF_FAILURE;
+    }
+    if (OsalSemInit(&virtual->exited, 0) != HDF_SUCCESS) {
+        (void)OsalSemDestroy(&virtual->kick);
+        (void)OsalSpinDestroy(&virtual->spin);
+        return HDF_FAILURE;
+    }
+    virtual->running = true;
+    cfg.name = "virtual_dmac";
+    cfg.priority = OSAL_THREAD_PRI_HIGH;
+    cfg.stackSize = VIRTUAL_DMAC_STACK_SIZE;
+    if (OsalThreadCreate(&virtual->thread, (OsalThreadEntry)VirtualDmacThread, virtual) != HDF_SUCCESS ||
+        OsalThreadStart(&virtual->thread, &cfg) != HDF_SUCCESS) {
+        HDF_LOGE("%s: start engine thread failed", __func__);
+        (void)OsalSemDestroy(&virtual->exited);
+        (void)OsalSemDestroy(&virtual->kick);
+        (void)OsalSpinDestroy(&virtual->spin);
+        return HDF_FAILURE;
+    }
+    return HDF_SUCCESS;
+}
+
+static void VirtualDmacStop(struct VirtualDmac *virtual)
+{
+    virtual->running = false;
+    (void)OsalSemPost(&virtual->kick);
+    (void)OsalSemWait(&virtual->exited, HDF_WAIT_FOREVER);
+    (void)OsalSemDestroy(&virtual->exited);
+    (void)OsalSemDestroy(&virtual->kick);
+    (void)OsalSpinDestroy(&virtual->spin);
+}
+
+static int32_t VirtualDmacReadConfig(struct DmaCntlr *cntlr, const struct DeviceResourceNode *node)
+{
+    uint32_t maxTransSize;
+    struct DeviceResourceIface *drsOps = NULL;
+
+    drsOps = DeviceResourceGetIfaceInstance(HDF_CONFIG_SOURCE);
+    if (drsOps == NULL || drsOps->GetUint16 == NULL || drsOps->GetUint32 == NULL) {
+        HDF_LOGE("%s: invalid drs ops", __func__);
+        return HDF_FAILURE;
+    }
+    if (drsOps->GetUint16(node, "channel_num", &cntlr->channelNum, 0) != HDF_SUCCESS ||
+        cntlr->channelNum == 0 || cntlr->channelNum > VIRTUAL_DMAC_CHAN_MAX) {
+        HDF_LOGE("%s: invalid channel_num", __func__);
+        return HDF_ERR_INVALID_PARAM;
+    }
+    (void)drsOps->GetUint32(node, "max_trans_size", &maxTransSize, VIRTUAL_DMAC_TRANS_SIZE_DEF);
+    cntlr->maxTransSize = maxTransSize;
+    (void)drsOps->GetUint16(node, "lli_pool_size", &cntlr->lliPoolSize, 0);
+    (void)drsOps->GetUint16(node, "index", &cntlr->index, 0);
+    return HDF_SUCCESS;
+}
+
+static int32_t VirtualDmacBind(struct HdfDeviceObject *device)
+{
+    struct DmaCntlr *cntlr = NULL;
+
+    if (device == NULL) {
+        return HDF_ERR_INVALID_OBJECT;
+    }
+    cntlr = DmaCntlrCreate(device);
+    if (cntlr == NULL) {
+        return HDF_ERR_MALLOC_FAIL;
+    }
+    device->service = &cntlr->service;
+    return HDF_SUCCESS;
+}
+
+static int32_t VirtualDmacInit(struct HdfDeviceObject *device)
+{
+    int32_t ret;
+    struct DmaCntlr *cntlr = NULL;
+    struct VirtualDmac *virtual = NULL;
+
+    if (device == NULL || device->service == NULL || device->property == NULL) {
+        HDF_LOGE("%s: device, service or property is NULL", __func__);
+        return HDF_ERR_INVALID_OBJECT;
+    }
+    cntlr = (struct DmaCntlr *)device->service;
+    ret = VirtualDmacReadConfig(cntlr, device->property);
+    if (ret != HDF_SUCCESS) {
+        return ret;
+    }
+    virtual = (struct VirtualDmac *)OsalMemCalloc(sizeof(*virtual));
+    if (virtual == NULL) {
+        return HDF_ERR_MALLOC_FAIL;
+    }
+    virtual->cntlr = cntlr;
+    cntlr->private = virtual;
+    cntlr->irq = DMAC_IRQ_NONE;
+    cntlr->getChanInfo = VirtualDmacGetChanInfo;
+    cntlr->dmaChanEnable = VirtualDmacChanEnable;
+    cntlr->dmaM2mChanEnable = VirtualDmacM2mChanEnable;
+    cntlr->dmacChanDisable = VirtualDmacChanDisable;
+    cntlr->dmacCacheInv = VirtualDmacCacheOp;
+    cntlr->dmacCacheFlush = VirtualDmacCacheOp;
+    cntlr->dmacPaddrToVaddr = VirtualDmacPaddrToVaddr;
+    cntlr->dmacVaddrToPaddr = VirtualDmacVaddrToPaddr;
+    cntlr->dmacGetChanStatus = VirtualDmacGetChanStatus;
+    cntlr->dmacGetCurrDestAddr = VirtualDmacGetCurrDestAddr;
+    ret = VirtualDmacStart(virtual);
+    if (ret != HDF_SUCCESS) {
+        cntlr->private = NULL;
+        OsalMemFree(virtual);
+        return ret;
+    }
+    ret = DmacCntlrAdd(cntlr);
+    if (ret != HDF_SUCCESS) {
+        HDF_LOGE("%s: add dma controller failed, ret=%d", __func__, ret);
+        VirtualDmacStop(virtual);
+        cntlr->private = NULL;
+        OsalMemFree(virtual);
+        return ret;
+    }
+    return HDF_SUCCESS;
+}
+
+static void VirtualDmacRelease(struct HdfDeviceObject *device)
+{
+    struct DmaCntlr *cntlr = NULL;
+
+    if (device == NULL || device->service == NULL) {
+        return;
+    }
+    cntlr = (struct DmaCntlr *)device->service;
+    if (cntlr->private != NULL) {
+        VirtualDmacStop((struct VirtualDmac *)cntlr->private);
+        OsalMemFree(cntlr->private);
+    }
+    DmacCntlrRemove(cntlr);
+    DmaCntlrDestroy(cntlr);
+    device->service = NULL;
+}
+
+struct HdfDriverEntry g_virtualDmacDriverEntry = {
+    .moduleVersion = 1,
+    .moduleName = "virtual_dmac_driver",
+    .Bind = VirtualDmacBind,
+    .Init = VirtualDmacInit,
+    .Release = VirtualDmacRelease,
+};
+HDF_INIT(g_virtualDmacDriverEntry);
@@ -0,0 +1,180 @@
+/*
+ * Copyright (c) 2021 Huawei Device Co., Ltd.
+ *
+ * HDF is dual licensed: you can use it either under the terms of
+ * the GPL, or the BSD license, at your option.
+ * See the LICENSE file in the root of this repository for complete details.
+ */
+
+#include "gpio/gpio_core.h"
+#include "device_resource_if.h"
+#include "hdf_device_desc.h"
+#include "hdf_log.h"
+#include "osal_mem.h"
+
+#define HDF_LOG_TAG gpio_virtual
+
+#define VIRTUAL_GPIO_COUNT_MAX 64
+
+/*
+ * A controller without hardware: outputs read back what was written, and interrupts
+ * are only raised by calling GpioCntlrIrqCallback, which lets tests drive the irq path.
+ */
+struct VirtualGpioCntlr {
+    struct GpioCntlr cntlr;
+    uint16_t dirs[VIRTUAL_GPIO_COUNT_MAX];
+    uint16_t vals[VIRTUAL_GPIO_COUNT_MAX];
+};
+
+static int32_t VirtualGpioWrite(struct GpioCntlr *cntlr, uint16_t local, uint16_t val)
+{
+    struct VirtualGpioCntlr *virtual = (struct VirtualGpioCntlr *)cntlr;
+
+    virtual->vals[local] = val;
+    return HDF_SUCCESS;
+}
+
+static int32_t VirtualGpioRead(struct GpioCntlr *cntlr, uint16_t local, uint16_t *val)
+{
+    struct VirtualGpioCntlr *virtual = (struct VirtualGpioCntlr *)cntlr;
+
+    *val = virtual->vals[local];
+    return HDF_SUCCESS;
+}
+
+static int32_t VirtualGpioWriteMulti(struct GpioCntlr *cntlr, const uint16_t *locals, const uint16_t *vals,
+    uint16_t count)
+{
+    uint16_t i;
+    struct VirtualGpioCntlr *virtual = (struct VirtualGpioCntlr *)cntlr;
+
+    for (i = 0; i < count; i++) {
+        virtual->vals[locals[i]] = vals[i];
+    }
+    return HDF_SUCCESS;
+}
+
+static int32_t VirtualGpioReadMulti(struct GpioCntlr *cntlr, const uint16_t *locals, uint16_t *vals,
+    uint16_t count)
+{
+    uint16_t i;
+    struct VirtualGpioCntlr *virtual = (struct VirtualGpioCntlr *)cntlr;
+
+    for (i = 0; i < count; i++) {
+        vals[i] = virtual->vals[locals[i]];
+    }
+    return HDF_SUCCESS;
+}
+
+static int32_t VirtualGpioSetDir(struct GpioCntlr *cntlr, uint16_t local, uint16_t dir)
+{
+    struct VirtualGpioCntlr *virtual = (struct VirtualGpioCntlr *)cntlr;
+
+    virtual->dirs[local] = dir;
+    return HDF_SUCCESS;
+}
+
+static int32_t VirtualGpioGetDir(struct GpioCntlr *cntlr, uint16_t local, uint16_t *dir)
+{
+    struct VirtualGpioCntlr *virtual = (struct VirtualGpioCntlr *)cntlr;
+
+    *dir = virtual->dirs[local];
+    return HDF_SUCCESS;
+}
+
+static int32_t VirtualGpioSetIrq(struct GpioCntlr *cntlr, uint16_t local, uint16_t mode,
+    GpioIrqFunc func, void *arg)
+{
+    (void)cntlr;
+    (void)local;
+    (void)mode;
+    (void)func;
+    (void)arg;
+    return HDF_SUCCESS;
+}
+
+static int32_t VirtualGpioIrqOp(struct GpioCntlr *cntlr, uint16_t local)
+{
+    (void)cntlr;
+    (void)local;
+    return HDF_SUCCESS;
+}
+
+static struct GpioMethod g_virtualGpioMethod = {
+    .write = VirtualGpioWrite,
+    .read = VirtualGpioRead,
+    .setDir = VirtualGpioSetDir,
+    .getDir = VirtualGpioGetDir,
+    .setIrq = VirtualGpioSetIrq,
+    .unsetIrq = VirtualGpioIrqOp,
+    .enableIrq = VirtualGpioIrqOp,
+    .disableIrq = VirtualGpioIrqOp,
+    .writeMulti = VirtualGpioWriteMulti,
+    .readMulti = VirtualGpioReadMulti,
+};
+
+static int32_t VirtualGpioInit(struct HdfDeviceObject *device)
+{
+    int32_t ret;
+    uint16_t start;
+    uint16_t count;
+    struct VirtualGpioCntlr *virtual = NULL;
+    struct DeviceResourceIface *drsOps = NULL;
+
+    if (device == NULL || device->property == NULL) {
+        HDF_LOGE("%s: device or property is NULL", __func__);
+        return HDF_ERR_INVALID_OBJECT;
+    }
+    drsOps = DeviceResourceGetIfaceInstance(HDF_CONFIG_SOURCE);
+    if (drsOps == NULL || drsOps->GetUint16 == NULL) {
+        HDF_LOGE("%s: invalid drs ops", __func__);
+        return HDF_FAILURE;
+    }
+    if (drsOps->GetUint16(device->property, "start", &start, 0) != HDF_SUCCESS ||
+        drsOps->GetUint16(device->property, "count", &count, 0) != HDF_SUCCESS) {
+        HDF_LOGE("%s: read start or count failed", __func__);
+        return HDF_FAILURE;
+    }
+    if (count == 0 || count > VIRTUAL_GPIO_COUNT_MAX) {
+        HDF_LOGE("%s: invalid count:%u", __func__, count);
+        return HDF_ERR_INVALID_PARAM;
+    }
+
+    virtual = (struct VirtualGpioCntlr *)OsalMemCalloc(sizeof(*virtual));
+    if (virtual == NULL) {
+        return HDF_ERR_MALLOC_FAIL;
+    }
+    virtual->cntlr.start = start;
+    virtual->cntlr.count = count;
+    virtual->cntlr.priv = virtual;
+    virtual->cntlr.ops = &g_virtualGpioMethod;
+    ret = GpioCntlrAdd(&virtual->cntlr);
+    if (ret != HDF_SUCCESS) {
+        HDF_LOGE("%s: add gpio controller %u failed, ret=%d", __func__, start, ret);
+        OsalMemFree(virtual);
+        return ret;
+    }
+    device->priv = virtual;
+    return HDF_SUCCESS;
+}
+
+static void VirtualGpioRelease(struct HdfDeviceObject *device)
+{
+    struct VirtualGpioCntlr *virtual = NULL;
+
+    if (device == NULL || device->priv == NULL) {
+        return;
+    }
+    virtual = (struct VirtualGpioCntlr *)device->priv;
+    GpioCntlrRemove(&virtual->cntlr);
+    OsalMemFree(virtual);
+    device->priv = NULL;
+}
+
+struct HdfDriverEntry g_virtualGpioDriverEntry = {
+    .moduleVersion = 1,
+    .moduleName = "virtual_gpio_driver",
+    .Init = VirtualGpioInit,
+    .Release = VirtualGpioRelease,
+};
+HDF_INIT(g_virtualGpioDriverEntry);
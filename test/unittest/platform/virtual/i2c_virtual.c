@@ -0,0 +1,122 @@
+/*
+ * Copyright (c) 2021 Huawei Device Co., Ltd.
+ *
+ * HDF is dual licensed: you can use it either under the terms of
+ * the GPL, or the BSD license, at your option.
+ * See the LICENSE file in the root of this repository for complete details.
+ */
+
+#include "i2c_core.h"
+#include "device_resource_if.h"
+#include "hdf_device_desc.h"
+#include "hdf_log.h"
+#include "osal_mem.h"
+
+#define HDF_LOG_TAG i2c_virtual
+
+#define VIRTUAL_I2C_MEM_SIZE 256
+
+/*
+ * A controller with one eeprom like device on it: the first byte of a write msg sets the
+ * register offset, the rest is stored from there on, and read msgs continue from the offset.
+ */
+struct VirtualI2cCntlr {
+    struct I2cCntlr cntlr;
+    uint16_t devAddr;
+    uint8_t offset;
+    uint8_t mem[VIRTUAL_I2C_MEM_SIZE];
+};
+
+static int32_t VirtualI2cTransfer(struct I2cCntlr *cntlr, struct I2cMsg *msgs, int16_t count)
+{
+    int16_t i;
+    uint16_t j;
+    struct VirtualI2cCntlr *virtual = (struct VirtualI2cCntlr *)cntlr;
+
+    for (i = 0; i < count; i++) {
+        if (msgs[i].addr != virtual->devAddr) {
+            /* no ack from the address, stop like a real controller does */
+            return i;
+        }
+        if ((msgs[i].flags & I2C_FLAG_READ) != 0) {
+            for (j = 0; j < msgs[i].len; j++) {
+                msgs[i].buf[j] = virtual->mem[virtual->offset++];
+            }
+            continue;
+        }
+        if (msgs[i].len == 0) {
+            continue;
+        }
+        virtual->offset = msgs[i].buf[0];
+        for (j = 1; j < msgs[i].len; j++) {
+            virtual->mem[virtual->offset++] = msgs[i].buf[j];
+        }
+    }
+    return count;
+}
+
+static const struct I2cMethod g_virtualI2cMethod = {
+    .transfer = VirtualI2cTransfer,
+};
+
+static int32_t VirtualI2cInit(struct HdfDeviceObject *device)
+{
+    int32_t ret;
+    uint16_t busId;
+    uint16_t devAddr;
+    struct VirtualI2cCntlr *virtual = NULL;
+    struct DeviceResourceIface *drsOps = NULL;
+
+    if (device == NULL || device->property == NULL) {
+        HDF_LOGE("%s: device or property is NULL", __func__);
+        return HDF_ERR_INVALID_OBJECT;
+    }
+    drsOps = DeviceResourceGetIfaceInstance(HDF_CONFIG_SOURCE);
+    if (drsOps == NULL || drsOps->GetUint16 == NULL) {
+        HDF_LOGE("%s: invalid drs ops", __func__);
+        return HDF_FAILURE;
+    }
+    if (drsOps->GetUint16(device->property, "bus", &busId, 0) != HDF_SUCCESS ||
+        drsOps->GetUint16(device->property, "dev_addr", &devAddr, 0) != HDF_SUCCESS) {
+        HDF_LOGE("%s: read bus or dev_addr failed", __func__);
+        return HDF_FAILURE;
+    }
+
+    virtual = (struct VirtualI2cCntlr *)OsalMemCalloc(sizeof(*virtual));
+    if (virtual == NULL) {
+        return HDF_ERR_MALLOC_FAIL;
+    }
+    virtual->devAddr = devAddr;
+    virtual->cntlr.busId = (int16_t)busId;
+    virtual->cntlr.priv = virtual;
+    virtual->cntlr.ops = &g_virtualI2cMethod;
+    ret = I2cCntlrAdd(&virtual->cntlr);
+    if (ret != HDF_SUCCESS) {
+        HDF_LOGE("%s: add i2c controller %u failed, ret=%d", __func__, busId, ret);
+        OsalMemFree(virtual);
+        return ret;
+    }
+    device->priv = virtual;
+    return HDF_SUCCESS;
+}
+
+static void VirtualI2cRelease(struct HdfDeviceObject *device)
+{
+    struct VirtualI2cCntlr *virtual = NULL;
+
+    if (device == NULL || device->priv == NULL) {
+        return;
+    }
+    virtual = (struct VirtualI2cCntlr *)device->priv;
+    I2cCntlrRemove(&virtual->cntlr);
+    OsalMemFree(virtual);
+    device->priv = NULL;
+}
+
+struct HdfDriverEntry g_virtualI2cDriverEntry = {
+    .moduleVersion = 1,
+    .moduleName = "virtual_i2c_driver",
+    .Init = VirtualI2cInit,
+    .Release = VirtualI2cRelease,
+};
+HDF_INIT(g_virtualI2cDriverEntry);
@@ -237,6 +237,7 @@ static int32_t I3cIbiHandle(uint32_t irq, void *data)
     struct VirtualI3cCntlr *virtual = NULL;
     struct I3cDevice *device = NULL;
     uint16_t ibiAddr;
+    int32_t ret;
     char *testStr = VIRTUAL_I3C_TEST_STR;
 
     (void)irq;
@@ -260,7 +261,9 @@ static int32_t I3cIbiHandle(uint32_t irq, void *data)
             /* Put the string "Hello I3C!" into IBI buffer */
             *device->ibi->data = *testStr;
         }
-        return I3cCntlrIbiCallback(device);
+        ret = I3cCntlrIbiCallback(device);
+        I3cDevicePut(device);
+        return ret;
     }
 
     return HDF_SUCCESS;
@@ -0,0 +1,220 @@
+/*
+ * Copyright (c) 2021 Huawei Device Co., Ltd.
+ *
+ * HDF is dual licensed: you can use it either under the terms of
+ * the GPL, or the BSD license, at your option.
+ * See the LICENSE file in the root of this repository for complete details.
+ */
+
+#include "device_resource_if.h"
+#include "hdf_device_desc.h"
+#include "hdf_log.h"
+#include "mtd_core.h"
+#include "mtd_test.h"
+#include "osal_mem.h"
+#include "securec.h"
+
+#define HDF_LOG_TAG mtd_nand_virtual
+
+#define VIRTUAL_NAND_ERASED_BYTE  0xff
+#define VIRTUAL_NAND_BAD_MARK     0x00
+#define VIRTUAL_NAND_BLOCK_SIZE   (MTD_VIRTUAL_NAND_PAGE_SIZE * MTD_VIRTUAL_NAND_BLOCK_PAGES)
+#define VIRTUAL_NAND_PAGE_NUM     (MTD_VIRTUAL_NAND_BLOCK_PAGES * MTD_VIRTUAL_NAND_BLOCK_NUM)
+
+/* A ram backed nand flash, the bad block marker is the first oob byte of the first page in a block. */
+struct VirtualNand {
+    struct MtdDevice mtd;
+    struct MtdVirtualNandStats stats;
+    uint8_t *data;
+    uint8_t *oob;
+};
+
+static inline struct VirtualNand *ToVirtualNand(struct MtdDevice *mtdDevice)
+{
+    return CONTAINER_OF(mtdDevice, struct VirtualNand, mtd);
+}
+
+static inline uint8_t *VirtualNandBadMark(struct VirtualNand *nand, off_t addr)
+{
+    size_t page = (size_t)(addr / VIRTUAL_NAND_BLOCK_SIZE) * MTD_VIRTUAL_NAND_BLOCK_PAGES;
+
+    return nand->oob + page * MTD_VIRTUAL_NAND_OOB_SIZE;
+}
+
+static int32_t VirtualNandCopy(struct VirtualNand *nand, enum MtdMsgType type, off_t addr, uint8_t *buf, size_t len)
+{
+    if (type == MTD_MSG_TYPE_WRITE) {
+        return memcpy_s(nand->data + addr, nand->mtd.capacity - addr, buf, len);
+    }
+    return memcpy_s(buf, len, nand->data + addr, len);
+}
+
+static int32_t VirtualNandPageTransfer(struct MtdDevice *mtdDevice, struct MtdPage *mtdPage)
+{
+    struct VirtualNand *nand = ToVirtualNand(mtdDevice);
+    uint8_t *oob = NULL;
+    int32_t ret;
+
+    nand->stats.pageTransfers++;
+    ret = VirtualNandCopy(nand, mtdPage->type, mtdPage->addr, mtdPage->dataBuf, mtdPage->dataLen);
+    if (ret != EOK || mtdPage->oobBuf == NULL || mtdPage->oobLen == 0) {
+        return (ret == EOK) ? HDF_SUCCESS : HDF_ERR_IO;
+    }
+
+    oob = nand->oob + MtdDeviceAddrToPage(mtdDevice, mtdPage->addr) * MTD_VIRTUAL_NAND_OOB_SIZE;
+    if (mtdPage->type == MTD_MSG_TYPE_WRITE) {
+        ret = memcpy_s(oob, MTD_VIRTUAL_NAND_OOB_SIZE, mtdPage->oobBuf, mtdPage->oobLen);
+    } else {
+        ret = memcpy_s(mtdPage->oobBuf, mtdPage->oobLen, oob, MTD_VIRTUAL_NAND_OOB_SIZE);
+    }
+    return (ret == EOK) ? HDF_SUCCESS : HDF_ERR_IO;
+}
+
+static int32_t VirtualNandMultiPageTransfer(struct MtdDevice *mtdDevice, struct MtdPage *mtdPage)
+{
+    struct VirtualNand *nand = ToVirtualNand(mtdDevice);
+
+    /* whole pages inside one block, as the core guarantees */
+    if (!MtdDeviceIsPageAligned(mtdDevice, mtdPage->addr) || (mtdPage->dataLen % mtdDevice->writeSize) != 0 ||
+        ((mtdPage->addr % VIRTUAL_NAND_BLOCK_SIZE) + mtdPage->dataLen) > VIRTUAL_NAND_BLOCK_SIZE) {
+        HDF_LOGE("%s: invalid transfer, addr=0x%jx, len=%zu", __func__, mtdPage->addr, mtdPage->dataLen);
+        return HDF_ERR_INVALID_PARAM;
+    }
+    nand->stats.multiPageTransfers++;
+    if (VirtualNandCopy(nand, mtdPage->type, mtdPage->addr, mtdPage->dataBuf, mtdPage->dataLen) != EOK) {
+        return HDF_ERR_IO;
+    }
+    return HDF_SUCCESS;
+}
+
+static bool VirtualNandIsBadBlock(struct MtdDevice *mtdDevice, off_t addr)
+{
+    struct VirtualNand *nand = ToVirtualNand(mtdDevice);
+
+    nand->stats.badBlockChecks++;
+    return (*VirtualNandBadMark(nand, addr) != VIRTUAL_NAND_ERASED_BYTE);
+}
+
+static int32_t VirtualNandMarkBadBlock(struct MtdDevice *mtdDevice, off_t addr)
+{
+    *VirtualNandBadMark(ToVirtualNand(mtdDevice), addr) = VIRTUAL_NAND_BAD_MARK;
+    return HDF_SUCCESS;
+}
+
+static int32_t VirtualNandErase(struct MtdDevice *mtdDevice, off_t addr, size_t len, off_t *faddr)
+{
+    struct VirtualNand *nand = ToVirtualNand(mtdDevice);
+    off_t end = addr + len;
+    size_t page;
+
+    for (; addr < end; addr += VIRTUAL_NAND_BLOCK_SIZE) {
+        if (*VirtualNandBadMark(nand, addr) != VIRTUAL_NAND_ERASED_BYTE) {
+            if (faddr != NULL) {
+                *faddr = addr;
+            }
+            return HDF_ERR_IO;
+        }
+        page = MtdDeviceAddrToPage(mtdDevice, addr);
+        (void)memset_s(nand->data + addr, VIRTUAL_NAND_BLOCK_SIZE, VIRTUAL_NAND_ERASED_BYTE, VIRTUAL_NAND_BLOCK_SIZE);
+        (void)memset_s(nand->oob + page * MTD_VIRTUAL_NAND_OOB_SIZE,
+            MTD_VIRTUAL_NAND_BLOCK_PAGES * MTD_VIRTUAL_NAND_OOB_SIZE, VIRTUAL_NAND_ERASED_BYTE,
+            MTD_VIRTUAL_NAND_BLOCK_PAGES * MTD_VIRTUAL_NAND_OOB_SIZE);
+    }
+    return HDF_SUCCESS;
+}
+
+static struct MtdDeviceMethod g_virtualNandMethod = {
+    .erase = VirtualNandErase,
+    .pageTransfer = VirtualNandPageTransfer,
+    .multiPageTransfer = VirtualNandMultiPageTransfer,
+    .isBadBlock = VirtualNandIsBadBlock,
+    .markBadBlock = VirtualNandMarkBadBlock,
+};
+
+static void VirtualNandFree(struct VirtualNand *nand)
+{
+    OsalMemFree(nand->data);
+    OsalMemFree(nand->oob);
+    OsalMemFree(nand);
+}
+
+static int32_t VirtualNandInit(struct HdfDeviceObject *device)
+{
+    int32_t ret;
+    uint32_t index;
+    struct VirtualNand *nand = NULL;
+    struct DeviceResourceIface *drsOps = NULL;
+
+    if (device == NULL || device->property == NULL) {
+        HDF_LOGE("%s: device or property is NULL", __func__);
+        return HDF_ERR_INVALID_OBJECT;
+    }
+    drsOps = DeviceResourceGetIfaceInstance(HDF_CONFIG_SOURCE);
+    if (drsOps == NULL || drsOps->GetUint32 == NULL) {
+        HDF_LOGE("%s: invalid drs ops", __func__);
+        return HDF_FAILURE;
+    }
+    ret = drsOps->GetUint32(device->property, "index", &index, 0);
+    if (ret != HDF_SUCCESS) {
+        HDF_LOGE("%s: read index failed", __func__);
+        return ret;
+    }
+
+    nand = (struct VirtualNand *)OsalMemCalloc(sizeof(*nand));
+    if (nand == NULL) {
+        return HDF_ERR_MALLOC_FAIL;
+    }
+    nand->data = (uint8_t *)OsalMemAlloc(VIRTUAL_NAND_PAGE_NUM * MTD_VIRTUAL_NAND_PAGE_SIZE);
+    nand->oob = (uint8_t *)OsalMemAlloc(VIRTUAL_NAND_PAGE_NUM * MTD_VIRTUAL_NAND_OOB_SIZE);
+    if (nand->data == NULL || nand->oob == NULL) {
+        VirtualNandFree(nand);
+        return HDF_ERR_MALLOC_FAIL;
+    }
+    (void)memset_s(nand->data, VIRTUAL_NAND_PAGE_NUM * MTD_VIRTUAL_NAND_PAGE_SIZE, VIRTUAL_NAND_ERASED_BYTE,
+        VIRTUAL_NAND_PAGE_NUM * MTD_VIRTUAL_NAND_PAGE_SIZE);
+    (void)memset_s(nand->oob, VIRTUAL_NAND_PAGE_NUM * MTD_VIRTUAL_NAND_OOB_SIZE, VIRTUAL_NAND_ERASED_BYTE,
+        VIRTUAL_NAND_PAGE_NUM * MTD_VIRTUAL_NAND_OOB_SIZE);
+    *VirtualNandBadMark(nand, MTD_VIRTUAL_NAND_BAD_BLOCK * VIRTUAL_NAND_BLOCK_SIZE) = VIRTUAL_NAND_BAD_MARK;
+
+    nand->mtd.index = (int16_t)index;
+    nand->mtd.name = "virtual_nand";
+    nand->mtd.chipName = "virtual_nand";
+    nand->mtd.type = MTD_TYPE_NAND;
+    nand->mtd.capacity = VIRTUAL_NAND_PAGE_NUM * MTD_VIRTUAL_NAND_PAGE_SIZE;
+    nand->mtd.eraseSize = VIRTUAL_NAND_BLOCK_SIZE;
+    nand->mtd.writeSize = MTD_VIRTUAL_NAND_PAGE_SIZE;
+    nand->mtd.readSize = MTD_VIRTUAL_NAND_PAGE_SIZE;
+    nand->mtd.oobSize = MTD_VIRTUAL_NAND_OOB_SIZE;
+    nand->mtd.writeSizeShift = MtdFfs(MTD_VIRTUAL_NAND_PAGE_SIZE) - 1;
+    nand->mtd.ops = &g_virtualNandMethod;
+    nand->mtd.priv = &nand->stats;
+    ret = MtdDeviceAdd(&nand->mtd);
+    if (ret != HDF_SUCCESS) {
+        HDF_LOGE("%s: add mtd device failed, ret=%d", __func__, ret);
+        VirtualNandFree(nand);
+        return ret;
+    }
+    device->priv = nand;
+    return HDF_SUCCESS;
+}
+
+static void VirtualNandRelease(struct HdfDeviceObject *device)
+{
+    struct VirtualNand *nand = NULL;
+
+    if (device == NULL || device->priv == NULL) {
+        return;
+    }
+    nand = (struct VirtualNand *)device->priv;
+    MtdDeviceDel(&nand->mtd);
+    VirtualNandFree(nand);
+    device->priv = NULL;
+}
+
+struct HdfDriverEntry g_virtualNandDriverEntry = {
+    .moduleVersion = 1,
+    .moduleName = "virtual_mtd_nand_driver",
+    .Init = VirtualNandInit,
+    .Release = VirtualNandRelease,
+};
+HDF_INIT(g_virtualNandDriverEntry);
@@ -0,0 +1,208 @@
+/*
+ * Copyright (c) 2021 Huawei Device Co., Ltd.
+ *
+ * HDF is dual licensed: you can use it either under the terms of
+ * the GPL, or the BSD license, at your option.
+ * See the LICENSE file in the root of this repository for complete details.
+ */
+
+#include "spi_core.h"
+#include "device_resource_if.h"
+#include "hdf_device_desc.h"
+#include "hdf_log.h"
+#include "osal_mem.h"
+#include "osal_time.h"
+#include "securec.h"
+
+#define HDF_LOG_TAG spi_virtual
+
+#define VIRTUAL_SPI_CS_MAX        8
+#define VIRTUAL_SPI_SPEED_DEF     10000000
+#define VIRTUAL_SPI_CFG_DELAY_DEF 20 /* us spent programming the clock and frame registers */
+#define VIRTUAL_SPI_BITS_DEF      8
+#define VIRTUAL_SPI_USEC_PER_SEC  1000000
+
+/*
+ * A loopback controller: the read buffer gets what is written, after the time the bits take
+ * on the wire. Programming the config of a device costs a fixed time, as register writes and
+ * a clock switch do on hardware, and a transfer fails unless the config of its device is in place.
+ */
+struct VirtualSpiCntlr {
+    struct SpiCntlr *cntlr;
+    struct SpiCfg cfgs[VIRTUAL_SPI_CS_MAX];
+    uint32_t programmedCs;
+    uint32_t cfgDelayUs;
+};
+
+static int32_t VirtualSpiGetCfg(struct SpiCntlr *cntlr, struct SpiCfg *cfg)
+{
+    struct VirtualSpiCntlr *virtual = (struct VirtualSpiCntlr *)cntlr->priv;
+
+    if (cfg == NULL || cntlr->curCs >= cntlr->numCs) {
+        return HDF_ERR_INVALID_PARAM;
+    }
+    *cfg = virtual->cfgs[cntlr->curCs];
+    return HDF_SUCCESS;
+}
+
+static int32_t VirtualSpiSetCfg(struct SpiCntlr *cntlr, struct SpiCfg *cfg)
+{
+    struct VirtualSpiCntlr *virtual = (struct VirtualSpiCntlr *)cntlr->priv;
+
+    if (cfg == NULL || cntlr->curCs >= cntlr->numCs || cfg->maxSpeedHz == 0) {
+        return HDF_ERR_INVALID_PARAM;
+    }
+    virtual->cfgs[cntlr->curCs] = *cfg;
+    if (virtual->programmedCs == cntlr->curCs) {
+        virtual->programmedCs = SPI_CS_NONE;
+    }
+    return HDF_SUCCESS;
+}
+
+static int32_t VirtualSpiPrepare(struct SpiCntlr *cntlr)
+{
+    struct VirtualSpiCntlr *virtual = (struct VirtualSpiCntlr *)cntlr->priv;
+
+    if (cntlr->curCs >= cntlr->numCs) {
+        return HDF_ERR_INVALID_PARAM;
+    }
+    OsalUDelay(virtual->cfgDelayUs);
+    virtual->programmedCs = cntlr->curCs;
+    return HDF_SUCCESS;
+}
+
+static int32_t VirtualSpiTransfer(struct SpiCntlr *cntlr, struct SpiMsg *msg, uint32_t count)
+{
+    uint32_t i;
+    uint32_t speed;
+    uint64_t wireUs;
+    struct SpiCfg *cfg = NULL;
+    struct VirtualSpiCntlr *virtual = (struct VirtualSpiCntlr *)cntlr->priv;
+
+    if (msg == NULL || count == 0) {
+        return HDF_ERR_INVALID_PARAM;
+    }
+    if (virtual->programmedCs != cntlr->curCs) {
+        HDF_LOGE("%s: cs %u not prepared, cs %u is", __func__, cntlr->curCs, virtual->programmedCs);
+        return HDF_ERR_IO;
+    }
+    cfg = &virtual->cfgs[cntlr->curCs];
+    for (i = 0; i < count; i++) {
+        if (msg[i].rbuf != NULL) {
+            if (msg[i].wbuf != NULL) {
+                (void)memcpy_s(msg[i].rbuf, msg[i].len, msg[i].wbuf, msg[i].len);
+            } else {
+                (void)memset_s(msg[i].rbuf, msg[i].len, 0, msg[i].len);
+            }
+        }
+        speed = (msg[i].speed != 0 && msg[i].speed < cfg->maxSpeedHz) ? msg[i].speed : cfg->maxSpeedHz;
+        wireUs = (uint64_t)msg[i].len * cfg->bitsPerWord * VIRTUAL_SPI_USEC_PER_SEC / speed;
+        OsalUDelay((uint32_t)wireUs + msg[i].delayUs);
+    }
+    return HDF_SUCCESS;
+}
+
+static int32_t VirtualSpiOpen(struct SpiCntlr *cntlr)
+{
+    return (cntlr->curCs < cntlr->numCs) ? HDF_SUCCESS : HDF_ERR_INVALID_PARAM;
+}
+
+static int32_t VirtualSpiClose(struct SpiCntlr *cntlr)
+{
+    (void)cntlr;
+    return HDF_SUCCESS;
+}
+
+static struct SpiCntlrMethod g_virtualSpiMethod = {
+    .GetCfg = VirtualSpiGetCfg,
+    .SetCfg = VirtualSpiSetCfg,
+    .Transfer = VirtualSpiTransfer,
+    .Open = VirtualSpiOpen,
+    .Close = VirtualSpiClose,
+    .Prepare = VirtualSpiPrepare,
+};
+
+static int32_t VirtualSpiBind(struct HdfDeviceObject *device)
+{
+    if (device == NULL) {
+        return HDF_ERR_INVALID_OBJECT;
+    }
+    if (SpiCntlrCreate(device) == NULL) {
+        HDF_LOGE("%s: SpiCntlrCreate failed", __func__);
+        return HDF_FAILURE;
+    }
+    return HDF_SUCCESS;
+}
+
+static int32_t VirtualSpiInit(struct HdfDeviceObject *device)
+{
+    uint32_t i;
+    struct SpiCntlr *cntlr = NULL;
+    struct VirtualSpiCntlr *virtual = NULL;
+    struct DeviceResourceIface *drsOps = NULL;
+
+    if (device == NULL || device->property == NULL) {
+        HDF_LOGE("%s: device or property is NULL", __func__);
+        return HDF_ERR_INVALID_OBJECT;
+    }
+    cntlr = SpiCntlrFromDevice(device);
+    drsOps = DeviceResourceGetIfaceInstance(HDF_CONFIG_SOURCE);
+    if (cntlr == NULL || drsOps == NULL || drsOps->GetUint32 == NULL) {
+        HDF_LOGE("%s: invalid cntlr or drs ops", __func__);
+        return HDF_FAILURE;
+    }
+    if (drsOps->GetUint32(device->property, "bus_num", &cntlr->busNum, 0) != HDF_SUCCESS ||
+        drsOps->GetUint32(device->property, "num_cs", &cntlr->numCs, 0) != HDF_SUCCESS) {
+        HDF_LOGE("%s: read bus_num or num_cs failed", __func__);
+        return HDF_FAILURE;
+    }
+    if (cntlr->numCs == 0 || cntlr->numCs > VIRTUAL_SPI_CS_MAX) {
+        HDF_LOGE("%s: invalid num_cs:%u", __func__, cntlr->numCs);
+        return HDF_ERR_INVALID_PARAM;
+    }
+
+    virtual = (struct VirtualSpiCntlr *)OsalMemCalloc(sizeof(*virtual));
+    if (virtual == NULL) {
+        return HDF_ERR_MALLOC_FAIL;
+    }
+    (void)drsOps->GetUint32(device->property, "cfg_delay_us", &virtual->cfgDelayUs, VIRTUAL_SPI_CFG_DELAY_DEF);
+    for (i = 0; i < cntlr->numCs; i++) {
+        virtual->cfgs[i].maxSpeedHz = VIRTUAL_SPI_SPEED_DEF;
+        virtual->cfgs[i].bitsPerWord = VIRTUAL_SPI_BITS_DEF;
+        virtual->cfgs[i].transferMode = SPI_POLLING_TRANSFER;
+    }
+    virtual->programmedCs = SPI_CS_NONE;
+    virtual->cntlr = cntlr;
+    cntlr->priv = virtual;
+    cntlr->method = &g_virtualSpiMethod;
+    return HDF_SUCCESS;
+}
+
+static void VirtualSpiRelease(struct HdfDeviceObject *device)
+{
+    struct SpiCntlr *cntlr = NULL;
+    struct VirtualSpiCntlr *virtual = NULL;
+
+    if (device == NULL) {
+        return;
+    }
+    cntlr = SpiCntlrFromDevice(device);
+    if (cntlr == NULL) {
+        return;
+    }
+    virtual = (struct VirtualSpiCntlr *)cntlr->priv;
+    /* stops the queue thread, which may still be in the methods */
+    SpiCntlrDestroy(cntlr);
+    if (virtual != NULL) {
+        OsalMemFree(virtual);
+    }
+}
+
+struct HdfDriverEntry g_virtualSpiDriverEntry = {
+    .moduleVersion = 1,
+    .moduleName = "virtual_spi_driver",
+    .Bind = VirtualSpiBind,
+    .Init = VirtualSpiInit,
+    .Release = VirtualSpiRelease,
+};
+HDF_INIT(g_virtualSpiDriverEntry);
@@ -0,0 +1,320 @@
+/*
+ * Copyright (c) 2021 Huawei Device Co., Ltd.
+ *
+ * HDF is dual licensed: you can use it either under the terms of
+ * the GPL, or the BSD license, at your option.
+ * See the LICENSE file in the root of this repository for complete details.
+ */
+
+#include "uart_core.h"
+#include "device_resource_if.h"
+#include "hdf_device_desc.h"
+#include "hdf_log.h"
+#include "osal_mem.h"
+#include "osal_sem.h"
+#include "osal_thread.h"
+#include "osal_time.h"
+#include "securec.h"
+
+#define HDF_LOG_TAG uart_virtual
+
+#define VIRTUAL_UART_FIFO_SIZE   4096 /* a power of 2 */
+#define VIRTUAL_UART_BAUD_DEF    115200
+#define VIRTUAL_UART_BITS_PER_CH 10   /* start, 8 data and stop bit */
+#define VIRTUAL_UART_TICK_MS     1
+#define VIRTUAL_UART_USEC_PER_SEC 1000000
+#define VIRTUAL_UART_STACK_SIZE  10000
+#define VIRTUAL_UART_NAME_LEN    32
+
+struct VirtualUartFifo {
+    uint8_t buf[VIRTUAL_UART_FIFO_SIZE];
+    uint32_t head;
+    uint32_t tail;
+};
+
+/*
+ * A loopback port: written data is put on a wire, which a thread moves to the receive side
+ * at the rate of the baud, either into the receive ring of the host or into a fifo for Read.
+ */
+struct VirtualUart {
+    struct UartHost *host;
+    uint32_t baud;
+    bool push;
+    bool running;
+    OsalSpinlock spin;
+    struct VirtualUartFifo wire;
+    struct VirtualUartFifo rx;
+    uint64_t budget;        /* bit times not used yet, in us * baud */
+    OsalTimespec last;
+    struct OsalThread thread;
+    struct OsalSem exited;
+    char name[VIRTUAL_UART_NAME_LEN];
+};
+
+static uint32_t VirtualUartFifoPut(struct VirtualUartFifo *fifo, const uint8_t *data, uint32_t size)
+{
+    uint32_t i;
+    uint32_t count = VIRTUAL_UART_FIFO_SIZE - (fifo->head - fifo->tail);
+
+    count = (size < count) ? size : count;
+    for (i = 0; i < count; i++) {
+        fifo->buf[(fifo->head + i) & (VIRTUAL_UART_FIFO_SIZE - 1)] = data[i];
+    }
+    fifo->head += count;
+    return count;
+}
+
+static uint32_t VirtualUartFifoGet(struct VirtualUartFifo *fifo, uint8_t *data, uint32_t size)
+{
+    uint32_t i;
+    uint32_t count = fifo->head - fifo->tail;
+
+    count = (size < count) ? size : count;
+    for (i = 0; i < count; i++) {
+        data[i] = fifo->buf[(fifo->tail + i) & (VIRTUAL_UART_FIFO_SIZE - 1)];
+    }
+    fifo->tail += count;
+    return count;
+}
+
+/* the bytes the wire carried since the last tick */
+static uint32_t VirtualUartWireBudget(struct VirtualUart *virtual)
+{
+    uint32_t count;
+    OsalTimespec now;
+    OsalTimespec diff;
+
+    (void)OsalGetTime(&now);
+    (void)OsalDiffTime(&virtual->last, &now, &diff);
+    virtual->last = now;
+    virtual->budget += ((uint64_t)diff.sec * VIRTUAL_UART_USEC_PER_SEC + diff.usec) * virtual->baud;
+    count = (uint32_t)(virtual->budget / ((uint64_t)VIRTUAL_UART_BITS_PER_CH * VIRTUAL_UART_USEC_PER_SEC));
+    virtual->budget -= (uint64_t)count * VIRTUAL_UART_BITS_PER_CH * VIRTUAL_UART_USEC_PER_SEC;
+    return count;
+}
+
+static int VirtualUartWireThread(void *data)
+{
+    uint32_t flags;
+    uint32_t count;
+    uint32_t budget;
+    uint8_t chunk[VIRTUAL_UART_FIFO_SIZE / 4];
+    struct VirtualUart *virtual = (struct VirtualUart *)data;
+
+    (void)OsalGetTime(&virtual->last);
+    while (virtual->running) {
+        OsalMSleep(VIRTUAL_UART_TICK_MS);
+        budget = VirtualUartWireBudget(virtual);
+        do {
+            (void)OsalSpinLockIrqSave(&virtual->spin, &flags);
+            count = VirtualUartFifoGet(&virtual->wire, chunk, (budget < sizeof(chunk)) ? budget : sizeof(chunk));
+            if (!virtual->push) {
+                /* a full rx fifo loses data, as a real one does */
+                (void)VirtualUartFifoPut(&virtual->rx, chunk, count);
+            }
+            (void)OsalSpinUnlockIrqRestore(&virtual->spin, &flags);
+            if (virtual->push && count > 0) {
+                (void)UartHostRxPut(virtual->host, chunk, count);
+            }
+            budget -= count;
+        } while (count > 0 && budget > 0);
+        if (budget > 0) {
+            /* an idle line does not save up bit times */
+            virtual->budget = 0;
+        }
+    }
+    (void)OsalSemPost(&virtual->exited);
+    return HDF_SUCCESS;
+}
+
+static int32_t VirtualUartRead(struct UartHost *host, uint8_t *data, uint32_t size)
+{
+    uint32_t flags;
+    uint32_t count;
+    struct VirtualUart *virtual = (struct VirtualUart *)host->priv;
+
+    if (data == NULL) {
+        return HDF_ERR_INVALID_PARAM;
+    }
+    (void)OsalSpinLockIrqSave(&virtual->spin, &flags);
+    count = VirtualUartFifoGet(&virtual->rx, data, size);
+    (void)OsalSpinUnlockIrqRestore(&virtual->spin, &flags);
+    return (int32_t)count;
+}
+
+static int32_t VirtualUartWrite(struct UartHost *host, uint8_t *data, uint32_t size)
+{
+    uint32_t flags;
+    uint32_t done = 0;
+    struct VirtualUart *virtual = (struct VirtualUart *)host->priv;
+
+    if (data == NULL) {
+        return HDF_ERR_INVALID_PARAM;
+    }
+    /* blocks until the wire took all of it */
+    while (true) {
+        (void)OsalSpinLockIrqSave(&virtual->spin, &flags);
+        done += VirtualUartFifoPut(&virtual->wire, data + done, size - done);
+        (void)OsalSpinUnlockIrqRestore(&virtual->spin, &flags);
+        if (done >= size) {
+            break;
+        }
+        OsalMSleep(VIRTUAL_UART_TICK_MS);
+    }
+    return HDF_SUCCESS;
+}
+
+static int32_t VirtualUartGetBaud(struct UartHost *host, uint32_t *baudRate)
+{
+    struct VirtualUart *virtual = (struct VirtualUart *)host->priv;
+
+    if (baudRate == NULL) {
+        return HDF_ERR_INVALID_PARAM;
+    }
+    *baudRate = virtual->baud;
+    return HDF_SUCCESS;
+}
+
+static int32_t VirtualUartSetBaud(struct UartHost *host, uint32_t baudRate)
+{
+    struct VirtualUart *virtual = (struct VirtualUart *)host->priv;
+
+    if (baudRate == 0) {
+        return HDF_ERR_INVALID_PARAM;
+    }
+    virtual->baud = baudRate;
+    return HDF_SUCCESS;
+}
+
+static int32_t VirtualUartSetRxPush(struct UartHost *host, bool enable)
+{
+    uint32_t flags;
+    struct VirtualUart *virtual = (struct VirtualUart *)host->priv;
+
+    (void)OsalSpinLockIrqSave(&virtual->spin, &flags);
+    virtual->push = enable;
+    (void)OsalSpinUnlockIrqRestore(&virtual->spin, &flags);
+    if (!enable) {
+        /* let a chunk the wire thread is handing over complete */
+        OsalMSleep(VIRTUAL_UART_TICK_MS + VIRTUAL_UART_TICK_MS);
+    }
+    return HDF_SUCCESS;
+}
+
+static struct UartHostMethod g_virtualUartMethod = {
+    .Read = VirtualUartRead,
+    .Write = VirtualUartWrite,
+    .GetBaud = VirtualUartGetBaud,
+    .SetBaud = VirtualUartSetBaud,
+    .SetRxPush = VirtualUartSetRxPush,
+};
+
+static int32_t VirtualUartStart(struct VirtualUart *virtual)
+{
+    struct OsalThreadParam cfg;
+
+    if (snprintf_s(virtual->name, VIRTUAL_UART_NAME_LEN, VIRTUAL_UART_NAME_LEN - 1,
+        "virtual_uart_%u", virtual->host->num) < 0) {
+        return HDF_FAILURE;
+    }
+    if (OsalSpinInit(&virtual->spin) != HDF_SUCCESS) {
+        return HDF_FAILURE;
+    }
+    if (OsalSemInit(&virtual->exited, 0) != HDF_SUCCESS) {
+        (void)OsalSpinDestroy(&virtual->spin);
+        return HDF_FAILURE;
+    }
+    virtual->running = true;
+    cfg.name = virtual->name;
+    cfg.priority = OSAL_THREAD_PRI_HIGH;
+    cfg.stackSize = VIRTUAL_UART_STACK_SIZE;
+    if (OsalThreadCreate(&virtual->thread, (OsalThreadEntry)VirtualUartWireThread, virtual) != HDF_SUCCESS ||
+        OsalThreadStart(&virtual->thread, &cfg) != HDF_SUCCESS) {
+        HDF_LOGE("%s: start wire thread failed", __func__);
+        (void)OsalSemDestroy(&virtual->exited);
+        (void)OsalSpinDestroy(&virtual->spin);
+        return HDF_FAILURE;
+    }
+    return HDF_SUCCESS;
+}
+
+static int32_t VirtualUartBind(struct HdfDeviceObject *device)
+{
+    if (device == NULL) {
+        return HDF_ERR_INVALID_OBJECT;
+    }
+    if (UartHostCreate(device) == NULL) {
+        HDF_LOGE("%s: UartHostCreate failed", __func__);
+        return HDF_FAILURE;
+    }
+    return HDF_SUCCESS;
+}
+
+static int32_t VirtualUartInit(struct HdfDeviceObject *device)
+{
+    struct UartHost *host = NULL;
+    struct VirtualUart *virtual = NULL;
+    struct DeviceResourceIface *drsOps = NULL;
+
+    if (device == NULL || device->property == NULL) {
+        HDF_LOGE("%s: device or property is NULL", __func__);
+        return HDF_ERR_INVALID_OBJECT;
+    }
+    host = UartHostFromDevice(device);
+    drsOps = DeviceResourceGetIfaceInstance(HDF_CONFIG_SOURCE);
+    if (host == NULL || drsOps == NULL || drsOps->GetUint32 == NULL) {
+        HDF_LOGE("%s: invalid host or drs ops", __func__);
+        return HDF_FAILURE;
+    }
+    if (drsOps->GetUint32(device->property, "num", &host->num, 0) != HDF_SUCCESS) {
+        HDF_LOGE("%s: read num failed", __func__);
+        return HDF_FAILURE;
+    }
+
+    virtual = (struct VirtualUart *)OsalMemCalloc(sizeof(*virtual));
+    if (virtual == NULL) {
+        return HDF_ERR_MALLOC_FAIL;
+    }
+    virtual->host = host;
+    virtual->baud = VIRTUAL_UART_BAUD_DEF;
+    if (VirtualUartStart(virtual) != HDF_SUCCESS) {
+        OsalMemFree(virtual);
+        return HDF_FAILURE;
+    }
+    host->priv = virtual;
+    host->method = &g_virtualUartMethod;
+    return HDF_SUCCESS;
+}
+
+static void VirtualUartRelease(struct HdfDeviceObject *device)
+{
+    struct UartHost *host = NULL;
+    struct VirtualUart *virtual = NULL;
+
+    if (device == NULL) {
+        return;
+    }
+    host = UartHostFromDevice(device);
+    if (host == NULL) {
+        return;
+    }
+    virtual = (struct VirtualUart *)host->priv;
+    if (virtual != NULL) {
+        virtual->running = false;
+        (void)OsalSemWait(&virtual->exited, HDF_WAIT_FOREVER);
+        (void)OsalSemDestroy(&virtual->exited);
+        (void)OsalSpinDestroy(&virtual->spin);
+        OsalMemFree(virtual);
+        host->priv = NULL;
+    }
+    UartHostDestroy(host);
+}
+
+struct HdfDriverEntry g_virtualUartDriverEntry = {
+    .moduleVersion = 1,
+    .moduleName = "virtual_uart_driver",
+    .Bind = VirtualUartBind,
+    .Init = VirtualUartInit,
+    .Release = VirtualUartRelease,
+};
+HDF_INIT(g_virtualUartDriverEntry);
@@ -10,7 +10,6 @@
 #include "hdf_base.h"
 #include "hdf_device_desc.h"
 #include "hdf_sensor_test.h"
-#include "osal_math.h"
 #include "osal_time.h"
 #include "sensor_platform_if.h"
 #include "sensor_device_manager.h"
@@ -21,7 +20,6 @@
 #define HDF_SENSOR_TEST_VALUE    1024000000 // 1g = 9.8m/s^2
 #define SENSOR_TEST_MAX_RANGE    8
 #define SENSOR_TEST_MAX_POWER    230
-#define HDF_SENSOR_TEST_WORK_QUEUE_NAME    "hdf_sensor_test_work_queue"
 
 static struct SensorTestDrvData *GetSensorTestDrvData(void)
 {
@@ -52,38 +50,10 @@ static void SensorTestDataWorkEntry(void *arg)
     ReportSensorEvent(&event);
 }
 
-static void SensorTestTimerEntry(uintptr_t arg)
-{
-    int64_t interval;
-    struct SensorTestDrvData *drvData = (struct SensorTestDrvData *)arg;
-    CHECK_NULL_PTR_RETURN(drvData);
-
-    if (!HdfAddWork(&drvData->workQueue, &drvData->work)) {
-        HDF_LOGE("%s: sensor test add work queue failed", __func__);
-    }
-
-    interval = OsalDivS64(drvData->interval, (SENSOR_CONVERT_UNIT * SENSOR_CONVERT_UNIT));
-    interval = (interval < SENSOR_TIMER_MIN_TIME) ? SENSOR_TIMER_MIN_TIME : interval;
-
-    if (OsalTimerSetTimeout(&drvData->timer, interval) != HDF_SUCCESS) {
-        HDF_LOGE("%s: sensor test modify time failed", __func__);
-    }
-}
-
 static int32_t SensorInitTestConfig(void)
 {
     struct SensorTestDrvData *drvData = GetSensorTestDrvData();
 
-    if (HdfWorkQueueInit(&drvData->workQueue, HDF_SENSOR_TEST_WORK_QUEUE_NAME) != HDF_SUCCESS) {
-        HDF_LOGE("%s: sensor test init work queue failed", __func__);
-        return HDF_FAILURE;
-    }
-
-    if (HdfWorkInit(&drvData->work, SensorTestDataWorkEntry, drvData) != HDF_SUCCESS) {
-        HDF_LOGE("%s: sensor test create thread failed", __func__);
-        return HDF_FAILURE;
-    }
-
     drvData->enable = false;
     drvData->initStatus = true;
 
@@ -100,15 +70,9 @@ static int32_t SensorEnableTest(void)
         return HDF_SUCCESS;
     }
 
-    ret = OsalTimerCreate(&drvData->timer, SENSOR_TIMER_MIN_TIME, SensorTestTimerEntry, (uintptr_t)drvData);
+    ret = SensorSchedStart(&drvData->schedNode, SensorTestDataWorkEntry, drvData, drvData->interval);
     if (ret != HDF_SUCCESS) {
-        HDF_LOGE("%s: sensor test create timer failed[%d]", __func__, ret);
-        return ret;
-    }
-
-    ret = OsalTimerStartLoop(&drvData->timer);
-    if (ret != HDF_SUCCESS) {
-        HDF_LOGE("%s: sensor test start timer failed[%d]", __func__, ret);
+        HDF_LOGE("%s: sensor test start sched failed[%d]", __func__, ret);
         return ret;
     }
     drvData->enable = true;
@@ -126,12 +90,10 @@ static int32_t SensorDisableTest(void)
         return HDF_SUCCESS;
     }
 
-    if (drvData->timer.realTimer != NULL) {
-        ret = OsalTimerDelete(&drvData->timer);
-        if (ret != HDF_SUCCESS) {
-            HDF_LOGE("%s: sensor test delete timer failed", __func__);
-            return ret;
-        }
+    ret = SensorSchedStop(&drvData->schedNode);
+    if (ret != HDF_SUCCESS) {
+        HDF_LOGE("%s: sensor test stop sched failed", __func__);
+        return ret;
     }
 
     drvData->enable = false;
@@ -147,6 +109,9 @@ static int32_t SensorSetBatchTest(int64_t samplingInterval, int64_t interval)
     drvData = GetSensorTestDrvData();
 
     drvData->interval = samplingInterval;
+    if (drvData->enable) {
+        return SensorSchedSetInterval(&drvData->schedNode, samplingInterval);
+    }
     return HDF_SUCCESS;
 }
 
@@ -248,11 +213,9 @@ void ReleaseSensorDriverTest(struct HdfDeviceObject *device)
     (void)device;
     (void)DeleteSensorDevice(&deviceInfo.sensorInfo);
 
-    if (drvData->timer.realTimer != NULL) {
-        ret = OsalTimerDelete(&drvData->timer);
-        if (ret != HDF_SUCCESS) {
-            HDF_LOGE("%s: sensor test delete timer failed", __func__);
-        }
+    ret = SensorSchedStop(&drvData->schedNode);
+    if (ret != HDF_SUCCESS) {
+        HDF_LOGE("%s: sensor test stop sched failed", __func__);
     }
 }
 
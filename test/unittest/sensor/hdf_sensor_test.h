@@ -9,17 +9,14 @@
 #ifndef HDF_SENSOR_DRIVER_TEST_H
 #define HDF_SENSOR_DRIVER_TEST_H
 
-#include "hdf_workqueue.h"
-#include "osal_timer.h"
+#include "sensor_sched.h"
 
 #define SENSOR_TEST_SAMPLING_200_MS    200000000
 
 struct SensorTestDrvData {
     uint8_t initStatus;
     int64_t interval;
-    HdfWorkQueue workQueue;
-    HdfWork work;
-    OsalTimer timer;
+    struct SensorSchedNode schedNode;
     bool enable;
 };
 